@@ -21,6 +21,7 @@
 #include <mrpt/obs/CObservation2DRangeScan.h>
 #include <mrpt/slam/CMetricMapBuilderICP.h>
 #include <mrpt/config/CConfigFile.h>
+#include <mrpt/containers/bounded_mpmc_queue.h>
 #include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
 #include <mrpt/io/CFileOutputStream.h>
@@ -107,8 +108,10 @@ int main(int argc, char** argv)
 
 // Sensor thread -------------------------
 MRPT_TODO("Should these be global?")
-mrpt::hwdrivers::CGenericSensor::TListObservations global_list_obs;
-std::mutex cs_global_list_obs;
+// Lock-free, so sensors do not contend with each other nor with SLAM:
+mrpt::containers::bounded_mpmc_queue<
+	mrpt::hwdrivers::CGenericSensor::TListObsPair>
+	global_obs_queue(1 << 14);
 
 bool allThreadsMustExit = false;
 struct TThreadParams
@@ -151,9 +154,15 @@ void SensorThread(TThreadParams params)
 			// Get new observations
 			CGenericSensor::TListObservations lstObjs;
 			sensor->getObservations(lstObjs);
+			// If the queue is full, wait for SLAM (backpressure) unless we
+			// are exiting:
+			for (const auto& o : lstObjs)
 			{
-				std::lock_guard<std::mutex> lock(cs_global_list_obs);
-				global_list_obs.insert(lstObjs.begin(), lstObjs.end());
+				CGenericSensor::TListObsPair obs(o.first, o.second);
+				while (!global_obs_queue.push(std::move(obs), 100ms) &&
+					   !allThreadsMustExit)
+				{
+				}
 			}
 			lstObjs.clear();
 			// wait for the process period:
@@ -341,9 +350,9 @@ void MapBuilding_ICP_Live(const string& INI_FILENAME)
 		{
 			mrpt::hwdrivers::CGenericSensor::TListObservations obs_copy;
 			{
-				std::lock_guard<std::mutex> csl(cs_global_list_obs);
-				obs_copy = global_list_obs;
-				global_list_obs.clear();
+				mrpt::hwdrivers::CGenericSensor::TListObsPair obs;
+				while (global_obs_queue.try_pop(obs))
+					obs_copy.insert(std::move(obs));
 			}
 			// Keep the most recent laser scan:
 			for (mrpt::hwdrivers::CGenericSensor::TListObservations::
@@ -32,6 +32,7 @@ void register_tests_matrices();
 void register_tests_grids();
 void register_tests_pointmaps();
 void register_tests_random();
+void register_tests_particle_filter();
 void register_tests_math();
 void register_tests_image();
 void register_tests_scan_matching();
@@ -42,6 +43,8 @@ void register_tests_graphslam();
 void register_tests_CObservation3DRangeScan();
 void register_tests_atan2lut();
 void register_tests_strings();
+void register_tests_nav();
+void register_tests_velodyne();
 // -------------------------------------------------
 
 using TestFunctor =
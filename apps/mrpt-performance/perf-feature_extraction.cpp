@@ -8,6 +8,7 @@
    +------------------------------------------------------------------------+ */
 
 #include <mrpt/img/CImage.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <mrpt/vision/CFeatureExtraction.h>
 
 #include "common.h"
@@ -268,6 +269,40 @@ double feature_extraction_test_FASTER(int N, int threshold)
 	return T;
 }
 
+// ------------------------------------------------------
+//				Benchmark: tiled extraction
+// ------------------------------------------------------
+// num_threads: 0=> not tiled, 1=> tiled, >1 => tiled+threads
+template <mrpt::vision::TFeatureType TYP>
+double feature_extraction_test_tiled(int N, int num_threads)
+{
+	CImage img;
+	getTestImage(0, img);
+	img.grayscaleInPlace();
+	img.scaleImage(1920, 1080);
+
+	std::unique_ptr<mrpt::system::CWorkerThreadsPool> pool;
+	if (num_threads > 1)
+		pool.reset(new mrpt::system::CWorkerThreadsPool(num_threads - 1));
+
+	CFeatureExtraction fExt;
+	fExt.options.featsType = TYP;
+	fExt.options.FASTOptions.threshold = 20;
+	fExt.options.patchSize = 0;
+	fExt.options.tilingOptions.enable = (num_threads > 0);
+	fExt.options.tilingOptions.cells_x = 8;
+	fExt.options.tilingOptions.cells_y = 6;
+	fExt.options.tilingOptions.threadPool = pool.get();
+
+	CFeatureList feats;
+	CTicTac tictac;
+	tictac.Tic();
+	for (int i = 0; i < N; i++) fExt.detectFeatures(img, feats, 0, 1000);
+
+	const double T = tictac.Tac() / N;
+	return T;
+}
+
 // ------------------------------------------------------
 // register_tests_feature_extraction
 // ------------------------------------------------------
@@ -408,4 +443,31 @@ void register_tests_feature_extraction()
 			"feature_extraction [1024x768]: "
 			"detectFeatures_SSE2_FASTER12()+row-index",
 			feature_extraction_test_FAST12<1024, 768, true>, 1000));
+
+	lstTests.push_back(
+		TestData(
+			"feature_extraction [1920x1080]: FASTER-9 (best 1000)",
+			feature_extraction_test_tiled<featFASTER9>, 50, 0));
+	lstTests.push_back(
+		TestData(
+			"feature_extraction [1920x1080]: FASTER-9 (best 1000) tiled 8x6",
+			feature_extraction_test_tiled<featFASTER9>, 50, 1));
+	lstTests.push_back(
+		TestData(
+			"feature_extraction [1920x1080]: FASTER-9 (best 1000) tiled 8x6, "
+			"4 threads",
+			feature_extraction_test_tiled<featFASTER9>, 50, 4));
+	lstTests.push_back(
+		TestData(
+			"feature_extraction [1920x1080]: ORB (best 1000)",
+			feature_extraction_test_tiled<featORB>, 10, 0));
+	lstTests.push_back(
+		TestData(
+			"feature_extraction [1920x1080]: ORB (best 1000) tiled 8x6",
+			feature_extraction_test_tiled<featORB>, 10, 1));
+	lstTests.push_back(
+		TestData(
+			"feature_extraction [1920x1080]: ORB (best 1000) tiled 8x6, "
+			"4 threads",
+			feature_extraction_test_tiled<featORB>, 10, 4));
 }
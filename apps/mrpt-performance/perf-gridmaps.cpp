@@ -85,7 +85,7 @@ double grid_test_4(int a1, int a2)
 
 	float p = 0.57f;
 	COccupancyGridMap2D::cellType logodd_obs = COccupancyGridMap2D::p2l(p);
-	COccupancyGridMap2D::cellType* theMapArray = gridMap.getRow(0);
+	COccupancyGridMap2D::cellType* theMapArray = gridMap.getRow(2);
 	unsigned theMapSize_x = gridMap.getSizeX();
 	COccupancyGridMap2D::cellType logodd_thres_occupied =
 		COccupancyGridMap2D::OCCGRID_CELLTYPE_MIN + logodd_obs;
@@ -94,7 +94,7 @@ double grid_test_4(int a1, int a2)
 	for (long i = 0; i < N; i++)
 	{
 		COccupancyGridMap2D::updateCell_fast_occupied(
-			2, 2, logodd_obs, logodd_thres_occupied, theMapArray, theMapSize_x);
+			2, 0, logodd_obs, logodd_thres_occupied, theMapArray, theMapSize_x);
 	}
 	return tictac.Tac() / N;
 }
@@ -213,6 +213,32 @@ double grid_test_9(int a1, int a2)
 	return tictac.Tac() / a1;
 }
 
+double grid_test_10(int a1, int a2)
+{
+	// test 10: copy a map (as in RBPF resampling) and insert one scan in
+	// each copy
+	// ----------------------------------------
+	CObservation2DRangeScan scan1;
+	scan1.aperture = M_PIf;
+	scan1.rightToLeft = true;
+	scan1.loadFromVectors(
+		sizeof(SCAN_RANGES_1) / sizeof(SCAN_RANGES_1[0]), SCAN_RANGES_1,
+		SCAN_VALID_1);
+
+	COccupancyGridMap2D gridmap(-50, 50, -50, 50, 0.05f);
+	CPose3D pose3D(0, 0, 0);
+	gridmap.insertObservation(&scan1, &pose3D);
+
+	std::vector<COccupancyGridMap2D> copies(a1);
+	CTicTac tictac;
+	for (auto& c : copies)
+	{
+		c = gridmap;
+		c.insertObservation(&scan1, &pose3D);
+	}
+	return tictac.Tac() / a1;
+}
+
 // ------------------------------------------------------
 // register_tests_grids
 // ------------------------------------------------------
@@ -231,4 +257,6 @@ void register_tests_grids()
 	lstTests.push_back(TestData("gridmap2D: computeLikelihood", grid_test_8));
 	lstTests.push_back(
 		TestData("gridmap2D: determineMatching2D", grid_test_9, 5000));
+	lstTests.push_back(
+		TestData("gridmap2D: copy map + insert scan", grid_test_10, 100));
 }
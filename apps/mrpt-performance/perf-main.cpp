@@ -209,6 +209,7 @@ int main(int argc, char** argv)
 		register_tests_grids();
 		register_tests_pointmaps();
 		register_tests_random();
+		register_tests_particle_filter();
 		register_tests_math();
 		register_tests_image();
 		register_tests_scan_matching();
@@ -219,6 +220,8 @@ int main(int argc, char** argv)
 		register_tests_CObservation3DRangeScan();
 		register_tests_atan2lut();
 		register_tests_strings();
+		register_tests_nav();
+		register_tests_velodyne();
 
 		if (doLog)
 		{
@@ -0,0 +1,158 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/nav/tpspace/CParameterizedTrajectoryGenerator.h>
+#include <mrpt/config/CConfigFileMemory.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/random.h>
+#include <memory>
+
+#include "common.h"
+
+using namespace mrpt::nav;
+using namespace std;
+
+// A typical set of 7 PTGs for a differential-driven robot, plus a holonomic
+// one, all with a polygonal or circular robot shape of ~0.3m:
+static const char* PTGS_7_CFG =
+	"[PTGS]\n"
+	"PTG_COUNT = 7\n"
+	"PTG0_Type = CPTG_DiffDrive_C\n"
+	"PTG0_K = 1.0\n"
+	"PTG1_Type = CPTG_DiffDrive_C\n"
+	"PTG1_K = -1.0\n"
+	"PTG2_Type = CPTG_DiffDrive_alpha\n"
+	"PTG2_cte_a0v_deg = 57\n"
+	"PTG2_cte_a0w_deg = 57\n"
+	"PTG3_Type = CPTG_DiffDrive_CC\n"
+	"PTG3_K = 1.0\n"
+	"PTG4_Type = CPTG_DiffDrive_CCS\n"
+	"PTG4_K = 1.0\n"
+	"PTG5_Type = CPTG_DiffDrive_CS\n"
+	"PTG5_K = 1.0\n"
+	"PTG6_Type = CPTG_Holo_Blend\n"
+	"PTG6_T_ramp_max = 0.8\n"
+	"PTG6_robot_radius = 0.30\n";
+
+static const vector<CParameterizedTrajectoryGenerator::Ptr>& get7PTGs()
+{
+	static vector<CParameterizedTrajectoryGenerator::Ptr> ptgs;
+	if (!ptgs.empty()) return ptgs;
+
+	mrpt::config::CConfigFileMemory cfg{std::string(PTGS_7_CFG)};
+	const unsigned int PTG_COUNT = cfg.read_int("PTGS", "PTG_COUNT", 0, true);
+	for (unsigned int n = 0; n < PTG_COUNT; n++)
+	{
+		const string sPrefix = mrpt::format("PTG%u_", n);
+		const vector<pair<string, string>> common_params = {
+			{"resolution", "0.05"},
+			{"refDistance", "4.0"},
+			{"num_paths", "121"},
+			{"v_max_mps", "1.0"},
+			{"w_max_dps", "60"},
+			{"shape_x0", "-0.2"},
+			{"shape_y0", "0.3"},
+			{"shape_x1", "0.4"},
+			{"shape_y1", "0.3"},
+			{"shape_x2", "0.4"},
+			{"shape_y2", "-0.3"},
+			{"shape_x3", "-0.2"},
+			{"shape_y3", "-0.3"}};
+		for (const auto& p : common_params)
+			cfg.write("PTGS", sPrefix + p.first, p.second);
+
+		ptgs.emplace_back(CParameterizedTrajectoryGenerator::CreatePTG(
+			cfg.read_string("PTGS", sPrefix + "Type", "", true), cfg, "PTGS",
+			sPrefix));
+		ptgs.back()->initialize(string(), false /*verbose*/);
+	}
+	return ptgs;
+}
+
+// Random obstacles around the robot, in the typical density of a 2D scan:
+static void getRandomObstacles(size_t N, vector<float>& oxs, vector<float>& oys)
+{
+	auto& rnd = mrpt::random::getRandomGenerator();
+	rnd.randomize(123);
+	oxs.resize(N);
+	oys.resize(N);
+	for (size_t i = 0; i < N; i++)
+	{
+		const double ang = rnd.drawUniform(-M_PI, M_PI);
+		const double r = rnd.drawUniform(0.6, 6.0);
+		oxs[i] = r * cos(ang);
+		oys[i] = r * sin(ang);
+	}
+}
+
+// num_threads: 0=> one obstacle at a time, 1=> batch, >1 => batch+threads
+double nav_test_clearance_7ptgs(int num_obstacles, int num_threads)
+{
+	const auto& ptgs = get7PTGs();
+	vector<float> oxs, oys;
+	getRandomObstacles(num_obstacles, oxs, oys);
+
+	std::unique_ptr<mrpt::system::CWorkerThreadsPool> pool;
+	if (num_threads > 1)
+		pool.reset(new mrpt::system::CWorkerThreadsPool(num_threads - 1));
+
+	vector<ClearanceDiagram> cds(ptgs.size());
+	const int N = 10;
+	CTicTac tictac;
+	for (int it = 0; it < N; it++)
+	{
+		for (size_t i = 0; i < ptgs.size(); i++)
+		{
+			const auto& ptg = ptgs[i];
+			ptg->initClearanceDiagram(cds[i]);
+			if (num_threads == 0)
+			{
+				for (size_t j = 0; j < oxs.size(); j++)
+					ptg->updateClearance(oxs[j], oys[j], cds[i]);
+			}
+			else
+			{
+				ptg->updateClearanceBatch(
+					&oxs[0], &oys[0], oxs.size(), cds[i], pool.get());
+			}
+		}
+	}
+	return tictac.Tac() / N;
+}
+
+// ------------------------------------------------------
+// register_tests_nav
+// ------------------------------------------------------
+void register_tests_nav()
+{
+	lstTests.push_back(
+		TestData(
+			"nav: clearance 7 PTGs, 1000 obs, updateClearance()",
+			nav_test_clearance_7ptgs, 1000, 0));
+	lstTests.push_back(
+		TestData(
+			"nav: clearance 7 PTGs, 1000 obs, batch", nav_test_clearance_7ptgs,
+			1000, 1));
+	lstTests.push_back(
+		TestData(
+			"nav: clearance 7 PTGs, 1000 obs, batch, 4 threads",
+			nav_test_clearance_7ptgs, 1000, 4));
+	lstTests.push_back(
+		TestData(
+			"nav: clearance 7 PTGs, 5000 obs, updateClearance()",
+			nav_test_clearance_7ptgs, 5000, 0));
+	lstTests.push_back(
+		TestData(
+			"nav: clearance 7 PTGs, 5000 obs, batch", nav_test_clearance_7ptgs,
+			5000, 1));
+	lstTests.push_back(
+		TestData(
+			"nav: clearance 7 PTGs, 5000 obs, batch, 4 threads",
+			nav_test_clearance_7ptgs, 5000, 4));
+}
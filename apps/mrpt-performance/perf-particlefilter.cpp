@@ -0,0 +1,179 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/bayes/CParticleFilterCapable.h>
+#include <mrpt/random.h>
+#include <algorithm>
+#include <iostream>
+
+#include "common.h"
+
+using namespace mrpt;
+using namespace mrpt::bayes;
+using namespace mrpt::random;
+using namespace std;
+
+// Random log-weights, with a dynamic range similar to that of real filters:
+static void pf_random_log_weights(size_t N, std::vector<double>& log_ws)
+{
+	getRandomGenerator().randomize(1234);
+	log_ws.resize(N);
+	for (auto& lw : log_ws) lw = getRandomGenerator().drawGaussian1D(0, 30);
+}
+
+// ------------------------------------------------------
+//				Benchmark Particle Filters
+// ------------------------------------------------------
+template <CParticleFilter::TParticleResamplingAlgorithm METHOD>
+double pf_test_resample(int N, int a2)
+{
+	std::vector<double> log_ws, workspace;
+	std::vector<size_t> idxs;
+	pf_random_log_weights(N, log_ws);
+
+	const long REPS = std::max(10, 10000000 / N);
+	CTicTac tictac;
+	for (long i = 0; i < REPS; i++)
+		CParticleFilterCapable::computeResampling(
+			METHOD, log_ws, idxs, workspace);
+	return tictac.Tac() / REPS;
+}
+
+double pf_test_logsumexp(int N, int a2)
+{
+	std::vector<double> log_ws;
+	pf_random_log_weights(N, log_ws);
+
+	const long REPS = std::max(10, 10000000 / N);
+	double dummy = 0;
+	CTicTac tictac;
+	for (long i = 0; i < REPS; i++)
+		dummy += CParticleFilterCapable::logSumExp(log_ws);
+	const double T = tictac.Tac() / REPS;
+	if (dummy == 0) cout << "";  // avoid optimizing out the loop
+	return T;
+}
+
+double pf_test_ess(int N, int a2)
+{
+	std::vector<double> log_ws;
+	pf_random_log_weights(N, log_ws);
+
+	const long REPS = std::max(10, 10000000 / N);
+	double dummy = 0;
+	CTicTac tictac;
+	for (long i = 0; i < REPS; i++)
+		dummy += CParticleFilterCapable::computeESS(log_ws);
+	const double T = tictac.Tac() / REPS;
+	if (dummy == 0) cout << "";  // avoid optimizing out the loop
+	return T;
+}
+
+// ------------------------------------------------------
+// register_tests_particle_filter
+// ------------------------------------------------------
+void register_tests_particle_filter()
+{
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prMultinomial (N=100)",
+			pf_test_resample<CParticleFilter::prMultinomial>, 100));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prMultinomial (N=1k)",
+			pf_test_resample<CParticleFilter::prMultinomial>, 1000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prMultinomial (N=10k)",
+			pf_test_resample<CParticleFilter::prMultinomial>, 10000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prMultinomial (N=100k)",
+			pf_test_resample<CParticleFilter::prMultinomial>, 100000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prMultinomial (N=1M)",
+			pf_test_resample<CParticleFilter::prMultinomial>, 1000000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prResidual (N=100)",
+			pf_test_resample<CParticleFilter::prResidual>, 100));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prResidual (N=1k)",
+			pf_test_resample<CParticleFilter::prResidual>, 1000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prResidual (N=10k)",
+			pf_test_resample<CParticleFilter::prResidual>, 10000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prResidual (N=100k)",
+			pf_test_resample<CParticleFilter::prResidual>, 100000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prResidual (N=1M)",
+			pf_test_resample<CParticleFilter::prResidual>, 1000000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prStratified (N=100)",
+			pf_test_resample<CParticleFilter::prStratified>, 100));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prStratified (N=1k)",
+			pf_test_resample<CParticleFilter::prStratified>, 1000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prStratified (N=10k)",
+			pf_test_resample<CParticleFilter::prStratified>, 10000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prStratified (N=100k)",
+			pf_test_resample<CParticleFilter::prStratified>, 100000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prStratified (N=1M)",
+			pf_test_resample<CParticleFilter::prStratified>, 1000000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prSystematic (N=100)",
+			pf_test_resample<CParticleFilter::prSystematic>, 100));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prSystematic (N=1k)",
+			pf_test_resample<CParticleFilter::prSystematic>, 1000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prSystematic (N=10k)",
+			pf_test_resample<CParticleFilter::prSystematic>, 10000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prSystematic (N=100k)",
+			pf_test_resample<CParticleFilter::prSystematic>, 100000));
+	lstTests.push_back(
+		TestData(
+			"pf: resampling prSystematic (N=1M)",
+			pf_test_resample<CParticleFilter::prSystematic>, 1000000));
+	lstTests.push_back(
+		TestData("pf: logSumExp (N=100)", pf_test_logsumexp, 100));
+	lstTests.push_back(
+		TestData("pf: logSumExp (N=1k)", pf_test_logsumexp, 1000));
+	lstTests.push_back(
+		TestData("pf: logSumExp (N=10k)", pf_test_logsumexp, 10000));
+	lstTests.push_back(
+		TestData("pf: logSumExp (N=100k)", pf_test_logsumexp, 100000));
+	lstTests.push_back(
+		TestData("pf: logSumExp (N=1M)", pf_test_logsumexp, 1000000));
+	lstTests.push_back(TestData("pf: computeESS (N=100)", pf_test_ess, 100));
+	lstTests.push_back(TestData("pf: computeESS (N=1k)", pf_test_ess, 1000));
+	lstTests.push_back(TestData("pf: computeESS (N=10k)", pf_test_ess, 10000));
+	lstTests.push_back(
+		TestData("pf: computeESS (N=100k)", pf_test_ess, 100000));
+	lstTests.push_back(TestData("pf: computeESS (N=1M)", pf_test_ess, 1000000));
+}
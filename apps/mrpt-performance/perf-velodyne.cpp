@@ -0,0 +1,162 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/hwdrivers/CVelodyneScanner.h>
+#include <mrpt/obs/CObservationVelodyneScan.h>
+#include <mrpt/poses/CPose3DInterpolator.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/system/filesystem.h>
+#include <mrpt/config.h>
+#include <memory>
+
+#include "common.h"
+
+using namespace mrpt::obs;
+using namespace mrpt::hwdrivers;
+using namespace std;
+
+static const string velodyne_pcap_files[2] = {
+#ifdef MRPT_TESTS_DATA_DIR
+	MRPT_TESTS_DATA_DIR "/sample_velodyne_vlp16_gps.pcap",
+	MRPT_TESTS_DATA_DIR "/sample_velodyne_hdl32.pcap"
+#else
+	"", ""
+#endif
+};
+
+// model: 0=VLP16, 1=HDL32. Scans are read once from the PCAP files.
+static const vector<CObservationVelodyneScan::Ptr>& loadVelodyneScans(
+	int model)
+{
+	static vector<CObservationVelodyneScan::Ptr> scans[2];
+	auto& lst = scans[model];
+	if (!lst.empty()) return lst;
+
+	CVelodyneScanner velodyne;
+	velodyne.setModelName(
+		model == 0 ? CVelodyneScanner::VLP16 : CVelodyneScanner::HDL32);
+	velodyne.setPCAPInputFile(velodyne_pcap_files[model]);
+	velodyne.setPCAPInputFileReadOnce(true);
+	velodyne.enableVerbose(false);
+	velodyne.setPCAPVerbosity(false);
+	velodyne.initialize();
+
+	bool rx_ok = true;
+	for (size_t i = 0; i < 1000 && rx_ok; i++)
+	{
+		CObservationVelodyneScan::Ptr scan;
+		CObservationGPS::Ptr gps;
+		rx_ok = velodyne.getNextObservation(scan, gps);
+		if (scan) lst.push_back(scan);
+	}
+	return lst;
+}
+
+// num_threads: 0,1 => single-threaded, >1 => thread pool
+double velodyne_test_generatePointCloud(int model, int num_threads)
+{
+	const auto& scans = loadVelodyneScans(model);
+	if (scans.empty()) return 0;
+
+	std::unique_ptr<mrpt::system::CWorkerThreadsPool> pool;
+	if (num_threads > 1)
+		pool.reset(new mrpt::system::CWorkerThreadsPool(num_threads - 1));
+
+	CObservationVelodyneScan::TGeneratePointCloudParameters p;
+	p.threadPool = pool.get();
+
+	const int N = 20;
+	CTicTac tictac;
+	for (int it = 0; it < N; it++)
+		for (const auto& scan : scans) scan->generatePointCloud(p);
+	return tictac.Tac() / (N * scans.size());
+}
+
+double velodyne_test_generatePointCloudAlongSE3Trajectory(
+	int model, int num_threads)
+{
+	const auto& scans = loadVelodyneScans(model);
+	if (scans.empty()) return 0;
+
+	std::unique_ptr<mrpt::system::CWorkerThreadsPool> pool;
+	if (num_threads > 1)
+		pool.reset(new mrpt::system::CWorkerThreadsPool(num_threads - 1));
+
+	CObservationVelodyneScan::TGeneratePointCloudParameters p;
+	p.threadPool = pool.get();
+
+	// A vehicle moving at 10 m/s during all the scans:
+	mrpt::poses::CPose3DInterpolator path;
+	const auto t0 = scans.front()->timestamp;
+	const double duration = mrpt::system::timeDifference(
+		t0, mrpt::system::timestampAdd(scans.back()->timestamp, 0.2));
+	for (double t = -0.1; t < duration; t += 0.01)
+		path.insert(
+			mrpt::system::timestampAdd(t0, t),
+			mrpt::math::TPose3D(10 * t, 0, 0, 0.1 * t, 0, 0));
+
+	std::vector<mrpt::math::TPointXYZIu8> pts;
+	const int N = 20;
+	CTicTac tictac;
+	for (int it = 0; it < N; it++)
+		for (const auto& scan : scans)
+		{
+			pts.clear();
+			CObservationVelodyneScan::TGeneratePointCloudSE3Results res;
+			scan->generatePointCloudAlongSE3Trajectory(path, pts, res, p);
+		}
+	return tictac.Tac() / (N * scans.size());
+}
+
+// ------------------------------------------------------
+// register_tests_velodyne
+// ------------------------------------------------------
+void register_tests_velodyne()
+{
+#if MRPT_HAS_LIBPCAP
+	if (mrpt::system::fileExists(velodyne_pcap_files[0]))
+	{
+		lstTests.push_back(
+			TestData(
+				"velodyne: VLP16 scan->point cloud, 1 thread",
+				velodyne_test_generatePointCloud, 0, 1));
+		lstTests.push_back(
+			TestData(
+				"velodyne: VLP16 scan->point cloud, 4 threads",
+				velodyne_test_generatePointCloud, 0, 4));
+		lstTests.push_back(
+			TestData(
+				"velodyne: VLP16 scan->points along SE3 path, 1 thread",
+				velodyne_test_generatePointCloudAlongSE3Trajectory, 0, 1));
+		lstTests.push_back(
+			TestData(
+				"velodyne: VLP16 scan->points along SE3 path, 4 threads",
+				velodyne_test_generatePointCloudAlongSE3Trajectory, 0, 4));
+	}
+	if (mrpt::system::fileExists(velodyne_pcap_files[1]))
+	{
+		lstTests.push_back(
+			TestData(
+				"velodyne: HDL32 scan->point cloud, 1 thread",
+				velodyne_test_generatePointCloud, 1, 1));
+		lstTests.push_back(
+			TestData(
+				"velodyne: HDL32 scan->point cloud, 4 threads",
+				velodyne_test_generatePointCloud, 1, 4));
+		lstTests.push_back(
+			TestData(
+				"velodyne: HDL32 scan->points along SE3 path, 1 thread",
+				velodyne_test_generatePointCloudAlongSE3Trajectory, 1, 1));
+		lstTests.push_back(
+			TestData(
+				"velodyne: HDL32 scan->points along SE3 path, 4 threads",
+				velodyne_test_generatePointCloudAlongSE3Trajectory, 1, 4));
+	}
+#endif
+}
@@ -0,0 +1,74 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "rawlog-edit-declarations.h"
+#include <mrpt/obs/CRawlogIndexedReader.h>
+#include <mrpt/system/CTicTac.h>
+#include <map>
+
+using namespace mrpt;
+using namespace mrpt::obs;
+using namespace mrpt::system;
+using namespace mrpt::rawlogtools;
+using namespace std;
+using namespace mrpt::io;
+
+// ======================================================================
+//		op_build_index
+// ======================================================================
+DECLARE_OP_FUNCTION(op_build_index)
+{
+	MRPT_UNUSED_PARAM(in_rawlog);
+
+	string input_rawlog;
+	getArgValue<std::string>(cmdline, "input", input_rawlog);
+
+	// Remove any previous index, so it's built again:
+	const string idxFile = CRawlogIndexedReader::getIndexFileName(input_rawlog);
+	if (fileExists(idxFile) && !deleteFile(idxFile))
+		throw std::runtime_error("build-index: Cannot delete old index file.");
+
+	CTicTac tictac;
+	CRawlogIndexedReader rawlog;
+	if (!rawlog.open(input_rawlog))
+		throw std::runtime_error("build-index: Cannot open input file.");
+	const double t = tictac.Tac();
+
+	if (!fileExists(idxFile))
+		throw std::runtime_error(
+			"build-index: Cannot write index file: " + idxFile);
+
+	// Dump statistics:
+	// ---------------------------------
+	map<string, size_t> entriesPerClass;
+	TTimeStamp t0 = INVALID_TIMESTAMP, t1 = INVALID_TIMESTAMP;
+	for (size_t i = 0; i < rawlog.size(); i++)
+	{
+		entriesPerClass[rawlog.getEntryClassName(i)]++;
+		const TTimeStamp ti = rawlog.getEntryTimestamp(i);
+		if (ti == INVALID_TIMESTAMP) continue;
+		if (t0 == INVALID_TIMESTAMP || ti < t0) t0 = ti;
+		if (t1 == INVALID_TIMESTAMP || ti > t1) t1 = ti;
+	}
+
+	VERBOSE_COUT << "Index written to                  : " << idxFile << "\n";
+	VERBOSE_COUT << "Time to build index (sec)         : " << t << "\n";
+	VERBOSE_COUT << "Indexed entries                   : " << rawlog.size()
+				 << "\n";
+	if (t0 != INVALID_TIMESTAMP)
+	{
+		VERBOSE_COUT << "First timestamp                   : "
+					 << dateTimeLocalToString(t0) << "\n";
+		VERBOSE_COUT << "Last timestamp                    : "
+					 << dateTimeLocalToString(t1) << "\n";
+	}
+	for (const auto& e : entriesPerClass)
+		VERBOSE_COUT << "Entries of class " << e.first << ": " << e.second
+					 << "\n";
+}
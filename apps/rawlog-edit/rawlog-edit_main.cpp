@@ -67,6 +67,7 @@ DECLARE_OP_FUNCTION(op_stereo_rectify);
 DECLARE_OP_FUNCTION(op_rename_externals);
 DECLARE_OP_FUNCTION(op_list_timestamps);
 DECLARE_OP_FUNCTION(op_remap_timestamps);
+DECLARE_OP_FUNCTION(op_build_index);
 
 // Declare the supported command line switches ===========
 TCLAP::CmdLine cmd(
@@ -201,6 +202,16 @@ int main(int argc, char** argv)
 				cmd, false));
 		ops_functors["list-timestamps"] = &op_list_timestamps;
 
+		arg_ops.push_back(
+			new TCLAP::SwitchArg(
+				"", "build-index",
+				"Op: builds (or rebuilds) the index file `<input>.idx` used "
+				"for fast random access to the rawlog entries (see "
+				"mrpt::obs::CRawlogIndexedReader), and prints a summary of "
+				"its contents.",
+				cmd, false));
+		ops_functors["build-index"] = &op_build_index;
+
 		arg_ops.push_back(
 			new TCLAP::ValueArg<std::string>(
 				"", "remap-timestamps",
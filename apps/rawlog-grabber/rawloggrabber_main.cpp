@@ -18,7 +18,8 @@
 
 #include <mrpt/hwdrivers/CGenericSensor.h>
 #include <mrpt/config/CConfigFile.h>
-#include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/containers/bounded_mpmc_queue.h>
+#include <mrpt/io/CFileBlockGZOutputStream.h>
 #include <mrpt/img/CImage.h>
 #include <mrpt/core/round.h>
 #include <mrpt/obs/CActionCollection.h>
@@ -61,8 +62,10 @@ struct TThreadParams
 
 void SensorThread(TThreadParams params);
 
-CGenericSensor::TListObservations global_list_obs;
-std::mutex cs_global_list_obs;
+// Observations from all sensor threads, to be saved by the main thread.
+// Lock-free, so fast sensors do not contend with each other:
+mrpt::containers::bounded_mpmc_queue<CGenericSensor::TListObsPair>
+	global_obs_queue(1 << 16);
 
 bool allThreadsMustExit = false;
 
@@ -107,6 +110,8 @@ int main(int argc, char** argv)
 		int GRABBER_PERIOD_MS = 1000;
 		int rawlog_GZ_compress_level =
 			1;  // 0: No compress, 1-9: compress level
+		// Threads compressing the rawlog (0: as many as CPU cores)
+		int rawlog_GZ_num_threads = 0;
 
 		MRPT_LOAD_CONFIG_VAR(
 			rawlog_prefix, string, iniFile, GLOBAL_SECTION_NAME);
@@ -121,6 +126,8 @@ int main(int argc, char** argv)
 
 		MRPT_LOAD_CONFIG_VAR(
 			rawlog_GZ_compress_level, int, iniFile, GLOBAL_SECTION_NAME);
+		MRPT_LOAD_CONFIG_VAR(
+			rawlog_GZ_num_threads, int, iniFile, GLOBAL_SECTION_NAME);
 
 		// Build full rawlog file name:
 		string rawlog_postfix = "_";
@@ -183,12 +190,21 @@ int main(int argc, char** argv)
 		// ----------------------------------------------
 		// Run:
 		// ----------------------------------------------
-		mrpt::io::CFileGZOutputStream out_file;
+		// Blocks are compressed in parallel, and the output is still a
+		// regular .gz file, readable by all rawlog tools:
+		mrpt::io::CFileBlockGZOutputStream out_file;
 		auto out_arch = archiveFrom(out_file);
 
-		out_file.open(rawlog_filename, rawlog_GZ_compress_level);
+		ASSERT_(rawlog_GZ_num_threads >= 0);
+		if (!out_file.open(
+				rawlog_filename, rawlog_GZ_compress_level,
+				static_cast<unsigned int>(rawlog_GZ_num_threads)))
+			THROW_EXCEPTION_FMT(
+				"Error creating rawlog file: '%s'", rawlog_filename.c_str());
 
 		CSensoryFrame curSF;
+		// Observations received but not saved yet, sorted by timestamp:
+		CGenericSensor::TListObservations pending_obs;
 		CGenericSensor::TListObservations copy_of_global_list_obs;
 
 		cout << endl << "Press any key to exit program" << endl;
@@ -196,19 +212,22 @@ int main(int argc, char** argv)
 		{
 			// See if we have observations and process them:
 			{
-				std::lock_guard<std::mutex> lock(cs_global_list_obs);
-				copy_of_global_list_obs.clear();
+				CGenericSensor::TListObsPair obs;
+				while (global_obs_queue.try_pop(obs))
+					pending_obs.insert(std::move(obs));
 
-				if (!global_list_obs.empty())
+				// Save the older half, so observations from all sensors
+				// are saved in timestamp order:
+				copy_of_global_list_obs.clear();
+				if (!pending_obs.empty())
 				{
 					CGenericSensor::TListObservations::iterator itEnd =
-						global_list_obs.begin();
-					std::advance(itEnd, global_list_obs.size() / 2);
-					copy_of_global_list_obs.insert(
-						global_list_obs.begin(), itEnd);
-					global_list_obs.erase(global_list_obs.begin(), itEnd);
+						pending_obs.begin();
+					std::advance(itEnd, pending_obs.size() / 2);
+					copy_of_global_list_obs.insert(pending_obs.begin(), itEnd);
+					pending_obs.erase(pending_obs.begin(), itEnd);
 				}
-			}  // End of cs lock
+			}
 
 			if (use_sensoryframes)
 			{
@@ -452,6 +471,12 @@ int main(int argc, char** argv)
 		// Flush file to disk:
 		out_file.close();
 
+		const auto qs = global_obs_queue.getStats();
+		cout << "Observations queue: " << qs.n_push << " received, max. "
+			 << qs.max_size << " waiting (capacity: "
+			 << global_obs_queue.capacity() << "), " << qs.n_push_full
+			 << " times full.\n";
+
 		// Wait all threads:
 		// ----------------------------
 		allThreadsMustExit = true;
@@ -526,9 +551,15 @@ void SensorThread(TThreadParams params)
 			CGenericSensor::TListObservations lstObjs;
 			sensor->getObservations(lstObjs);
 
+			// If the queue is full, wait for the main thread (backpressure)
+			// unless we are exiting:
+			for (const auto& o : lstObjs)
 			{
-				std::lock_guard<std::mutex> lock(cs_global_list_obs);
-				global_list_obs.insert(lstObjs.begin(), lstObjs.end());
+				CGenericSensor::TListObsPair obs(o.first, o.second);
+				while (!global_obs_queue.push(std::move(obs), 100ms) &&
+					   !allThreadsMustExit)
+				{
+				}
 			}
 
 			lstObjs.clear();
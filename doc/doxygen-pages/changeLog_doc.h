@@ -53,16 +53,59 @@ initializator
 			- Removed the include file: `<mrpt/math/jacobians.h>`. Replace by
 `<mrpt/math/num_jacobian.h>` or individual methods in \ref mrpt_poses_grp
 classes.
+			- New robust kernels mrpt::math::rkHuber and mrpt::math::rkCauchy.
 		- \ref mrpt_config_grp  [NEW IN MRPT 2.0.0]
 			- mrpt::config::CConfigFileBase::write() now supports enum types.
 		- \ref mrpt_serialization_grp  [NEW IN MRPT 2.0.0]
 			- New method mrpt::serialization::CArchive::ReadPOD() and macro
 `MRPT_READ_POD()` for reading unaligned POD variables.-
 			- Add support for `$env{}` syntax to evaluate environment variables.
+			- mrpt::serialization::CArchive::WriteBufferFixEndianness() and
+mrpt::serialization::CArchive::ReadBufferFixEndianness() convert big endian
+data in blocks instead of element by element. mrpt::math::CMatrix and
+mrpt::math::CMatrixD are (de)serialized with one single bulk I/O operation.
+		- \ref mrpt_bayes_grp
+			- mrpt::bayes::CParticleFilterCapable::computeResampling(): all
+resampling methods now run in linear time (multinomial draws no longer sort
+random numbers) and can reuse a user-provided workspace.
+			- New methods mrpt::bayes::CParticleFilterCapable::logSumExp() and
+mrpt::bayes::CParticleFilterCapable::computeESS(), with AVX2 code paths.
+			- Numerically-stable ESS() and log2linearWeights() for log-weights
+far from zero.
 		- \ref mrpt_slam_grp
 			- rbpf-slam: Add support for simplemap continuation.
 			- CICP: parameter `onlyClosestCorrespondences` deleted (always true
 now).
+			- Particle filters based on mrpt::slam::PF_implementation
+(localization and RBPF-SLAM) can now propagate and weight particles in
+parallel. See the new option
+mrpt::bayes::CParticleFilter::TParticleFilterOptions::numThreads.
+			- mrpt::slam::CICP: correspondences can be searched in parallel
+(new option `numThreads`), and new 3D method `icpPointToPlane`.
+		- \ref mrpt_graphslam_grp
+			- mrpt::graphslam::optimize_graph_spa_levmarq(): the Hessian is
+assembled into a block sparse structure computed only once per graph, whose
+symbolic Cholesky decomposition is reused along iterations, and constraints
+can be evaluated in parallel (new parameter `num_threads`).
+			- New incremental pose-graph solver
+mrpt::graphslam::CIncrementalPoseGraphSolver, which updates the Cholesky
+factor with new nodes/edges and only relinearizes the nodes that moved, and
+the optimizer mrpt::graphslam::optimizers::CIncrementalGSO for
+`graphslam-engine` built on it.
+			- mrpt::graphslam::deciders::CLoopCloserERD runs the ICP alignments
+of loop closure hypotheses and scan-matching edges, and the pair-wise
+consistency matrix, in a thread pool (new parameter `LC_num_threads`,
+default: 1, i.e. serial). The
+points maps (and KD-trees) of the node scans are kept among alignments, and
+Dijkstra links are computed once per pair of nodes.
+		- \ref mrpt_poses_grp
+			- mrpt::poses::CPoseRandomSampler::drawSample() accepts a
+user-provided random generator.
+			- New batch methods mrpt::poses::CPose3D::composePoints(),
+mrpt::poses::CPose3D::inverseComposePoints() and
+mrpt::poses::CPose3D::composePoses() (and their mrpt::poses::CPose2D
+counterparts) for structure-of-arrays buffers, with AVX2 code paths. Used
+to transform point maps, insert them into each other and load 3D scans.
 		- \ref mrpt_nav_grp
 			- Removed deprecated mrpt::nav::THolonomicMethod.
 			- mrpt::nav::CAbstractNavigator: callbacks in
@@ -70,18 +113,130 @@ mrpt::nav::CRobot2NavInterface are now invoked *after* `navigationStep()` to
 avoid problems if user code invokes the navigator API to change its state.
 			- Added methods to load/save mrpt::nav::TWaypointSequence to
 configuration files.
+			- mrpt::nav::CAbstractPTGBasedReactive builds the TP-Obstacles of all
+PTGs in parallel (new parameter `num_threads`, default: 1, i.e. serial) from
+structure-of-arrays obstacle buffers, through the new batch method
+mrpt::nav::CParameterizedTrajectoryGenerator::updateTPObstacleBatch(), which
+also splits the obstacle points in chunks for PTGs based on collision grids.
+Its wall time is logged in mrpt::nav::CLogFileRecord as
+`timeForTPObsTransformation_allPTGs`.
+			- mrpt::nav::CPTG_DiffDrive_CollisionGridBased: collision grids are
+cached in a new flat, uncompressed file format which is memory-mapped
+read-only instead of parsed, and shared among processes. Cache files in the
+former format are converted upon load.
+			- New method
+mrpt::nav::CParameterizedTrajectoryGenerator::updateClearanceBatch(), which
+evaluates clearance diagrams for all obstacles at once, skipping obstacles
+that can not reduce the clearance and evaluating decimated paths in parallel.
+Used in the reactive navigators, with ~15x speed-ups for typical PTG sets
+(see the new `nav:` tests in mrpt-performance).
+		- \ref mrpt_system_grp
+			- New class mrpt::system::CWorkerThreadsPool.
+			- mrpt::system::CTimeLogger: new hierarchical mode, with per-thread
+call trees of nested sections, section IDs interned once per call site
+(MRPT_TIME_LOGGER_SCOPE()) and export to the Chrome trace format. The
+name-based API and mrpt::system::CTimeLoggerEntry work on top of it.
+		- \ref mrpt_io_grp
+			- mrpt::io::CFileGZInputStream now implements Seek().
+			- New class mrpt::io::CMemoryMappedFile.
+			- New class mrpt::io::CFileMappedInputStream, for deserializing large
+objects straight from memory-mapped files.
+			- mrpt::io::CMemoryStream: the buffer grows geometrically while
+writing, so serializing large objects takes linear time. Fixed
+getTotalBytesCount() for memory blocks assigned with
+mrpt::io::CMemoryStream::assignMemoryNotOwn() and Seek() from the end.
+			- New classes mrpt::io::CFileBlockGZOutputStream and
+mrpt::io::CFileBlockGZInputStream, for gzip files made of independently
+compressed blocks, which are deflated/inflated in parallel and allow fast
+seeking. Files remain readable by mrpt::io::CFileGZInputStream and all rawlog
+tools. `rawlog-grabber` now writes rawlogs this way, with the new option
+`rawlog_GZ_num_threads`.
+		- \ref mrpt_containers_grp
+			- New lock-free queue mrpt::containers::bounded_mpmc_queue, used
+by `rawlog-grabber` and `icp-slam-live` to pass observations from sensor
+threads.
 		- \ref mrpt_comms_grp [NEW IN MRPT 2.0.0]
 			- This new module has been created to hold all serial devices &
 networking classes, with minimal dependencies.
 		- \ref mrpt_maps_grp
 			- Added optional "channel" attribute to CReflectivityGrdMap2D and
 CObservationReflectivity to support different colors of light.
+			- New batch method
+mrpt::maps::COccupancyGridMap2D::computeLikelihoodField_Thrun() evaluating a
+whole set of poses against one scan, using a distance-transform table, AVX2
+gathers and an optional thread pool.
+			- New option
+mrpt::maps::COccupancyGridMap2D::TLikelihoodOptions::LF_useDistanceTransform:
+the likelihood field is kept in a persistent distance transform, updated only
+around the cells modified by new observations.
+			- mrpt::maps::COccupancyGridMap2D stores its cells in copy-on-write
+tiles of rows, shared among map copies (e.g. RBPF particles) until modified.
+			- mrpt::maps::CPointsMap::determineMatching2D() and
+mrpt::maps::CPointsMap::determineMatching3D() can run KD-tree queries in
+parallel via mrpt::maps::TMatchingParams::threadPool.
+			- New point cloud filters mrpt::maps::CPointCloudFilterVoxelGrid
+and mrpt::maps::CPointCloudFilterRandomSubsample.
+			- New option
+mrpt::maps::CPointsMap::TInsertionOptions::insertionFilter to filter 3D range
+and Velodyne scans before inserting them into point maps. The filter is shared
+by map copies, so both new filters are safe to call concurrently.
+		- \ref mrpt_obs_grp
+			- mrpt::obs::CObservation3DRangeScan: in
+project3DPointsFromDepthImageInto(), range filtering uses AVX2 if available
+and no longer needs image widths multiple of 8, the output is resized only
+once, and there are new options
+mrpt::obs::T3DPointsProjectionParams::decimation and
+mrpt::obs::T3DPointsProjectionParams::threadPool.
+			- New class mrpt::obs::CRawlogIndexedReader for random and
+sequential access to large rawlogs without loading them into memory, with a
+cached index file and read-ahead in a background thread. New rawlog-edit
+operation `--build-index`.
+			- mrpt::obs::CObservationVelodyneScan::generatePointCloud() and
+mrpt::obs::CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory()
+use per-laser tables precomputed from the calibration, decode packets straight
+into the pre-sized output arrays, and can decode in parallel with the new
+option
+mrpt::obs::CObservationVelodyneScan::TGeneratePointCloudParameters::threadPool.
+		- \ref mrpt_vision_grp
+			- New class mrpt::vision::CDescriptorMatrix, with the descriptors of
+a mrpt::vision::CFeatureList packed in one aligned block of memory, and
+brute-force matchers mrpt::vision::match_descriptors_brute_force() and
+mrpt::vision::match_features_brute_force(), with POPCNT/AVX2 Hamming and
+SSE2/AVX2 L2 kernels, ratio test, cross-check and an optional thread pool.
+mrpt::vision::CFeature::descriptorORBDistanceTo() uses the same kernel.
+			- mrpt::vision::CFeatureExtraction: new
+mrpt::vision::CFeatureExtraction::TOptions::tilingOptions, for a tiled
+extraction of FAST, FASTER, ORB, Harris and KLT features: per-cell budgets,
+non-maximum suppression across cells and an optional thread pool. Also
+available for any detector via
+mrpt::vision::CFeatureExtraction::detectFeaturesTiled().
+			- mrpt::vision::CImagePyramid: octave images are reused (no
+allocations) when rebuilt with images of the same size, optional per-octave
+SSE2/AVX2 gradients (mrpt::vision::CImagePyramid::computeGradients()), and
+building in a background thread with
+mrpt::vision::CImagePyramid::buildPyramidAsync().
+mrpt::img::CImage::scaleHalf(), mrpt::img::CImage::scaleHalfSmooth(),
+mrpt::img::CImage::grayscale() and the copy operator reuse the buffer of the
+output image, and the SSE2 half-scaling works for any image width and row
+padding. mrpt::vision::CFeatureTracker_KL keeps its pyramid buffers between
+frames.
+			- mrpt::vision::bundle_adj_full() builds the Schur-reduced camera system
+as a block-sparse matrix with a precomputed structure (its cost no longer
+grows with frames x landmarks), weights the Hessian with the robust kernel
+(IRLS), and runs residuals, Jacobians, Hessian blocks and the landmark
+back-substitution in parallel (new parameter "num_threads"). New
+"robust_kernel_type" parameter.
 		- \ref mrpt_hwdrivers_grp
 			- COpenNI2Generic: is safer in multithreading apps.
 			- CHokuyoURG:
 				- Rewrite driver to be safer and reduce mem allocs.
 				- New parameter `scan_interval` to decimate scans.
 	- BUG FIXES:
+		- Fix mrpt::math::CSparseMatrix::swap() not swapping the number of
+columns.
+		- Fix wrong 3D points from
+mrpt::obs::CObservation3DRangeScan::project3DPointsFromDepthImageInto() with
+a LUT and the non-SSE2 code path, if there were invalid ranges.
 		- Fix reactive navigator inconsistent state if navigation API is called
 from within rnav callbacks.
 		- Fix incorrect evaluation of "ASSERT" formulas in
@@ -163,6 +163,18 @@ class CParticleFilter : public mrpt::system::COutputLogger
 		 * perform rejection sampling, but just the most-likely (ML) particle
 		 * found in the preliminary weight-determination stage. */
 		bool pfAuxFilterOptimal_MLE{false};
+
+		/** Number of threads used to propagate particles and evaluate their
+		 * weights, in those algorithms that support it (default=1: serial
+		 * execution). Use 0 to use all hardware threads.
+		 * With more than one thread, random samples are drawn from
+		 * per-block generators seeded from mrpt::random::getRandomGenerator(),
+		 * so results are reproducible and independent of the number of
+		 * threads (but different from the serial ones). The observation
+		 * likelihood of the maps must be safe to evaluate concurrently.
+		 * \note [New in MRPT 2.0.0]
+		 */
+		unsigned int numThreads{1};
 	};
 
 	/** Statistics for being returned from the "execute" method. */
@@ -210,6 +210,11 @@ class CParticleFilterCapable
 	 * output samples is the same than the input population.
 	  *  This generic method just computes these indexes, to actually perform a
 	 * resampling in a particle filter object, call performResampling
+	  *
+	  * All methods run in O(N+M) time, for N input and M output particles.
+	  * The indexes of the multinomial, stratified and systematic methods are
+	  * returned in ascending order; for prResidual, the deterministic part
+	  * comes first, followed by the (ascending) randomly drawn residual part.
 	  * \param[in] out_particle_count The desired number of output particles
 	 * after resampling; 0 means don't modify the current number.
 	  * \sa performResampling
@@ -219,14 +224,43 @@ class CParticleFilterCapable
 		const std::vector<double>& in_logWeights,
 		std::vector<size_t>& out_indexes, size_t out_particle_count = 0);
 
+	/** \overload Using the user-provided `workspace` as temporary storage, so
+	 * repeated calls with populations of similar size do not allocate memory
+	 * (neither do they for `out_indexes`, if it is also reused).
+	 * \note [New in MRPT 2.0.0]
+	 */
+	static void computeResampling(
+		CParticleFilter::TParticleResamplingAlgorithm method,
+		const std::vector<double>& in_logWeights,
+		std::vector<size_t>& out_indexes, std::vector<double>& workspace,
+		size_t out_particle_count = 0);
+
 	/** A static method to compute the linear, normalized (the sum the unity)
-	 * weights from log-weights.
-	  * \sa performResampling
+	 * weights from log-weights. Log-weights are shifted by their maximum
+	 * before exponentiation, so they can take any (finite) range.
+	  * \return The log of the sum of the linear (unnormalized) weights, i.e.
+	  * \f$ \log \sum_i e^{lw_i} \f$.
+	  * \sa performResampling, logSumExp
 	  */
-	static void log2linearWeights(
+	static double log2linearWeights(
 		const std::vector<double>& in_logWeights,
 		std::vector<double>& out_linWeights);
 
+	/** Computes \f$ \log \sum_i e^{lw_i} \f$ in a numerically-stable way,
+	 * with SIMD instructions if available. Returns -infinity for an empty
+	 * input.
+	 * \note [New in MRPT 2.0.0]
+	 */
+	static double logSumExp(const std::vector<double>& in_logWeights);
+
+	/** Computes the normalized ESS (Estimated Sample Size), in the range
+	 * [0,1], of a set of log-weights, which need not be normalized.
+	 * Uses SIMD instructions if available.
+	 * \note [New in MRPT 2.0.0]
+	 * \sa ESS
+	 */
+	static double computeESS(const std::vector<double>& in_logWeights);
+
    protected:
 	/** Performs the particle filter prediction/update stages for the algorithm
 	 * "pfStandardProposal" (if not implemented in heritated class, it will
@@ -285,6 +319,10 @@ class CParticleFilterCapable
 
 		std::vector<uint32_t> alreadyDrawnIndexes;
 		size_t alreadyDrawnNextOne;
+
+		/** Temporary buffers for resampling, kept to avoid reallocations */
+		std::vector<double> resamplingLogW, resamplingWorkspace;
+		std::vector<size_t> resamplingIndexes;
 	};
 
 	/** Auxiliary vectors, see CParticleFilterCapable::prepareFastDrawSample for
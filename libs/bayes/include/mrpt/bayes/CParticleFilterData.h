@@ -88,24 +88,21 @@ struct CParticleFilterDataImpl : public CParticleFilterCapable
 	double ESS() const override
 	{
 		MRPT_START
-		double cum = 0;
+		const auto& parts = derived().m_particles;
+		if (parts.empty()) return 0;
 
-		/* Sum of weights: */
-		double sumLinearWeights = 0;
-		for (typename particle_list_t::const_iterator it =
-				 derived().m_particles.begin();
-			 it != derived().m_particles.end(); ++it)
-			sumLinearWeights += std::exp(it->log_w);
-		/* Compute ESS: */
-		for (typename particle_list_t::const_iterator it =
-				 derived().m_particles.begin();
-			 it != derived().m_particles.end(); ++it)
-			cum += mrpt::square(std::exp(it->log_w) / sumLinearWeights);
-
-		if (cum == 0)
-			return 0;
-		else
-			return 1.0 / (derived().m_particles.size() * cum);
+		/* ESS = (sum w_i)^2 / (N * sum w_i^2), invariant to the scale of w_i,
+		 * so weights are shifted by the max. log_w to avoid underflows: */
+		double maxW = parts.begin()->log_w;
+		for (const auto& p : parts) maxW = std::max<double>(maxW, p.log_w);
+		double sumW = 0, sumW2 = 0;
+		for (const auto& p : parts)
+		{
+			const double w = std::exp(p.log_w - maxW);
+			sumW += w;
+			sumW2 += w * w;
+		}
+		return sumW * sumW / (parts.size() * sumW2);
 		MRPT_END
 	}
 
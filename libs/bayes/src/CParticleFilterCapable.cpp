@@ -12,7 +12,15 @@
 #include <mrpt/bayes/CParticleFilterCapable.h>
 #include <mrpt/random.h>
 #include <mrpt/math/ops_vectors.h>
+#include <mrpt/config.h>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
+
+#if MRPT_HAS_AVX2
+#include <immintrin.h>
+#endif
 
 using namespace mrpt;
 using namespace mrpt::bayes;
@@ -36,25 +44,177 @@ void CParticleFilterCapable::performResampling(
 	const size_t in_particle_count = particlesCount();
 	ASSERT_(in_particle_count > 0);
 
-	vector<size_t> indxs;
-	vector<double> log_ws;
-	log_ws.assign(in_particle_count, .0);
+	// (Reuse buffers from previous iterations)
+	vector<size_t>& indxs = m_fastDrawAuxiliary.resamplingIndexes;
+	vector<double>& log_ws = m_fastDrawAuxiliary.resamplingLogW;
+	log_ws.resize(in_particle_count);
 	for (size_t i = 0; i < in_particle_count; i++) log_ws[i] = getW(i);
 
 	// Compute the surviving indexes:
 	computeResampling(
-		PF_options.resamplingMethod, log_ws, indxs, out_particle_count);
+		PF_options.resamplingMethod, log_ws, indxs,
+		m_fastDrawAuxiliary.resamplingWorkspace, out_particle_count);
 
 	// And perform the particle replacement:
 	performSubstitution(indxs);
 
 	// Finally, equal weights:
-	for (size_t i = 0; i < out_particle_count; i++)
+	for (size_t i = 0; i < indxs.size(); i++)
 		setW(i, 0 /* Logarithmic weight */);
 
 	MRPT_END
 }
 
+namespace
+{
+// Maximum of a non-empty array:
+double arrayMaximum(const double* x, const size_t N)
+{
+	size_t i = 0;
+#if MRPT_HAS_AVX2
+	double ret;
+	if (N >= 4)
+	{
+		__m256d m = _mm256_loadu_pd(x);
+		for (i = 4; i + 4 <= N; i += 4)
+			m = _mm256_max_pd(m, _mm256_loadu_pd(x + i));
+		alignas(32) double ms[4];
+		_mm256_store_pd(ms, m);
+		ret = std::max(std::max(ms[0], ms[1]), std::max(ms[2], ms[3]));
+	}
+	else
+		ret = x[i++];
+#else
+	double ret = x[i++];
+#endif
+	for (; i < N; i++) ret = std::max(ret, x[i]);
+	return ret;
+}
+
+#if MRPT_HAS_AVX2
+// exp() of 4 doubles, all of them <=0, with the Cephes rational
+// approximation (~1 ulp). Arguments below ~-708 underflow to 0.
+inline __m256d exp4_nonpositive(__m256d x)
+{
+	const __m256d underflow = _mm256_cmp_pd(
+		x, _mm256_set1_pd(-708.0), _CMP_GE_OQ);
+	x = _mm256_max_pd(x, _mm256_set1_pd(-708.0));
+	// x = n*log(2) + r, with |r| <= log(2)/2:
+	const __m256d n = _mm256_round_pd(
+		_mm256_mul_pd(x, _mm256_set1_pd(1.4426950408889634073599)),
+		_MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	x = _mm256_sub_pd(x, _mm256_mul_pd(n, _mm256_set1_pd(6.93145751953125E-1)));
+	x = _mm256_sub_pd(
+		x, _mm256_mul_pd(n, _mm256_set1_pd(1.42860682030941723212E-6)));
+	const __m256d xx = _mm256_mul_pd(x, x);
+	__m256d p = _mm256_set1_pd(1.26177193074810590878E-4);
+	p = _mm256_add_pd(
+		_mm256_mul_pd(p, xx), _mm256_set1_pd(3.02994407707441961300E-2));
+	p = _mm256_add_pd(
+		_mm256_mul_pd(p, xx), _mm256_set1_pd(9.99999999999999999910E-1));
+	p = _mm256_mul_pd(p, x);
+	__m256d q = _mm256_set1_pd(3.00198505138664455042E-6);
+	q = _mm256_add_pd(
+		_mm256_mul_pd(q, xx), _mm256_set1_pd(2.52448340349684104192E-3));
+	q = _mm256_add_pd(
+		_mm256_mul_pd(q, xx), _mm256_set1_pd(2.27265548208155028766E-1));
+	q = _mm256_add_pd(
+		_mm256_mul_pd(q, xx), _mm256_set1_pd(2.00000000000000000009E0));
+	__m256d r = _mm256_div_pd(p, _mm256_sub_pd(q, p));
+	r = _mm256_add_pd(
+		_mm256_set1_pd(1.0), _mm256_mul_pd(_mm256_set1_pd(2.0), r));
+	// Multiply by 2^n, building the exponent bits of a double:
+	const __m128i ni = _mm256_cvtpd_epi32(n);
+	const __m256i e = _mm256_slli_epi64(
+		_mm256_cvtepi32_epi64(_mm_add_epi32(ni, _mm_set1_epi32(1023))), 52);
+	r = _mm256_mul_pd(r, _mm256_castsi256_pd(e));
+	return _mm256_and_pd(r, underflow);
+}
+#endif
+
+// Computes out[i]=exp(lw[i]-max_lw) (if out!=nullptr), and returns the sum
+// of those values and of their squares:
+void shiftedExpSums(
+	const double* lw, const size_t N, const double max_lw, double* out,
+	double& sum, double& sum_sq)
+{
+	size_t i = 0;
+	sum = sum_sq = 0;
+#if MRPT_HAS_AVX2
+	{
+		const __m256d vmax = _mm256_set1_pd(max_lw);
+		__m256d s = _mm256_setzero_pd(), s2 = _mm256_setzero_pd();
+		for (; i + 4 <= N; i += 4)
+		{
+			const __m256d w = exp4_nonpositive(
+				_mm256_sub_pd(_mm256_loadu_pd(lw + i), vmax));
+			if (out) _mm256_storeu_pd(out + i, w);
+			s = _mm256_add_pd(s, w);
+			s2 = _mm256_add_pd(s2, _mm256_mul_pd(w, w));
+		}
+		alignas(32) double ss[4], ss2[4];
+		_mm256_store_pd(ss, s);
+		_mm256_store_pd(ss2, s2);
+		sum = (ss[0] + ss[1]) + (ss[2] + ss[3]);
+		sum_sq = (ss2[0] + ss2[1]) + (ss2[2] + ss2[3]);
+	}
+#endif
+	for (; i < N; i++)
+	{
+		const double w = std::exp(lw[i] - max_lw);
+		if (out) out[i] = w;
+		sum += w;
+		sum_sq += w * w;
+	}
+}
+
+// Given the CDF of the input weights in Q (with a sentinel >1 in the last
+// entry), finds the bins for the ascending sequence of thresholds
+// T(k), k=0,...,M-1.
+template <class THRESHOLDS>
+void drawFromCDF(
+	const vector<double>& Q, size_t* out_idxs, const size_t M,
+	THRESHOLDS&& T)
+{
+	size_t j = 0;
+	for (size_t k = 0; k < M; k++)
+	{
+		const double t = T(k);
+		while (t >= Q[j]) j++;
+		out_idxs[k] = j;
+	}
+}
+
+// Multinomial resampling: draws M samples from the distribution in the
+// CDF Q. Instead of sorting M uniform samples, they are generated already in
+// descending order as U(M) = V^(1/M), U(k) = U(k+1) * V^(1/k), V~U(0,1].
+void multinomialFromCDF(
+	const vector<double>& Q, size_t* out_idxs, const size_t M)
+{
+	auto& rng = getRandomGenerator();
+	size_t j = Q.size() - 1;
+	double u = 1.0;
+	for (size_t k = M; k > 0; k--)
+	{
+		// V in (0,1] (2^-32 steps), never 0: drawUniform(0,1) may return
+		// exactly 1.0, so 1-drawUniform() could be 0 and u would stay at 0.
+		const double v =
+			(rng.drawUniform32bit() + 1.0) * 2.3283064365386963e-10;
+		u *= std::pow(v, 1.0 / k);
+		while (j > 0 && Q[j - 1] > u) j--;
+		out_idxs[k - 1] = j;
+	}
+}
+
+// In-place cumulative sum of the N weights in W, with a sentinel at the end:
+void weightsToCDF(vector<double>& W)
+{
+	double acc = 0;
+	for (auto& w : W) w = (acc += w);
+	W.back() = 1.1;
+}
+}  // namespace
+
 /*---------------------------------------------------------------
 						resample
  ---------------------------------------------------------------*/
@@ -62,31 +222,30 @@ void CParticleFilterCapable::computeResampling(
 	CParticleFilter::TParticleResamplingAlgorithm method,
 	const vector<double>& in_logWeights, vector<size_t>& out_indexes,
 	size_t out_particle_count)
+{
+	vector<double> workspace;
+	computeResampling(
+		method, in_logWeights, out_indexes, workspace, out_particle_count);
+}
+
+void CParticleFilterCapable::computeResampling(
+	CParticleFilter::TParticleResamplingAlgorithm method,
+	const vector<double>& in_logWeights, vector<size_t>& out_indexes,
+	vector<double>& workspace, size_t out_particle_count)
 {
 	MRPT_START
 
 	// Compute the normalized linear weights:
 	//  The array "linW" will be the input to the actual
 	//  resampling algorithms.
-	size_t i, j, M = in_logWeights.size();
-	ASSERT_(M > 0);
-
-	if (!out_particle_count) out_particle_count = M;
-
-	vector<double> linW(M, 0);
-	vector<double>::const_iterator inIt;
-	vector<double>::iterator outIt;
-	double linW_SUM = 0;
+	const size_t N = in_logWeights.size();
+	ASSERT_(N > 0);
 
-	// This is to avoid float point range problems:
-	double max_log_w = math::maximum(in_logWeights);
-	for (i = 0, inIt = in_logWeights.begin(), outIt = linW.begin(); i < M;
-		 i++, inIt++, outIt++)
-		linW_SUM += ((*outIt) = exp((*inIt) - max_log_w));
+	const size_t M = out_particle_count ? out_particle_count : N;
+	out_indexes.resize(M);
 
-	// Normalize weights:
-	ASSERT_(linW_SUM > 0);
-	linW *= 1.0 / linW_SUM;
+	vector<double>& linW = workspace;
+	log2linearWeights(in_logWeights, linW);
 
 	switch (method)
 	{
@@ -95,34 +254,8 @@ void CParticleFilterCapable::computeResampling(
 			// ==============================================
 			//   Select with replacement
 			// ==============================================
-			vector<double> Q;
-			mrpt::math::cumsum_tmpl<vector<double>, vector<double>, double>(
-				linW, Q);
-			Q[M - 1] = 1.1;
-
-			vector<double> T(M);
-			getRandomGenerator().drawUniformVector(T, 0.0, 0.999999);
-			T.push_back(1.0);
-
-			// Sort:
-			// --------------------
-			sort(T.begin(), T.end());
-
-			out_indexes.resize(out_particle_count);
-			i = j = 0;
-
-			while (i < out_particle_count)
-			{
-				if (T[i] < Q[j])
-				{
-					out_indexes[i++] = (unsigned int)j;
-				}
-				else
-				{
-					j++;
-					if (j >= M) j = M - 1;
-				}
-			}
+			weightsToCDF(linW);
+			multinomialFromCDF(linW, &out_indexes[0], M);
 		}
 		break;  // end of "Select with replacement"
 
@@ -131,67 +264,38 @@ void CParticleFilterCapable::computeResampling(
 			// ==============================================
 			//   prResidual
 			// ==============================================
-			// Repetition counts:
-			std::vector<uint32_t> N(M);
-			size_t R = 0;  // Remainder or residual count
-			for (i = 0; i < M; i++)
+			// Fillout the deterministic part of the resampling, with
+			// floor(M*w_i) copies of each particle, and leave the residual
+			// (unnormalized) weights in linW:
+			size_t M_fixed = 0;
+			for (size_t i = 0; i < N; i++)
 			{
-				N[i] = int(M * linW[i]);
-				R += N[i];
+				const double Mw = M * linW[i];
+				const size_t n = std::min<size_t>(size_t(Mw), M - M_fixed);
+				for (size_t k = 0; k < n; k++) out_indexes[M_fixed++] = i;
+				linW[i] = std::max(0.0, Mw - n);
 			}
-			size_t N_rnd = out_particle_count >= R ? (out_particle_count - R)
-												   : 0;  // # of particles to be
-			// drawn randomly (the
-			// "residual" part)
-
-			// Fillout the deterministic part of the resampling:
-			out_indexes.resize(out_particle_count);
-			for (i = 0, j = 0; i < out_particle_count; i++)
-				for (size_t k = 0; k < N[i]; k++) out_indexes[j++] = i;
-
-			size_t M_fixed = j;
-
-			// Prepare a multinomial resampling with the residual part,
-			//  using the modified weights:
-			// ----------------------------------------------------------
-			if (N_rnd)  // If there are "residual" part (should be virtually
-			// always!)
-			{
-				// Compute modified weights:
-				vector<double> linW_mod(M);
-				const double M_R_1 = 1.0 / N_rnd;
-				for (i = 0; i < M; i++)
-					linW_mod[i] = M_R_1 * (M * linW[i] - N[i]);
-
-				// perform resampling:
-				vector<double> Q;
-				mrpt::math::cumsum_tmpl<vector<double>, vector<double>, double>(
-					linW_mod, Q);
-				Q[M - 1] = 1.1;
-
-				vector<double> T(M);
-				getRandomGenerator().drawUniformVector(T, 0.0, 0.999999);
-				T.push_back(1.0);
-
-				// Sort:
-				sort(T.begin(), T.end());
+			// # of particles to be drawn randomly (the "residual" part):
+			const size_t N_rnd = M - M_fixed;
 
-				i = 0;
-				j = 0;
-
-				while (i < N_rnd)
+			// Multinomial resampling with the residual part:
+			if (N_rnd)
+			{
+				double sumRes = 0;
+				for (const double w : linW) sumRes += w;
+				if (sumRes > 0)
+				{
+					for (auto& w : linW) w /= sumRes;
+					weightsToCDF(linW);
+					multinomialFromCDF(linW, &out_indexes[M_fixed], N_rnd);
+				}
+				else
 				{
-					if (T[i] < Q[j])
-					{
-						out_indexes[M_fixed + i++] = (unsigned int)j;
-					}
-					else
-					{
-						j++;
-						if (j >= M) j = M - 1;
-					}
+					// Only possible due to round-off errors:
+					for (size_t k = M_fixed; k < M; k++)
+						out_indexes[k] = out_indexes[k - M_fixed];
 				}
-			}  // end if N_rnd!=0
+			}
 		}
 		break;
 		case CParticleFilter::prStratified:
@@ -199,36 +303,13 @@ void CParticleFilterCapable::computeResampling(
 			// ==============================================
 			//   prStratified
 			// ==============================================
-			vector<double> Q;
-			mrpt::math::cumsum_tmpl<vector<double>, vector<double>, double>(
-				linW, Q);
-			Q[M - 1] = 1.1;
-
-			// Stratified-uniform random vector:
-			vector<double> T(M + 1);
+			weightsToCDF(linW);
+			// Stratified-uniform random thresholds:
+			auto& rng = getRandomGenerator();
 			const double _1_M = 1.0 / M;
-			const double _1_M_eps = _1_M - 0.000001;
-			double T_offset = 0;
-			for (i = 0; i < M; i++)
-			{
-				T[i] =
-					T_offset + getRandomGenerator().drawUniform(0.0, _1_M_eps);
-				T_offset += _1_M;
-			}
-			T[M] = 1;
-
-			out_indexes.resize(out_particle_count);
-			i = j = 0;
-			while (i < out_particle_count)
-			{
-				if (T[i] < Q[j])
-					out_indexes[i++] = (unsigned int)j;
-				else
-				{
-					j++;
-					if (j >= M) j = M - 1;
-				}
-			}
+			drawFromCDF(linW, &out_indexes[0], M, [&](size_t k) {
+				return (k + rng.drawUniform(0.0, 1.0)) * _1_M;
+			});
 		}
 		break;
 		case CParticleFilter::prSystematic:
@@ -236,30 +317,13 @@ void CParticleFilterCapable::computeResampling(
 			// ==============================================
 			//   prSystematic
 			// ==============================================
-			vector<double> Q;
-			mrpt::math::cumsum_tmpl<vector<double>, vector<double>, double>(
-				linW, Q);
-			Q[M - 1] = 1.1;
-
-			// Uniform random vector:
-			vector<double> T(M + 1);
-			double _1_M = 1.0 / M;
-			T[0] = getRandomGenerator().drawUniform(0.0, _1_M);
-			for (i = 1; i < M; i++) T[i] = T[i - 1] + _1_M;
-			T[M] = 1;
-
-			out_indexes.resize(out_particle_count);
-			i = j = 0;
-			while (i < out_particle_count)
-			{
-				if (T[i] < Q[j])
-					out_indexes[i++] = (unsigned int)j;
-				else
-				{
-					j++;
-					if (j >= M) j = M - 1;
-				}
-			}
+			weightsToCDF(linW);
+			// Uniformly-spaced thresholds, with a random offset:
+			const double _1_M = 1.0 / M;
+			const double T0 = getRandomGenerator().drawUniform(0.0, _1_M);
+			drawFromCDF(linW, &out_indexes[0], M, [&](size_t k) {
+				return T0 + k * _1_M;
+			});
 		}
 		break;
 		default:
@@ -458,16 +522,19 @@ void CParticleFilterCapable::prepareFastDrawSample(
 		// Generate the vector with the "probabilities" of each particle being
 		// selected:
 		size_t i, M = particlesCount();
-		vector<double> PDF(M, 0);
+		vector<double>& PDF = m_fastDrawAuxiliary.resamplingLogW;
+		PDF.resize(M);
 		for (i = 0; i < M; i++)
 			PDF[i] = partEvaluator(
 				PF_options, this, i, action,
 				observation);  // Default evaluator: takes current weight.
 
-		vector<size_t> idxs;
+		vector<size_t>& idxs = m_fastDrawAuxiliary.resamplingIndexes;
 
 		// Generate the particle samples:
-		computeResampling(PF_options.resamplingMethod, PDF, idxs);
+		computeResampling(
+			PF_options.resamplingMethod, PDF, idxs,
+			m_fastDrawAuxiliary.resamplingWorkspace);
 
 		vector<size_t>::iterator it;
 		std::vector<uint32_t>::iterator it2;
@@ -552,24 +619,56 @@ size_t CParticleFilterCapable::fastDrawSample(
 /*---------------------------------------------------------------
 						log2linearWeights
  ---------------------------------------------------------------*/
-void CParticleFilterCapable::log2linearWeights(
+double CParticleFilterCapable::log2linearWeights(
 	const vector<double>& in_logWeights, vector<double>& out_linWeights)
 {
 	MRPT_START
 
-	size_t N = in_logWeights.size();
-
+	const size_t N = in_logWeights.size();
 	out_linWeights.resize(N);
+	if (!N) return -std::numeric_limits<double>::infinity();
 
-	if (!N) return;
-
-	double sumW = 0;
-	size_t i;
-	for (i = 0; i < N; i++) sumW += out_linWeights[i] = exp(in_logWeights[i]);
-
+	// This is to avoid float point range problems:
+	const double max_log_w = arrayMaximum(&in_logWeights[0], N);
+	double sumW, sumW2;
+	shiftedExpSums(
+		&in_logWeights[0], N, max_log_w, &out_linWeights[0], sumW, sumW2);
 	ASSERT_(sumW > 0);
 
-	for (i = 0; i < N; i++) out_linWeights[i] /= sumW;
+	const double k = 1.0 / sumW;
+	for (auto& w : out_linWeights) w *= k;
+
+	return max_log_w + std::log(sumW);
 
 	MRPT_END
 }
+
+/*---------------------------------------------------------------
+						logSumExp
+ ---------------------------------------------------------------*/
+double CParticleFilterCapable::logSumExp(const vector<double>& in_logWeights)
+{
+	const size_t N = in_logWeights.size();
+	if (!N) return -std::numeric_limits<double>::infinity();
+
+	const double max_log_w = arrayMaximum(&in_logWeights[0], N);
+	double sumW, sumW2;
+	shiftedExpSums(&in_logWeights[0], N, max_log_w, nullptr, sumW, sumW2);
+	return max_log_w + std::log(sumW);
+}
+
+/*---------------------------------------------------------------
+						computeESS
+ ---------------------------------------------------------------*/
+double CParticleFilterCapable::computeESS(const vector<double>& in_logWeights)
+{
+	const size_t N = in_logWeights.size();
+	if (!N) return 0;
+
+	// ESS = (sum w_i)^2 / (N * sum w_i^2), invariant to the scale of w_i:
+	const double max_log_w = arrayMaximum(&in_logWeights[0], N);
+	double sumW, sumW2;
+	shiftedExpSums(&in_logWeights[0], N, max_log_w, nullptr, sumW, sumW2);
+	if (sumW2 == 0) return 0;
+	return sumW * sumW / (N * sumW2);
+}
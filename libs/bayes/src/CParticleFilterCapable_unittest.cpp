@@ -0,0 +1,87 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/bayes/CParticleFilterCapable.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace mrpt;
+using namespace mrpt::bayes;
+using namespace std;
+
+TEST(CParticleFilterCapable, logSumExpAndESS)
+{
+	mrpt::random::getRandomGenerator().randomize(123);
+	for (size_t N : {1, 3, 4, 7, 100, 1001})
+	{
+		vector<double> lw(N);
+		for (auto& w : lw)
+			w = mrpt::random::getRandomGenerator().drawGaussian1D(-500, 20);
+
+		double maxw = lw[0];
+		for (auto w : lw) maxw = std::max(maxw, w);
+		double s = 0, s2 = 0;
+		for (auto w : lw)
+		{
+			s += std::exp(w - maxw);
+			s2 += std::exp(2 * (w - maxw));
+		}
+		EXPECT_NEAR(
+			CParticleFilterCapable::logSumExp(lw), maxw + std::log(s), 1e-9);
+		EXPECT_NEAR(
+			CParticleFilterCapable::computeESS(lw), s * s / (N * s2), 1e-9);
+
+		vector<double> linW;
+		CParticleFilterCapable::log2linearWeights(lw, linW);
+		double sumLin = 0;
+		for (auto w : linW) sumLin += w;
+		EXPECT_NEAR(sumLin, 1.0, 1e-9);
+	}
+	// Equal weights: maximum ESS
+	EXPECT_NEAR(
+		CParticleFilterCapable::computeESS(vector<double>(10, -1000.0)), 1.0,
+		1e-12);
+}
+
+TEST(CParticleFilterCapable, computeResampling)
+{
+	mrpt::random::getRandomGenerator().randomize(1);
+	// Weights proportional to 1,2,3,4:
+	const vector<double> lw = {log(1.0), log(2.0), log(3.0), log(4.0)};
+
+	for (auto method :
+		 {CParticleFilter::prMultinomial, CParticleFilter::prResidual,
+		  CParticleFilter::prStratified, CParticleFilter::prSystematic})
+	{
+		for (size_t M : {4, 1, 13, 20000})
+		{
+			vector<size_t> idxs;
+			vector<double> workspace;
+			CParticleFilterCapable::computeResampling(
+				method, lw, idxs, workspace, M);
+			ASSERT_EQ(idxs.size(), M);
+			vector<size_t> counts(lw.size(), 0);
+			for (auto i : idxs)
+			{
+				ASSERT_LT(i, lw.size());
+				counts[i]++;
+			}
+			if (M < 1000) continue;
+			for (size_t i = 0; i < lw.size(); i++)
+				EXPECT_NEAR(double(counts[i]) / M, (i + 1) / 10.0, 0.02)
+					<< "method=" << int(method) << " i=" << i;
+			// The low-variance methods are exact up to a few particles:
+			if (method == CParticleFilter::prMultinomial) continue;
+			for (size_t i = 0; i < lw.size(); i++)
+				EXPECT_LE(std::abs(counts[i] - M * (i + 1) / 10.0), 4.0)
+					<< "method=" << int(method) << " i=" << i;
+		}
+	}
+}
@@ -49,6 +49,7 @@ namespace containers
  * with \a get(). However, elements
   *   still in the queue upon destruction will be deleted automatically.
   *
+  * \sa bounded_mpmc_queue, a lock-free alternative for high rates of messages.
  * \ingroup mrpt_containers_grp
   */
 template <class T>
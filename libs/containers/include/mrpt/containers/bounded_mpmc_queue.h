@@ -0,0 +1,292 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace mrpt
+{
+namespace containers
+{
+/** A bounded, lock-free, multi-producer/multi-consumer FIFO queue, for passing
+ * objects (e.g. observations as `std::shared_ptr`) between threads.
+ *
+ * It is a ring buffer where each cell has a sequence number (D. Vyukov's
+ * algorithm), so producers and consumers only contend on one atomic
+ * counter each, and never on a mutex, which makes it suitable for many
+ * sensor threads feeding one consumer at high rates.
+ *
+ * The capacity is fixed upon construction (rounded up to a power of 2):
+ * - try_push() / try_pop() return `false` immediately if the queue is
+ * full / empty.
+ * - push() / pop() wait until there is room / data (optionally, with a
+ * timeout): first spinning, then yielding and finally sleeping for short
+ * periods. The waits of producers (backpressure) are counted in getStats().
+ *
+ * \code
+ * mrpt::containers::bounded_mpmc_queue<std::shared_ptr<MyMsg>> q(1024);
+ * // Threads 1..N:
+ * q.push(std::make_shared<MyMsg>(...));
+ * // Thread N+1:
+ * std::shared_ptr<MyMsg> msg;
+ * while (q.try_pop(msg)) process(msg);
+ * \endcode
+ *
+ * `T` must be default-constructible and move-assignable. Elements are moved
+ * into and out of preallocated cells, so push/pop never allocate memory.
+ *
+ * \note Defined in #include <mrpt/containers/bounded_mpmc_queue.h>
+ * \note [New in MRPT 2.0.0]
+ * \sa CThreadSafeQueue
+ * \ingroup mrpt_containers_grp
+ */
+template <class T>
+class bounded_mpmc_queue
+{
+   public:
+	/** Counters of the usage of the queue \sa getStats */
+	struct TStats
+	{
+		/** Number of elements inserted/retrieved so far */
+		uint64_t n_push{0}, n_pop{0};
+		/** Number of times a producer found the queue full (try_push()
+		 * failed, or push() had to wait) */
+		uint64_t n_push_full{0};
+		/** Maximum number of elements stored at once, as seen by producers */
+		std::size_t max_size{0};
+	};
+
+	/** Creates the queue, with room for at least `capacity` elements. */
+	explicit bounded_mpmc_queue(std::size_t capacity)
+	{
+		std::size_t n = 2;
+		while (n < capacity) n <<= 1;
+		m_mask = n - 1;
+		m_cells.reset(new Cell[n]);
+		for (std::size_t i = 0; i < n; i++)
+			m_cells[i].seq.store(i, std::memory_order_relaxed);
+	}
+
+	bounded_mpmc_queue(const bounded_mpmc_queue&) = delete;
+	bounded_mpmc_queue& operator=(const bounded_mpmc_queue&) = delete;
+
+	/** Maximum number of elements */
+	std::size_t capacity() const { return m_mask + 1; }
+
+	/** Number of elements in the queue. Only approximate while other threads
+	 * are pushing or popping. */
+	std::size_t size() const
+	{
+		const std::size_t tail = m_dequeue_pos.load(std::memory_order_acquire);
+		const std::size_t head = m_enqueue_pos.load(std::memory_order_acquire);
+		return head > tail ? head - tail : 0;
+	}
+	/** See size() */
+	bool empty() const { return size() == 0; }
+
+	/** Inserts an element, if there is room for it.
+	 * \return false if the queue is full. `v` is left untouched then (it is
+	 * not moved from), so the call can be retried. */
+	bool try_push(T&& v) { return do_push(v, true); }
+	/** \overload */
+	bool try_push(const T& v)
+	{
+		T tmp(v);
+		return do_push(tmp, true);
+	}
+
+	/** Inserts an element, waiting for room if the queue is full. */
+	void push(T v)
+	{
+		if (do_push(v, true)) return;
+		for (unsigned int iter = 0; !do_push(v, false); iter++) backoff(iter);
+	}
+
+	/** Inserts an element, waiting at most `timeout` for room if the queue is
+	 * full.
+	 * \return false if the queue was still full after the timeout. `v` is
+	 * left untouched then (it is not moved from), so the call can be
+	 * retried. */
+	template <class Rep, class Period>
+	bool push(T&& v, const std::chrono::duration<Rep, Period>& timeout)
+	{
+		if (do_push(v, true)) return true;
+		const auto t_end = std::chrono::steady_clock::now() + timeout;
+		for (unsigned int iter = 0; !do_push(v, false); iter++)
+		{
+			if (std::chrono::steady_clock::now() >= t_end) return false;
+			backoff(iter);
+		}
+		return true;
+	}
+	/** \overload */
+	template <class Rep, class Period>
+	bool push(const T& v, const std::chrono::duration<Rep, Period>& timeout)
+	{
+		T tmp(v);
+		return push(std::move(tmp), timeout);
+	}
+
+	/** Retrieves the oldest element, if any.
+	 * \return false if the queue is empty. */
+	bool try_pop(T& v)
+	{
+		std::size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& c = m_cells[pos & m_mask];
+			const std::size_t seq = c.seq.load(std::memory_order_acquire);
+			const auto dif = static_cast<std::ptrdiff_t>(seq) -
+							 static_cast<std::ptrdiff_t>(pos + 1);
+			if (dif == 0)
+			{
+				if (m_dequeue_pos.compare_exchange_weak(
+						pos, pos + 1, std::memory_order_relaxed))
+				{
+					v = std::move(c.data);
+					c.data = T();  // Release resources (e.g. shared_ptr's)
+					c.seq.store(pos + m_mask + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (dif < 0)
+				return false;  // Empty
+			else
+				pos = m_dequeue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	/** Retrieves the oldest element, waiting for one if the queue is empty. */
+	void pop(T& v)
+	{
+		for (unsigned int iter = 0; !try_pop(v); iter++) backoff(iter);
+	}
+
+	/** Retrieves the oldest element, waiting at most `timeout` for one.
+	 * \return false if the queue was still empty after the timeout. */
+	template <class Rep, class Period>
+	bool pop(T& v, const std::chrono::duration<Rep, Period>& timeout)
+	{
+		const auto t_end = std::chrono::steady_clock::now() + timeout;
+		for (unsigned int iter = 0; !try_pop(v); iter++)
+		{
+			if (std::chrono::steady_clock::now() >= t_end) return false;
+			backoff(iter);
+		}
+		return true;
+	}
+
+	/** Returns the usage statistics. \sa resetStats */
+	TStats getStats() const
+	{
+		TStats s;
+		s.n_push = m_enqueue_pos.load(std::memory_order_relaxed) -
+				   m_stats_enqueue_pos0.load(std::memory_order_relaxed);
+		s.n_pop = m_dequeue_pos.load(std::memory_order_relaxed) -
+				  m_stats_dequeue_pos0.load(std::memory_order_relaxed);
+		s.n_push_full = m_n_push_full.load(std::memory_order_relaxed);
+		s.max_size = m_max_size.load(std::memory_order_relaxed);
+		return s;
+	}
+	/** Resets all counters in getStats() */
+	void resetStats()
+	{
+		m_stats_enqueue_pos0 = m_enqueue_pos.load();
+		m_stats_dequeue_pos0 = m_dequeue_pos.load();
+		m_n_push_full = 0;
+		m_max_size = 0;
+	}
+
+   private:
+	struct Cell
+	{
+		std::atomic<std::size_t> seq;
+		T data;
+	};
+	/** To keep the counters in different cache lines */
+	struct Padding
+	{
+		char pad[64];
+	};
+
+	std::unique_ptr<Cell[]> m_cells;
+	std::size_t m_mask{0};
+	Padding m_pad0;
+	std::atomic<std::size_t> m_enqueue_pos{0};
+	Padding m_pad1;
+	std::atomic<std::size_t> m_dequeue_pos{0};
+	Padding m_pad2;
+	std::atomic<uint64_t> m_n_push_full{0};
+	std::atomic<std::size_t> m_max_size{0};
+	std::atomic<std::size_t> m_stats_enqueue_pos0{0}, m_stats_dequeue_pos0{0};
+
+	/** \param count_full Whether to count a full queue in the stats */
+	bool do_push(T& v, const bool count_full)
+	{
+		std::size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			Cell& c = m_cells[pos & m_mask];
+			const std::size_t seq = c.seq.load(std::memory_order_acquire);
+			const auto dif = static_cast<std::ptrdiff_t>(seq) -
+							 static_cast<std::ptrdiff_t>(pos);
+			if (dif == 0)
+			{
+				if (m_enqueue_pos.compare_exchange_weak(
+						pos, pos + 1, std::memory_order_relaxed))
+				{
+					c.data = std::move(v);
+					c.seq.store(pos + 1, std::memory_order_release);
+					updateMaxSize(pos + 1);
+					return true;
+				}
+			}
+			else if (dif < 0)
+			{
+				// Full
+				if (count_full)
+					m_n_push_full.fetch_add(1, std::memory_order_relaxed);
+				return false;
+			}
+			else
+				pos = m_enqueue_pos.load(std::memory_order_relaxed);
+		}
+	}
+
+	void updateMaxSize(const std::size_t head)
+	{
+		const std::size_t tail = m_dequeue_pos.load(std::memory_order_relaxed);
+		const std::size_t sz = head > tail ? head - tail : 0;
+		std::size_t cur = m_max_size.load(std::memory_order_relaxed);
+		while (sz > cur && !m_max_size.compare_exchange_weak(
+							   cur, sz, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	/** Waits a bit longer on each iteration */
+	static void backoff(const unsigned int iter)
+	{
+		if (iter < 64)
+			return;  // Busy wait
+		else if (iter < 128)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+};
+
+}  // namespace containers
+}  // namespace mrpt
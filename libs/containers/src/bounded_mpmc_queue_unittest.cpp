@@ -0,0 +1,97 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/containers/bounded_mpmc_queue.h>
+#include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using mrpt::containers::bounded_mpmc_queue;
+
+TEST(bounded_mpmc_queue, tryPushPop)
+{
+	bounded_mpmc_queue<std::shared_ptr<int>> q(3);
+	EXPECT_EQ(q.capacity(), 4U);
+	EXPECT_TRUE(q.empty());
+
+	for (int i = 0; i < 4; i++)
+		EXPECT_TRUE(q.try_push(std::make_shared<int>(i)));
+	auto extra = std::make_shared<int>(4);
+	EXPECT_FALSE(q.try_push(std::move(extra)));
+	EXPECT_TRUE(extra);  // Not moved if not inserted
+	EXPECT_FALSE(q.push(std::move(extra), std::chrono::milliseconds(1)));
+	EXPECT_TRUE(extra);
+	EXPECT_FALSE(q.push(extra, std::chrono::milliseconds(1)));  // Copy
+	EXPECT_FALSE(
+		q.push(std::make_shared<int>(5), std::chrono::milliseconds(1)));
+	EXPECT_TRUE(extra);
+	EXPECT_EQ(q.size(), 4U);
+
+	std::shared_ptr<int> v;
+	for (int i = 0; i < 4; i++)
+	{
+		EXPECT_TRUE(q.try_pop(v));
+		EXPECT_EQ(*v, i);
+	}
+	EXPECT_FALSE(q.try_pop(v));
+	EXPECT_FALSE(q.pop(v, std::chrono::milliseconds(1)));
+
+	const auto s = q.getStats();
+	EXPECT_EQ(s.n_push, 4U);
+	EXPECT_EQ(s.n_pop, 4U);
+	EXPECT_EQ(s.n_push_full, 4U);
+	EXPECT_EQ(s.max_size, 4U);
+
+	// The queue does not keep references to popped objects:
+	EXPECT_EQ(v.use_count(), 1);
+}
+
+TEST(bounded_mpmc_queue, multiProducerMultiConsumer)
+{
+	const int nProducers = 4, nConsumers = 3, N = 20000;
+	// Small, to test the waits when full:
+	bounded_mpmc_queue<int> q(16);
+
+	std::vector<std::vector<int>> received(nConsumers);
+	std::vector<std::thread> threads;
+	for (int c = 0; c < nConsumers; c++)
+		threads.emplace_back([&, c]() {
+			for (;;)
+			{
+				int v;
+				q.pop(v);
+				if (v < 0) break;
+				received[c].push_back(v);
+			}
+		});
+	for (int p = 0; p < nProducers; p++)
+		threads.emplace_back([&, p]() {
+			for (int i = 0; i < N; i++) q.push(p * N + i);
+		});
+	for (int p = 0; p < nProducers; p++) threads[nConsumers + p].join();
+	for (int c = 0; c < nConsumers; c++) q.push(-1);
+	for (int c = 0; c < nConsumers; c++) threads[c].join();
+
+	// Each element received exactly once, and in order for each producer:
+	std::vector<int> count(nProducers * N, 0);
+	for (const auto& r : received)
+	{
+		std::vector<int> last(nProducers, -1);
+		for (const int v : r)
+		{
+			count[v]++;
+			EXPECT_GT(v, last[v / N]);
+			last[v / N] = v;
+		}
+	}
+	for (const int c : count) EXPECT_EQ(c, 1);
+	EXPECT_TRUE(q.empty());
+	EXPECT_EQ(q.getStats().n_pop, uint64_t(nProducers * N + nConsumers));
+}
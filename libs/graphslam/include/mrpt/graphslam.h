@@ -16,6 +16,9 @@
 // Graph SLAM: Batch solvers
 #include "graphslam/levmarq.h"
 
+// Graph SLAM: Incremental solvers
+#include "graphslam/CIncrementalPoseGraphSolver.h"
+
 // Interfaces for implementing deciders/optimizers
 #include "graphslam/interfaces/CRegistrationDeciderOrOptimizer.h"
 #include "graphslam/interfaces/CNodeRegistrationDecider.h"
@@ -36,6 +39,7 @@
 // GraphSlamOptimizers
 #include "graphslam/GSO/CEmptyGSO.h"
 #include "graphslam/GSO/CLevMarqGSO.h"
+#include "graphslam/GSO/CIncrementalGSO.h"
 
 // Graph SLAM Engine - Relevant headers
 #include "graphslam/misc/CRangeScanOps.h"
@@ -0,0 +1,186 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/graphslam/types.h>
+#include <mrpt/graphslam/levmarq_impl.h>  // computeJacobiansAndError()
+#include <mrpt/core/aligned_std_deque.h>
+#include <mrpt/core/aligned_std_map.h>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+namespace mrpt
+{
+namespace graphslam
+{
+/** Incremental (iSAM-like) Gauss-Newton solver of pose graphs, for graphs
+ * which grow along time, as those built by CGraphSlamEngine.
+ *
+ * Instead of building and factorizing the whole linear system each time
+ * the graph changes, as optimize_graph_spa_levmarq() does, this class keeps
+ * the information matrix (Hessian) \f$ H = J^t W J \f$, its block Cholesky
+ * factor \f$ H = L L^t \f$ and the gradient, each linearized at its own
+ * linearization point, between calls to update(). On each call:
+ *
+ *  - New nodes (variables) and edges in the graph are detected, and their
+ *    contributions are added to \f$ H \f$ and the gradient. A new node is
+ *    initialized by composing an edge with the current estimate of an
+ *    already known neighbor.
+ *  - Only those variables whose pending increment is larger than
+ *    TOptions::relinearize_threshold are relinearized, by subtracting and
+ *    adding again the contribution of the edges touching them.
+ *  - Only the trailing columns of \f$ L \f$ affected by the changes are
+ *    recomputed (variables are ordered by their first appearance). Thus,
+ *    adding an odometry edge costs O(1) while closing a loop with the
+ *    k'th node costs as refactoring the columns from k on.
+ *  - Back substitution stops propagating ("wildfire") into older variables
+ *    when the changes in the solution become smaller than
+ *    TOptions::wildfire_threshold.
+ *
+ * Finally, the estimated poses are written into graph.nodes. The root node
+ * is held fixed, and nodes without edges are ignored.
+ *
+ * Edges must not be modified nor removed from the graph between calls to
+ * update(). If the number of edges decreases, the solver starts again from
+ * scratch, as after reset().
+ *
+ * Timing and statistics of the last call are available via
+ * getLastUpdateStats().
+ *
+ * \note The following graph types are supported:
+ * mrpt::graphs::CNetworkOfPoses2D, mrpt::graphs::CNetworkOfPoses3D,
+ * mrpt::graphs::CNetworkOfPoses2DInf, mrpt::graphs::CNetworkOfPoses3DInf
+ *
+ * \sa optimize_graph_spa_levmarq(),
+ * mrpt::graphslam::optimizers::CIncrementalGSO
+ * \note [New in MRPT 2.0.0]
+ * \ingroup mrpt_graphslam_grp
+ */
+template <class GRAPH_T>
+class CIncrementalPoseGraphSolver
+{
+   public:
+	using gst = graphslam_traits<GRAPH_T>;
+	using pose_t = typename gst::edge_poses_type;
+	using matrix_t = typename gst::matrix_VxV_t;
+	using array_t = typename gst::Array_O;
+	/** Dimensionality of the pose manifold (3 for 2D, 6 for 3D) */
+	static constexpr size_t DIM = gst::SE_TYPE::VECTOR_SIZE;
+
+	struct TOptions
+	{
+		/** Relinearize those variables whose increment (in the Lie algebra)
+		 * has an infinity norm larger than this value */
+		double relinearize_threshold{0.05};
+		/** Stop back substitution into older variables when the changes in
+		 * the solution are smaller than this value */
+		double wildfire_threshold{1e-3};
+		/** Number of relinearize+solve iterations per update() call */
+		size_t max_iterations{1};
+	};
+	TOptions options;
+
+	/** Statistics and timing (in seconds) of the last update() */
+	struct TUpdateStats
+	{
+		size_t num_new_variables{0}, num_new_edges{0};
+		/** Number of variables relinearized (in all iterations) */
+		size_t num_relinearized{0};
+		/** Number of refactored columns (in all iterations) of the Cholesky
+		 * factor, and the index of the first one in the last iteration */
+		size_t num_refactored_columns{0}, first_refactored_column{0};
+		/** Number of variables updated during back substitution */
+		size_t num_backsub_variables{0};
+		size_t num_iterations{0};
+		double time_linearize{0}, time_factorize{0}, time_solve{0};
+		double time_total{0};
+	};
+
+	CIncrementalPoseGraphSolver() = default;
+
+	/** Incorporates the new nodes and edges of the graph into the problem,
+	 * updates the solution and writes it into graph.nodes.
+	 * \exception std::exception If the problem is not well-constrained (e.g.
+	 * a set of nodes is not connected to the root).
+	 */
+	void update(GRAPH_T& graph);
+	/** Forgets all the problem state */
+	void reset();
+
+	const TUpdateStats& getLastUpdateStats() const { return m_stats; }
+	/** Number of variables (free nodes) in the problem */
+	size_t getVariableCount() const { return m_vars.size(); }
+	size_t getEdgeCount() const { return m_edges.size(); }
+
+   private:
+	static const size_t NONE = static_cast<size_t>(-1);
+
+	struct TVariable
+	{
+		mrpt::graphs::TNodeID id;
+		/** Linearization point and current solution of the linear system,
+		 * in the same convention than optimize_graph_spa_levmarq(): the
+		 * estimate is Exp(-delta) * x_lin */
+		pose_t x_lin;
+		array_t delta, grad, y;
+		/** Diagonal block, and lower blocks H(i,this) (i>this) of H */
+		matrix_t H_diag;
+		mrpt::aligned_std_map<size_t, matrix_t> H_low;
+		/** Same for L, plus the columns c<this with L(this,c)!=0 */
+		matrix_t L_diag;
+		mrpt::aligned_std_map<size_t, matrix_t> L_low;
+		std::set<size_t> L_row;
+		/** Indices in m_edges of the edges touching this variable */
+		std::vector<size_t> edges;
+		bool delta_changed{false};
+
+		MRPT_MAKE_ALIGNED_OPERATOR_NEW
+	};
+
+	struct TEdge
+	{
+		typename gst::edge_const_iterator it;
+		/** Variable index of each end, or NONE for the fixed root */
+		size_t v1{NONE}, v2{NONE};
+		/** Current contributions to H and the gradient. H_hl is the
+		 * contribution to H(max(v1,v2),min(v1,v2)) */
+		matrix_t H11, H22, H_hl;
+		array_t g1, g2;
+		bool linearized{false};
+
+		MRPT_MAKE_ALIGNED_OPERATOR_NEW
+	};
+
+	mrpt::aligned_std_deque<TVariable> m_vars;
+	mrpt::aligned_std_deque<TEdge> m_edges;
+	std::map<mrpt::graphs::TNodeID, size_t> m_nodeID2var;
+	/** Known edges, by the address of their value in graph.edges */
+	std::unordered_set<const void*> m_known_edges;
+	mrpt::graphs::TNodeID m_root{INVALID_NODEID};
+	pose_t m_root_pose;
+	TUpdateStats m_stats;
+
+	/** Detects new edges and nodes. Returns the smallest affected variable
+	 * index, or NONE. */
+	size_t addNewEdges(const GRAPH_T& graph);
+	size_t addVariable(const mrpt::graphs::TNodeID id, const pose_t& p);
+	pose_t currentEstimate(const size_t v) const;
+	/** Adds (sign=+1) or removes (sign=-1) the edge contribution to H and g */
+	void accumulateEdge(const TEdge& e, const double sign);
+	void linearizeEdge(TEdge& e);
+	void factorize(const size_t first_col);
+	void solve(const size_t first_col);
+};
+
+}  // namespace graphslam
+}  // namespace mrpt
+
+#include "CIncrementalPoseGraphSolver_impl.h"
@@ -0,0 +1,367 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/system/CTicTac.h>
+#include <Eigen/Cholesky>
+#include <algorithm>
+
+namespace mrpt
+{
+namespace graphslam
+{
+template <class GRAPH_T>
+void CIncrementalPoseGraphSolver<GRAPH_T>::reset()
+{
+	m_vars.clear();
+	m_edges.clear();
+	m_nodeID2var.clear();
+	m_known_edges.clear();
+	m_root = INVALID_NODEID;
+	m_stats = TUpdateStats();
+}
+
+template <class GRAPH_T>
+void CIncrementalPoseGraphSolver<GRAPH_T>::update(GRAPH_T& graph)
+{
+	MRPT_START
+
+	mrpt::system::CTicTac tictac_total, tictac;
+	m_stats = TUpdateStats();
+
+	// A different root or removed edges: start again.
+	if (graph.root != m_root || graph.edges.size() < m_known_edges.size())
+		reset();
+	if (m_root == INVALID_NODEID)
+	{
+		auto itRoot = graph.nodes.find(graph.root);
+		ASSERTMSG_(
+			itRoot != graph.nodes.end(),
+			"The graph root node has no global pose in 'graph.nodes'");
+		m_root = graph.root;
+		m_root_pose = itRoot->second;
+	}
+
+	for (size_t iter = 0; iter < options.max_iterations; iter++)
+	{
+		tictac.Tic();
+		size_t first_col = NONE;
+		if (iter == 0) first_col = addNewEdges(graph);
+
+		// Relinearize those variables which moved too far away from their
+		// linearization point, and then all the edges touching them:
+		std::set<size_t> dirty_edges;
+		for (auto& v : m_vars)
+		{
+			if (v.delta.array().abs().maxCoeff() <=
+				options.relinearize_threshold)
+				continue;
+			array_t minus_delta(-v.delta);
+			pose_t exp_delta(mrpt::poses::UNINITIALIZED_POSE);
+			gst::SE_TYPE::exp(minus_delta, exp_delta);
+			v.x_lin.composeFrom(exp_delta, pose_t(v.x_lin));
+			v.delta.setZero();
+			dirty_edges.insert(v.edges.begin(), v.edges.end());
+			m_stats.num_relinearized++;
+		}
+		for (const size_t idx : dirty_edges)
+		{
+			TEdge& e = m_edges[idx];
+			accumulateEdge(e, -1.0);
+			linearizeEdge(e);
+			accumulateEdge(e, +1.0);
+			first_col = std::min(first_col, std::min(e.v1, e.v2));
+		}
+		m_stats.time_linearize += tictac.Tac();
+
+		if (first_col == NONE) break;  // Nothing changed.
+		m_stats.num_iterations++;
+
+		tictac.Tic();
+		factorize(first_col);
+		m_stats.time_factorize += tictac.Tac();
+
+		tictac.Tic();
+		solve(first_col);
+		m_stats.time_solve += tictac.Tac();
+	}
+
+	// Write the current estimate back into the graph:
+	for (size_t v = 0; v < m_vars.size(); v++)
+		graph.nodes[m_vars[v].id] = currentEstimate(v);
+
+	m_stats.time_total = tictac_total.Tac();
+
+	MRPT_END
+}
+
+template <class GRAPH_T>
+size_t CIncrementalPoseGraphSolver<GRAPH_T>::addNewEdges(const GRAPH_T& graph)
+{
+	using mrpt::graphs::TNodeID;
+
+	std::vector<typename gst::edge_const_iterator> new_edges;
+	for (auto it = graph.edges.begin(); it != graph.edges.end(); ++it)
+		if (m_known_edges.insert(&it->second).second) new_edges.push_back(it);
+
+	// Insert them in chronological order (approx.), so new nodes can be
+	// initialized from their predecessors and the variable ordering follows
+	// the robot trajectory:
+	std::stable_sort(
+		new_edges.begin(), new_edges.end(),
+		[](const typename gst::edge_const_iterator& a,
+		   const typename gst::edge_const_iterator& b) {
+			return std::max(a->first.first, a->first.second) <
+				   std::max(b->first.first, b->first.second);
+		});
+
+	// Variable index of a node: NONE for the root, or create a new one
+	// initialized from the current estimate of the other end of the edge.
+	const auto varIndex = [&](
+		const TNodeID id, const TNodeID other_id, const pose_t& edge_mean,
+		const bool id_is_edge_end) -> size_t {
+		if (id == m_root) return NONE;
+		auto it = m_nodeID2var.find(id);
+		if (it != m_nodeID2var.end()) return it->second;
+
+		const bool other_is_known =
+			other_id == m_root || m_nodeID2var.count(other_id) != 0;
+		if (!other_is_known)
+		{
+			auto itP = graph.nodes.find(id);
+			ASSERTMSG_(
+				itP != graph.nodes.end(),
+				"Node in an edge does not have a global pose in 'graph.nodes'");
+			return addVariable(id, itP->second);
+		}
+		const pose_t other = other_id == m_root
+								 ? m_root_pose
+								 : currentEstimate(m_nodeID2var[other_id]);
+		return addVariable(
+			id, id_is_edge_end ? other + edge_mean : other + (-edge_mean));
+	};
+
+	size_t first_col = NONE;
+	for (const auto& it : new_edges)
+	{
+		const TNodeID id1 = it->first.first, id2 = it->first.second;
+		if (id1 == id2 || (id1 == m_root && id2 == m_root)) continue;
+		const pose_t& edge_mean = it->second.getPoseMean();
+
+		TEdge e;
+		e.it = it;
+		e.v1 = varIndex(id1, id2, edge_mean, false);
+		e.v2 = varIndex(id2, id1, edge_mean, true);
+		linearizeEdge(e);
+		accumulateEdge(e, +1.0);
+
+		const size_t idx = m_edges.size();
+		m_edges.push_back(e);
+		for (const size_t v : {e.v1, e.v2})
+		{
+			if (v == NONE) continue;
+			m_vars[v].edges.push_back(idx);
+			first_col = std::min(first_col, v);
+		}
+		m_stats.num_new_edges++;
+	}
+	return first_col;
+}
+
+template <class GRAPH_T>
+size_t CIncrementalPoseGraphSolver<GRAPH_T>::addVariable(
+	const mrpt::graphs::TNodeID id, const pose_t& p)
+{
+	const size_t idx = m_vars.size();
+	m_vars.resize(idx + 1);
+	TVariable& v = m_vars.back();
+	v.id = id;
+	v.x_lin = p;
+	v.delta.setZero();
+	v.grad.setZero();
+	v.y.setZero();
+	m_nodeID2var[id] = idx;
+	m_stats.num_new_variables++;
+	return idx;
+}
+
+template <class GRAPH_T>
+typename CIncrementalPoseGraphSolver<GRAPH_T>::pose_t
+	CIncrementalPoseGraphSolver<GRAPH_T>::currentEstimate(const size_t v) const
+{
+	const TVariable& var = m_vars[v];
+	const array_t minus_delta(-var.delta);
+	pose_t exp_delta(mrpt::poses::UNINITIALIZED_POSE);
+	gst::SE_TYPE::exp(minus_delta, exp_delta);
+	pose_t p(mrpt::poses::UNINITIALIZED_POSE);
+	p.composeFrom(exp_delta, var.x_lin);
+	return p;
+}
+
+template <class GRAPH_T>
+void CIncrementalPoseGraphSolver<GRAPH_T>::linearizeEdge(TEdge& e)
+{
+	using aux_t = detail::AuxErrorEval<typename gst::edge_t, gst>;
+
+	typename gst::observation_info_t obs;
+	obs.edge = e.it;
+	obs.edge_mean = &e.it->second.getPoseMean();
+	obs.P1 = e.v1 == NONE ? &m_root_pose : &m_vars[e.v1].x_lin;
+	obs.P2 = e.v2 == NONE ? &m_root_pose : &m_vars[e.v2].x_lin;
+
+	typename gst::TPairJacobs jacobs;
+	array_t err;
+	detail::computeJacobiansAndError<gst>(obs, jacobs, err);
+
+	if (e.v1 != NONE)
+	{
+		aux_t::multiplyJtLambdaJ(jacobs.first, e.H11, e.it);
+		e.g1.setZero();
+		aux_t::multiply_Jt_W_err(jacobs.first, e.it, err, e.g1);
+	}
+	if (e.v2 != NONE)
+	{
+		aux_t::multiplyJtLambdaJ(jacobs.second, e.H22, e.it);
+		e.g2.setZero();
+		aux_t::multiply_Jt_W_err(jacobs.second, e.it, err, e.g2);
+	}
+	if (e.v1 != NONE && e.v2 != NONE)
+	{
+		// H(hi,lo) = J_hi^t * Inf * J_lo
+		if (e.v1 < e.v2)
+			aux_t::multiplyJ1tLambdaJ2(
+				jacobs.second, jacobs.first, e.H_hl, e.it);
+		else
+			aux_t::multiplyJ1tLambdaJ2(
+				jacobs.first, jacobs.second, e.H_hl, e.it);
+	}
+	e.linearized = true;
+}
+
+template <class GRAPH_T>
+void CIncrementalPoseGraphSolver<GRAPH_T>::accumulateEdge(
+	const TEdge& e, const double sign)
+{
+	if (!e.linearized) return;
+	if (e.v1 != NONE)
+	{
+		m_vars[e.v1].H_diag += sign * e.H11;
+		m_vars[e.v1].grad += sign * e.g1;
+	}
+	if (e.v2 != NONE)
+	{
+		m_vars[e.v2].H_diag += sign * e.H22;
+		m_vars[e.v2].grad += sign * e.g2;
+	}
+	if (e.v1 != NONE && e.v2 != NONE)
+		m_vars[std::min(e.v1, e.v2)].H_low[std::max(e.v1, e.v2)] +=
+			sign * e.H_hl;
+}
+
+template <class GRAPH_T>
+void CIncrementalPoseGraphSolver<GRAPH_T>::factorize(const size_t first_col)
+{
+	using dense_t = typename matrix_t::Base;
+	const size_t n = m_vars.size();
+	m_stats.first_refactored_column = first_col;
+	m_stats.num_refactored_columns += n - first_col;
+
+	// Columns before "first_col" are not affected by the changes, since all
+	// of them are in H(first_col:n,first_col:n). Remove the rest:
+	for (size_t j = first_col; j < n; j++)
+	{
+		for (const auto& r : m_vars[j].L_low) m_vars[r.first].L_row.erase(j);
+		m_vars[j].L_low.clear();
+	}
+
+	// Left-looking block Cholesky: L(j:n,j) from H(j:n,j) and L(j:n,0:j-1)
+	for (size_t j = first_col; j < n; j++)
+	{
+		TVariable& vj = m_vars[j];
+		dense_t D = vj.H_diag;
+		mrpt::aligned_std_map<size_t, matrix_t> B = vj.H_low;
+		for (const size_t c : vj.L_row)
+		{
+			const auto& Lc = m_vars[c].L_low;
+			const matrix_t& Ljc = Lc.find(j)->second;
+			D.noalias() -= Ljc * Ljc.transpose();
+			for (auto it = Lc.upper_bound(j); it != Lc.end(); ++it)
+				B[it->first].noalias() -= it->second * Ljc.transpose();
+		}
+
+		const Eigen::LLT<dense_t> llt(D);
+		if (llt.info() != Eigen::Success)
+			THROW_EXCEPTION_FMT(
+				"Information matrix is not positive definite at node #%u: is "
+				"it connected to the root node?",
+				static_cast<unsigned int>(vj.id));
+		vj.L_diag = dense_t(llt.matrixL());
+
+		// L(i,j) = B(i,j) * L(j,j)^-t
+		for (const auto& b : B)
+		{
+			vj.L_low[b.first] =
+				vj.L_diag.template triangularView<Eigen::Lower>()
+					.solve(b.second.transpose())
+					.transpose();
+			m_vars[b.first].L_row.insert(j);
+		}
+	}
+}
+
+template <class GRAPH_T>
+void CIncrementalPoseGraphSolver<GRAPH_T>::solve(const size_t first_col)
+{
+	const size_t n = m_vars.size();
+
+	// Forward substitution L*y=grad: y(0:first_col-1) does not change.
+	for (size_t j = first_col; j < n; j++)
+	{
+		TVariable& vj = m_vars[j];
+		array_t r = vj.grad;
+		for (const size_t c : vj.L_row)
+			r.noalias() -= m_vars[c].L_low.find(j)->second * m_vars[c].y;
+		vj.y = vj.L_diag.template triangularView<Eigen::Lower>().solve(r);
+	}
+
+	// Back substitution L^t*delta=y, only going back into older variables
+	// while the solution changes significantly:
+	for (size_t j = n; j-- > 0;)
+	{
+		TVariable& vj = m_vars[j];
+		if (j < first_col)
+		{
+			bool needed = false;
+			for (const auto& l : vj.L_low)
+				if (m_vars[l.first].delta_changed)
+				{
+					needed = true;
+					break;
+				}
+			if (!needed)
+			{
+				vj.delta_changed = false;
+				continue;
+			}
+		}
+		array_t r = vj.y;
+		for (const auto& l : vj.L_low)
+			r.noalias() -= l.second.transpose() * m_vars[l.first].delta;
+		const array_t new_delta(
+			vj.L_diag.transpose().template triangularView<Eigen::Upper>().solve(
+				r));
+		vj.delta_changed = (new_delta - vj.delta).array().abs().maxCoeff() >
+						   options.wildfire_threshold;
+		vj.delta = new_delta;
+		m_stats.num_backsub_variables++;
+	}
+}
+
+}  // namespace graphslam
+}  // namespace mrpt
@@ -14,11 +14,14 @@
 #include <mrpt/config/CLoadableOptions.h>
 #include <mrpt/config/CConfigFileBase.h>
 #include <mrpt/img/TColor.h>
+#include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/obs/CObservation2DRangeScan.h>
 #include <mrpt/obs/CActionCollection.h>
 #include <mrpt/obs/CSensoryFrame.h>
 #include <mrpt/slam/CIncrementalMapPartitioner.h>
 #include <mrpt/slam/CICP.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/core/aligned_std_vector.h>
 
 #include <mrpt/graphslam/interfaces/CRangeScanEdgeRegistrationDecider.h>
 #include <mrpt/graphslam/misc/TSlidingWindow.h>
@@ -28,6 +31,7 @@
 #include <mrpt/graphs/CHypothesisNotFoundException.h>
 
 #include <map>
+#include <memory>
 #include <vector>
 #include <string>
 #include <set>
@@ -200,6 +204,15 @@ exponential.
  *   + \a Description   : Boolean flag indicating whether to check for loop
  *   closures only in the current node's partition
  *
+ * - \b LC_num_threads
+ *   + \a Section       : EdgeRegistrationDeciderParameters
+ *   + \a Default value : 1
+ *   + \a Required      : FALSE
+ *   + \a Description   : Number of threads for evaluating loop closures and
+ *   scan-matching edges: the ICP alignments of the hypotheses and the
+ *   pair-wise consistency matrix. Use 0 for all cores, 1 for serial
+ *   execution.
+ *
  * - \b visualize_map_partitions
  *   + \a Section       : VisualizationParameters
  *   + \a Default value : TRUE
@@ -494,6 +507,12 @@ class CLoopCloserERD : public virtual mrpt::graphslam::deciders::
 		 * before I consider the potential loop closure.
 		 */
 		int LC_min_remote_nodes;
+		/**\brief Threads for the ICP alignments and the pair-wise consistency
+		 * matrix (0: all cores, 1: serial). Default: 1
+		 *
+		 * Results do not depend on this value.
+		 */
+		size_t LC_num_threads;
 		/**\brief Full partition of map only afer X new nodes have been
 		 * registered
 		 */
@@ -645,6 +664,18 @@ class CLoopCloserERD : public virtual mrpt::graphslam::deciders::
 		const mrpt::graphs::TNodeID& a1, const mrpt::graphs::TNodeID& a2,
 		const mrpt::graphs::TNodeID& b1, const mrpt::graphs::TNodeID& b2,
 		const hypotsp_t& hypots, const paths_t* opt_paths = NULL);
+	/**\brief Pair-wise consistency element out of the already computed
+	 * Dijkstra links and hypotheses. See generatePWConsistencyElement.
+	 *
+	 * \note Thread-safe: it neither logs nor touches the class state.
+	 *
+	 * \param[out] res_transform If given, filled with the composition of
+	 * transformations a1 ==> a2 ==> b1 ==> b2 ==> a1
+	 */
+	static double computePWConsistencyElement(
+		const path_t& path_a1_a2, const path_t& path_b1_b2,
+		const hypot_t& hypot_b1_a2, const hypot_t& hypot_b2_a1,
+		constraint_t* res_transform = NULL);
 	/**\brief Given a vector of THypothesis objects, find the one that
 	 * has the given start and end nodes.
 	 *
@@ -713,6 +744,65 @@ class CLoopCloserERD : public virtual mrpt::graphslam::deciders::
 		const mrpt::graphs::TNodeID& from, const mrpt::graphs::TNodeID& to,
 		constraint_t* rel_edge, mrpt::slam::CICP::TReturnInfo* icp_info = NULL,
 		const TGetICPEdgeAdParams* ad_params = NULL);
+	/**\brief An ICP alignment between the scans of two nodes, to be run
+	 * along with others by getICPEdges().
+	 */
+	struct TICPEdgeJob
+	{
+		/**\brief Input: nodes and, optionally, additional parameters as in
+		 * getICPEdge() */
+		/**\{ */
+		mrpt::graphs::TNodeID from{INVALID_NODEID}, to{INVALID_NODEID};
+		bool use_ad_params{false};
+		TGetICPEdgeAdParams ad_params;
+		/**\} */
+
+		/**\brief Output: as in getICPEdge() */
+		/**\{ */
+		bool found_edge{false};
+		constraint_t rel_edge;
+		mrpt::slam::CICP::TReturnInfo icp_info;
+		/**\} */
+
+		/**\brief Filled by prepareICPEdgeJob() */
+		/**\{ */
+		pose_t init_estim;
+		std::shared_ptr<const mrpt::maps::CSimplePointsMap> from_map, to_map;
+		/**\} */
+
+		MRPT_MAKE_ALIGNED_OPERATOR_NEW
+	};
+	using icp_jobs_t = mrpt::aligned_std_vector<TICPEdgeJob>;
+	/**\brief Batch version of getICPEdge(): runs all the given alignments,
+	 * in parallel if TLoopClosureParams::LC_num_threads allows so.
+	 *
+	 * Scans and poses are fetched, and their points maps built, in the
+	 * calling thread; only the ICP alignments are dispatched to the worker
+	 * threads, each of which takes the next pending job until none is
+	 * left. Results are those of calling getICPEdge() for each job.
+	 *
+	 * \note Unlike getICPEdge(), this method is not virtual.
+	 */
+	void getICPEdges(icp_jobs_t& jobs);
+	/**\brief Fetch the pose difference and the scan points maps of the
+	 * nodes of the job.
+	 *
+	 * \return False if either of the nodes has no valid laser scan.
+	 */
+	bool prepareICPEdgeJob(TICPEdgeJob& job);
+	/**\brief Return the points map of the given laser scan of a node.
+	 *
+	 * Maps are kept in m_node_scan_maps, so their KD-tree is built once per
+	 * node instead of once per ICP alignment, and they are ready to be used
+	 * read-only from several threads.
+	 */
+	std::shared_ptr<const mrpt::maps::CSimplePointsMap> getScanPointsMap(
+		const mrpt::graphs::TNodeID nodeID,
+		const mrpt::obs::CObservation2DRangeScan::Ptr& scan);
+	/**\brief Thread pool for loop closure evaluation, or nullptr if it is to
+	 * be done serially (see TLoopClosureParams::LC_num_threads).
+	 */
+	mrpt::system::CWorkerThreadsPool* getLCThreadPool();
 	/**\brief compute the minimum uncertainty of each node position with
 	 * regards to the graph root.
 	 *
@@ -831,6 +921,19 @@ class CLoopCloserERD : public virtual mrpt::graphslam::deciders::
 	 * execDijkstraProjection method
 	 */
 	typename std::map<mrpt::graphs::TNodeID, path_t*> m_node_optimal_paths;
+	/**\brief Points maps of the laser scans of the nodes, along with the scan
+	 * they were built from.
+	 *
+	 * \sa getScanPointsMap
+	 */
+	std::map<
+		mrpt::graphs::TNodeID,
+		std::pair<
+			mrpt::obs::CObservation2DRangeScan::Ptr,
+			std::shared_ptr<const mrpt::maps::CSimplePointsMap>>>
+		m_node_scan_maps;
+	/**\brief See getLCThreadPool */
+	std::shared_ptr<mrpt::system::CWorkerThreadsPool> m_lc_threads_pool;
 	/**\brief Keep track of the first recorded laser scan so that it can be
 	 * assigned to the root node when the NRD adds the first *two* nodes to the
 	 * graph.
@@ -14,6 +14,8 @@
 #include <mrpt/opengl/CEllipsoid.h>
 #include <mrpt/opengl/CSphere.h>
 #include <mrpt/math/data_utils.h>
+#include <algorithm>
+#include <atomic>
 
 namespace mrpt
 {
@@ -206,20 +208,28 @@ void CLoopCloserERD<GRAPH_T>::addScanMatchingEdges(
 	std::set<TNodeID> nodes_set;
 	this->fetchNodeIDsForScanMatching(curr_nodeID, &nodes_set);
 
-	// try adding ICP constraints with each node in the previous set
-	for (std::set<TNodeID>::const_iterator node_it = nodes_set.begin();
-		 node_it != nodes_set.end(); ++node_it)
+	// align the scans of all the nodes at once
+	icp_jobs_t jobs(nodes_set.size());
 	{
-		constraint_t rel_edge;
-		mrpt::slam::CICP::TReturnInfo icp_info;
-
-		MRPT_LOG_DEBUG_STREAM(
-			"Fetching laser scan for nodes: " << *node_it << "==> "
-											  << curr_nodeID);
+		auto job_it = jobs.begin();
+		for (const TNodeID nodeID : nodes_set)
+		{
+			MRPT_LOG_DEBUG_STREAM(
+				"Fetching laser scan for nodes: " << nodeID << "==> "
+												  << curr_nodeID);
+			job_it->from = nodeID;
+			job_it->to = curr_nodeID;
+			++job_it;
+		}
+	}
+	this->getICPEdges(jobs);
 
-		bool found_edge =
-			this->getICPEdge(*node_it, curr_nodeID, &rel_edge, &icp_info);
-		if (!found_edge) continue;
+	// try adding ICP constraints with each node in the previous set
+	for (const TICPEdgeJob& job : jobs)
+	{
+		if (!job.found_edge) continue;
+		const constraint_t& rel_edge = job.rel_edge;
+		const mrpt::slam::CICP::TReturnInfo& icp_info = job.icp_info;
 
 		// keep track of the recorded goodness values
 		// TODO - rethink on these condition.
@@ -241,12 +251,12 @@ void CLoopCloserERD<GRAPH_T>::addScanMatchingEdges(
 		// make sure that the suggested edge makes sense with regards to current
 		// graph config - check against the current position difference
 		bool accept_mahal_distance = this->mahalanobisDistanceOdometryToICPEdge(
-			*node_it, curr_nodeID, rel_edge);
+			job.from, curr_nodeID, rel_edge);
 
 		// criterion for registering a new node
 		if (accept_goodness && accept_mahal_distance)
 		{
-			this->registerNewEdge(*node_it, curr_nodeID, rel_edge);
+			this->registerNewEdge(job.from, curr_nodeID, rel_edge);
 		}
 	}
 
@@ -262,16 +272,7 @@ bool CLoopCloserERD<GRAPH_T>::getICPEdge(
 	ASSERTDEB_(rel_edge);
 	this->m_time_logger.enter("getICPEdge");
 
-	using namespace mrpt::obs;
 	using namespace std;
-	using namespace mrpt::graphslam::detail;
-
-	// fetch the relevant laser scans and poses of the nodeIDs
-	// If given in the additional params struct, use those values instead of
-	// searching in the class std::map(s)
-	CObservation2DRangeScan::Ptr from_scan, to_scan;
-	global_pose_t from_pose;
-	global_pose_t to_pose;
 
 	MRPT_LOG_DEBUG_STREAM("****In getICPEdge method: ");
 	if (ad_params)
@@ -281,48 +282,162 @@ bool CLoopCloserERD<GRAPH_T>::getICPEdge(
 			<< ad_params->getAsString() << endl);
 	}
 
+	// fetch the relevant laser scans and poses of the nodeIDs
+	// If given in the additional params struct, use those values instead of
+	// searching in the class std::map(s)
+	TICPEdgeJob job;
+	job.from = from;
+	job.to = to;
+	if (ad_params)
+	{
+		job.use_ad_params = true;
+		job.ad_params = *ad_params;
+	}
+	if (!this->prepareICPEdgeJob(job))
+	{
+		this->m_time_logger.leave("getICPEdge");
+		return false;
+	}
+
+	range_ops_t::getICPEdge(
+		*job.from_map, *job.to_map, rel_edge, &job.init_estim, icp_info);
+	MRPT_LOG_DEBUG_STREAM("*************");
+
+	this->m_time_logger.leave("getICPEdge");
+	return true;
+	MRPT_END;
+}  // end of getICPEdge
+
+template <class GRAPH_T>
+void CLoopCloserERD<GRAPH_T>::getICPEdges(icp_jobs_t& jobs)
+{
+	MRPT_START;
+	this->m_time_logger.enter("getICPEdges");
+
+	// Scans, poses and points maps are fetched here, since the class
+	// containers and the logger are not thread-safe:
+	for (auto& job : jobs) job.found_edge = this->prepareICPEdgeJob(job);
+
+	mrpt::system::CWorkerThreadsPool* pool = this->getLCThreadPool();
+	std::atomic<size_t> next_job(0);
+	auto align_jobs = [&](mrpt::slam::CICP* icp) {
+		for (size_t i; (i = next_job++) < jobs.size();)
+		{
+			TICPEdgeJob& job = jobs[i];
+			if (!job.found_edge) continue;
+			range_ops_t::getICPEdge(
+				*job.from_map, *job.to_map, &job.rel_edge, &job.init_estim,
+				&job.icp_info, icp);
+		}
+	};
+
+	if (!pool || jobs.size() < 2)
+	{
+		align_jobs(nullptr);  // use params.icp
+	}
+	else
+	{
+		// One task per thread, each of them running the next pending
+		// alignment (their cost varies a lot) with its own, serial, ICP:
+		pool->parallel_for(pool->size() + 1, [&](size_t, size_t) {
+			mrpt::slam::CICP icp(this->params.icp.options);
+			icp.options.numThreads = 1;
+			align_jobs(&icp);
+		});
+	}
+
+	this->m_time_logger.leave("getICPEdges");
+	MRPT_END;
+}  // end of getICPEdges
+
+template <class GRAPH_T>
+bool CLoopCloserERD<GRAPH_T>::prepareICPEdgeJob(TICPEdgeJob& job)
+{
+	MRPT_START;
+	using namespace mrpt::obs;
+
+	CObservation2DRangeScan::Ptr from_scan, to_scan;
+	global_pose_t from_pose;
+	global_pose_t to_pose;
+
 	// from-node parameters
 	const node_props_t* from_params =
-		ad_params ? &ad_params->from_params : NULL;
+		job.use_ad_params ? &job.ad_params.from_params : NULL;
 	bool from_success = this->getPropsOfNodeID(
-		from, &from_pose, from_scan, from_params);  // TODO
+		job.from, &from_pose, from_scan, from_params);  // TODO
 	// to-node parameters
-	const node_props_t* to_params = ad_params ? &ad_params->to_params : NULL;
-	bool to_success = this->getPropsOfNodeID(to, &to_pose, to_scan, to_params);
+	const node_props_t* to_params =
+		job.use_ad_params ? &job.ad_params.to_params : NULL;
+	bool to_success =
+		this->getPropsOfNodeID(job.to, &to_pose, to_scan, to_params);
 
 	if (!from_success || !to_success)
 	{
 		MRPT_LOG_DEBUG_STREAM(
 			"Either node #"
-			<< from << " or node #" << to
+			<< job.from << " or node #" << job.to
 			<< " doesn't contain a valid LaserScan. Ignoring this...");
 		return false;
 	}
 
 	// make use of initial node position difference for the ICP edge
 	// from_node pose
-	pose_t initial_estim;
-	if (ad_params)
+	if (job.use_ad_params)
 	{
-		initial_estim = ad_params->init_estim;
+		job.init_estim = job.ad_params.init_estim;
 	}
 	else
 	{
-		initial_estim = to_pose - from_pose;
+		job.init_estim = to_pose - from_pose;
 	}
 
 	MRPT_LOG_DEBUG_STREAM(
 		"from_pose: " << from_pose << "| to_pose: " << to_pose
-					  << "| init_estim: " << initial_estim);
+					  << "| init_estim: " << job.init_estim);
 
-	range_ops_t::getICPEdge(
-		*from_scan, *to_scan, rel_edge, &initial_estim, icp_info);
-	MRPT_LOG_DEBUG_STREAM("*************");
-
-	this->m_time_logger.leave("getICPEdge");
+	job.from_map = this->getScanPointsMap(job.from, from_scan);
+	job.to_map = this->getScanPointsMap(job.to, to_scan);
 	return true;
 	MRPT_END;
-}  // end of getICPEdge
+}  // end of prepareICPEdgeJob
+
+template <class GRAPH_T>
+std::shared_ptr<const mrpt::maps::CSimplePointsMap>
+	CLoopCloserERD<GRAPH_T>::getScanPointsMap(
+		const mrpt::graphs::TNodeID nodeID,
+		const mrpt::obs::CObservation2DRangeScan::Ptr& scan)
+{
+	auto& cached = m_node_scan_maps[nodeID];
+	if (!cached.second || cached.first != scan)
+	{
+		auto m = mrpt::make_aligned_shared<mrpt::maps::CSimplePointsMap>();
+		m->insertObservation(scan.get());
+		// Compute now the data the maps build on demand, so they can be
+		// aligned against from several threads at once:
+		m->kdTreeEnsureIndexBuilt2D();
+		mrpt::math::TPoint3D bb_min, bb_max;
+		m->boundingBox(bb_min, bb_max);
+
+		cached.first = scan;
+		cached.second = m;
+	}
+	return cached.second;
+}
+
+template <class GRAPH_T>
+mrpt::system::CWorkerThreadsPool* CLoopCloserERD<GRAPH_T>::getLCThreadPool()
+{
+	using mrpt::system::CWorkerThreadsPool;
+
+	if (m_lc_params.LC_num_threads == 1) return nullptr;
+	const size_t nThreads = m_lc_params.LC_num_threads != 0
+								? m_lc_params.LC_num_threads
+								: CWorkerThreadsPool::hardwareThreads();
+	if (nThreads <= 1) return nullptr;
+	if (!m_lc_threads_pool || m_lc_threads_pool->size() != nThreads - 1)
+		m_lc_threads_pool = std::make_shared<CWorkerThreadsPool>(nThreads - 1);
+	return m_lc_threads_pool.get();
+}
 
 template <class GRAPH_T>
 bool CLoopCloserERD<GRAPH_T>::fillNodePropsFromGroupParams(
@@ -794,101 +909,76 @@ void CLoopCloserERD<GRAPH_T>::generateHypotsPool(
 		}
 	}
 
-	// use a hypothesis ID with which the consistency matrix will then be
-	// formed
-	int hypot_counter = 0;
-	int invalid_hypots = 0;  // just for keeping track of them.
+	// Fetch the ICP constraints bi => ai for all the pairs at once.
+	// By default hypotheses will direct bi => ai; If the hypothesis is
+	// traversed the opposite way, take the opposite of the constraint
+	icp_jobs_t jobs(groupA.size() * groupB.size());
 	{
+		auto job_it = jobs.begin();
 		// iterate over all the nodes in both groups
-		for (std::vector<uint32_t>::const_iterator  // B - from
-			 b_it = groupB.begin();
-			 b_it != groupB.end(); ++b_it)
+		for (const uint32_t b : groupB)  // B - from
 		{
-			for (std::vector<uint32_t>::const_iterator  // A - to
-				 a_it = groupA.begin();
-				 a_it != groupA.end(); ++a_it)
+			for (const uint32_t a : groupA)  // A - to
 			{
-				// by default hypotheses will direct bi => ai; If the hypothesis
-				// is
-				// traversed the opposite way, take the opposite of the
-				// constraint
-				hypot_t* hypot = new hypot_t;
-				hypot->from = *b_it;
-				hypot->to = *a_it;
-				hypot->id = hypot_counter++;
-
-				// [from] *b_it ====[edge]===> [to]  *a_it
+				// [from] b ====[edge]===> [to] a
+				job_it->from = b;
+				job_it->to = a;
 
 				// Fetch and set the pose and LaserScan of from, to nodeIDs
 				//
-				// even if icp_ad_params NULL, it will be handled appropriately
-				// by the
-				// getICPEdge fun.
-				// bool from_success, to_success;
-				TGetICPEdgeAdParams* icp_ad_params = NULL;
+				// even if not given, they will be handled appropriately by
+				// the getICPEdges fun.
 				if (ad_params)
 				{
-					icp_ad_params = new TGetICPEdgeAdParams;
-					// from_success = fillNodePropsFromGroupParams(
+					job_it->use_ad_params = true;
 					fillNodePropsFromGroupParams(
-						*b_it, ad_params->groupB_params,
-						&icp_ad_params->from_params);
-					// to_success = fillNodePropsFromGroupParams(
+						b, ad_params->groupB_params,
+						&job_it->ad_params.from_params);
 					fillNodePropsFromGroupParams(
-						*a_it, ad_params->groupA_params,
-						&icp_ad_params->to_params);
-
-					// MRPT_LOG_DEBUG_STREAM(">>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>");
-					// MRPT_LOG_DEBUG_STREAM("From nodeID (other): " << *b_it);
-					// MRPT_LOG_DEBUG_STREAM("From params (other): "
-					//<< icp_ad_params->from_params.getAsString());
-					// MRPT_LOG_DEBUG_STREAM("from_success: " << (from_success?
-					// "TRUE" : "FALSE"));
-					// MRPT_LOG_DEBUG_STREAM("**********");
-					// MRPT_LOG_DEBUG_STREAM("To nodeID (own)   : " << *a_it);
-					// MRPT_LOG_DEBUG_STREAM("To params (own)   : "
-					//<< icp_ad_params->to_params.getAsString());
-					// MRPT_LOG_DEBUG_STREAM("to_success: " << (to_success?
-					// "TRUE" : "FALSE"));
-					// MRPT_LOG_DEBUG_STREAM("<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<");
+						a, ad_params->groupA_params,
+						&job_it->ad_params.to_params);
 				}
+				++job_it;
+			}
+		}
+	}
+	this->getICPEdges(jobs);
 
-				// fetch the ICP constraint bi => ai
-				mrpt::slam::CICP::TReturnInfo icp_info;
-				constraint_t edge;
-				bool found_edge = this->getICPEdge(
-					*b_it, *a_it, &edge, &icp_info, icp_ad_params);
+	// use a hypothesis ID with which the consistency matrix will then be
+	// formed
+	int hypot_counter = 0;
+	int invalid_hypots = 0;  // just for keeping track of them.
+	{
+		// Goodness Threshold
+		const double goodness_thresh =
+			m_laser_params.goodness_threshold_win.getMedian() *
+			m_lc_icp_constraint_factor;
 
-				hypot->setEdge(edge);
-				hypot->goodness =
-					icp_info.goodness;  // goodness related to the edge
+		for (const TICPEdgeJob& job : jobs)
+		{
+			hypot_t* hypot = new hypot_t;
+			hypot->from = job.from;
+			hypot->to = job.to;
+			hypot->id = hypot_counter++;
 
-				// Check if invalid
-				//
-				// Goodness Threshold
-				double goodness_thresh =
-					m_laser_params.goodness_threshold_win.getMedian() *
-					m_lc_icp_constraint_factor;
-				bool accept_goodness = icp_info.goodness > goodness_thresh;
-				MRPT_LOG_DEBUG_STREAM(
-					"generateHypotsPool:\nCurr. Goodness: "
-					<< icp_info.goodness << "|\t Threshold: " << goodness_thresh
-					<< " => " << (accept_goodness ? "ACCEPT" : "REJECT")
-					<< endl);
-
-				if (!found_edge || !accept_goodness)
-				{
-					hypot->is_valid = false;
-					invalid_hypots++;
-				}
-				generated_hypots->push_back(hypot);
-				MRPT_LOG_DEBUG_STREAM(hypot->getAsString());
+			hypot->setEdge(job.rel_edge);
+			hypot->goodness =
+				job.icp_info.goodness;  // goodness related to the edge
 
-				// delete pointer to getICPEdge additional parameters if they
-				// were
-				// initialized
-				delete icp_ad_params;
+			// Check if invalid
+			bool accept_goodness = job.icp_info.goodness > goodness_thresh;
+			MRPT_LOG_DEBUG_STREAM(
+				"generateHypotsPool:\nCurr. Goodness: "
+				<< job.icp_info.goodness << "|\t Threshold: " << goodness_thresh
+				<< " => " << (accept_goodness ? "ACCEPT" : "REJECT") << endl);
+
+			if (!job.found_edge || !accept_goodness)
+			{
+				hypot->is_valid = false;
+				invalid_hypots++;
 			}
+			generated_hypots->push_back(hypot);
+			MRPT_LOG_DEBUG_STREAM(hypot->getAsString());
 		}
 		MRPT_LOG_DEBUG_STREAM(
 			"Generated pool of hypotheses...\tsize = "
@@ -1008,6 +1098,19 @@ void CLoopCloserERD<GRAPH_T>::generatePWConsistenciesMatrix(
 		<< "\tgroupB: " << getSTLContainerAsString(groupB) << endl
 		<< "\tHypots pool Size: " << hypots_pool.size());
 
+	this->m_time_logger.enter("generatePWConsistenciesMatrix");
+
+	// Pairs of hypotheses to evaluate (the rest are nulled) and their
+	// Dijkstra links
+	struct TElement
+	{
+		TNodeID a1, a2, b1, b2;
+		const hypot_t *hypot_b2_a1, *hypot_b1_a2;
+		const path_t *path_a1_a2, *path_b1_b2;
+	};
+	std::vector<TElement> elements;
+	std::set<std::pair<TNodeID, TNodeID>> needed_paths;
+
 	// b1
 	for (std::vector<uint32_t>::const_iterator b1_it = groupB.begin();
 		 b1_it != groupB.end(); ++b1_it)
@@ -1027,8 +1130,6 @@ void CLoopCloserERD<GRAPH_T>::generatePWConsistenciesMatrix(
 				TNodeID a1 = *a1_it;
 				hypot_t* hypot_b2_a1 =
 					this->findHypotByEnds(hypots_pool, b2, a1);
-				// MRPT_LOG_DEBUG_STREAM("hypot_b2_a1: " <<
-				// hypot_b2_a1->getAsString());
 
 				// a2
 				for (std::vector<uint32_t>::const_iterator a2_it = a1_it + 1;
@@ -1037,87 +1138,88 @@ void CLoopCloserERD<GRAPH_T>::generatePWConsistenciesMatrix(
 					TNodeID a2 = *a2_it;
 					hypot_t* hypot_b1_a2 =
 						this->findHypotByEnds(hypots_pool, b1, a2);
-					// MRPT_LOG_DEBUG_STREAM("hypot_b1_a2: " <<
-					// hypot_b1_a2->getAsString());
-
-					double consistency;
 
-					// compute consistency element
 					if (hypot_b2_a1->is_valid && hypot_b1_a2->is_valid)
 					{
-						// extract vector of hypotheses that connect the given
-						// nodes,
-						// instead of passing the whole hypothesis pool.
-						hypotsp_t extracted_hypots;
-						extracted_hypots.push_back(hypot_b2_a1);
-						extracted_hypots.push_back(hypot_b1_a2);
-
-						paths_t* curr_opt_paths = NULL;
-						if (groupA_opt_paths || groupB_opt_paths)
-						{  // fill curr_opt_paths
-							curr_opt_paths = new paths_t();
-						}
-
-						// decide on additional optimal paths
-						if (curr_opt_paths)
-						{
-							// groupA
-							if (groupA_opt_paths)
-							{  // a1 -> a2 optimal path
-								const path_t* p = this->findPathByEnds(
-									*groupA_opt_paths, a1, a2,
-									/*throw_exc=*/true);
-								curr_opt_paths->push_back(*p);
-							}
-							else
-							{  // empty
-								curr_opt_paths->push_back(path_t());
-							}
-
-							if (groupB_opt_paths)
-							{  // b1 -> b2 optimal path
-								const path_t* p = this->findPathByEnds(
-									*groupB_opt_paths, b1, b2,
-									/*throw_exc=*/true);
-								curr_opt_paths->push_back(*p);
-							}
-							else
-							{  // empty
-								curr_opt_paths->push_back(path_t());
-							}
-						}
-
-						consistency = this->generatePWConsistencyElement(
-							a1, a2, b1, b2, extracted_hypots, curr_opt_paths);
-
-						delete curr_opt_paths;
+						elements.push_back(
+							TElement{a1, a2, b1, b2, hypot_b2_a1, hypot_b1_a2,
+									 NULL, NULL});
+						needed_paths.insert(std::make_pair(a1, a2));
+						needed_paths.insert(std::make_pair(b1, b2));
 					}
 					else
 					{  //  null those that don't look good
-						consistency = 0;
+						// fill the PW consistency matrix corresponding
+						// element - symmetrical
+						int id1 = hypot_b2_a1->id;
+						int id2 = hypot_b1_a2->id;
+						(*consist_matrix)(id1, id2) = 0;
+						(*consist_matrix)(id2, id1) = 0;
 					}
+				}
+			}
+		}
+	}
 
-					// MRPT_LOG_DEBUG_STREAM(
-					//"Adding hypothesis consistency for nodeIDs: "
-					//<< "[b1] " << b1 << ", [b2] -> " << b2
-					//<< ", [a1] -> " << a1 << ", [a2] -> " << a2
-					//<< " ==> " << consistency << endl);
+	// Use the given optimal paths, or compute the Dijkstra links a1 => a2,
+	// b1 => b2. The latter is done here once per pair of nodes and not for
+	// every element, since execDijkstraProjection modifies the class state.
+	mrpt::aligned_std_map<std::pair<TNodeID, TNodeID>, path_t> paths;
+	for (const auto& ends : needed_paths)
+	{
+		const bool is_groupA =
+			std::find(groupA.begin(), groupA.end(), ends.first) !=
+			groupA.end();
+		const paths_t* opt_paths =
+			is_groupA ? groupA_opt_paths : groupB_opt_paths;
+		if (opt_paths)
+		{
+			paths[ends] = *this->findPathByEnds(
+				*opt_paths, ends.first, ends.second, /*throw_exc=*/true);
+		}
+		else
+		{
+			MRPT_LOG_DEBUG_STREAM(
+				"Running dijkstra " << ends.first << " => " << ends.second);
+			execDijkstraProjection(
+				/*starting_node=*/ends.first, /*ending_node=*/ends.second);
+			const path_t* p = this->queryOptimalPath(ends.second);
+			ASSERTDEB_(p);
+			p->assertIsBetweenNodeIDs(
+				/*start=*/ends.first, /*end*/ ends.second);
+			paths[ends] = *p;
+		}
+	}
+	for (TElement& e : elements)
+	{
+		e.path_a1_a2 = &paths[std::make_pair(e.a1, e.a2)];
+		e.path_b1_b2 = &paths[std::make_pair(e.b1, e.b2)];
+	}
 
-					// fill the PW consistency matrix corresponding element -
-					// symmetrical
-					int id1 = hypot_b2_a1->id;
-					int id2 = hypot_b1_a2->id;
+	// compute the consistency elements, each one in its own matrix entries
+	auto compute_elements = [&](size_t first, size_t last) {
+		for (size_t i = first; i < last; i++)
+		{
+			const TElement& e = elements[i];
+			const double consistency = computePWConsistencyElement(
+				*e.path_a1_a2, *e.path_b1_b2, *e.hypot_b1_a2, *e.hypot_b2_a1);
 
-					(*consist_matrix)(id1, id2) = consistency;
-					(*consist_matrix)(id2, id1) = consistency;
+			// fill the PW consistency matrix corresponding element -
+			// symmetrical
+			int id1 = e.hypot_b2_a1->id;
+			int id2 = e.hypot_b1_a2->id;
 
-					// MRPT_LOG_DEBUG_STREAM("id1 = " << id1 << "\t|"
-					//<< "id2 = " << id2 << "\t|"
-					//<< "consistency = " << consistency);
-				}
-			}
+			(*consist_matrix)(id1, id2) = consistency;
+			(*consist_matrix)(id2, id1) = consistency;
 		}
-	}
+	};
+	mrpt::system::CWorkerThreadsPool* pool = this->getLCThreadPool();
+	if (pool)
+		pool->parallel_for(elements.size(), compute_elements, 16);
+	else
+		compute_elements(0, elements.size());
+
+	this->m_time_logger.leave("generatePWConsistenciesMatrix");
 
 	// MRPT_LOG_WARN_STREAM("Consistency matrix:" << endl
 	//<< this->header_sep << endl
@@ -1180,7 +1282,7 @@ double CLoopCloserERD<GRAPH_T>::generatePWConsistencyElement(
 
 	// b1 ==> b2
 	const path_t* path_b1_b2;
-	if (!opt_paths || opt_paths->rend()->isEmpty())
+	if (!opt_paths || opt_paths->rbegin()->isEmpty())
 	{
 		MRPT_LOG_DEBUG_STREAM(
 			"Running djkstra [b1] " << b1 << " => [b2] " << b2);
@@ -1201,12 +1303,9 @@ double CLoopCloserERD<GRAPH_T>::generatePWConsistencyElement(
 	// forward edge b2=>a1
 	hypot_t* hypot_b2_a1 = this->findHypotByEnds(hypots, b2, a1);
 
-	// Composition of Poses
-	// Order : a1 ==> a2 ==> b1 ==> b2 ==> a1
-	constraint_t res_transform(path_a1_a2->curr_pose_pdf);
-	res_transform += hypot_b1_a2->getInverseEdge();
-	res_transform += path_b1_b2->curr_pose_pdf;
-	res_transform += hypot_b2_a1->getEdge();
+	constraint_t res_transform;
+	const double consistency_elem = computePWConsistencyElement(
+		*path_a1_a2, *path_b1_b2, *hypot_b1_a2, *hypot_b2_a1, &res_transform);
 
 	MRPT_LOG_DEBUG_STREAM(
 		"\n-----------Resulting Transformation----------- Hypots: #"
@@ -1224,6 +1323,27 @@ double CLoopCloserERD<GRAPH_T>::generatePWConsistencyElement(
 		<< "hypot_b2_a1:\n"
 		<< hypot_b2_a1->getEdge() << endl);
 
+	return consistency_elem;
+	MRPT_END;
+}  // end of generatePWConsistencyElement
+
+template <class GRAPH_T>
+double CLoopCloserERD<GRAPH_T>::computePWConsistencyElement(
+	const path_t& path_a1_a2, const path_t& path_b1_b2,
+	const hypot_t& hypot_b1_a2, const hypot_t& hypot_b2_a1,
+	constraint_t* res_transform_out /*=NULL*/)
+{
+	MRPT_START;
+	using namespace mrpt::math;
+
+	// Composition of Poses
+	// Order : a1 ==> a2 ==> b1 ==> b2 ==> a1
+	constraint_t res_transform(path_a1_a2.curr_pose_pdf);
+	res_transform += hypot_b1_a2.getInverseEdge();
+	res_transform += path_b1_b2.curr_pose_pdf;
+	res_transform += hypot_b2_a1.getEdge();
+	if (res_transform_out) *res_transform_out = res_transform;
+
 	// get the vector of the corresponding transformation - [x, y, phi] form
 	dynamic_vector<double> T;
 	res_transform.getMeanVal().getAsVector(T);
@@ -1239,14 +1359,9 @@ double CLoopCloserERD<GRAPH_T>::generatePWConsistencyElement(
 	double exponent = (-T.transpose() * cov_mat * T).value();
 	double consistency_elem = exp(exponent);
 
-	// cout << "T = " << endl << T << endl;
-	// cout << "exponent = " << exponent << endl;
-	// cout << "consistency_elem = " << consistency_elem << endl;
-	// mrpt::system::pause();
-
 	return consistency_elem;
 	MRPT_END;
-}  // end of generatePWConsistencyElement
+}  // end of computePWConsistencyElement
 
 template <class GRAPH_T>
 const mrpt::graphslam::TUncertaintyPath<GRAPH_T>*
@@ -2621,7 +2736,8 @@ void CLoopCloserERD<GRAPH_T>::TLaserParams::loadFromConfigFile(
 
 template <class GRAPH_T>
 CLoopCloserERD<GRAPH_T>::TLoopClosureParams::TLoopClosureParams()
-	: keystroke_map_partitions("b"),
+	: LC_num_threads(1),
+	  keystroke_map_partitions("b"),
 	  balloon_elevation(3),
 	  balloon_radius(0.5),
 	  balloon_std_color(153, 0, 153),
@@ -2654,6 +2770,8 @@ void CLoopCloserERD<GRAPH_T>::TLoopClosureParams::dumpToTextStream(
 	   << (LC_check_curr_partition_only ? "TRUE" : "FALSE") << endl;
 	ss << "New registered nodes required for full partitioning   = "
 	   << full_partition_per_nodes << endl;
+	ss << "Threads for evaluating loop closures (0: all cores)   = "
+	   << LC_num_threads << endl;
 	ss << "Visualize map partitions                              = "
 	   << (visualize_map_partitions ? "TRUE" : "FALSE") << endl;
 
@@ -2677,6 +2795,8 @@ void CLoopCloserERD<GRAPH_T>::TLoopClosureParams::loadFromConfigFile(
 		source.read_bool(section, "LC_check_curr_partition_only", true, false);
 	full_partition_per_nodes =
 		source.read_int(section, "full_partition_per_nodes", 50, false);
+	LC_num_threads = source.read_uint64_t(
+		section, "LC_num_threads", LC_num_threads, false);
 	visualize_map_partitions = source.read_bool(
 		"VisualizationParameters", "visualize_map_partitions", true, false);
 
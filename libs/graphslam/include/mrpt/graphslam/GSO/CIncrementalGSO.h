@@ -0,0 +1,118 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#ifndef CINCREMENTALGSO_H
+#define CINCREMENTALGSO_H
+
+#include <mrpt/graphslam/GSO/CLevMarqGSO.h>
+#include <mrpt/graphslam/CIncrementalPoseGraphSolver.h>
+
+namespace mrpt
+{
+namespace graphslam
+{
+namespace optimizers
+{
+/**\brief Incremental non-linear graph slam optimization scheme.
+ *
+ * ## Description
+ *
+ * Unlike CLevMarqGSO, which solves the whole problem (or that of the nodes
+ * around the current one) from scratch every time a node is registered,
+ * this optimizer keeps the factorized linear system between calls and
+ * updates it with the new nodes and edges only, relinearizing just those
+ * nodes whose estimate moved significantly. See
+ * mrpt::graphslam::CIncrementalPoseGraphSolver for the details. This keeps
+ * an approximately constant latency per new node, except for those closing
+ * a loop, whose cost grows with the length of the loop.
+ *
+ * The time spent in each stage of the solver is recorded in the class
+ * time logger (see getDescriptiveReport()) and the statistics of the last
+ * update are available via getLastUpdateStats().
+ *
+ * The graph visualization is shared with CLevMarqGSO, and so are its
+ * parameters in the \b VisualizationParameters section.
+ *
+ * ### .ini Configuration Parameters
+ *
+ * \htmlinclude graphslam-engine_config_params_preamble.txt
+ *
+ * - \b class_verbosity
+ *   + \a Section       : OptimizerParameters
+ *   + \a Default value : 1 (mrpt::system::LVL_INFO)
+ *   + \a Required      : FALSE
+ *
+ * - \b incremental_relinearize_threshold
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 0.05
+ *  + \a Required      : FALSE
+ *  + \a Description   : Nodes whose pending increment (in the Lie algebra)
+ *  is larger than this value are relinearized.
+ *
+ * - \b incremental_wildfire_threshold
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 1e-3
+ *  + \a Required      : FALSE
+ *  + \a Description   : Changes in the solution smaller than this value are
+ *  not propagated to older nodes.
+ *
+ * - \b incremental_max_iterations
+ *  + \a Section       : OptimizerParameters
+ *  + \a Default value : 1
+ *  + \a Required      : FALSE
+ *  + \a Description   : Relinearization and solving steps per update.
+ *
+ * \note [New in MRPT 2.0.0]
+ * \ingroup mrpt_graphslam_grp
+ */
+template <class GRAPH_T = typename mrpt::graphs::CNetworkOfPoses2DInf>
+class CIncrementalGSO
+	: public mrpt::graphslam::optimizers::CLevMarqGSO<GRAPH_T>
+{
+   public:
+	/**\brief Handy typedefs */
+	/**\{*/
+	using lm_parent = mrpt::graphslam::optimizers::CLevMarqGSO<GRAPH_T>;
+	using solver_t = mrpt::graphslam::CIncrementalPoseGraphSolver<GRAPH_T>;
+	/**\}*/
+
+	CIncrementalGSO();
+	~CIncrementalGSO() {}
+	bool updateState(
+		mrpt::obs::CActionCollection::Ptr action,
+		mrpt::obs::CSensoryFrame::Ptr observations,
+		mrpt::obs::CObservation::Ptr observation);
+
+	void initializeVisuals();
+	void loadParams(const std::string& source_fname);
+	void printParams() const;
+	void getDescriptiveReport(std::string* report_str) const;
+
+	/** Statistics and timing of the last update of the solver */
+	const typename solver_t::TUpdateStats& getLastUpdateStats() const
+	{
+		return m_solver.getLastUpdateStats();
+	}
+
+   protected:
+	/** Updates the solver with the new nodes/edges. Called with the graph
+	 * section locked. */
+	void updateSolver();
+	void optimizeGraph();
+
+	solver_t m_solver;
+	size_t m_last_num_edges;
+};
+}  // namespace optimizers
+}  // namespace graphslam
+}  // namespace mrpt
+
+#include "CIncrementalGSO_impl.h"
+
+#endif /* end of include guard: CINCREMENTALGSO_H */
@@ -0,0 +1,194 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#ifndef CINCREMENTALGSO_IMPL_H
+#define CINCREMENTALGSO_IMPL_H
+
+namespace mrpt
+{
+namespace graphslam
+{
+namespace optimizers
+{
+template <class GRAPH_T>
+CIncrementalGSO<GRAPH_T>::CIncrementalGSO() : m_last_num_edges(0)
+{
+	MRPT_START;
+	this->initializeLoggers("CIncrementalGSO");
+	MRPT_END;
+}
+
+template <class GRAPH_T>
+bool CIncrementalGSO<GRAPH_T>::updateState(
+	mrpt::obs::CActionCollection::Ptr action,
+	mrpt::obs::CSensoryFrame::Ptr observations,
+	mrpt::obs::CObservation::Ptr observation)
+{
+	MRPT_START;
+	MRPT_UNUSED_PARAM(action);
+	MRPT_UNUSED_PARAM(observations);
+	MRPT_UNUSED_PARAM(observation);
+
+	if (this->m_graph->nodeCount() < this->m_min_nodes_for_optimization)
+		return false;
+
+	// Called even if there are no new nodes/edges, since the poses in the
+	// graph may have been overwritten by the engine (e.g. by its Dijkstra
+	// estimation after a new node). In that case, the solver just writes
+	// them again.
+	this->updateSolver();
+	return true;
+
+	MRPT_END;
+}
+
+template <class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::updateSolver()
+{
+	MRPT_START;
+	const size_t num_nodes = this->m_graph->nodeCount();
+	const size_t num_edges = this->m_graph->edges.size();
+	this->registered_new_node = num_nodes > this->m_last_total_num_of_nodes;
+	const bool graph_changed =
+		this->registered_new_node || num_edges != m_last_num_edges;
+	this->m_last_total_num_of_nodes = num_nodes;
+	m_last_num_edges = num_edges;
+
+	this->m_time_logger.enter("CIncrementalGSO::updateSolver");
+	m_solver.update(*this->m_graph);
+	this->m_time_logger.leave("CIncrementalGSO::updateSolver");
+
+	const auto& stats = m_solver.getLastUpdateStats();
+	this->m_just_fully_optimized_graph =
+		stats.num_backsub_variables == m_solver.getVariableCount();
+	if (stats.num_iterations)
+	{
+		this->m_time_logger.registerUserMeasure(
+			"CIncrementalGSO.linearize", stats.time_linearize);
+		this->m_time_logger.registerUserMeasure(
+			"CIncrementalGSO.factorize", stats.time_factorize);
+		this->m_time_logger.registerUserMeasure(
+			"CIncrementalGSO.solve", stats.time_solve);
+	}
+	if (graph_changed)
+		MRPT_LOG_DEBUG_STREAM(
+			"Solver update: " << stats.num_new_variables << " new nodes, "
+							  << stats.num_new_edges << " new edges, "
+							  << stats.num_relinearized << " relinearized, "
+							  << stats.num_refactored_columns
+							  << " refactored columns, "
+							  << stats.num_backsub_variables
+							  << " updated nodes. Time: " << stats.time_total
+							  << " s");
+	MRPT_END;
+}
+
+template <class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::optimizeGraph()
+{
+	MRPT_START;
+	std::lock_guard<std::mutex> graph_lock(*this->m_graph_section);
+	this->updateSolver();
+	MRPT_END;
+}
+
+template <class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::initializeVisuals()
+{
+	MRPT_START;
+	ASSERTDEB_(this->m_has_read_config);
+	// Same as CLevMarqGSO, but without the optimization distance disk:
+	lm_parent::parent::initializeVisuals();
+	this->initGraphVisualization();
+	MRPT_END;
+}
+
+template <class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::loadParams(const std::string& source_fname)
+{
+	MRPT_START;
+	lm_parent::loadParams(source_fname);
+
+	// The whole graph is always being optimized:
+	this->opt_params.optimization_distance = -1;
+	this->opt_params.optimization_on_second_thread = false;
+
+	mrpt::config::CConfigFile source(source_fname);
+	const std::string sect = "OptimizerParameters";
+	auto& opts = m_solver.options;
+	opts.relinearize_threshold = source.read_double(
+		sect, "incremental_relinearize_threshold", opts.relinearize_threshold,
+		false);
+	opts.wildfire_threshold = source.read_double(
+		sect, "incremental_wildfire_threshold", opts.wildfire_threshold,
+		false);
+	opts.max_iterations = source.read_uint64_t(
+		sect, "incremental_max_iterations", opts.max_iterations, false);
+
+	MRPT_END;
+}
+
+template <class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::printParams() const
+{
+	lm_parent::printParams();
+
+	const auto& opts = m_solver.options;
+	std::cout << "-----------[ Incremental Optimization ] -------\n";
+	std::cout << "Relinearization threshold      = "
+			  << opts.relinearize_threshold << "\n";
+	std::cout << "Wildfire threshold             = " << opts.wildfire_threshold
+			  << "\n";
+	std::cout << "Max. iterations per update     = " << opts.max_iterations
+			  << "\n";
+}
+
+template <class GRAPH_T>
+void CIncrementalGSO<GRAPH_T>::getDescriptiveReport(
+	std::string* report_str) const
+{
+	MRPT_START;
+	using namespace std;
+
+	const std::string report_sep(2, '\n');
+	const std::string header_sep(80, '#');
+
+	// Report on graph
+	stringstream class_props_ss;
+	class_props_ss << "Incremental Optimization Summary: " << std::endl;
+	class_props_ss << header_sep << std::endl;
+	class_props_ss << "Nodes in the solver: " << m_solver.getVariableCount()
+				   << std::endl;
+	class_props_ss << "Edges in the solver: " << m_solver.getEdgeCount()
+				   << std::endl;
+
+	// time and output logging
+	const std::string time_res = this->m_time_logger.getStatsAsText();
+	const std::string output_res = this->getLogAsString();
+
+	// merge the individual reports
+	report_str->clear();
+	lm_parent::parent::getDescriptiveReport(report_str);
+
+	*report_str += class_props_ss.str();
+	*report_str += report_sep;
+
+	*report_str += time_res;
+	*report_str += report_sep;
+
+	*report_str += output_res;
+	*report_str += report_sep;
+
+	MRPT_END;
+}
+}  // namespace optimizers
+}  // namespace graphslam
+}  // namespace mrpt
+
+#endif /* end of include guard: CINCREMENTALGSO_IMPL_H */
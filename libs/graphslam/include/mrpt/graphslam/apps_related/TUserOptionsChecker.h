@@ -23,6 +23,7 @@
 #include <mrpt/graphslam/ERD/CEmptyERD.h>
 #include <mrpt/graphslam/ERD/CLoopCloserERD.h>
 #include <mrpt/graphslam/GSO/CLevMarqGSO.h>
+#include <mrpt/graphslam/GSO/CIncrementalGSO.h>
 
 #include <string>
 #include <iostream>
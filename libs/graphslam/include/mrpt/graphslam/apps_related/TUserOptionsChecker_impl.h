@@ -62,6 +62,8 @@ void TUserOptionsChecker<GRAPH_t>::createDeciderOptimizerMappings()
 	// optimizers
 	optimizers_map["CLevMarqGSO"] =
 		&createGraphSlamOptimizer<CLevMarqGSO<GRAPH_t>>;
+	optimizers_map["CIncrementalGSO"] =
+		&createGraphSlamOptimizer<CIncrementalGSO<GRAPH_t>>;
 	optimizers_map["CEmptyGSO"] =
 		&createGraphSlamOptimizer<CLevMarqGSO<GRAPH_t>>;
 
@@ -428,6 +430,19 @@ void TUserOptionsChecker<GRAPH_t>::populateDeciderOptimizerProperties()
 		optimizers_descriptions.push_back(opt);
 	}
 
+	{  // CIncrementalGSO
+		TOptimizerProps* opt = new TOptimizerProps;
+		opt->name = "CIncrementalGSO";
+		opt->description =
+			"Incremental (iSAM-like) non-linear graphSLAM solver, with "
+			"bounded per-node cost";
+		opt->is_mr_slam_class = true;
+		opt->is_slam_2d = true;
+		opt->is_slam_3d = true;
+
+		optimizers_descriptions.push_back(opt);
+	}
+
 	MRPT_END
 }
 }
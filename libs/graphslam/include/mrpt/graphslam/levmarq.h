@@ -63,6 +63,13 @@ namespace graphslam
  *		- "e2": (default=1e-6) Lev-marq algorithm iteration stopping criterion
  *#2:
  *|delta_incr| < e2*(x_norm+e2)
+ *		- "num_threads": (default=1) Number of threads used to evaluate the
+ *errors and Jacobians of the constraints. 0 means one per CPU core.
+ *
+ * The upper triangular part of the Hessian is kept in a block sparse
+ *structure whose pattern is computed once from the graph topology, so the
+ *symbolic part of the sparse Cholesky decomposition (including its AMD
+ *ordering) is also computed only once and reused in all iterations.
  *
  * \note The following graph types are supported:
  *mrpt::graphs::CNetworkOfPoses2D, mrpt::graphs::CNetworkOfPoses3D,
@@ -118,6 +125,7 @@ void optimize_graph_spa_levmarq(
 
 	const double SCALE_HESSIAN =
 		extra_params.getWithDefaultVal("scale_hessian", 1);
+	const size_t num_threads = extra_params.getWithDefaultVal("num_threads", 1);
 
 	mrpt::system::CTimeLogger profiler(enable_profiler);
 	profiler.enter("optimize_graph_spa_levmarq (entire)");
@@ -214,11 +222,19 @@ void optimize_graph_spa_levmarq(
 		SparseCholeskyDecompPtr;
 	SparseCholeskyDecompPtr ptrCh;
 
+	std::unique_ptr<mrpt::system::CWorkerThreadsPool> threadPool;
+	if (num_threads != 1)
+		threadPool.reset(new mrpt::system::CWorkerThreadsPool(
+			(num_threads != 0
+				 ? num_threads
+				 : mrpt::system::CWorkerThreadsPool::hardwareThreads()) -
+			1));
+
 	// The list of Jacobians: for each constraint i->j,
 	//  we need the pair of Jacobians: { dh(xi,xj)_dxi, dh(xi,xj)_dxj },
-	//  which are "first" and "second" in each pair.
-	// Index of the map are the node IDs {i,j} for each contraint.
-	typename gst::map_pairIDs_pairJacobs_t lstJacobians;
+	//  which are "first" and "second" in each pair, in the same order than
+	//  "lstObservationData".
+	mrpt::aligned_std_vector<typename gst::TPairJacobs> lstJacobians;
 	// The vector of errors: err_k = SE(2/3)::pseudo_Ln( P_i * EDGE_ij *
 	// inv(P_j) )
 	mrpt::aligned_std_vector<typename gst::Array_O>
@@ -230,7 +246,7 @@ void optimize_graph_spa_levmarq(
 	// ===================================
 	profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");
 	double total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
-		graph, lstObservationData, lstJacobians, errs);
+		lstObservationData, lstJacobians, errs, threadPool.get());
 	profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");
 
 	// Only once (since this will be static along iterations), build a quick
@@ -238,6 +254,7 @@ void optimize_graph_spa_levmarq(
 	//  indices of the free nodes associated to the (first_id,second_id) of each
 	//  Jacobian pair:
 	// ------------------------------------------------------------------------
+	profiler.enter("optimize_graph_spa_levmarq.sp_H:pattern");
 	vector<pair<size_t, size_t>>
 		observationIndex_to_relatedFreeNodeIndex;  // "relatedFreeNodeIndex"
 	// means into
@@ -247,24 +264,34 @@ void optimize_graph_spa_levmarq(
 	// "nodes_to_optimize"
 	observationIndex_to_relatedFreeNodeIndex.reserve(nObservations);
 	ASSERTDEB_(lstJacobians.size() == nObservations);
-	for (typename gst::map_pairIDs_pairJacobs_t::const_iterator itJ =
-			 lstJacobians.begin();
-		 itJ != lstJacobians.end(); ++itJ)
 	{
-		const TNodeID id1 = itJ->first.first;
-		const TNodeID id2 = itJ->first.second;
-		observationIndex_to_relatedFreeNodeIndex.push_back(
-			std::make_pair(
-				mrpt::containers::find_in_vector(id1, *nodes_to_optimize),
-				mrpt::containers::find_in_vector(id2, *nodes_to_optimize)));
+		// (std::set is sorted, so we can use binary search on this copy)
+		const vector<TNodeID> freeNodeIDs(
+			nodes_to_optimize->begin(), nodes_to_optimize->end());
+		const auto freeNodeIndex = [&freeNodeIDs](const TNodeID id) {
+			auto it =
+				std::lower_bound(freeNodeIDs.begin(), freeNodeIDs.end(), id);
+			return (it != freeNodeIDs.end() && *it == id)
+					   ? static_cast<size_t>(it - freeNodeIDs.begin())
+					   : string::npos;
+		};
+		for (const auto& obs : lstObservationData)
+			observationIndex_to_relatedFreeNodeIndex.emplace_back(
+				freeNodeIndex(obs.edge->first.first),
+				freeNodeIndex(obs.edge->first.second));
 	}
 
+	// The sparsity pattern of the Hessian, fixed for all iterations:
+	detail::BlockSparseHessian<typename gst::matrix_VxV_t, DIMS_POSE> H;
+	H.buildPattern(nFreeNodes, observationIndex_to_relatedFreeNodeIndex);
+	H.setZero();
+	profiler.leave("optimize_graph_spa_levmarq.sp_H:pattern");
+
 	// other important vars for the main loop:
 	CVectorDouble grad(nFreeNodes * DIMS_POSE);
 	grad.setZero();
-	using map_ID2matrix_VxV_t =
-		mrpt::aligned_std_map<TNodeID, typename gst::matrix_VxV_t>;
-	vector<map_ID2matrix_VxV_t> H_map(nFreeNodes);
+	// The sparse H+lambda*I. Must live as long as "ptrCh".
+	CSparseMatrix sp_H;
 
 	double lambda = initial_lambda;  // Will be actually set on first iteration.
 	double v = 1;  // was 2, changed since it's modified in the first pass.
@@ -304,15 +331,9 @@ void optimize_graph_spa_levmarq(
 			// "lstObservationData":
 			ASSERTDEB_EQUAL_(lstJacobians.size(), lstObservationData.size());
 			{
-				size_t idx_obs;
-				typename gst::map_pairIDs_pairJacobs_t::const_iterator itJ;
-
-				for (idx_obs = 0, itJ = lstJacobians.begin();
-					 itJ != lstJacobians.end(); ++itJ, ++idx_obs)
+				for (size_t idx_obs = 0; idx_obs < nObservations; ++idx_obs)
 				{
-					// make sure they're in the expected order!
-					ASSERTDEB_(
-						itJ->first == lstObservationData[idx_obs].edge->first);
+					const auto& jacobs = lstJacobians[idx_obs];
 
 					//  grad[k] += J^t_{i->k} * Inf.Matrix * errs_i
 					//    k: [0,nFreeNodes-1]     <-- IDs.first & IDs.second
@@ -329,7 +350,7 @@ void optimize_graph_spa_levmarq(
 					if (idx1 != string::npos)
 						detail::AuxErrorEval<typename gst::edge_t, gst>::
 							multiply_Jt_W_err(
-								itJ->second.first /* J */,
+								jacobs.first /* J */,
 								lstObservationData[idx_obs].edge /* W */,
 								errs[idx_obs] /* err */,
 								grad_parts[idx1] /* out */
@@ -338,7 +359,7 @@ void optimize_graph_spa_levmarq(
 					if (idx2 != string::npos)
 						detail::AuxErrorEval<typename gst::edge_t, gst>::
 							multiply_Jt_W_err(
-								itJ->second.second /* J */,
+								jacobs.second /* J */,
 								lstObservationData[idx_obs].edge /* W */,
 								errs[idx_obs] /* err */,
 								grad_parts[idx2] /* out */
@@ -370,87 +391,50 @@ void optimize_graph_spa_levmarq(
 
 			profiler.enter("optimize_graph_spa_levmarq.sp_H:build map");
 			// ======================================================================
-			// Build sparse representation of the upper triangular part of
-			//  the Hessian matrix H = J^t * J
-			//
-			// Sparse memory structure is a vector of maps, such as:
-			//  - H_map[i]: corresponds to the i'th column of H.
-			//              Here "i" corresponds to [0,N-1] indices of
-			//              appearance in the map "*nodes_to_optimize".
-			//  - H_map[i][j] is the entry for the j'th row, with "j" also in
-			//  the range [0,N-1] as ordered in "*nodes_to_optimize".
+			// Build the upper triangular part of the Hessian matrix
+			//  H = J^t * J, in the fixed block sparse structure "H", where
+			//  block (i,j) is for the i'th and j'th free nodes in the range
+			//  [0,N-1], as ordered in "*nodes_to_optimize".
+			//  Note that H is not reset here, so it also keeps the terms
+			//  from the former accepted estimates, which acts as an extra
+			//  damping.
 			// ======================================================================
+			for (size_t idxObs = 0; idxObs < nObservations; ++idxObs)
 			{
-				size_t idxObs;
-				typename gst::map_pairIDs_pairJacobs_t::const_iterator
-					itJacobPair;
-
-				for (idxObs = 0, itJacobPair = lstJacobians.begin();
-					 idxObs < nObservations; ++itJacobPair, ++idxObs)
+				const auto& jacobs = lstJacobians[idxObs];
+				const auto& edge = lstObservationData[idxObs].edge;
+				const auto& eb = H.edge_blocks[idxObs];
+
+				// J1^t * Inf * J1 and J2^t * Inf * J2, for free nodes:
+				typename gst::matrix_VxV_t JtJ(
+					mrpt::math::UNINITIALIZED_MATRIX);
+				if (eb.b11 != string::npos)
+				{
+					detail::AuxErrorEval<typename gst::edge_t, gst>::
+						multiplyJtLambdaJ(jacobs.first, JtJ, edge);
+					H.blocks[eb.b11] += JtJ;
+				}
+				if (eb.b22 != string::npos)
+				{
+					detail::AuxErrorEval<typename gst::edge_t, gst>::
+						multiplyJtLambdaJ(jacobs.second, JtJ, edge);
+					H.blocks[eb.b22] += JtJ;
+				}
+				// Are both free nodes? -> Ji^t * Inf * Jj, with "i" the one
+				// with the smallest index, since we only build the upper
+				// triangular part:
+				if (eb.b12 != string::npos)
 				{
-					// We sort IDs such as "i" < "j" and we can build just the
-					// upper triangular part of the Hessian.
 					const bool edge_straight =
-						itJacobPair->first.first < itJacobPair->first.second;
-
-					// Indices in the "H_map" vector:
-					const size_t idx_i =
-						edge_straight
-							? observationIndex_to_relatedFreeNodeIndex[idxObs]
-								  .first
-							: observationIndex_to_relatedFreeNodeIndex[idxObs]
-								  .second;
-					const size_t idx_j =
-						edge_straight
-							? observationIndex_to_relatedFreeNodeIndex[idxObs]
-								  .second
-							: observationIndex_to_relatedFreeNodeIndex[idxObs]
-								  .first;
-
-					const bool is_i_free_node = idx_i != string::npos;
-					const bool is_j_free_node = idx_j != string::npos;
-
-					// Take references to both Jacobians (wrt pose "i" and pose
-					// "j"), taking into account the possible
-					// switch in their order:
-
-					const typename gst::matrix_VxV_t& J1 =
-						edge_straight ? itJacobPair->second.first
-									  : itJacobPair->second.second;
-					const typename gst::matrix_VxV_t& J2 =
-						edge_straight ? itJacobPair->second.second
-									  : itJacobPair->second.first;
-
-					// Is "i" a free (to be optimized) node? -> Ji^t * Inf *  Ji
-					if (is_i_free_node)
-					{
-						typename gst::matrix_VxV_t JtJ(
-							mrpt::math::UNINITIALIZED_MATRIX);
-						detail::AuxErrorEval<typename gst::edge_t, gst>::
-							multiplyJtLambdaJ(
-								J1, JtJ, lstObservationData[idxObs].edge);
-						H_map[idx_i][idx_i] += JtJ;
-					}
-					// Is "j" a free (to be optimized) node? -> Jj^t * Inf *  Jj
-					if (is_j_free_node)
-					{
-						typename gst::matrix_VxV_t JtJ(
-							mrpt::math::UNINITIALIZED_MATRIX);
-						detail::AuxErrorEval<typename gst::edge_t, gst>::
-							multiplyJtLambdaJ(
-								J2, JtJ, lstObservationData[idxObs].edge);
-						H_map[idx_j][idx_j] += JtJ;
-					}
-					// Are both "i" and "j" free nodes? -> Ji^t * Inf *  Jj
-					if (is_i_free_node && is_j_free_node)
-					{
-						typename gst::matrix_VxV_t JtJ(
-							mrpt::math::UNINITIALIZED_MATRIX);
-						detail::AuxErrorEval<typename gst::edge_t, gst>::
-							multiplyJ1tLambdaJ2(
-								J1, J2, JtJ, lstObservationData[idxObs].edge);
-						H_map[idx_j][idx_i] += JtJ;
-					}
+						observationIndex_to_relatedFreeNodeIndex[idxObs]
+							.first <
+						observationIndex_to_relatedFreeNodeIndex[idxObs].second;
+					detail::AuxErrorEval<typename gst::edge_t, gst>::
+						multiplyJ1tLambdaJ2(
+							edge_straight ? jacobs.first : jacobs.second,
+							edge_straight ? jacobs.second : jacobs.first, JtJ,
+							edge);
+					H.blocks[eb.b12] += JtJ;
 				}
 			}
 			profiler.leave("optimize_graph_spa_levmarq.sp_H:build map");
@@ -461,23 +445,7 @@ void optimize_graph_spa_levmarq(
 			{
 				profiler.enter(
 					"optimize_graph_spa_levmarq.lambda_init");  // ---\  .
-				double H_diagonal_max = 0;
-				for (size_t i = 0; i < nFreeNodes; i++)
-					for (typename map_ID2matrix_VxV_t::const_iterator it =
-							 H_map[i].begin();
-						 it != H_map[i].end(); ++it)
-					{
-						const size_t j =
-							it->first;  // entry submatrix is for (i,j).
-						if (i == j)
-						{
-							for (size_t k = 0; k < DIMS_POSE; k++)
-								mrpt::keep_max(
-									H_diagonal_max,
-									it->second.get_unsafe(k, k));
-						}
-					}
-				lambda = tau * H_diagonal_max;
+				lambda = tau * H.maxDiagonal();
 
 				profiler.leave(
 					"optimize_graph_spa_levmarq.lambda_init");  // ---/
@@ -508,48 +476,12 @@ void optimize_graph_spa_levmarq(
 		}
 
 		profiler.enter("optimize_graph_spa_levmarq.sp_H:build");
-		// Now, build the actual sparse matrix H:
+		// Now, build the actual sparse matrix H+lambda*I:
 		// Note: we only need to fill out the upper diagonal part, since
-		// Cholesky will later on ignore the other part.
-		CSparseMatrix sp_H(nFreeNodes * DIMS_POSE, nFreeNodes * DIMS_POSE);
-		for (size_t i = 0; i < nFreeNodes; i++)
-		{
-			const size_t i_offset = i * DIMS_POSE;
-
-			for (typename map_ID2matrix_VxV_t::const_iterator it =
-					 H_map[i].begin();
-				 it != H_map[i].end(); ++it)
-			{
-				const size_t j = it->first;  // entry submatrix is for (i,j).
-				const size_t j_offset = j * DIMS_POSE;
-
-				// For i==j (diagonal blocks), it's different, since we only
-				// need to insert their
-				// upper-diagonal half and also we have to add the lambda*I to
-				// the diagonal from the Lev-Marq. algorithm:
-				if (i == j)
-				{
-					for (size_t r = 0; r < DIMS_POSE; r++)
-					{
-						// c=r: add lambda from LM
-						sp_H.insert_entry_fast(
-							j_offset + r, i_offset + r,
-							it->second.get_unsafe(r, r) + lambda);
-						// c>r:
-						for (size_t c = r + 1; c < DIMS_POSE; c++)
-							sp_H.insert_entry_fast(
-								j_offset + r, i_offset + c,
-								it->second.get_unsafe(r, c));
-					}
-				}
-				else
-				{
-					sp_H.insert_submatrix(j_offset, i_offset, it->second);
-				}
-			}
-		}  // end for each free node, build sp_H
-
-		sp_H.compressFromTriplet();
+		// Cholesky will later on ignore the other part. Its structure is the
+		// same in all iterations, so the symbolic Cholesky decomposition is
+		// reused in ptrCh->update().
+		H.getSparseMatrix(lambda, sp_H);
 		profiler.leave("optimize_graph_spa_levmarq.sp_H:build");
 
 		// Use the cparse Cholesky decomposition to efficiently solve:
@@ -664,12 +596,14 @@ void optimize_graph_spa_levmarq(
 			// =============================================================
 			// Compute Jacobians & errors with the new "graph.nodes" info:
 			// =============================================================
-			typename gst::map_pairIDs_pairJacobs_t new_lstJacobians;
+			mrpt::aligned_std_vector<typename gst::TPairJacobs>
+				new_lstJacobians;
 			mrpt::aligned_std_vector<typename gst::Array_O> new_errs;
 
 			profiler.enter("optimize_graph_spa_levmarq.Jacobians&err");
 			double new_total_sqr_err = computeJacobiansAndErrors<GRAPH_T>(
-				graph, lstObservationData, new_lstJacobians, new_errs);
+				lstObservationData, new_lstJacobians, new_errs,
+				threadPool.get());
 			profiler.leave("optimize_graph_spa_levmarq.Jacobians&err");
 
 			// Now, to decide whether to accept the change:
@@ -9,6 +9,11 @@
 #ifndef GRAPH_SLAM_LEVMARQ_IMPL_H
 #define GRAPH_SLAM_LEVMARQ_IMPL_H
 
+#include <mrpt/math/CSparseMatrix.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <algorithm>
+#include <vector>
+
 namespace mrpt
 {
 namespace graphslam
@@ -172,77 +177,236 @@ struct AuxErrorEval<CPose3DPDFGaussianInf, gst>
 	}
 };
 
-}  // end NS detail
+// Jacobians and error vector of one constraint.
+template <class gst>
+void computeJacobiansAndError(
+	const typename gst::observation_info_t& obs,
+	typename gst::TPairJacobs& jacobs, typename gst::Array_O& err)
+{
+	using pose_t = typename gst::graph_t::constraint_t::type_value;
 
-// Compute, at once, jacobians and the error vectors for each constraint in
-// "lstObservationData", returns the overall squared error.
-template <class GRAPH_T>
-double computeJacobiansAndErrors(
-	const GRAPH_T& graph,
-	const std::vector<typename graphslam_traits<GRAPH_T>::observation_info_t>&
-		lstObservationData,
-	typename graphslam_traits<GRAPH_T>::map_pairIDs_pairJacobs_t& lstJacobians,
-	mrpt::aligned_std_vector<typename graphslam_traits<GRAPH_T>::Array_O>& errs)
+	// Compute the residual pose error of these pair of nodes + its
+	// constraint,
+	//  that is: P1DP2inv = P1 * EDGE * inv(P2)
+	pose_t P1DP2inv(mrpt::poses::UNINITIALIZED_POSE);
+	{
+		pose_t P1D(mrpt::poses::UNINITIALIZED_POSE);
+		P1D.composeFrom(*obs.P1, *obs.edge_mean);
+		const pose_t P2inv =
+			-(*obs.P2);  // Pose inverse (NOT just switching signs!)
+		P1DP2inv.composeFrom(P1D, P2inv);
+	}
+
+	AuxErrorEval<typename gst::edge_t, gst>::computePseudoLnError(
+		P1DP2inv, err, obs.edge);
+
+	gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(
+		P1DP2inv, &jacobs.first, &jacobs.second);
+}
+
+/** Upper triangular part of the Hessian H=J^t*Inf*J of a SPA problem, stored
+ * as DIMxDIM blocks in block compressed-column order. The sparsity pattern
+ * only depends on the graph topology, so it is computed once by
+ * buildPattern() and reused along all the Lev-Marq iterations, where only
+ * the block values change. */
+template <class MATRIX, size_t DIM>
+struct BlockSparseHessian
 {
-	MRPT_UNUSED_PARAM(graph);
-	using gst = graphslam_traits<GRAPH_T>;
+	/** Blocks of the c'th column of blocks are those in
+	 * [col_ptr[c],col_ptr[c+1]), whose row indices are in row_idx[] in
+	 * ascending order, so the diagonal block is the last one. */
+	std::vector<size_t> col_ptr, row_idx;
+	mrpt::aligned_std_vector<MATRIX> blocks;
 
-	lstJacobians.clear();
-	errs.clear();
+	/** For each edge: indices in blocks[] of its contributions to the
+	 * diagonal blocks of the 1st and 2nd node, and to the off-diagonal
+	 * block (std::string::npos if the nodes are not free) */
+	struct TEdgeBlocks
+	{
+		size_t b11, b22, b12;
+	};
+	std::vector<TEdgeBlocks> edge_blocks;
 
-	const size_t nObservations = lstObservationData.size();
+	/** Scalar column-compressed structure of the upper triangle, in the
+	 * CSparse format, and a buffer for its values */
+	std::vector<int> csc_p, csc_i;
+	std::vector<double> csc_x;
 
-	for (size_t i = 0; i < nObservations; i++)
+	/** Builds the sparsity pattern for a problem with nFreeNodes free nodes,
+	 * given the free node indices (or std::string::npos if fixed) of the two
+	 * ends of each edge. A diagonal block is always present for each free
+	 * node, even if no edge touches it. */
+	void buildPattern(
+		const size_t nFreeNodes,
+		const std::vector<std::pair<size_t, size_t>>& edgeNodes)
 	{
-		const typename gst::observation_info_t& obs = lstObservationData[i];
-		typename gst::edge_const_iterator it = obs.edge;
-		const typename gst::graph_t::constraint_t::type_value* EDGE_POSE =
-			obs.edge_mean;
-		typename gst::graph_t::constraint_t::type_value* P1 = obs.P1;
-		typename gst::graph_t::constraint_t::type_value* P2 = obs.P2;
+		const size_t npos = std::string::npos;
+		std::vector<std::vector<size_t>> rows(nFreeNodes);
+		for (size_t c = 0; c < nFreeNodes; c++) rows[c].push_back(c);
+		for (const auto& e : edgeNodes)
+			if (e.first != npos && e.second != npos)
+				rows[std::max(e.first, e.second)].push_back(
+					std::min(e.first, e.second));
 
-		const auto& ids = it->first;
-		const auto& edge = it->second;
+		col_ptr.assign(1, 0);
+		row_idx.clear();
+		for (auto& r : rows)
+		{
+			std::sort(r.begin(), r.end());
+			r.erase(std::unique(r.begin(), r.end()), r.end());
+			row_idx.insert(row_idx.end(), r.begin(), r.end());
+			col_ptr.push_back(row_idx.size());
+		}
+		blocks.resize(row_idx.size());
 
-		// Compute the residual pose error of these pair of nodes + its
-		// constraint,
-		//  that is: P1DP2inv = P1 * EDGE * inv(P2)
-		typename gst::graph_t::constraint_t::type_value P1DP2inv(
-			mrpt::poses::UNINITIALIZED_POSE);
+		const auto findBlock = [this](size_t r, size_t c) {
+			return std::lower_bound(
+					   row_idx.begin() + col_ptr[c],
+					   row_idx.begin() + col_ptr[c + 1], r) -
+				   row_idx.begin();
+		};
+		edge_blocks.resize(edgeNodes.size());
+		for (size_t k = 0; k < edgeNodes.size(); k++)
 		{
-			typename gst::graph_t::constraint_t::type_value P1D(
-				mrpt::poses::UNINITIALIZED_POSE);
-			P1D.composeFrom(*P1, *EDGE_POSE);
-			const typename gst::graph_t::constraint_t::type_value P2inv =
-				-(*P2);  // Pose inverse (NOT just switching signs!)
-			P1DP2inv.composeFrom(P1D, P2inv);
+			const size_t n1 = edgeNodes[k].first, n2 = edgeNodes[k].second;
+			auto& eb = edge_blocks[k];
+			eb.b11 = (n1 != npos) ? col_ptr[n1 + 1] - 1 : npos;
+			eb.b22 = (n2 != npos) ? col_ptr[n2 + 1] - 1 : npos;
+			eb.b12 = (n1 != npos && n2 != npos)
+						 ? findBlock(std::min(n1, n2), std::max(n1, n2))
+						 : npos;
 		}
 
-		// Add to vector of errors:
-		errs.resize(errs.size() + 1);
-		detail::AuxErrorEval<typename gst::edge_t, gst>::computePseudoLnError(
-			P1DP2inv, errs.back(), edge);
+		// Scalar structure: each column has DIM entries per off-diagonal
+		// block, plus the upper half of the diagonal block.
+		const size_t nCols = nFreeNodes * DIM;
+		csc_p.resize(nCols + 1);
+		csc_i.clear();
+		csc_p[0] = 0;
+		for (size_t c = 0; c < nFreeNodes; c++)
+			for (size_t k = 0; k < DIM; k++)
+			{
+				for (size_t b = col_ptr[c]; b < col_ptr[c + 1]; b++)
+				{
+					const size_t nRows = (row_idx[b] == c) ? k + 1 : DIM;
+					for (size_t m = 0; m < nRows; m++)
+						csc_i.push_back(static_cast<int>(row_idx[b] * DIM + m));
+				}
+				csc_p[c * DIM + k + 1] = static_cast<int>(csc_i.size());
+			}
+		csc_x.resize(csc_i.size());
+	}
 
-		// Compute the jacobians:
-		alignas(MRPT_MAX_ALIGN_BYTES)
-			std::pair<mrpt::graphs::TPairNodeIDs, typename gst::TPairJacobs>
-				newMapEntry;
-		newMapEntry.first = ids;
-		gst::SE_TYPE::jacobian_dP1DP2inv_depsilon(
-			P1DP2inv, &newMapEntry.second.first, &newMapEntry.second.second);
+	void setZero()
+	{
+		for (auto& b : blocks) b.setZero();
+	}
 
-		// And insert into map of jacobians:
-		lstJacobians.insert(lstJacobians.end(), newMapEntry);
+	/** Max. value in the diagonal of H */
+	double maxDiagonal() const
+	{
+		double ret = 0;
+		for (size_t c = 0; c + 1 < col_ptr.size(); c++)
+			for (size_t k = 0; k < DIM; k++)
+				mrpt::keep_max(ret, blocks[col_ptr[c + 1] - 1](k, k));
+		return ret;
 	}
 
-	// return overall square error:  (Was:
-	// std::accumulate(...,mrpt::squareNorm_accum<>), but led to GCC
-	// errors when enabling parallelization)
+	/** Returns H+lambda*I as a column-compressed sparse matrix, with the same
+	 * sparsity structure in all calls */
+	void getSparseMatrix(const double lambda, mrpt::math::CSparseMatrix& H)
+	{
+		double* x = csc_x.data();
+		const size_t nFreeNodes = col_ptr.size() - 1;
+		for (size_t c = 0; c < nFreeNodes; c++)
+			for (size_t k = 0; k < DIM; k++)
+				for (size_t b = col_ptr[c]; b < col_ptr[c + 1]; b++)
+				{
+					const MATRIX& B = blocks[b];
+					if (row_idx[b] != c)
+						for (size_t m = 0; m < DIM; m++) *x++ = B(m, k);
+					else
+					{
+						for (size_t m = 0; m < k; m++) *x++ = B(m, k);
+						*x++ = B(k, k) + lambda;
+					}
+				}
+
+		cs sm;
+		sm.nzmax = static_cast<int>(csc_x.size());
+		sm.m = sm.n = static_cast<int>(nFreeNodes * DIM);
+		sm.p = csc_p.data();
+		sm.i = csc_i.data();
+		sm.x = csc_x.data();
+		sm.nz = -1;  // column-compressed
+		mrpt::math::CSparseMatrix newH(&sm);
+		H.swap(newH);
+	}
+};
+
+}  // end NS detail
+
+/** Computes, at once, the Jacobians and the error vectors for each
+ * constraint in "lstObservationData", in the same order, and returns the
+ * overall squared error. Constraints are evaluated in parallel if a thread
+ * pool is provided. */
+template <class GRAPH_T>
+double computeJacobiansAndErrors(
+	const std::vector<typename graphslam_traits<GRAPH_T>::observation_info_t>&
+		lstObservationData,
+	mrpt::aligned_std_vector<typename graphslam_traits<GRAPH_T>::TPairJacobs>&
+		lstJacobians,
+	mrpt::aligned_std_vector<typename graphslam_traits<GRAPH_T>::Array_O>& errs,
+	mrpt::system::CWorkerThreadsPool* threadPool = nullptr)
+{
+	using gst = graphslam_traits<GRAPH_T>;
+
+	const size_t nObservations = lstObservationData.size();
+	lstJacobians.resize(nObservations);
+	errs.resize(nObservations);
+
+	const auto body = [&](size_t i0, size_t i1) {
+		for (size_t i = i0; i < i1; i++)
+			detail::computeJacobiansAndError<gst>(
+				lstObservationData[i], lstJacobians[i], errs[i]);
+	};
+	if (threadPool)
+		threadPool->parallel_for(nObservations, body, 256);
+	else
+		body(0, nObservations);
+
+	// return overall square error (serial, so the result does not depend
+	// on the number of threads):
 	double ret_err = 0.0;
 	for (size_t i = 0; i < errs.size(); i++) ret_err += errs[i].squaredNorm();
 	return ret_err;
 }
 
+/** \overload Same as above, but returning the Jacobians in a map indexed by
+ * the node IDs of each constraint. */
+template <class GRAPH_T>
+double computeJacobiansAndErrors(
+	const GRAPH_T& graph,
+	const std::vector<typename graphslam_traits<GRAPH_T>::observation_info_t>&
+		lstObservationData,
+	typename graphslam_traits<GRAPH_T>::map_pairIDs_pairJacobs_t& lstJacobians,
+	mrpt::aligned_std_vector<typename graphslam_traits<GRAPH_T>::Array_O>& errs)
+{
+	MRPT_UNUSED_PARAM(graph);
+	using gst = graphslam_traits<GRAPH_T>;
+
+	mrpt::aligned_std_vector<typename gst::TPairJacobs> jacobs;
+	const double ret_err =
+		computeJacobiansAndErrors<GRAPH_T>(lstObservationData, jacobs, errs);
+
+	lstJacobians.clear();
+	for (size_t i = 0; i < jacobs.size(); i++)
+		lstJacobians.insert(
+			lstJacobians.end(),
+			std::make_pair(lstObservationData[i].edge->first, jacobs[i]));
+	return ret_err;
+}
+
 }  // end of NS
 }  // end of NS
 
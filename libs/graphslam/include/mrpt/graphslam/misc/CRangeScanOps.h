@@ -96,6 +96,21 @@ class CRangeScanOps
 		const mrpt::obs::CObservation2DRangeScan& to, constraint_t* rel_edge,
 		const mrpt::poses::CPose2D* initial_pose = nullptr,
 		mrpt::slam::CICP::TReturnInfo* icp_info = nullptr);
+	/**\brief Align the points maps of two 2D range scans, e.g. those kept
+	 * among calls so their KD-trees are not built again for every alignment.
+	 *
+	 * If given, \a icp is used instead of params.icp. Since the maps are not
+	 * modified, several alignments can run in parallel, each with its own
+	 * CICP instance, as long as the KD-tree (see
+	 * mrpt::math::KDTreeCapable::kdTreeEnsureIndexBuilt2D) and the bounding
+	 * box of the \a from map are already computed.
+	 */
+	void getICPEdge(
+		const mrpt::maps::CPointsMap& from, const mrpt::maps::CPointsMap& to,
+		constraint_t* rel_edge,
+		const mrpt::poses::CPose2D* initial_pose = nullptr,
+		mrpt::slam::CICP::TReturnInfo* icp_info = nullptr,
+		mrpt::slam::CICP* icp = nullptr);
 	/**\brief Align the 3D range scans provided and find the potential edge that
 	 * can transform the one into the other.
 	 *
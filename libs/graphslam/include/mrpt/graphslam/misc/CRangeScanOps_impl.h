@@ -26,12 +26,24 @@ void CRangeScanOps<GRAPH_T>::getICPEdge(
 	MRPT_START;
 
 	mrpt::maps::CSimplePointsMap m1, m2;
-	float running_time;
-	mrpt::slam::CICP::TReturnInfo info;
-
-	// have them initialized prior - and then just clear them
 	m1.insertObservation(&from);
 	m2.insertObservation(&to);
+	this->getICPEdge(m1, m2, rel_edge, initial_pose_in, icp_info);
+
+	MRPT_END;
+}
+template <class GRAPH_T>
+void CRangeScanOps<GRAPH_T>::getICPEdge(
+	const mrpt::maps::CPointsMap& from, const mrpt::maps::CPointsMap& to,
+	constraint_t* rel_edge,
+	const mrpt::poses::CPose2D* initial_pose_in /* = nullptr */,
+	mrpt::slam::CICP::TReturnInfo* icp_info /* = nullptr */,
+	mrpt::slam::CICP* icp /* = nullptr */)
+{
+	MRPT_START;
+
+	float running_time;
+	mrpt::slam::CICP::TReturnInfo info;
 
 	// If given, use initial_pose_in as a first guess for the ICP
 	mrpt::poses::CPose2D initial_pose;
@@ -40,8 +52,9 @@ void CRangeScanOps<GRAPH_T>::getICPEdge(
 		initial_pose = *initial_pose_in;
 	}
 
+	if (!icp) icp = &params.icp;
 	mrpt::poses::CPosePDF::Ptr pdf =
-		params.icp.Align(&m1, &m2, initial_pose, &running_time, (void*)&info);
+		icp->Align(&from, &to, initial_pose, &running_time, (void*)&info);
 
 	// return the edge regardless of the goodness of the alignment
 	rel_edge->copyFrom(*pdf);
@@ -0,0 +1,157 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "graph_slam_levmarq_test_common.h"
+
+#include <gtest/gtest.h>
+#include <mrpt/graphslam/CIncrementalPoseGraphSolver.h>
+
+using namespace mrpt;
+using namespace mrpt::random;
+using namespace mrpt::poses;
+using namespace mrpt::graphs;
+using namespace mrpt::math;
+using namespace std;
+
+template <class my_graph_t>
+class GraphSlamIncrementalTester : public GraphSlamLevMarqTest<my_graph_t>,
+								   public ::testing::Test
+{
+   protected:
+	virtual void SetUp() {}
+	virtual void TearDown() {}
+	void test_ring_path_incremental()
+	{
+		my_graph_t full_graph;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(full_graph);
+		// Noisy edges, so the solution is not just the composition of them:
+		for (auto& e : full_graph.edges)
+			e.second += typename my_graph_t::edge_t(
+				CPose3D(
+					getRandomGenerator().drawGaussian1D(0, 0.02),
+					getRandomGenerator().drawGaussian1D(0, 0.02), 0,
+					getRandomGenerator().drawGaussian1D(0, DEG2RAD(0.5)), 0,
+					0));
+
+		// Feed the graph to the solver node by node, as a SLAM front-end
+		// would do: node #n comes with all its edges to former nodes.
+		my_graph_t graph;
+		graph.root = full_graph.root;
+		graph.nodes[graph.root] = full_graph.nodes[graph.root];
+
+		graphslam::CIncrementalPoseGraphSolver<my_graph_t> solver;
+		const TNodeID N = full_graph.nodes.size();
+		size_t max_refactored_odometry = 0;
+		for (TNodeID n = 1; n < N; n++)
+		{
+			graph.nodes[n] = full_graph.nodes[n];
+			bool is_loop_closure = false;
+			for (const auto& e : full_graph.edges)
+			{
+				const auto& ids = e.first;
+				if (std::max(ids.first, ids.second) != n) continue;
+				graph.insertEdge(ids.first, ids.second, e.second);
+				if (std::min(ids.first, ids.second) + 3 < n)
+					is_loop_closure = true;
+			}
+			solver.update(graph);
+
+			const auto& stats = solver.getLastUpdateStats();
+			EXPECT_EQ(stats.num_new_variables, 1u);
+			EXPECT_EQ(solver.getVariableCount(), n);
+			EXPECT_EQ(solver.getEdgeCount(), graph.edges.size());
+			// Only the trailing part of the factor is recomputed:
+			if (!is_loop_closure && stats.num_relinearized == 0)
+				mrpt::keep_max(
+					max_refactored_odometry, stats.num_refactored_columns);
+		}
+		EXPECT_LE(max_refactored_odometry, 4u);
+
+		// A few more (relinearize + solve) steps to converge, the last ones
+		// relinearizing everything:
+		for (int i = 0; i < 20; i++) solver.update(graph);
+		EXPECT_EQ(solver.getLastUpdateStats().num_new_edges, 0u);
+		solver.options.relinearize_threshold = 0;
+		solver.options.wildfire_threshold = 0;
+		for (int i = 0; i < 10; i++) solver.update(graph);
+
+		// The result must be a minimum: the batch solver, started from it,
+		// cannot improve it.
+		my_graph_t refined = graph;
+		mrpt::system::TParametersDouble params;
+		params["max_iterations"] = 100;
+		graphslam::TResultInfoSpaLevMarq levmarq_info;
+		graphslam::optimize_graph_spa_levmarq(
+			refined, levmarq_info, nullptr, params);
+
+		const double err = graph.getGlobalSquareError();
+		EXPECT_NEAR(err, refined.getGlobalSquareError(), 1e-3 * err);
+		for (const auto& n : graph.nodes)
+		{
+			const Eigen::VectorXd d = n.second.getAsVectorVal() -
+									  refined.nodes[n.first].getAsVectorVal();
+			EXPECT_NEAR(d.array().abs().maxCoeff(), 0, 1e-3);
+		}
+	}
+
+	void test_no_new_edges()
+	{
+		my_graph_t graph;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(graph);
+
+		graphslam::CIncrementalPoseGraphSolver<my_graph_t> solver;
+		solver.options.max_iterations = 10;
+		solver.update(graph);
+		EXPECT_EQ(
+			solver.getLastUpdateStats().num_new_edges, graph.edges.size());
+		EXPECT_EQ(solver.getVariableCount(), graph.nodes.size() - 1);
+		for (int i = 0; i < 10; i++) solver.update(graph);
+
+		// Converged: nothing else to do.
+		solver.update(graph);
+		const auto& stats = solver.getLastUpdateStats();
+		EXPECT_EQ(stats.num_new_edges, 0u);
+		EXPECT_EQ(stats.num_relinearized, 0u);
+		EXPECT_EQ(stats.num_refactored_columns, 0u);
+		EXPECT_LE(graph.getGlobalSquareError(), 1e-2);
+	}
+};
+
+using GraphSlamIncrementalTester2D =
+	GraphSlamIncrementalTester<CNetworkOfPoses2D>;
+using GraphSlamIncrementalTester3D =
+	GraphSlamIncrementalTester<CNetworkOfPoses3D>;
+
+TEST_F(GraphSlamIncrementalTester2D, OptimizeSampleRingPathIncremental)
+{
+	for (int seed = 1; seed < 3; seed++)
+	{
+		getRandomGenerator().randomize(seed);
+		test_ring_path_incremental();
+	}
+}
+TEST_F(GraphSlamIncrementalTester2D, BatchInput)
+{
+	getRandomGenerator().randomize(1);
+	test_no_new_edges();
+}
+
+TEST_F(GraphSlamIncrementalTester3D, OptimizeSampleRingPathIncremental)
+{
+	for (int seed = 1; seed < 3; seed++)
+	{
+		getRandomGenerator().randomize(seed);
+		test_ring_path_incremental();
+	}
+}
+TEST_F(GraphSlamIncrementalTester3D, BatchInput)
+{
+	getRandomGenerator().randomize(1);
+	test_no_new_edges();
+}
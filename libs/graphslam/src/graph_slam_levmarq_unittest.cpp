@@ -53,6 +53,33 @@ class GraphSlamLevMarqTester : public GraphSlamLevMarqTest<my_graph_t>,
 
 	}  // end test_ring_path
 
+	void test_ring_path_multithread()
+	{
+		my_graph_t graph;
+		GraphSlamLevMarqTest<my_graph_t>::create_ring_path(graph);
+		my_graph_t graph_mt = graph;
+
+		mrpt::system::TParametersDouble params;
+		params["max_iterations"] = 1000;
+		graphslam::TResultInfoSpaLevMarq info, info_mt;
+		graphslam::optimize_graph_spa_levmarq(graph, info, nullptr, params);
+
+		params["num_threads"] = 3;
+		graphslam::optimize_graph_spa_levmarq(
+			graph_mt, info_mt, nullptr, params);
+
+		// Results must not depend on the number of threads:
+		EXPECT_EQ(info.num_iters, info_mt.num_iters);
+		EXPECT_DOUBLE_EQ(
+			info.final_total_sq_error, info_mt.final_total_sq_error);
+		for (const auto& n : graph.nodes)
+		{
+			const auto d = n.second.getAsVectorVal() -
+						   graph_mt.nodes[n.first].getAsVectorVal();
+			EXPECT_NEAR(d.array().abs().sum(), 0, 1e-12);
+		}
+	}
+
 	void test_graph_bin_serialization()
 	{
 		my_graph_t graph;
@@ -100,6 +127,11 @@ TEST_F(GraphSlamLevMarqTester2D, OptimizeSampleRingPath)
 		test_ring_path();
 	}
 }
+TEST_F(GraphSlamLevMarqTester2D, OptimizeSampleRingPathMultiThread)
+{
+	getRandomGenerator().randomize(1);
+	test_ring_path_multithread();
+}
 TEST_F(GraphSlamLevMarqTester2D, BinarySerialization)
 {
 	getRandomGenerator().randomize(123);
@@ -114,6 +146,11 @@ TEST_F(GraphSlamLevMarqTester3D, OptimizeSampleRingPath)
 		test_ring_path();
 	}
 }
+TEST_F(GraphSlamLevMarqTester3D, OptimizeSampleRingPathMultiThread)
+{
+	getRandomGenerator().randomize(1);
+	test_ring_path_multithread();
+}
 TEST_F(GraphSlamLevMarqTester3D, BinarySerialization)
 {
 	getRandomGenerator().randomize(123);
@@ -1111,6 +1111,13 @@ class CImage : public mrpt::serialization::CSerializable, public CCanvas
 	/** Release the internal IPL image, if not nullptr or read-only. */
 	void releaseIpl(bool thisIsExternalImgUnload = false) noexcept;
 
+	/** Prepares `out` to hold the result of an image operation: reuses its
+	 * buffer if it already owns an image of the given size and format (e.g.
+	 * in image pyramids rebuilt for each frame), or allocates a new one.
+	 * \return The IplImage* of `out`. */
+	static void* prepareOutputImage(
+		CImage& out, int width, int height, int nChannels, int origin);
+
 	/** Checks if the image is of type "external storage", and if so and not
 	 * loaded yet, load it.
 	 * \exception CExceptionExternalImageNotFound */
@@ -106,6 +106,25 @@ CImage& CImage::operator=(const CImage& o)
 {
 	MRPT_START
 	if (this == &o) return *this;
+#if MRPT_HAS_OPENCV
+	// Reuse our buffer if it has the same size and format:
+	if (!o.m_imgIsExternalStorage && o.img && img && !m_imgIsReadOnly &&
+		!m_imgIsExternalStorage)
+	{
+		const IplImage* src = static_cast<const IplImage*>(o.img);
+		IplImage* dst = static_cast<IplImage*>(img);
+		if (src->width == dst->width && src->height == dst->height &&
+			src->nChannels == dst->nChannels && src->depth == dst->depth &&
+			src->origin == dst->origin && src->roi == nullptr &&
+			dst->roi == nullptr)
+		{
+			cvCopy(src, dst);
+			memcpy(dst->colorModel, src->colorModel, 4);
+			memcpy(dst->channelSeq, src->channelSeq, 4);
+			return *this;
+		}
+	}
+#endif
 	releaseIpl();
 	m_imgIsExternalStorage = o.m_imgIsExternalStorage;
 	m_imgIsReadOnly = false;
@@ -1000,11 +1019,8 @@ CImage CImage::grayscale() const
 
 // Auxiliary function for both ::grayscale() and ::grayscaleInPlace()
 #if MRPT_HAS_OPENCV
-IplImage* ipl_to_grayscale(const IplImage* img_src)
+void ipl_to_grayscale(const IplImage* img_src, IplImage* img_dest)
 {
-	IplImage* img_dest =
-		cvCreateImage(cvSize(img_src->width, img_src->height), IPL_DEPTH_8U, 1);
-	img_dest->origin = img_src->origin;
 
 // If possible, use SSE optimized version:
 #if MRPT_HAS_SSE3
@@ -1016,13 +1032,12 @@ IplImage* ipl_to_grayscale(const IplImage* img_src)
 		image_SSSE3_bgr_to_gray_8u(
 			(const uint8_t*)img_src->imageData, (uint8_t*)img_dest->imageData,
 			img_src->width, img_src->height);
-		return img_dest;
+		return;
 	}
 #endif
 
 	// OpenCV Method:
 	cvCvtColor(img_src, img_dest, CV_BGR2GRAY);
-	return img_dest;
 }
 #endif
 
@@ -1041,10 +1056,18 @@ void CImage::grayscale(CImage& ret) const
 		ret = *this;
 		return;
 	}
+	else if (&ret == this)
+	{
+		CImage tmp;
+		grayscale(tmp);
+		ret.swap(tmp);
+	}
 	else
 	{
 		// Convert to a single luminance channel image
-		ret.setFromIplImage(ipl_to_grayscale(ipl));
+		ipl_to_grayscale(
+			ipl, static_cast<IplImage*>(prepareOutputImage(
+					 ret, ipl->width, ipl->height, 1, ipl->origin)));
 	}
 #endif
 }
@@ -1060,7 +1083,11 @@ void CImage::grayscaleInPlace()
 	ASSERT_(ipl);
 	if (ipl->nChannels == 1) return;  // Already done.
 
-	setFromIplImage(ipl_to_grayscale(ipl));
+	IplImage* img_dest =
+		cvCreateImage(cvSize(ipl->width, ipl->height), IPL_DEPTH_8U, 1);
+	img_dest->origin = ipl->origin;
+	ipl_to_grayscale(ipl, img_dest);
+	setFromIplImage(img_dest);
 #endif
 }
 
@@ -1070,6 +1097,13 @@ void CImage::grayscaleInPlace()
 void CImage::scaleHalf(CImage& out) const
 {
 #if MRPT_HAS_OPENCV
+	if (&out == this)
+	{
+		CImage tmp;
+		scaleHalf(tmp);
+		out.swap(tmp);
+		return;
+	}
 	makeSureImageIsLoaded();  // For delayed loaded images stored externally
 	ASSERT_(img != nullptr);
 	// Get this image size:
@@ -1077,13 +1111,11 @@ void CImage::scaleHalf(CImage& out) const
 	const int w = img_src->width;
 	const int h = img_src->height;
 
-	// Create target image:
-	IplImage* img_dest =
-		cvCreateImage(cvSize(w >> 1, h >> 1), IPL_DEPTH_8U, img_src->nChannels);
-	img_dest->origin = img_src->origin;
+	// Create target image (or reuse its buffer):
+	IplImage* img_dest = static_cast<IplImage*>(prepareOutputImage(
+		out, w >> 1, h >> 1, img_src->nChannels, img_src->origin));
 	memcpy(img_dest->colorModel, img_src->colorModel, 4);
 	memcpy(img_dest->channelSeq, img_src->channelSeq, 4);
-	img_dest->dataOrder = img_src->dataOrder;
 
 // If possible, use SSE optimized version:
 #if MRPT_HAS_SSE3
@@ -1095,29 +1127,22 @@ void CImage::scaleHalf(CImage& out) const
 		image_SSSE3_scale_half_3c8u(
 			(const uint8_t*)img_src->imageData, (uint8_t*)img_dest->imageData,
 			w, h);
-		out.setFromIplImage(img_dest);
 		return;
 	}
 #endif
 
 #if MRPT_HAS_SSE2
-	if (img_src->nChannels == 1 && is_aligned<16>(img_src->imageData) &&
-		is_aligned<16>(img_dest->imageData) && (w & 0xF) == 0 &&
-		img_src->widthStep == img_src->width * img_src->nChannels &&
-		img_dest->widthStep == img_dest->width * img_dest->nChannels)
+	if (img_src->nChannels == 1 && img_src->roi == nullptr)
 	{
 		image_SSE2_scale_half_1c8u(
 			(const uint8_t*)img_src->imageData, (uint8_t*)img_dest->imageData,
-			w, h);
-
-		out.setFromIplImage(img_dest);
+			w, h, img_src->widthStep, img_dest->widthStep);
 		return;
 	}
 #endif
 
 	// Fall back to slow method:
 	cvResize(img_src, img_dest, IMG_INTERP_NN);
-	out.setFromIplImage(img_dest);
 #endif
 }
 
@@ -1127,6 +1152,13 @@ void CImage::scaleHalf(CImage& out) const
 void CImage::scaleHalfSmooth(CImage& out) const
 {
 #if MRPT_HAS_OPENCV
+	if (&out == this)
+	{
+		CImage tmp;
+		scaleHalfSmooth(tmp);
+		out.swap(tmp);
+		return;
+	}
 	makeSureImageIsLoaded();  // For delayed loaded images stored externally
 	ASSERT_(img != nullptr);
 	// Get this image size:
@@ -1134,33 +1166,25 @@ void CImage::scaleHalfSmooth(CImage& out) const
 	const int w = img_src->width;
 	const int h = img_src->height;
 
-	// Create target image:
-	IplImage* img_dest =
-		cvCreateImage(cvSize(w >> 1, h >> 1), IPL_DEPTH_8U, img_src->nChannels);
-	img_dest->origin = img_src->origin;
+	// Create target image (or reuse its buffer):
+	IplImage* img_dest = static_cast<IplImage*>(prepareOutputImage(
+		out, w >> 1, h >> 1, img_src->nChannels, img_src->origin));
 	memcpy(img_dest->colorModel, img_src->colorModel, 4);
 	memcpy(img_dest->channelSeq, img_src->channelSeq, 4);
-	img_dest->dataOrder = img_src->dataOrder;
 
 // If possible, use SSE optimized version:
 #if MRPT_HAS_SSE2
-	if (img_src->nChannels == 1 && is_aligned<16>(img_src->imageData) &&
-		is_aligned<16>(img_dest->imageData) && (w & 0xF) == 0 &&
-		img_src->widthStep == img_src->width * img_src->nChannels &&
-		img_dest->widthStep == img_dest->width * img_dest->nChannels)
+	if (img_src->nChannels == 1 && img_src->roi == nullptr)
 	{
 		image_SSE2_scale_half_smooth_1c8u(
 			(const uint8_t*)img_src->imageData, (uint8_t*)img_dest->imageData,
-			w, h);
-
-		out.setFromIplImage(img_dest);
+			w, h, img_src->widthStep, img_dest->widthStep);
 		return;
 	}
 #endif
 
 	// Fall back to slow method:
 	cvResize(img_src, img_dest, IMG_INTERP_LINEAR);
-	out.setFromIplImage(img_dest);
 #endif
 }
 
@@ -1922,6 +1946,34 @@ void CImage::releaseIpl(bool thisIsExternalImgUnload) noexcept
 #endif
 }
 
+/*---------------------------------------------------------------
+			prepareOutputImage
+---------------------------------------------------------------*/
+void* CImage::prepareOutputImage(
+	CImage& out, int width, int height, int nChannels, int origin)
+{
+#if MRPT_HAS_OPENCV
+	IplImage* ipl = static_cast<IplImage*>(out.img);
+	if (ipl && !out.m_imgIsReadOnly && !out.m_imgIsExternalStorage &&
+		ipl->width == width && ipl->height == height &&
+		ipl->nChannels == nChannels && ipl->depth == IPL_DEPTH_8U &&
+		ipl->origin == origin && ipl->roi == nullptr)
+		return ipl;
+
+	ipl = cvCreateImage(cvSize(width, height), IPL_DEPTH_8U, nChannels);
+	ipl->origin = origin;
+	out.setFromIplImage(ipl);
+	return ipl;
+#else
+	MRPT_UNUSED_PARAM(out);
+	MRPT_UNUSED_PARAM(width);
+	MRPT_UNUSED_PARAM(height);
+	MRPT_UNUSED_PARAM(nChannels);
+	MRPT_UNUSED_PARAM(origin);
+	THROW_EXCEPTION("The MRPT has been compiled with MRPT_HAS_OPENCV=0 !");
+#endif
+}
+
 /*---------------------------------------------------------------
 			makeSureImageIsLoaded
 ---------------------------------------------------------------*/
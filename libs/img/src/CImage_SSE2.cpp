@@ -34,73 +34,82 @@
  * ignoring the other 3
  *  - <b>Input format:</b> uint8_t, 1 channel
  *  - <b>Output format:</b> uint8_t, 1 channel
- *  - <b>Preconditions:</b> in & out aligned to 16bytes, w = k*16 (w=width in
- * pixels), widthStep=w*1
- *  - <b>Notes:</b>
+ *  - <b>Preconditions:</b> none: any width, and any row stride (in bytes)
+ * for the input (`step_in`) and output (`step_out`) images.
+ *  - <b>Notes:</b> The last (w%16)/2 output pixels of each row are
+ * computed without SSE.
  *  - <b>Requires:</b> SSE2
  *  - <b>Invoked from:</b> mrpt::img::CImage::scaleHalf()
  */
-void image_SSE2_scale_half_1c8u(const uint8_t* in, uint8_t* out, int w, int h)
+void image_SSE2_scale_half_1c8u(
+	const uint8_t* in, uint8_t* out, int w, int h, size_t step_in,
+	size_t step_out)
 {
-	alignas(32) const unsigned long long mask[2] = {0x00FF00FF00FF00FFull,
-													0x00FF00FF00FF00FFull};
-	const __m128i m = _mm_load_si128((const __m128i*)mask);
+	const __m128i m = _mm_set1_epi16(0x00FF);
 
-	int sw = w >> 4;
-	int sh = h >> 1;
+	const int sw = w >> 4;
+	const int sh = h >> 1;
+	const int ow = w >> 1;
 
 	for (int i = 0; i < sh; i++)
 	{
+		const uint8_t* in_row = in + 2 * i * step_in;
+		uint8_t* out_row = out + i * step_out;
 		for (int j = 0; j < sw; j++)
 		{
-			const __m128i here_sampled =
-				_mm_and_si128(_mm_load_si128((const __m128i*)in), m);
+			const __m128i here_sampled = _mm_and_si128(
+				_mm_loadu_si128((const __m128i*)(in_row + 16 * j)), m);
 			_mm_storel_epi64(
-				(__m128i*)out, _mm_packus_epi16(here_sampled, here_sampled));
-			in += 16;
-			out += 8;
+				(__m128i*)(out_row + 8 * j),
+				_mm_packus_epi16(here_sampled, here_sampled));
 		}
-		in += w;
+		for (int j = sw * 8; j < ow; j++) out_row[j] = in_row[2 * j];
 	}
 }
 
 /** Average each 2x2 pixels into 1x1 pixel (arithmetic average)
  *  - <b>Input format:</b> uint8_t, 1 channel
  *  - <b>Output format:</b> uint8_t, 1 channel
- *  - <b>Preconditions:</b> in & out aligned to 16bytes, w = k*16 (w=width in
- * pixels), widthStep=w*1
- *  - <b>Notes:</b>
+ *  - <b>Preconditions:</b> none: any width, and any row stride (in bytes)
+ * for the input (`step_in`) and output (`step_out`) images.
+ *  - <b>Notes:</b> The last (w%16)/2 output pixels of each row are
+ * computed without SSE, with the same rounding.
  *  - <b>Requires:</b> SSE2
  *  - <b>Invoked from:</b> mrpt::img::CImage::scaleHalfSmooth()
  */
 void image_SSE2_scale_half_smooth_1c8u(
-	const uint8_t* in, uint8_t* out, int w, int h)
+	const uint8_t* in, uint8_t* out, int w, int h, size_t step_in,
+	size_t step_out)
 {
-	alignas(MRPT_MAX_ALIGN_BYTES) const unsigned long long mask[2] = {0x00FF00FF00FF00FFull,
-													0x00FF00FF00FF00FFull};
-	const uint8_t* nextRow = in + w;
-	__m128i m = _mm_load_si128((const __m128i*)mask);
-	int sw = w >> 4;
-	int sh = h >> 1;
+	const __m128i m = _mm_set1_epi16(0x00FF);
+	const int sw = w >> 4;
+	const int sh = h >> 1;
+	const int ow = w >> 1;
 
 	for (int i = 0; i < sh; i++)
 	{
+		const uint8_t* in_row = in + 2 * i * step_in;
+		const uint8_t* next_row = in_row + step_in;
+		uint8_t* out_row = out + i * step_out;
 		for (int j = 0; j < sw; j++)
 		{
-			__m128i here = _mm_load_si128((const __m128i*)in);
-			__m128i next = _mm_load_si128((const __m128i*)nextRow);
+			__m128i here = _mm_loadu_si128((const __m128i*)(in_row + 16 * j));
+			__m128i next =
+				_mm_loadu_si128((const __m128i*)(next_row + 16 * j));
 			here = _mm_avg_epu8(here, next);
 			next = _mm_and_si128(_mm_srli_si128(here, 1), m);
 			here = _mm_and_si128(here, m);
 			here = _mm_avg_epu16(here, next);
-			_mm_storel_epi64((__m128i*)out, _mm_packus_epi16(here, here));
-			in += 16;
-			nextRow += 16;
-			out += 8;
+			_mm_storel_epi64(
+				(__m128i*)(out_row + 8 * j), _mm_packus_epi16(here, here));
+		}
+		for (int j = sw * 8; j < ow; j++)
+		{
+			// Same rounding than _mm_avg_epu8() and _mm_avg_epu16():
+			const int a = (in_row[2 * j] + next_row[2 * j] + 1) >> 1;
+			const int b = (in_row[2 * j + 1] + next_row[2 * j + 1] + 1) >> 1;
+			out_row[j] = static_cast<uint8_t>((a + b + 1) >> 1);
 		}
-
-		in += w;
-		nextRow += w;
 	}
 }
 
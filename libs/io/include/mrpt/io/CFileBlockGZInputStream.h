@@ -0,0 +1,98 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/io/CStream.h>
+#include <mrpt/core/pimpl.h>
+
+namespace mrpt
+{
+namespace io
+{
+/** Reads block-compressed files written by CFileBlockGZOutputStream,
+ * decompressing the next blocks in parallel, in a pool of threads, while the
+ * current one is being read.
+ *
+ * The index of blocks is built upon open() from the headers of the gzip
+ * members, so Seek() only needs to decompress the block at the new position.
+ * If the file ends with an incomplete block (e.g. the writing program was
+ * killed), that block is ignored.
+ *
+ * Regular gzip files (not written by CFileBlockGZOutputStream) can not be
+ * opened with this class: use CFileGZInputStream instead, which reads both
+ * kinds of files. See isBlockGZFile().
+ *
+ * \note [New in MRPT 2.0.0]
+ * \sa CFileBlockGZOutputStream, CFileGZInputStream
+ * \ingroup mrpt_io_grp
+ */
+class CFileBlockGZInputStream : public CStream
+{
+   public:
+	/** Constructor without open */
+	CFileBlockGZInputStream();
+
+	/** Constructor and open, using as many threads as CPU cores.
+	 * \param fileName The file to be open in this stream
+	 * \exception std::exception If there's an error opening the file.
+	 */
+	CFileBlockGZInputStream(const std::string& fileName);
+
+	CFileBlockGZInputStream(const CFileBlockGZInputStream&) = delete;
+	CFileBlockGZInputStream& operator=(const CFileBlockGZInputStream&) =
+		delete;
+
+	/** Dtor */
+	virtual ~CFileBlockGZInputStream();
+
+	/** Opens the file for read.
+	 * \param fileName The file to be open in this stream
+	 * \param num_threads Number of threads decompressing blocks in advance.
+	 * 0 means as many as CPU cores; 1 decompresses in the calling thread,
+	 * only when needed.
+	 * \return false if there's an error opening the file, or it is not a
+	 * block-compressed file, true otherwise
+	 */
+	bool open(const std::string& fileName, unsigned int num_threads = 0);
+	/** Closes the file */
+	void close();
+	/** Returns true if the file was open without errors. */
+	bool fileOpenCorrectly() const;
+	/** Returns true if the file was open without errors. */
+	bool is_open() { return fileOpenCorrectly(); }
+	/** Will be true if EOF has been already reached. */
+	bool checkEOF();
+
+	/** Returns true if the file exists and starts with a block written by
+	 * CFileBlockGZOutputStream. */
+	static bool isBlockGZFile(const std::string& fileName);
+
+	/** Number of compressed blocks in the file. */
+	std::size_t getBlockCount() const;
+
+	/** Method for getting the total number of <b>uncompressed</b> bytes in
+	 * the file. */
+	uint64_t getTotalBytesCount() const override;
+	/** Method for getting the current cursor position in the
+	 * <b>uncompressed</b> stream, where 0 is the first byte. */
+	uint64_t getPosition() const override;
+
+	/** Moves the read cursor, in <b>uncompressed</b> bytes. All origins are
+	 * supported, and the cost does not depend on the distance. */
+	uint64_t Seek(
+		int64_t Offset, CStream::TSeekOrigin Origin = sFromBeginning) override;
+	size_t Read(void* Buffer, size_t Count) override;
+	size_t Write(const void* Buffer, size_t Count) override;
+
+   private:
+	struct Impl;
+	mrpt::pimpl<Impl> m_impl;
+};  // End of class def.
+}  // namespace io
+}  // namespace mrpt
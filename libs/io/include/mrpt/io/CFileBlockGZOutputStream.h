@@ -0,0 +1,99 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/io/CStream.h>
+#include <mrpt/core/pimpl.h>
+
+namespace mrpt
+{
+namespace io
+{
+/** Saves data to a file compressed in independent blocks, which are deflated
+ * in parallel by a pool of threads.
+ *
+ * The file format is a valid gzip file made of a sequence of gzip members
+ * (RFC 1952), one per block of (up to) `block_size` uncompressed bytes, so
+ * these files can be read by CFileGZInputStream, `gzip`, `zcat` and all
+ * rawlog tools. The header of each member has an "extra field" with
+ * subfield ID `'M','R'` and 8 bytes of data: the total size of the member
+ * and the uncompressed size of the block, both as little endian `uint32_t`.
+ * CFileBlockGZInputStream uses these fields to build an index of blocks, so
+ * reading can be parallelized and random access is cheap.
+ *
+ * Since data is only written to disk in whole blocks, up to `block_size`
+ * bytes written by the user will not be in the file until the next block is
+ * complete or the stream is closed.
+ *
+ * \note [New in MRPT 2.0.0]
+ * \sa CFileBlockGZInputStream, CFileGZOutputStream
+ * \ingroup mrpt_io_grp
+ */
+class CFileBlockGZOutputStream : public CStream
+{
+   public:
+	/** Default size of each compressed block [bytes] */
+	static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+	/** Constructor: opens an output file with compression level = 1 (minimum,
+	 * fastest) and as many threads as CPU cores.
+	 * \param fileName The file to be open in this stream
+	 * \exception std::exception On error creating the file.
+	 * \sa open
+	 */
+	CFileBlockGZOutputStream(const std::string& fileName);
+
+	/** Constructor, without opening the file.
+	 * \sa open
+	 */
+	CFileBlockGZOutputStream();
+
+	CFileBlockGZOutputStream(const CFileBlockGZOutputStream&) = delete;
+	CFileBlockGZOutputStream& operator=(const CFileBlockGZOutputStream&) =
+		delete;
+
+	/** Destructor: see close() */
+	virtual ~CFileBlockGZOutputStream();
+
+	/** Open a file for write, choosing the compression level.
+	 * \param fileName The file to be open in this stream
+	 * \param compress_level 0:no compression, 1:fastest, 9:best
+	 * \param num_threads Number of threads compressing blocks in parallel.
+	 * 0 means as many as CPU cores; 1 compresses in the calling thread.
+	 * \param block_size Size of each block, in uncompressed bytes.
+	 * \return true on success, false on any error.
+	 */
+	bool open(
+		const std::string& fileName, int compress_level = 1,
+		unsigned int num_threads = 0,
+		std::size_t block_size = DEFAULT_BLOCK_SIZE);
+	/** Compresses and writes all pending data, and closes the file.
+	 * \exception std::exception On any error writing the pending data.
+	 */
+	void close();
+	/** Returns true if the file was open without errors. */
+	bool fileOpenCorrectly() const;
+	/** Returns true if the file was open without errors. */
+	bool is_open() { return fileOpenCorrectly(); }
+	/** Number of uncompressed bytes written so far. */
+	uint64_t getPosition() const override;
+
+	/** This method is not implemented in this class */
+	uint64_t Seek(int64_t, CStream::TSeekOrigin = sFromBeginning) override;
+	/** This method is not implemented in this class */
+	uint64_t getTotalBytesCount() const override;
+	size_t Read(void* Buffer, size_t Count) override;
+	size_t Write(const void* Buffer, size_t Count) override;
+
+   private:
+	struct Impl;
+	mrpt::pimpl<Impl> m_impl;
+};  // End of class def.
+}  // namespace io
+}  // namespace mrpt
@@ -63,12 +63,22 @@ class CFileGZInputStream : public CStream
 	/** Method for getting the total number of <b>compressed</b> bytes of in the
 	 * file (the physical size of the compressed file). */
 	uint64_t getTotalBytesCount() const override;
-	/** Method for getting the current cursor position in the <b>compressed</b>,
-	 * where 0 is the first byte and TotalBytesCount-1 the last one. */
+	/** Method for getting the current cursor position in the
+	 * <b>uncompressed</b> stream, where 0 is the first byte.
+	 * \exception std::exception If it does not fit in zlib's offset type
+	 * (e.g. beyond 2GB in platforms without 64-bit gztell64()). */
 	uint64_t getPosition() const override;
 
-	/** This method is not implemented in this class */
-	uint64_t Seek(int64_t, CStream::TSeekOrigin = sFromBeginning) override;
+	/** Moves the read cursor, in <b>uncompressed</b> bytes. Only
+	 * sFromBeginning and sFromCurrent are supported. Note that seeking
+	 * backwards requires decompressing again from the beginning of the file,
+	 * so random access to large files should be avoided.
+	 * \exception std::exception On error, if Origin is sFromEnd, or if the
+	 * offset does not fit in zlib's offset type (e.g. beyond 2GB in
+	 * platforms without 64-bit gzseek64()).
+	 * \note Seek() was not available prior to MRPT 2.0.0 */
+	uint64_t Seek(
+		int64_t Offset, CStream::TSeekOrigin Origin = sFromBeginning) override;
 	size_t Read(void* Buffer, size_t Count) override;
 	size_t Write(const void* Buffer, size_t Count) override;
 };  // End of class def.
@@ -0,0 +1,87 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/io/CStream.h>
+#include <mrpt/io/CMemoryMappedFile.h>
+
+namespace mrpt
+{
+namespace io
+{
+/** A read-only, binary stream on a file which is mapped into memory (see
+ * CMemoryMappedFile).
+ *
+ * Read() copies data straight from the OS page cache into the destination
+ * buffer, without the intermediary buffers of CFileInputStream, so this is
+ * the fastest way to deserialize large objects (point clouds, images, depth
+ * frames,...) from uncompressed files:
+ * \code
+ * mrpt::io::CFileMappedInputStream f("cloud.bin");
+ * auto arch = mrpt::serialization::archiveFrom(f);
+ * arch >> pointsMap;
+ * \endcode
+ *
+ * Empty files can not be opened, since they can not be mapped.
+ *
+ * \note [New in MRPT 2.0.0]
+ * \sa CFileInputStream, CMemoryMappedFile
+ * \ingroup mrpt_io_grp
+ */
+class CFileMappedInputStream : public CStream
+{
+   public:
+	/** Constructor
+	 * \param fileName The file to be open in this stream
+	 * \exception std::exception On error trying to open or map the file.
+	 */
+	CFileMappedInputStream(const std::string& fileName);
+	/** Default constructor */
+	CFileMappedInputStream();
+
+	CFileMappedInputStream(const CFileMappedInputStream&) = delete;
+	CFileMappedInputStream& operator=(const CFileMappedInputStream&) = delete;
+
+	virtual ~CFileMappedInputStream();
+
+	/** Open and map a file for reading
+	 * \param fileName The file to be open in this stream
+	 * \return true on success.
+	 */
+	bool open(const std::string& fileName);
+	/** Close the stream */
+	void close();
+	/** Returns true if the file was open without errors. */
+	bool fileOpenCorrectly() const { return m_file.isOpen(); }
+	/** Returns true if the file was open without errors. */
+	bool is_open() { return fileOpenCorrectly(); }
+	/** Will be true if EOF has been already reached. */
+	bool checkEOF() const { return m_position >= m_file.size(); }
+
+	/** Direct access to the contents of the file, for zero-copy parsing of
+	 * data. The length is getTotalBytesCount(). */
+	const uint8_t* getRawBufferData() const { return m_file.data(); }
+
+	// See docs in base class
+	uint64_t Seek(
+		int64_t off, CStream::TSeekOrigin Origin = sFromBeginning) override;
+	// See docs in base class
+	uint64_t getTotalBytesCount() const override { return m_file.size(); }
+	// See docs in base class
+	uint64_t getPosition() const override { return m_position; }
+
+	size_t Read(void* Buffer, size_t Count) override;
+	size_t Write(const void* Buffer, size_t Count) override;
+
+   private:
+	CMemoryMappedFile m_file;
+	uint64_t m_position{0};
+};  // End of class def.
+}  // namespace io
+}  // namespace mrpt
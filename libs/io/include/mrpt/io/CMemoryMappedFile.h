@@ -0,0 +1,68 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace mrpt
+{
+namespace io
+{
+/** A read-only view of a whole file mapped into memory (`mmap()` in POSIX,
+ * `MapViewOfFile()` in Windows). Pages are loaded by the OS on demand and
+ * shared among all processes mapping the same file, so this is the fastest
+ * way to access large, precomputed binary tables.
+ *
+ * The file must not be modified while it is mapped. Empty files cannot be
+ * mapped.
+ *
+ * \note [New in MRPT 2.0.0]
+ * \sa CFileInputStream
+ * \ingroup mrpt_io_grp
+ */
+class CMemoryMappedFile
+{
+   public:
+	/** Default constructor: no file is mapped. */
+	CMemoryMappedFile();
+	/** Constructor that maps the given file.
+	 * \exception std::exception On error trying to open or map the file.
+	 */
+	CMemoryMappedFile(const std::string& fileName);
+	/** Dtor: unmaps the file, if mapped. */
+	~CMemoryMappedFile();
+
+	CMemoryMappedFile(const CMemoryMappedFile&) = delete;
+	CMemoryMappedFile& operator=(const CMemoryMappedFile&) = delete;
+
+	/** Maps a file, unmapping the former one, if any.
+	 * \return true on success. */
+	bool open(const std::string& fileName);
+	/** Unmaps the file, if mapped. */
+	void close();
+	/** Returns true if a file is mapped. */
+	bool isOpen() const { return m_data != nullptr; }
+	/** Pointer to the first byte of the file, or nullptr if none is mapped.
+	 * The memory is page aligned. */
+	const uint8_t* data() const { return m_data; }
+	/** Length of the mapped file [bytes] */
+	std::size_t size() const { return m_size; }
+
+   private:
+	const uint8_t* m_data;
+	std::size_t m_size;
+#ifdef _WIN32
+	void* m_hFile;
+	void* m_hMapping;
+#endif
+};  // End of class def.
+}  // namespace io
+}  // namespace mrpt
@@ -54,7 +54,8 @@ class CMemoryStream : public CStream
 	 *  After assigning a block of data with this method, the object becomes
 	 * "read-only", so further attempts to change the size of the buffer will
 	 * raise an exception.
-	 *  This method resets the write and read positions to the beginning. */
+	 *  This method resets the write and read positions to the beginning.
+	 * \sa CFileMappedInputStream */
 	void assignMemoryNotOwn(const void* data, const uint64_t nBytesInData);
 
 	/** Destructor */
@@ -89,8 +90,9 @@ class CMemoryStream : public CStream
 	 * error */
 	bool loadBufferFromFile(const std::string& file_name);
 
-	/** Change the size of the additional memory block that is reserved whenever
-	 * the current block runs too short (default=0x10000 bytes) */
+	/** Change the minimum size of the additional memory block that is reserved
+	 * whenever the current block runs too short (default=0x1000 bytes). The
+	 * buffer always grows by at least 50% of its current size. */
 	void setAllocBlockSize(uint64_t alloc_block_size)
 	{
 		ASSERT_(alloc_block_size > 0);
@@ -0,0 +1,284 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "io-precomp.h"  // Precompiled headers
+
+#include <mrpt/io/CFileBlockGZInputStream.h>
+#include <mrpt/io/CFileInputStream.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/core/exceptions.h>
+#include "CFileBlockGZ_internal.h"
+
+#include <algorithm>  // min(), upper_bound()
+#include <cstring>  // memcpy
+#include <future>
+#include <map>
+#include <memory>
+
+using namespace mrpt::io;
+using namespace std;
+
+struct CFileBlockGZInputStream::Impl
+{
+	struct BlockInfo
+	{
+		/** Position of the gzip member in the file */
+		uint64_t file_offset;
+		/** Position of the first uncompressed byte in the stream */
+		uint64_t offset;
+		uint32_t member_len, len;
+	};
+
+	std::shared_ptr<CFileInputStream> file;
+	std::shared_ptr<mrpt::system::CWorkerThreadsPool> pool;
+	/** Index of blocks, sorted by `offset` */
+	std::vector<BlockInfo> blocks;
+	uint64_t total_len{0};
+	/** Read cursor, in uncompressed bytes */
+	uint64_t position{0};
+	/** Data of the block `current_idx`, if `current_valid` */
+	std::vector<uint8_t> current;
+	std::size_t current_idx{0};
+	bool current_valid{false};
+	/** Blocks being decompressed in the pool, by block index */
+	std::map<std::size_t, std::shared_future<std::vector<uint8_t>>> prefetch;
+
+	std::vector<uint8_t> readMember(const std::size_t idx)
+	{
+		const auto& b = blocks[idx];
+		std::vector<uint8_t> member(b.member_len);
+		file->Seek(b.file_offset);
+		if (file->Read(member.data(), member.size()) != member.size())
+			THROW_EXCEPTION("Unexpected end of file reading block.");
+		return member;
+	}
+
+	/** Index of the block containing the uncompressed byte `pos` */
+	std::size_t findBlock(const uint64_t pos) const
+	{
+		auto it = std::upper_bound(
+			blocks.begin(), blocks.end(), pos,
+			[](uint64_t p, const BlockInfo& b) { return p < b.offset; });
+		return static_cast<std::size_t>(it - blocks.begin()) - 1;
+	}
+
+	void loadBlock(const std::size_t idx)
+	{
+		if (current_valid && current_idx == idx) return;
+
+		auto it = prefetch.find(idx);
+		if (it != prefetch.end())
+		{
+			current = it->second.get();
+			prefetch.erase(it);
+		}
+		else
+			current = internal::decompressBlockGZ(readMember(idx));
+		current_idx = idx;
+		current_valid = true;
+
+		if (!pool) return;
+		// Forget blocks we will not use, e.g. after a Seek():
+		const std::size_t last_idx =
+			std::min(blocks.size() - 1, idx + 2 * pool->size());
+		for (auto p = prefetch.begin(); p != prefetch.end();)
+		{
+			if (p->first < idx || p->first > last_idx)
+				p = prefetch.erase(p);
+			else
+				++p;
+		}
+		// File access is sequential, in this thread; only inflate() runs in
+		// parallel:
+		for (std::size_t i = idx + 1; i <= last_idx; i++)
+		{
+			if (prefetch.count(i)) continue;
+			auto member =
+				std::make_shared<std::vector<uint8_t>>(readMember(i));
+			auto task = [member]() {
+				return internal::decompressBlockGZ(*member);
+			};
+			prefetch[i] = pool->enqueue(task).share();
+		}
+	}
+};
+
+CFileBlockGZInputStream::CFileBlockGZInputStream()
+	: m_impl(mrpt::make_impl<CFileBlockGZInputStream::Impl>())
+{
+}
+
+CFileBlockGZInputStream::CFileBlockGZInputStream(const string& fileName)
+	: m_impl(mrpt::make_impl<CFileBlockGZInputStream::Impl>())
+{
+	MRPT_START
+	if (!open(fileName))
+		THROW_EXCEPTION_FMT(
+			"Error trying to open file: '%s'", fileName.c_str());
+	MRPT_END
+}
+
+CFileBlockGZInputStream::~CFileBlockGZInputStream() { close(); }
+
+bool CFileBlockGZInputStream::open(
+	const string& fileName, unsigned int num_threads)
+{
+	MRPT_START
+
+	close();
+
+	auto f = std::make_shared<CFileInputStream>();
+	if (!f->open(fileName)) return false;
+
+	// Build the index of blocks from the headers of all gzip members:
+	const uint64_t file_len = f->getTotalBytesCount();
+	std::vector<Impl::BlockInfo> blocks;
+	uint64_t file_offset = 0, offset = 0;
+	while (file_offset + internal::BLOCK_GZ_HEADER_LEN <= file_len)
+	{
+		uint8_t header[internal::BLOCK_GZ_HEADER_LEN];
+		uint32_t member_len = 0, len = 0;
+		f->Seek(file_offset);
+		if (f->Read(header, sizeof(header)) != sizeof(header) ||
+			!internal::parseBlockGZHeader(header, member_len, len))
+		{
+			// Not written by CFileBlockGZOutputStream?
+			if (file_offset == 0) return false;
+			break;
+		}
+		// Incomplete last block: the file was not properly closed.
+		if (file_offset + member_len > file_len) break;
+
+		if (len > 0)
+			blocks.push_back({file_offset, offset, member_len, len});
+		file_offset += member_len;
+		offset += len;
+	}
+	if (file_offset == 0) return false;
+
+	m_impl->file = f;
+	m_impl->blocks = std::move(blocks);
+	m_impl->total_len = offset;
+
+	if (num_threads == 0)
+		num_threads = mrpt::system::CWorkerThreadsPool::hardwareThreads();
+	if (num_threads > 1)
+		m_impl->pool =
+			std::make_shared<mrpt::system::CWorkerThreadsPool>(num_threads);
+	return true;
+
+	MRPT_END
+}
+
+void CFileBlockGZInputStream::close()
+{
+	m_impl->prefetch.clear();
+	m_impl->pool.reset();
+	m_impl->file.reset();
+	m_impl->blocks.clear();
+	m_impl->total_len = 0;
+	m_impl->position = 0;
+	m_impl->current = std::vector<uint8_t>();
+	m_impl->current_valid = false;
+}
+
+bool CFileBlockGZInputStream::isBlockGZFile(const std::string& fileName)
+{
+	CFileInputStream f;
+	if (!f.open(fileName)) return false;
+	uint8_t header[internal::BLOCK_GZ_HEADER_LEN];
+	uint32_t member_len = 0, len = 0;
+	return f.Read(header, sizeof(header)) == sizeof(header) &&
+		   internal::parseBlockGZHeader(header, member_len, len);
+}
+
+size_t CFileBlockGZInputStream::Read(void* Buffer, size_t Count)
+{
+	MRPT_START
+	if (!m_impl->file) THROW_EXCEPTION("File is not open.");
+
+	auto dst = reinterpret_cast<uint8_t*>(Buffer);
+	size_t nRead = 0;
+	while (nRead < Count && m_impl->position < m_impl->total_len)
+	{
+		const auto idx = m_impl->findBlock(m_impl->position);
+		m_impl->loadBlock(idx);
+
+		const auto& b = m_impl->blocks[idx];
+		const size_t in_block = m_impl->position - b.offset;
+		const size_t n = std::min(Count - nRead, b.len - in_block);
+		::memcpy(dst + nRead, &m_impl->current[in_block], n);
+		nRead += n;
+		m_impl->position += n;
+	}
+	return nRead;
+	MRPT_END
+}
+
+size_t CFileBlockGZInputStream::Write(const void* Buffer, size_t Count)
+{
+	MRPT_UNUSED_PARAM(Buffer);
+	MRPT_UNUSED_PARAM(Count);
+	THROW_EXCEPTION("Trying to write to an input file stream.");
+}
+
+uint64_t CFileBlockGZInputStream::Seek(
+	int64_t Offset, CStream::TSeekOrigin Origin)
+{
+	if (!m_impl->file) THROW_EXCEPTION("File is not open.");
+
+	int64_t newPos = 0;
+	switch (Origin)
+	{
+		case sFromBeginning:
+			newPos = Offset;
+			break;
+		case sFromCurrent:
+			newPos = static_cast<int64_t>(m_impl->position) + Offset;
+			break;
+		case sFromEnd:
+			newPos = static_cast<int64_t>(m_impl->total_len) + Offset;
+			break;
+		default:
+			THROW_EXCEPTION("Invalid value for 'Origin'");
+	}
+	// Allow positioning at the end of file (EOF), but not beyond:
+	if (newPos < 0) newPos = 0;
+	if (newPos > static_cast<int64_t>(m_impl->total_len))
+		newPos = static_cast<int64_t>(m_impl->total_len);
+	m_impl->position = static_cast<uint64_t>(newPos);
+	return m_impl->position;
+}
+
+uint64_t CFileBlockGZInputStream::getTotalBytesCount() const
+{
+	if (!m_impl->file) THROW_EXCEPTION("File is not open.");
+	return m_impl->total_len;
+}
+
+uint64_t CFileBlockGZInputStream::getPosition() const
+{
+	if (!m_impl->file) THROW_EXCEPTION("File is not open.");
+	return m_impl->position;
+}
+
+bool CFileBlockGZInputStream::fileOpenCorrectly() const
+{
+	return m_impl->file != nullptr;
+}
+
+bool CFileBlockGZInputStream::checkEOF()
+{
+	return !m_impl->file || m_impl->position >= m_impl->total_len;
+}
+
+std::size_t CFileBlockGZInputStream::getBlockCount() const
+{
+	return m_impl->blocks.size();
+}
@@ -0,0 +1,208 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "io-precomp.h"  // Precompiled headers
+
+#include <mrpt/io/CFileBlockGZOutputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/core/exceptions.h>
+#include "CFileBlockGZ_internal.h"
+
+#include <algorithm>  // min()
+#include <deque>
+#include <exception>
+#include <future>
+#include <iostream>
+#include <memory>
+
+using namespace mrpt::io;
+using namespace std;
+
+struct CFileBlockGZOutputStream::Impl
+{
+	std::shared_ptr<CFileOutputStream> file;
+	std::shared_ptr<mrpt::system::CWorkerThreadsPool> pool;
+	/** Blocks being compressed, in file order */
+	std::deque<std::shared_future<std::vector<uint8_t>>> pending;
+	/** Uncompressed data of the block being filled */
+	std::vector<uint8_t> block;
+	std::size_t block_size{CFileBlockGZOutputStream::DEFAULT_BLOCK_SIZE};
+	int compress_level{1};
+	uint64_t position{0};
+	bool any_block_written{false};
+
+	void writeMember(const std::vector<uint8_t>& member)
+	{
+		if (file->Write(member.data(), member.size()) != member.size())
+			THROW_EXCEPTION("Error writing compressed block to file.");
+		any_block_written = true;
+	}
+
+	/** Writes to disk the oldest compressed blocks, until at most
+	 * `max_pending` are left (blocks if they are not ready yet). */
+	void writeFinished(const std::size_t max_pending)
+	{
+		while (pending.size() > max_pending)
+		{
+			writeMember(pending.front().get());
+			pending.pop_front();
+		}
+	}
+
+	/** Sends the current block to compression, even if not full. */
+	void flushBlock()
+	{
+		if (!pool)
+		{
+			writeMember(
+				internal::compressBlockGZ(
+					block.data(), block.size(), compress_level));
+			block.clear();
+			return;
+		}
+		const int level = compress_level;
+		auto data = std::make_shared<std::vector<uint8_t>>(std::move(block));
+		block = std::vector<uint8_t>();
+		block.reserve(block_size);
+		auto task = [data, level]() {
+			return internal::compressBlockGZ(data->data(), data->size(), level);
+		};
+		pending.emplace_back(pool->enqueue(task).share());
+		// Keep all threads busy, but bound the memory in use:
+		writeFinished(2 * pool->size());
+	}
+};
+
+CFileBlockGZOutputStream::CFileBlockGZOutputStream(const string& fileName)
+	: m_impl(mrpt::make_impl<CFileBlockGZOutputStream::Impl>())
+{
+	MRPT_START
+	if (!open(fileName))
+		THROW_EXCEPTION_FMT(
+			"Error trying to open file: '%s'", fileName.c_str());
+	MRPT_END
+}
+
+CFileBlockGZOutputStream::CFileBlockGZOutputStream()
+	: m_impl(mrpt::make_impl<CFileBlockGZOutputStream::Impl>())
+{
+}
+
+CFileBlockGZOutputStream::~CFileBlockGZOutputStream()
+{
+	try
+	{
+		close();
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "[~CFileBlockGZOutputStream] Error closing file:\n"
+				  << e.what() << std::endl;
+	}
+}
+
+bool CFileBlockGZOutputStream::open(
+	const string& fileName, int compress_level, unsigned int num_threads,
+	std::size_t block_size)
+{
+	MRPT_START
+	ASSERT_(block_size > 0 && block_size <= internal::BLOCK_GZ_MAX_SIZE);
+	ASSERT_(compress_level >= 0 && compress_level <= 9);
+
+	close();
+
+	auto f = std::make_shared<CFileOutputStream>();
+	if (!f->open(fileName)) return false;
+
+	m_impl->file = f;
+	m_impl->block_size = block_size;
+	m_impl->compress_level = compress_level;
+	m_impl->block.reserve(block_size);
+
+	if (num_threads == 0)
+		num_threads = mrpt::system::CWorkerThreadsPool::hardwareThreads();
+	if (num_threads > 1)
+		m_impl->pool =
+			std::make_shared<mrpt::system::CWorkerThreadsPool>(num_threads);
+	return true;
+	MRPT_END
+}
+
+void CFileBlockGZOutputStream::close()
+{
+	if (!m_impl->file) return;
+
+	// Make sure the stream is left closed, even if writing fails:
+	std::exception_ptr err;
+	try
+	{
+		// An empty file is not a valid gzip file: write at least one block.
+		if (!m_impl->block.empty() || !m_impl->any_block_written)
+			m_impl->flushBlock();
+		m_impl->writeFinished(0);
+	}
+	catch (...)
+	{
+		err = std::current_exception();
+	}
+	m_impl->pending.clear();
+	m_impl->pool.reset();
+	m_impl->file->close();
+	m_impl->file.reset();
+	m_impl->block = std::vector<uint8_t>();
+	m_impl->position = 0;
+	m_impl->any_block_written = false;
+	if (err) std::rethrow_exception(err);
+}
+
+size_t CFileBlockGZOutputStream::Read(void*, size_t)
+{
+	THROW_EXCEPTION("Trying to read from an output file stream.");
+}
+
+size_t CFileBlockGZOutputStream::Write(const void* Buffer, size_t Count)
+{
+	if (!m_impl->file) THROW_EXCEPTION("File is not open.");
+
+	auto src = reinterpret_cast<const uint8_t*>(Buffer);
+	size_t left = Count;
+	while (left > 0)
+	{
+		auto& blk = m_impl->block;
+		const size_t n = std::min(left, m_impl->block_size - blk.size());
+		blk.insert(blk.end(), src, src + n);
+		src += n;
+		left -= n;
+		if (blk.size() == m_impl->block_size) m_impl->flushBlock();
+	}
+	m_impl->position += Count;
+	return Count;
+}
+
+uint64_t CFileBlockGZOutputStream::getPosition() const
+{
+	if (!m_impl->file) THROW_EXCEPTION("File is not open.");
+	return m_impl->position;
+}
+
+bool CFileBlockGZOutputStream::fileOpenCorrectly() const
+{
+	return m_impl->file != nullptr;
+}
+
+uint64_t CFileBlockGZOutputStream::Seek(int64_t, CStream::TSeekOrigin)
+{
+	THROW_EXCEPTION("Method not available in this class.");
+}
+
+uint64_t CFileBlockGZOutputStream::getTotalBytesCount() const
+{
+	THROW_EXCEPTION("Method not available in this class.");
+}
@@ -0,0 +1,124 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "io-precomp.h"  // Precompiled headers
+
+#include "CFileBlockGZ_internal.h"
+#include <mrpt/core/exceptions.h>
+
+#include <zlib.h>
+#include <algorithm>  // copy()
+
+using namespace mrpt::io::internal;
+
+static void put_uint32(uint8_t* p, const uint32_t v)
+{
+	p[0] = static_cast<uint8_t>(v);
+	p[1] = static_cast<uint8_t>(v >> 8);
+	p[2] = static_cast<uint8_t>(v >> 16);
+	p[3] = static_cast<uint8_t>(v >> 24);
+}
+
+static uint32_t get_uint32(const uint8_t* p)
+{
+	return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) |
+		   (uint32_t(p[3]) << 24);
+}
+
+std::vector<uint8_t> mrpt::io::internal::compressBlockGZ(
+	const uint8_t* data, std::size_t len, int compress_level)
+{
+	MRPT_START
+	ASSERT_(len <= BLOCK_GZ_MAX_SIZE);
+
+	z_stream strm{};
+	// Negative window bits: raw deflate data, we write the gzip framing.
+	int ret = deflateInit2(
+		&strm, compress_level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+	if (ret != Z_OK) THROW_EXCEPTION_FMT("deflateInit2() error: %i", ret);
+
+	const auto bound = deflateBound(&strm, static_cast<uLong>(len));
+	std::vector<uint8_t> out(
+		BLOCK_GZ_HEADER_LEN + bound + BLOCK_GZ_TRAILER_LEN);
+
+	strm.next_in = const_cast<Bytef*>(data);
+	strm.avail_in = static_cast<uInt>(len);
+	strm.next_out = &out[BLOCK_GZ_HEADER_LEN];
+	strm.avail_out = static_cast<uInt>(bound);
+	ret = deflate(&strm, Z_FINISH);
+	const std::size_t deflated_len = strm.total_out;
+	deflateEnd(&strm);
+	if (ret != Z_STREAM_END) THROW_EXCEPTION_FMT("deflate() error: %i", ret);
+
+	const std::size_t member_len =
+		BLOCK_GZ_HEADER_LEN + deflated_len + BLOCK_GZ_TRAILER_LEN;
+	out.resize(member_len);
+
+	uint8_t* h = &out[0];
+	const uint8_t magic[16] = {0x1f, 0x8b, 0x08, 0x04, 0, 0,   0, 0,
+							   0,	0xff, 12,   0,	'M', 'R', 8, 0};
+	std::copy(magic, magic + sizeof(magic), h);
+	put_uint32(h + 16, static_cast<uint32_t>(member_len));
+	put_uint32(h + 20, static_cast<uint32_t>(len));
+
+	uint8_t* t = &out[member_len - BLOCK_GZ_TRAILER_LEN];
+	put_uint32(t, crc32(crc32(0, Z_NULL, 0), data, static_cast<uInt>(len)));
+	put_uint32(t + 4, static_cast<uint32_t>(len));
+	return out;
+	MRPT_END
+}
+
+bool mrpt::io::internal::parseBlockGZHeader(
+	const uint8_t* h, uint32_t& member_len, uint32_t& uncompressed_len)
+{
+	if (h[0] != 0x1f || h[1] != 0x8b || h[2] != 0x08 || h[3] != 0x04 ||
+		h[10] != 12 || h[11] != 0 || h[12] != 'M' || h[13] != 'R' ||
+		h[14] != 8 || h[15] != 0)
+		return false;
+	member_len = get_uint32(h + 16);
+	uncompressed_len = get_uint32(h + 20);
+	return member_len >= BLOCK_GZ_HEADER_LEN + BLOCK_GZ_TRAILER_LEN &&
+		   uncompressed_len <= BLOCK_GZ_MAX_SIZE;
+}
+
+std::vector<uint8_t> mrpt::io::internal::decompressBlockGZ(
+	const std::vector<uint8_t>& member)
+{
+	MRPT_START
+	uint32_t member_len = 0, len = 0;
+	ASSERT_(member.size() >= BLOCK_GZ_HEADER_LEN + BLOCK_GZ_TRAILER_LEN);
+	if (!parseBlockGZHeader(&member[0], member_len, len) ||
+		member_len != member.size())
+		THROW_EXCEPTION("Corrupted block header in compressed file.");
+
+	std::vector<uint8_t> out(len);
+	z_stream strm{};
+	int ret = inflateInit2(&strm, -MAX_WBITS);
+	if (ret != Z_OK) THROW_EXCEPTION_FMT("inflateInit2() error: %i", ret);
+
+	strm.next_in = const_cast<Bytef*>(&member[BLOCK_GZ_HEADER_LEN]);
+	strm.avail_in = static_cast<uInt>(
+		member_len - BLOCK_GZ_HEADER_LEN - BLOCK_GZ_TRAILER_LEN);
+	uint8_t dummy;  // inflate() refuses a null output, even if empty
+	strm.next_out = len ? out.data() : &dummy;
+	strm.avail_out = static_cast<uInt>(len);
+	ret = inflate(&strm, Z_FINISH);
+	const std::size_t inflated_len = strm.total_out;
+	inflateEnd(&strm);
+	if (ret != Z_STREAM_END || inflated_len != len)
+		THROW_EXCEPTION_FMT("Corrupted compressed block (inflate: %i)", ret);
+
+	const uint8_t* t = &member[member_len - BLOCK_GZ_TRAILER_LEN];
+	const uint32_t crc =
+		crc32(crc32(0, Z_NULL, 0), out.data(), static_cast<uInt>(len));
+	if (get_uint32(t) != crc || get_uint32(t + 4) != len)
+		THROW_EXCEPTION("CRC error in compressed block.");
+	return out;
+	MRPT_END
+}
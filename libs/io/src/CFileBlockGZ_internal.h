@@ -0,0 +1,60 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Private helpers shared by CFileBlockGZOutputStream and
+// CFileBlockGZInputStream. Each block is stored as one gzip member (RFC 1952):
+//
+//  Offset  Size  Contents
+//  0       4     1f 8b 08 04 (gzip magic, deflate, FEXTRA flag)
+//  4       4     MTIME = 0
+//  8       2     XFL = 0, OS = 0xff (unknown)
+//  10      2     XLEN = 12
+//  12      4     'M' 'R' 08 00 (subfield ID and its length)
+//  16      4     Total size of this member, in bytes (LE)
+//  20      4     Uncompressed size of the block, in bytes (LE)
+//  24      ...   Raw deflate data
+//  end-8   4     CRC32 of the uncompressed data (LE)
+//  end-4   4     Uncompressed size of the block, in bytes (LE)
+
+namespace mrpt
+{
+namespace io
+{
+namespace internal
+{
+/** Length of the header of each gzip member */
+constexpr std::size_t BLOCK_GZ_HEADER_LEN = 24;
+/** Length of the trailer of each gzip member */
+constexpr std::size_t BLOCK_GZ_TRAILER_LEN = 8;
+/** Maximum uncompressed size of one block, so that any member fits in the
+ * 32bit size fields of the header. */
+constexpr std::size_t BLOCK_GZ_MAX_SIZE = 64 * 1024 * 1024;
+
+/** Compresses one block into a complete gzip member. */
+std::vector<uint8_t> compressBlockGZ(
+	const uint8_t* data, std::size_t len, int compress_level);
+
+/** Parses the header of a gzip member.
+ * \return false if it is not a member written by compressBlockGZ() */
+bool parseBlockGZHeader(
+	const uint8_t* header, uint32_t& member_len, uint32_t& uncompressed_len);
+
+/** Decompresses a complete gzip member written by compressBlockGZ() and
+ * checks its CRC.
+ * \exception std::exception On corrupted data. */
+std::vector<uint8_t> decompressBlockGZ(const std::vector<uint8_t>& member);
+
+}  // namespace internal
+}  // namespace io
+}  // namespace mrpt
@@ -0,0 +1,157 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/io/CFileBlockGZInputStream.h>
+#include <mrpt/io/CFileBlockGZOutputStream.h>
+#include <mrpt/io/CFileGZInputStream.h>
+#include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/io/CFileInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+using namespace mrpt::io;
+
+namespace
+{
+std::vector<uint32_t> testData()
+{
+	std::vector<uint32_t> buf(100000);
+	for (size_t i = 0; i < buf.size(); i++) buf[i] = (i * 7) % 1000;
+	return buf;
+}
+
+void writeTestFile(
+	const std::string& fil, const std::vector<uint32_t>& buf,
+	unsigned int num_threads)
+{
+	CFileBlockGZOutputStream f;
+	// Small blocks, to test data spanning several of them:
+	EXPECT_TRUE(f.open(fil, 1, num_threads, 10000));
+	// Writes of odd sizes, not aligned with blocks:
+	const auto data = reinterpret_cast<const uint8_t*>(&buf[0]);
+	const size_t len = buf.size() * sizeof(buf[0]);
+	for (size_t i = 0; i < len; i += 777)
+		f.Write(data + i, std::min<size_t>(777, len - i));
+	EXPECT_EQ(f.getPosition(), len);
+}
+}  // namespace
+
+TEST(CFileBlockGZ, writeReadSeek)
+{
+	const auto buf = testData();
+	const size_t len = buf.size() * sizeof(buf[0]);
+
+	for (unsigned int num_threads : {1U, 4U})
+	{
+		const std::string fil = mrpt::system::getTempFileName();
+		writeTestFile(fil, buf, num_threads);
+		EXPECT_TRUE(CFileBlockGZInputStream::isBlockGZFile(fil));
+
+		CFileBlockGZInputStream f;
+		ASSERT_TRUE(f.open(fil, num_threads));
+		EXPECT_EQ(f.getBlockCount(), (len + 9999) / 10000);
+		EXPECT_EQ(f.getTotalBytesCount(), len);
+
+		std::vector<uint32_t> rd(buf.size());
+		EXPECT_EQ(f.Read(&rd[0], len), len);
+		EXPECT_TRUE(rd == buf);
+		EXPECT_TRUE(f.checkEOF());
+		EXPECT_EQ(f.Read(&rd[0], 4), 0U);
+
+		// Random access, backwards and across blocks:
+		uint32_t v = 0;
+		for (size_t i : {99999U, 5000U, 2499U, 2500U, 0U, 60000U})
+		{
+			f.Seek(i * sizeof(uint32_t));
+			EXPECT_EQ(f.Read(&v, sizeof(v)), sizeof(v));
+			EXPECT_EQ(v, buf[i]);
+		}
+		f.Seek(-int64_t(2 * sizeof(uint32_t)), CStream::sFromEnd);
+		EXPECT_EQ(f.Read(&v, sizeof(v)), sizeof(v));
+		EXPECT_EQ(v, buf[buf.size() - 2]);
+		f.Seek(-int64_t(2 * sizeof(uint32_t)), CStream::sFromCurrent);
+		EXPECT_EQ(f.Read(&v, sizeof(v)), sizeof(v));
+		EXPECT_EQ(v, buf[buf.size() - 3]);
+		f.close();
+
+		mrpt::system::deleteFile(fil);
+	}
+}
+
+TEST(CFileBlockGZ, readableAsGzip)
+{
+	const auto buf = testData();
+	const size_t len = buf.size() * sizeof(buf[0]);
+	const std::string fil = mrpt::system::getTempFileName();
+	writeTestFile(fil, buf, 4);
+
+	CFileGZInputStream f(fil);
+	std::vector<uint32_t> rd(buf.size() + 1);
+	EXPECT_EQ(f.Read(&rd[0], len + 4), len);
+	rd.resize(buf.size());
+	EXPECT_TRUE(rd == buf);
+	f.close();
+
+	mrpt::system::deleteFile(fil);
+}
+
+TEST(CFileBlockGZ, truncatedAndForeignFiles)
+{
+	const auto buf = testData();
+	const std::string fil = mrpt::system::getTempFileName();
+
+	// Empty, but valid file:
+	{
+		CFileBlockGZOutputStream f(fil);
+	}
+	{
+		CFileBlockGZInputStream f(fil);
+		EXPECT_EQ(f.getTotalBytesCount(), 0U);
+		EXPECT_TRUE(f.checkEOF());
+	}
+
+	// Regular gzip files can not be read:
+	{
+		CFileGZOutputStream f(fil);
+		f.Write(&buf[0], 1000);
+	}
+	EXPECT_FALSE(CFileBlockGZInputStream::isBlockGZFile(fil));
+	{
+		CFileBlockGZInputStream f;
+		EXPECT_FALSE(f.open(fil));
+		EXPECT_FALSE(f.fileOpenCorrectly());
+	}
+
+	// Files not properly closed: the incomplete block is ignored.
+	writeTestFile(fil, buf, 1);
+	std::vector<uint8_t> raw;
+	{
+		CFileInputStream f(fil);
+		raw.resize(f.getTotalBytesCount());
+		f.Read(&raw[0], raw.size());
+	}
+	{
+		CFileOutputStream f(fil);
+		f.Write(&raw[0], raw.size() - 10);
+	}
+	{
+		CFileBlockGZInputStream f(fil);
+		const size_t nBlocks = (buf.size() * sizeof(buf[0]) + 9999) / 10000;
+		EXPECT_EQ(f.getBlockCount(), nBlocks - 1);
+		std::vector<uint32_t> rd(buf.size());
+		const size_t n = f.Read(&rd[0], rd.size() * sizeof(rd[0]));
+		EXPECT_EQ(n, (nBlocks - 1) * 10000);
+		EXPECT_TRUE(std::equal(rd.begin(), rd.begin() + n / 4, buf.begin()));
+	}
+
+	mrpt::system::deleteFile(fil);
+}
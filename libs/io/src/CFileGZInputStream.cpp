@@ -14,6 +14,7 @@
 #include <mrpt/core/exceptions.h>
 
 #include <zlib.h>
+#include <limits>
 
 using namespace mrpt::io;
 using namespace std;
@@ -25,6 +26,20 @@ static_assert(
 
 #define THE_GZFILE reinterpret_cast<gzFile>(m_f)
 
+// gzseek() and gztell() use z_off_t, which is a 32-bit long in some
+// platforms (e.g. Windows). Use their 64-bit versions when zlib provides
+// them; otherwise, positions beyond z_off_t raise an exception instead of
+// silently wrapping around.
+#if defined(Z_LARGE64)
+using gz_offset_t = z_off64_t;
+#define MRPT_GZSEEK gzseek64
+#define MRPT_GZTELL gztell64
+#else
+using gz_offset_t = z_off_t;
+#define MRPT_GZSEEK gzseek
+#define MRPT_GZTELL gztell
+#endif
+
 CFileGZInputStream::CFileGZInputStream(const string& fileName) : m_f(nullptr)
 {
 	MRPT_START
@@ -93,7 +108,12 @@ uint64_t CFileGZInputStream::getPosition() const
 	{
 		THROW_EXCEPTION("File is not open.");
 	}
-	return gztell(THE_GZFILE);
+	const gz_offset_t ret = MRPT_GZTELL(THE_GZFILE);
+	if (ret < 0)
+		THROW_EXCEPTION(
+			"Error getting the position in gz file (or it is beyond the "
+			"range of z_off_t).");
+	return static_cast<uint64_t>(ret);
 }
 
 bool CFileGZInputStream::fileOpenCorrectly() const { return m_f != nullptr; }
@@ -105,7 +125,30 @@ bool CFileGZInputStream::checkEOF()
 		return 0 != gzeof(THE_GZFILE);
 }
 
-uint64_t CFileGZInputStream::Seek(int64_t, CStream::TSeekOrigin)
+uint64_t CFileGZInputStream::Seek(
+	int64_t Offset, CStream::TSeekOrigin Origin)
 {
-	THROW_EXCEPTION("Method not available in this class.");
+	if (!m_f)
+	{
+		THROW_EXCEPTION("File is not open.");
+	}
+	int whence;
+	switch (Origin)
+	{
+		case sFromBeginning:
+			whence = SEEK_SET;
+			break;
+		case sFromCurrent:
+			whence = SEEK_CUR;
+			break;
+		default:
+			THROW_EXCEPTION("Seek from the end is not supported in gz files.");
+	}
+	if (Offset > std::numeric_limits<gz_offset_t>::max() ||
+		Offset < std::numeric_limits<gz_offset_t>::min())
+		THROW_EXCEPTION("Seek offset beyond the range of z_off_t.");
+	const gz_offset_t ret =
+		MRPT_GZSEEK(THE_GZFILE, static_cast<gz_offset_t>(Offset), whence);
+	if (ret < 0) THROW_EXCEPTION("Error seeking in gz file.");
+	return static_cast<uint64_t>(ret);
 }
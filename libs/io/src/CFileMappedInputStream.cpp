@@ -0,0 +1,86 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "io-precomp.h"  // Precompiled headers
+
+#include <mrpt/io/CFileMappedInputStream.h>
+#include <mrpt/core/exceptions.h>
+#include <algorithm>  // min()
+#include <cstring>  // memcpy
+
+using namespace mrpt::io;
+
+CFileMappedInputStream::CFileMappedInputStream(const std::string& fileName)
+{
+	MRPT_START
+	if (!open(fileName))
+		THROW_EXCEPTION_FMT(
+			"Error trying to open file: '%s'", fileName.c_str());
+	MRPT_END
+}
+
+CFileMappedInputStream::CFileMappedInputStream() {}
+CFileMappedInputStream::~CFileMappedInputStream() { close(); }
+bool CFileMappedInputStream::open(const std::string& fileName)
+{
+	m_position = 0;
+	return m_file.open(fileName);
+}
+
+void CFileMappedInputStream::close()
+{
+	m_file.close();
+	m_position = 0;
+}
+
+size_t CFileMappedInputStream::Read(void* Buffer, size_t Count)
+{
+	if (!m_file.isOpen() || m_position >= m_file.size()) return 0;
+
+	const size_t nToRead =
+		std::min<uint64_t>(Count, m_file.size() - m_position);
+	::memcpy(Buffer, m_file.data() + m_position, nToRead);
+	m_position += nToRead;
+	return nToRead;
+}
+
+size_t CFileMappedInputStream::Write(const void* Buffer, size_t Count)
+{
+	MRPT_UNUSED_PARAM(Buffer);
+	MRPT_UNUSED_PARAM(Count);
+	THROW_EXCEPTION("Trying to write to a read file stream.");
+}
+
+uint64_t CFileMappedInputStream::Seek(
+	int64_t Offset, CStream::TSeekOrigin Origin)
+{
+	if (!m_file.isOpen()) return 0;
+
+	int64_t newPos = 0;
+	switch (Origin)
+	{
+		case sFromBeginning:
+			newPos = Offset;
+			break;
+		case sFromCurrent:
+			newPos = static_cast<int64_t>(m_position) + Offset;
+			break;
+		case sFromEnd:
+			newPos = static_cast<int64_t>(m_file.size()) + Offset;
+			break;
+		default:
+			THROW_EXCEPTION("Invalid value for 'Origin'");
+	}
+	// Allow positioning at the end of file (EOF), but not beyond:
+	if (newPos < 0) newPos = 0;
+	if (newPos > static_cast<int64_t>(m_file.size()))
+		newPos = static_cast<int64_t>(m_file.size());
+	m_position = static_cast<uint64_t>(newPos);
+	return m_position;
+}
@@ -0,0 +1,59 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/io/CFileMappedInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+using namespace mrpt::io;
+
+TEST(CFileMappedInputStream, readSeek)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	std::vector<uint32_t> buf(5000);
+	for (size_t i = 0; i < buf.size(); i++) buf[i] = i * 3;
+	{
+		CFileOutputStream f(fil);
+		f.Write(&buf[0], buf.size() * sizeof(buf[0]));
+	}
+
+	{
+		CFileMappedInputStream f(fil);
+		EXPECT_TRUE(f.fileOpenCorrectly());
+		EXPECT_EQ(f.getTotalBytesCount(), buf.size() * sizeof(buf[0]));
+
+		std::vector<uint32_t> rd(100);
+		EXPECT_EQ(f.Read(&rd[0], 100 * sizeof(uint32_t)), 400U);
+		EXPECT_TRUE(std::equal(rd.begin(), rd.end(), buf.begin()));
+		EXPECT_EQ(f.getPosition(), 400U);
+
+		f.Seek(-int64_t(sizeof(uint32_t)), CStream::sFromEnd);
+		uint32_t last = 0;
+		EXPECT_EQ(f.Read(&last, sizeof(last)), sizeof(last));
+		EXPECT_EQ(last, buf.back());
+		EXPECT_TRUE(f.checkEOF());
+		EXPECT_EQ(f.Read(&last, sizeof(last)), 0U);
+
+		f.Seek(8);
+		EXPECT_EQ(f.Read(&last, sizeof(last)), sizeof(last));
+		EXPECT_EQ(last, buf[2]);
+		f.Seek(4, CStream::sFromCurrent);
+		EXPECT_EQ(f.Read(&last, sizeof(last)), sizeof(last));
+		EXPECT_EQ(last, buf[4]);
+	}
+
+	CFileMappedInputStream f;
+	EXPECT_FALSE(f.open(fil + ".does_not_exist"));
+	EXPECT_FALSE(f.fileOpenCorrectly());
+
+	mrpt::system::deleteFile(fil);
+}
@@ -0,0 +1,117 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "io-precomp.h"  // Precompiled headers
+
+#include <mrpt/io/CMemoryMappedFile.h>
+#include <mrpt/core/exceptions.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace mrpt::io;
+
+CMemoryMappedFile::CMemoryMappedFile()
+	: m_data(nullptr),
+	  m_size(0)
+#ifdef _WIN32
+	  ,
+	  m_hFile(nullptr),
+	  m_hMapping(nullptr)
+#endif
+{
+}
+
+CMemoryMappedFile::CMemoryMappedFile(const std::string& fileName)
+	: CMemoryMappedFile()
+{
+	MRPT_START
+	if (!open(fileName))
+		THROW_EXCEPTION_FMT(
+			"Error trying to map file into memory: '%s'", fileName.c_str());
+	MRPT_END
+}
+
+CMemoryMappedFile::~CMemoryMappedFile() { close(); }
+bool CMemoryMappedFile::open(const std::string& fileName)
+{
+	close();
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(
+		fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER len;
+	if (!GetFileSizeEx(hFile, &len) || len.QuadPart == 0)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+	HANDLE hMapping =
+		CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!hMapping)
+	{
+		CloseHandle(hFile);
+		return false;
+	}
+	const void* ptr = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	if (!ptr)
+	{
+		CloseHandle(hMapping);
+		CloseHandle(hFile);
+		return false;
+	}
+	m_hFile = hFile;
+	m_hMapping = hMapping;
+	m_size = static_cast<std::size_t>(len.QuadPart);
+#else
+	const int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || st.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+	void* ptr = ::mmap(
+		nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_SHARED,
+		fd, 0);
+	// The mapping keeps its own reference to the file:
+	::close(fd);
+	if (ptr == MAP_FAILED) return false;
+	m_size = static_cast<std::size_t>(st.st_size);
+#endif
+	m_data = static_cast<const uint8_t*>(ptr);
+	return true;
+}
+
+void CMemoryMappedFile::close()
+{
+	if (!m_data) return;
+#ifdef _WIN32
+	UnmapViewOfFile(m_data);
+	CloseHandle(static_cast<HANDLE>(m_hMapping));
+	CloseHandle(static_cast<HANDLE>(m_hFile));
+	m_hMapping = nullptr;
+	m_hFile = nullptr;
+#else
+	::munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+	m_data = nullptr;
+	m_size = 0;
+}
@@ -0,0 +1,46 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/io/CMemoryMappedFile.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+
+using namespace mrpt::io;
+
+TEST(CMemoryMappedFile, readFile)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	std::vector<uint8_t> buf(10000);
+	for (size_t i = 0; i < buf.size(); i++)
+		buf[i] = static_cast<uint8_t>(i * 7);
+	{
+		CFileOutputStream f(fil);
+		f.Write(&buf[0], buf.size());
+	}
+
+	{
+		CMemoryMappedFile mf(fil);
+		EXPECT_TRUE(mf.isOpen());
+		ASSERT_EQ(mf.size(), buf.size());
+		EXPECT_TRUE(std::equal(buf.begin(), buf.end(), mf.data()));
+
+		mf.close();
+		EXPECT_FALSE(mf.isOpen());
+		EXPECT_EQ(mf.data(), nullptr);
+	}
+
+	CMemoryMappedFile mf;
+	EXPECT_FALSE(mf.open(fil + ".does_not_exist"));
+	EXPECT_FALSE(mf.isOpen());
+
+	mrpt::system::deleteFile(fil);
+}
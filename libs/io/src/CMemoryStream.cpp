@@ -40,7 +40,7 @@ void CMemoryStream::assignMemoryNotOwn(
 	m_memory.set(data);
 	m_size = nBytesInData;
 	m_position = 0;
-	m_bytesWritten = 0;
+	m_bytesWritten = nBytesInData;
 	m_read_only = true;
 }
 
@@ -102,8 +102,10 @@ size_t CMemoryStream::Write(const void* Buffer, size_t Count)
 
 	if (requiredSize >= m_size)
 	{
-		// Incrent the size of reserved memory:
-		resize(requiredSize + m_alloc_block_size);
+		// Increment the size of reserved memory. Grow geometrically, so
+		// writing large objects in many small chunks takes linear time:
+		resize(max<uint64_t>(
+			requiredSize + m_alloc_block_size, m_size + m_size / 2));
 	}
 
 	// Copy the memory block:
@@ -128,7 +130,7 @@ uint64_t CMemoryStream::Seek(int64_t Offset, CStream::TSeekOrigin Origin)
 			m_position += Offset;
 			break;
 		case sFromEnd:
-			m_position = m_bytesWritten - 1 + Origin;
+			m_position = m_bytesWritten + Offset;
 			break;
 	};
 
@@ -23,6 +23,11 @@
 #include <mrpt/typemeta/TEnumType.h>
 
 #include <mrpt/config.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #if (                                                \
 	!defined(OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS) &&   \
 	!defined(OCCUPANCY_GRIDMAP_CELL_SIZE_16BITS)) || \
@@ -33,6 +38,10 @@
 
 namespace mrpt
 {
+namespace system
+{
+class CWorkerThreadsPool;
+}
 namespace maps
 {
 /** A class for storing an occupancy grid map.
@@ -100,8 +109,38 @@ class COccupancyGridMap2D : public CMetricMap,
 	/** Lookup tables for log-odds */
 	static CLogOddsGridMapLUT<cellType>& get_logodd_lut();
 
-	/** Store of cell occupancy values. Order: row by row, from left to right */
-	std::vector<cellType> map;
+	/** log2 of the number of grid rows stored in each tile */
+	static constexpr unsigned int TILE_ROWS_LOG2 = 5;
+	static constexpr unsigned int TILE_ROWS = 1u << TILE_ROWS_LOG2;
+	/** A tile: TILE_ROWS consecutive rows of cells */
+	using tile_t = std::vector<cellType>;
+	/** Store of cell occupancy values. Order: row by row, from left to right,
+	 * split into tiles of TILE_ROWS full rows each. Tiles are reference
+	 * counted and shared by copies of the map (e.g. RBPF particles after
+	 * resampling): a tile is only duplicated when one of the maps sharing it
+	 * modifies any of its cells (copy-on-write). */
+	std::vector<std::shared_ptr<tile_t>> m_tiles;
+
+	/** Reallocates m_tiles for the current size_x,size_y, with all cells set
+	 * to `value`. All tiles initially share the same storage. */
+	void allocTiles(cellType value);
+	/** Pointer to the first cell of row `cy` (unchecked), for reading. */
+	inline const cellType* cellsRow(unsigned int cy) const
+	{
+		return m_tiles[cy >> TILE_ROWS_LOG2]->data() +
+			   (cy & (TILE_ROWS - 1)) * size_x;
+	}
+	/** Pointer to the first cell of row `cy` (unchecked), for writing: it
+	 * first duplicates the row tile if it is shared with another map. */
+	inline cellType* cellsRowForWriting(unsigned int cy)
+	{
+		std::shared_ptr<tile_t>& t = m_tiles[cy >> TILE_ROWS_LOG2];
+		if (t.use_count() > 1) t = std::make_shared<tile_t>(*t);
+		return t->data() + (cy & (TILE_ROWS - 1)) * size_x;
+	}
+	/** Gets pointers to rows [cy0,cy1] (clipped to the grid) for writing, into
+	 * `rows`, indexed by row number. Other entries are left as nullptr. */
+	void getRowsForWriting(int cy0, int cy1, std::vector<cellType*>& rows);
 	/** The size of the grid in cells */
 	uint32_t size_x, size_y;
 	/** The limits of the grid in "units" (meters) */
@@ -109,12 +148,110 @@ class COccupancyGridMap2D : public CMetricMap,
 	/** Cell size, i.e. resolution of the grid map. */
 	float resolution;
 
+	/** Per-cell likelihood values, filled on demand. Cells are atomic since
+	 * several threads may evaluate observations on the same map at once
+	 * (e.g. the particles of a filter). Copies start empty. */
+	struct TLikelihoodCache
+	{
+		TLikelihoodCache() = default;
+		TLikelihoodCache(const TLikelihoodCache&) {}
+		TLikelihoodCache& operator=(const TLikelihoodCache&)
+		{
+			assign(0, 0);
+			return *this;
+		}
+		void assign(size_t n, double val)
+		{
+			cells.reset(n ? new std::atomic<double>[n] : nullptr);
+			for (size_t i = 0; i < n; i++)
+				cells[i].store(val, std::memory_order_relaxed);
+			num_cells = n;
+		}
+		size_t size() const { return num_cells; }
+		std::atomic<double>& operator[](size_t i) { return cells[i]; }
+
+		std::unique_ptr<std::atomic<double>[]> cells;
+		size_t num_cells{0};
+		/** Held while checking or resetting the cache */
+		std::mutex cs;
+	};
+
 	/** Auxiliary variables to speed up the computation of observation
 	 * likelihood values for LF method among others, at a high cost in memory
 	 * (see TLikelihoodOptions::enableLikelihoodCache). */
-	std::vector<double> precomputedLikelihood;
+	TLikelihoodCache precomputedLikelihood;
 	bool precomputedLikelihoodToBeRecomputed;
 
+	/** Dense table with the per-cell term accumulated by the batch version of
+	 * computeLikelihoodField_Thrun() (log-likelihood, or likelihood if
+	 * TLikelihoodOptions::LF_alternateAverageMethod), built on demand from
+	 * m_DT. Empty if it must be rebuilt. */
+	std::vector<float> m_LF_table;
+	/** The LF_* parameters m_LF_table was built with. */
+	std::array<double, 7> m_LF_table_params;
+	/** Held while updating m_DT and m_LF_table, which are built lazily and
+	 * may be requested by several threads evaluating likelihoods at once.
+	 * Copies get their own mutex. */
+	struct TLikelihoodTableMutex
+	{
+		TLikelihoodTableMutex() = default;
+		TLikelihoodTableMutex(const TLikelihoodTableMutex&) {}
+		TLikelihoodTableMutex& operator=(const TLikelihoodTableMutex&)
+		{
+			return *this;
+		}
+		std::mutex cs;
+	};
+	TLikelihoodTableMutex m_LF_table_cs;
+	/** (Re)builds m_LF_table (and m_DT), if needed. Thread-safe. */
+	void buildLikelihoodFieldTable(
+		mrpt::system::CWorkerThreadsPool* threadPool = nullptr);
+
+	/** A rectangle of cells [x_min,x_max]x[y_min,y_max] (empty if
+	 * x_min>x_max) */
+	struct TCellRect
+	{
+		int x_min{1}, x_max{0}, y_min{1}, y_max{0};
+		bool empty() const { return x_min > x_max || y_min > y_max; }
+	};
+	/** Squared distance (in cells^2) from each cell to the closest occupied
+	 * one, saturated at m_DT_max_dist2. This distance transform of the grid
+	 * persists across map updates: only the cells around those modified since
+	 * the last call to updateDistanceTransform() (see m_DT_modified) are
+	 * recomputed. Empty if it must be rebuilt from scratch. */
+	std::vector<uint32_t> m_DT;
+	uint32_t m_DT_max_dist2;
+	/** Cells modified since the last update of m_DT. */
+	TCellRect m_DT_modified;
+	/** Updates m_DT, and returns in `changed` the cells whose value may have
+	 * changed. Must be called with m_LF_table_cs held. */
+	void updateDistanceTransform(
+		mrpt::system::CWorkerThreadsPool* threadPool, TCellRect& changed);
+	/** Must be called after modifying the given range of cells (clipped to
+	 * the grid), to keep m_DT up to date. */
+	inline void markCellsAsModified(int cx0, int cx1, int cy0, int cy1)
+	{
+		if (m_DT.empty()) return;  // Will be fully rebuilt anyway.
+		TCellRect& r = m_DT_modified;
+		cx0 = std::max(cx0, 0);
+		cy0 = std::max(cy0, 0);
+		cx1 = std::min(cx1, static_cast<int>(size_x) - 1);
+		cy1 = std::min(cy1, static_cast<int>(size_y) - 1);
+		if (cx0 > cx1 || cy0 > cy1) return;
+		if (r.empty())
+		{
+			r.x_min = cx0;
+			r.x_max = cx1;
+			r.y_min = cy0;
+			r.y_max = cy1;
+			return;
+		}
+		r.x_min = std::min(r.x_min, cx0);
+		r.x_max = std::max(r.x_max, cx1);
+		r.y_min = std::min(r.y_min, cy0);
+		r.y_max = std::max(r.y_max, cy1);
+	}
+
 	/** Used for Voronoi calculation.Same struct as "map", but contains a "0" if
 	 * not a basis point. */
 	mrpt::containers::CDynamicGrid<uint8_t> m_basis_map;
@@ -143,18 +280,24 @@ class COccupancyGridMap2D : public CMetricMap,
 	/** Change the contents [0,1] of a cell, given its index */
 	inline void setCell_nocheck(int x, int y, float value)
 	{
-		map[x + y * size_x] = p2l(value);
+		cellsRowForWriting(y)[x] = p2l(value);
+		markCellsAsModified(x, x, y, y);
 	}
 
 	/** Read the real valued [0,1] contents of a cell, given its index */
 	inline float getCell_nocheck(int x, int y) const
 	{
-		return l2p(map[x + y * size_x]);
+		return l2p(cellsRow(y)[x]);
 	}
 	/** Changes a cell by its absolute index (Do not use it normally) */
 	inline void setRawCell(unsigned int cellIndex, cellType b)
 	{
-		if (cellIndex < size_x * size_y) map[cellIndex] = b;
+		if (cellIndex < size_x * size_y)
+		{
+			const int cx = cellIndex % size_x, cy = cellIndex / size_x;
+			cellsRowForWriting(cy)[cx] = b;
+			markCellsAsModified(cx, cx, cy, cy);
+		}
 	}
 
 	/** One of the methods that can be selected for implementing
@@ -217,7 +360,7 @@ class COccupancyGridMap2D : public CMetricMap,
    public:
 	/** Read-only access to the raw cell contents (cells are in log-odd units)
 	 */
-	const std::vector<cellType>& getRawMap() const { return this->map; }
+	std::vector<cellType> getRawMap() const;
 	/** Performs the Bayesian fusion of a new observation of a cell  \sa
 	 * updateInfoChangeOnly, updateCell_fast_occupied, updateCell_fast_free */
 	void updateCell(int x, int y, float v);
@@ -371,8 +514,8 @@ class COccupancyGridMap2D : public CMetricMap,
 		if (static_cast<unsigned int>(x) >= size_x ||
 			static_cast<unsigned int>(y) >= size_y)
 			return;
-		else
-			map[x + y * size_x] = p2l(value);
+		cellsRowForWriting(y)[x] = p2l(value);
+		markCellsAsModified(x, x, y, y);
 	}
 
 	/** Read the real valued [0,1] contents of a cell, given its index */
@@ -383,17 +526,19 @@ class COccupancyGridMap2D : public CMetricMap,
 			static_cast<unsigned int>(y) >= size_y)
 			return 0.5f;
 		else
-			return l2p(map[x + y * size_x]);
+			return l2p(cellsRow(y)[x]);
 	}
 
 	/** Access to a "row": mainly used for drawing grid as a bitmap efficiently,
-	 * do not use it normally */
+	 * do not use it normally. Changes done through this pointer are not
+	 * tracked by TLikelihoodOptions::LF_useDistanceTransform. Only the cells
+	 * within one row are contiguous in memory. */
 	inline cellType* getRow(int cy)
 	{
 		if (cy < 0 || static_cast<unsigned int>(cy) >= size_y)
 			return nullptr;
 		else
-			return &map[0 + cy * size_x];
+			return cellsRowForWriting(cy);
 	}
 
 	/** Access to a "row": mainly used for drawing grid as a bitmap efficiently,
@@ -403,7 +548,7 @@ class COccupancyGridMap2D : public CMetricMap,
 		if (cy < 0 || static_cast<unsigned int>(cy) >= size_y)
 			return nullptr;
 		else
-			return &map[0 + cy * size_x];
+			return cellsRow(cy);
 	}
 
 	/** Change the contents [0,1] of a cell, given its coordinates */
@@ -646,6 +791,12 @@ class COccupancyGridMap2D : public CMetricMap,
 		/** Enables the usage of a cache of likelihood values (for LF methods),
 		 * if set to true (default=false). */
 		bool enableLikelihoodCache;
+		/** [LikelihoodField] If true (default=false), the likelihood field is
+		 * looked up in a dense table built from a distance transform of the
+		 * grid, which is kept across map updates and only recomputed around
+		 * the modified cells (see computeLikelihoodField_Thrun() for a batch of
+		 * poses). It takes 8 bytes per cell. */
+		bool LF_useDistanceTransform;
 	} likelihoodOptions;
 
 	/** Auxiliary private class. */
@@ -963,6 +1114,29 @@ class COccupancyGridMap2D : public CMetricMap,
 		const CPointsMap* pm,
 		const mrpt::poses::CPose2D* relativePose = nullptr);
 
+	/** Batch version of computeLikelihoodField_Thrun(): evaluates the
+	 * log-likelihood of the set of points `pm` as seen from each of the given
+	 * poses (e.g. all the particles of a localization filter against one
+	 * scan). `out_log_liks` is resized to the number of poses.
+	 *
+	 * Instead of searching for the closest occupied cell around each point,
+	 * a dense likelihood table is built from an Euclidean distance transform
+	 * of the grid, which is kept and only updated around the cells modified
+	 * by later insertions or updateCell(); then, each point costs a single
+	 * table lookup (AVX2 gathers if MRPT_HAS_AVX2). Poses are
+	 * evaluated in parallel if a thread pool is provided.
+	 * Results match those of computeLikelihoodField_Thrun() up to float
+	 * rounding. Several threads may call this method on the same map at
+	 * once (the table is built only once), as long as the map is not being
+	 * modified.
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void computeLikelihoodField_Thrun(
+		const CPointsMap* pm,
+		const std::vector<mrpt::poses::CPose2D>& relativePoses,
+		std::vector<double>& out_log_liks,
+		mrpt::system::CWorkerThreadsPool* threadPool = nullptr);
+
 	/** Saves the gridmap as a graphical file (BMP,PNG,...).
 	 * The format will be derived from the file extension (see
 	 * CImage::saveToFile )
@@ -0,0 +1,90 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/maps/CPointCloudFilterBase.h>
+#include <mrpt/config/CLoadableOptions.h>
+#include <atomic>
+#include <cstdint>
+
+namespace mrpt
+{
+namespace maps
+{
+/** Reduces the size of point clouds by keeping a subset of their points,
+ * either chosen at random or evenly spaced (one out of every `1/keep_ratio`
+ * points). The relative order of the kept points is preserved, and the
+ * number of kept points is exactly `round(keep_ratio*N)` (further limited by
+ * `max_points`, if set). Runs in O(N).
+ *
+ * Each call to filter() uses its own random generator, so one instance can be
+ * shared by several maps (see CPointsMap::TInsertionOptions::insertionFilter)
+ * and run from several threads at once.
+ *
+ * \sa CPointsMap, CPointCloudFilterVoxelGrid
+ * \note [New in MRPT 2.0.0]
+ * \ingroup mrpt_maps_grp
+ */
+class CPointCloudFilterRandomSubsample
+	: public mrpt::maps::CPointCloudFilterBase
+{
+   public:
+	// See base docs
+	void filter(
+		/** [in,out] The input pointcloud, which will be modified upon
+		   return after filtering. */
+		mrpt::maps::CPointsMap* inout_pointcloud,
+		/** [in] The timestamp of the input pointcloud */
+		const mrpt::system::TTimeStamp pc_timestamp,
+		/** [in] If nullptr, the PC is assumed to be given in global
+		   coordinates. Otherwise, it will be transformed from local
+		   coordinates to global using this transformation. */
+		const mrpt::poses::CPose3D& pc_reference_pose,
+		/** [in,out] additional in/out parameters */
+		TExtraFilterParams* params = nullptr) override;
+
+	struct TOptions : public mrpt::config::CLoadableOptions
+	{
+		/** (Default: 0.5) Ratio [0,1] of points to keep. */
+		double keep_ratio{0.5};
+		/** (Default: 0=no limit) Maximum number of points to keep. */
+		size_t max_points{0};
+		/** (Default: false) If true, points are taken evenly spaced instead
+		 * of randomly. */
+		bool uniform{false};
+
+		void loadFromConfigFile(
+			const mrpt::config::CConfigFileBase& source,
+			const std::string& section) override;  // See base docs
+		void saveToConfigFile(
+			mrpt::config::CConfigFileBase& c,
+			const std::string& section) const override;
+	};
+
+	TOptions options;
+
+	/** Sets a random seed, for repeatable results: from then on, the n-th
+	 * call to filter() always picks the same points for the same input.
+	 * By default, each call is seeded from `std::random_device`.
+	 * Must not be called while filter() is running in another thread. */
+	void randomize(uint32_t seed)
+	{
+		m_seed = seed;
+		m_seeded = true;
+		m_calls = 0;
+	}
+
+   private:
+	uint32_t m_seed{0};
+	bool m_seeded{false};
+	/** Number of filter() calls since randomize() */
+	std::atomic<uint32_t> m_calls{0};
+};
+}  // namespace maps
+}  // namespace mrpt
@@ -0,0 +1,83 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/maps/CPointCloudFilterBase.h>
+#include <mrpt/config/CLoadableOptions.h>
+#include <cstdint>
+#include <unordered_map>
+
+namespace mrpt
+{
+namespace maps
+{
+/** Voxel-grid downsampling of point clouds: the space is divided into cubic
+ * voxels of a given size and only one point is kept for each occupied voxel.
+ * The kept point is either the first point that fell into the voxel, or the
+ * first one moved to the centroid of all the voxel points (its other
+ * attributes, e.g. color, are those of the first point).
+ *
+ * Voxels are indexed with a hash table, so the cost is O(N) in the number of
+ * points regardless of the extension of the cloud. The grid is aligned with
+ * the frame in which the points are given; `pc_reference_pose` is ignored.
+ *
+ * filter() keeps no state between calls, so one instance can be shared by
+ * several maps (see CPointsMap::TInsertionOptions::insertionFilter) and run
+ * from several threads at once.
+ *
+ * \sa CPointsMap, CPointCloudFilterRandomSubsample
+ * \note [New in MRPT 2.0.0]
+ * \ingroup mrpt_maps_grp
+ */
+class CPointCloudFilterVoxelGrid : public mrpt::maps::CPointCloudFilterBase
+{
+   public:
+	// See base docs
+	void filter(
+		/** [in,out] The input pointcloud, which will be modified upon
+		   return after filtering. */
+		mrpt::maps::CPointsMap* inout_pointcloud,
+		/** [in] The timestamp of the input pointcloud */
+		const mrpt::system::TTimeStamp pc_timestamp,
+		/** [in] If nullptr, the PC is assumed to be given in global
+		   coordinates. Otherwise, it will be transformed from local
+		   coordinates to global using this transformation. */
+		const mrpt::poses::CPose3D& pc_reference_pose,
+		/** [in,out] additional in/out parameters */
+		TExtraFilterParams* params = nullptr) override;
+
+	struct TOptions : public mrpt::config::CLoadableOptions
+	{
+		/** (Default: 0.10 m) Length of the voxels edges. */
+		double resolution{0.10};
+		/** (Default: true) Keep the centroid of each voxel instead of its
+		 * first point. */
+		bool use_centroid{true};
+
+		void loadFromConfigFile(
+			const mrpt::config::CConfigFileBase& source,
+			const std::string& section) override;  // See base docs
+		void saveToConfigFile(
+			mrpt::config::CConfigFileBase& c,
+			const std::string& section) const override;
+	};
+
+	TOptions options;
+
+   private:
+	struct TVoxel
+	{
+		/** Index of the first point in the voxel */
+		size_t first_idx;
+		size_t count;
+		float sum_x, sum_y, sum_z;
+	};
+};
+}  // namespace maps
+}  // namespace mrpt
@@ -9,6 +9,7 @@
 #pragma once
 
 #include <mrpt/maps/CMetricMap.h>
+#include <mrpt/maps/CPointCloudFilterBase.h>
 #include <mrpt/serialization/CSerializable.h>
 #include <mrpt/config/CLoadableOptions.h>
 #include <mrpt/core/safe_pointers.h>
@@ -244,6 +245,18 @@ class CPointsMap : public CMetricMap,
 		float maxDistForInterpolatePoints;
 		/** Points with x,y,z coordinates set to zero will also be inserted */
 		bool insertInvalidPoints;
+		/** (Default: none) If set, 3D range scans and Velodyne scans are
+		 * first projected into a temporary point cloud in the robot frame,
+		 * which is passed through this filter (e.g. a
+		 * CPointCloudFilterVoxelGrid) before being inserted into the map.
+		 * It is neither serialized nor loaded from config files.
+		 * The filter object is shared, not cloned, when the options or the
+		 * whole map are copied (e.g. RBPF particles), so it may be called
+		 * from several threads at once: it must not keep per-call state.
+		 * CPointCloudFilterVoxelGrid and CPointCloudFilterRandomSubsample
+		 * are safe for this; CPointCloudFilterByDistance is not.
+		 * \note [New in MRPT 2.0.0] */
+		mrpt::maps::CPointCloudFilterBase::Ptr insertionFilter;
 
 		/** Binary dump to stream - for usage in derived classes' serialization
 		 */
@@ -105,7 +105,7 @@ CLogOddsGridMapLUT<COccupancyGridMap2D::cellType>&
   ---------------------------------------------------------------*/
 COccupancyGridMap2D::COccupancyGridMap2D(
 	float min_x, float max_x, float min_y, float max_y, float res)
-	: map(),
+	: m_tiles(),
 	  size_x(0),
 	  size_y(0),
 	  x_min(),
@@ -115,6 +115,11 @@ COccupancyGridMap2D::COccupancyGridMap2D(
 	  resolution(),
 	  precomputedLikelihood(),
 	  precomputedLikelihoodToBeRecomputed(true),
+	  m_LF_table(),
+	  m_LF_table_params(),
+	  m_DT(),
+	  m_DT_max_dist2(0),
+	  m_DT_modified(),
 	  m_basis_map(),
 	  m_voronoi_diagram(),
 	  m_is_empty(true),
@@ -144,7 +149,7 @@ void COccupancyGridMap2D::copyMapContentFrom(const COccupancyGridMap2D& o)
 	y_max = o.y_max;
 	size_x = o.size_x;
 	size_y = o.size_y;
-	map = o.map;
+	m_tiles = o.m_tiles;
 
 	m_basis_map.clear();
 	m_voronoi_diagram.clear();
@@ -196,7 +201,7 @@ void COccupancyGridMap2D::setSize(
 #endif
 
 	// Cells memory:
-	map.resize(size_x * size_y, p2l(default_value));
+	allocTiles(p2l(default_value));
 
 	// Free these buffers also:
 	m_basis_map.clear();
@@ -213,7 +218,6 @@ void COccupancyGridMap2D::resizeGrid(
 {
 	unsigned int extra_x_izq = 0, extra_y_arr = 0, new_size_x = 0,
 				 new_size_y = 0;
-	std::vector<cellType> new_map;
 
 	if (new_x_min > new_x_max)
 	{
@@ -239,6 +243,7 @@ void COccupancyGridMap2D::resizeGrid(
 
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_DT.clear();
 
 	// Add an additional margin:
 	if (additionalMargin)
@@ -288,28 +293,11 @@ void COccupancyGridMap2D::resizeGrid(
 	assert(0 == (new_size_x % 16));
 #endif
 
-	// Reserve new mem block
-	new_map.resize(new_size_x * new_size_y, p2l(new_cells_default_value));
+	// Reserve new mem block, keeping the old one aside:
+	std::vector<std::shared_ptr<tile_t>> old_tiles;
+	old_tiles.swap(m_tiles);
+	const unsigned int old_size_x = size_x, old_size_y = size_y;
 
-	// Copy all the old map rows into the new map:
-	{
-		cellType* dest_ptr = &new_map[extra_x_izq + extra_y_arr * new_size_x];
-		cellType* src_ptr = &map[0];
-		size_t row_size = size_x * sizeof(cellType);
-
-		for (size_t y = 0; y < size_y; y++)
-		{
-#if defined(_DEBUG) || (MRPT_ALWAYS_CHECKS_DEBUG)
-			assert(dest_ptr + row_size - 1 <= &new_map[new_map.size() - 1]);
-			assert(src_ptr + row_size - 1 <= &map[map.size() - 1]);
-#endif
-			memcpy(dest_ptr, src_ptr, row_size);
-			dest_ptr += new_size_x;
-			src_ptr += size_x;
-		}
-	}
-
-	// Move new values into the new map:
 	x_min = new_x_min;
 	x_max = new_x_max;
 	y_min = new_y_min;
@@ -318,14 +306,50 @@ void COccupancyGridMap2D::resizeGrid(
 	size_x = new_size_x;
 	size_y = new_size_y;
 
-	// Free old map, replace by new one:
-	map.swap(new_map);
+	allocTiles(p2l(new_cells_default_value));
+
+	// Copy all the old map rows into the new map:
+	const size_t row_size = old_size_x * sizeof(cellType);
+	for (unsigned int y = 0; y < old_size_y; y++)
+	{
+		const cellType* src_ptr = old_tiles[y >> TILE_ROWS_LOG2]->data() +
+								  (y & (TILE_ROWS - 1)) * old_size_x;
+		memcpy(
+			cellsRowForWriting(y + extra_y_arr) + extra_x_izq, src_ptr,
+			row_size);
+	}
 
 	// Free the other buffers:
 	m_basis_map.clear();
 	m_voronoi_diagram.clear();
 }
 
+void COccupancyGridMap2D::allocTiles(cellType value)
+{
+	// All tiles share one block of memory until they are written to:
+	const size_t nTiles = (size_y + TILE_ROWS - 1) >> TILE_ROWS_LOG2;
+	m_tiles.assign(
+		nTiles, std::make_shared<tile_t>(size_t(TILE_ROWS) * size_x, value));
+}
+
+void COccupancyGridMap2D::getRowsForWriting(
+	int cy0, int cy1, std::vector<cellType*>& rows)
+{
+	rows.assign(size_y, nullptr);
+	cy0 = std::max(cy0, 0);
+	cy1 = std::min(cy1, static_cast<int>(size_y) - 1);
+	for (int cy = cy0; cy <= cy1; cy++) rows[cy] = cellsRowForWriting(cy);
+}
+
+std::vector<COccupancyGridMap2D::cellType> COccupancyGridMap2D::getRawMap()
+	const
+{
+	std::vector<cellType> ret(size_t(size_x) * size_y);
+	for (unsigned int cy = 0; cy < size_y; cy++)
+		std::copy(cellsRow(cy), cellsRow(cy) + size_x, &ret[cy * size_x]);
+	return ret;
+}
+
 /*---------------------------------------------------------------
 						freeMap
   ---------------------------------------------------------------*/
@@ -334,7 +358,7 @@ void COccupancyGridMap2D::freeMap()
 	MRPT_START
 
 	// Free map and sectors
-	map.clear();
+	m_tiles.clear();
 
 	m_basis_map.clear();
 	m_voronoi_diagram.clear();
@@ -343,6 +367,7 @@ void COccupancyGridMap2D::freeMap()
 
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_DT.clear();
 
 	m_is_empty = true;
 
@@ -398,16 +423,19 @@ void COccupancyGridMap2D::computeEntropy(TEntropyInfo& info) const
 
 	info.H = info.I = 0;
 	info.effectiveMappedCells = 0;
-	for (std::vector<cellType>::const_iterator it = map.begin();
-		 it != map.end(); ++it)
+	for (unsigned int cy = 0; cy < size_y; cy++)
 	{
-		cellTypeUnsigned ctu = static_cast<cellTypeUnsigned>(*it);
-		h = entropyTable[ctu];
-		info.H += h;
-		if (h < (MAX_H - 0.001f))
+		const cellType* row = cellsRow(cy);
+		for (unsigned int cx = 0; cx < size_x; cx++)
 		{
-			info.effectiveMappedCells++;
-			info.I -= h;
+			cellTypeUnsigned ctu = static_cast<cellTypeUnsigned>(row[cx]);
+			h = entropyTable[ctu];
+			info.H += h;
+			if (h < (MAX_H - 0.001f))
+			{
+				info.effectiveMappedCells++;
+				info.I -= h;
+			}
 		}
 	}
 
@@ -458,11 +486,10 @@ void COccupancyGridMap2D::internal_clear()
  ---------------------------------------------------------------*/
 void COccupancyGridMap2D::fill(float default_value)
 {
-	cellType defValue = p2l(default_value);
-	for (std::vector<cellType>::iterator it = map.begin(); it < map.end(); ++it)
-		*it = defValue;
+	allocTiles(p2l(default_value));
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_DT.clear();
 	// resetFeaturesCache();
 }
 
@@ -476,19 +503,20 @@ void COccupancyGridMap2D::updateCell(int x, int y, float v)
 		static_cast<unsigned int>(y) >= size_y)
 		return;
 
-	// Get the current contents of the cell:
-	cellType& theCell = map[x + y * size_x];
+	markCellsAsModified(x, x, y, y);
 
 	// Compute the new Bayesian-fused value of the cell:
 	if (updateInfoChangeOnly.enabled)
 	{
-		float old = l2p(theCell);
+		float old = l2p(cellsRow(y)[x]);
 		float new_v = 1 / (1 + (1 - v) * (1 - old) / (old * v));
 		updateInfoChangeOnly.cellsUpdated++;
 		updateInfoChangeOnly.I_change += 1 - (H(new_v) + H(1 - new_v)) / MAX_H;
 	}
 	else
 	{
+		// Get the current contents of the cell:
+		cellType& theCell = cellsRowForWriting(y)[x];
 		cellType obs =
 			p2l(v);  // The observation: will be >0 for free, <0 for occupied.
 		if (obs > 0)
@@ -541,7 +569,10 @@ void COccupancyGridMap2D::subSample(int downRatio)
 	}
 
 	setSize(x_min, x_max, y_min, y_max, resolution);
-	map = newMap;
+	for (int y = 0; y < newSizeY; y++)
+		std::copy(
+			newMap.begin() + y * newSizeX, newMap.begin() + (y + 1) * newSizeX,
+			cellsRowForWriting(y));
 }
 
 /*---------------------------------------------------------------
@@ -667,7 +698,7 @@ void COccupancyGridMap2D::determineMatching2D(
 			for (int cy = cy_min; cy <= cy_max; cy++)
 			{
 				// Is an occupied cell?
-				if (map[cx + cy * size_x] <
+				if (cellsRow(cy)[cx] <
 					thresholdCellValue)  //  getCell(cx,cy)<0.49)
 				{
 					const float residual_x = idx2x(cx) - x_local;
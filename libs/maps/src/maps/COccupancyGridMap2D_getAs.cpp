@@ -34,10 +34,10 @@ void COccupancyGridMap2D::getAsImage(
 		if (!forceRGB)
 		{  // 8bit gray-scale
 			img.resize(size_x, size_y, 1, true);  // verticalFlip);
-			const cellType* srcPtr = &map[0];
 			unsigned char* destPtr;
 			for (unsigned int y = 0; y < size_y; y++)
 			{
+				const cellType* srcPtr = cellsRow(y);
 				if (!verticalFlip)
 					destPtr = img(0, size_y - 1 - y);
 				else
@@ -51,10 +51,10 @@ void COccupancyGridMap2D::getAsImage(
 		else
 		{  // 24bit RGB:
 			img.resize(size_x, size_y, 3, true);  // verticalFlip);
-			const cellType* srcPtr = &map[0];
 			unsigned char* destPtr;
 			for (unsigned int y = 0; y < size_y; y++)
 			{
+				const cellType* srcPtr = cellsRow(y);
 				if (!verticalFlip)
 					destPtr = img(0, size_y - 1 - y);
 				else
@@ -75,10 +75,10 @@ void COccupancyGridMap2D::getAsImage(
 		if (!forceRGB)
 		{  // 8bit gray-scale
 			img.resize(size_x, size_y, 1, true);  // verticalFlip);
-			const cellType* srcPtr = &map[0];
 			unsigned char* destPtr;
 			for (unsigned int y = 0; y < size_y; y++)
 			{
+				const cellType* srcPtr = cellsRow(y);
 				if (!verticalFlip)
 					destPtr = img(0, size_y - 1 - y);
 				else
@@ -99,10 +99,10 @@ void COccupancyGridMap2D::getAsImage(
 		else
 		{  // 24bit RGB:
 			img.resize(size_x, size_y, 3, true);  // verticalFlip);
-			const cellType* srcPtr = &map[0];
 			unsigned char* destPtr;
 			for (unsigned int y = 0; y < size_y; y++)
 			{
+				const cellType* srcPtr = cellsRow(y);
 				if (!verticalFlip)
 					destPtr = img(0, size_y - 1 - y);
 				else
@@ -171,10 +171,9 @@ void COccupancyGridMap2D::getAs3DObject(
 	CImage imgColor(size_x, size_y, 1);
 	CImage imgTrans(size_x, size_y, 1);
 
-	const cellType* srcPtr = &map[0];
-
 	for (unsigned int y = 0; y < size_y; y++)
 	{
+		const cellType* srcPtr = cellsRow(y);
 		unsigned char* destPtr_color = imgColor(0, y);
 		unsigned char* destPtr_trans = imgTrans(0, y);
 		for (unsigned int x = 0; x < size_x; x++)
@@ -150,6 +150,13 @@ bool COccupancyGridMap2D::internal_insertObservation(
 			MRPT_CHECK_NORMAL_NUMBER(px);
 			MRPT_CHECK_NORMAL_NUMBER(py);
 #endif
+			// All updated cells lie within this box (for the distance
+			// transform used in the likelihood field):
+			markCellsAsModified(
+				x2idx(px - maxDistanceInsertion) - 1,
+				x2idx(px + maxDistanceInsertion) + 1,
+				y2idx(py - maxDistanceInsertion) - 1,
+				y2idx(py + maxDistanceInsertion) + 1);
 
 			// Here we go! Now really insert changes in the grid:
 			if (!insertionOptions.wideningBeamsWithDistance)
@@ -248,8 +255,11 @@ bool COccupancyGridMap2D::internal_insertObservation(
 				resizeGrid(new_x_min, new_x_max, new_y_min, new_y_max, 0.5);
 
 				// For updateCell_fast methods:
-				cellType* theMapArray = &map[0];
-				unsigned theMapSize_x = size_x;
+				// Only the rows within reach of the rays are written to:
+				std::vector<cellType*> theMapRows;
+				getRowsForWriting(
+					y2idx(py - maxDistanceInsertion) - 2,
+					y2idx(py + maxDistanceInsertion) + 2, theMapRows);
 
 				int cx0 =
 					x2idx(px);  // Remember: This must be after the resizeGrid!!
@@ -302,8 +312,8 @@ bool COccupancyGridMap2D::internal_insertObservation(
 					for (int nStep = 0; nStep < nStepsRay; nStep++)
 					{
 						updateCell_fast_free(
-							cx, cy, logodd_free, logodd_thres_free, theMapArray,
-							theMapSize_x);
+							&theMapRows[cy][cx], logodd_free,
+							logodd_thres_free);
 
 						frCX += frAcx;
 						frCY += frAcy;
@@ -319,8 +329,8 @@ bool COccupancyGridMap2D::internal_insertObservation(
 					if (o->validRange[idx] &&
 						o->scan[idx] < maxDistanceInsertion)
 						updateCell_fast_occupied(
-							trg_cx, trg_cy, logodd_observation_occupied,
-							logodd_thres_occupied, theMapArray, theMapSize_x);
+							&theMapRows[trg_cy][trg_cx],
+							logodd_observation_occupied, logodd_thres_occupied);
 
 				}  // End of each range
 
@@ -415,8 +425,11 @@ bool COccupancyGridMap2D::internal_insertObservation(
 				resizeGrid(new_x_min, new_x_max, new_y_min, new_y_max, 0.5);
 
 				// For updateCell_fast methods:
-				cellType* theMapArray = &map[0];
-				unsigned theMapSize_x = size_x;
+				// Only the rows within reach of the rays are written to:
+				std::vector<cellType*> theMapRows;
+				getRowsForWriting(
+					y2idx(py - maxDistanceInsertion) - 2,
+					y2idx(py + maxDistanceInsertion) + 2, theMapRows);
 
 				// int  cx0 = x2idx(px);		// Remember: This must be after
 				// the
@@ -524,8 +537,8 @@ bool COccupancyGridMap2D::internal_insertObservation(
 
 						for (int ccx = min_cx; ccx <= max_cx; ccx++)
 							updateCell_fast_free(
-								ccx, P0.cy, logodd_observation_free,
-								logodd_thres_free, theMapArray, theMapSize_x);
+								&theMapRows[P0.cy][ccx],
+								logodd_observation_free, logodd_thres_free);
 					}
 					else
 					{
@@ -608,9 +621,9 @@ bool COccupancyGridMap2D::internal_insertObservation(
 
 								for (int ccx = R1.cx; ccx <= R2.cx; ccx++)
 									updateCell_fast_free(
-										ccx, R1.cy, logodd_observation_free,
-										logodd_thres_free, theMapArray,
-										theMapSize_x);
+										&theMapRows[R1.cy][ccx],
+										logodd_observation_free,
+										logodd_thres_free);
 							}
 
 							R1.frX += frAx_R1;
@@ -694,9 +707,9 @@ bool COccupancyGridMap2D::internal_insertObservation(
 								last_insert_cy = R1.cy;
 								for (int ccx = R1.cx; ccx <= R2.cx; ccx++)
 									updateCell_fast_free(
-										ccx, R1.cy, logodd_observation_free,
-										logodd_thres_free, theMapArray,
-										theMapSize_x);
+										&theMapRows[R1.cy][ccx],
+										logodd_observation_free,
+										logodd_thres_free);
 							}
 
 							R1.frX += frAx_R1;
@@ -746,9 +759,9 @@ bool COccupancyGridMap2D::internal_insertObservation(
 						if (P2.cx == P1.cx && P2.cy == P1.cy)
 						{
 							updateCell_fast_occupied(
-								P1.cx, P1.cy, logodd_observation_occupied,
-								logodd_thres_occupied, theMapArray,
-								theMapSize_x);
+								&theMapRows[P1.cy][P1.cx],
+								logodd_observation_occupied,
+								logodd_thres_occupied);
 						}
 						else
 						{
@@ -775,9 +788,9 @@ bool COccupancyGridMap2D::internal_insertObservation(
 							for (int nStep = 0; nStep <= nSteps; nStep++)
 							{
 								updateCell_fast_occupied(
-									R1.cx, R1.cy, logodd_observation_occupied,
-									logodd_thres_occupied, theMapArray,
-									theMapSize_x);
+									&theMapRows[R1.cy][R1.cx],
+									logodd_observation_occupied,
+									logodd_thres_occupied);
 
 								R1.frX += frAcxE;
 								R1.frY += frAcyE;
@@ -854,6 +867,13 @@ bool COccupancyGridMap2D::internal_insertObservation(
 			MRPT_CHECK_NORMAL_NUMBER(px);
 			MRPT_CHECK_NORMAL_NUMBER(py);
 #endif
+			// All updated cells lie within this box (for the distance
+			// transform used in the likelihood field):
+			markCellsAsModified(
+				x2idx(px - maxDistanceInsertion) - 1,
+				x2idx(px + maxDistanceInsertion) + 1,
+				y2idx(py - maxDistanceInsertion) - 1,
+				y2idx(py + maxDistanceInsertion) + 1);
 			// ---------------------------------
 			//  		Widen rays
 			// Algorithm in: http://www.mrpt.org/Occupancy_Grids
@@ -933,8 +953,11 @@ bool COccupancyGridMap2D::internal_insertObservation(
 			resizeGrid(new_x_min, new_x_max, new_y_min, new_y_max, 0.5);
 
 			// For updateCell_fast methods:
-			cellType* theMapArray = &map[0];
-			unsigned theMapSize_x = size_x;
+			// Only the rows within reach of the rays are written to:
+			std::vector<cellType*> theMapRows;
+			getRowsForWriting(
+				y2idx(py - maxDistanceInsertion) - 2,
+				y2idx(py + maxDistanceInsertion) + 2, theMapRows);
 
 			// int  cx0 = x2idx(px);		// Remember: This must be after the
 			// resizeGrid!!
@@ -1031,8 +1054,8 @@ bool COccupancyGridMap2D::internal_insertObservation(
 
 					for (int ccx = min_cx; ccx <= max_cx; ccx++)
 						updateCell_fast_free(
-							ccx, P0.cy, logodd_observation_free,
-							logodd_thres_free, theMapArray, theMapSize_x);
+							&theMapRows[P0.cy][ccx], logodd_observation_free,
+							logodd_thres_free);
 				}
 				else
 				{
@@ -1114,9 +1137,8 @@ bool COccupancyGridMap2D::internal_insertObservation(
 
 							for (int ccx = R1.cx; ccx <= R2.cx; ccx++)
 								updateCell_fast_free(
-									ccx, R1.cy, logodd_observation_free,
-									logodd_thres_free, theMapArray,
-									theMapSize_x);
+									&theMapRows[R1.cy][ccx],
+									logodd_observation_free, logodd_thres_free);
 						}
 
 						R1.frX += frAx_R1;
@@ -1199,9 +1221,8 @@ bool COccupancyGridMap2D::internal_insertObservation(
 							last_insert_cy = R1.cy;
 							for (int ccx = R1.cx; ccx <= R2.cx; ccx++)
 								updateCell_fast_free(
-									ccx, R1.cy, logodd_observation_free,
-									logodd_thres_free, theMapArray,
-									theMapSize_x);
+									&theMapRows[R1.cy][ccx],
+									logodd_observation_free, logodd_thres_free);
 						}
 
 						R1.frX += frAx_R1;
@@ -1250,8 +1271,8 @@ bool COccupancyGridMap2D::internal_insertObservation(
 					if (P2.cx == P1.cx && P2.cy == P1.cy)
 					{
 						updateCell_fast_occupied(
-							P1.cx, P1.cy, logodd_observation_occupied,
-							logodd_thres_occupied, theMapArray, theMapSize_x);
+							&theMapRows[P1.cy][P1.cx],
+							logodd_observation_occupied, logodd_thres_occupied);
 					}
 					else
 					{
@@ -1278,9 +1299,9 @@ bool COccupancyGridMap2D::internal_insertObservation(
 						for (int nStep = 0; nStep <= nSteps; nStep++)
 						{
 							updateCell_fast_occupied(
-								R1.cx, R1.cy, logodd_observation_occupied,
-								logodd_thres_occupied, theMapArray,
-								theMapSize_x);
+								&theMapRows[R1.cy][R1.cx],
+								logodd_observation_occupied,
+								logodd_thres_occupied);
 
 							R1.frX += frAcxE;
 							R1.frY += frAcyE;
@@ -57,13 +57,16 @@ void COccupancyGridMap2D::serializeTo(mrpt::serialization::CArchive& out) const
 #endif
 
 	out << size_x << size_y << x_min << x_max << y_min << y_max << resolution;
-	ASSERT_(size_x * size_y == map.size());
 
+	// Cells, row by row:
+	for (unsigned int cy = 0; cy < size_y; cy++)
+	{
 #ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
-	out.WriteBuffer(&map[0], sizeof(map[0]) * size_x * size_y);
+		out.WriteBuffer(cellsRow(cy), sizeof(cellType) * size_x);
 #else
-	out.WriteBufferFixEndianness(&map[0], size_x * size_y);
+		out.WriteBufferFixEndianness(cellsRow(cy), size_x);
 #endif
+	}
 
 	// insertionOptions:
 	out << insertionOptions.mapAltitude << insertionOptions.useMapAltitude
@@ -142,15 +145,15 @@ void COccupancyGridMap2D::serializeFrom(
 				new_x_min, new_x_max, new_y_min, new_y_max, new_resolution,
 				0.5);
 
-			ASSERT_(size_x * size_y == map.size());
+			std::vector<cellType> cells(size_t(size_x) * size_y);
 
 			if (bitsPerCellStream == MyBitsPerCell)
 			{
 // Perfect:
 #ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
-				in.ReadBuffer(&map[0], sizeof(map[0]) * map.size());
+				in.ReadBuffer(&cells[0], sizeof(cells[0]) * cells.size());
 #else
-				in.ReadBufferFixEndianness(&map[0], map.size());
+				in.ReadBufferFixEndianness(&cells[0], cells.size());
 #endif
 			}
 			else
@@ -159,21 +162,21 @@ void COccupancyGridMap2D::serializeFrom(
 #ifdef OCCUPANCY_GRIDMAP_CELL_SIZE_8BITS
 				// We are 8-bit, stream is 16-bit
 				ASSERT_(bitsPerCellStream == 16);
-				std::vector<uint16_t> auxMap(map.size());
+				std::vector<uint16_t> auxMap(cells.size());
 				in.ReadBuffer(&auxMap[0], sizeof(auxMap[0]) * auxMap.size());
 
-				size_t i, N = map.size();
-				uint8_t* ptrTrg = (uint8_t*)&map[0];
+				size_t i, N = cells.size();
+				uint8_t* ptrTrg = (uint8_t*)&cells[0];
 				const uint16_t* ptrSrc = (const uint16_t*)&auxMap[0];
 				for (i = 0; i < N; i++) *ptrTrg++ = (*ptrSrc++) >> 8;
 #else
 				// We are 16-bit, stream is 8-bit
 				ASSERT_(bitsPerCellStream == 8);
-				std::vector<uint8_t> auxMap(map.size());
+				std::vector<uint8_t> auxMap(cells.size());
 				in.ReadBuffer(&auxMap[0], sizeof(auxMap[0]) * auxMap.size());
 
-				size_t i, N = map.size();
-				uint16_t* ptrTrg = (uint16_t*)&map[0];
+				size_t i, N = cells.size();
+				uint16_t* ptrTrg = (uint16_t*)&cells[0];
 				const uint8_t* ptrSrc = (const uint8_t*)&auxMap[0];
 				for (i = 0; i < N; i++) *ptrTrg++ = (*ptrSrc++) << 8;
 #endif
@@ -183,8 +186,8 @@ void COccupancyGridMap2D::serializeFrom(
 			// log-odds:
 			if (version < 3)
 			{
-				size_t i, N = map.size();
-				cellType* ptr = &map[0];
+				size_t i, N = cells.size();
+				cellType* ptr = &cells[0];
 				for (i = 0; i < N; i++)
 				{
 					double p = cellTypeUnsigned(*ptr) * (1.0f / 0xFF);
@@ -194,8 +197,14 @@ void COccupancyGridMap2D::serializeFrom(
 				}
 			}
 
+			for (unsigned int cy = 0; cy < size_y; cy++)
+				std::copy(
+					cells.begin() + cy * size_x,
+					cells.begin() + (cy + 1) * size_x, cellsRowForWriting(cy));
+
 			// For the precomputed likelihood trick:
 			precomputedLikelihoodToBeRecomputed = true;
+			m_DT.clear();
 
 			if (version >= 1)
 			{
@@ -294,6 +303,7 @@ bool COccupancyGridMap2D::loadFromBitmap(
 
 	// For the precomputed likelihood trick:
 	precomputedLikelihoodToBeRecomputed = true;
+	m_DT.clear();
 
 	size_t bmpWidth = imgFl.getWidth();
 	size_t bmpHeight = imgFl.getHeight();
@@ -14,6 +14,12 @@
 #include <mrpt/obs/CObservationRange.h>
 #include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <limits>
+
+#if MRPT_HAS_AVX2
+#include <immintrin.h>
+#endif
 
 using namespace mrpt;
 using namespace mrpt::math;
@@ -540,6 +546,17 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 		return -100;  // No way to estimate this likelihood!!
 	}
 
+	if (likelihoodOptions.LF_useDistanceTransform)
+	{
+		// O(1) lookups in the table built from the distance transform:
+		std::vector<double> logLiks;
+		computeLikelihoodField_Thrun(
+			pm, std::vector<CPose2D>(
+					1, relativePose ? *relativePose : CPose2D()),
+			logLiks);
+		return logLiks[0];
+	}
+
 	// Compute the likelihoods for each point:
 	ret = 0;
 
@@ -565,14 +582,14 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 
 	if (likelihoodOptions.enableLikelihoodCache)
 	{
-		// Reset the precomputed likelihood values map
-		if (precomputedLikelihoodToBeRecomputed)
+		// Reset the precomputed likelihood values map (once, even if
+		// called from several threads):
+		std::lock_guard<std::mutex> lck(precomputedLikelihood.cs);
+		const size_t nCells = m_tiles.empty() ? 0 : size_t(size_x) * size_y;
+		if (precomputedLikelihoodToBeRecomputed ||
+			precomputedLikelihood.size() != nCells)
 		{
-			if (!map.empty())
-				precomputedLikelihood.assign(map.size(), LIK_LF_CACHE_INVALID);
-			else
-				precomputedLikelihood.clear();
-
+			precomputedLikelihood.assign(nCells, LIK_LF_CACHE_INVALID);
 			precomputedLikelihoodToBeRecomputed = false;
 		}
 	}
@@ -632,7 +649,8 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 			// We are into the map limits:
 			if (likelihoodOptions.enableLikelihoodCache)
 			{
-				thisLik = precomputedLikelihood[cx + cy * size_x];
+				thisLik = precomputedLikelihood[cx + cy * size_x].load(
+					std::memory_order_relaxed);
 			}
 
 			if (!likelihoodOptions.enableLikelihoodCache ||
@@ -649,10 +667,6 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 
 				// Optimized code: this part will be invoked a *lot* of times:
 				{
-					cellType* mapPtr =
-						&map[xx1 + yy1 * size_x];  // Initial pointer position
-					unsigned incrAfterRow = size_x - ((xx2 - xx1) + 1);
-
 					signed int Ax0 = 10 * (xx1 - cx);
 					signed int Ay = 10 * (yy1 - cy);
 
@@ -666,6 +680,7 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 						// with unsigned.
 						signed short Ax = Ax0;
 						cellType cell;
+						const cellType* mapPtr = cellsRow(yy) + xx1;
 
 						for (int xx = xx1; xx <= xx2; xx++)
 						{
@@ -677,8 +692,6 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 							}
 							Ax += 10;
 						}
-						// Go to (xx1,yy++)
-						mapPtr += incrAfterRow;
 						Ay += 10;
 					}
 
@@ -692,8 +705,10 @@ double COccupancyGridMap2D::computeLikelihoodField_Thrun(
 				thisLik = zRandomTerm + zHit * exp(Q * occupiedMinDist);
 
 				if (likelihoodOptions.enableLikelihoodCache)
-					// And save it into the table and into "thisLik":
-					precomputedLikelihood[cx + cy * size_x] = thisLik;
+					// And save it into the table and into "thisLik".
+					// Concurrent writers store the same value:
+					precomputedLikelihood[cx + cy * size_x].store(
+						thisLik, std::memory_order_relaxed);
 			}
 		}
 
@@ -816,6 +831,358 @@ double COccupancyGridMap2D::computeLikelihoodField_II(
 	MRPT_END
 }
 
+namespace
+{
+/** Value for "no obstacle" samples in edt_1d() (must be finite) */
+const double EDT_EMPTY = 1e20;
+
+/** 1D squared Euclidean distance transform of the sampled function `f`
+ * (Felzenszwalb & Huttenlocher, 2012). `v` and `z` are work buffers of length
+ * n and n+1, respectively. */
+void edt_1d(const double* f, const int n, double* d, int* v, double* z)
+{
+	const double INF = std::numeric_limits<double>::infinity();
+	int k = 0;
+	v[0] = 0;
+	z[0] = -INF;
+	z[1] = INF;
+	// Abscissa of the intersection of the parabolas rooted at q and p:
+	auto intersect = [f](const int q, const int p) {
+		return ((f[q] + q * q) - (f[p] + p * p)) / (2 * q - 2 * p);
+	};
+	for (int q = 1; q < n; q++)
+	{
+		double s = intersect(q, v[k]);
+		while (s <= z[k])
+		{
+			k--;
+			s = intersect(q, v[k]);
+		}
+		k++;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = INF;
+	}
+	k = 0;
+	for (int q = 0; q < n; q++)
+	{
+		while (z[k + 1] < q) k++;
+		d[q] = square(q - v[k]) + f[v[k]];
+	}
+}
+
+/** Runs body(i0,i1) over [0,N), in parallel if a pool is given. */
+void run_parallel(
+	mrpt::system::CWorkerThreadsPool* pool, const size_t N,
+	const std::function<void(size_t, size_t)>& body,
+	const size_t min_chunk_size)
+{
+	if (pool)
+		pool->parallel_for(N, body, min_chunk_size);
+	else
+		body(0, N);
+}
+}  // namespace
+
+/*---------------------------------------------------------------
+					updateDistanceTransform
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::updateDistanceTransform(
+	mrpt::system::CWorkerThreadsPool* threadPool, TCellRect& changed)
+{
+	MRPT_START
+
+	// Distances are saturated beyond the max. correspondence distance, so a
+	// modified cell can only affect cells closer than this radius:
+	const int R =
+		static_cast<int>(
+			ceil(likelihoodOptions.LF_maxCorrsDistance / resolution)) +
+		1;
+	const uint32_t max_dist2 = static_cast<uint32_t>(R * R);
+	const int sx = static_cast<int>(size_x), sy = static_cast<int>(size_y);
+	const size_t nCells = static_cast<size_t>(sx) * sy;
+
+	// "region": the cells to update. "window": the cells whose occupancy
+	// matters to update them.
+	TCellRect region, window;
+	if (m_DT.size() != nCells || m_DT_max_dist2 != max_dist2)
+	{
+		m_DT.assign(nCells, max_dist2);
+		m_DT_max_dist2 = max_dist2;
+		if (!nCells) return;
+		region.x_min = region.y_min = 0;
+		region.x_max = sx - 1;
+		region.y_max = sy - 1;
+		window = region;
+	}
+	else
+	{
+		if (m_DT_modified.empty()) return;  // Up to date.
+		const TCellRect& m = m_DT_modified;
+		region.x_min = std::max(0, m.x_min - R);
+		region.x_max = std::min(sx - 1, m.x_max + R);
+		region.y_min = std::max(0, m.y_min - R);
+		region.y_max = std::min(sy - 1, m.y_max + R);
+		window.x_min = std::max(0, region.x_min - R);
+		window.x_max = std::min(sx - 1, region.x_max + R);
+		window.y_min = std::max(0, region.y_min - R);
+		window.y_max = std::min(sy - 1, region.y_max + R);
+	}
+	m_DT_modified = TCellRect();
+	changed = region;
+
+	const cellType thresholdCellValue = p2l(0.5f);
+	const int wx = window.x_max - window.x_min + 1;
+	const int wy = window.y_max - window.y_min + 1;
+	const int rx = region.x_max - region.x_min + 1;
+	const int ry = region.y_max - region.y_min + 1;
+
+	// 1st pass: along the columns of the window. Only the rows within the
+	// region are needed afterwards:
+	std::vector<double> dist2(static_cast<size_t>(wx) * ry);
+	run_parallel(
+		threadPool, wx,
+		[&](size_t i0, size_t i1) {
+			std::vector<double> f(wy), d(wy), z(wy + 1);
+			std::vector<int> v(wy);
+			for (size_t i = i0; i < i1; i++)
+			{
+				const int cx = window.x_min + static_cast<int>(i);
+				for (int j = 0; j < wy; j++)
+					f[j] = cellsRow(window.y_min + j)[cx] < thresholdCellValue
+							   ? 0
+							   : EDT_EMPTY;
+				edt_1d(&f[0], wy, &d[0], &v[0], &z[0]);
+				for (int j = 0; j < ry; j++)
+					dist2[i + j * wx] = d[region.y_min - window.y_min + j];
+			}
+		},
+		16);
+	// 2nd pass: along the rows:
+	run_parallel(
+		threadPool, ry,
+		[&](size_t j0, size_t j1) {
+			std::vector<double> d(wx), z(wx + 1);
+			std::vector<int> v(wx);
+			for (size_t j = j0; j < j1; j++)
+			{
+				edt_1d(&dist2[j * wx], wx, &d[0], &v[0], &z[0]);
+				uint32_t* out =
+					&m_DT[region.x_min + (region.y_min + j) * sx];
+				const double* in = &d[region.x_min - window.x_min];
+				for (int i = 0; i < rx; i++)
+					out[i] = static_cast<uint32_t>(
+						std::min<double>(max_dist2, in[i]));
+			}
+		},
+		16);
+
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+					buildLikelihoodFieldTable
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::buildLikelihoodFieldTable(
+	mrpt::system::CWorkerThreadsPool* threadPool)
+{
+	MRPT_START
+
+	const bool Product_T_OrSum_F = !likelihoodOptions.LF_alternateAverageMethod;
+	const std::array<double, 7> params = {
+		{likelihoodOptions.LF_stdHit, likelihoodOptions.LF_zHit,
+		 likelihoodOptions.LF_zRandom, likelihoodOptions.LF_maxRange,
+		 likelihoodOptions.LF_maxCorrsDistance,
+		 likelihoodOptions.LF_useSquareDist ? 1.0 : 0.0,
+		 Product_T_OrSum_F ? 1.0 : 0.0}};
+
+	// Built once, even if requested from several threads: the others wait
+	// here until the table is up to date.
+	std::lock_guard<std::mutex> lck(m_LF_table_cs.cs);
+
+	TCellRect changed;
+	updateDistanceTransform(threadPool, changed);
+
+	const size_t nCells = static_cast<size_t>(size_x) * size_y;
+	if (m_LF_table.size() != nCells || m_LF_table_params != params)
+	{
+		m_LF_table_params = params;
+		m_LF_table.resize(nCells);
+		changed.x_min = changed.y_min = 0;
+		changed.x_max = static_cast<int>(size_x) - 1;
+		changed.y_max = static_cast<int>(size_y) - 1;
+	}
+	if (changed.empty()) return;  // Up to date.
+
+	// Same terms than in computeLikelihoodField_Thrun(), so results match:
+	const float stdHit = likelihoodOptions.LF_stdHit;
+	const float zHit = likelihoodOptions.LF_zHit;
+	const float zRandom = likelihoodOptions.LF_zRandom;
+	const float zRandomMaxRange = likelihoodOptions.LF_maxRange;
+	const float zRandomTerm = zRandom / zRandomMaxRange;
+	const float Q = -0.5f / square(stdHit);
+	const double maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
+	const double constDist2DiscrUnits = 100 / (resolution * resolution);
+	const double constDist2DiscrUnits_INV = 1.0 / constDist2DiscrUnits;
+	const double maxDistInt =
+		mrpt::round(maxCorrDist_sq * constDist2DiscrUnits);
+
+	run_parallel(
+		threadPool, changed.y_max - changed.y_min + 1,
+		[&](size_t j0, size_t j1) {
+			for (size_t j = j0; j < j1; j++)
+			{
+				const size_t row = (changed.y_min + j) * size_x;
+				for (int cx = changed.x_min; cx <= changed.x_max; cx++)
+				{
+					const unsigned int occupiedMinDistInt =
+						static_cast<unsigned int>(
+							std::min(maxDistInt, 100.0 * m_DT[row + cx]));
+					float occupiedMinDist =
+						occupiedMinDistInt * constDist2DiscrUnits_INV;
+					if (likelihoodOptions.LF_useSquareDist)
+						occupiedMinDist *= occupiedMinDist;
+					const double thisLik =
+						zRandomTerm + zHit * exp(Q * occupiedMinDist);
+					m_LF_table[row + cx] =
+						Product_T_OrSum_F ? log(thisLik) : thisLik;
+				}
+			}
+		},
+		16);
+
+	MRPT_END
+}
+
+/*---------------------------------------------------------------
+			computeLikelihoodField_Thrun (batch of poses)
+ ---------------------------------------------------------------*/
+void COccupancyGridMap2D::computeLikelihoodField_Thrun(
+	const CPointsMap* pm, const std::vector<CPose2D>& relativePoses,
+	std::vector<double>& out_log_liks,
+	mrpt::system::CWorkerThreadsPool* threadPool)
+{
+	MRPT_START
+
+	ASSERT_(pm != nullptr);
+	const size_t nPoses = relativePoses.size();
+	out_log_liks.resize(nPoses);
+	const size_t N = pm->size();
+	if (!N)
+	{
+		// No way to estimate this likelihood!!
+		std::fill(out_log_liks.begin(), out_log_liks.end(), -100.0);
+		return;
+	}
+
+	buildLikelihoodFieldTable(threadPool);
+
+	const bool Product_T_OrSum_F = !likelihoodOptions.LF_alternateAverageMethod;
+	const float zHit = likelihoodOptions.LF_zHit;
+	const float zRandomTerm =
+		likelihoodOptions.LF_zRandom / likelihoodOptions.LF_maxRange;
+	const float Q = -0.5f / square(likelihoodOptions.LF_stdHit);
+	const double maxCorrDist_sq = square(likelihoodOptions.LF_maxCorrsDistance);
+	const double minimumLik = zRandomTerm + zHit * exp(Q * maxCorrDist_sq);
+	const double outsideTerm = Product_T_OrSum_F ? log(minimumLik) : minimumLik;
+
+	// Decimated copy of the points, shared by all poses:
+	const size_t decimation = N < 10 ? 1 : likelihoodOptions.LF_decimation;
+	const auto& pxs = pm->getPointsBufferRef_x();
+	const auto& pys = pm->getPointsBufferRef_y();
+	std::vector<double> lxs, lys;
+	lxs.reserve(N / decimation + 1);
+	lys.reserve(N / decimation + 1);
+	for (size_t j = 0; j < N; j += decimation)
+	{
+		lxs.push_back(pxs[j]);
+		lys.push_back(pys[j]);
+	}
+	const size_t M = lxs.size();
+
+	const unsigned int size_x_1 = size_x - 1;
+	const unsigned int size_y_1 = size_y - 1;
+	const double xmin = x_min, ymin = y_min, res = resolution;
+	const float* table = m_LF_table.data();
+
+	auto evalPoses = [&](size_t p0, size_t p1) {
+		for (size_t p = p0; p < p1; p++)
+		{
+			const CPose2D& pose = relativePoses[p];
+			const double ccos = cos(pose.phi()), ssin = sin(pose.phi());
+			const double px = pose.x(), py = pose.y();
+			double ret = 0;
+			size_t j = 0;
+#if MRPT_HAS_AVX2
+			{
+				const __m256d vpx = _mm256_set1_pd(px),
+							  vpy = _mm256_set1_pd(py);
+				const __m256d vc = _mm256_set1_pd(ccos),
+							  vs = _mm256_set1_pd(ssin);
+				const __m256d vxmin = _mm256_set1_pd(xmin),
+							  vymin = _mm256_set1_pd(ymin),
+							  vres = _mm256_set1_pd(res);
+				// Unsigned comparisons via signed ones with flipped sign bit:
+				const __m128i vsign = _mm_set1_epi32(0x80000000);
+				const __m128i vlimx =
+					_mm_set1_epi32(static_cast<int>(size_x_1 ^ 0x80000000));
+				const __m128i vlimy =
+					_mm_set1_epi32(static_cast<int>(size_y_1 ^ 0x80000000));
+				const __m128i vsx = _mm_set1_epi32(static_cast<int>(size_x));
+				const __m128 vout =
+					_mm_set1_ps(static_cast<float>(outsideTerm));
+				__m256d acc = _mm256_setzero_pd();
+				for (; j + 4 <= M; j += 4)
+				{
+					const __m256d lx = _mm256_loadu_pd(&lxs[j]);
+					const __m256d ly = _mm256_loadu_pd(&lys[j]);
+					const __m256d gx = _mm256_sub_pd(
+						_mm256_add_pd(vpx, _mm256_mul_pd(lx, vc)),
+						_mm256_mul_pd(ly, vs));
+					const __m256d gy = _mm256_add_pd(
+						_mm256_add_pd(vpy, _mm256_mul_pd(lx, vs)),
+						_mm256_mul_pd(ly, vc));
+					const __m128i cx = _mm256_cvttpd_epi32(
+						_mm256_div_pd(_mm256_sub_pd(gx, vxmin), vres));
+					const __m128i cy = _mm256_cvttpd_epi32(
+						_mm256_div_pd(_mm256_sub_pd(gy, vymin), vres));
+					const __m128i inside = _mm_and_si128(
+						_mm_cmpgt_epi32(vlimx, _mm_xor_si128(cx, vsign)),
+						_mm_cmpgt_epi32(vlimy, _mm_xor_si128(cy, vsign)));
+					const __m128i idx =
+						_mm_add_epi32(cx, _mm_mullo_epi32(cy, vsx));
+					const __m128 terms = _mm_mask_i32gather_ps(
+						vout, table, idx, _mm_castsi128_ps(inside), 4);
+					acc = _mm256_add_pd(acc, _mm256_cvtps_pd(terms));
+				}
+				alignas(32) double accs[4];
+				_mm256_store_pd(accs, acc);
+				ret = (accs[0] + accs[1]) + (accs[2] + accs[3]);
+			}
+#endif
+			// Scalar code (and remainder of the SIMD loop):
+			for (; j < M; j++)
+			{
+				const double gx = px + lxs[j] * ccos - lys[j] * ssin;
+				const double gy = py + lxs[j] * ssin + lys[j] * ccos;
+				const int cx = static_cast<int>((gx - xmin) / res);
+				const int cy = static_cast<int>((gy - ymin) / res);
+				if (static_cast<unsigned>(cx) >= size_x_1 ||
+					static_cast<unsigned>(cy) >= size_y_1)
+					ret += outsideTerm;
+				else
+					ret += table[cx + cy * size_x];
+			}
+			if (!Product_T_OrSum_F) ret = log(ret / M);
+			out_log_liks[p] = ret;
+		}
+	};
+
+	run_parallel(threadPool, nPoses, evalPoses, 8);
+
+	MRPT_END
+}
+
 /*---------------------------------------------------------------
 	Initilization of values, don't needed to be called directly.
   ---------------------------------------------------------------*/
@@ -843,7 +1210,8 @@ COccupancyGridMap2D::TLikelihoodOptions::TLikelihoodOptions()
 	  consensus_pow(5),
 	  OWA_weights(100, 1 / 100.0f),
 
-	  enableLikelihoodCache(true)
+	  enableLikelihoodCache(true),
+	  LF_useDistanceTransform(false)
 {
 }
 
@@ -870,6 +1238,8 @@ void COccupancyGridMap2D::TLikelihoodOptions::loadFromConfigFile(
 		iniFile.read_bool(section, "LF_useSquareDist", LF_useSquareDist);
 	LF_alternateAverageMethod = iniFile.read_bool(
 		section, "LF_alternateAverageMethod", LF_alternateAverageMethod);
+	LF_useDistanceTransform = iniFile.read_bool(
+		section, "LF_useDistanceTransform", LF_useDistanceTransform);
 
 	MI_exponent = iniFile.read_float(section, "MI_exponent", MI_exponent);
 	MI_skip_rays = iniFile.read_int(section, "MI_skip_rays", MI_skip_rays);
@@ -950,6 +1320,9 @@ void COccupancyGridMap2D::TLikelihoodOptions::dumpToTextStream(
 	out << mrpt::format(
 		"LF_alternateAverageMethod               = %c\n",
 		LF_alternateAverageMethod ? 'Y' : 'N');
+	out << mrpt::format(
+		"LF_useDistanceTransform                 = %c\n",
+		LF_useDistanceTransform ? 'Y' : 'N');
 	out << mrpt::format(
 		"MI_exponent                             = %f\n", MI_exponent);
 	out << mrpt::format(
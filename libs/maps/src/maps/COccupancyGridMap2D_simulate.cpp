@@ -152,7 +152,7 @@ void COccupancyGridMap2D::simulateScanRay(
 
 	while ((x = int_x2idx(rxi)) >= 0 && (y = int_y2idx(ryi)) >= 0 &&
 		   x < static_cast<int>(size_x) && y < static_cast<int>(size_y) &&
-		   (hitCellOcc_int = map[x + y * size_x]) > threshold_free_int &&
+		   (hitCellOcc_int = cellsRow(y)[x]) > threshold_free_int &&
 		   ray_len < max_ray_len)
 	{
 		rxi += Arxi;
@@ -7,9 +7,16 @@
    | Released under BSD License. See details in http://www.mrpt.org/License |
    +------------------------------------------------------------------------+ */
 
+#include <mrpt/io/CMemoryStream.h>
 #include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/maps/CSimplePointsMap.h>
 #include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/poses/CPose2D.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
 
 using namespace mrpt;
 using namespace mrpt::maps;
@@ -104,3 +111,232 @@ TEST(COccupancyGridMap2DTests, insert2DScan)
 		// should have a high "freeness"
 	}
 }
+
+TEST(COccupancyGridMap2DTests, likelihoodFieldBatch)
+{
+	// A squared room, 10x10 m, with a pillar in the middle:
+	COccupancyGridMap2D grid(-8.0f, 8.0f, -8.0f, 8.0f, 0.05f);
+	CSimplePointsMap pts;
+	for (float t = -5.0f; t <= 5.0f; t += 0.02f)
+	{
+		for (const auto& p : {TPoint2D(t, -5), TPoint2D(t, 5), TPoint2D(-5, t),
+							  TPoint2D(5, t)})
+		{
+			grid.setPos(p.x, p.y, 0.0f);
+			pts.insertPoint(p.x, p.y);
+		}
+	}
+	for (float t = -0.5f; t <= 0.5f; t += 0.02f)
+	{
+		grid.setPos(t, 0.5f, 0.0f);
+		pts.insertPoint(t, 0.5f);
+	}
+
+	std::vector<CPose2D> poses;
+	for (int ix = -3; ix <= 3; ix++)
+		for (int iphi = -2; iphi <= 2; iphi++)
+			poses.emplace_back(0.1 * ix, -0.05 * ix, 0.05 * iphi);
+	poses.emplace_back(20.0, 0, 0);  // All points out of the map
+
+	mrpt::system::CWorkerThreadsPool pool(2);
+	for (bool altAverage : {false, true})
+	{
+		for (bool useCache : {false, true})
+		{
+			grid.likelihoodOptions.LF_alternateAverageMethod = altAverage;
+			grid.likelihoodOptions.enableLikelihoodCache = useCache;
+
+			std::vector<double> batch_liks, batch_liks_mt;
+			grid.computeLikelihoodField_Thrun(&pts, poses, batch_liks);
+			grid.computeLikelihoodField_Thrun(
+				&pts, poses, batch_liks_mt, &pool);
+			ASSERT_EQ(batch_liks.size(), poses.size());
+			ASSERT_EQ(batch_liks_mt.size(), poses.size());
+
+			for (size_t i = 0; i < poses.size(); i++)
+			{
+				const double lik =
+					grid.computeLikelihoodField_Thrun(&pts, &poses[i]);
+				EXPECT_NEAR(lik, batch_liks[i], 1e-4 * std::abs(lik) + 1e-6)
+					<< "pose=" << poses[i];
+				EXPECT_EQ(batch_liks[i], batch_liks_mt[i]);
+			}
+			// The best pose is the ground truth one:
+			EXPECT_EQ(
+				std::max_element(batch_liks.begin(), batch_liks.end()) -
+					batch_liks.begin(),
+				3 * 5 + 2);
+		}
+	}
+}
+
+TEST(COccupancyGridMap2DTests, likelihoodFieldIncrementalUpdate)
+{
+	COccupancyGridMap2D grid(-8.0f, 8.0f, -8.0f, 8.0f, 0.05f);
+	CSimplePointsMap pts;
+	for (float t = -5.0f; t <= 5.0f; t += 0.02f)
+	{
+		for (const auto& p : {TPoint2D(t, -5), TPoint2D(t, 5), TPoint2D(-5, t),
+							  TPoint2D(5, t)})
+		{
+			grid.setPos(p.x, p.y, 0.0f);
+			pts.insertPoint(p.x, p.y);
+		}
+	}
+	grid.likelihoodOptions.LF_useDistanceTransform = true;
+
+	std::vector<CPose2D> poses;
+	for (int i = -5; i <= 5; i++) poses.emplace_back(0.1 * i, 0.2 * i, 0.1 * i);
+
+	// Builds the whole distance transform:
+	std::vector<double> liks;
+	grid.computeLikelihoodField_Thrun(&pts, poses, liks);
+
+	// Modify the map in all possible ways:
+	grid.setPos(5.0f, 0.0f, 0.9f);  // Remove one wall cell
+	grid.setCell(10, 20, 0.0f);  // Add an obstacle
+	for (int k = 0; k < 10; k++) grid.updateCell(200, 150, 0.1f);
+
+	CObservation2DRangeScan scan;
+	scan.aperture = M_PIf;
+	const std::vector<float> ranges(181, 3.0f);
+	const std::vector<char> valid(181, 1);
+	scan.loadFromVectors(ranges.size(), &ranges[0], &valid[0]);
+	const CPose3D scanPose(1.0, 1.0, 0, 0.3, 0, 0);
+	grid.insertionOptions.maxDistanceInsertion = 4.0f;
+	grid.insertObservation(&scan, &scanPose);
+
+	// The incrementally updated field must be identical to a new one:
+	COccupancyGridMap2D fresh;
+	fresh.copyMapContentFrom(grid);
+	fresh.likelihoodOptions = grid.likelihoodOptions;
+
+	std::vector<double> liks_incr, liks_fresh;
+	grid.computeLikelihoodField_Thrun(&pts, poses, liks_incr);
+	fresh.computeLikelihoodField_Thrun(&pts, poses, liks_fresh);
+	ASSERT_EQ(liks_incr.size(), poses.size());
+	for (size_t i = 0; i < poses.size(); i++)
+	{
+		EXPECT_EQ(liks_incr[i], liks_fresh[i]) << "pose=" << poses[i];
+		// The per-pose method uses the same table:
+		EXPECT_EQ(
+			liks_incr[i], grid.computeLikelihoodField_Thrun(&pts, &poses[i]));
+	}
+
+	// And it matches the reference method, too:
+	fresh.likelihoodOptions.LF_useDistanceTransform = false;
+	for (size_t i = 0; i < poses.size(); i++)
+	{
+		const double lik = fresh.computeLikelihoodField_Thrun(&pts, &poses[i]);
+		EXPECT_NEAR(lik, liks_incr[i], 1e-4 * std::abs(lik) + 1e-6);
+	}
+
+	// Probe every cell, too:
+	CSimplePointsMap probe;
+	for (float x = -7.9f; x < 7.9f; x += 0.05f)
+		for (float y = -7.9f; y < 7.9f; y += 0.05f) probe.insertPoint(x, y);
+	fresh.likelihoodOptions.LF_useDistanceTransform = true;
+	fresh.likelihoodOptions.LF_decimation = 1;
+	grid.likelihoodOptions.LF_decimation = 1;
+	EXPECT_EQ(
+		grid.computeLikelihoodField_Thrun(&probe),
+		fresh.computeLikelihoodField_Thrun(&probe));
+}
+
+TEST(COccupancyGridMap2DTests, likelihoodFieldConcurrentQueries)
+{
+	COccupancyGridMap2D grid(-8.0f, 8.0f, -8.0f, 8.0f, 0.05f);
+	CSimplePointsMap pts;
+	for (float t = -5.0f; t <= 5.0f; t += 0.02f)
+	{
+		for (const auto& p : {TPoint2D(t, -5), TPoint2D(t, 5), TPoint2D(-5, t),
+							  TPoint2D(5, t)})
+		{
+			grid.setPos(p.x, p.y, 0.0f);
+			pts.insertPoint(p.x, p.y);
+		}
+	}
+	grid.likelihoodOptions.LF_useDistanceTransform = true;
+
+	std::vector<CPose2D> poses;
+	for (int i = -5; i <= 5; i++) poses.emplace_back(0.1 * i, 0.2 * i, 0.1 * i);
+
+	// Reference values, from a copy evaluated in this thread:
+	COccupancyGridMap2D ref;
+	ref.copyMapContentFrom(grid);
+	ref.likelihoodOptions = grid.likelihoodOptions;
+	std::vector<double> ref_liks;
+	ref.computeLikelihoodField_Thrun(&pts, poses, ref_liks);
+
+	// All threads start at once, with the table still to be built:
+	const size_t nThreads = 4;
+	std::vector<std::vector<double>> liks(
+		nThreads, std::vector<double>(poses.size()));
+	std::atomic<bool> go{false};
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < nThreads; t++)
+		threads.emplace_back([&, t]() {
+			while (!go) std::this_thread::yield();
+			for (size_t i = 0; i < poses.size(); i++)
+				liks[t][i] = grid.computeLikelihoodField_Thrun(&pts, &poses[i]);
+		});
+	go = true;
+	for (auto& th : threads) th.join();
+
+	for (size_t t = 0; t < nThreads; t++)
+		for (size_t i = 0; i < poses.size(); i++)
+			EXPECT_EQ(liks[t][i], ref_liks[i]) << "pose=" << poses[i];
+}
+
+TEST(COccupancyGridMap2DTests, copyOnWriteTiles)
+{
+	COccupancyGridMap2D grid(-10.0f, 10.0f, -10.0f, 10.0f, 0.05f);
+	for (int i = 0; i < 200; i++) grid.setCell(i, 3 * i, 0.1f + 0.004f * i);
+
+	// Modifying a copy must not alter the original:
+	COccupancyGridMap2D copy = grid;
+	copy.setCell(10, 30, 0.9f);
+	copy.updateCell(150, 380, 0.8f);
+	EXPECT_NEAR(grid.getCell(10, 30), 0.1f + 0.004f * 10, 0.02f);
+	EXPECT_NEAR(grid.getCell(150, 380), 0.5f, 0.02f);
+	EXPECT_NEAR(copy.getCell(10, 30), 0.9f, 0.02f);
+	EXPECT_GT(copy.getCell(150, 380), 0.6f);
+	for (int i = 0; i < 200; i++)
+	{
+		if (i != 10)
+		{
+			EXPECT_EQ(grid.getCell(i, 3 * i), copy.getCell(i, 3 * i));
+		}
+	}
+
+	// Nor inserting an observation into it:
+	CObservation2DRangeScan scan;
+	scan.aperture = M_PIf;
+	scan.resizeScanAndAssign(181, 5.0f, true);
+	COccupancyGridMap2D copy2 = grid;
+	copy2.insertObservation(&scan);
+	EXPECT_GT(copy2.getCell(copy2.x2idx(1.0), copy2.y2idx(0.0)), 0.5f);
+	EXPECT_NEAR(grid.getCell(grid.x2idx(1.0), grid.y2idx(0.0)), 0.5f, 0.02f);
+
+	// Raw cells survive serialization and resizing:
+	const auto raw = grid.getRawMap();
+	{
+		mrpt::io::CMemoryStream buf;
+		auto arch = mrpt::serialization::archiveFrom(buf);
+		arch << grid;
+		buf.Seek(0);
+		COccupancyGridMap2D loaded;
+		arch >> loaded;
+		EXPECT_EQ(raw, loaded.getRawMap());
+	}
+	COccupancyGridMap2D bigger = grid;
+	bigger.resizeGrid(-15.0f, 12.0f, -13.0f, 11.0f, 0.5f, false);
+	for (int i = 0; i < 200; i++)
+	{
+		const double x = grid.idx2x(i), y = grid.idx2y(3 * i);
+		EXPECT_EQ(
+			grid.getCell(i, 3 * i),
+			bigger.getCell(bigger.x2idx(x), bigger.y2idx(y)));
+	}
+	EXPECT_EQ(raw, grid.getRawMap());
+}
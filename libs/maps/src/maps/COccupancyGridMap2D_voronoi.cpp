@@ -263,7 +263,7 @@ int COccupancyGridMap2D::computeClearance(
 		static_cast<unsigned>(cy) >= size_y)
 		return 0;
 
-	if (map[cx + cy * size_y] < thresholdCellValue) return 0;
+	if (cellsRow(cy)[cx] < thresholdCellValue) return 0;
 
 	// Truco para acelerar MUCHO:
 	//  Si miramos un punto junto al mirado antes,
@@ -349,7 +349,7 @@ int COccupancyGridMap2D::computeClearance(
 				yy < static_cast<int>(size_y))
 			{
 				// if ( getCell(xx,yy)<=voroni_free_threshold )
-				if (map[xx + yy * size_y] < thresholdCellValue)
+				if (cellsRow(yy)[xx] < thresholdCellValue)
 				{
 					if (!dentro_obs)
 					{
@@ -587,7 +587,7 @@ float COccupancyGridMap2D::computeClearance(
 
 	for (xx = xx1; xx <= xx2; xx++)
 		for (yy = yy1; yy <= yy2; yy++)
-			if (map[xx + yy * size_x] < thresholdCellValue)
+			if (cellsRow(yy)[xx] < thresholdCellValue)
 				clearance_sq =
 					min(clearance_sq, square(resolution) *
 										  (square(xx - cx) + square(yy - cy)));
@@ -0,0 +1,102 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h"  // Precomp header
+
+#include <mrpt/maps/CPointCloudFilterRandomSubsample.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/config/CConfigFileBase.h>
+#include <mrpt/random/RandomGenerators.h>
+#include <cmath>
+#include <random>
+
+using namespace mrpt::maps;
+
+void CPointCloudFilterRandomSubsample::filter(
+	/** [in,out] The input pointcloud, which will be modified upon return after
+	   filtering. */
+	mrpt::maps::CPointsMap* pc,
+	/** [in] The timestamp of the input pointcloud */
+	const mrpt::system::TTimeStamp pc_timestamp,
+	/** [in] If nullptr, the PC is assumed to be given in global coordinates.
+	   Otherwise, it will be transformed from local coordinates to global using
+	   this transformation. */
+	const mrpt::poses::CPose3D& cur_pc_pose,
+	/** [in,out] additional in/out parameters */
+	TExtraFilterParams* params)
+{
+	MRPT_UNUSED_PARAM(pc_timestamp);
+	MRPT_UNUSED_PARAM(cur_pc_pose);
+
+	MRPT_START
+	ASSERT_(pc != nullptr);
+	ASSERT_(options.keep_ratio >= 0 && options.keep_ratio <= 1);
+
+	const size_t N = pc->size();
+	size_t M = static_cast<size_t>(std::round(options.keep_ratio * N));
+	if (options.max_points != 0 && M > options.max_points)
+		M = options.max_points;
+
+	std::vector<bool> deletion_mask(N, true);
+	if (options.uniform)
+	{
+		// Keep point i if the sequence floor(i*M/N) steps at it:
+		for (size_t i = 0; i < N; i++)
+			deletion_mask[i] = ((i + 1) * M) / N == (i * M) / N;
+	}
+	else
+	{
+		// Selection sampling (Knuth's "Algorithm S"): each point is kept with
+		// probability (points still needed)/(points not visited yet), which
+		// picks exactly M points, all subsets being equally likely.
+		// The generator is local, so that concurrent calls do not race:
+		const uint32_t call = m_calls++;
+		mrpt::random::CRandomGenerator rng(
+			m_seeded ? m_seed + call : std::random_device()());
+		size_t kept = 0;
+		for (size_t i = 0; i < N && kept < M; i++)
+		{
+			if ((N - i) * rng.drawUniform(0.0, 1.0) < (M - kept))
+			{
+				deletion_mask[i] = false;
+				kept++;
+			}
+		}
+	}
+
+	if ((params == nullptr || params->do_not_delete == false) && M < N)
+		pc->applyDeletionMask(deletion_mask);
+
+	if (params != nullptr && params->out_deletion_mask != nullptr)
+		*params->out_deletion_mask = std::move(deletion_mask);
+
+	MRPT_END
+}
+
+void CPointCloudFilterRandomSubsample::TOptions::loadFromConfigFile(
+	const mrpt::config::CConfigFileBase& c, const std::string& s)
+{
+	MRPT_LOAD_CONFIG_VAR(keep_ratio, double, c, s);
+	MRPT_LOAD_CONFIG_VAR(max_points, uint64_t, c, s);
+	MRPT_LOAD_CONFIG_VAR(uniform, bool, c, s);
+}
+
+void CPointCloudFilterRandomSubsample::TOptions::saveToConfigFile(
+	mrpt::config::CConfigFileBase& c, const std::string& s) const
+{
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		keep_ratio, "(Default: 0.5) Ratio [0,1] of points to keep.");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		max_points,
+		"(Default: 0=no limit) Maximum number of points to keep.");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		uniform,
+		"(Default: false) If true, points are taken evenly spaced instead of "
+		"randomly.");
+}
@@ -0,0 +1,79 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/maps/CPointCloudFilterRandomSubsample.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+
+TEST(CPointCloudFilterRandomSubsample, keepRatio)
+{
+	for (const bool uniform : {false, true})
+	{
+		mrpt::maps::CSimplePointsMap m;
+		for (int i = 0; i < 1000; i++) m.insertPoint(i, 0, 0);
+
+		mrpt::maps::CPointCloudFilterRandomSubsample f;
+		f.randomize(123);
+		f.options.keep_ratio = 0.25;
+		f.options.uniform = uniform;
+		f.filter(&m, mrpt::system::now(), mrpt::poses::CPose3D());
+		ASSERT_EQ(m.size(), 250u);
+
+		// Order must be preserved:
+		float last_x = -1;
+		for (size_t i = 0; i < m.size(); i++)
+		{
+			float x, y, z;
+			m.getPoint(i, x, y, z);
+			EXPECT_GT(x, last_x);
+			if (uniform)
+			{
+				EXPECT_FLOAT_EQ(x, 3 + 4 * i);
+			}
+			last_x = x;
+		}
+	}
+}
+
+TEST(CPointCloudFilterRandomSubsample, maxPoints)
+{
+	mrpt::maps::CSimplePointsMap m;
+	for (int i = 0; i < 1000; i++) m.insertPoint(i, 0, 0);
+
+	mrpt::maps::CPointCloudFilterRandomSubsample f;
+	f.options.keep_ratio = 0.5;
+	f.options.max_points = 100;
+	f.filter(&m, mrpt::system::now(), mrpt::poses::CPose3D());
+	EXPECT_EQ(m.size(), 100u);
+}
+
+TEST(CPointCloudFilterRandomSubsample, repeatableWithSeed)
+{
+	std::vector<float> xs[2];
+	for (auto& x : xs)
+	{
+		mrpt::maps::CPointCloudFilterRandomSubsample f;
+		f.randomize(456);
+		for (int call = 0; call < 2; call++)
+		{
+			mrpt::maps::CSimplePointsMap m;
+			for (int i = 0; i < 1000; i++) m.insertPoint(i, 0, 0);
+			f.options.keep_ratio = 0.1;
+			f.filter(&m, mrpt::system::now(), mrpt::poses::CPose3D());
+			ASSERT_EQ(m.size(), 100u);
+			const auto& mx = m.getPointsBufferRef_x();
+			x.insert(x.end(), mx.begin(), mx.end());
+		}
+	}
+	EXPECT_EQ(xs[0], xs[1]);
+	// Successive calls pick different points:
+	EXPECT_FALSE(
+		std::equal(xs[0].begin(), xs[0].begin() + 100, xs[0].begin() + 100));
+}
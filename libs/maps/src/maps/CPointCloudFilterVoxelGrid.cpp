@@ -0,0 +1,115 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "maps-precomp.h"  // Precomp header
+
+#include <mrpt/maps/CPointCloudFilterVoxelGrid.h>
+#include <mrpt/maps/CPointsMap.h>
+#include <mrpt/config/CConfigFileBase.h>
+#include <cmath>
+
+using namespace mrpt::maps;
+
+void CPointCloudFilterVoxelGrid::filter(
+	/** [in,out] The input pointcloud, which will be modified upon return after
+	   filtering. */
+	mrpt::maps::CPointsMap* pc,
+	/** [in] The timestamp of the input pointcloud */
+	const mrpt::system::TTimeStamp pc_timestamp,
+	/** [in] If nullptr, the PC is assumed to be given in global coordinates.
+	   Otherwise, it will be transformed from local coordinates to global using
+	   this transformation. */
+	const mrpt::poses::CPose3D& cur_pc_pose,
+	/** [in,out] additional in/out parameters */
+	TExtraFilterParams* params)
+{
+	MRPT_UNUSED_PARAM(pc_timestamp);
+	MRPT_UNUSED_PARAM(cur_pc_pose);
+
+	MRPT_START
+	ASSERT_(pc != nullptr);
+	ASSERT_ABOVE_(options.resolution, 0);
+
+	const size_t N = pc->size();
+	const auto& xs = pc->getPointsBufferRef_x();
+	const auto& ys = pc->getPointsBufferRef_y();
+	const auto& zs = pc->getPointsBufferRef_z();
+	const double inv_res = 1.0 / options.resolution;
+
+	// 1) Assign points to voxels. Voxel indices are packed into 21 bits per
+	// axis, i.e. +-2^20 voxels (+-100km with 10cm voxels) before wrapping:
+	// ---------------------
+	std::unordered_map<uint64_t, TVoxel> voxels;
+	voxels.reserve(N);
+	std::vector<bool> deletion_mask(N, false);
+	size_t del_count = 0;
+	for (size_t i = 0; i < N; i++)
+	{
+		const auto vx = static_cast<int64_t>(std::floor(xs[i] * inv_res));
+		const auto vy = static_cast<int64_t>(std::floor(ys[i] * inv_res));
+		const auto vz = static_cast<int64_t>(std::floor(zs[i] * inv_res));
+		const uint64_t key = ((uint64_t(vx) & 0x1FFFFF) << 42) |
+							 ((uint64_t(vy) & 0x1FFFFF) << 21) |
+							 (uint64_t(vz) & 0x1FFFFF);
+
+		auto ins = voxels.emplace(key, TVoxel{i, 0, .0f, .0f, .0f});
+		TVoxel& v = ins.first->second;
+		v.count++;
+		v.sum_x += xs[i];
+		v.sum_y += ys[i];
+		v.sum_z += zs[i];
+		if (!ins.second)
+		{
+			deletion_mask[i] = true;
+			del_count++;
+		}
+	}
+
+	// 2) Remove points:
+	// ---------------------
+	if (params == nullptr || params->do_not_delete == false)
+	{
+		if (options.use_centroid)
+		{
+			for (const auto& kv : voxels)
+			{
+				const TVoxel& v = kv.second;
+				if (v.count < 2) continue;
+				const float k = 1.0f / v.count;
+				pc->setPointFast(
+					v.first_idx, v.sum_x * k, v.sum_y * k, v.sum_z * k);
+			}
+			pc->mark_as_modified();
+		}
+		if (del_count) pc->applyDeletionMask(deletion_mask);
+	}
+
+	if (params != nullptr && params->out_deletion_mask != nullptr)
+		*params->out_deletion_mask = std::move(deletion_mask);
+
+	MRPT_END
+}
+
+void CPointCloudFilterVoxelGrid::TOptions::loadFromConfigFile(
+	const mrpt::config::CConfigFileBase& c, const std::string& s)
+{
+	MRPT_LOAD_CONFIG_VAR(resolution, double, c, s);
+	MRPT_LOAD_CONFIG_VAR(use_centroid, bool, c, s);
+}
+
+void CPointCloudFilterVoxelGrid::TOptions::saveToConfigFile(
+	mrpt::config::CConfigFileBase& c, const std::string& s) const
+{
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		resolution, "(Default: 0.10 m) Length of the voxels edges.");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		use_centroid,
+		"(Default: true) Keep the centroid of each voxel instead of its "
+		"first point.");
+}
@@ -0,0 +1,149 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/maps/CPointCloudFilterVoxelGrid.h>
+#include <mrpt/maps/CSimplePointsMap.h>
+#include <mrpt/obs/CObservation3DRangeScan.h>
+#include <gtest/gtest.h>
+#include <thread>
+
+static void fill_voxel_test_map(mrpt::maps::CSimplePointsMap& m)
+{
+	// 3 points in voxel (0,0,0), 1 in voxel (1,0,0), 2 in voxel (-1,-1,0)
+	// with resolution=1:
+	m.clear();
+	m.insertPoint(0.1f, 0.1f, 0.1f);
+	m.insertPoint(0.5f, 0.2f, 0.3f);
+	m.insertPoint(0.9f, 0.3f, 0.2f);
+	m.insertPoint(1.5f, 0.5f, 0.5f);
+	m.insertPoint(-0.5f, -0.5f, 0.5f);
+	m.insertPoint(-0.1f, -0.9f, 0.1f);
+}
+
+TEST(CPointCloudFilterVoxelGrid, firstPoint)
+{
+	mrpt::maps::CSimplePointsMap m;
+	fill_voxel_test_map(m);
+
+	mrpt::maps::CPointCloudFilterVoxelGrid f;
+	f.options.resolution = 1.0;
+	f.options.use_centroid = false;
+
+	std::vector<bool> deletion_mask;
+	mrpt::maps::CPointCloudFilterBase::TExtraFilterParams extra_params;
+	extra_params.out_deletion_mask = &deletion_mask;
+	f.filter(&m, mrpt::system::now(), mrpt::poses::CPose3D(), &extra_params);
+
+	ASSERT_EQ(m.size(), 3u);
+	const std::vector<bool> expected_mask = {false, true, true,
+											 false, false, true};
+	EXPECT_EQ(deletion_mask, expected_mask);
+	float x, y, z;
+	m.getPoint(0, x, y, z);
+	EXPECT_FLOAT_EQ(x, 0.1f);
+	m.getPoint(2, x, y, z);
+	EXPECT_FLOAT_EQ(x, -0.5f);
+}
+
+TEST(CPointCloudFilterVoxelGrid, centroid)
+{
+	mrpt::maps::CSimplePointsMap m;
+	fill_voxel_test_map(m);
+
+	mrpt::maps::CPointCloudFilterVoxelGrid f;
+	f.options.resolution = 1.0;
+	f.filter(&m, mrpt::system::now(), mrpt::poses::CPose3D());
+
+	ASSERT_EQ(m.size(), 3u);
+	float x, y, z;
+	m.getPoint(0, x, y, z);
+	EXPECT_NEAR(x, 0.5f, 1e-5f);
+	EXPECT_NEAR(y, 0.2f, 1e-5f);
+	EXPECT_NEAR(z, 0.2f, 1e-5f);
+	m.getPoint(1, x, y, z);
+	EXPECT_NEAR(x, 1.5f, 1e-5f);
+	m.getPoint(2, x, y, z);
+	EXPECT_NEAR(x, -0.3f, 1e-5f);
+	EXPECT_NEAR(y, -0.7f, 1e-5f);
+	EXPECT_NEAR(z, 0.3f, 1e-5f);
+}
+
+TEST(CPointCloudFilterVoxelGrid, insertionFilter)
+{
+	// A 3D scan with 100 points within a 10cm cube, seen from a robot at
+	// (10,0,0):
+	mrpt::obs::CObservation3DRangeScan obs;
+	obs.timestamp = mrpt::system::now();
+	obs.hasPoints3D = true;
+	for (int i = 0; i < 100; i++)
+	{
+		obs.points3D_x.push_back(1.0f + 0.001f * i);
+		obs.points3D_y.push_back(0.05f);
+		obs.points3D_z.push_back(0.05f);
+	}
+	const mrpt::poses::CPose3D robotPose(10, 0, 0, 0, 0, 0);
+
+	auto f = std::make_shared<mrpt::maps::CPointCloudFilterVoxelGrid>();
+	f->options.resolution = 1.0;
+
+	mrpt::maps::CSimplePointsMap m;
+	m.insertionOptions.minDistBetweenLaserPoints = 0;
+	m.insertionOptions.insertionFilter = f;
+	m.insertObservation(&obs, &robotPose);
+
+	ASSERT_EQ(m.size(), 1u);
+	float x, y, z;
+	m.getPoint(0, x, y, z);
+	EXPECT_NEAR(x, 11.0495f, 1e-4f);
+	EXPECT_NEAR(y, 0.05f, 1e-4f);
+	EXPECT_NEAR(z, 0.05f, 1e-4f);
+}
+
+TEST(CPointCloudFilterVoxelGrid, sharedByMapCopies)
+{
+	// Map copies (e.g. RBPF particles) share the insertion filter and may
+	// insert observations concurrently:
+	mrpt::obs::CObservation3DRangeScan obs;
+	obs.timestamp = mrpt::system::now();
+	obs.hasPoints3D = true;
+	for (int i = 0; i < 20000; i++)
+	{
+		obs.points3D_x.push_back(1.0f + 0.0005f * (i % 4000));
+		obs.points3D_y.push_back(0.01f * (i / 4000));
+		obs.points3D_z.push_back(0.0f);
+	}
+
+	mrpt::maps::CSimplePointsMap m0;
+	m0.insertionOptions.minDistBetweenLaserPoints = 0;
+	m0.insertionOptions.insertionFilter =
+		std::make_shared<mrpt::maps::CPointCloudFilterVoxelGrid>();
+	std::vector<mrpt::maps::CSimplePointsMap> maps(4, m0);
+
+	std::vector<std::thread> threads;
+	for (size_t k = 0; k < maps.size(); k++)
+		threads.emplace_back([&, k]() {
+			const mrpt::poses::CPose3D robotPose(k, 0, 0, 0, 0, 0);
+			for (int rep = 0; rep < 5; rep++)
+			{
+				maps[k].clear();
+				maps[k].insertObservation(&obs, &robotPose);
+			}
+		});
+	for (auto& t : threads) t.join();
+
+	for (size_t k = 0; k < maps.size(); k++)
+	{
+		const mrpt::poses::CPose3D robotPose(k, 0, 0, 0, 0, 0);
+		m0.clear();
+		m0.insertObservation(&obs, &robotPose);
+		ASSERT_EQ(maps[k].size(), m0.size());
+		EXPECT_EQ(maps[k].getPointsBufferRef_x(), m0.getPointsBufferRef_x());
+		EXPECT_EQ(maps[k].getPointsBufferRef_y(), m0.getPointsBufferRef_y());
+	}
+}
@@ -12,9 +12,11 @@
 #include <mrpt/config/CConfigFile.h>
 #include <mrpt/system/CTicTac.h>
 #include <mrpt/system/CTimeLogger.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <mrpt/system/os.h>
 #include <mrpt/math/geometry.h>
 #include <mrpt/serialization/CArchive.h>
+#include <memory>
 
 #include <mrpt/maps/CPointsMap.h>
 #include <mrpt/maps/CSimplePointsMap.h>
@@ -301,6 +303,46 @@ void CPointsMap::clipOutOfRange(const TPoint2D& p, float maxRange)
 	mark_as_modified();
 }
 
+namespace
+{
+/** Result of one nearest-neighbor query in determineMatching2D/3D() */
+struct TNearestNeighbor
+{
+	unsigned int idx;
+	float err_sq;
+	bool valid;
+};
+
+/** Number of points of the "other" map to be paired, given the decimation */
+size_t countMatchingQueries(const TMatchingParams& params, size_t nLocalPoints)
+{
+	if (params.offset_other_map_points >= nLocalPoints) return 0;
+	return (nLocalPoints - params.offset_other_map_points +
+			params.decimation_other_map_points - 1) /
+		   params.decimation_other_map_points;
+}
+
+/** Runs query(k) for k in [0,N), split among the threads of pool, if any */
+void runMatchingQueries(
+	CWorkerThreadsPool* pool, const size_t N,
+	const std::function<void(size_t)>& query)
+{
+	// Below this size, scheduling costs more than the queries themselves:
+	const size_t MIN_CHUNK = 256;
+	if (!pool || N < 2 * MIN_CHUNK)
+	{
+		for (size_t k = 0; k < N; k++) query(k);
+		return;
+	}
+	pool->parallel_for(
+		N,
+		[&](size_t k0, size_t k1) {
+			for (size_t k = k0; k < k1; k++) query(k);
+		},
+		MIN_CHUNK);
+}
+}  // namespace
+
 void CPointsMap::determineMatching2D(
 	const mrpt::maps::CMetricMap* otherMap2, const CPose2D& otherMapPose_,
 	TMatchingPairList& correspondences, const TMatchingParams& params,
@@ -335,18 +377,14 @@ void CPointsMap::determineMatching2D(
 	float global_y_min = std::numeric_limits<float>::max(),
 		  global_y_max = -std::numeric_limits<float>::max();
 
-	double maxDistForCorrespondenceSquared;
-	float x_local, y_local;
-	unsigned int localIdx;
-
-	const float *x_other_it, *y_other_it, *z_other_it;
-
 	// Prepare output: no correspondences initially:
 	correspondences.clear();
 	correspondences.reserve(nLocalPoints);
 	extraResults.correspondencesRatio = 0;
 
-	TMatchingPairList _correspondences;
+	// (Buffers reused among calls, to avoid memory allocations)
+	thread_local TMatchingPairList _correspondences;
+	_correspondences.clear();
 	_correspondences.reserve(nLocalPoints);
 
 	// Nothing to do if we have an empty map!
@@ -467,37 +505,35 @@ void CPointsMap::determineMatching2D(
 		local_y_min > global_y_max || local_y_max < global_y_min)
 		return;  // We know for sure there is no matching at all
 
-	// Loop for each point in local map:
+	// Find the nearest neighbor of each local point, in parallel if
+	// requested:
 	// --------------------------------------------------
-	for (localIdx = params.offset_other_map_points,
-		x_other_it = &otherMap->m_x[params.offset_other_map_points],
-		y_other_it = &otherMap->m_y[params.offset_other_map_points],
-		z_other_it = &otherMap->m_z[params.offset_other_map_points];
-		 localIdx < nLocalPoints;
-		 x_other_it += params.decimation_other_map_points,
-		y_other_it += params.decimation_other_map_points,
-		z_other_it += params.decimation_other_map_points,
-		localIdx += params.decimation_other_map_points)
-	{
-		// For speed-up:
-		x_local = x_locals[localIdx];  // *x_locals_it;
-		y_local = y_locals[localIdx];  // *y_locals_it;
-
-		// Find all the matchings in the requested distance:
+	const size_t nQueries = countMatchingQueries(params, nLocalPoints);
+	// (The reference is needed for the worker threads to see *this* thread
+	// buffer, not their own one)
+	thread_local std::vector<TNearestNeighbor> nnBuffer;
+	std::vector<TNearestNeighbor>& nn = nnBuffer;
+	nn.resize(nQueries);
+	kdTreeEnsureIndexBuilt2D();
+
+	runMatchingQueries(params.threadPool, nQueries, [&](size_t k) {
+		const size_t localIdx = params.offset_other_map_points +
+								k * params.decimation_other_map_points;
+		const float x_local = x_locals[localIdx];
+		const float y_local = y_locals[localIdx];
 
 		// KD-TREE implementation =================================
 		// Use a KD-tree to look for the nearnest neighbor of:
 		//   (x_local, y_local, z_local)
 		// In "this" (global/reference) points map.
-
 		float tentativ_err_sq;
-		unsigned int tentativ_this_idx = kdTreeClosestPoint2D(
+		const unsigned int tentativ_this_idx = kdTreeClosestPoint2D(
 			x_local, y_local,  // Look closest to this guy
 			tentativ_err_sq  // save here the min. distance squared
 		);
 
 		// Compute max. allowed distance:
-		maxDistForCorrespondenceSquared = square(
+		const double maxDistForCorrespondenceSquared = square(
 			params.maxAngularDistForCorrespondence *
 				std::sqrt(
 					square(params.angularDistPivotPoint.x - x_local) +
@@ -505,33 +541,42 @@ void CPointsMap::determineMatching2D(
 			params.maxDistForCorrespondence);
 
 		// Distance below the threshold??
-		if (tentativ_err_sq < maxDistForCorrespondenceSquared)
-		{
-			// Save all the correspondences:
-			_correspondences.resize(_correspondences.size() + 1);
+		nn[k].valid = tentativ_err_sq < maxDistForCorrespondenceSquared;
+		nn[k].idx = tentativ_this_idx;
+		nn[k].err_sq = tentativ_err_sq;
+	});
+
+	// Gather the correspondences, in the same order than the local points:
+	// --------------------------------------------------
+	for (size_t k = 0; k < nQueries; k++)
+	{
+		if (!nn[k].valid) continue;
+		const size_t localIdx = params.offset_other_map_points +
+								k * params.decimation_other_map_points;
 
-			TMatchingPair& p = _correspondences.back();
+		// Save all the correspondences:
+		_correspondences.resize(_correspondences.size() + 1);
 
-			p.this_idx = tentativ_this_idx;
-			p.this_x = m_x[tentativ_this_idx];
-			p.this_y = m_y[tentativ_this_idx];
-			p.this_z = m_z[tentativ_this_idx];
+		TMatchingPair& p = _correspondences.back();
 
-			p.other_idx = localIdx;
-			p.other_x = *x_other_it;
-			p.other_y = *y_other_it;
-			p.other_z = *z_other_it;
+		p.this_idx = nn[k].idx;
+		p.this_x = m_x[nn[k].idx];
+		p.this_y = m_y[nn[k].idx];
+		p.this_z = m_z[nn[k].idx];
 
-			p.errorSquareAfterTransformation = tentativ_err_sq;
+		p.other_idx = localIdx;
+		p.other_x = otherMap->m_x[localIdx];
+		p.other_y = otherMap->m_y[localIdx];
+		p.other_z = otherMap->m_z[localIdx];
 
-			// At least one:
-			nOtherMapPointsWithCorrespondence++;
+		p.errorSquareAfterTransformation = nn[k].err_sq;
 
-			// Accumulate the MSE:
-			_sumSqrDist += p.errorSquareAfterTransformation;
-			_sumSqrCount++;
-		}
+		// At least one:
+		nOtherMapPointsWithCorrespondence++;
 
+		// Accumulate the MSE:
+		_sumSqrDist += p.errorSquareAfterTransformation;
+		_sumSqrCount++;
 	}  // For each local point
 
 	// Additional consistency filter: "onlyKeepTheClosest" up to now
@@ -574,14 +619,8 @@ void CPointsMap::determineMatching2D(
 void CPointsMap::changeCoordinatesReference(const CPose2D& newBase)
 {
 	const size_t N = m_x.size();
-
-	const CPose3D newBase3D(newBase);
-
-	for (size_t i = 0; i < N; i++)
-		newBase3D.composePoint(
-			m_x[i], m_y[i], m_z[i],  // In
-			m_x[i], m_y[i], m_z[i]  // Out
-		);
+	// (Z coordinates are not modified by a 2D pose)
+	newBase.composePoints(m_x.data(), m_y.data(), N, m_x.data(), m_y.data());
 
 	mark_as_modified();
 }
@@ -592,12 +631,9 @@ void CPointsMap::changeCoordinatesReference(const CPose2D& newBase)
 void CPointsMap::changeCoordinatesReference(const CPose3D& newBase)
 {
 	const size_t N = m_x.size();
-
-	for (size_t i = 0; i < N; i++)
-		newBase.composePoint(
-			m_x[i], m_y[i], m_z[i],  // In
-			m_x[i], m_y[i], m_z[i]  // Out
-		);
+	newBase.composePoints(
+		m_x.data(), m_y.data(), m_z.data(), N, m_x.data(), m_y.data(),
+		m_z.data());
 
 	mark_as_modified();
 }
@@ -1099,13 +1135,13 @@ void CPointsMap::determineMatching3D(
 	float local_z_min = std::numeric_limits<float>::max(),
 		  local_z_max = -std::numeric_limits<float>::max();
 
-	double maxDistForCorrespondenceSquared;
-
 	// Prepare output: no correspondences initially:
 	correspondences.clear();
 	correspondences.reserve(nLocalPoints);
 
-	TMatchingPairList _correspondences;
+	// (Buffers reused among calls, to avoid memory allocations)
+	thread_local TMatchingPairList _correspondences;
+	_correspondences.clear();
 	_correspondences.reserve(nLocalPoints);
 
 	// Empty maps?  Nothing to do
@@ -1151,65 +1187,78 @@ void CPointsMap::determineMatching3D(
 		local_y_min > global_y_max || local_y_max < global_y_min)
 		return;  // No need to compute: matching is ZERO.
 
-	// Loop for each point in local map:
+	// Find the nearest neighbor of each local point, in parallel if
+	// requested:
 	// --------------------------------------------------
-	for (unsigned int localIdx = params.offset_other_map_points;
-		 localIdx < nLocalPoints;
-		 localIdx += params.decimation_other_map_points)
-	{
-		// For speed-up:
+	const size_t nQueries = countMatchingQueries(params, nLocalPoints);
+	// (The reference is needed for the worker threads to see *this* thread
+	// buffer, not their own one)
+	thread_local std::vector<TNearestNeighbor> nnBuffer;
+	std::vector<TNearestNeighbor>& nn = nnBuffer;
+	nn.resize(nQueries);
+	kdTreeEnsureIndexBuilt3D();
+
+	runMatchingQueries(params.threadPool, nQueries, [&](size_t k) {
+		const size_t localIdx = params.offset_other_map_points +
+								k * params.decimation_other_map_points;
 		const float x_local = x_locals[localIdx];
 		const float y_local = y_locals[localIdx];
 		const float z_local = z_locals[localIdx];
 
-		{
-			// KD-TREE implementation
-			// Use a KD-tree to look for the nearnest neighbor of:
-			//   (x_local, y_local, z_local)
-			// In "this" (global/reference) points map.
+		// KD-TREE implementation
+		// Use a KD-tree to look for the nearnest neighbor of:
+		//   (x_local, y_local, z_local)
+		// In "this" (global/reference) points map.
+		float tentativ_err_sq;
+		const unsigned int tentativ_this_idx = kdTreeClosestPoint3D(
+			x_local, y_local, z_local,  // Look closest to this guy
+			tentativ_err_sq  // save here the min. distance squared
+		);
 
-			float tentativ_err_sq;
-			const unsigned int tentativ_this_idx = kdTreeClosestPoint3D(
-				x_local, y_local, z_local,  // Look closest to this guy
-				tentativ_err_sq  // save here the min. distance squared
-			);
+		// Compute max. allowed distance:
+		const double maxDistForCorrespondenceSquared = square(
+			params.maxAngularDistForCorrespondence *
+				params.angularDistPivotPoint.distanceTo(
+					TPoint3D(x_local, y_local, z_local)) +
+			params.maxDistForCorrespondence);
 
-			// Compute max. allowed distance:
-			maxDistForCorrespondenceSquared = square(
-				params.maxAngularDistForCorrespondence *
-					params.angularDistPivotPoint.distanceTo(
-						TPoint3D(x_local, y_local, z_local)) +
-				params.maxDistForCorrespondence);
+		// Distance below the threshold??
+		nn[k].valid = tentativ_err_sq < maxDistForCorrespondenceSquared;
+		nn[k].idx = tentativ_this_idx;
+		nn[k].err_sq = tentativ_err_sq;
+	});
 
-			// Distance below the threshold??
-			if (tentativ_err_sq < maxDistForCorrespondenceSquared)
-			{
-				// Save all the correspondences:
-				_correspondences.resize(_correspondences.size() + 1);
+	// Gather the correspondences, in the same order than the local points:
+	// --------------------------------------------------
+	for (size_t k = 0; k < nQueries; k++)
+	{
+		if (!nn[k].valid) continue;
+		const size_t localIdx = params.offset_other_map_points +
+								k * params.decimation_other_map_points;
 
-				TMatchingPair& p = _correspondences.back();
+		// Save all the correspondences:
+		_correspondences.resize(_correspondences.size() + 1);
 
-				p.this_idx = tentativ_this_idx;
-				p.this_x = m_x[tentativ_this_idx];
-				p.this_y = m_y[tentativ_this_idx];
-				p.this_z = m_z[tentativ_this_idx];
+		TMatchingPair& p = _correspondences.back();
 
-				p.other_idx = localIdx;
-				p.other_x = otherMap->m_x[localIdx];
-				p.other_y = otherMap->m_y[localIdx];
-				p.other_z = otherMap->m_z[localIdx];
+		p.this_idx = nn[k].idx;
+		p.this_x = m_x[nn[k].idx];
+		p.this_y = m_y[nn[k].idx];
+		p.this_z = m_z[nn[k].idx];
 
-				p.errorSquareAfterTransformation = tentativ_err_sq;
+		p.other_idx = localIdx;
+		p.other_x = otherMap->m_x[localIdx];
+		p.other_y = otherMap->m_y[localIdx];
+		p.other_z = otherMap->m_z[localIdx];
 
-				// At least one:
-				nOtherMapPointsWithCorrespondence++;
+		p.errorSquareAfterTransformation = nn[k].err_sq;
 
-				// Accumulate the MSE:
-				_sumSqrDist += p.errorSquareAfterTransformation;
-				_sumSqrCount++;
-			}
+		// At least one:
+		nOtherMapPointsWithCorrespondence++;
 
-		}  // End of test_match
+		// Accumulate the MSE:
+		_sumSqrDist += p.errorSquareAfterTransformation;
+		_sumSqrCount++;
 	}  // For each local point
 
 	// Additional consistency filter: "onlyKeepTheClosest" up to now
@@ -1781,20 +1830,12 @@ void CPointsMap::insertAnotherMap(
 	// Set the new size:
 	this->resize(N_this + N_other);
 
-	mrpt::math::TPoint3Df pt;
-	size_t src, dst;
-	for (src = 0, dst = N_this; src < N_other; src++, dst++)
-	{
-		// Load the next point:
-		otherMap->getPointFast(src, pt.x, pt.y, pt.z);
-
-		// Translation:
-		double gx, gy, gz;
-		otherPose.composePoint(pt.x, pt.y, pt.z, gx, gy, gz);
-
-		// Add to this map:
-		this->setPointFast(dst, gx, gy, gz);
-	}
+	// Transform all the points at once into this map:
+	if (N_other)
+		otherPose.composePoints(
+			otherMap->m_x.data(), otherMap->m_y.data(),
+			otherMap->m_z.data(), N_other, &m_x[N_this], &m_y[N_this],
+			&m_z[N_this]);
 
 	// Also copy other data fields (color, ...)
 	addFrom_classSpecific(*otherMap, N_this);
@@ -1825,6 +1866,32 @@ void CPointsMap::base_copyFrom(const CPointsMap& obj)
 	MRPT_END
 }
 
+/** Empty map of the same class than `m` (e.g. to keep colors, weights,...) */
+static std::unique_ptr<CPointsMap> createEmptyLike(const CPointsMap& m)
+{
+	return std::unique_ptr<CPointsMap>(
+		static_cast<CPointsMap*>(m.GetRuntimeClass()->createObject()));
+}
+
+/** Passes a point cloud in the robot frame through the insertion filter, then
+ * inserts (or fuses) it into the map at the given robot pose. */
+static void insertFilteredLocalCloud(
+	CPointsMap& map, CPointsMap& localCloud, const CObservation& obs,
+	const CPose3D& robotPose)
+{
+	map.insertionOptions.insertionFilter->filter(
+		&localCloud, obs.timestamp, robotPose);
+	if (map.insertionOptions.fuseWithExisting)
+	{
+		localCloud.changeCoordinatesReference(robotPose);
+		map.fuseWith(
+			&localCloud, map.insertionOptions.minDistBetweenLaserPoints,
+			nullptr);
+	}
+	else
+		map.insertAnotherMap(&localCloud, robotPose);
+}
+
 /*---------------------------------------------------------------
 					internal_insertObservation
 
@@ -1962,7 +2029,16 @@ bool CPointsMap::internal_insertObservation(
 		{
 			// 1) Fuse into the points map or add directly?
 			// ----------------------------------------------
-			if (insertionOptions.fuseWithExisting)
+			if (insertionOptions.insertionFilter)
+			{
+				// Project in the robot frame, filter and insert:
+				auto auxMap = createEmptyLike(*this);
+				auxMap->insertionOptions = insertionOptions;
+				auxMap->insertionOptions.addToExistingPointsMap = false;
+				auxMap->loadFromRangeScan(*o);
+				insertFilteredLocalCloud(*this, *auxMap, *o, robotPose3D);
+			}
+			else if (insertionOptions.fuseWithExisting)
 			{
 				// Fuse:
 				CSimplePointsMap auxMap;
@@ -2065,7 +2141,16 @@ bool CPointsMap::internal_insertObservation(
 		if (!o->point_cloud.size())
 			const_cast<CObservationVelodyneScan*>(o)->generatePointCloud();
 
-		if (insertionOptions.fuseWithExisting)
+		if (insertionOptions.insertionFilter)
+		{
+			// Filter in the robot frame, then insert:
+			auto auxMap = createEmptyLike(*this);
+			auxMap->insertionOptions = insertionOptions;
+			auxMap->insertionOptions.addToExistingPointsMap = false;
+			auxMap->loadFromVelodyneScan(*o);
+			insertFilteredLocalCloud(*this, *auxMap, *o, robotPose3D);
+		}
+		else if (insertionOptions.fuseWithExisting)
 		{
 			// Fuse:
 			CSimplePointsMap auxMap;
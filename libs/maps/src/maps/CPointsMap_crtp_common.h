@@ -408,19 +408,16 @@ struct loadFromRangeImpl
 		// --------------------------------------------------------------------------
 		mrpt::maps::CPointsMap::TLaserRange3DInsertContext lric(rangeScan);
 		sensorPose3D.getHomogeneousMatrix(lric.HM);
-		// For quicker access to values as "float" instead of "doubles":
-		float m00 = lric.HM.get_unsafe(0, 0);
-		float m01 = lric.HM.get_unsafe(0, 1);
-		float m02 = lric.HM.get_unsafe(0, 2);
-		float m03 = lric.HM.get_unsafe(0, 3);
-		float m10 = lric.HM.get_unsafe(1, 0);
-		float m11 = lric.HM.get_unsafe(1, 1);
-		float m12 = lric.HM.get_unsafe(1, 2);
-		float m13 = lric.HM.get_unsafe(1, 3);
-		float m20 = lric.HM.get_unsafe(2, 0);
-		float m21 = lric.HM.get_unsafe(2, 1);
-		float m22 = lric.HM.get_unsafe(2, 2);
-		float m23 = lric.HM.get_unsafe(2, 3);
+
+		// Transform all the points at once (buffers reused among calls):
+		thread_local std::vector<float> gxs, gys, gzs;
+		gxs.resize(sizeRangeScan);
+		gys.resize(sizeRangeScan);
+		gzs.resize(sizeRangeScan);
+		sensorPose3D.composePoints(
+			rangeScan.points3D_x.data(), rangeScan.points3D_y.data(),
+			rangeScan.points3D_z.data(), sizeRangeScan, gxs.data(),
+			gys.data(), gzs.data());
 
 		float lx_1, ly_1, lz_1, lx = 0, ly = 0,
 								lz = 0;  // Punto anterior y actual:
@@ -458,12 +455,9 @@ struct loadFromRangeImpl
 				lric.scan_y = rangeScan.points3D_y[i];
 				lric.scan_z = rangeScan.points3D_z[i];
 
-				lx = m00 * lric.scan_x + m01 * lric.scan_y + m02 * lric.scan_z +
-					 m03;
-				ly = m10 * lric.scan_x + m11 * lric.scan_y + m12 * lric.scan_z +
-					 m13;
-				lz = m20 * lric.scan_x + m21 * lric.scan_y + m22 * lric.scan_z +
-					 m23;
+				lx = gxs[i];
+				ly = gys[i];
+				lz = gzs[i];
 
 				// Specialized work in derived classes:
 				pointmap_traits<Derived>::
@@ -69,6 +69,11 @@ namespace math
  * different class instances for
  *  queries of each dimensionality, etc.
  *
+ * Queries do not modify the object once the KD-tree for their dimensionality
+ * has been built, so several threads can query it concurrently after calling
+ * kdTreeEnsureIndexBuilt2D() or kdTreeEnsureIndexBuilt3D() (and as long as
+ * the underlying data is not modified).
+ *
  *  \sa See some of the derived classes for example implementations. See also
  * the documentation of nanoflann
  * \ingroup mrpt_math_grp
@@ -135,11 +140,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&ret_index, &out_dist_sqr);
 
-		m_kdtree2d_data.query_point[0] = x0;
-		m_kdtree2d_data.query_point[1] = y0;
+		const num_t query_point[2] = {x0, y0};
 		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 
 		// Copy output to user vars:
 		out_x = derived().kdtree_get_pt(ret_index, 0);
@@ -163,11 +166,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&ret_index, &out_dist_sqr);
 
-		m_kdtree2d_data.query_point[0] = x0;
-		m_kdtree2d_data.query_point[1] = y0;
+		const num_t query_point[2] = {x0, y0};
 		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 
 		return ret_index;
 		MRPT_END
@@ -237,11 +238,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&ret_indexes[0], &ret_sqdist[0]);
 
-		m_kdtree2d_data.query_point[0] = x0;
-		m_kdtree2d_data.query_point[1] = y0;
+		const num_t query_point[2] = {x0, y0};
 		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 
 		// Copy output to user vars:
 		out_x1 = derived().kdtree_get_pt(ret_indexes[0], 0);
@@ -306,11 +305,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&ret_indexes[0], &out_dist_sqr[0]);
 
-		m_kdtree2d_data.query_point[0] = x0;
-		m_kdtree2d_data.query_point[1] = y0;
+		const num_t query_point[2] = {x0, y0};
 		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 
 		for (size_t i = 0; i < knn; i++)
 		{
@@ -368,11 +365,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&out_idx[0], &out_dist_sqr[0]);
 
-		m_kdtree2d_data.query_point[0] = x0;
-		m_kdtree2d_data.query_point[1] = y0;
+		const num_t query_point[2] = {x0, y0};
 		m_kdtree2d_data.index->findNeighbors(
-			resultSet, &m_kdtree2d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 		MRPT_END
 	}
 
@@ -418,12 +413,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&ret_index, &out_dist_sqr);
 
-		m_kdtree3d_data.query_point[0] = x0;
-		m_kdtree3d_data.query_point[1] = y0;
-		m_kdtree3d_data.query_point[2] = z0;
+		const num_t query_point[3] = {x0, y0, z0};
 		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 
 		// Copy output to user vars:
 		out_x = derived().kdtree_get_pt(ret_index, 0);
@@ -448,12 +440,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&ret_index, &out_dist_sqr);
 
-		m_kdtree3d_data.query_point[0] = x0;
-		m_kdtree3d_data.query_point[1] = y0;
-		m_kdtree3d_data.query_point[2] = z0;
+		const num_t query_point[3] = {x0, y0, z0};
 		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 
 		return ret_index;
 		MRPT_END
@@ -514,12 +503,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&ret_indexes[0], &out_dist_sqr[0]);
 
-		m_kdtree3d_data.query_point[0] = x0;
-		m_kdtree3d_data.query_point[1] = y0;
-		m_kdtree3d_data.query_point[2] = z0;
+		const num_t query_point[3] = {x0, y0, z0};
 		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 
 		for (size_t i = 0; i < knn; i++)
 		{
@@ -572,12 +558,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&out_idx[0], &out_dist_sqr[0]);
 
-		m_kdtree3d_data.query_point[0] = x0;
-		m_kdtree3d_data.query_point[1] = y0;
-		m_kdtree3d_data.query_point[2] = z0;
+		const num_t query_point[3] = {x0, y0, z0};
 		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 
 		for (size_t i = 0; i < knn; i++)
 		{
@@ -706,12 +689,9 @@ class KDTreeCapable
 		nanoflann::KNNResultSet<num_t> resultSet(knn);
 		resultSet.init(&out_idx[0], &out_dist_sqr[0]);
 
-		m_kdtree3d_data.query_point[0] = x0;
-		m_kdtree3d_data.query_point[1] = y0;
-		m_kdtree3d_data.query_point[2] = z0;
+		const num_t query_point[3] = {x0, y0, z0};
 		m_kdtree3d_data.index->findNeighbors(
-			resultSet, &m_kdtree3d_data.query_point[0],
-			nanoflann::SearchParams());
+			resultSet, query_point, nanoflann::SearchParams());
 		MRPT_END
 	}
 
@@ -724,6 +704,15 @@ class KDTreeCapable
 			static_cast<float>(p0.z), N, outIdx, outDistSqr);
 	}
 
+	/** Builds the 2D KD-tree now, if it was not already up to date, so that
+	 * subsequent 2D queries can be safely done from several threads.
+	 * \note [New in MRPT 2.0.0] */
+	inline void kdTreeEnsureIndexBuilt2D() const { rebuild_kdTree_2D(); }
+	/** Builds the 3D KD-tree now, if it was not already up to date, so that
+	 * subsequent 3D queries can be safely done from several threads.
+	 * \note [New in MRPT 2.0.0] */
+	inline void kdTreeEnsureIndexBuilt3D() const { rebuild_kdTree_3D(); }
+
 	/* @} */
 
    protected:
@@ -761,7 +750,6 @@ class KDTreeCapable
 		/** nullptr or the up-to-date index */
 		std::unique_ptr<kdtree_index_t> index;
 
-		std::vector<num_t> query_point;
 		/** Dimensionality. typ: 2,3 */
 		size_t m_dim = _DIM;
 		size_t m_num_points = 0;
@@ -794,7 +782,6 @@ class KDTreeCapable
 			const size_t N = derived().kdtree_get_point_count();
 			m_kdtree2d_data.m_num_points = N;
 			m_kdtree2d_data.m_dim = 2;
-			m_kdtree2d_data.query_point.resize(2);
 			if (N)
 			{
 				m_kdtree2d_data.index.reset(
@@ -828,7 +815,6 @@ class KDTreeCapable
 			const size_t N = derived().kdtree_get_point_count();
 			m_kdtree3d_data.m_num_points = N;
 			m_kdtree3d_data.m_dim = 3;
-			m_kdtree3d_data.query_point.resize(3);
 			if (N)
 			{
 				m_kdtree3d_data.index.reset(
@@ -9,7 +9,7 @@
 
 #pragma once
 
-#include <cmath>  // std::sqrt()
+#include <cmath>  // std::sqrt(), std::log()
 
 namespace mrpt
 {
@@ -27,7 +27,11 @@ enum TRobustKernelType
 	/** No robust kernel, use standard least squares: rho(r)= 1/2 * r^2 */
 	rkLeastSquares = 0,
 	/** Pseudo-huber robust kernel */
-	rkPseudoHuber
+	rkPseudoHuber,
+	/** Huber robust kernel \note [New in MRPT 2.0.0] */
+	rkHuber,
+	/** Cauchy robust kernel \note [New in MRPT 2.0.0] */
+	rkCauchy
 };
 
 // Generic declaration.
@@ -76,6 +80,56 @@ struct RobustKernel<rkPseudoHuber, T>
 	}
 };
 
+/** Huber robust kernel: rho(r) = r^2 if |r|<=delta, or
+ * 2*delta*|r|-delta^2 otherwise (quadratic for inliers, linear for
+ * outliers) \note [New in MRPT 2.0.0] */
+template <typename T>
+struct RobustKernel<rkHuber, T>
+{
+	/** The kernel parameter (the "threshold") squared. */
+	T param_sq;
+
+	/** Evaluates the kernel function for the squared error r2 and returns
+	 * robustified squared error and derivatives of sqrt(2*rho(r)) at this
+	 * point. */
+	inline T eval(const T r2, T& out_1st_deriv, T& out_2nd_deriv)
+	{
+		if (r2 <= param_sq)
+		{
+			out_1st_deriv = 1;
+			out_2nd_deriv = 0;
+			return r2;  // return: 2*cost
+		}
+		const T r = std::sqrt(r2);
+		const T delta = std::sqrt(param_sq);
+		out_1st_deriv = delta / r;
+		out_2nd_deriv = -0.5 * out_1st_deriv / r2;
+		return 2 * delta * r - param_sq;  // return: 2*cost
+	}
+};
+
+/** Cauchy robust kernel: rho(r) = delta^2 * log( 1 + r^2/delta^2 ). Stronger
+ * down-weighting of large outliers than (pseudo-)Huber.
+ * \note [New in MRPT 2.0.0] */
+template <typename T>
+struct RobustKernel<rkCauchy, T>
+{
+	/** The kernel parameter (the "threshold") squared. */
+	T param_sq;
+
+	/** Evaluates the kernel function for the squared error r2 and returns
+	 * robustified squared error and derivatives of sqrt(2*rho(r)) at this
+	 * point. */
+	inline T eval(const T r2, T& out_1st_deriv, T& out_2nd_deriv)
+	{
+		const T param_sq_inv = 1.0 / param_sq;
+		const T a = 1 + r2 * param_sq_inv;
+		out_1st_deriv = 1. / a;
+		out_2nd_deriv = -param_sq_inv * out_1st_deriv * out_1st_deriv;
+		return param_sq * std::log(a);  // return: 2*cost
+	}
+};
+
 /** @} */  // end of grouping
 }  // namespace math
 }  // namespace mrpt
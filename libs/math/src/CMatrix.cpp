@@ -26,9 +26,9 @@ void CMatrix::serializeTo(mrpt::serialization::CArchive& out) const
 	// First, write the number of rows and columns:
 	out << (uint32_t)rows() << (uint32_t)cols();
 
+	// Row-major storage: all rows are written at once.
 	if (rows() > 0 && cols() > 0)
-		for (Index i = 0; i < rows(); i++)
-			out.WriteBufferFixEndianness<Scalar>(&coeff(i, 0), cols());
+		out.WriteBufferFixEndianness<Scalar>(data(), rows() * cols());
 }
 
 void CMatrix::serializeFrom(mrpt::serialization::CArchive& in, uint8_t version)
@@ -45,8 +45,8 @@ void CMatrix::serializeFrom(mrpt::serialization::CArchive& in, uint8_t version)
 			setSize(nRows, nCols);
 
 			if (nRows > 0 && nCols > 0)
-				for (Index i = 0; i < rows(); i++)
-					in.ReadBufferFixEndianness<Scalar>(&coeffRef(i, 0), nCols);
+				in.ReadBufferFixEndianness<Scalar>(
+					data(), size_t(nRows) * nCols);
 		}
 		break;
 		default:
@@ -82,7 +82,7 @@ void CSparseMatrix::swap(CSparseMatrix& other)
 {
 	// Fast copy / Move:
 	std::swap(sparse_matrix.m, other.sparse_matrix.m);
-	std::swap(sparse_matrix.n, sparse_matrix.n);
+	std::swap(sparse_matrix.n, other.sparse_matrix.n);
 	std::swap(sparse_matrix.nz, other.sparse_matrix.nz);
 	std::swap(sparse_matrix.nzmax, other.sparse_matrix.nzmax);
 
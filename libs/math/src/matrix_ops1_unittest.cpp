@@ -13,6 +13,7 @@
 
 #include <mrpt/math/CMatrixFixedNumeric.h>
 #include <mrpt/math/CMatrixD.h>
+#include <mrpt/math/CMatrix.h>
 #include <mrpt/math/matrix_serialization.h>  // serialization of matrices
 //#include <mrpt/math/ops_matrices.h>
 #include <mrpt/serialization/CArchive.h>
@@ -87,6 +88,21 @@ TEST(Matrices, SerializeCMatrixD)
 	}
 }
 
+TEST(Matrices, SerializeCMatrix)
+{
+	CMatrix A(40, 30);
+	for (int r = 0; r < A.rows(); r++)
+		for (int c = 0; c < A.cols(); c++) A(r, c) = r * 100 + c;
+
+	mrpt::io::CMemoryStream membuf;
+	auto arch = mrpt::serialization::archiveFrom(membuf);
+	arch << A;
+	membuf.Seek(0);
+	CMatrix B;
+	arch >> B;
+	EXPECT_EQ(A, B);
+}
+
 TEST(Matrices, EigenVal2x2dyn)
 {
 	const double dat_C1[] = {14.6271, 5.8133, 5.8133, 16.8805};
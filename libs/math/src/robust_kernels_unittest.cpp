@@ -35,6 +35,22 @@ const double list_test_kernel_pshb[][5] = {
 	{4.0, 4.0, 3.31371, 0.707107, -0.0441942},
 	{4.0, 9.0, 3.63331, 0.83205, -0.0320019}};
 
+// =============  Kernel: Huber
+const double list_test_kernel_huber[][5] = {
+	{0.0, 1.0, 0.0, 1.0, 0.0},
+	{1.0, 1.0, 1.0, 1.0, 0.0},
+	{1.0, 4.0, 1.0, 1.0, 0.0},
+	{4.0, 1.0, 3.0, 0.5, -0.0625},
+	{9.0, 4.0, 8.0, 0.666667, -0.037037}};
+
+// =============  Kernel: Cauchy
+const double list_test_kernel_cauchy[][5] = {
+	{0.0, 1.0, 0.0, 1.0, -1.0},
+	{1.0, 1.0, 0.693147, 0.5, -0.25},
+	{4.0, 1.0, 1.609438, 0.2, -0.04},
+	{4.0, 4.0, 2.772589, 0.5, -0.0625},
+	{9.0, 4.0, 4.714620, 0.307692, -0.0236686}};
+
 template <TRobustKernelType KERNEL_TYPE>
 void tester_robust_kernel(const double table[][5], const size_t N)
 {
@@ -72,3 +88,17 @@ TEST(RobustKernels, PseudoHuber)
 		sizeof(list_test_kernel_pshb) / sizeof(list_test_kernel_pshb[0]);
 	tester_robust_kernel<rkPseudoHuber>(list_test_kernel_pshb, N);
 }
+
+TEST(RobustKernels, Huber)
+{
+	const size_t N =
+		sizeof(list_test_kernel_huber) / sizeof(list_test_kernel_huber[0]);
+	tester_robust_kernel<rkHuber>(list_test_kernel_huber, N);
+}
+
+TEST(RobustKernels, Cauchy)
+{
+	const size_t N =
+		sizeof(list_test_kernel_cauchy) / sizeof(list_test_kernel_cauchy[0]);
+	tester_robust_kernel<rkCauchy>(list_test_kernel_cauchy, N);
+}
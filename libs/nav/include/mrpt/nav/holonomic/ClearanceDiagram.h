@@ -11,6 +11,7 @@
 #include <vector>
 #include <map>
 #include <cstdint>
+#include <cstddef>
 #include <mrpt/opengl/opengl_frwds.h>
 #include <mrpt/serialization/serialization_frwds.h>
 
@@ -23,7 +24,9 @@ namespace nav
  * - Declare an object of this type (it will be initialized to "empty"),
  * - Call CParameterizedTrajectoryGenerator::initClearanceDiagram()
  * - Repeatedly call CParameterizedTrajectoryGenerator::updateClearance() for
- * each 2D obstacle point.
+ * each 2D obstacle point, or
+ * CParameterizedTrajectoryGenerator::updateClearanceBatch() once for all of
+ * them.
  *
  *  \ingroup nav_tpspace
  */
@@ -225,6 +225,14 @@ class CAbstractPTGBasedReactive : public CWaypointsNavigator
 		/** Max dist [meters] to use time-based path prediction for NOP
 		 * evaluation. */
 		double max_dist_for_timebased_path_prediction;
+		/** Number of threads to build the TP-Obstacles of all PTGs, in
+		 * parallel for the different PTGs and, within each PTG, for chunks of
+		 * obstacle points (0: as many as CPU cores; 1: no threads, all in the
+		 * navigation thread). Values other than 1 require that
+		 * STEP3_WSpaceToTPSpace() of derived classes is thread-safe. Changes
+		 * take effect at the next initialize() or loadConfigFile().
+		 * (Default: 1) */
+		unsigned int num_threads;
 
 		virtual void loadFromConfigFile(
 			const mrpt::config::CConfigFileBase& c,
@@ -342,13 +350,26 @@ class CAbstractPTGBasedReactive : public CWaypointsNavigator
 	 * "out_TPObstacles" is already initialized to the proper length and
 	 * maximum collision-free distance for each "k" trajectory index.
 	 * Distances are in "pseudo-meters". They will be normalized automatically
-	 * to [0,1] upon return. */
+	 * to [0,1] upon return.
+	 * \note It is called in parallel for the different PTGs (see
+	 * TAbstractPTGNavigatorParams::num_threads), so it must not modify any
+	 * shared state. */
 	virtual void STEP3_WSpaceToTPSpace(
 		const size_t ptg_idx, std::vector<double>& out_TPObstacles,
 		mrpt::nav::ClearanceDiagram& out_clearance,
 		const mrpt::math::TPose2D& rel_pose_PTG_origin_wrt_sense,
 		const bool eval_clearance) = 0;
 
+	/** Returns the pool of worker threads for
+	 * TAbstractPTGNavigatorParams::num_threads, or nullptr if it is 1. The
+	 * pool is only (re)created by initialize() and loadConfigFile(), so
+	 * implementations of STEP3_WSpaceToTPSpace() may use it from any
+	 * thread. */
+	mrpt::system::CWorkerThreadsPool* getThreadPool() const
+	{
+		return m_threadPool.get();
+	}
+
 	/** Generates a pointcloud of obstacles, and the robot shape, to be saved in
 	 * the logging record for the current timestep */
 	virtual void loggingGetWSObstaclesAndShape(CLogFileRecord& out_log) = 0;
@@ -418,12 +439,36 @@ class CAbstractPTGBasedReactive : public CWaypointsNavigator
 		std::vector<double> TP_Obstacles;
 		/** Clearance for each path */
 		ClearanceDiagram clearance;
+		/** Whether `targets`, `TP_Obstacles` and `clearance` have been
+		 * already computed for this navigation step. */
+		bool TP_Obstacles_ready;
+		/** Whether any target falls into the PTG domain. */
+		bool any_TPTarget_is_valid;
+		/** Time spent in building the TP-Obstacles [s] */
+		double timeForTPObsTransformation;
+
+		TInfoPerPTG()
+			: TP_Obstacles_ready(false),
+			  any_TPTarget_is_valid(false),
+			  timeForTPObsTransformation(.0)
+		{
+		}
 	};
 
 	/** Temporary buffers for working with each PTG during a navigationStep() */
 	std::vector<TInfoPerPTG> m_infoPerPTG;
 	mrpt::system::TTimeStamp m_infoPerPTG_timestamp;
 
+	/** Maps the targets into the TP-Space of the given PTG and, if any of
+	 * them is valid, builds its TP-Obstacles (STEP3), filling in `ipf`.
+	 * Thread-safe for different PTGs, as long as STEP3_WSpaceToTPSpace() is.
+	 * Called from build_movement_candidate() if not done yet. */
+	void build_TP_targets_and_obstacles(
+		CParameterizedTrajectoryGenerator* ptg, const size_t indexPTG,
+		const std::vector<mrpt::math::TPose2D>& relTargets,
+		const mrpt::math::TPose2D& rel_pose_PTG_origin_wrt_sense,
+		const TNavigationParams& navp, TInfoPerPTG& ipf);
+
 	void build_movement_candidate(
 		CParameterizedTrajectoryGenerator* ptg, const size_t indexPTG,
 		const std::vector<mrpt::math::TPose2D>& relTargets,
@@ -473,6 +518,12 @@ class CAbstractPTGBasedReactive : public CWaypointsNavigator
 	/** A copy of last-iteration navparams, used to detect changes */
 	std::unique_ptr<TNavigationParams> m_copy_prev_navParams;
 
+	/** \sa getThreadPool() */
+	std::shared_ptr<mrpt::system::CWorkerThreadsPool> m_threadPool;
+	/** (Re)creates m_threadPool from TAbstractPTGNavigatorParams::num_threads
+	 */
+	void updateThreadPool();
+
 };  // end of CAbstractPTGBasedReactive
 }  // namespace nav
 }  // namespace mrpt
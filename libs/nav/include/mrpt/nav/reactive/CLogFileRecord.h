@@ -81,6 +81,9 @@ class CLogFileRecord : public mrpt::serialization::CSerializable
 	/** Known values:
 	 *	- "executionTime": The total computation time, excluding sensing.
 	 *	- "estimatedExecutionPeriod": The estimated execution period.
+	 *	- "timeForTPObsTransformation_allPTGs": Wall time for building the
+	 * TP-Obstacles of all PTGs (in parallel). The time for each PTG is in
+	 * TInfoPerPTG::timeForTPObsTransformation.
 	 */
 	std::map<std::string, double> values;
 	/** Known values:
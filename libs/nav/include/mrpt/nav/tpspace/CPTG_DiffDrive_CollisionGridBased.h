@@ -12,6 +12,7 @@
 #include <mrpt/containers/CDynamicGrid.h>
 #include <mrpt/math/CPolygon.h>
 #include <mrpt/typemeta/TEnumType.h>
+#include <memory>
 
 namespace mrpt
 {
@@ -45,6 +46,13 @@ mrpt::serialization::CArchive& operator>>(
  * look-up-table.
  * Regarding `initialize()`: in this this family of PTGs, the method builds the
  * collision grid or load it from a cache file.
+ * The cache file (the given file name, without its `.gz` extension, if any)
+ * holds the grid in a flat, compact layout (for each cell, the offset of its
+ * list of (k,distance) pairs in two arrays with all of them) which is mapped
+ * read-only into memory (see mrpt::io::CMemoryMappedFile) instead of being
+ * parsed, so loading is almost instantaneous and the OS shares the memory
+ * among all processes using the same PTGs. Cache files in the former,
+ * gz-compressed format are still read and converted into the new one.
  * Collision grids must be calculated before calling getTPObstacle(). Robot
  * shape must be set before initializing with setRobotShape().
  * The rest of PTG parameters should have been set at the constructor.
@@ -98,6 +106,10 @@ class CPTG_DiffDrive_CollisionGridBased : public CPTG_RobotShape_Polygonal
 	double getMaxAngVel() const override { return W_MAX; }
 	void updateTPObstacle(
 		double ox, double oy, std::vector<double>& tp_obstacles) const override;
+	void updateTPObstacleBatch(
+		const float* ox, const float* oy, const size_t N,
+		std::vector<double>& tp_obstacles,
+		mrpt::system::CWorkerThreadsPool* pool = nullptr) const override;
 	void updateTPObstacleSingle(
 		double ox, double oy, uint16_t k, double& tp_obstacle_k) const override;
 
@@ -111,6 +123,9 @@ class CPTG_DiffDrive_CollisionGridBased : public CPTG_RobotShape_Polygonal
 
 	double getMax_V() const { return V_MAX; }
 	double getMax_W() const { return W_MAX; }
+	/** Returns true if the collision grid is being read from a memory-mapped
+	 * cache file, false if it was computed (or converted) in this process. */
+	bool isCollisionGridMapped() const { return m_collisionGrid.isMapped(); }
    protected:
 	CPTG_DiffDrive_CollisionGridBased();
 
@@ -164,11 +179,36 @@ class CPTG_DiffDrive_CollisionGridBased : public CPTG_RobotShape_Polygonal
 	 */
 	using TCollisionCell = std::vector<std::pair<uint16_t, float>>;
 
-	/** An internal class for storing the collision grid  */
+	/** A read-only view of the (k,distance) pairs of a cell of the collision
+	 * grid, `k[i]` and `dist[i]` for `i=0,...,size-1`. */
+	struct TCollisionCellView
+	{
+		const uint16_t* k;
+		const float* dist;
+		uint32_t size;
+	};
+
+	/** An internal class for storing the collision grid.
+	 * While being built with updateCellInfo(), each cell holds a
+	 * TCollisionCell. Once complete, compact() moves all of them into a
+	 * read-only, compact layout (or loadFromFile() maps it from a cache
+	 * file) which is used by getTPObstacle(). */
 	class CCollisionGrid : public mrpt::containers::CDynamicGrid<TCollisionCell>
 	{
 	   private:
 		CPTG_DiffDrive_CollisionGridBased const* m_parent;
+		/** The compact, read-only grid (defined in the .cpp). Shared (not
+		 * duplicated) among copies of this object. */
+		struct TCompactCells;
+		std::shared_ptr<const TCompactCells> m_compact;
+
+		void saveHeader(
+			mrpt::serialization::CArchive& f, const uint8_t version,
+			const mrpt::math::CPolygon& computed_robotShape) const;
+		/** \return false if the file is not for this PTG and robot shape */
+		bool loadAndCheckHeader(
+			mrpt::serialization::CArchive& f, const uint8_t version,
+			const mrpt::math::CPolygon& current_robotShape) const;
 
 	   public:
 		CCollisionGrid(
@@ -180,18 +220,30 @@ class CPTG_DiffDrive_CollisionGridBased : public CPTG_RobotShape_Polygonal
 		{
 		}
 		virtual ~CCollisionGrid() {}
-		/** Save to file, true = OK */
+		/** Save the compact grid to a cache file, true = OK */
 		bool saveToFile(
-			mrpt::serialization::CArchive* fil,
+			const std::string& filename,
 			const mrpt::math::CPolygon& computed_robotShape) const;
-		/** Load from file,  true = OK */
+		/** Maps a cache file written by saveToFile(), true = OK.
+		 * The grid must have been already set to the expected size. */
 		bool loadFromFile(
+			const std::string& filename,
+			const mrpt::math::CPolygon& current_robotShape);
+		/** Load from a cache file in the former, gz-compressed format, true =
+		 * OK. The grid is compacted upon load. */
+		bool loadFromLegacyFile(
 			mrpt::serialization::CArchive* fil,
 			const mrpt::math::CPolygon& current_robotShape);
 
-		/** For an obstacle (x,y), returns a vector with all the pairs (a,d)
-		 * such as the robot collides */
-		const TCollisionCell& getTPObstacle(
+		/** Moves the cells built with updateCellInfo() into the compact
+		 * layout, freeing them. */
+		void compact();
+		/** Whether the compact grid is mapped from a cache file */
+		bool isMapped() const;
+
+		/** For an obstacle (x,y), returns all the pairs (k,d) such as the
+		 * robot collides. Only valid after compact() or loadFromFile(). */
+		TCollisionCellView getTPObstacle(
 			const float obsX, const float obsY) const;
 
 		/** Updates the info into a cell: It updates the cell only if the
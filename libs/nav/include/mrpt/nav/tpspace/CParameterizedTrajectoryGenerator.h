@@ -25,6 +25,10 @@ namespace opengl
 {
 class CSetOfLines;
 }
+namespace system
+{
+class CWorkerThreadsPool;
+}
 }
 
 namespace mrpt
@@ -251,6 +255,21 @@ class CParameterizedTrajectoryGenerator
 	virtual void updateTPObstacle(
 		double ox, double oy, std::vector<double>& tp_obstacles) const = 0;
 
+	/** Like updateTPObstacle() but for a batch of `N` obstacle points, given
+	 * as separate arrays of X and Y coordinates (relative to the origin of
+	 * the PTG). The result is exactly the same than calling
+	 * updateTPObstacle() for each point.
+	 * The default implementation just does that; PTGs with a fast lookup of
+	 * TP-Obstacles reimplement it to process chunks of points in parallel
+	 * in the given pool of threads, if not nullptr.
+	 * This method can be called in parallel for different `tp_obstacles`.
+	 * \note [New in MRPT 2.0.0]
+	 */
+	virtual void updateTPObstacleBatch(
+		const float* ox, const float* oy, const size_t N,
+		std::vector<double>& tp_obstacles,
+		mrpt::system::CWorkerThreadsPool* pool = nullptr) const;
+
 	/** Like updateTPObstacle() but for one direction only (`k`) in TP-Space.
 	 * `tp_obstacle_k` must be initialized with initTPObstacleSingle() before
 	 * call (collision-free ranges, in "pseudometers", un-normalized). */
@@ -305,7 +324,9 @@ class CParameterizedTrajectoryGenerator
 		const double x, const double y) const = 0;
 
 	/** Evals the clearance from an obstacle (ox,oy) in coordinates relative to
-	 * the robot center. Zero or negative means collision. */
+	 * the robot center. Zero or negative means collision.
+	 * Implementations must never return less than `hypot(ox,oy) -
+	 * getMaxRobotRadius()` (see updateClearanceBatch()). */
 	virtual double evalClearanceToRobotShape(
 		const double ox, const double oy) const = 0;
 
@@ -440,6 +461,27 @@ class CParameterizedTrajectoryGenerator
 	  */
 	void updateClearance(
 		const double ox, const double oy, ClearanceDiagram& cd) const;
+
+	/** Like updateClearance() but for a batch of `N` obstacle points, given as
+	 * separate arrays of X and Y coordinates (relative to the PTG origin).
+	 * The result is exactly the same than calling updateClearance() for each
+	 * point, but much faster:
+	 * - Robot poses along each decimated path are evaluated only once.
+	 * - Obstacles whose distance to a pose (or to the circle bounding a whole
+	 * path) minus getMaxRobotRadius() can not improve the stored clearance are
+	 * skipped without calling evalClearanceToRobotShape(). This relies on
+	 * evalClearanceToRobotShape() never returning less than that distance, as
+	 * is the case for all robot shapes in MRPT.
+	 * - Decimated paths are processed in parallel in the given pool of
+	 * threads, if not nullptr.
+	 *
+	 * Note that this method always uses the base class implementation of
+	 * evalClearanceSingleObstacle().
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void updateClearanceBatch(
+		const float* ox, const float* oy, const size_t N, ClearanceDiagram& cd,
+		mrpt::system::CWorkerThreadsPool* pool = nullptr) const;
 	void updateClearancePost(
 		ClearanceDiagram& cd, const std::vector<double>& TP_obstacles) const;
 
@@ -20,6 +20,7 @@
 #include <mrpt/io/CMemoryStream.h>
 #include <mrpt/maps/CPointCloudFilterByDistance.h>
 #include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <limits>
 #include <iomanip>
 #include <array>
@@ -122,6 +123,8 @@ void CAbstractPTGBasedReactive::initialize()
 	ASSERT_(m_multiobjopt);
 	m_multiobjopt->clear();
 
+	updateThreadPool();
+
 	// Compute collision grids:
 	STEP1_InitPTGs();
 }
@@ -510,6 +513,29 @@ void CAbstractPTGBasedReactive::performNavigationStep()
 
 		m_infoPerPTG.assign(nPTGs + 1, TInfoPerPTG());  // reset contents
 		m_infoPerPTG_timestamp = tim_start_iteration;
+
+		// STEP3: TP-Obstacles of all PTGs, in parallel. The rest of the
+		// evaluation of each PTG goes on sequentially below.
+		{
+			CTimeLoggerEntry tle(
+				m_timelogger, "navigationStep.STEP3_WSpaceToTPSpace_allPTGs");
+			CTicTac tic_allPTGs;
+			ASSERT_(m_navigationParams);
+			const auto buildTPObs = [&](size_t first, size_t last) {
+				for (size_t indexPTG = first; indexPTG < last; indexPTG++)
+					build_TP_targets_and_obstacles(
+						getPTG(indexPTG), indexPTG, relTargets,
+						rel_pose_PTG_origin_wrt_sense, *m_navigationParams,
+						m_infoPerPTG[indexPTG]);
+			};
+			CWorkerThreadsPool* pool = getThreadPool();
+			if (pool)
+				pool->parallel_for(nPTGs, buildTPObs);
+			else
+				buildTPObs(0, nPTGs);
+			newLogRec.values["timeForTPObsTransformation_allPTGs"] =
+				tic_allPTGs.Tac();
+		}
 		vector<TCandidateMovementPTG> candidate_movs(
 			nPTGs + 1);  // the last extra one is for the evaluation of "NOP
 		// motion command" choice.
@@ -1517,27 +1543,19 @@ bool CAbstractPTGBasedReactive::TSentVelCmd::isValid() const
 }
 
 /** \callergraph */
-void CAbstractPTGBasedReactive::build_movement_candidate(
+void CAbstractPTGBasedReactive::build_TP_targets_and_obstacles(
 	CParameterizedTrajectoryGenerator* ptg, const size_t indexPTG,
 	const std::vector<mrpt::math::TPose2D>& relTargets,
-	const mrpt::math::TPose2D& rel_pose_PTG_origin_wrt_sense, TInfoPerPTG& ipf,
-	TCandidateMovementPTG& cm, CLogFileRecord& newLogRec,
-	const bool this_is_PTG_continuation,
-	mrpt::nav::CAbstractHolonomicReactiveMethod& holoMethod,
-	const mrpt::system::TTimeStamp tim_start_iteration,
-	const TNavigationParams& navp,
-	const mrpt::math::TPose2D& rel_cur_pose_wrt_last_vel_cmd_NOP)
+	const mrpt::math::TPose2D& rel_pose_PTG_origin_wrt_sense,
+	const TNavigationParams& navp, TInfoPerPTG& ipf)
 {
 	ASSERT_(ptg);
 
-	const size_t idx_in_log_infoPerPTGs =
-		this_is_PTG_continuation ? getPTG_count() : indexPTG;
-
-	CHolonomicLogFileRecord::Ptr HLFR;
-	cm.PTG = ptg;
-
 	// If the user doesn't want to use this PTG, just mark it as invalid:
 	ipf.targets.clear();
+	ipf.any_TPTarget_is_valid = false;
+	ipf.timeForTPObsTransformation = .0;
+	ipf.TP_Obstacles_ready = true;
 	bool use_this_ptg = true;
 	{
 		const TNavigationParamsPTG* navpPTG =
@@ -1554,10 +1572,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 		}
 	}
 
-	double timeForTPObsTransformation = .0, timeForHolonomicMethod = .0;
-
 	// Normal PTG validity filter: check if target falls into the PTG domain:
-	bool any_TPTarget_is_valid = false;
 	if (use_this_ptg)
 	{
 		for (size_t i = 0; i < relTargets.size(); i++)
@@ -1569,7 +1584,7 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 				trg.x, trg.y, ptg_target.target_k, ptg_target.target_dist);
 			if (!ptg_target.valid_TP) continue;
 
-			any_TPTarget_is_valid = true;
+			ipf.any_TPTarget_is_valid = true;
 			ptg_target.target_alpha = ptg->index2alpha(ptg_target.target_k);
 			ptg_target.TP_Target.x =
 				cos(ptg_target.target_alpha) * ptg_target.target_dist;
@@ -1579,49 +1594,93 @@ void CAbstractPTGBasedReactive::build_movement_candidate(
 			ipf.targets.emplace_back(ptg_target);
 		}
 	}
+	if (!ipf.any_TPTarget_is_valid) return;
 
-	if (!any_TPTarget_is_valid)
+	//  STEP3(b): Build TP-Obstacles
+	// -------------------------------------------------------------------------
+	// (Local timer, since this may run in parallel for several PTGs)
+	CTicTac tic;
+
+	// Initialize TP-Obstacles:
+	const size_t Ki = ptg->getAlphaValuesCount();
+	ptg->initTPObstacles(ipf.TP_Obstacles);
+	if (params_abstract_ptg_navigator.evaluate_clearance)
 	{
-		newLogRec.additional_debug_msgs[mrpt::format(
-			"mov_candidate_%u", static_cast<unsigned int>(indexPTG))] =
-			"PTG discarded since target(s) is(are) out of domain.";
+		ptg->initClearanceDiagram(ipf.clearance);
 	}
-	else
+
+	// Implementation-dependent conversion:
+	STEP3_WSpaceToTPSpace(
+		indexPTG, ipf.TP_Obstacles, ipf.clearance,
+		mrpt::math::TPose2D(0, 0, 0) - rel_pose_PTG_origin_wrt_sense,
+		params_abstract_ptg_navigator.evaluate_clearance);
+
+	if (params_abstract_ptg_navigator.evaluate_clearance)
 	{
-		//  STEP3(b): Build TP-Obstacles
-		// -----------------------------------------------------------------------------
-		{
-			tictac.Tic();
+		ptg->updateClearancePost(ipf.clearance, ipf.TP_Obstacles);
+	}
 
-			// Initialize TP-Obstacles:
-			const size_t Ki = ptg->getAlphaValuesCount();
-			ptg->initTPObstacles(ipf.TP_Obstacles);
-			if (params_abstract_ptg_navigator.evaluate_clearance)
-			{
-				ptg->initClearanceDiagram(ipf.clearance);
-			}
+	// Distances in TP-Space are normalized to [0,1]:
+	const double _refD = 1.0 / ptg->getRefDistance();
+	for (size_t i = 0; i < Ki; i++) ipf.TP_Obstacles[i] *= _refD;
 
-			// Implementation-dependent conversion:
-			STEP3_WSpaceToTPSpace(
-				indexPTG, ipf.TP_Obstacles, ipf.clearance,
-				mrpt::math::TPose2D(0, 0, 0) - rel_pose_PTG_origin_wrt_sense,
-				params_abstract_ptg_navigator.evaluate_clearance);
+	ipf.timeForTPObsTransformation = tic.Tac();
+}
 
-			if (params_abstract_ptg_navigator.evaluate_clearance)
-			{
-				ptg->updateClearancePost(ipf.clearance, ipf.TP_Obstacles);
-			}
+void CAbstractPTGBasedReactive::updateThreadPool()
+{
+	const unsigned int num_threads = params_abstract_ptg_navigator.num_threads;
+	if (num_threads == 1)
+	{
+		m_threadPool.reset();
+		return;
+	}
+	const size_t nThreads = num_threads != 0
+								? num_threads
+								: CWorkerThreadsPool::hardwareThreads();
+	if (!m_threadPool || m_threadPool->size() != nThreads - 1)
+		m_threadPool = std::make_shared<CWorkerThreadsPool>(nThreads - 1);
+}
 
-			// Distances in TP-Space are normalized to [0,1]:
-			const double _refD = 1.0 / ptg->getRefDistance();
-			for (size_t i = 0; i < Ki; i++) ipf.TP_Obstacles[i] *= _refD;
+void CAbstractPTGBasedReactive::build_movement_candidate(
+	CParameterizedTrajectoryGenerator* ptg, const size_t indexPTG,
+	const std::vector<mrpt::math::TPose2D>& relTargets,
+	const mrpt::math::TPose2D& rel_pose_PTG_origin_wrt_sense, TInfoPerPTG& ipf,
+	TCandidateMovementPTG& cm, CLogFileRecord& newLogRec,
+	const bool this_is_PTG_continuation,
+	mrpt::nav::CAbstractHolonomicReactiveMethod& holoMethod,
+	const mrpt::system::TTimeStamp tim_start_iteration,
+	const TNavigationParams& navp,
+	const mrpt::math::TPose2D& rel_cur_pose_wrt_last_vel_cmd_NOP)
+{
+	ASSERT_(ptg);
 
-			timeForTPObsTransformation = tictac.Tac();
-			if (m_timelogger.isEnabled())
-				m_timelogger.registerUserMeasure(
-					"navigationStep.STEP3_WSpaceToTPSpace",
-					timeForTPObsTransformation);
-		}
+	const size_t idx_in_log_infoPerPTGs =
+		this_is_PTG_continuation ? getPTG_count() : indexPTG;
+
+	CHolonomicLogFileRecord::Ptr HLFR;
+	cm.PTG = ptg;
+
+	if (!ipf.TP_Obstacles_ready)
+		build_TP_targets_and_obstacles(
+			ptg, indexPTG, relTargets, rel_pose_PTG_origin_wrt_sense, navp,
+			ipf);
+
+	const double timeForTPObsTransformation = ipf.timeForTPObsTransformation;
+	double timeForHolonomicMethod = .0;
+
+	if (!ipf.any_TPTarget_is_valid)
+	{
+		newLogRec.additional_debug_msgs[mrpt::format(
+			"mov_candidate_%u", static_cast<unsigned int>(indexPTG))] =
+			"PTG discarded since target(s) is(are) out of domain.";
+	}
+	else
+	{
+		if (m_timelogger.isEnabled())
+			m_timelogger.registerUserMeasure(
+				"navigationStep.STEP3_WSpaceToTPSpace",
+				timeForTPObsTransformation);
 
 		//  STEP4: Holonomic navigation method
 		// -----------------------------------------------------------------------------
@@ -1781,6 +1840,7 @@ void CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR_CS(enable_obstacle_filtering, bool);
 	MRPT_LOAD_CONFIG_VAR_CS(evaluate_clearance, bool);
 	MRPT_LOAD_CONFIG_VAR_CS(max_dist_for_timebased_path_prediction, double);
+	MRPT_LOAD_CONFIG_VAR_CS(num_threads, int);
 
 	MRPT_END;
 }
@@ -1858,6 +1918,10 @@ void CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::saveToConfigFile(
 		max_dist_for_timebased_path_prediction,
 		"Max dist [meters] to use time-based path prediction for NOP "
 		"evaluation");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		num_threads,
+		"Number of threads to build TP-Obstacles (0: as many as CPU cores, "
+		"1: no threads)");
 }
 
 CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::
@@ -1874,7 +1938,8 @@ CAbstractPTGBasedReactive::TAbstractPTGNavigatorParams::
 	  robot_absolute_speed_limits(),
 	  enable_obstacle_filtering(true),
 	  evaluate_clearance(false),
-	  max_dist_for_timebased_path_prediction(2.0)
+	  max_dist_for_timebased_path_prediction(2.0),
+	  num_threads(1)
 {
 }
 
@@ -1890,6 +1955,7 @@ void CAbstractPTGBasedReactive::loadConfigFile(
 	// Load my params:
 	params_abstract_ptg_navigator.loadFromConfigFile(
 		c, "CAbstractPTGBasedReactive");
+	updateThreadPool();
 
 	// Filtering:
 	if (params_abstract_ptg_navigator.enable_obstacle_filtering)
@@ -239,23 +239,35 @@ void CReactiveNavigationSystem::STEP3_WSpaceToTPSpace(
 	size_t nObs;
 	const float *xs, *ys, *zs;
 	m_WS_Obstacles.getPointsBuffer(nObs, xs, ys, zs);
+	if (!nObs) return;
 
+	// Obstacles relative to the PTG, in buffers reused between calls. This
+	// method may run in parallel for different PTGs, hence thread_local:
+	thread_local std::vector<float> oxs, oys;
+	oxs.resize(nObs);
+	oys.resize(nObs);
+	rel_pose_PTG_origin_wrt_sense.composePoints(xs, ys, nObs, &oxs[0], &oys[0]);
+
+	// Keep only those within range:
+	size_t nValid = 0;
 	for (size_t obs = 0; obs < nObs; obs++)
 	{
-		double ox, oy, oz = zs[obs];
-		rel_pose_PTG_origin_wrt_sense.composePoint(xs[obs], ys[obs], ox, oy);
-
+		const float ox = oxs[obs], oy = oys[obs], oz = zs[obs];
 		if (ox > -OBS_MAX_XY && ox < OBS_MAX_XY && oy > -OBS_MAX_XY &&
 			oy < OBS_MAX_XY && oz >= params_reactive_nav.min_obstacles_height &&
 			oz <= params_reactive_nav.max_obstacles_height)
 		{
-			ptg->updateTPObstacle(ox, oy, out_TPObstacles);
-			if (eval_clearance)
-			{
-				ptg->updateClearance(ox, oy, out_clearance);
-			}
+			oxs[nValid] = ox;
+			oys[nValid] = oy;
+			nValid++;
 		}
 	}
+
+	ptg->updateTPObstacleBatch(
+		&oxs[0], &oys[0], nValid, out_TPObstacles, getThreadPool());
+	if (eval_clearance)
+		ptg->updateClearanceBatch(
+			&oxs[0], &oys[0], nValid, out_clearance, getThreadPool());
 }
 
 /** Generates a pointcloud of obstacles, and the robot shape, to be saved in the
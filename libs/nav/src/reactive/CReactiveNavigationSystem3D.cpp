@@ -270,25 +270,29 @@ void CReactiveNavigationSystem3D::STEP3_WSpaceToTPSpace(
 	const mrpt::poses::CPose2D rel_pose_PTG_origin_wrt_sense(
 		rel_pose_PTG_origin_wrt_sense_);
 
+	// Obstacles relative to the PTG, in buffers reused between calls. This
+	// method may run in parallel for different PTGs, hence thread_local:
+	thread_local std::vector<float> oxs, oys;
+
 	for (size_t j = 0; j < m_robotShape.size(); j++)
 	{
 		size_t nObs;
 		const float *xs, *ys, *zs;
 		m_WS_Obstacles_inlevels[j].getPointsBuffer(nObs, xs, ys, zs);
-
-		for (size_t obs = 0; obs < nObs; obs++)
-		{
-			double ox, oy;
-			rel_pose_PTG_origin_wrt_sense.composePoint(
-				xs[obs], ys[obs], ox, oy);
-			m_ptgmultilevel[ptg_idx].PTGs[j]->updateTPObstacle(
-				ox, oy, out_TPObstacles);
-			if (eval_clearance)
-			{
-				m_ptgmultilevel[ptg_idx].PTGs[j]->updateClearance(
-					ox, oy, out_clearance);
-			}
-		}
+		if (!nObs) continue;
+
+		oxs.resize(nObs);
+		oys.resize(nObs);
+		rel_pose_PTG_origin_wrt_sense.composePoints(
+			xs, ys, nObs, &oxs[0], &oys[0]);
+
+		CParameterizedTrajectoryGenerator* ptg =
+			m_ptgmultilevel[ptg_idx].PTGs[j];
+		ptg->updateTPObstacleBatch(
+			&oxs[0], &oys[0], nObs, out_TPObstacles, getThreadPool());
+		if (eval_clearance)
+			ptg->updateClearanceBatch(
+				&oxs[0], &oys[0], nObs, out_clearance, getThreadPool());
 	}
 
 	// Distances in TP-Space are normalized to [0,1]
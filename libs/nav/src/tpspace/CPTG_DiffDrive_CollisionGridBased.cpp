@@ -13,12 +13,25 @@
 
 #include <mrpt/io/CFileGZInputStream.h>
 #include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/CMemoryMappedFile.h>
+#include <mrpt/io/CMemoryStream.h>
+#include <mrpt/system/filesystem.h>
 #include <mrpt/system/CTicTac.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <mrpt/math/geometry.h>
 #include <mrpt/serialization/stl_serialization.h>
 #include <mrpt/kinematics/CVehicleVelCmd_DiffDriven.h>
 #include <mrpt/serialization/CArchive.h>
+#include <atomic>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+#ifdef _WIN32
+#include <process.h>  // _getpid()
+#else
+#include <unistd.h>  // getpid()
+#endif
 
 using namespace mrpt::nav;
 
@@ -286,16 +299,80 @@ mrpt::kinematics::CVehicleVelCmd::Ptr
 	return mrpt::kinematics::CVehicleVelCmd::Ptr(cmd);
 }
 
+/** The compact layout of the collision grid: the (k,dist) pairs of the cell
+ * with index `i` are `k[j]`, `dist[j]` for `j` in `[offsets[i],
+ * offsets[i+1])`. Arrays are either owned or point into a mapped file. */
+struct CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::TCompactCells
+{
+	uint32_t num_cells = 0;
+	const uint32_t* offsets = nullptr;
+	const uint16_t* k = nullptr;
+	const float* dist = nullptr;
+
+	std::vector<uint32_t> own_offsets;
+	std::vector<uint16_t> own_k;
+	std::vector<float> own_dist;
+	mrpt::io::CMemoryMappedFile mapped_file;
+};
+
 /*---------------------------------------------------------------
 					getTPObstacle
   ---------------------------------------------------------------*/
-const CPTG_DiffDrive_CollisionGridBased::TCollisionCell&
+CPTG_DiffDrive_CollisionGridBased::TCollisionCellView
 	CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::getTPObstacle(
 		const float obsX, const float obsY) const
 {
-	static const TCollisionCell emptyCell;
-	const TCollisionCell* cell = cellByPos(obsX, obsY);
-	return cell != nullptr ? *cell : emptyCell;
+	TCollisionCellView cell{nullptr, nullptr, 0};
+	const int cx = x2idx(obsX), cy = y2idx(obsY);
+	if (!m_compact || cx < 0 || cx >= static_cast<int>(m_size_x) || cy < 0 ||
+		cy >= static_cast<int>(m_size_y))
+		return cell;
+	const size_t idx = cx + cy * m_size_x;
+	if (idx >= m_compact->num_cells) return cell;
+
+	const uint32_t first = m_compact->offsets[idx];
+	cell.k = m_compact->k + first;
+	cell.dist = m_compact->dist + first;
+	cell.size = m_compact->offsets[idx + 1] - first;
+	return cell;
+}
+
+void CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::compact()
+{
+	auto c = std::make_shared<TCompactCells>();
+	c->num_cells = m_map.size();
+	c->own_offsets.resize(c->num_cells + 1);
+	uint32_t nEntries = 0;
+	for (uint32_t i = 0; i < c->num_cells; i++)
+	{
+		c->own_offsets[i] = nEntries;
+		nEntries += m_map[i].size();
+	}
+	c->own_offsets[c->num_cells] = nEntries;
+
+	c->own_k.resize(nEntries);
+	c->own_dist.resize(nEntries);
+	for (uint32_t i = 0; i < c->num_cells; i++)
+	{
+		const uint32_t first = c->own_offsets[i];
+		for (size_t j = 0; j < m_map[i].size(); j++)
+		{
+			c->own_k[first + j] = m_map[i][j].first;
+			c->own_dist[first + j] = m_map[i][j].second;
+		}
+	}
+	c->offsets = &c->own_offsets[0];
+	c->k = c->own_k.data();
+	c->dist = c->own_dist.data();
+	m_compact = c;
+
+	// The cells are not needed anymore:
+	std::vector<TCollisionCell>().swap(m_map);
+}
+
+bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::isMapped() const
+{
+	return m_compact && m_compact->mapped_file.isOpen();
 }
 
 /*---------------------------------------------------------------
@@ -329,6 +406,18 @@ void CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::updateCellInfo(
 	}
 }
 
+/** The name of the cache file in the compact format for a given (former)
+ * cache file name: the same one, without the `.gz` extension. */
+static std::string compactCacheFileName(const std::string& filename)
+{
+	const std::string gz_ext = ".gz";
+	if (filename.size() > gz_ext.size() &&
+		filename.compare(
+			filename.size() - gz_ext.size(), gz_ext.size(), gz_ext) == 0)
+		return filename.substr(0, filename.size() - gz_ext.size());
+	return filename;
+}
+
 /*---------------------------------------------------------------
 					Save to file
   ---------------------------------------------------------------*/
@@ -336,20 +425,8 @@ bool CPTG_DiffDrive_CollisionGridBased::saveColGridsToFile(
 	const std::string& filename,
 	const mrpt::math::CPolygon& computed_robotShape) const
 {
-	try
-	{
-		mrpt::io::CFileGZOutputStream fo(filename);
-		if (!fo.fileOpenCorrectly()) return false;
-
-		const uint32_t n = 1;  // for backwards compatibility...
-		auto arch = mrpt::serialization::archiveFrom(fo);
-		arch << n;
-		return m_collisionGrid.saveToFile(&arch, computed_robotShape);
-	}
-	catch (...)
-	{
-		return false;
-	}
+	return m_collisionGrid.saveToFile(
+		compactCacheFileName(filename), computed_robotShape);
 }
 
 /*---------------------------------------------------------------
@@ -358,8 +435,14 @@ bool CPTG_DiffDrive_CollisionGridBased::saveColGridsToFile(
 bool CPTG_DiffDrive_CollisionGridBased::loadColGridsFromFile(
 	const std::string& filename, const mrpt::math::CPolygon& current_robotShape)
 {
+	if (m_collisionGrid.loadFromFile(
+			compactCacheFileName(filename), current_robotShape))
+		return true;
+
+	// Try with the former file format and, if found, convert it:
 	try
 	{
+		if (!mrpt::system::fileExists(filename)) return false;
 		mrpt::io::CFileGZInputStream fi(filename);
 		if (!fi.fileOpenCorrectly()) return false;
 		auto arch = mrpt::serialization::archiveFrom(fi);
@@ -370,55 +453,183 @@ bool CPTG_DiffDrive_CollisionGridBased::loadColGridsFromFile(
 			return false;  // Incompatible (old) format, just discard and
 		// recompute.
 
-		return m_collisionGrid.loadFromFile(&arch, current_robotShape);
+		if (!m_collisionGrid.loadFromLegacyFile(&arch, current_robotShape))
+			return false;
 	}
 	catch (...)
 	{
 		return false;
 	}
+	saveColGridsToFile(filename, current_robotShape);
+	return true;
 }
 
 const uint32_t COLGRID_FILE_MAGIC = 0xC0C0C0C3;
+/** v1: As of jun 2012, v2: As of dec-2013 (gz-compressed),
+ * v3: compact, mapped layout (as of MRPT 2.0.0) */
+const uint8_t COLGRID_FILE_VERSION = 3;
+/** Written as raw bytes, to detect files from a different endianness */
+const uint32_t COLGRID_FILE_BYTE_ORDER_MARK = 0x01020304;
+/** Alignment of the arrays in the file (wrt its start) */
+const size_t COLGRID_FILE_ARRAYS_ALIGN = 8;
+
+void CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::saveHeader(
+	mrpt::serialization::CArchive& f, const uint8_t version,
+	const mrpt::math::CPolygon& computed_robotShape) const
+{
+	// Save magic signature && serialization version:
+	f << COLGRID_FILE_MAGIC << version;
+
+	// Robot shape:
+	f << computed_robotShape;
+
+	// and standard PTG data:
+	f << m_parent->getDescription() << m_parent->getAlphaValuesCount()
+	  << static_cast<float>(m_parent->getMax_V())
+	  << static_cast<float>(m_parent->getMax_W());
+
+	f << m_x_min << m_x_max << m_y_min << m_y_max;
+	f << m_resolution;
+}
+
+bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadAndCheckHeader(
+	mrpt::serialization::CArchive& f, const uint8_t version,
+	const mrpt::math::CPolygon& current_robotShape) const
+{
+	// Return false if the file contents doesn't match what we expected:
+	uint32_t file_magic;
+	f >> file_magic;
+
+	// It doesn't seem to be a valid file or was in an old format, just
+	// recompute the grid:
+	if (COLGRID_FILE_MAGIC != file_magic) return false;
+
+	// Unknown version: Maybe we are loading a file from a more recent version
+	// of MRPT? Whatever, we can't read it: It's safer just to re-generate the
+	// PTG data
+	uint8_t serialized_version;
+	f >> serialized_version;
+	if (serialized_version != version) return false;
+
+	mrpt::math::CPolygon stored_shape;
+	f >> stored_shape;
+
+	const bool shapes_match =
+		(stored_shape.size() == current_robotShape.size() &&
+		 std::equal(
+			 stored_shape.begin(), stored_shape.end(),
+			 current_robotShape.begin()));
+
+	if (!shapes_match)
+		return false;  // Must recompute if the robot shape changed.
+
+	// Standard PTG data:
+	const std::string expected_desc = m_parent->getDescription();
+	std::string desc;
+	f >> desc;
+	if (desc != expected_desc) return false;
+
+// and standard PTG data:
+#define READ_UINT16_CHECK_IT_MATCHES_STORED(_VAR) \
+	{                                             \
+		uint16_t ff;                              \
+		f >> ff;                                  \
+		if (ff != _VAR) return false;             \
+	}
+#define READ_FLOAT_CHECK_IT_MATCHES_STORED(_VAR)       \
+	{                                                  \
+		float ff;                                      \
+		f >> ff;                                       \
+		if (std::abs(ff - _VAR) > 1e-4f) return false; \
+	}
+#define READ_DOUBLE_CHECK_IT_MATCHES_STORED(_VAR)     \
+	{                                                 \
+		double ff;                                    \
+		f >> ff;                                      \
+		if (std::abs(ff - _VAR) > 1e-6) return false; \
+	}
+
+	READ_UINT16_CHECK_IT_MATCHES_STORED(m_parent->getAlphaValuesCount())
+	READ_FLOAT_CHECK_IT_MATCHES_STORED(m_parent->getMax_V())
+	READ_FLOAT_CHECK_IT_MATCHES_STORED(m_parent->getMax_W())
+
+	// Cell dimensions:
+	READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_x_min)
+	READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_x_max)
+	READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_y_min)
+	READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_y_max)
+	READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_resolution)
+
+	// OK, all parameters seem to be exactly the same than when we
+	// precomputed the table.
+	return true;
+}
 
 /*---------------------------------------------------------------
 					Save to file
   ---------------------------------------------------------------*/
 bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::saveToFile(
-	mrpt::serialization::CArchive* f,
+	const std::string& filename,
 	const mrpt::math::CPolygon& computed_robotShape) const
 {
 	try
 	{
-		if (!f) return false;
-
-		const uint8_t serialize_version =
-			2;  // v1: As of jun 2012, v2: As of dec-2013
-
-		// Save magic signature && serialization version:
-		*f << COLGRID_FILE_MAGIC << serialize_version;
-
-		// Robot shape:
-		*f << computed_robotShape;
-
-		// and standard PTG data:
-		*f << m_parent->getDescription() << m_parent->getAlphaValuesCount()
-		   << static_cast<float>(m_parent->getMax_V())
-		   << static_cast<float>(m_parent->getMax_W());
-
-		*f << m_x_min << m_x_max << m_y_min << m_y_max;
-		*f << m_resolution;
-
-		// v1 was:  *f << m_map;
-		uint32_t N = m_map.size();
-		*f << N;
-		for (uint32_t i = 0; i < N; i++)
+		if (!m_compact || filename.empty()) return false;
+		// Don't overwrite the file we may be mapping right now:
+		if (m_compact->mapped_file.isOpen()) return true;
+
+		// File format:
+		//  - Header (CArchive serialization)
+		//  - Grid size and number of (k,dist) entries (CArchive)
+		//  - Byte order mark (raw)
+		//  - Zero padding up to COLGRID_FILE_ARRAYS_ALIGN
+		//  - Arrays of cell offsets, distances and k's (raw)
+		// Written into a temporary file which then replaces the former one, so
+		// other processes which may be mapping it keep a valid copy. Its name
+		// is unique to this process and call, so concurrent writers of the
+		// same cache never write into the same temporary file:
+		static std::atomic<unsigned int> tmp_counter{0};
+#ifdef _WIN32
+		const int pid = _getpid();
+#else
+		const int pid = static_cast<int>(getpid());
+#endif
+		const std::string tmp_filename = mrpt::format(
+			"%s.%i.%u.tmp", filename.c_str(), pid, tmp_counter++);
 		{
-			uint32_t M = m_map[i].size();
-			*f << M;
-			for (uint32_t k = 0; k < M; k++)
-				*f << m_map[i][k].first << m_map[i][k].second;
+			mrpt::io::CFileOutputStream fo;
+			if (!fo.open(tmp_filename)) return false;
+			auto f = mrpt::serialization::archiveFrom(fo);
+
+			saveHeader(f, COLGRID_FILE_VERSION, computed_robotShape);
+
+			const uint32_t nCells = m_compact->num_cells;
+			const uint32_t nEntries = m_compact->offsets[nCells];
+			f << static_cast<uint32_t>(m_size_x)
+			  << static_cast<uint32_t>(m_size_y) << nEntries;
+
+			fo.Write(
+				&COLGRID_FILE_BYTE_ORDER_MARK,
+				sizeof(COLGRID_FILE_BYTE_ORDER_MARK));
+			const uint8_t zeros[COLGRID_FILE_ARRAYS_ALIGN] = {0};
+			fo.Write(
+				zeros, (COLGRID_FILE_ARRAYS_ALIGN -
+						fo.getPosition() % COLGRID_FILE_ARRAYS_ALIGN) %
+						   COLGRID_FILE_ARRAYS_ALIGN);
+
+			fo.Write(m_compact->offsets, sizeof(uint32_t) * (nCells + 1));
+			fo.Write(m_compact->dist, sizeof(float) * nEntries);
+			fo.Write(m_compact->k, sizeof(uint16_t) * nEntries);
+		}
+#ifdef _WIN32
+		// rename() does not replace existing files in Windows:
+		mrpt::system::deleteFile(filename);
+#endif
+		if (!mrpt::system::renameFile(tmp_filename, filename))
+		{
+			mrpt::system::deleteFile(tmp_filename);
+			return false;
 		}
-
 		return true;
 	}
 	catch (...)
@@ -431,89 +642,79 @@ bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::saveToFile(
 						loadFromFile
   ---------------------------------------------------------------*/
 bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadFromFile(
-	mrpt::serialization::CArchive* f,
-	const mrpt::math::CPolygon& current_robotShape)
+	const std::string& filename, const mrpt::math::CPolygon& current_robotShape)
 {
 	try
 	{
-		if (!f) return false;
-
-		// Return false if the file contents doesn't match what we expected:
-		uint32_t file_magic;
-		*f >> file_magic;
-
-		// It doesn't seem to be a valid file or was in an old format, just
-		// recompute the grid:
-		if (COLGRID_FILE_MAGIC != file_magic) return false;
-
-		uint8_t serialized_version;
-		*f >> serialized_version;
-
-		switch (serialized_version)
-		{
-			case 2:
-			{
-				mrpt::math::CPolygon stored_shape;
-				*f >> stored_shape;
-
-				const bool shapes_match =
-					(stored_shape.size() == current_robotShape.size() &&
-					 std::equal(
-						 stored_shape.begin(), stored_shape.end(),
-						 current_robotShape.begin()));
-
-				if (!shapes_match)
-					return false;  // Must recompute if the robot shape changed.
-			}
-			break;
-
-			case 1:
-			default:
-				// Unknown version: Maybe we are loading a file from a more
-				// recent version of MRPT? Whatever, we can't read it: It's
-				// safer just to re-generate the PTG data
-				return false;
-		};
-
-		// Standard PTG data:
-		const std::string expected_desc = m_parent->getDescription();
-		std::string desc;
-		*f >> desc;
-		if (desc != expected_desc) return false;
-
-// and standard PTG data:
-#define READ_UINT16_CHECK_IT_MATCHES_STORED(_VAR) \
-	{                                             \
-		uint16_t ff;                              \
-		*f >> ff;                                 \
-		if (ff != _VAR) return false;             \
+		if (!mrpt::system::fileExists(filename)) return false;
+
+		auto c = std::make_shared<TCompactCells>();
+		if (!c->mapped_file.open(filename)) return false;
+		const uint8_t* data = c->mapped_file.data();
+		const size_t len = c->mapped_file.size();
+
+		mrpt::io::CMemoryStream ms;
+		ms.assignMemoryNotOwn(data, len);
+		auto f = mrpt::serialization::archiveFrom(ms);
+
+		if (!loadAndCheckHeader(f, COLGRID_FILE_VERSION, current_robotShape))
+			return false;
+
+		uint32_t size_x, size_y, nEntries;
+		f >> size_x >> size_y >> nEntries;
+		if (size_x != m_size_x || size_y != m_size_y) return false;
+		const size_t nCells = size_t(size_x) * size_y;
+
+		size_t pos = ms.getPosition();
+		uint32_t bom;
+		if (pos + sizeof(bom) > len) return false;
+		std::memcpy(&bom, data + pos, sizeof(bom));
+		if (bom != COLGRID_FILE_BYTE_ORDER_MARK) return false;
+		pos += sizeof(bom);
+		pos += (COLGRID_FILE_ARRAYS_ALIGN - pos % COLGRID_FILE_ARRAYS_ALIGN) %
+			   COLGRID_FILE_ARRAYS_ALIGN;
+
+		const size_t pos_dist = pos + sizeof(uint32_t) * (nCells + 1);
+		const size_t pos_k = pos_dist + sizeof(float) * nEntries;
+		if (pos_k + sizeof(uint16_t) * nEntries != len) return false;
+
+		c->num_cells = nCells;
+		c->offsets = reinterpret_cast<const uint32_t*>(data + pos);
+		c->dist = reinterpret_cast<const float*>(data + pos_dist);
+		c->k = reinterpret_cast<const uint16_t*>(data + pos_k);
+		// Sanity check, so we never read beyond the arrays: offsets must be
+		// non-decreasing, start at 0 and end at nEntries.
+		if (c->offsets[0] != 0 || c->offsets[nCells] != nEntries) return false;
+		for (size_t i = 0; i < nCells; i++)
+			if (c->offsets[i] > c->offsets[i + 1]) return false;
+
+		m_compact = c;
+		std::vector<TCollisionCell>().swap(m_map);
+		return true;
 	}
-#define READ_FLOAT_CHECK_IT_MATCHES_STORED(_VAR)       \
-	{                                                  \
-		float ff;                                      \
-		*f >> ff;                                      \
-		if (std::abs(ff - _VAR) > 1e-4f) return false; \
+	catch (std::exception& e)
+	{
+		std::cerr << "[CCollisionGrid::loadFromFile] " << e.what();
+		return false;
 	}
-#define READ_DOUBLE_CHECK_IT_MATCHES_STORED(_VAR)     \
-	{                                                 \
-		double ff;                                    \
-		*f >> ff;                                     \
-		if (std::abs(ff - _VAR) > 1e-6) return false; \
+	catch (...)
+	{
+		return false;
 	}
+}
 
-		READ_UINT16_CHECK_IT_MATCHES_STORED(m_parent->getAlphaValuesCount())
-		READ_FLOAT_CHECK_IT_MATCHES_STORED(m_parent->getMax_V())
-		READ_FLOAT_CHECK_IT_MATCHES_STORED(m_parent->getMax_W())
-
-		// Cell dimensions:
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_x_min)
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_x_max)
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_y_min)
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_y_max)
-		READ_DOUBLE_CHECK_IT_MATCHES_STORED(m_resolution)
+/*---------------------------------------------------------------
+						loadFromLegacyFile
+  ---------------------------------------------------------------*/
+bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadFromLegacyFile(
+	mrpt::serialization::CArchive* f,
+	const mrpt::math::CPolygon& current_robotShape)
+{
+	try
+	{
+		if (!f) return false;
+		if (!loadAndCheckHeader(*f, 2, current_robotShape)) return false;
 
-		// OK, all parameters seem to be exactly the same than when we
-		// precomputed the table: load it.
 		// v1 was:  *f >> m_map;
 		uint32_t N;
 		*f >> N;
@@ -527,11 +728,12 @@ bool CPTG_DiffDrive_CollisionGridBased::CCollisionGrid::loadFromFile(
 				*f >> m_map[i][k].first >> m_map[i][k].second;
 		}
 
+		compact();
 		return true;
 	}
 	catch (std::exception& e)
 	{
-		std::cerr << "[CCollisionGrid::loadFromFile] " << e.what();
+		std::cerr << "[CCollisionGrid::loadFromLegacyFile] " << e.what();
 		return false;
 	}
 	catch (...)
@@ -829,6 +1031,8 @@ void CPTG_DiffDrive_CollisionGridBased::internal_initialize(
 
 		if (verbose) cout << format("Done! [%.03f sec]\n", tictac.Tac());
 
+		m_collisionGrid.compact();
+
 		// save it to the cache file for the next run:
 		saveColGridsToFile(cacheFilename, m_robotShape);
 
@@ -889,25 +1093,72 @@ void CPTG_DiffDrive_CollisionGridBased::updateTPObstacle(
 	double ox, double oy, std::vector<double>& tp_obstacles) const
 {
 	ASSERTMSG_(!m_trajectory.empty(), "PTG has not been initialized!");
-	const TCollisionCell& cell = m_collisionGrid.getTPObstacle(ox, oy);
+	const TCollisionCellView cell = m_collisionGrid.getTPObstacle(ox, oy);
 	// Keep the minimum distance:
-	for (TCollisionCell::const_iterator i = cell.begin(); i != cell.end(); ++i)
+	for (uint32_t i = 0; i < cell.size; i++)
+	{
+		const double dist = cell.dist[i];
+		internal_TPObsDistancePostprocess(
+			ox, oy, dist, tp_obstacles[cell.k[i]]);
+	}
+}
+
+void CPTG_DiffDrive_CollisionGridBased::updateTPObstacleBatch(
+	const float* ox, const float* oy, const size_t N,
+	std::vector<double>& tp_obstacles,
+	mrpt::system::CWorkerThreadsPool* pool) const
+{
+	ASSERTMSG_(!m_trajectory.empty(), "PTG has not been initialized!");
+
+	const auto processPoints = [&](
+		size_t first, size_t last, std::vector<double>& tp_obs) {
+		for (size_t i = first; i < last; i++)
+		{
+			const TCollisionCellView cell =
+				m_collisionGrid.getTPObstacle(ox[i], oy[i]);
+			for (uint32_t j = 0; j < cell.size; j++)
+				internal_TPObsDistancePostprocess(
+					ox[i], oy[i], cell.dist[j], tp_obs[cell.k[j]]);
+		}
+	};
+
+	// Fewer points than this are not worth the overhead of the threads:
+	const size_t min_chunk = 512;
+	if (!pool || !pool->size() || N < 2 * min_chunk)
 	{
-		const double dist = i->second;
-		internal_TPObsDistancePostprocess(ox, oy, dist, tp_obstacles[i->first]);
+		processPoints(0, N, tp_obstacles);
+		return;
 	}
+
+	// Each chunk of points is processed into its own copy of the obstacle
+	// ranges, which are then merged. Since all the updates of
+	// internal_TPObsDistancePostprocess() can only decrease the ranges, the
+	// merged minimum is exactly the serial result, regardless of the order.
+	const std::vector<double> tp_obs_init = tp_obstacles;
+	std::mutex merge_mtx;
+	pool->parallel_for(
+		N,
+		[&](size_t first, size_t last) {
+			thread_local std::vector<double> tp_obs_chunk;
+			tp_obs_chunk = tp_obs_init;
+			processPoints(first, last, tp_obs_chunk);
+			std::lock_guard<std::mutex> lck(merge_mtx);
+			for (size_t k = 0; k < tp_obs_chunk.size(); k++)
+				mrpt::keep_min(tp_obstacles[k], tp_obs_chunk[k]);
+		},
+		min_chunk);
 }
 
 void CPTG_DiffDrive_CollisionGridBased::updateTPObstacleSingle(
 	double ox, double oy, uint16_t k, double& tp_obstacle_k) const
 {
 	ASSERTMSG_(!m_trajectory.empty(), "PTG has not been initialized!");
-	const TCollisionCell& cell = m_collisionGrid.getTPObstacle(ox, oy);
+	const TCollisionCellView cell = m_collisionGrid.getTPObstacle(ox, oy);
 	// Keep the minimum distance:
-	for (TCollisionCell::const_iterator i = cell.begin(); i != cell.end(); ++i)
-		if (i->first == k)
+	for (uint32_t i = 0; i < cell.size; i++)
+		if (cell.k[i] == k)
 		{
-			const double dist = i->second;
+			const double dist = cell.dist[i];
 			internal_TPObsDistancePostprocess(ox, oy, dist, tp_obstacle_k);
 		}
 }
@@ -14,6 +14,9 @@
 #include <mrpt/system/filesystem.h>
 #include <mrpt/system/os.h>
 #include <mrpt/opengl/CSetOfLines.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <algorithm>
+#include <array>
 
 using namespace mrpt::nav;
 
@@ -413,6 +416,16 @@ void CParameterizedTrajectoryGenerator::deinitialize()
 	m_is_initialized = false;
 }
 
+void CParameterizedTrajectoryGenerator::updateTPObstacleBatch(
+	const float* ox, const float* oy, const size_t N,
+	std::vector<double>& tp_obstacles,
+	mrpt::system::CWorkerThreadsPool* pool) const
+{
+	MRPT_UNUSED_PARAM(pool);
+	for (size_t i = 0; i < N; i++)
+		this->updateTPObstacle(ox[i], oy[i], tp_obstacles);
+}
+
 void CParameterizedTrajectoryGenerator::internal_TPObsDistancePostprocess(
 	const double ox, const double oy, const double new_tp_obs_dist,
 	double& inout_tp_obs) const
@@ -497,6 +510,119 @@ void CParameterizedTrajectoryGenerator::updateClearance(
 	}
 }
 
+void CParameterizedTrajectoryGenerator::updateClearanceBatch(
+	const float* ox, const float* oy, const size_t N, ClearanceDiagram& cd,
+	mrpt::system::CWorkerThreadsPool* pool) const
+{
+	ASSERT_(cd.get_actual_num_paths() == m_alphaValuesCount);
+	ASSERT_(m_clearance_num_points > 0 && m_clearance_num_points < 10000);
+	if (!N) return;
+
+	const size_t num_decim_paths = cd.get_decimated_num_paths();
+	const double R = this->getMaxRobotRadius();
+	// Safety margin [m] for the lower bounds of clearance, to absorb any
+	// round-off difference wrt the exact evaluation:
+	const double BOUND_MARGIN = 1e-6;
+
+	// getPathStepCount() may update internal caches in some PTGs, so
+	// call it here, from one single thread:
+	std::vector<size_t> num_path_steps(num_decim_paths);
+	for (size_t decim_k = 0; decim_k < num_decim_paths; decim_k++)
+		num_path_steps[decim_k] =
+			getPathStepCount(cd.decimated_k_to_real_k(decim_k));
+
+	// Same algorithm than evalClearanceSingleObstacle(), with all obstacles
+	// evaluated against one path at once:
+	auto processPaths = [&](size_t first, size_t last) {
+		// Per path step: robot pose (x,y,cos(phi),sin(phi)) and clearance:
+		thread_local std::vector<std::array<double, 4>> poses;
+		thread_local std::vector<double> cl;
+
+		for (size_t decim_k = first; decim_k < last; decim_k++)
+		{
+			const auto real_k = cd.decimated_k_to_real_k(decim_k);
+			auto& cl_map = cd.get_path_clearance_decimated(decim_k);
+			const size_t M = cl_map.size();
+			const size_t numPathSteps = num_path_steps[decim_k];
+			ASSERT_(numPathSteps > M);
+			const double numStepsPerIncr = (numPathSteps - 1.0) / M;
+
+			poses.resize(M);
+			cl.resize(M);
+			double step_pointer_dbl = 0.0, max_cl = 0.0;
+			double min_x = 0, max_x = 0, min_y = 0, max_y = 0;
+			size_t s = 0;
+			for (const auto& e : cl_map)
+			{
+				step_pointer_dbl += numStepsPerIncr;
+				const size_t step = mrpt::round(step_pointer_dbl);
+				mrpt::math::TPose2D pose;
+				this->getPathPose(real_k, step, pose);
+				poses[s] = {pose.x, pose.y, ::cos(pose.phi), ::sin(pose.phi)};
+				cl[s] = e.second;
+				mrpt::keep_max(max_cl, e.second);
+				if (!s || pose.x < min_x) min_x = pose.x;
+				if (!s || pose.x > max_x) max_x = pose.x;
+				if (!s || pose.y < min_y) min_y = pose.y;
+				if (!s || pose.y > max_y) max_y = pose.y;
+				s++;
+			}
+
+			// Circle bounding all the robot poses in this path:
+			const double cx = 0.5 * (min_x + max_x), cy = 0.5 * (min_y + max_y);
+			double rad = 0;
+			for (const auto& p : poses)
+				mrpt::keep_max(rad, mrpt::hypot_fast(p[0] - cx, p[1] - cy));
+
+			for (size_t i = 0; i < N; i++)
+			{
+				const double gx = ox[i], gy = oy[i];
+
+				// Early exit #1: the obstacle is too far from the whole path:
+				const double path_lb =
+					mrpt::hypot_fast(gx - cx, gy - cy) - rad - R - BOUND_MARGIN;
+				if (path_lb > 0 && path_lb / refDistance >= max_cl) continue;
+
+				bool changed = false;
+				for (s = 0; s < M; s++)
+				{
+					const auto& p = poses[s];
+					const double Ax = gx - p[0], Ay = gy - p[1];
+
+					// Early exit #2: too far from this particular pose:
+					const double lb =
+						mrpt::hypot_fast(Ax, Ay) - R - BOUND_MARGIN;
+					if (lb > 0 && lb / refDistance >= cl[s]) continue;
+
+					// Obstacle in the robot frame, exactly as
+					// TPose2D::inverseComposePoint():
+					const double olx = Ax * p[2] + Ay * p[3],
+								 oly = -Ax * p[3] + Ay * p[2];
+					const double this_clearance =
+						this->evalClearanceToRobotShape(olx, oly);
+					changed = true;
+					if (this_clearance <= .0)
+					{
+						// Collision: the rest of the path is not reachable.
+						for (; s < M; s++) cl[s] = .0;
+						break;
+					}
+					mrpt::keep_min(cl[s], this_clearance / refDistance);
+				}
+				if (changed) max_cl = *std::max_element(cl.begin(), cl.end());
+			}
+
+			s = 0;
+			for (auto& e : cl_map) e.second = cl[s++];
+		}
+	};
+
+	if (!pool || num_decim_paths < 2)
+		processPaths(0, num_decim_paths);
+	else
+		pool->parallel_for(num_decim_paths, processPaths);
+}
+
 void CParameterizedTrajectoryGenerator::updateClearancePost(
 	ClearanceDiagram& cd, const std::vector<double>& TP_obstacles) const
 {
@@ -8,8 +8,10 @@
    +------------------------------------------------------------------------+ */
 
 #include <mrpt/nav/tpspace/CParameterizedTrajectoryGenerator.h>
+#include <mrpt/nav/tpspace/CPTG_DiffDrive_CollisionGridBased.h>
 #include <mrpt/config/CConfigFile.h>
 #include <mrpt/system/filesystem.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <gtest/gtest.h>
 
 // Defined in tests/test_main.cpp
@@ -184,6 +186,55 @@ TEST(NavTests, PTGs_tests)
 			EXPECT_TRUE(any_change_all);
 		}
 
+		// TEST: TP_obstacles, batch version (serial and threaded) must give
+		// exactly the same result than point by point:
+		{
+			std::vector<float> oxs, oys;
+			for (float ox = -refDist * 0.5f; ox < refDist * 0.5f; ox += 0.05f)
+				for (float oy = -refDist * 0.5f; oy < refDist * 0.5f;
+					 oy += 0.05f)
+				{
+					oxs.push_back(ox);
+					oys.push_back(oy);
+				}
+
+			std::vector<double> TP_obs_ref, TP_obs_batch, TP_obs_threads;
+			ptg->initTPObstacles(TP_obs_ref);
+			ptg->initTPObstacles(TP_obs_batch);
+			ptg->initTPObstacles(TP_obs_threads);
+			for (size_t i = 0; i < oxs.size(); i++)
+				ptg->updateTPObstacle(oxs[i], oys[i], TP_obs_ref);
+
+			mrpt::system::CWorkerThreadsPool pool(3);
+			ptg->updateTPObstacleBatch(
+				&oxs[0], &oys[0], oxs.size(), TP_obs_batch);
+			ptg->updateTPObstacleBatch(
+				&oxs[0], &oys[0], oxs.size(), TP_obs_threads, &pool);
+			EXPECT_EQ(TP_obs_ref, TP_obs_batch) << "PTG: " << sPTGDesc;
+			EXPECT_EQ(TP_obs_ref, TP_obs_threads) << "PTG: " << sPTGDesc;
+			num_tests_run++;
+
+			// Same for the clearance diagram:
+			mrpt::nav::ClearanceDiagram cd_ref, cd_batch, cd_threads;
+			ptg->initClearanceDiagram(cd_ref);
+			ptg->initClearanceDiagram(cd_batch);
+			ptg->initClearanceDiagram(cd_threads);
+			for (size_t i = 0; i < oxs.size(); i++)
+				ptg->updateClearance(oxs[i], oys[i], cd_ref);
+			ptg->updateClearanceBatch(&oxs[0], &oys[0], oxs.size(), cd_batch);
+			ptg->updateClearanceBatch(
+				&oxs[0], &oys[0], oxs.size(), cd_threads, &pool);
+			for (size_t k = 0; k < cd_ref.get_decimated_num_paths(); k++)
+			{
+				const auto& cl_ref = cd_ref.get_path_clearance_decimated(k);
+				EXPECT_EQ(cl_ref, cd_batch.get_path_clearance_decimated(k))
+					<< "PTG: " << sPTGDesc << " decimated k=" << k;
+				EXPECT_EQ(cl_ref, cd_threads.get_path_clearance_decimated(k))
+					<< "PTG: " << sPTGDesc << " decimated k=" << k;
+			}
+			num_tests_run++;
+		}
+
 		printf(
 			"PTG `%50s` run %6u tests.\n", sPTGDesc.c_str(),
 			(unsigned int)num_tests_run);
@@ -193,3 +244,68 @@ TEST(NavTests, PTGs_tests)
 	// Clean up:
 	for (unsigned int n = 0; n < PTG_COUNT; n++) delete PTGs[n];
 }
+
+TEST(NavTests, PTGs_collision_grid_cache)
+{
+	using namespace std;
+	using namespace mrpt;
+	using namespace mrpt::nav;
+
+	const string sFil = mrpt::MRPT_GLOBAL_UNITTEST_SRC_DIR +
+						string("/tests/PTGs_for_tests.ini");
+	if (!mrpt::system::fileExists(sFil))
+	{
+		cerr << "**WARNING* Skipping tests since file cannot be found: '"
+			 << sFil << "'\n";
+		return;
+	}
+	mrpt::config::CConfigFile cfg(sFil);
+
+	const unsigned int PTG_COUNT =
+		cfg.read_int("PTG_UNIT_TESTS", "PTG_COUNT", 0, true);
+	for (unsigned int n = 0; n < PTG_COUNT; n++)
+	{
+		const string sPTGName = cfg.read_string(
+			"PTG_UNIT_TESTS", format("PTG%u_Type", n), "", true);
+		const string sPrefix = format("PTG%u_", n);
+		CParameterizedTrajectoryGenerator::Ptr ptg1(
+			CParameterizedTrajectoryGenerator::CreatePTG(
+				sPTGName, cfg, "PTG_UNIT_TESTS", sPrefix));
+		if (!dynamic_cast<CPTG_DiffDrive_CollisionGridBased*>(ptg1.get()))
+			continue;
+		CParameterizedTrajectoryGenerator::Ptr ptg2(
+			CParameterizedTrajectoryGenerator::CreatePTG(
+				sPTGName, cfg, "PTG_UNIT_TESTS", sPrefix));
+
+		// 1st: build the grid and save it. 2nd: map the cache file.
+		const string sCache = mrpt::system::getTempFileName() + ".dat.gz";
+		const string sCacheCompact = sCache.substr(0, sCache.size() - 3);
+		ptg1->initialize(sCache, false /*verbose */);
+		EXPECT_TRUE(mrpt::system::fileExists(sCacheCompact));
+		ptg2->initialize(sCache, false /*verbose */);
+		EXPECT_FALSE(
+			dynamic_cast<CPTG_DiffDrive_CollisionGridBased&>(*ptg1)
+				.isCollisionGridMapped());
+		EXPECT_TRUE(
+			dynamic_cast<CPTG_DiffDrive_CollisionGridBased&>(*ptg2)
+				.isCollisionGridMapped())
+			<< "PTG: " << ptg2->getDescription();
+
+		const double refDist = ptg1->getRefDistance();
+		std::vector<double> TP_obs1, TP_obs2;
+		for (double ox = -refDist; ox < refDist; ox += 0.1)
+		{
+			for (double oy = -refDist; oy < refDist; oy += 0.1)
+			{
+				ptg1->initTPObstacles(TP_obs1);
+				ptg2->initTPObstacles(TP_obs2);
+				ptg1->updateTPObstacle(ox, oy, TP_obs1);
+				ptg2->updateTPObstacle(ox, oy, TP_obs2);
+				EXPECT_EQ(TP_obs1, TP_obs2) << "PTG: " << ptg1->getDescription()
+											<< " ox=" << ox << " oy=" << oy;
+			}
+		}
+		ptg2.reset();
+		mrpt::system::deleteFile(sCacheCompact);
+	}
+}
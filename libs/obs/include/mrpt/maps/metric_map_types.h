@@ -15,6 +15,10 @@
 
 namespace mrpt
 {
+namespace system
+{
+class CWorkerThreadsPool;
+}
 namespace maps
 {
 /** Parameters for the determination of matchings between point clouds, etc. \sa
@@ -42,6 +46,11 @@ struct TMatchingParams
 	/** The point used to calculate angular distances: e.g. the coordinates of
 	 * the sensor for a 2D laser scanner. */
 	mrpt::math::TPoint3D angularDistPivotPoint;
+	/** If not nullptr, maps supporting it (e.g. mrpt::maps::CPointsMap) will
+	 * split the nearest-neighbor queries among the threads of this pool. The
+	 * output is identical to that of a serial search. (Default=nullptr)
+	 * \note [New in MRPT 2.0.0] */
+	mrpt::system::CWorkerThreadsPool* threadPool;
 
 	/** Ctor: default values */
 	TMatchingParams()
@@ -51,7 +60,8 @@ struct TMatchingParams
 		  onlyUniqueRobust(false),
 		  decimation_other_map_points(1),
 		  offset_other_map_points(0),
-		  angularDistPivotPoint(0, 0, 0)
+		  angularDistPivotPoint(0, 0, 0),
+		  threadPool(nullptr)
 	{
 	}
 };
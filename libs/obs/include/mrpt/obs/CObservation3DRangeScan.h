@@ -24,6 +24,10 @@
 
 namespace mrpt
 {
+namespace system
+{
+class CWorkerThreadsPool;
+}
 namespace obs
 {
 /** Used in CObservation3DRangeScan::project3DPointsFromDepthImageInto() */
@@ -42,17 +46,29 @@ struct T3DPointsProjectionParams
 	 * <b>and</b> with different camera parameter matrices. In all other cases,
 	 * it is a good idea to left it enabled. */
 	bool PROJ3D_USE_LUT;
-	/** (Default:true) If possible, use SSE2 optimized code. */
+	/** (Default:true) If possible, use SIMD (SSE2/AVX2) optimized code. */
 	bool USE_SSE2;
 	/** (Default:true) set to false if you want to preserve the organization of
 	 * the point cloud */
 	bool MAKE_DENSE;
+	/** (Default:1) Only project one out of every `decimation` rows and
+	 * columns of the range image. With `MAKE_DENSE=false`, the organized
+	 * cloud has the size of the decimated image.
+	 * \note [New in MRPT 2.0.0] */
+	uint8_t decimation;
+	/** (Default:nullptr) If provided, image rows and output points are split
+	 * among the threads of this pool. The output is identical to that of the
+	 * single-threaded projection.
+	 * \note [New in MRPT 2.0.0] */
+	mrpt::system::CWorkerThreadsPool* threadPool;
 	T3DPointsProjectionParams()
 		: takeIntoAccountSensorPoseOnRobot(false),
 		  robotPoseInTheWorld(nullptr),
 		  PROJ3D_USE_LUT(true),
 		  USE_SSE2(true),
-		  MAKE_DENSE(true)
+		  MAKE_DENSE(true),
+		  decimation(1),
+		  threadPool(nullptr)
 	{
 	}
 };
@@ -304,6 +320,13 @@ class CObservation3DRangeScan : public CObservation
 	 *  the points are transformed with \a sensorPose. Furthermore, if
 	 * provided, those coordinates are transformed with \a robotPoseInTheWorld
 	 *
+	 *  The range image is processed in two passes over its (optionally
+	 * decimated) rows: the first one evaluates \a filterParams (with SIMD
+	 * code) and counts the valid points of each row, so the destination is
+	 * resized only once to its final size, and the second one writes the
+	 * points. Both can be split among the threads of
+	 * T3DPointsProjectionParams::threadPool.
+	 *
 	 * \tparam POINTMAP Supported maps are all those covered by
 	 * mrpt::opengl::PointCloudAdapter (mrpt::maps::CPointsMap and derived,
 	 * mrpt::opengl::CPointCloudColoured, PCL point clouds,...)
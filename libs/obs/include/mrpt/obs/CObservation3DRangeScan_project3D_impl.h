@@ -10,6 +10,14 @@
 #define CObservation3DRangeScan_project3D_impl_H
 
 #include <mrpt/core/round.h>  // round()
+#include <mrpt/core/SSE_types.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <cmath>
+#include <functional>
+#include <vector>
+#if MRPT_HAS_AVX2
+#include <immintrin.h>
+#endif
 
 namespace mrpt
 {
@@ -17,22 +25,14 @@ namespace obs
 {
 namespace detail
 {
-// Auxiliary functions which implement SSE-optimized proyection of 3D point
-// cloud:
-template <class POINTMAP>
-void do_project_3d_pointcloud(
-	const int H, const int W, const float* kys, const float* kzs,
-	const mrpt::math::CMatrix& rangeImage,
-	mrpt::opengl::PointCloudAdapter<POINTMAP>& pca,
-	std::vector<uint16_t>& idxs_x, std::vector<uint16_t>& idxs_y,
-	const mrpt::obs::TRangeImageFilterParams& filterParams, bool MAKE_DENSE);
-template <class POINTMAP>
-void do_project_3d_pointcloud_SSE2(
-	const int H, const int W, const float* kys, const float* kzs,
-	const mrpt::math::CMatrix& rangeImage,
-	mrpt::opengl::PointCloudAdapter<POINTMAP>& pca,
-	std::vector<uint16_t>& idxs_x, std::vector<uint16_t>& idxs_y,
-	const mrpt::obs::TRangeImageFilterParams& filterParams, bool MAKE_DENSE);
+// Auxiliary functions for the projection of 3D point clouds:
+inline void do_range_filter_row(
+	const mrpt::math::CMatrix& rangeImage, const TRangeImageFilter& rif,
+	const int r, const int decimation, const bool useSIMD, uint8_t* valid);
+inline void run_in_parallel(
+	mrpt::system::CWorkerThreadsPool* pool, const std::size_t N,
+	const std::size_t min_chunk,
+	const std::function<void(std::size_t, std::size_t)>& body);
 
 template <class POINTMAP>
 void project3DPointsFromDepthImageInto(
@@ -45,6 +45,7 @@ void project3DPointsFromDepthImageInto(
 	if (!src_obs.hasRangeImage) return;
 
 	mrpt::opengl::PointCloudAdapter<POINTMAP> pca(dest_pointcloud);
+	mrpt::system::CWorkerThreadsPool* pool = projectParams.threadPool;
 
 	// ------------------------------------------------------------
 	// Stage 1/3: Create 3D point cloud local coordinates
@@ -53,161 +54,157 @@ void project3DPointsFromDepthImageInto(
 	const int H = src_obs.rangeImage.rows();
 	ASSERT_(W != 0 && H != 0);
 	const size_t WH = W * H;
+	const int dec = projectParams.decimation;
+	ASSERT_ABOVEEQ_(dec, 1);
+	// Size of the decimated image:
+	const int Wd = (W + dec - 1) / dec, Hd = (H + dec - 1) / dec;
+
+	if (filterParams.rangeMask_min)
+	{  // sanity check:
+		ASSERT_EQUAL_(
+			filterParams.rangeMask_min->cols(), src_obs.rangeImage.cols());
+		ASSERT_EQUAL_(
+			filterParams.rangeMask_min->rows(), src_obs.rangeImage.rows());
+	}
+	if (filterParams.rangeMask_max)
+	{  // sanity check:
+		ASSERT_EQUAL_(
+			filterParams.rangeMask_max->cols(), src_obs.rangeImage.cols());
+		ASSERT_EQUAL_(
+			filterParams.rangeMask_max->rows(), src_obs.rangeImage.rows());
+	}
 
-	src_obs.resizePoints3DVectors(WH);  // This is to make sure
-	// points3D_idxs_{x,y} have the expected
-	// sizes.
-	pca.resize(WH);  // Reserve memory for 3D points. It will be later resized
-	// again to the actual number of valid points
+	const float r_cx = src_obs.cameraParams.cx();
+	const float r_cy = src_obs.cameraParams.cy();
+	const float r_fx_inv = 1.0f / src_obs.cameraParams.fx();
+	const float r_fy_inv = 1.0f / src_obs.cameraParams.fy();
 
-	if (src_obs.range_is_depth)
+	// Use cached tables? (Only used for range_is_depth=true)
+	const float *kys = nullptr, *kzs = nullptr;
+	if (src_obs.range_is_depth && projectParams.PROJ3D_USE_LUT)
 	{
-		// range_is_depth = true
+		auto& lut = src_obs.get_3dproj_lut();
+		if (lut.prev_camParams != src_obs.cameraParams ||
+			WH != size_t(lut.Kys.size()))
+		{
+			lut.prev_camParams = src_obs.cameraParams;
+			lut.Kys.resize(WH);
+			lut.Kzs.resize(WH);
+
+			float* ky = &lut.Kys[0];
+			float* kz = &lut.Kzs[0];
+			for (int r = 0; r < H; r++)
+				for (int c = 0; c < W; c++)
+				{
+					*ky++ = (r_cx - c) * r_fx_inv;
+					*kz++ = (r_cy - r) * r_fy_inv;
+				}
+		}  // end update LUT.
+
+		ASSERT_EQUAL_(WH, size_t(lut.Kys.size()));
+		ASSERT_EQUAL_(WH, size_t(lut.Kzs.size()));
+		kys = &lut.Kys[0];
+		kzs = &lut.Kzs[0];
+	}
 
-		// Use cached tables?
-		if (projectParams.PROJ3D_USE_LUT)
+	// 1st pass: evaluate the range filter for all (decimated) pixels, and
+	// count the valid ones in each row. Buffers are reused among calls:
+	thread_local std::vector<uint8_t> validBuf;
+	thread_local std::vector<size_t> rowStartBuf;
+	// (Bind the buffers of *this* thread, since they are used from workers)
+	std::vector<uint8_t>& valid = validBuf;
+	std::vector<size_t>& rowStart = rowStartBuf;
+	valid.resize(size_t(Wd) * Hd);
+	rowStart.resize(Hd + 1);
+
+	const TRangeImageFilter rif(filterParams);
+	const bool useSIMD = projectParams.USE_SSE2;
+	run_in_parallel(pool, Hd, 16, [&](size_t rd0, size_t rd1) {
+		for (size_t rd = rd0; rd < rd1; rd++)
 		{
-			// Use LUT:
-			if (src_obs.get_3dproj_lut().prev_camParams !=
-					src_obs.cameraParams ||
-				WH != size_t(src_obs.get_3dproj_lut().Kys.size()))
-			{
-				src_obs.get_3dproj_lut().prev_camParams = src_obs.cameraParams;
-				src_obs.get_3dproj_lut().Kys.resize(WH);
-				src_obs.get_3dproj_lut().Kzs.resize(WH);
-
-				const float r_cx = src_obs.cameraParams.cx();
-				const float r_cy = src_obs.cameraParams.cy();
-				const float r_fx_inv = 1.0f / src_obs.cameraParams.fx();
-				const float r_fy_inv = 1.0f / src_obs.cameraParams.fy();
-
-				float* kys = &src_obs.get_3dproj_lut().Kys[0];
-				float* kzs = &src_obs.get_3dproj_lut().Kzs[0];
-				for (int r = 0; r < H; r++)
-					for (int c = 0; c < W; c++)
-					{
-						*kys++ = (r_cx - c) * r_fx_inv;
-						*kzs++ = (r_cy - r) * r_fy_inv;
-					}
-			}  // end update LUT.
-
-			ASSERT_EQUAL_(WH, size_t(src_obs.get_3dproj_lut().Kys.size()));
-			ASSERT_EQUAL_(WH, size_t(src_obs.get_3dproj_lut().Kzs.size()));
-			float* kys = &src_obs.get_3dproj_lut().Kys[0];
-			float* kzs = &src_obs.get_3dproj_lut().Kzs[0];
-
-			if (filterParams.rangeMask_min)
-			{  // sanity check:
-				ASSERT_EQUAL_(
-					filterParams.rangeMask_min->cols(),
-					src_obs.rangeImage.cols());
-				ASSERT_EQUAL_(
-					filterParams.rangeMask_min->rows(),
-					src_obs.rangeImage.rows());
-			}
-			if (filterParams.rangeMask_max)
-			{  // sanity check:
-				ASSERT_EQUAL_(
-					filterParams.rangeMask_max->cols(),
-					src_obs.rangeImage.cols());
-				ASSERT_EQUAL_(
-					filterParams.rangeMask_max->rows(),
-					src_obs.rangeImage.rows());
-			}
-#if MRPT_HAS_SSE2
-			if ((W & 0x07) == 0 && projectParams.USE_SSE2)
-				do_project_3d_pointcloud_SSE2(
-					H, W, kys, kzs, src_obs.rangeImage, pca,
-					src_obs.points3D_idxs_x, src_obs.points3D_idxs_y,
-					filterParams, projectParams.MAKE_DENSE);
-			else
-				do_project_3d_pointcloud(
-					H, W, kys, kzs, src_obs.rangeImage, pca,
-					src_obs.points3D_idxs_x, src_obs.points3D_idxs_y,
-					filterParams, projectParams.MAKE_DENSE);  // if image width
-// is not 8*N, use
-// standard method
-#else
-			do_project_3d_pointcloud(
-				H, W, kys, kzs, src_obs.rangeImage, pca,
-				src_obs.points3D_idxs_x, src_obs.points3D_idxs_y, filterParams,
-				projectParams.MAKE_DENSE);
-#endif
+			uint8_t* v = &valid[rd * Wd];
+			do_range_filter_row(
+				src_obs.rangeImage, rif, rd * dec, dec, useSIMD, v);
+			size_t n = 0;
+			for (int cd = 0; cd < Wd; cd++) n += v[cd];
+			rowStart[rd + 1] = n;
 		}
-		else
+	});
+
+	// Output index of the first point of each row:
+	const bool MAKE_DENSE = projectParams.MAKE_DENSE;
+	rowStart[0] = 0;
+	for (int rd = 0; rd < Hd; rd++)
+		rowStart[rd + 1] = MAKE_DENSE ? rowStart[rd] + rowStart[rd + 1]
+									  : size_t(rd + 1) * Wd;
+	const size_t nPts = rowStart[Hd];
+
+	// Resize the outputs only once, to their final size. Their memory is kept
+	// by std::vector's between frames, so there are no reallocations once
+	// they have grown to the usual number of points:
+	if (src_obs.points3D_idxs_x.size() < nPts)
+		src_obs.resizePoints3DVectors(nPts);
+	pca.resize(nPts);
+
+	// 2nd pass: compute the 3D points:
+	run_in_parallel(pool, Hd, 16, [&](size_t rd0, size_t rd1) {
+		for (size_t rd = rd0; rd < rd1; rd++)
 		{
-			// Without LUT:
-			const float r_cx = src_obs.cameraParams.cx();
-			const float r_cy = src_obs.cameraParams.cy();
-			const float r_fx_inv = 1.0f / src_obs.cameraParams.fx();
-			const float r_fy_inv = 1.0f / src_obs.cameraParams.fy();
-			TRangeImageFilter rif(filterParams);
-			size_t idx = 0;
-			for (int r = 0; r < H; r++)
-				for (int c = 0; c < W; c++)
+			const int r = rd * dec;
+			const float* D_row = &src_obs.rangeImage.coeffRef(r, 0);
+			const uint8_t* v = &valid[rd * Wd];
+			const float Kz_row = (r_cy - r) * r_fy_inv;
+			size_t idx = rowStart[rd];
+			for (int cd = 0, c = 0; cd < Wd; cd++, c += dec)
+			{
+				if (!v[cd])
+				{
+					if (!MAKE_DENSE) pca.setInvalidPoint(idx++);
+					continue;
+				}
+				const float D = D_row[c];
+				if (kys)
 				{
-					const float D = src_obs.rangeImage.coeff(r, c);
-					if (rif.do_range_filter(r, c, D))
+					pca.setPointXYZ(
+						idx, D /*x*/, kys[r * W + c] * D /*y*/,
+						kzs[r * W + c] * D /*z*/);
+				}
+				else
+				{
+					const float Ky = (r_cx - c) * r_fx_inv;
+					if (src_obs.range_is_depth)
+						pca.setPointXYZ(idx, D, Ky * D, Kz_row * D);
+					else
 					{
-						const float Kz = (r_cy - r) * r_fy_inv;
-						const float Ky = (r_cx - c) * r_fx_inv;
+						/* range_is_depth = false :
+						 *   Ky = (r_cx - c)/r_fx
+						 *   Kz = (r_cy - r)/r_fy
+						 *
+						 *   x(i) = rangeImage(r,c) / sqrt( 1 + Ky^2 + Kz^2 )
+						 *   y(i) = Ky * x(i)
+						 *   z(i) = Kz * x(i)
+						 */
 						pca.setPointXYZ(
 							idx,
-							D,  // x
+							D / std::sqrt(1 + Ky * Ky + Kz_row * Kz_row),  // x
 							Ky * D,  // y
-							Kz * D  // z
+							Kz_row * D  // z
 							);
-						src_obs.points3D_idxs_x[idx] = c;
-						src_obs.points3D_idxs_y[idx] = r;
-						++idx;
 					}
 				}
-			pca.resize(idx);  // Actual number of valid pts
-		}
-	}
-	else
-	{
-		/* range_is_depth = false :
-		 *   Ky = (r_cx - c)/r_fx
-		 *   Kz = (r_cy - r)/r_fy
-		 *
-		 *   x(i) = rangeImage(r,c) / sqrt( 1 + Ky^2 + Kz^2 )
-		 *   y(i) = Ky * x(i)
-		 *   z(i) = Kz * x(i)
-		 */
-		const float r_cx = src_obs.cameraParams.cx();
-		const float r_cy = src_obs.cameraParams.cy();
-		const float r_fx_inv = 1.0f / src_obs.cameraParams.fx();
-		const float r_fy_inv = 1.0f / src_obs.cameraParams.fy();
-		TRangeImageFilter rif(filterParams);
-		size_t idx = 0;
-		for (int r = 0; r < H; r++)
-			for (int c = 0; c < W; c++)
-			{
-				const float D = src_obs.rangeImage.coeff(r, c);
-				if (rif.do_range_filter(r, c, D))
-				{
-					const float Ky = (r_cx - c) * r_fx_inv;
-					const float Kz = (r_cy - r) * r_fy_inv;
-					pca.setPointXYZ(
-						idx,
-						D / std::sqrt(1 + Ky * Ky + Kz * Kz),  // x
-						Ky * D,  // y
-						Kz * D  // z
-						);
-					src_obs.points3D_idxs_x[idx] = c;
-					src_obs.points3D_idxs_y[idx] = r;
-					++idx;
-				}
+				src_obs.points3D_idxs_x[idx] = c;
+				src_obs.points3D_idxs_y[idx] = r;
+				++idx;
 			}
-		pca.resize(idx);  // Actual number of valid pts
-	}
+		}
+	});
 
 	// -------------------------------------------------------------
 	// Stage 2/3: Project local points into RGB image to get colors
 	// -------------------------------------------------------------
 	if (src_obs.hasIntensityImage)
 	{
+		// (This also loads externally-stored images, before going parallel)
 		const int imgW = src_obs.intensityImage.getWidth();
 		const int imgH = src_obs.intensityImage.getHeight();
 		const bool hasColorIntensityImg = src_obs.intensityImage.isColor();
@@ -238,68 +235,70 @@ void project3DPointsFromDepthImageInto(
 			T_inv.block<3, 1>(0, 3) = t_inv.cast<float>();
 		}
 
-		Eigen::Matrix<float, 4, 1> pt_wrt_color, pt_wrt_depth;
-		pt_wrt_depth[3] = 1;
-
-		mrpt::img::TColor pCol;
-
 		// For each local point:
-		const size_t nPts = pca.size();
-		for (size_t i = 0; i < nPts; i++)
-		{
-			int img_idx_x, img_idx_y;  // projected pixel coordinates, in the
-			// RGB image plane
-			bool pointWithinImage = false;
-			if (isDirectCorresp)
-			{
-				pointWithinImage = true;
-				img_idx_x = src_obs.points3D_idxs_x[i];
-				img_idx_y = src_obs.points3D_idxs_y[i];
-			}
-			else
+		run_in_parallel(pool, nPts, 4096, [&](size_t i0, size_t i1) {
+			Eigen::Matrix<float, 4, 1> pt_wrt_color, pt_wrt_depth;
+			pt_wrt_depth[3] = 1;
+			mrpt::img::TColor pCol;
+
+			for (size_t i = i0; i < i1; i++)
 			{
-				// Project point, which is now in "pca" in local coordinates wrt
-				// the depth camera, into the intensity camera:
-				pca.getPointXYZ(
-					i, pt_wrt_depth[0], pt_wrt_depth[1], pt_wrt_depth[2]);
-				pt_wrt_color = T_inv * pt_wrt_depth;
-
-				// Project to image plane:
-				if (pt_wrt_color[2])
+				int img_idx_x, img_idx_y;  // projected pixel coordinates, in
+				// the RGB image plane
+				bool pointWithinImage = false;
+				if (isDirectCorresp)
 				{
-					img_idx_x = mrpt::round(
-						cx + fx * pt_wrt_color[0] / pt_wrt_color[2]);
-					img_idx_y = mrpt::round(
-						cy + fy * pt_wrt_color[1] / pt_wrt_color[2]);
-					pointWithinImage = img_idx_x >= 0 && img_idx_x < imgW &&
-									   img_idx_y >= 0 && img_idx_y < imgH;
+					pointWithinImage = true;
+					img_idx_x = src_obs.points3D_idxs_x[i];
+					img_idx_y = src_obs.points3D_idxs_y[i];
+				}
+				else
+				{
+					// Project point, which is now in "pca" in local
+					// coordinates wrt the depth camera, into the intensity
+					// camera:
+					pca.getPointXYZ(
+						i, pt_wrt_depth[0], pt_wrt_depth[1], pt_wrt_depth[2]);
+					pt_wrt_color = T_inv * pt_wrt_depth;
+
+					// Project to image plane:
+					if (pt_wrt_color[2])
+					{
+						img_idx_x = mrpt::round(
+							cx + fx * pt_wrt_color[0] / pt_wrt_color[2]);
+						img_idx_y = mrpt::round(
+							cy + fy * pt_wrt_color[1] / pt_wrt_color[2]);
+						pointWithinImage = img_idx_x >= 0 &&
+										   img_idx_x < imgW &&
+										   img_idx_y >= 0 && img_idx_y < imgH;
+					}
 				}
-			}
 
-			if (pointWithinImage)
-			{
-				if (hasColorIntensityImg)
+				if (pointWithinImage)
 				{
-					const uint8_t* c = src_obs.intensityImage.get_unsafe(
-						img_idx_x, img_idx_y, 0);
-					pCol.R = c[2];
-					pCol.G = c[1];
-					pCol.B = c[0];
+					if (hasColorIntensityImg)
+					{
+						const uint8_t* c = src_obs.intensityImage.get_unsafe(
+							img_idx_x, img_idx_y, 0);
+						pCol.R = c[2];
+						pCol.G = c[1];
+						pCol.B = c[0];
+					}
+					else
+					{
+						uint8_t c = *src_obs.intensityImage.get_unsafe(
+							img_idx_x, img_idx_y, 0);
+						pCol.R = pCol.G = pCol.B = c;
+					}
 				}
 				else
 				{
-					uint8_t c = *src_obs.intensityImage.get_unsafe(
-						img_idx_x, img_idx_y, 0);
-					pCol.R = pCol.G = pCol.B = c;
+					pCol.R = pCol.G = pCol.B = 255;
 				}
-			}
-			else
-			{
-				pCol.R = pCol.G = pCol.B = 255;
-			}
-			// Set color:
-			pca.setPointRGBu8(i, pCol.R, pCol.G, pCol.B);
-		}  // end for each point
+				// Set color:
+				pca.setPointRGBu8(i, pCol.R, pCol.G, pCol.B);
+			}  // end for each point
+		});
 	}  // end if src_obs has intensity image
 
 	// ...
@@ -324,181 +323,122 @@ void project3DPointsFromDepthImageInto(
 			transf_to_apply
 				.getHomogeneousMatrixVal<mrpt::math::CMatrixDouble44>()
 				.cast<float>();
-		Eigen::Matrix<float, 4, 1> pt, pt_transf;
-		pt[3] = 1;
 
-		const size_t nPts = pca.size();
-		for (size_t i = 0; i < nPts; i++)
-		{
-			pca.getPointXYZ(i, pt[0], pt[1], pt[2]);
-			pt_transf = HM * pt;
-			pca.setPointXYZ(i, pt_transf[0], pt_transf[1], pt_transf[2]);
-		}
+		run_in_parallel(pool, nPts, 4096, [&](size_t i0, size_t i1) {
+			Eigen::Matrix<float, 4, 1> pt, pt_transf;
+			pt[3] = 1;
+			for (size_t i = i0; i < i1; i++)
+			{
+				pca.getPointXYZ(i, pt[0], pt[1], pt[2]);
+				pt_transf = HM * pt;
+				pca.setPointXYZ(i, pt_transf[0], pt_transf[1], pt_transf[2]);
+			}
+		});
 	}
 }  // end of project3DPointsFromDepthImageInto
 
-// Auxiliary functions which implement proyection of 3D point clouds:
-template <class POINTMAP>
-inline void do_project_3d_pointcloud(
-	const int H, const int W, const float* kys, const float* kzs,
-	const mrpt::math::CMatrix& rangeImage,
-	mrpt::opengl::PointCloudAdapter<POINTMAP>& pca,
-	std::vector<uint16_t>& idxs_x, std::vector<uint16_t>& idxs_y,
-	const mrpt::obs::TRangeImageFilterParams& fp, bool MAKE_DENSE)
+/** Runs body() over [0,N) in the given pool, or in this thread if it is
+ * nullptr. */
+inline void run_in_parallel(
+	mrpt::system::CWorkerThreadsPool* pool, const std::size_t N,
+	const std::size_t min_chunk,
+	const std::function<void(std::size_t, std::size_t)>& body)
 {
-	TRangeImageFilter rif(fp);
-	// Preconditions: minRangeMask() has the right size
-	size_t idx = 0;
-	for (int r = 0; r < H; r++)
-		for (int c = 0; c < W; c++)
-		{
-			const float D = rangeImage.coeff(r, c);
-			if (!rif.do_range_filter(r, c, D))
-			{
-				if (!MAKE_DENSE)
-				{
-					pca.setInvalidPoint(idx);
-					++idx;
-				}
-				continue;
-			}
-
-			pca.setPointXYZ(idx, D /*x*/, *kys++ * D /*y*/, *kzs++ * D /*z*/);
-			idxs_x[idx] = c;
-			idxs_y[idx] = r;
-			++idx;
-		}
-	pca.resize(idx);
+	if (pool && N > min_chunk)
+		pool->parallel_for(N, body, min_chunk);
+	else if (N)
+		body(0, N);
 }
 
-// Auxiliary functions which implement proyection of 3D point clouds:
-template <class POINTMAP>
-inline void do_project_3d_pointcloud_SSE2(
-	const int H, const int W, const float* kys, const float* kzs,
-	const mrpt::math::CMatrix& rangeImage,
-	mrpt::opengl::PointCloudAdapter<POINTMAP>& pca,
-	std::vector<uint16_t>& idxs_x, std::vector<uint16_t>& idxs_y,
-	const mrpt::obs::TRangeImageFilterParams& filterParams, bool MAKE_DENSE)
+/** Evaluates TRangeImageFilter::do_range_filter() for the pixels
+ * `0,decimation,2*decimation,...` of the row `r` of the range image, and
+ * writes 1 (valid) or 0 for each of them into `valid`. */
+inline void do_range_filter_row(
+	const mrpt::math::CMatrix& rangeImage, const TRangeImageFilter& rif,
+	const int r, const int decimation, const bool useSIMD, uint8_t* valid)
 {
-#if MRPT_HAS_SSE2
-	// Preconditions: minRangeMask() has the right size
-	// Use optimized version:
-	const int W_4 = W >> 2;  // /=4 , since we process 4 values at a time.
-	size_t idx = 0;
-	alignas(MRPT_MAX_ALIGN_BYTES) float xs[4], ys[4], zs[4];
-	const __m128 D_zeros = _mm_set_ps(.0f, .0f, .0f, .0f);
-	const __m128 xormask =
-		(filterParams.rangeCheckBetween)
-			? _mm_cmpneq_ps(D_zeros, D_zeros)
-			:  // want points BETWEEN min and max to be valid
-			_mm_cmpeq_ps(
-				D_zeros,
-				D_zeros);  // want points OUTSIDE of min and max to be valid
-	for (int r = 0; r < H; r++)
+	const int W = rangeImage.cols();
+	int c = 0;
+#if MRPT_HAS_AVX2 || MRPT_HAS_SSE2
+	if (decimation == 1 && useSIMD)
 	{
-		const float* D_ptr =
-			&rangeImage.coeffRef(r, 0);  // Matrices are 16-aligned
-		const float* Dgt_ptr =
-			!filterParams.rangeMask_min
-				? nullptr
-				: &filterParams.rangeMask_min->coeffRef(r, 0);
-		const float* Dlt_ptr =
-			!filterParams.rangeMask_max
-				? nullptr
-				: &filterParams.rangeMask_max->coeffRef(r, 0);
-
-		for (int c = 0; c < W_4; c++)
+		// Same logic than do_range_filter(), with masks:
+		//  pass_gt = !(Dmin!=0) || D>=Dmin
+		//  pass_lt = !(Dmax!=0) || D<=Dmax
+		//  both    = Dmin!=0 && Dmax!=0
+		//  valid   = !(D<=0) && ((pass_gt && pass_lt) XOR (both && !between))
+		// (Comparisons are chosen so that NaN's behave as in the scalar code)
+		const float* D = &rangeImage.coeffRef(r, 0);
+		const float* Dmin =
+			rif.fp.rangeMask_min ? &rif.fp.rangeMask_min->coeffRef(r, 0)
+								 : nullptr;
+		const float* Dmax =
+			rif.fp.rangeMask_max ? &rif.fp.rangeMask_max->coeffRef(r, 0)
+								 : nullptr;
+#if MRPT_HAS_AVX2
+		const __m256 zeros = _mm256_setzero_ps();
+		const __m256 ones = _mm256_cmp_ps(zeros, zeros, _CMP_EQ_OQ);
+		const __m256 notBetween = rif.fp.rangeCheckBetween ? zeros : ones;
+		for (; c + 8 <= W; c += 8)
 		{
-			const __m128 D = _mm_load_ps(D_ptr);
-			const __m128 nz_mask = _mm_cmpgt_ps(D, D_zeros);
-			__m128 valid_range_mask;
-			if (!filterParams.rangeMask_min && !filterParams.rangeMask_max)
-			{  // No filter: just skip D=0 points
-				valid_range_mask = nz_mask;
+			const __m256 d = _mm256_loadu_ps(D + c);
+			// noMinOrMax stays all-ones unless both masks are given:
+			__m256 pass = ones, noMin = ones, noMinOrMax = ones;
+			if (Dmin)
+			{
+				const __m256 m = _mm256_loadu_ps(Dmin + c);
+				noMin = _mm256_cmp_ps(m, zeros, _CMP_EQ_OQ);
+				pass = _mm256_or_ps(noMin, _mm256_cmp_ps(d, m, _CMP_GE_OQ));
 			}
-			else
+			if (Dmax)
 			{
-				if (!filterParams.rangeMask_min || !filterParams.rangeMask_max)
-				{  // Only one filter
-					if (filterParams.rangeMask_min)
-					{
-						const __m128 Dmin = _mm_load_ps(Dgt_ptr);
-						valid_range_mask = _mm_and_ps(
-							_mm_cmpgt_ps(D, Dmin), _mm_cmpgt_ps(Dmin, D_zeros));
-					}
-					else
-					{
-						const __m128 Dmax = _mm_load_ps(Dlt_ptr);
-						valid_range_mask = _mm_and_ps(
-							_mm_cmplt_ps(D, Dmax), _mm_cmpgt_ps(Dmax, D_zeros));
-					}
-					valid_range_mask = _mm_and_ps(
-						valid_range_mask, nz_mask);  // Filter out D=0 points
-				}
-				else
-				{
-					// We have both: D>Dmin and D<Dmax conditions, with XOR to
-					// optionally invert the selection:
-					const __m128 Dmin = _mm_load_ps(Dgt_ptr);
-					const __m128 Dmax = _mm_load_ps(Dlt_ptr);
-
-					const __m128 gt_mask = _mm_cmpgt_ps(D, Dmin);
-					const __m128 lt_mask = _mm_and_ps(
-						_mm_cmplt_ps(D, Dmax), nz_mask);  // skip points at zero
-					valid_range_mask =
-						_mm_and_ps(gt_mask, lt_mask);  // (D>Dmin && D<Dmax)
-					valid_range_mask = _mm_xor_ps(valid_range_mask, xormask);
-					// Add the case of D_min & D_max = 0 (no filtering)
-					valid_range_mask = _mm_or_ps(
-						valid_range_mask, _mm_and_ps(
-											  _mm_cmpeq_ps(Dmin, D_zeros),
-											  _mm_cmpeq_ps(Dmax, D_zeros)));
-					// Finally, ensure no invalid ranges get thru:
-					valid_range_mask = _mm_and_ps(valid_range_mask, nz_mask);
-				}
+				const __m256 m = _mm256_loadu_ps(Dmax + c);
+				const __m256 noMax = _mm256_cmp_ps(m, zeros, _CMP_EQ_OQ);
+				pass = _mm256_and_ps(
+					pass,
+					_mm256_or_ps(noMax, _mm256_cmp_ps(d, m, _CMP_LE_OQ)));
+				if (Dmin) noMinOrMax = _mm256_or_ps(noMin, noMax);
 			}
-			const int valid_range_maski = _mm_movemask_epi8(
-				_mm_castps_si128(valid_range_mask));  // 0x{f|0}{f|0}{f|0}{f|0}
-			if (valid_range_maski != 0)  // Any of the 4 values is valid?
+			pass =
+				_mm256_xor_ps(pass, _mm256_andnot_ps(noMinOrMax, notBetween));
+			pass = _mm256_and_ps(pass, _mm256_cmp_ps(d, zeros, _CMP_NLE_UQ));
+			const int bits = _mm256_movemask_ps(pass);
+			for (int q = 0; q < 8; q++) valid[c + q] = (bits >> q) & 1;
+		}
+#else
+		const __m128 zeros = _mm_setzero_ps();
+		const __m128 ones = _mm_cmpeq_ps(zeros, zeros);
+		const __m128 notBetween = rif.fp.rangeCheckBetween ? zeros : ones;
+		for (; c + 4 <= W; c += 4)
+		{
+			const __m128 d = _mm_loadu_ps(D + c);
+			// noMinOrMax stays all-ones unless both masks are given:
+			__m128 pass = ones, noMin = ones, noMinOrMax = ones;
+			if (Dmin)
 			{
-				const __m128 KY = _mm_load_ps(kys);
-				const __m128 KZ = _mm_load_ps(kzs);
-
-				_mm_storeu_ps(xs, D);
-				_mm_storeu_ps(ys, _mm_mul_ps(KY, D));
-				_mm_storeu_ps(zs, _mm_mul_ps(KZ, D));
-
-				for (int q = 0; q < 4; q++)
-					if ((valid_range_maski & (1 << (q * 4))) != 0)
-					{
-						pca.setPointXYZ(idx, xs[q], ys[q], zs[q]);
-						idxs_x[idx] = (c << 2) + q;
-						idxs_y[idx] = r;
-						++idx;
-					}
-					else if (!MAKE_DENSE)
-					{
-						pca.setInvalidPoint(idx);
-						++idx;
-					}
+				const __m128 m = _mm_loadu_ps(Dmin + c);
+				noMin = _mm_cmpeq_ps(m, zeros);
+				pass = _mm_or_ps(noMin, _mm_cmpge_ps(d, m));
 			}
-			else if (!MAKE_DENSE)
+			if (Dmax)
 			{
-				for (int q = 0; q < 4; q++)
-				{
-					pca.setInvalidPoint(idx);
-					++idx;
-				}
+				const __m128 m = _mm_loadu_ps(Dmax + c);
+				const __m128 noMax = _mm_cmpeq_ps(m, zeros);
+				pass = _mm_and_ps(pass, _mm_or_ps(noMax, _mm_cmple_ps(d, m)));
+				if (Dmin) noMinOrMax = _mm_or_ps(noMin, noMax);
 			}
-			D_ptr += 4;
-			if (Dgt_ptr) Dgt_ptr += 4;
-			if (Dlt_ptr) Dlt_ptr += 4;
-			kys += 4;
-			kzs += 4;
+			pass = _mm_xor_ps(pass, _mm_andnot_ps(noMinOrMax, notBetween));
+			pass = _mm_and_ps(pass, _mm_cmpnle_ps(d, zeros));
+			const int bits = _mm_movemask_ps(pass);
+			for (int q = 0; q < 4; q++) valid[c + q] = (bits >> q) & 1;
 		}
+#endif
 	}
-	pca.resize(idx);
 #endif
+	// Remaining (or decimated) pixels:
+	for (; c < W; c += decimation)
+		valid[c / decimation] =
+			rif.do_range_filter(r, c, rangeImage.coeff(r, c)) ? 1 : 0;
 }
 
 }  // namespace detail
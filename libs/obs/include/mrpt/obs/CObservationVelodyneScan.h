@@ -22,6 +22,10 @@ namespace poses
 {
 class CPose3DInterpolator;
 }
+namespace system
+{
+class CWorkerThreadsPool;
+}
 namespace obs
 {
 /** A `CObservation`-derived class for RAW DATA (and optionally, point cloud) of
@@ -254,6 +258,11 @@ class CObservationVelodyneScan : public CObservation
 		bool generatePerPointTimestamp{false};
 		/** (Default:false) If `true`, populate the vector azimuth */
 		bool generatePerPointAzimuth{false};
+		/** (Default:nullptr) If provided, raw packets are decoded in parallel
+		 * by the threads of this pool. The output is identical to that of the
+		 * single-threaded decoding.
+		 * \note [New in MRPT 2.0.0] */
+		mrpt::system::CWorkerThreadsPool* threadPool{nullptr};
 	};
 
 	/** Generates the point cloud into the point cloud data fields in \a
@@ -266,6 +275,8 @@ class CObservationVelodyneScan : public CObservation
 	 * generatePointCloudAlongSE3Trajectory()
 	 * \note Points with ranges out of [minRange,maxRange] are discarded; as
 	 * well, other filters are available in \a params.
+	 * \note The vectors in point_cloud keep their capacity, so decoding
+	 * successive scans into the same object does not reallocate them.
 	 * \sa generatePointCloudAlongSE3Trajectory(),
 	 * TGeneratePointCloudParameters
 	 */
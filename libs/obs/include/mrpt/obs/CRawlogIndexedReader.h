@@ -0,0 +1,162 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/serialization/CSerializable.h>
+#include <mrpt/system/datetime.h>
+#include <mrpt/io/CFileGZInputStream.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace mrpt
+{
+namespace obs
+{
+/** Memory-bounded reader of rawlog files, with random access to its entries.
+ *
+ * Unlike CRawlog::loadFromRawLogFile(), which deserializes the whole dataset
+ * into memory, this class only keeps an index with the position in the file,
+ * the timestamp and the class of each entry (an observation, a
+ * CSensoryFrame, a CActionCollection,...). Entries are only deserialized
+ * when requested, either by index (getEntry()), by timestamp
+ * (findEntryByTimestamp()), or sequentially (rewind() and next()), in which
+ * case the next entries can be read ahead by a background thread
+ * (setPrefetchSize()).
+ *
+ * Building the index requires parsing the whole file once, so by default the
+ * index is cached in a sidecar file (`<rawlog_file>.idx`, see
+ * getIndexFileName()) and reused as long as the rawlog file size and
+ * modification time do not change.
+ *
+ * Both plain and gz-compressed rawlogs are supported. Random access is
+ * immediate in plain files, while in gz-compressed ones jumping backwards
+ * requires decompressing again from the beginning of the file. Therefore,
+ * decompress large datasets (e.g. with `gunzip`) if they will be accessed
+ * in random order.
+ *
+ * Usage:
+ * \code
+ * mrpt::obs::CRawlogIndexedReader rawlog("dataset.rawlog");
+ * rawlog.setPrefetchSize(100);
+ * mrpt::serialization::CSerializable::Ptr obj;
+ * while (rawlog.next(obj))
+ * {
+ *    // ...
+ * }
+ * \endcode
+ *
+ * Methods of this class are not thread-safe.
+ *
+ * \sa CRawlog
+ * \note [New in MRPT 2.0.0]
+ * \ingroup mrpt_obs_grp
+ */
+class CRawlogIndexedReader
+{
+   public:
+	/** Default ctor: call open() before accessing entries */
+	CRawlogIndexedReader();
+	/** Ctor and open(). \exception std::exception On error opening the
+	 * file or parsing it. */
+	CRawlogIndexedReader(
+		const std::string& fileName, bool useIndexFile = true);
+	~CRawlogIndexedReader();
+
+	CRawlogIndexedReader(const CRawlogIndexedReader&) = delete;
+	CRawlogIndexedReader& operator=(const CRawlogIndexedReader&) = delete;
+
+	/** Opens a rawlog file and loads its index from the sidecar index file,
+	 * or builds it if that file does not exist or is outdated. If
+	 * `useIndexFile` is false, the index is always built and never saved.
+	 * \return false if the file could not be opened.
+	 * \exception std::exception On errors parsing the rawlog file.
+	 */
+	bool open(const std::string& fileName, bool useIndexFile = true);
+	/** Closes the file and clears the index */
+	void close();
+	bool isOpen() const { return m_file.fileOpenCorrectly(); }
+	/** Returns the name of the sidecar index file of a given rawlog */
+	static std::string getIndexFileName(const std::string& rawlogFile)
+	{
+		return rawlogFile + std::string(".idx");
+	}
+
+	/** Number of entries in the rawlog */
+	size_t size() const { return m_offsets.size(); }
+	/** Timestamp of the i'th entry: that of the observation, or of the first
+	 * observation (action) in a CSensoryFrame (CActionCollection), or
+	 * INVALID_TIMESTAMP for other kinds of objects. */
+	mrpt::system::TTimeStamp getEntryTimestamp(size_t index) const;
+	/** Class name of the i'th entry (e.g. "CObservation2DRangeScan") */
+	const std::string& getEntryClassName(size_t index) const;
+
+	/** Reads and deserializes the i'th entry.
+	 * \exception std::exception If index is out of range or the object could
+	 * not be deserialized. */
+	mrpt::serialization::CSerializable::Ptr getEntry(size_t index);
+	/** Returns the index of the first entry (in timestamp order) with a
+	 * timestamp equal or later than `t`, or size() if there is none. Entries
+	 * without a timestamp are ignored. */
+	size_t findEntryByTimestamp(const mrpt::system::TTimeStamp t) const;
+
+	/** Sets the entry to be returned by the next call to next() */
+	void rewind(size_t index = 0);
+	/** Reads the next entry in file order, and advances to the following one.
+	 * \return false when the end of the rawlog has been reached. */
+	bool next(mrpt::serialization::CSerializable::Ptr& obj);
+	/** Index of the entry to be returned by the next call to next() */
+	size_t tell() const { return m_nextIndex; }
+
+	/** Sets the maximum number of entries read ahead of next() by a
+	 * background thread. 0 (default) disables read-ahead. Memory usage is
+	 * bounded by this number of deserialized entries. */
+	void setPrefetchSize(size_t numEntries);
+	size_t getPrefetchSize() const { return m_prefetchSize; }
+
+   private:
+	std::string m_fileName;
+	/** Stream used for random access (and sequential reads w/o prefetch) */
+	mrpt::io::CFileGZInputStream m_file;
+
+	/** The index: position of each object in the uncompressed stream,
+	 * timestamp and index in m_classNames */
+	std::vector<uint64_t> m_offsets;
+	std::vector<mrpt::system::TTimeStamp> m_timestamps;
+	std::vector<uint16_t> m_classIdxs;
+	std::vector<std::string> m_classNames;
+	/** (timestamp,entry index) sorted by timestamp, for searches */
+	std::vector<std::pair<mrpt::system::TTimeStamp, size_t>> m_sortedByTime;
+
+	size_t m_nextIndex{0};
+
+	/** Read-ahead thread state: */
+	size_t m_prefetchSize{0};
+	std::thread m_prefetchThread;
+	std::mutex m_prefetchMtx;
+	std::condition_variable m_prefetchCV;
+	std::deque<mrpt::serialization::CSerializable::Ptr> m_prefetched;
+	bool m_prefetchStop{false};
+	bool m_prefetchEOF{false};
+	std::exception_ptr m_prefetchError;
+
+	bool loadIndexFile();
+	void saveIndexFile() const;
+	void buildIndex();
+	void startPrefetch();
+	void stopPrefetch();
+	void prefetchThreadMain(size_t firstIndex);
+};
+}  // namespace obs
+}  // namespace mrpt
@@ -8,6 +8,8 @@
    +------------------------------------------------------------------------+ */
 
 #include <mrpt/obs/CObservation3DRangeScan.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/random.h>
 
 #include <gtest/gtest.h>
 
@@ -183,3 +185,116 @@ TEST(CObservation3DRangeScan, Project3D_filterMax)
 										   << std::endl;
 	}
 }
+
+TEST(CObservation3DRangeScan, Project3D_sameOutputAllPaths)
+{
+	mrpt::system::CWorkerThreadsPool pool(3);
+	mrpt::obs::T3DPointsProjectionParams pp;
+	mrpt::obs::TRangeImageFilterParams fp;
+
+	// Reference: no LUT, no SIMD, single thread:
+	mrpt::obs::CObservation3DRangeScan ref;
+	fillSampleObs(ref, pp, 0);
+	ref.cameraParams.setIntrinsicParamsFromValues(20.0, 20.0, 16.0, 12.0);
+	ref.project3DPointsFromDepthImageInto(ref, pp, fp);
+
+	for (int i = 0; i < 16; i++)  // test all combinations of flags
+	{
+		mrpt::obs::CObservation3DRangeScan o;
+		fillSampleObs(o, pp, i & 3);
+		o.cameraParams = ref.cameraParams;
+		pp.threadPool = (i & 4) != 0 ? &pool : nullptr;
+		// Check that outputs are properly resized if already populated:
+		if ((i & 8) != 0) o.resizePoints3DVectors(100);
+
+		o.project3DPointsFromDepthImageInto(o, pp, fp);
+		ASSERT_EQ(o.points3D_x.size(), ref.points3D_x.size())
+			<< " testcase flags: i=" << i << std::endl;
+		for (size_t k = 0; k < ref.points3D_x.size(); k++)
+		{
+			EXPECT_EQ(o.points3D_idxs_x[k], ref.points3D_idxs_x[k]);
+			EXPECT_EQ(o.points3D_idxs_y[k], ref.points3D_idxs_y[k]);
+			EXPECT_NEAR(o.points3D_x[k], ref.points3D_x[k], 1e-5f);
+			EXPECT_NEAR(o.points3D_y[k], ref.points3D_y[k], 1e-5f);
+			EXPECT_NEAR(o.points3D_z[k], ref.points3D_z[k], 1e-5f);
+		}
+	}
+}
+
+TEST(CObservation3DRangeScan, Project3D_decimation)
+{
+	mrpt::obs::T3DPointsProjectionParams pp;
+	mrpt::obs::TRangeImageFilterParams fp;
+	pp.decimation = 2;
+
+	for (int i = 0; i < 8; i++)  // test all combinations of flags
+	{
+		mrpt::obs::CObservation3DRangeScan o;
+		fillSampleObs(o, pp, i);
+
+		o.project3DPointsFromDepthImageInto(o, pp, fp);
+		// Only even rows & columns of the sample points:
+		EXPECT_EQ(o.points3D_x.size(), 6U) << " testcase flags: i=" << i
+										   << std::endl;
+		for (size_t k = 0; k < o.points3D_x.size(); k++)
+		{
+			EXPECT_EQ(o.points3D_idxs_x[k] % 2, 0);
+			EXPECT_EQ(o.points3D_idxs_y[k] % 2, 0);
+		}
+	}
+}
+
+TEST(CObservation3DRangeScan, Project3D_filterSIMDMatchesScalar)
+{
+	// Random ranges and masks, with some zeros (no range, or no filter):
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(321);
+	mrpt::math::CMatrix fMin(TEST_RANGEIMG_HEIGHT, TEST_RANGEIMG_WIDTH),
+		fMax(TEST_RANGEIMG_HEIGHT, TEST_RANGEIMG_WIDTH),
+		D(TEST_RANGEIMG_HEIGHT, TEST_RANGEIMG_WIDTH);
+	for (int r = 0; r < TEST_RANGEIMG_HEIGHT; r++)
+		for (int c = 0; c < TEST_RANGEIMG_WIDTH; c++)
+		{
+			D(r, c) = rng.drawUniform32bit() % 5 ? rng.drawUniform(0, 10) : 0;
+			fMin(r, c) =
+				rng.drawUniform32bit() % 3 ? rng.drawUniform(0, 5) : 0;
+			fMax(r, c) =
+				rng.drawUniform32bit() % 3 ? rng.drawUniform(5, 10) : 0;
+		}
+
+	// Masks: 1=min only, 2=max only, 3=both
+	for (int masks = 1; masks <= 3; masks++)
+		for (bool between : {true, false})
+		{
+			mrpt::obs::TRangeImageFilterParams fp;
+			fp.rangeMask_min = (masks & 1) ? &fMin : nullptr;
+			fp.rangeMask_max = (masks & 2) ? &fMax : nullptr;
+			fp.rangeCheckBetween = between;
+
+			const mrpt::obs::TRangeImageFilter rif(fp);
+			size_t nExpected = 0;
+			for (int r = 0; r < TEST_RANGEIMG_HEIGHT; r++)
+				for (int c = 0; c < TEST_RANGEIMG_WIDTH; c++)
+					if (rif.do_range_filter(r, c, D(r, c))) nExpected++;
+
+			size_t nPts[2];
+			for (int simd = 0; simd < 2; simd++)
+			{
+				mrpt::obs::T3DPointsProjectionParams pp;
+				pp.USE_SSE2 = simd != 0;
+				mrpt::obs::CObservation3DRangeScan o;
+				o.hasRangeImage = true;
+				o.rangeImage = D;
+				o.project3DPointsFromDepthImageInto(o, pp, fp);
+				nPts[simd] = o.points3D_x.size();
+				for (size_t k = 0; k < nPts[simd]; k++)
+					EXPECT_TRUE(rif.do_range_filter(
+						o.points3D_idxs_y[k], o.points3D_idxs_x[k],
+						D(o.points3D_idxs_y[k], o.points3D_idxs_x[k])));
+			}
+			EXPECT_EQ(nPts[0], nExpected)
+				<< "masks=" << masks << " between=" << between;
+			EXPECT_EQ(nPts[1], nExpected)
+				<< "masks=" << masks << " between=" << between;
+		}
+}
@@ -12,7 +12,10 @@
 #include <mrpt/obs/CObservationVelodyneScan.h>
 #include <mrpt/poses/CPose3DInterpolator.h>
 #include <mrpt/core/round.h>
+#include <mrpt/core/aligned_std_vector.h>
 #include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <algorithm>
 #include <iostream>
 
 using namespace std;
@@ -136,36 +139,144 @@ double VLP16AdjustTimeStamp(int firingblock, int dsr, int firingwithinblock)
 		   (firingwithinblock * VLP16_FIRING_TOFFSET);
 }
 
-/** Auxiliary class used to refactor
- * CObservationVelodyneScan::generatePointCloud() */
-struct PointCloudStorageWrapper
+namespace
 {
-	/** Process the insertion of a new (x,y,z) point to the cloud, in
-	 * sensor-centric coordinates, with the exact timestamp of that LIDAR ray */
-	virtual void add_point(
-		double pt_x, double pt_y, double pt_z, uint8_t pt_intensity,
-		const mrpt::system::TTimeStamp& tim, const float azimuth) = 0;
+/** Max number of points decoded from one packet */
+const size_t MAX_POINTS_PER_PACKET =
+	CObservationVelodyneScan::BLOCKS_PER_PACKET * SCANS_PER_FIRING;
+/** Raw laser indices: dsr + 32 for the lower bank */
+const int NUM_RAW_LASERS = 64;
+
+/** Everything which only depends on the calibration and the LIDAR model,
+ * precomputed once per scan so the per-point loop has neither branches on
+ * the model nor conversions of the calibration values. */
+struct TVelodyneDecodeLUT
+{
+	struct TLaser
+	{
+		bool valid{false};
+		float cos_vert{0}, sin_vert{0}, horz_offset{0}, vert_offset{0};
+		/** vert_offset * sin_vert */
+		float xy_offset{0};
+		double dist_correction{0};
+	};
+	/** Indexed by raw laser index */
+	TLaser lasers[NUM_RAW_LASERS];
+	/** Fraction of the azimuth increment between blocks elapsed when each
+	 * laser fires, for [dual_mode][block][raw_laser_index] */
+	double azimuth_frac[2][CObservationVelodyneScan::BLOCKS_PER_PACKET]
+					   [NUM_RAW_LASERS];
+	size_t num_lasers{0};
+
+	explicit TVelodyneDecodeLUT(const VelodyneCalibration& calib)
+	{
+		// This is: 16,32,64 depending on the LIDAR model
+		num_lasers = calib.laser_corrections.size();
+		ASSERTMSG_(
+			num_lasers == 16 || num_lasers == 32 || num_lasers == 64,
+			"Error: unhandled LIDAR model!");
+
+		for (int raw = 0; raw < NUM_RAW_LASERS; raw++)
+		{
+			int laserId = raw;
+			// VLP-16: adjust laser id
+			bool firingWithinBlock = false;
+			if (num_lasers == 16 && laserId >= 16)
+			{
+				laserId -= 16;
+				firingWithinBlock = true;
+			}
+			TLaser& L = lasers[raw];
+			L.valid = laserId < static_cast<int>(num_lasers);
+			if (L.valid)
+			{
+				const VelodyneCalibration::PerLaserCalib& c =
+					calib.laser_corrections[laserId];
+				L.cos_vert = c.cosVertCorrection;
+				L.sin_vert = c.sinVertCorrection;
+				L.horz_offset = c.horizontalOffsetCorrection;
+				L.vert_offset = c.verticalOffsetCorrection;
+				L.xy_offset = L.vert_offset * L.sin_vert;
+				L.dist_correction = c.distanceCorrection;
+			}
+
+			// Azimuth correction: correct for the laser rotation as a
+			// function of timing during the firings
+			const int dsr = raw % 32;
+			for (int dual = 0; dual < 2; dual++)
+				for (int block = 0;
+					 block < CObservationVelodyneScan::BLOCKS_PER_PACKET;
+					 block++)
+				{
+					// [us] since beginning of scan
+					double timestampadjustment = 0.0;
+					double blockdsr0 = 0.0;
+					double nextblockdsr0 = 1.0;
+					switch (num_lasers)
+					{
+						// VLP-16
+						case 16:
+						{
+							const int b = dual ? block / 2 : block;
+							timestampadjustment = VLP16AdjustTimeStamp(
+								b, laserId, firingWithinBlock);
+							nextblockdsr0 = VLP16AdjustTimeStamp(b + 1, 0, 0);
+							blockdsr0 = VLP16AdjustTimeStamp(b, 0, 0);
+						}
+						break;
+						// HDL-32:
+						case 32:
+							timestampadjustment =
+								HDL32AdjustTimeStamp(block, dsr);
+							nextblockdsr0 = HDL32AdjustTimeStamp(block + 1, 0);
+							blockdsr0 = HDL32AdjustTimeStamp(block, 0);
+							break;
+						default:
+							break;
+					};
+					azimuth_frac[dual][block][raw] =
+						(timestampadjustment - blockdsr0) /
+						(nextblockdsr0 - blockdsr0);
+				}
+		}
+	}
 };
 
-static void velodyne_scan_to_pointcloud(
-	const CObservationVelodyneScan& scan,
+/** Output arrays for the points of one packet (azimuth may be nullptr) */
+struct TDecodedPointsOut
+{
+	float *x, *y, *z;
+	uint8_t* intensity;
+	float* azimuth;
+};
+
+/** Timestamp of one packet */
+mrpt::system::TTimeStamp packetTimestamp(
+	const CObservationVelodyneScan& scan, size_t iPkt)
+{
+	const uint32_t us_pkt0 = scan.scan_packets[0].gps_timestamp;
+	const uint32_t us_pkt_this = scan.scan_packets[iPkt].gps_timestamp;
+	// Handle the case of time counter reset by new hour 00:00:00
+	const uint32_t us_ellapsed =
+		(us_pkt_this >= us_pkt0)
+			? (us_pkt_this - us_pkt0)
+			: (1000000UL * 3600UL + us_pkt_this - us_pkt0);
+	return mrpt::system::timestampAdd(scan.timestamp, us_ellapsed * 1e-6);
+}
+
+/** Decodes the packet `iPkt` into `out`, which must have room for
+ * MAX_POINTS_PER_PACKET points. Returns the number of points. */
+size_t decodePacket(
+	const CObservationVelodyneScan& scan, const size_t iPkt,
+	const TVelodyneDecodeLUT& lut,
 	const CObservationVelodyneScan::TGeneratePointCloudParameters& params,
-	PointCloudStorageWrapper& out_pc)
+	const CSinCosLookUpTableFor2DScans::TSinCosValues& lut_sincos,
+	const TDecodedPointsOut& out)
 {
 	// Initially based on code from ROS velodyne & from
 	// vtkVelodyneHDLReader::vtkInternal::ProcessHDLPacket().
 	using mrpt::round;
 
-	// Access to sin/cos table:
-	mrpt::obs::T2DScanProperties scan_props;
-	scan_props.aperture = 2 * M_PI;
-	scan_props.nRays = CObservationVelodyneScan::ROTATION_MAX_UNITS;
-	scan_props.rightToLeft = true;
-	// The LUT contains sin/cos values for angles in this order: [180deg ... 0
-	// deg ... -180 deg]
-	const CSinCosLookUpTableFor2DScans::TSinCosValues& lut_sincos =
-		velodyne_sincos_tables.getSinCosForScan(scan_props);
-
 	const int minAzimuth_int = round(params.minAzimuth_deg * 100);
 	const int maxAzimuth_int = round(params.maxAzimuth_deg * 100);
 	const float realMinDist =
@@ -176,319 +287,280 @@ static void velodyne_scan_to_pointcloud(
 		params.isolatedPointsFilterDistance /
 		CObservationVelodyneScan::DISTANCE_RESOLUTION;
 
-	// This is: 16,32,64 depending on the LIDAR model
-	const size_t num_lasers = scan.calibration.laser_corrections.size();
+	const CObservationVelodyneScan::TVelodyneRawPacket* raw =
+		&scan.scan_packets[iPkt];
+	const bool dual_mode =
+		(raw->laser_return_mode == CObservationVelodyneScan::RETMODE_DUAL);
 
-	for (size_t iPkt = 0; iPkt < scan.scan_packets.size(); iPkt++)
+	// Take the median rotational speed as a good value for interpolating
+	// the missing azimuths:
+	int median_azimuth_diff;
 	{
-		const CObservationVelodyneScan::TVelodyneRawPacket* raw =
-			&scan.scan_packets[iPkt];
-
-		mrpt::system::TTimeStamp pkt_tim;  // Find out timestamp of this pkt
+		// In dual return, the azimuth rate is actually twice this
+		// estimation:
+		const int nBlocksPerAzimuth = dual_mode ? 2 : 1;
+		int diffs[CObservationVelodyneScan::BLOCKS_PER_PACKET];
+		const int nDiffs =
+			CObservationVelodyneScan::BLOCKS_PER_PACKET - nBlocksPerAzimuth;
+		for (int i = 0; i < nDiffs; ++i)
 		{
-			const uint32_t us_pkt0 = scan.scan_packets[0].gps_timestamp;
-			const uint32_t us_pkt_this = raw->gps_timestamp;
-			// Handle the case of time counter reset by new hour 00:00:00
-			const uint32_t us_ellapsed =
-				(us_pkt_this >= us_pkt0)
-					? (us_pkt_this - us_pkt0)
-					: (1000000UL * 3600UL + us_pkt_this - us_pkt0);
-			pkt_tim =
-				mrpt::system::timestampAdd(scan.timestamp, us_ellapsed * 1e-6);
+			int localDiff = (CObservationVelodyneScan::ROTATION_MAX_UNITS +
+							 raw->blocks[i + nBlocksPerAzimuth].rotation -
+							 raw->blocks[i].rotation) %
+							CObservationVelodyneScan::ROTATION_MAX_UNITS;
+			diffs[i] = localDiff;
 		}
+		std::nth_element(
+			diffs, diffs + CObservationVelodyneScan::BLOCKS_PER_PACKET / 2,
+			diffs + nDiffs);  // Calc median
+		median_azimuth_diff =
+			diffs[CObservationVelodyneScan::BLOCKS_PER_PACKET / 2];
+	}
+
+	size_t nPts = 0;
+	for (int block = 0; block < CObservationVelodyneScan::BLOCKS_PER_PACKET;
+		 block++)  // Firings per packet
+	{
+		const CObservationVelodyneScan::raw_block_t& blk = raw->blocks[block];
 
-		// Take the median rotational speed as a good value for interpolating
-		// the missing azimuths:
-		int median_azimuth_diff;
+		// ignore packets with mangled or otherwise different contents
+		if ((lut.num_lasers != 64 &&
+			 CObservationVelodyneScan::UPPER_BANK != blk.header) ||
+			(blk.header != CObservationVelodyneScan::UPPER_BANK &&
+			 blk.header != CObservationVelodyneScan::LOWER_BANK))
 		{
-			// In dual return, the azimuth rate is actually twice this
-			// estimation:
-			const int nBlocksPerAzimuth =
-				(raw->laser_return_mode ==
-				 CObservationVelodyneScan::RETMODE_DUAL)
-					? 2
-					: 1;
-			std::vector<int> diffs(
-				CObservationVelodyneScan::BLOCKS_PER_PACKET -
-				nBlocksPerAzimuth);
-			for (int i = 0; i < CObservationVelodyneScan::BLOCKS_PER_PACKET -
-									nBlocksPerAzimuth;
-				 ++i)
-			{
-				int localDiff = (CObservationVelodyneScan::ROTATION_MAX_UNITS +
-								 raw->blocks[i + nBlocksPerAzimuth].rotation -
-								 raw->blocks[i].rotation) %
-								CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				diffs[i] = localDiff;
-			}
-			std::nth_element(
-				diffs.begin(),
-				diffs.begin() + CObservationVelodyneScan::BLOCKS_PER_PACKET / 2,
-				diffs.end());  // Calc median
-			median_azimuth_diff =
-				diffs[CObservationVelodyneScan::BLOCKS_PER_PACKET / 2];
+			cerr << "[CObservationVelodyneScan] skipping invalid packet: "
+					"block "
+				 << block << " header value is " << blk.header;
+			continue;
 		}
 
-		for (int block = 0; block < CObservationVelodyneScan::BLOCKS_PER_PACKET;
-			 block++)  // Firings per packet
+		const int dsr_offset =
+			(blk.header == CObservationVelodyneScan::LOWER_BANK) ? 32 : 0;
+		const float azimuth_raw_f = (float)(blk.rotation);
+		const bool block_is_dual_2nd_ranges = dual_mode && ((block & 0x01) != 0);
+		const bool block_is_dual_last_ranges =
+			dual_mode && ((block & 0x01) == 0);
+		const double* azimuth_frac = lut.azimuth_frac[dual_mode ? 1 : 0][block];
+
+		for (int dsr = 0, k = 0; dsr < SCANS_PER_FIRING; dsr++, k++)
 		{
-			// ignore packets with mangled or otherwise different contents
-			if ((num_lasers != 64 &&
-				 CObservationVelodyneScan::UPPER_BANK !=
-					 raw->blocks[block].header) ||
-				(raw->blocks[block].header !=
-					 CObservationVelodyneScan::UPPER_BANK &&
-				 raw->blocks[block].header !=
-					 CObservationVelodyneScan::LOWER_BANK))
-			{
-				cerr << "[CObservationVelodyneScan] skipping invalid packet: "
-						"block "
-					 << block << " header value is "
-					 << raw->blocks[block].header;
+			const uint16_t dist_raw = blk.laser_returns[k].distance;
+			if (!dist_raw)  // Invalid return?
 				continue;
+
+			const int rawLaserId = dsr + dsr_offset;
+			const TVelodyneDecodeLUT::TLaser& L = lut.lasers[rawLaserId];
+			ASSERTMSG_(L.valid, "Laser index out of the calibration table");
+
+			// In dual return, if the distance is equal in both ranges,
+			// ignore one of them:
+			if (block_is_dual_2nd_ranges)
+			{
+				if (dist_raw ==
+					raw->blocks[block - 1].laser_returns[k].distance)
+					continue;  // duplicated point
+				if (!params.dualKeepStrongest) continue;
 			}
+			if (block_is_dual_last_ranges && !params.dualKeepLast) continue;
+
+			// Return distance:
+			const float distance =
+				dist_raw * CObservationVelodyneScan::DISTANCE_RESOLUTION +
+				L.dist_correction;
+			if (distance < realMinDist || distance > realMaxDist) continue;
 
-			const int dsr_offset = (raw->blocks[block].header ==
-									CObservationVelodyneScan::LOWER_BANK)
-									   ? 32
-									   : 0;
-			const float azimuth_raw_f = (float)(raw->blocks[block].rotation);
-			const bool block_is_dual_2nd_ranges =
-				(raw->laser_return_mode ==
-					 CObservationVelodyneScan::RETMODE_DUAL &&
-				 ((block & 0x01) != 0));
-			const bool block_is_dual_last_ranges =
-				(raw->laser_return_mode ==
-					 CObservationVelodyneScan::RETMODE_DUAL &&
-				 ((block & 0x01) == 0));
-
-			for (int dsr = 0, k = 0; dsr < SCANS_PER_FIRING; dsr++, k++)
+			// Isolated points filtering:
+			if (params.filterOutIsolatedPoints)
 			{
-				if (!raw->blocks[block]
-						 .laser_returns[k]
-						 .distance)  // Invalid return?
-					continue;
-
-				const uint8_t rawLaserId =
-					static_cast<uint8_t>(dsr + dsr_offset);
-				uint8_t laserId = rawLaserId;
-
-				// Detect VLP-16 data and adjust laser id if necessary
-				bool firingWithinBlock = false;
-				if (num_lasers == 16)
+				bool pass_filter = true;
+				const int16_t dist_this = dist_raw;
+				if (k > 0)
 				{
-					if (laserId >= 16)
-					{
-						laserId -= 16;
-						firingWithinBlock = true;
-					}
+					const int16_t dist_prev =
+						blk.laser_returns[k - 1].distance;
+					if (!dist_prev ||
+						std::abs(dist_this - dist_prev) >
+							isolatedPointsFilterDistance_units)
+						pass_filter = false;
 				}
-
-				ASSERT_BELOW_(laserId, num_lasers);
-				const mrpt::obs::VelodyneCalibration::PerLaserCalib& calib =
-					scan.calibration.laser_corrections[laserId];
-
-				// In dual return, if the distance is equal in both ranges,
-				// ignore one of them:
-				if (block_is_dual_2nd_ranges)
+				if (k < (SCANS_PER_FIRING - 1))
 				{
-					if (raw->blocks[block].laser_returns[k].distance ==
-						raw->blocks[block - 1].laser_returns[k].distance)
-						continue;  // duplicated point
-					if (!params.dualKeepStrongest) continue;
+					const int16_t dist_next =
+						blk.laser_returns[k + 1].distance;
+					if (!dist_next ||
+						std::abs(dist_this - dist_next) >
+							isolatedPointsFilterDistance_units)
+						pass_filter = false;
 				}
-				if (block_is_dual_last_ranges && !params.dualKeepLast) continue;
+				if (!pass_filter) continue;  // Filter out this point
+			}
 
-				// Return distance:
-				const float distance =
-					raw->blocks[block].laser_returns[k].distance *
-						CObservationVelodyneScan::DISTANCE_RESOLUTION +
-					calib.distanceCorrection;
-				if (distance < realMinDist || distance > realMaxDist) continue;
+			const int azimuthadjustment =
+				mrpt::round(median_azimuth_diff * azimuth_frac[rawLaserId]);
+
+			const float azimuth_corrected_f = azimuth_raw_f + azimuthadjustment;
+			const int azimuth_corrected =
+				((int)round(azimuth_corrected_f)) %
+				CObservationVelodyneScan::ROTATION_MAX_UNITS;
+
+			// Filter by azimuth:
+			if (!((minAzimuth_int < maxAzimuth_int &&
+				   azimuth_corrected >= minAzimuth_int &&
+				   azimuth_corrected <= maxAzimuth_int) ||
+				  (minAzimuth_int > maxAzimuth_int &&
+				   (azimuth_corrected <= maxAzimuth_int ||
+					azimuth_corrected >= minAzimuth_int))))
+				continue;
 
-				// Isolated points filtering:
-				if (params.filterOutIsolatedPoints)
-				{
-					bool pass_filter = true;
-					const int16_t dist_this =
-						raw->blocks[block].laser_returns[k].distance;
-					if (k > 0)
-					{
-						const int16_t dist_prev =
-							raw->blocks[block].laser_returns[k - 1].distance;
-						if (!dist_prev ||
-							std::abs(dist_this - dist_prev) >
-								isolatedPointsFilterDistance_units)
-							pass_filter = false;
-					}
-					if (k < (SCANS_PER_FIRING - 1))
-					{
-						const int16_t dist_next =
-							raw->blocks[block].laser_returns[k + 1].distance;
-						if (!dist_next ||
-							std::abs(dist_this - dist_next) >
-								isolatedPointsFilterDistance_units)
-							pass_filter = false;
-					}
-					if (!pass_filter) continue;  // Filter out this point
-				}
+			// Vertical axis mis-alignment calibration:
+			const float xy_distance = distance * L.cos_vert + L.xy_offset;
+
+			const int azimuth_corrected_for_lut =
+				(azimuth_corrected +
+				 (CObservationVelodyneScan::ROTATION_MAX_UNITS / 2)) %
+				CObservationVelodyneScan::ROTATION_MAX_UNITS;
+			const float cos_azimuth =
+				lut_sincos.ccos[azimuth_corrected_for_lut];
+			const float sin_azimuth =
+				lut_sincos.csin[azimuth_corrected_for_lut];
+
+			// Compute raw position
+			const mrpt::math::TPoint3Df pt(
+				xy_distance * cos_azimuth +
+					L.horz_offset * sin_azimuth,  // MRPT +X = Velodyne +Y
+				-(xy_distance * sin_azimuth -
+				  L.horz_offset * cos_azimuth),  // MRPT +Y = Velodyne -X
+				distance * L.sin_vert + L.vert_offset);
+
+			if (params.filterByROI &&
+				(pt.x > params.ROI_x_max || pt.x < params.ROI_x_min ||
+				 pt.y > params.ROI_y_max || pt.y < params.ROI_y_min ||
+				 pt.z > params.ROI_z_max || pt.z < params.ROI_z_min))
+				continue;
 
-				// Azimuth correction: correct for the laser rotation as a
-				// function of timing during the firings
-				double timestampadjustment =
-					0.0;  // [us] since beginning of scan
-				double blockdsr0 = 0.0;
-				double nextblockdsr0 = 1.0;
-				switch (num_lasers)
-				{
-					// VLP-16
-					case 16:
-					{
-						if (raw->laser_return_mode ==
-							CObservationVelodyneScan::RETMODE_DUAL)
-						{
-							timestampadjustment = VLP16AdjustTimeStamp(
-								block / 2, laserId, firingWithinBlock);
-							nextblockdsr0 =
-								VLP16AdjustTimeStamp(block / 2 + 1, 0, 0);
-							blockdsr0 = VLP16AdjustTimeStamp(block / 2, 0, 0);
-						}
-						else
-						{
-							timestampadjustment = VLP16AdjustTimeStamp(
-								block, laserId, firingWithinBlock);
-							nextblockdsr0 =
-								VLP16AdjustTimeStamp(block + 1, 0, 0);
-							blockdsr0 = VLP16AdjustTimeStamp(block, 0, 0);
-						}
-					}
-					break;
-					// HDL-32:
-					case 32:
-						timestampadjustment = HDL32AdjustTimeStamp(block, dsr);
-						nextblockdsr0 = HDL32AdjustTimeStamp(block + 1, 0);
-						blockdsr0 = HDL32AdjustTimeStamp(block, 0);
-						break;
-					case 64:
-						break;
-					default:
-					{
-						THROW_EXCEPTION("Error: unhandled LIDAR model!");
-					}
-				};
-
-				const int azimuthadjustment = mrpt::round(
-					median_azimuth_diff * ((timestampadjustment - blockdsr0) /
-										   (nextblockdsr0 - blockdsr0)));
-
-				const float azimuth_corrected_f =
-					azimuth_raw_f + azimuthadjustment;
-				const int azimuth_corrected =
-					((int)round(azimuth_corrected_f)) %
-					CObservationVelodyneScan::ROTATION_MAX_UNITS;
-
-				// Filter by azimuth:
-				if (!((minAzimuth_int < maxAzimuth_int &&
-					   azimuth_corrected >= minAzimuth_int &&
-					   azimuth_corrected <= maxAzimuth_int) ||
-					  (minAzimuth_int > maxAzimuth_int &&
-					   (azimuth_corrected <= maxAzimuth_int ||
-						azimuth_corrected >= minAzimuth_int))))
-					continue;
-
-				// Vertical axis mis-alignment calibration:
-				const float cos_vert_angle = calib.cosVertCorrection;
-				const float sin_vert_angle = calib.sinVertCorrection;
-				const float horz_offset = calib.horizontalOffsetCorrection;
-				const float vert_offset = calib.verticalOffsetCorrection;
-
-				float xy_distance = distance * cos_vert_angle;
-				if (vert_offset) xy_distance += vert_offset * sin_vert_angle;
-
-				const int azimuth_corrected_for_lut =
-					(azimuth_corrected +
-					 (CObservationVelodyneScan::ROTATION_MAX_UNITS / 2)) %
-					CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				const float cos_azimuth =
-					lut_sincos.ccos[azimuth_corrected_for_lut];
-				const float sin_azimuth =
-					lut_sincos.csin[azimuth_corrected_for_lut];
-
-				// Compute raw position
-				const mrpt::math::TPoint3Df pt(
-					xy_distance * cos_azimuth +
-						horz_offset * sin_azimuth,  // MRPT +X = Velodyne +Y
-					-(xy_distance * sin_azimuth -
-					  horz_offset * cos_azimuth),  // MRPT +Y = Velodyne -X
-					distance * sin_vert_angle + vert_offset);
-
-				bool add_point = true;
-				if (params.filterByROI &&
-					(pt.x > params.ROI_x_max || pt.x < params.ROI_x_min ||
-					 pt.y > params.ROI_y_max || pt.y < params.ROI_y_min ||
-					 pt.z > params.ROI_z_max || pt.z < params.ROI_z_min))
-					add_point = false;
-
-				if (params.filterBynROI &&
-					(pt.x <= params.nROI_x_max && pt.x >= params.nROI_x_min &&
-					 pt.y <= params.nROI_y_max && pt.y >= params.nROI_y_min &&
-					 pt.z <= params.nROI_z_max && pt.z >= params.nROI_z_min))
-					add_point = false;
-
-				if (!add_point) continue;
-
-				// Insert point:
-				out_pc.add_point(
-					pt.x, pt.y, pt.z,
-					raw->blocks[block].laser_returns[k].intensity, pkt_tim,
-					azimuth_corrected_f);
-
-			}  // end for k,dsr=[0,31]
-		}  // end for each block [0,11]
-	}  // end for each data packet
+			if (params.filterBynROI &&
+				(pt.x <= params.nROI_x_max && pt.x >= params.nROI_x_min &&
+				 pt.y <= params.nROI_y_max && pt.y >= params.nROI_y_min &&
+				 pt.z <= params.nROI_z_max && pt.z >= params.nROI_z_min))
+				continue;
+
+			// Insert point:
+			out.x[nPts] = pt.x;
+			out.y[nPts] = pt.y;
+			out.z[nPts] = pt.z;
+			out.intensity[nPts] = blk.laser_returns[k].intensity;
+			if (out.azimuth)
+				out.azimuth[nPts] =
+					azimuth_corrected *
+					CObservationVelodyneScan::ROTATION_RESOLUTION;
+			nPts++;
+		}  // end for k,dsr=[0,31]
+	}  // end for each block [0,11]
+	return nPts;
 }
 
-void CObservationVelodyneScan::generatePointCloud(
-	const TGeneratePointCloudParameters& params)
+/** Decodes all packets into `pc`. The arrays are first resized to hold
+ * MAX_POINTS_PER_PACKET points per packet, each packet is decoded (in
+ * parallel if a thread pool is given) straight into its own slot, then
+ * slots are packed together in order. At return, the points of the i-th
+ * packet are [pkt_first[i], pkt_first[i+1]) */
+void velodyne_scan_to_pointcloud(
+	const CObservationVelodyneScan& scan,
+	const CObservationVelodyneScan::TGeneratePointCloudParameters& params,
+	CObservationVelodyneScan::TPointCloud& pc, std::vector<size_t>& pkt_first)
 {
-	struct PointCloudStorageWrapper_Inner : public PointCloudStorageWrapper
-	{
-		CObservationVelodyneScan& me_;
-		const TGeneratePointCloudParameters& params_;
-		PointCloudStorageWrapper_Inner(
-			CObservationVelodyneScan& me,
-			const TGeneratePointCloudParameters& p)
-			: me_(me), params_(p)
+	const size_t nPkts = scan.scan_packets.size();
+	pkt_first.assign(nPkts + 1, 0);
+	pc.clear();
+	if (!nPkts) return;
+
+	const TVelodyneDecodeLUT lut(scan.calibration);
+
+	// Access to sin/cos table:
+	mrpt::obs::T2DScanProperties scan_props;
+	scan_props.aperture = 2 * M_PI;
+	scan_props.nRays = CObservationVelodyneScan::ROTATION_MAX_UNITS;
+	scan_props.rightToLeft = true;
+	// The LUT contains sin/cos values for angles in this order: [180deg ... 0
+	// deg ... -180 deg]
+	const CSinCosLookUpTableFor2DScans::TSinCosValues& lut_sincos =
+		velodyne_sincos_tables.getSinCosForScan(scan_props);
+
+	const size_t nMax = nPkts * MAX_POINTS_PER_PACKET;
+	pc.x.resize(nMax);
+	pc.y.resize(nMax);
+	pc.z.resize(nMax);
+	pc.intensity.resize(nMax);
+	if (params.generatePerPointAzimuth) pc.azimuth.resize(nMax);
+
+	std::vector<size_t> counts(nPkts);
+	auto decodePackets = [&](size_t p0, size_t p1) {
+		for (size_t p = p0; p < p1; p++)
 		{
-			// Reset point cloud:
-			me_.point_cloud.clear();
+			const size_t first = p * MAX_POINTS_PER_PACKET;
+			TDecodedPointsOut out;
+			out.x = &pc.x[first];
+			out.y = &pc.y[first];
+			out.z = &pc.z[first];
+			out.intensity = &pc.intensity[first];
+			out.azimuth =
+				params.generatePerPointAzimuth ? &pc.azimuth[first] : nullptr;
+			counts[p] = decodePacket(scan, p, lut, params, lut_sincos, out);
 		}
-		void add_point(
-			double pt_x, double pt_y, double pt_z, uint8_t pt_intensity,
-			const mrpt::system::TTimeStamp& tim, const float azimuth) override
+	};
+	if (params.threadPool)
+		params.threadPool->parallel_for(nPkts, decodePackets, 8);
+	else
+		decodePackets(0, nPkts);
+
+	// Pack the slots (destination is never after the source):
+	size_t n = 0;
+	for (size_t p = 0; p < nPkts; p++)
+	{
+		pkt_first[p] = n;
+		const size_t src = p * MAX_POINTS_PER_PACKET, cnt = counts[p];
+		if (src != n)
 		{
-			me_.point_cloud.x.push_back(pt_x);
-			me_.point_cloud.y.push_back(pt_y);
-			me_.point_cloud.z.push_back(pt_z);
-			me_.point_cloud.intensity.push_back(pt_intensity);
-			if (params_.generatePerPointTimestamp)
-			{
-				me_.point_cloud.timestamp.push_back(tim);
-			}
-			if (params_.generatePerPointAzimuth)
-			{
-				const int azimuth_corrected =
-					((int)round(azimuth)) %
-					CObservationVelodyneScan::ROTATION_MAX_UNITS;
-				me_.point_cloud.azimuth.push_back(
-					azimuth_corrected * ROTATION_RESOLUTION);
-			}
+			std::copy(&pc.x[src], &pc.x[src] + cnt, &pc.x[n]);
+			std::copy(&pc.y[src], &pc.y[src] + cnt, &pc.y[n]);
+			std::copy(&pc.z[src], &pc.z[src] + cnt, &pc.z[n]);
+			std::copy(
+				&pc.intensity[src], &pc.intensity[src] + cnt,
+				&pc.intensity[n]);
+			if (params.generatePerPointAzimuth)
+				std::copy(
+					&pc.azimuth[src], &pc.azimuth[src] + cnt, &pc.azimuth[n]);
 		}
-	};
+		n += cnt;
+	}
+	pkt_first[nPkts] = n;
+
+	pc.x.resize(n);
+	pc.y.resize(n);
+	pc.z.resize(n);
+	pc.intensity.resize(n);
+	if (params.generatePerPointAzimuth) pc.azimuth.resize(n);
+}
+}  // namespace
 
-	PointCloudStorageWrapper_Inner my_pc_wrap(*this, params);
+void CObservationVelodyneScan::generatePointCloud(
+	const TGeneratePointCloudParameters& params)
+{
+	thread_local std::vector<size_t> pkt_first;
+	velodyne_scan_to_pointcloud(*this, params, point_cloud, pkt_first);
 
-	velodyne_scan_to_pointcloud(*this, params, my_pc_wrap);
+	if (params.generatePerPointTimestamp)
+	{
+		point_cloud.timestamp.resize(point_cloud.size());
+		for (size_t p = 0; p < scan_packets.size(); p++)
+		{
+			const mrpt::system::TTimeStamp pkt_tim = packetTimestamp(*this, p);
+			std::fill(
+				point_cloud.timestamp.begin() + pkt_first[p],
+				point_cloud.timestamp.begin() + pkt_first[p + 1], pkt_tim);
+		}
+	}
 }
 
 void CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory(
@@ -497,64 +569,72 @@ void CObservationVelodyneScan::generatePointCloudAlongSE3Trajectory(
 	TGeneratePointCloudSE3Results& results_stats,
 	const TGeneratePointCloudParameters& params)
 {
-	// Pre-alloc mem:
-	out_points.reserve(
-		out_points.size() +
-		scan_packets.size() * BLOCKS_PER_PACKET * SCANS_PER_BLOCK + 16);
-
-	struct PointCloudStorageWrapper_SE3_Interp : public PointCloudStorageWrapper
-	{
-		CObservationVelodyneScan& me_;
-		const mrpt::poses::CPose3DInterpolator& vehicle_path_;
-		std::vector<mrpt::math::TPointXYZIu8>& out_points_;
-		TGeneratePointCloudSE3Results& results_stats_;
-		mrpt::system::TTimeStamp last_query_tim_;
-		mrpt::poses::CPose3D last_query_;
-		bool last_query_valid_;
-
-		PointCloudStorageWrapper_SE3_Interp(
-			CObservationVelodyneScan& me,
-			const mrpt::poses::CPose3DInterpolator& vehicle_path,
-			std::vector<mrpt::math::TPointXYZIu8>& out_points,
-			TGeneratePointCloudSE3Results& results_stats)
-			: me_(me),
-			  vehicle_path_(vehicle_path),
-			  out_points_(out_points),
-			  results_stats_(results_stats),
-			  last_query_tim_(INVALID_TIMESTAMP),
-			  last_query_valid_(false)
+	// Local points, in reusable buffers (referenced from the worker threads
+	// through these references, not by the names of the thread_local vars):
+	thread_local TPointCloud tl_pc;
+	thread_local std::vector<size_t> tl_pkt_first;
+	TPointCloud& pc = tl_pc;
+	std::vector<size_t>& pkt_first = tl_pkt_first;
+	TGeneratePointCloudParameters local_params = params;
+	local_params.generatePerPointAzimuth = false;
+	velodyne_scan_to_pointcloud(*this, local_params, pc, pkt_first);
+
+	// All points of a packet share its timestamp, hence the vehicle pose:
+	const size_t nPkts = scan_packets.size();
+	mrpt::aligned_std_vector<mrpt::poses::CPose3D> pkt_pose(nPkts);
+	std::vector<char> pkt_pose_valid(nPkts, 0);
+	auto interpPoses = [&](size_t p0, size_t p1) {
+		for (size_t p = p0; p < p1; p++)
 		{
+			if (pkt_first[p] == pkt_first[p + 1]) continue;
+			mrpt::poses::CPose3D veh_pose;
+			bool valid = false;
+			vehicle_path.interpolate(packetTimestamp(*this, p), veh_pose, valid);
+			if (!valid) continue;
+			pkt_pose[p].composeFrom(veh_pose, sensorPose);
+			pkt_pose_valid[p] = 1;
 		}
-		void add_point(
-			double pt_x, double pt_y, double pt_z, uint8_t pt_intensity,
-			const mrpt::system::TTimeStamp& tim, const float azimuth) override
-		{
-			// Use a cache since it's expected that the same timestamp is
-			// queried several times in a row:
-			if (last_query_tim_ != tim)
-			{
-				last_query_tim_ = tim;
-				vehicle_path_.interpolate(tim, last_query_, last_query_valid_);
-			}
+	};
 
-			if (last_query_valid_)
+	// Points are APPENDED, packets with a valid pose in order:
+	std::vector<size_t> out_first(nPkts + 1);
+	auto transformPoints = [&](size_t p0, size_t p1) {
+		for (size_t p = p0; p < p1; p++)
+		{
+			if (!pkt_pose_valid[p]) continue;
+			const mrpt::poses::CPose3D& global_sensor_pose = pkt_pose[p];
+			size_t o = out_first[p];
+			for (size_t i = pkt_first[p]; i < pkt_first[p + 1]; i++, o++)
 			{
-				mrpt::poses::CPose3D global_sensor_pose(
-					mrpt::poses::UNINITIALIZED_POSE);
-				global_sensor_pose.composeFrom(last_query_, me_.sensorPose);
 				double gx, gy, gz;
-				global_sensor_pose.composePoint(pt_x, pt_y, pt_z, gx, gy, gz);
-				out_points_.push_back(
-					mrpt::math::TPointXYZIu8(gx, gy, gz, pt_intensity));
-				++results_stats_.num_correctly_inserted_points;
+				global_sensor_pose.composePoint(
+					pc.x[i], pc.y[i], pc.z[i], gx, gy, gz);
+				out_points[o] =
+					mrpt::math::TPointXYZIu8(gx, gy, gz, pc.intensity[i]);
 			}
-			++results_stats_.num_points;
 		}
 	};
 
-	PointCloudStorageWrapper_SE3_Interp my_pc_wrap(
-		*this, vehicle_path, out_points, results_stats);
-	velodyne_scan_to_pointcloud(*this, params, my_pc_wrap);
+	if (params.threadPool)
+		params.threadPool->parallel_for(nPkts, interpPoses, 8);
+	else
+		interpPoses(0, nPkts);
+
+	size_t n = out_points.size();
+	for (size_t p = 0; p < nPkts; p++)
+	{
+		out_first[p] = n;
+		if (pkt_pose_valid[p]) n += pkt_first[p + 1] - pkt_first[p];
+	}
+	out_first[nPkts] = n;
+	results_stats.num_points += pc.size();
+	results_stats.num_correctly_inserted_points += n - out_points.size();
+	out_points.resize(n);
+
+	if (params.threadPool)
+		params.threadPool->parallel_for(nPkts, transformPoints, 8);
+	else
+		transformPoints(0, nPkts);
 }
 
 void CObservationVelodyneScan::TPointCloud::clear()
@@ -0,0 +1,143 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CObservationVelodyneScan.h>
+#include <mrpt/poses/CPose3DInterpolator.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt::obs;
+
+// A full turn of a VLP-16 in strongest return mode, with random ranges:
+static void fillSampleVLP16Scan(CObservationVelodyneScan& scan)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+
+	scan.timestamp = mrpt::system::time_tToTimestamp(1500000000.0);
+	scan.calibration = VelodyneCalibration::LoadDefaultCalibration("VLP16");
+	scan.scan_packets.resize(75);
+	uint16_t rotation = 0;
+	for (size_t p = 0; p < scan.scan_packets.size(); p++)
+	{
+		auto& pkt = scan.scan_packets[p];
+		pkt.gps_timestamp = 1000 + 1327 * p;
+		pkt.laser_return_mode = CObservationVelodyneScan::RETMODE_STRONGEST;
+		pkt.velodyne_model_ID = 0x22;
+		for (auto& blk : pkt.blocks)
+		{
+			blk.header = CObservationVelodyneScan::UPPER_BANK;
+			blk.rotation = rotation;
+			rotation = (rotation + 40) % 36000;
+			for (auto& ret : blk.laser_returns)
+			{
+				// 0 (no return) or 2-60 m
+				ret.distance = rng.drawUniform32bit() % 8 == 0
+								   ? 0
+								   : 1000 + rng.drawUniform32bit() % 29000;
+				ret.intensity = rng.drawUniform32bit() & 0xff;
+			}
+		}
+	}
+}
+
+TEST(CObservationVelodyneScan, generatePointCloud)
+{
+	CObservationVelodyneScan scan;
+	fillSampleVLP16Scan(scan);
+
+	CObservationVelodyneScan::TGeneratePointCloudParameters p;
+	p.generatePerPointAzimuth = true;
+	p.generatePerPointTimestamp = true;
+	scan.generatePointCloud(p);
+
+	const auto& pc = scan.point_cloud;
+	ASSERT_GT(pc.size(), 0u);
+	ASSERT_EQ(pc.azimuth.size(), pc.size());
+	ASSERT_EQ(pc.timestamp.size(), pc.size());
+
+	// The default VLP-16 calibration has no offsets: each point is at the
+	// range and azimuth of its return.
+	size_t nExpected = 0;
+	for (const auto& pkt : scan.scan_packets)
+		for (const auto& blk : pkt.blocks)
+			for (int k = 0; k < 16; k++)
+				if (blk.laser_returns[k].distance) nExpected++;
+	EXPECT_EQ(pc.size(), nExpected);
+
+	for (size_t i = 0; i < pc.size(); i++)
+	{
+		const double r = std::sqrt(
+			pc.x[i] * pc.x[i] + pc.y[i] * pc.y[i] + pc.z[i] * pc.z[i]);
+		EXPECT_GT(r, 1.9);
+		EXPECT_LT(r, 60.1);
+		const double az = mrpt::DEG2RAD(pc.azimuth[i]);
+		const double xy = std::sqrt(pc.x[i] * pc.x[i] + pc.y[i] * pc.y[i]);
+		EXPECT_NEAR(pc.x[i], xy * std::cos(az), 1e-3 * xy);
+		EXPECT_NEAR(pc.y[i], -xy * std::sin(az), 1e-3 * xy);
+		if (i > 0)
+		{
+			EXPECT_GE(pc.timestamp[i], pc.timestamp[i - 1]);
+		}
+	}
+	EXPECT_EQ(pc.timestamp.front(), scan.timestamp);
+
+	// Same result with threads:
+	mrpt::system::CWorkerThreadsPool pool(3);
+	CObservationVelodyneScan scan_mt = scan;
+	p.threadPool = &pool;
+	scan_mt.generatePointCloud(p);
+	EXPECT_EQ(scan_mt.point_cloud.x, pc.x);
+	EXPECT_EQ(scan_mt.point_cloud.y, pc.y);
+	EXPECT_EQ(scan_mt.point_cloud.z, pc.z);
+	EXPECT_EQ(scan_mt.point_cloud.intensity, pc.intensity);
+	EXPECT_EQ(scan_mt.point_cloud.azimuth, pc.azimuth);
+	EXPECT_EQ(scan_mt.point_cloud.timestamp, pc.timestamp);
+}
+
+TEST(CObservationVelodyneScan, generatePointCloudAlongSE3Trajectory)
+{
+	CObservationVelodyneScan scan;
+	fillSampleVLP16Scan(scan);
+	scan.sensorPose = mrpt::poses::CPose3D(0.5, 0, 1.0, 0, 0, 0);
+	scan.generatePointCloud();
+
+	// The vehicle moves along +X at 10 m/s, only known for the second
+	// half of the scan:
+	mrpt::poses::CPose3DInterpolator path;
+	for (int i = 5; i < 15; i++)
+		path.insert(
+			mrpt::system::timestampAdd(scan.timestamp, i * 0.01),
+			mrpt::math::TPose3D(i * 0.1, 0, 0, 0, 0, 0));
+
+	mrpt::system::CWorkerThreadsPool pool(2);
+	std::vector<mrpt::math::TPointXYZIu8> pts[2];
+	for (int t = 0; t < 2; t++)
+	{
+		CObservationVelodyneScan::TGeneratePointCloudParameters p;
+		if (t == 1) p.threadPool = &pool;
+		// Points are appended:
+		pts[t].resize(1);
+		CObservationVelodyneScan::TGeneratePointCloudSE3Results res;
+		scan.generatePointCloudAlongSE3Trajectory(path, pts[t], res, p);
+		EXPECT_EQ(res.num_points, scan.point_cloud.size());
+		EXPECT_GT(res.num_correctly_inserted_points, 0u);
+		EXPECT_LT(res.num_correctly_inserted_points, res.num_points);
+		EXPECT_EQ(pts[t].size(), 1 + res.num_correctly_inserted_points);
+	}
+	ASSERT_EQ(pts[0].size(), pts[1].size());
+	for (size_t i = 1; i < pts[0].size(); i++)
+	{
+		EXPECT_EQ(pts[0][i].pt.x, pts[1][i].pt.x);
+		EXPECT_EQ(pts[0][i].pt.y, pts[1][i].pt.y);
+		EXPECT_EQ(pts[0][i].pt.z, pts[1][i].pt.z);
+		EXPECT_EQ(pts[0][i].intensity, pts[1][i].intensity);
+	}
+}
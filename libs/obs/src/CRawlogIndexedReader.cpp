@@ -0,0 +1,365 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "obs-precomp.h"  // Precompiled headers
+
+#include <mrpt/obs/CRawlogIndexedReader.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/io/CFileInputStream.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/filesystem.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace mrpt::obs;
+using namespace mrpt::io;
+using namespace mrpt::serialization;
+using namespace mrpt::system;
+
+namespace
+{
+/** Sidecar index file format version */
+const uint32_t INDEX_FILE_MAGIC = 0x58444952;  // "RIDX"
+const uint32_t INDEX_FILE_VERSION = 1;
+
+/** Timestamp to be stored in the index for an object read from a rawlog */
+TTimeStamp entryTimestamp(const CSerializable::Ptr& obj)
+{
+	if (auto o = std::dynamic_pointer_cast<CObservation>(obj))
+		return o->timestamp;
+	if (auto sf = std::dynamic_pointer_cast<CSensoryFrame>(obj))
+		return sf->size() ? (*sf->begin())->timestamp : INVALID_TIMESTAMP;
+	if (auto acts = std::dynamic_pointer_cast<CActionCollection>(obj))
+		return acts->size() ? acts->get(0)->timestamp : INVALID_TIMESTAMP;
+	return INVALID_TIMESTAMP;
+}
+}  // namespace
+
+CRawlogIndexedReader::CRawlogIndexedReader() {}
+CRawlogIndexedReader::CRawlogIndexedReader(
+	const std::string& fileName, bool useIndexFile)
+{
+	MRPT_START
+	if (!open(fileName, useIndexFile))
+		THROW_EXCEPTION_FMT("Error opening rawlog file `%s`", fileName.c_str());
+	MRPT_END
+}
+
+CRawlogIndexedReader::~CRawlogIndexedReader() { close(); }
+bool CRawlogIndexedReader::open(const std::string& fileName, bool useIndexFile)
+{
+	MRPT_START
+
+	close();
+	if (!mrpt::system::fileExists(fileName) || !m_file.open(fileName))
+		return false;
+	m_fileName = fileName;
+
+	if (!useIndexFile || !loadIndexFile())
+	{
+		buildIndex();
+		if (useIndexFile) saveIndexFile();
+	}
+
+	// Timestamp look-up table:
+	m_sortedByTime.clear();
+	m_sortedByTime.reserve(m_timestamps.size());
+	for (size_t i = 0; i < m_timestamps.size(); i++)
+		if (m_timestamps[i] != INVALID_TIMESTAMP)
+			m_sortedByTime.emplace_back(m_timestamps[i], i);
+	std::stable_sort(
+		m_sortedByTime.begin(), m_sortedByTime.end(),
+		[](const std::pair<TTimeStamp, size_t>& a,
+		   const std::pair<TTimeStamp, size_t>& b) {
+			return a.first < b.first;
+		});
+
+	rewind(0);
+	return true;
+
+	MRPT_END
+}
+
+void CRawlogIndexedReader::close()
+{
+	stopPrefetch();
+	m_file.close();
+	m_fileName.clear();
+	m_offsets.clear();
+	m_timestamps.clear();
+	m_classIdxs.clear();
+	m_classNames.clear();
+	m_sortedByTime.clear();
+	m_nextIndex = 0;
+}
+
+void CRawlogIndexedReader::buildIndex()
+{
+	MRPT_START
+
+	m_offsets.clear();
+	m_timestamps.clear();
+	m_classIdxs.clear();
+	m_classNames.clear();
+
+	m_file.Seek(0);
+	auto arch = archiveFrom(m_file);
+	for (;;)
+	{
+		const uint64_t pos = m_file.getPosition();
+		CSerializable::Ptr obj;
+		try
+		{
+			arch >> obj;
+		}
+		catch (CExceptionEOF&)
+		{
+			break;
+		}
+		catch (std::exception& e)
+		{
+			// Truncated or corrupted rawlog: index up to the last good entry,
+			// as CRawlog::loadFromRawLogFile() does.
+			std::cerr << "[CRawlogIndexedReader] Stopped parsing `"
+					  << m_fileName << "` at entry #" << m_offsets.size()
+					  << ":\n"
+					  << e.what() << std::endl;
+			break;
+		}
+		if (!obj) break;
+
+		const std::string className = obj->GetRuntimeClass()->className;
+		auto it =
+			std::find(m_classNames.begin(), m_classNames.end(), className);
+		if (it == m_classNames.end())
+		{
+			ASSERT_BELOW_(m_classNames.size(), 0xFFFFu);
+			it = m_classNames.insert(m_classNames.end(), className);
+		}
+
+		m_offsets.push_back(pos);
+		m_timestamps.push_back(entryTimestamp(obj));
+		m_classIdxs.push_back(
+			static_cast<uint16_t>(it - m_classNames.begin()));
+	}
+
+	MRPT_END
+}
+
+bool CRawlogIndexedReader::loadIndexFile()
+{
+	const std::string idxFile = getIndexFileName(m_fileName);
+	if (!mrpt::system::fileExists(idxFile)) return false;
+	try
+	{
+		CFileInputStream f(idxFile);
+		auto arch = archiveFrom(f);
+		uint32_t magic, version;
+		uint64_t fileSize, fileTime, N;
+		arch >> magic >> version >> fileSize >> fileTime;
+		if (magic != INDEX_FILE_MAGIC || version != INDEX_FILE_VERSION ||
+			fileSize != mrpt::system::getFileSize(m_fileName) ||
+			fileTime != static_cast<uint64_t>(
+							mrpt::system::getFileModificationTime(m_fileName)))
+			return false;  // Outdated index
+
+		arch >> m_classNames >> N;
+		m_offsets.resize(N);
+		m_timestamps.resize(N);
+		m_classIdxs.resize(N);
+		if (N)
+		{
+			arch.ReadBufferFixEndianness(m_offsets.data(), N);
+			arch.ReadBufferFixEndianness(m_timestamps.data(), N);
+			arch.ReadBufferFixEndianness(m_classIdxs.data(), N);
+		}
+		for (const auto idx : m_classIdxs)
+			ASSERT_BELOW_(idx, m_classNames.size());
+		return true;
+	}
+	catch (std::exception&)
+	{
+		// Corrupted index: rebuild it.
+		m_offsets.clear();
+		m_timestamps.clear();
+		m_classIdxs.clear();
+		m_classNames.clear();
+		return false;
+	}
+}
+
+void CRawlogIndexedReader::saveIndexFile() const
+{
+	// Not being able to write the index (e.g. a read-only directory) is not
+	// an error: it will be just built again next time.
+	try
+	{
+		CFileOutputStream f;
+		if (!f.open(getIndexFileName(m_fileName))) return;
+		auto arch = archiveFrom(f);
+		const uint64_t N = m_offsets.size();
+		arch << INDEX_FILE_MAGIC << INDEX_FILE_VERSION
+			 << mrpt::system::getFileSize(m_fileName)
+			 << static_cast<uint64_t>(
+					mrpt::system::getFileModificationTime(m_fileName))
+			 << m_classNames << N;
+		if (N)
+		{
+			arch.WriteBufferFixEndianness(m_offsets.data(), N);
+			arch.WriteBufferFixEndianness(m_timestamps.data(), N);
+			arch.WriteBufferFixEndianness(m_classIdxs.data(), N);
+		}
+	}
+	catch (std::exception&)
+	{
+	}
+}
+
+TTimeStamp CRawlogIndexedReader::getEntryTimestamp(size_t index) const
+{
+	ASSERT_BELOW_(index, m_timestamps.size());
+	return m_timestamps[index];
+}
+
+const std::string& CRawlogIndexedReader::getEntryClassName(size_t index) const
+{
+	ASSERT_BELOW_(index, m_classIdxs.size());
+	return m_classNames[m_classIdxs[index]];
+}
+
+CSerializable::Ptr CRawlogIndexedReader::getEntry(size_t index)
+{
+	MRPT_START
+	ASSERT_BELOW_(index, m_offsets.size());
+	// (Seeking to the current position is free, even in gz files)
+	if (m_file.getPosition() != m_offsets[index]) m_file.Seek(m_offsets[index]);
+	auto arch = archiveFrom(m_file);
+	return arch.ReadObject();
+	MRPT_END
+}
+
+size_t CRawlogIndexedReader::findEntryByTimestamp(const TTimeStamp t) const
+{
+	auto it = std::lower_bound(
+		m_sortedByTime.begin(), m_sortedByTime.end(), t,
+		[](const std::pair<TTimeStamp, size_t>& a, const TTimeStamp b) {
+			return a.first < b;
+		});
+	return it == m_sortedByTime.end() ? size() : it->second;
+}
+
+void CRawlogIndexedReader::rewind(size_t index)
+{
+	stopPrefetch();
+	m_nextIndex = std::min(index, size());
+	if (m_prefetchSize) startPrefetch();
+}
+
+bool CRawlogIndexedReader::next(CSerializable::Ptr& obj)
+{
+	MRPT_START
+	if (m_nextIndex >= size()) return false;
+
+	if (!m_prefetchSize)
+	{
+		obj = getEntry(m_nextIndex++);
+		return true;
+	}
+
+	std::unique_lock<std::mutex> lck(m_prefetchMtx);
+	m_prefetchCV.wait(lck, [this]() {
+		return !m_prefetched.empty() || m_prefetchEOF || m_prefetchError;
+	});
+	if (m_prefetched.empty())
+	{
+		if (m_prefetchError) std::rethrow_exception(m_prefetchError);
+		return false;
+	}
+	obj = std::move(m_prefetched.front());
+	m_prefetched.pop_front();
+	m_nextIndex++;
+	lck.unlock();
+	m_prefetchCV.notify_all();  // There is room for one more
+	return true;
+	MRPT_END
+}
+
+void CRawlogIndexedReader::setPrefetchSize(size_t numEntries)
+{
+	if (numEntries == m_prefetchSize) return;
+	stopPrefetch();
+	m_prefetchSize = numEntries;
+	if (m_prefetchSize && isOpen()) startPrefetch();
+}
+
+void CRawlogIndexedReader::startPrefetch()
+{
+	ASSERT_(!m_prefetchThread.joinable());
+	m_prefetched.clear();
+	m_prefetchStop = false;
+	m_prefetchEOF = false;
+	m_prefetchError = nullptr;
+	m_prefetchThread = std::thread(
+		&CRawlogIndexedReader::prefetchThreadMain, this, m_nextIndex);
+}
+
+void CRawlogIndexedReader::stopPrefetch()
+{
+	if (!m_prefetchThread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lck(m_prefetchMtx);
+		m_prefetchStop = true;
+	}
+	m_prefetchCV.notify_all();
+	m_prefetchThread.join();
+	m_prefetched.clear();
+}
+
+void CRawlogIndexedReader::prefetchThreadMain(size_t firstIndex)
+{
+	try
+	{
+		// Use a stream of our own, so getEntry() can still be used while
+		// iterating:
+		CFileGZInputStream f(m_fileName);
+		if (firstIndex < m_offsets.size()) f.Seek(m_offsets[firstIndex]);
+		auto arch = archiveFrom(f);
+
+		for (size_t i = firstIndex; i < m_offsets.size(); i++)
+		{
+			{
+				std::unique_lock<std::mutex> lck(m_prefetchMtx);
+				m_prefetchCV.wait(lck, [this]() {
+					return m_prefetchStop ||
+						   m_prefetched.size() < m_prefetchSize;
+				});
+				if (m_prefetchStop) return;
+			}
+			// Deserialize without holding the lock:
+			CSerializable::Ptr obj = arch.ReadObject();
+			{
+				std::lock_guard<std::mutex> lck(m_prefetchMtx);
+				m_prefetched.push_back(std::move(obj));
+			}
+			m_prefetchCV.notify_all();
+		}
+		{
+			std::lock_guard<std::mutex> lck(m_prefetchMtx);
+			m_prefetchEOF = true;
+		}
+	}
+	catch (...)
+	{
+		std::lock_guard<std::mutex> lck(m_prefetchMtx);
+		m_prefetchError = std::current_exception();
+	}
+	m_prefetchCV.notify_all();
+}
@@ -0,0 +1,168 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/obs/CRawlogIndexedReader.h>
+#include <mrpt/obs/CObservationOdometry.h>
+#include <mrpt/obs/CSensoryFrame.h>
+#include <mrpt/io/CFileOutputStream.h>
+#include <mrpt/io/CFileGZOutputStream.h>
+#include <mrpt/serialization/CArchive.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt::obs;
+using namespace mrpt::serialization;
+
+namespace
+{
+const size_t NUM_ENTRIES = 50;
+const mrpt::system::TTimeStamp T0 = 1000000;
+
+// Entry #i: an odometry observation with "encoderLeftTicks=i", or, for
+// every 10th entry, a sensory frame with one of them.
+void writeTestRawlog(CArchive& arch)
+{
+	for (size_t i = 0; i < NUM_ENTRIES; i++)
+	{
+		auto obs = mrpt::make_aligned_shared<CObservationOdometry>();
+		obs->timestamp = T0 + 10 * i;
+		obs->hasEncodersInfo = true;
+		obs->encoderLeftTicks = static_cast<int32_t>(i);
+		if (i % 10 == 0)
+		{
+			CSensoryFrame sf;
+			sf.insert(obs);
+			arch << sf;
+		}
+		else
+			arch << *obs;
+	}
+}
+
+int32_t entryId(const CSerializable::Ptr& obj)
+{
+	CObservationOdometry::Ptr o;
+	if (auto sf = std::dynamic_pointer_cast<CSensoryFrame>(obj))
+		o = sf->getObservationByClass<CObservationOdometry>();
+	else
+		o = std::dynamic_pointer_cast<CObservationOdometry>(obj);
+	return o ? o->encoderLeftTicks : -1;
+}
+
+void testReader(const std::string& fil)
+{
+	const std::string idxFil = CRawlogIndexedReader::getIndexFileName(fil);
+	mrpt::system::deleteFile(idxFil);
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		// 1st pass builds the index, 2nd pass must reuse it:
+		EXPECT_EQ(pass == 1, mrpt::system::fileExists(idxFil));
+
+		CRawlogIndexedReader rawlog(fil);
+		ASSERT_EQ(rawlog.size(), NUM_ENTRIES);
+		EXPECT_TRUE(mrpt::system::fileExists(idxFil));
+
+		for (size_t i = 0; i < NUM_ENTRIES; i++)
+		{
+			EXPECT_EQ(rawlog.getEntryTimestamp(i), T0 + 10 * i);
+			EXPECT_EQ(
+				rawlog.getEntryClassName(i), (i % 10 == 0)
+												 ? "CSensoryFrame"
+												 : "CObservationOdometry");
+		}
+
+		// Random access, including backwards jumps:
+		for (size_t i : {7, 33, 2, 0, 49, 20, 21, 5})
+			EXPECT_EQ(entryId(rawlog.getEntry(i)), static_cast<int32_t>(i));
+
+		// Search by timestamp:
+		EXPECT_EQ(rawlog.findEntryByTimestamp(0), 0u);
+		EXPECT_EQ(rawlog.findEntryByTimestamp(T0 + 10 * 13), 13u);
+		EXPECT_EQ(rawlog.findEntryByTimestamp(T0 + 10 * 13 + 1), 14u);
+		EXPECT_EQ(rawlog.findEntryByTimestamp(T0 + 10000), NUM_ENTRIES);
+
+		// Sequential reads, w/o and with read-ahead:
+		for (size_t prefetch : {0, 1, 8})
+		{
+			rawlog.setPrefetchSize(prefetch);
+			rawlog.rewind(3);
+			CSerializable::Ptr obj;
+			size_t i = 3;
+			while (rawlog.next(obj))
+			{
+				EXPECT_EQ(entryId(obj), static_cast<int32_t>(i));
+				// Random access does not interfere with next():
+				if (i == 25)
+				{
+					EXPECT_EQ(entryId(rawlog.getEntry(4)), 4);
+				}
+				i++;
+			}
+			EXPECT_EQ(i, NUM_ENTRIES);
+			EXPECT_EQ(rawlog.tell(), NUM_ENTRIES);
+		}
+	}
+
+	mrpt::system::deleteFile(idxFil);
+	mrpt::system::deleteFile(fil);
+}
+}  // namespace
+
+TEST(CRawlogIndexedReader, plainFile)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	{
+		mrpt::io::CFileOutputStream f(fil);
+		auto arch = archiveFrom(f);
+		writeTestRawlog(arch);
+	}
+	testReader(fil);
+}
+
+TEST(CRawlogIndexedReader, gzFile)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	{
+		mrpt::io::CFileGZOutputStream f(fil);
+		auto arch = archiveFrom(f);
+		writeTestRawlog(arch);
+	}
+	testReader(fil);
+}
+
+TEST(CRawlogIndexedReader, outdatedIndexIsRebuilt)
+{
+	const std::string fil = mrpt::system::getTempFileName();
+	{
+		mrpt::io::CFileOutputStream f(fil);
+		auto arch = archiveFrom(f);
+		writeTestRawlog(arch);
+	}
+	{
+		CRawlogIndexedReader rawlog(fil);
+		EXPECT_EQ(rawlog.size(), NUM_ENTRIES);
+	}
+	{
+		// Append one more entry: the file size changes
+		mrpt::io::CFileOutputStream f(fil, true /*append*/);
+		auto arch = archiveFrom(f);
+		CObservationOdometry obs;
+		obs.timestamp = T0 + 10 * NUM_ENTRIES;
+		arch << obs;
+	}
+	{
+		CRawlogIndexedReader rawlog(fil);
+		EXPECT_EQ(rawlog.size(), NUM_ENTRIES + 1);
+		EXPECT_EQ(
+			rawlog.getEntryTimestamp(NUM_ENTRIES), T0 + 10 * NUM_ENTRIES);
+	}
+	mrpt::system::deleteFile(CRawlogIndexedReader::getIndexFileName(fil));
+	mrpt::system::deleteFile(fil);
+}
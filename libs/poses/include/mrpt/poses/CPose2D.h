@@ -186,6 +186,34 @@ class CPose2D : public CPose<CPose2D>, public mrpt::serialization::CSerializable
 		inverseComposePoint(g.x, g.y, l.x, l.y);
 	}
 
+	/** Batch version of composePoint() for `N` points given as a
+	 * structure-of-arrays. Computations are done in double precision, 4
+	 * points at a time if AVX2 is available. The output buffers may be the
+	 * input ones (in-place).
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void composePoints(
+		const float* lx, const float* ly, const std::size_t N, float* gx,
+		float* gy) const;
+
+	/** Batch version of inverseComposePoint(), for points given as a
+	 * structure-of-arrays. \sa composePoints
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void inverseComposePoints(
+		const float* gx, const float* gy, const std::size_t N, float* lx,
+		float* ly) const;
+
+	/** Batch pose composition for `N` poses given as a structure-of-arrays:
+	 * `out[i] = this (+) in[i]`. Output angles are wrapped to ]-pi,pi]. The
+	 * output buffers may be the input ones (in-place).
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void composePoses(
+		const double* in_x, const double* in_y, const double* in_phi,
+		const std::size_t N, double* out_x, double* out_y,
+		double* out_phi) const;
+
 	/** The operator \f$ u' = this \oplus u \f$ is the pose/point compounding
 	 * operator. */
 	CPoint3D operator+(const CPoint3D& u) const;
@@ -368,6 +368,31 @@ class CPose3D : public CPose<CPose3D>, public mrpt::serialization::CSerializable
 		ASSERT_BELOW_(std::abs(lz), eps);
 	}
 
+	/** Batch version of composePoint() for `N` points given as a
+	 * structure-of-arrays (one buffer per coordinate). Computations are done in
+	 * double precision, as in composePoint(), 4 points at a time if AVX2 is
+	 * available. The output buffers may be the input ones (in-place).
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void composePoints(
+		const float* lx, const float* ly, const float* lz, const std::size_t N,
+		float* gx, float* gy, float* gz) const;
+
+	/** Batch version of inverseComposePoint(), for points given as a
+	 * structure-of-arrays. \sa composePoints
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void inverseComposePoints(
+		const float* gx, const float* gy, const float* gz, const std::size_t N,
+		float* lx, float* ly, float* lz) const;
+
+	/** Batch pose composition: `out[i] = this (+) in[i]` for `i` in
+	 * `[0,N)`. `in` and `out` may be the same array.
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void composePoses(
+		const CPose3D* in, const std::size_t N, CPose3D* out) const;
+
 	/**  Makes "this = A (+) B"; this method is slightly more efficient than
 	 * "this= A + B;" since it avoids the temporary object.
 	 *  \note A or B can be "this" without problems.
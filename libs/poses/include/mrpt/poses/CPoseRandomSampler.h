@@ -19,6 +19,10 @@
 
 namespace mrpt
 {
+namespace random
+{
+class CRandomGenerator;
+}
 namespace poses
 {
 /** An efficient generator of random samples drawn from a given 2D (CPosePDF) or
@@ -60,9 +64,9 @@ class CPoseRandomSampler
 	void clear();
 
 	/** Used internally: sample from m_pdf2D */
-	void do_sample_2D(CPose2D& p) const;
+	void do_sample_2D(CPose2D& p, mrpt::random::CRandomGenerator& rng) const;
 	/** Used internally: sample from m_pdf3D */
-	void do_sample_3D(CPose3D& p) const;
+	void do_sample_3D(CPose3D& p, mrpt::random::CRandomGenerator& rng) const;
 
    public:
 	/** Default constructor */
@@ -113,6 +117,17 @@ class CPoseRandomSampler
 	  */
 	CPose3D& drawSample(CPose3D& p) const;
 
+	/** Like drawSample(), but using the given random generator instead of
+	 * mrpt::random::getRandomGenerator(), so samples can be drawn from
+	 * several threads at once, each one with its own generator.
+	 * \note [New in MRPT 2.0.0]
+	 */
+	CPose2D& drawSample(
+		CPose2D& p, mrpt::random::CRandomGenerator& rng) const;
+	/** \overload */
+	CPose3D& drawSample(
+		CPose3D& p, mrpt::random::CRandomGenerator& rng) const;
+
 	/** Return true if samples can be generated, which only requires a previous
 	 * call to setPosePDF */
 	bool isPrepared() const;
@@ -17,6 +17,9 @@
 #include <mrpt/math/wrap2pi.h>
 #include <mrpt/config.h>  // HAVE_SINCOS
 #include <limits>
+#if MRPT_HAS_AVX2
+#include <immintrin.h>
+#endif
 
 using namespace mrpt;
 using namespace mrpt::math;
@@ -215,6 +218,80 @@ void CPose2D::inverseComposePoint(
 	ly = -Ax * m_sinphi + Ay * m_cosphi;
 }
 
+namespace
+{
+/** o_i = R(c,s) * i_i + t, for 2D points in structure-of-arrays buffers,
+ * with R=[c -s;s c], computed in double precision. */
+void transformPoints2DSoA(
+	const double c, const double s, const double tx, const double ty,
+	const float* ix, const float* iy, const std::size_t N, float* ox,
+	float* oy)
+{
+	std::size_t i = 0;
+#if MRPT_HAS_AVX2
+	const __m256d vc = _mm256_set1_pd(c), vs = _mm256_set1_pd(s);
+	const __m256d vtx = _mm256_set1_pd(tx), vty = _mm256_set1_pd(ty);
+	for (; i + 4 <= N; i += 4)
+	{
+		// (All inputs are loaded before storing, so in-place is safe)
+		const __m256d x = _mm256_cvtps_pd(_mm_loadu_ps(ix + i));
+		const __m256d y = _mm256_cvtps_pd(_mm_loadu_ps(iy + i));
+		const __m256d gx = _mm256_add_pd(
+			vtx, _mm256_sub_pd(_mm256_mul_pd(x, vc), _mm256_mul_pd(y, vs)));
+		const __m256d gy = _mm256_add_pd(
+			vty, _mm256_add_pd(_mm256_mul_pd(x, vs), _mm256_mul_pd(y, vc)));
+		_mm_storeu_ps(ox + i, _mm256_cvtpd_ps(gx));
+		_mm_storeu_ps(oy + i, _mm256_cvtpd_ps(gy));
+	}
+#endif
+	for (; i < N; i++)
+	{
+		const double x = ix[i], y = iy[i];
+		ox[i] = static_cast<float>(tx + x * c - y * s);
+		oy[i] = static_cast<float>(ty + x * s + y * c);
+	}
+}
+}  // namespace
+
+void CPose2D::composePoints(
+	const float* lx, const float* ly, const std::size_t N, float* gx,
+	float* gy) const
+{
+	update_cached_cos_sin();
+	transformPoints2DSoA(
+		m_cosphi, m_sinphi, m_coords[0], m_coords[1], lx, ly, N, gx, gy);
+}
+
+void CPose2D::inverseComposePoints(
+	const float* gx, const float* gy, const std::size_t N, float* lx,
+	float* ly) const
+{
+	update_cached_cos_sin();
+	// L = R^t * (G - t) = R(-phi) * G - R(-phi) * t
+	const double c = m_cosphi, s = -m_sinphi;
+	const double tx = -(m_coords[0] * c - m_coords[1] * s);
+	const double ty = -(m_coords[0] * s + m_coords[1] * c);
+	transformPoints2DSoA(c, s, tx, ty, gx, gy, N, lx, ly);
+}
+
+void CPose2D::composePoses(
+	const double* in_x, const double* in_y, const double* in_phi,
+	const std::size_t N, double* out_x, double* out_y, double* out_phi) const
+{
+	update_cached_cos_sin();
+	const double c = m_cosphi, s = m_sinphi;
+	const double tx = m_coords[0], ty = m_coords[1], phi = m_phi;
+	// (Written so the compiler can auto-vectorize it)
+	for (std::size_t i = 0; i < N; i++)
+	{
+		const double x = in_x[i], y = in_y[i];
+		out_x[i] = tx + x * c - y * s;
+		out_y[i] = ty + x * s + y * c;
+	}
+	for (std::size_t i = 0; i < N; i++)
+		out_phi[i] = mrpt::math::wrapToPi(phi + in_phi[i]);
+}
+
 /*---------------------------------------------------------------
 The operator u'="this"+u is the pose/point compounding operator.
  ---------------------------------------------------------------*/
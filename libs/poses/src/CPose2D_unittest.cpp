@@ -0,0 +1,56 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/poses/CPose2D.h>
+#include <CTraitsTest.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt;
+using namespace mrpt::poses;
+
+template class mrpt::CTraitsTest<CPose2D>;
+
+TEST(CPose2D, ComposePointsAndPosesBatch)
+{
+	const CPose2D p(1.0, -2.0, DEG2RAD(40.0));
+	const size_t N = 7;
+	std::vector<float> xs(N), ys(N), gx(N), gy(N);
+	std::vector<double> px(N), py(N), pphi(N), ox(N), oy(N), ophi(N);
+	for (size_t k = 0; k < N; k++)
+	{
+		xs[k] = 0.5f * k - 2.0f;
+		ys[k] = 3.0f - 0.25f * k;
+		px[k] = xs[k];
+		py[k] = ys[k];
+		pphi[k] = DEG2RAD(30.0 * k);
+	}
+	p.composePoints(xs.data(), ys.data(), N, gx.data(), gy.data());
+	p.composePoses(
+		px.data(), py.data(), pphi.data(), N, ox.data(), oy.data(),
+		ophi.data());
+	for (size_t k = 0; k < N; k++)
+	{
+		double x, y;
+		p.composePoint(xs[k], ys[k], x, y);
+		EXPECT_NEAR(gx[k], x, 1e-4);
+		EXPECT_NEAR(gy[k], y, 1e-4);
+
+		const CPose2D q = p + CPose2D(px[k], py[k], pphi[k]);
+		EXPECT_NEAR(ox[k], q.x(), 1e-9);
+		EXPECT_NEAR(oy[k], q.y(), 1e-9);
+		EXPECT_NEAR(ophi[k], q.phi(), 1e-9);
+	}
+
+	p.inverseComposePoints(gx.data(), gy.data(), N, gx.data(), gy.data());
+	for (size_t k = 0; k < N; k++)
+	{
+		EXPECT_NEAR(gx[k], xs[k], 1e-4);
+		EXPECT_NEAR(gy[k], ys[k], 1e-4);
+	}
+}
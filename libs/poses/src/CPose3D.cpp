@@ -38,6 +38,9 @@
 #include <mrpt/serialization/CSerializable.h>  // for CSeriali...
 #include <mrpt/core/bits_math.h>  // for square
 #include <mrpt/math/utils_matlab.h>
+#if MRPT_HAS_AVX2
+#include <immintrin.h>
+#endif
 #include <mrpt/otherlibs/sophus/so3.hpp>
 #include <mrpt/otherlibs/sophus/se3.hpp>
 
@@ -755,6 +758,85 @@ void CPose3D::inverseComposePoint(
 	}
 }
 
+namespace
+{
+/** o_i = R * i_i + t, for points in structure-of-arrays buffers, computed in
+ * double precision. R is given in row-major order. */
+void transformPointsSoA(
+	const double R[9], const double t[3], const float* ix, const float* iy,
+	const float* iz, const std::size_t N, float* ox, float* oy, float* oz)
+{
+	std::size_t i = 0;
+#if MRPT_HAS_AVX2
+	const __m256d r00 = _mm256_set1_pd(R[0]), r01 = _mm256_set1_pd(R[1]),
+				  r02 = _mm256_set1_pd(R[2]), r10 = _mm256_set1_pd(R[3]),
+				  r11 = _mm256_set1_pd(R[4]), r12 = _mm256_set1_pd(R[5]),
+				  r20 = _mm256_set1_pd(R[6]), r21 = _mm256_set1_pd(R[7]),
+				  r22 = _mm256_set1_pd(R[8]);
+	const __m256d tx = _mm256_set1_pd(t[0]), ty = _mm256_set1_pd(t[1]),
+				  tz = _mm256_set1_pd(t[2]);
+	for (; i + 4 <= N; i += 4)
+	{
+		// (All inputs are loaded before storing, so in-place is safe)
+		const __m256d x = _mm256_cvtps_pd(_mm_loadu_ps(ix + i));
+		const __m256d y = _mm256_cvtps_pd(_mm_loadu_ps(iy + i));
+		const __m256d z = _mm256_cvtps_pd(_mm_loadu_ps(iz + i));
+		const __m256d gx = _mm256_add_pd(
+			_mm256_add_pd(_mm256_mul_pd(r00, x), _mm256_mul_pd(r01, y)),
+			_mm256_add_pd(_mm256_mul_pd(r02, z), tx));
+		const __m256d gy = _mm256_add_pd(
+			_mm256_add_pd(_mm256_mul_pd(r10, x), _mm256_mul_pd(r11, y)),
+			_mm256_add_pd(_mm256_mul_pd(r12, z), ty));
+		const __m256d gz = _mm256_add_pd(
+			_mm256_add_pd(_mm256_mul_pd(r20, x), _mm256_mul_pd(r21, y)),
+			_mm256_add_pd(_mm256_mul_pd(r22, z), tz));
+		_mm_storeu_ps(ox + i, _mm256_cvtpd_ps(gx));
+		_mm_storeu_ps(oy + i, _mm256_cvtpd_ps(gy));
+		_mm_storeu_ps(oz + i, _mm256_cvtpd_ps(gz));
+	}
+#endif
+	for (; i < N; i++)
+	{
+		const double x = ix[i], y = iy[i], z = iz[i];
+		ox[i] = static_cast<float>(R[0] * x + R[1] * y + R[2] * z + t[0]);
+		oy[i] = static_cast<float>(R[3] * x + R[4] * y + R[5] * z + t[1]);
+		oz[i] = static_cast<float>(R[6] * x + R[7] * y + R[8] * z + t[2]);
+	}
+}
+}  // namespace
+
+void CPose3D::composePoints(
+	const float* lx, const float* ly, const float* lz, const std::size_t N,
+	float* gx, float* gy, float* gz) const
+{
+	const double R[9] = {m_ROT(0, 0), m_ROT(0, 1), m_ROT(0, 2),
+						 m_ROT(1, 0), m_ROT(1, 1), m_ROT(1, 2),
+						 m_ROT(2, 0), m_ROT(2, 1), m_ROT(2, 2)};
+	const double t[3] = {m_coords[0], m_coords[1], m_coords[2]};
+	transformPointsSoA(R, t, lx, ly, lz, N, gx, gy, gz);
+}
+
+void CPose3D::inverseComposePoints(
+	const float* gx, const float* gy, const float* gz, const std::size_t N,
+	float* lx, float* ly, float* lz) const
+{
+	CMatrixDouble33 R_inv(UNINITIALIZED_MATRIX);
+	CArrayDouble<3> t_inv;
+	mrpt::math::homogeneousMatrixInverse(m_ROT, m_coords, R_inv, t_inv);
+
+	const double R[9] = {R_inv(0, 0), R_inv(0, 1), R_inv(0, 2),
+						 R_inv(1, 0), R_inv(1, 1), R_inv(1, 2),
+						 R_inv(2, 0), R_inv(2, 1), R_inv(2, 2)};
+	const double t[3] = {t_inv[0], t_inv[1], t_inv[2]};
+	transformPointsSoA(R, t, gx, gy, gz, N, lx, ly, lz);
+}
+
+void CPose3D::composePoses(
+	const CPose3D* in, const std::size_t N, CPose3D* out) const
+{
+	for (std::size_t i = 0; i < N; i++) out[i].composeFrom(*this, in[i]);
+}
+
 CPose3D CPose3D::exp(
 	const mrpt::math::CArrayNumeric<double, 6>& mu, bool pseudo_exponential)
 {
@@ -993,3 +993,64 @@ TEST_F(Pose3DTests, Jacob_dAexpeD_de)
 				ptc[j][2], DEG2RAD(ptc[j][3]), DEG2RAD(ptc[j][4]),
 				DEG2RAD(ptc[j][5]));
 }
+
+TEST_F(Pose3DTests, ComposePointsBatch)
+{
+	// An odd number of points, to also exercise the non-SIMD tail:
+	const size_t N = 11;
+	std::vector<float> xs(N), ys(N), zs(N);
+	for (size_t k = 0; k < N; k++)
+	{
+		xs[k] = 0.5f * k - 2.0f;
+		ys[k] = 3.0f - 0.25f * k;
+		zs[k] = 0.1f * k * k;
+	}
+	for (size_t i = 0; i < num_ptc; i++)
+	{
+		const CPose3D p(
+			ptc[i][0], ptc[i][1], ptc[i][2], DEG2RAD(ptc[i][3]),
+			DEG2RAD(ptc[i][4]), DEG2RAD(ptc[i][5]));
+
+		std::vector<float> gx(N), gy(N), gz(N);
+		p.composePoints(
+			xs.data(), ys.data(), zs.data(), N, gx.data(), gy.data(),
+			gz.data());
+		for (size_t k = 0; k < N; k++)
+		{
+			double x, y, z;
+			p.composePoint(xs[k], ys[k], zs[k], x, y, z);
+			EXPECT_NEAR(gx[k], x, 1e-4);
+			EXPECT_NEAR(gy[k], y, 1e-4);
+			EXPECT_NEAR(gz[k], z, 1e-4);
+		}
+
+		// In-place inverse composition must give back the original points:
+		p.inverseComposePoints(
+			gx.data(), gy.data(), gz.data(), N, gx.data(), gy.data(),
+			gz.data());
+		for (size_t k = 0; k < N; k++)
+		{
+			EXPECT_NEAR(gx[k], xs[k], 1e-4);
+			EXPECT_NEAR(gy[k], ys[k], 1e-4);
+			EXPECT_NEAR(gz[k], zs[k], 1e-4);
+		}
+	}
+}
+
+TEST_F(Pose3DTests, ComposePosesBatch)
+{
+	std::vector<CPose3D> in, out(num_ptc);
+	for (size_t i = 0; i < num_ptc; i++)
+		in.emplace_back(
+			ptc[i][0], ptc[i][1], ptc[i][2], DEG2RAD(ptc[i][3]),
+			DEG2RAD(ptc[i][4]), DEG2RAD(ptc[i][5]));
+	const CPose3D base(1.0, 2.0, 3.0, DEG2RAD(30.0), DEG2RAD(-10), DEG2RAD(5));
+	base.composePoses(in.data(), in.size(), out.data());
+	for (size_t i = 0; i < num_ptc; i++)
+		EXPECT_NEAR(
+			0, (out[i].getAsVectorVal() - (base + in[i]).getAsVectorVal())
+				   .array()
+				   .abs()
+				   .sum(),
+			1e-8);
+}
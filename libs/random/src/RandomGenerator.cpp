@@ -23,6 +23,8 @@ CRandomGenerator& mrpt::random::getRandomGenerator() { return randomGenerator; }
 void CRandomGenerator::MT19937_initializeGenerator(const uint32_t& seed)
 {
 	m_MT19937.seed(seed);
+	// Drop any cached normal sample, so the sequence only depends on "seed":
+	m_normdistribution.reset();
 }
 
 uint64_t CRandomGenerator::drawUniform64bit() { return m_uint64(m_MT19937); }
@@ -26,3 +26,15 @@ TEST(Random, Randomize)
 	auto r1abis = rnd.drawUniform32bit();
 	EXPECT_EQ(r1a, r1abis);
 }
+
+TEST(Random, RandomizeGaussian)
+{
+	using namespace mrpt::random;
+
+	CRandomGenerator rnd;
+	rnd.randomize(1);
+	const auto g1 = rnd.drawGaussian1D_normalized();
+	// An odd number of draws leaves a cached sample in the distribution:
+	rnd.randomize(1);
+	EXPECT_EQ(g1, rnd.drawGaussian1D_normalized());
+}
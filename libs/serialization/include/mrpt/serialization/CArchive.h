@@ -8,6 +8,7 @@
    +------------------------------------------------------------------------+ */
 #pragma once
 
+#include <algorithm>  // min()
 #include <cstdint>
 #include <mrpt/config.h>  // MRPT_IS_BIG_ENDIAN
 #include <mrpt/core/is_shared_ptr.h>
@@ -86,10 +87,11 @@ class CArchive
 		// little endian: no conversion needed.
 		return ReadBuffer(ptr, ElementCount * sizeof(T));
 #else
-		// big endian: convert.
+		// big endian: read directly into the output buffer and convert in
+		// place.
 		const size_t nread = ReadBuffer(ptr, ElementCount * sizeof(T));
 		for (size_t i = 0; i < ElementCount; i++)
-			mrpt::utils::reverseBytesInPlace(ptr[i]);
+			mrpt::reverseBytesInPlace(ptr[i]);
 		return nread;
 #endif
 	}
@@ -125,8 +127,17 @@ class CArchive
 		// little endian: no conversion needed.
 		return WriteBuffer(ptr, ElementCount * sizeof(T));
 #else
-		// big endian: the individual "<<" functions already convert endiannes
-		for (size_t i = 0; i < ElementCount; i++) (*this) << ptr[i];
+		// big endian: convert blocks of elements in a local buffer, and write
+		// each block at once:
+		constexpr size_t BLOCK_LEN = sizeof(T) < 4096 ? 4096 / sizeof(T) : 1;
+		T block[BLOCK_LEN];
+		for (size_t i = 0; i < ElementCount; i += BLOCK_LEN)
+		{
+			const size_t n = std::min(BLOCK_LEN, ElementCount - i);
+			for (size_t j = 0; j < n; j++)
+				mrpt::reverseBytes(ptr[i + j], block[j]);
+			WriteBuffer(block, n * sizeof(T));
+		}
 #endif
 	}
 	/** Read a value from a stream stored in a type different of the target
@@ -61,8 +61,9 @@ Writes an elemental data type to stream.
 #define IMPLEMENT_CArchive_READ_WRITE_SIMPLE_TYPE(T)                    \
 	CArchive& mrpt::serialization::operator<<(CArchive& out, const T a) \
 	{                                                                   \
-		mrpt::reverseBytesInPlace(a);                                   \
-		out.WriteBuffer((void*)&a, sizeof(a));                          \
+		T b;                                                            \
+		mrpt::reverseBytes(a, b);                                       \
+		out.WriteBuffer((void*)&b, sizeof(b));                          \
 		return out;                                                     \
 	}                                                                   \
 	CArchive& mrpt::serialization::operator>>(CArchive& in, T& a)       \
@@ -12,6 +12,15 @@
 #include <mrpt/slam/CMetricMapsAlignmentAlgorithm.h>
 #include <mrpt/config/CLoadableOptions.h>
 #include <mrpt/typemeta/TEnumType.h>
+#include <memory>
+
+namespace mrpt
+{
+namespace system
+{
+class CWorkerThreadsPool;
+}
+}  // namespace mrpt
 
 namespace mrpt
 {
@@ -22,7 +31,12 @@ namespace slam
 enum TICPAlgorithm
 {
 	icpClassic = 0,
-	icpLevenbergMarquardt
+	icpLevenbergMarquardt,
+	/** Point-to-plane ICP, only for Align3DPDF(). Surface normals of the
+	 * reference map are estimated from its nearest neighbors. The covariance
+	 * of the result comes from the Gauss-Newton Hessian of the last
+	 * iteration, scaled by the residual variance. [New in MRPT 2.0.0] */
+	icpPointToPlane
 };
 
 /** ICP covariance estimation methods, used in mrpt::slam::CICP::options
@@ -176,6 +190,17 @@ class CICP : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 		 * queries,
 		 *  the most expensive step in ICP */
 		uint32_t corresponding_points_decimation{5};
+
+		/** Number of threads used to search for correspondences in point
+		 * maps (default=1: serial execution). Use 0 to use all hardware
+		 * threads. Results do not depend on this value.
+		 * \note [New in MRPT 2.0.0] */
+		unsigned int numThreads{1};
+
+		/** [icpPointToPlane only] Number of nearest neighbors used to
+		 * estimate the surface normal at each point of the reference map
+		 * (default=8) */
+		unsigned int pointToPlane_normalNeighbors{8};
 	};
 
 	/** The options employed by the ICP align. */
@@ -263,6 +288,18 @@ class CICP : public mrpt::slam::CMetricMapsAlignmentAlgorithm
 		const mrpt::maps::CMetricMap* m1, const mrpt::maps::CMetricMap* m2,
 		const mrpt::poses::CPose3DPDFGaussian& initialEstimationPDF,
 		TReturnInfo& outInfo);
+	mrpt::poses::CPose3DPDF::Ptr ICP3D_Method_PointToPlane(
+		const mrpt::maps::CMetricMap* m1, const mrpt::maps::CMetricMap* m2,
+		const mrpt::poses::CPose3DPDFGaussian& initialEstimationPDF,
+		TReturnInfo& outInfo);
+
+	/** Returns the pool of worker threads for options.numThreads, or nullptr
+	 * if it is 1. The pool is created on demand. */
+	mrpt::system::CWorkerThreadsPool* getThreadPool();
+
+   private:
+	/** Shared (not duplicated) among copies of this object */
+	std::shared_ptr<mrpt::system::CWorkerThreadsPool> m_threadPool;
 };
 }  // namespace slam
 }  // namespace mrpt
@@ -271,6 +308,7 @@ MRPT_ENUM_TYPE_BEGIN(mrpt::slam::TICPAlgorithm)
 using namespace mrpt::slam;
 MRPT_FILL_ENUM(icpClassic);
 MRPT_FILL_ENUM(icpLevenbergMarquardt);
+MRPT_FILL_ENUM(icpPointToPlane);
 MRPT_ENUM_TYPE_END()
 
 MRPT_ENUM_TYPE_BEGIN(mrpt::slam::TICPCovarianceMethod)
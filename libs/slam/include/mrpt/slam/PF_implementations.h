@@ -132,6 +132,58 @@ bool PF_implementation<PARTICLE_TYPE, MYSELF>::
 	return true;
 }  // end of PF_SLAM_implementation_gatherActionsCheckBothActObs
 
+/*---------------------------------------------------------------
+			PF_SLAM_parallel_for
+ ---------------------------------------------------------------*/
+template <class PARTICLE_TYPE, class MYSELF>
+void PF_implementation<PARTICLE_TYPE, MYSELF>::PF_SLAM_parallel_for(
+	const mrpt::bayes::CParticleFilter::TParticleFilterOptions& PF_options,
+	const size_t N,
+	const std::function<void(size_t, mrpt::random::CRandomGenerator&)>& body)
+{
+	MRPT_START
+	if (!N) return;
+	if (PF_options.numThreads == 1)
+	{
+		auto& rng = mrpt::random::getRandomGenerator();
+		for (size_t i = 0; i < N; i++) body(i, rng);
+		return;
+	}
+
+	using mrpt::system::CWorkerThreadsPool;
+	const size_t nThreads = PF_options.numThreads != 0
+								? PF_options.numThreads
+								: CWorkerThreadsPool::hardwareThreads();
+	if (!m_threadPool || m_threadPool->size() != nThreads - 1)
+		m_threadPool = std::make_shared<CWorkerThreadsPool>(nThreads - 1);
+
+	// One generator per block of particles, seeded from the global one:
+	const size_t blockLen = PARALLEL_RNG_BLOCK;
+	const size_t nBlocks = (N + blockLen - 1) / blockLen;
+	const uint32_t baseSeed =
+		mrpt::random::getRandomGenerator().drawUniform32bit();
+
+	// Run the first particle alone, to build any lazy, shared cache:
+	mrpt::random::CRandomGenerator rng0(baseSeed);
+	body(0, rng0);
+
+	m_threadPool->parallel_for(nBlocks, [&](size_t b0, size_t b1) {
+		for (size_t b = b0; b < b1; b++)
+		{
+			const size_t i0 = b * blockLen, i1 = std::min(N, i0 + blockLen);
+			if (b == 0)
+			{
+				for (size_t i = 1; i < i1; i++) body(i, rng0);
+				continue;
+			}
+			mrpt::random::CRandomGenerator rng(
+				static_cast<uint32_t>(baseSeed + b));
+			for (size_t i = i0; i < i1; i++) body(i, rng);
+		}
+	});
+	MRPT_END
+}
+
 /** A generic implementation of the PF method
  * "prediction_and_update_pfAuxiliaryPFOptimal" (optimal sampling with rejection
  * sampling approximation),
@@ -236,22 +288,23 @@ void PF_implementation<PARTICLE_TYPE, MYSELF>::
 			// -------------------------------------------------------------
 			// FIXED SAMPLE SIZE
 			// -------------------------------------------------------------
-			mrpt::poses::CPose3D incrPose;
-			for (size_t i = 0; i < M; i++)
-			{
-				// Generate gaussian-distributed 2D-pose increments according to
-				// mean-cov:
-				m_movementDrawer.drawSample(incrPose);
-				bool pose_is_valid;
-				const mrpt::poses::CPose3D finalPose =
-					mrpt::poses::CPose3D(getLastPose(i, pose_is_valid)) +
-					incrPose;
-
-				// Update the particle with the new pose: this part is
-				// caller-dependant and must be implemented there:
-				PF_SLAM_implementation_custom_update_particle_with_new_pose(
-					me->m_particles[i].d.get(), finalPose.asTPose());
-			}
+			PF_SLAM_parallel_for(
+				PF_options, M,
+				[&](size_t i, mrpt::random::CRandomGenerator& rng) {
+					// Generate gaussian-distributed 2D-pose increments
+					// according to mean-cov:
+					mrpt::poses::CPose3D incrPose;
+					m_movementDrawer.drawSample(incrPose, rng);
+					bool pose_is_valid;
+					const mrpt::poses::CPose3D finalPose =
+						mrpt::poses::CPose3D(getLastPose(i, pose_is_valid)) +
+						incrPose;
+
+					// Update the particle with the new pose: this part is
+					// caller-dependant and must be implemented there:
+					PF_SLAM_implementation_custom_update_particle_with_new_pose(
+						me->m_particles[i].d.get(), finalPose.asTPose());
+				});
 		}
 		else
 		{
@@ -345,18 +398,19 @@ void PF_implementation<PARTICLE_TYPE, MYSELF>::
 		//	UPDATE STAGE
 		// ----------------------------------------------------------------------
 		// Compute all the likelihood values & update particles weight:
-		for (size_t i = 0; i < M; i++)
-		{
-			bool pose_is_valid;
-			const mrpt::math::TPose3D partPose =
-				getLastPose(i, pose_is_valid);  // Take the particle data:
-			mrpt::poses::CPose3D partPose2 = mrpt::poses::CPose3D(partPose);
-			const double obs_log_likelihood =
-				PF_SLAM_computeObservationLikelihoodForParticle(
-					PF_options, i, *sf, partPose2);
-			me->m_particles[i].log_w +=
-				obs_log_likelihood * PF_options.powFactor;
-		}  // for each particle "i"
+		PF_SLAM_parallel_for(
+			PF_options, M, [&](size_t i, mrpt::random::CRandomGenerator&) {
+				bool pose_is_valid;
+				const mrpt::math::TPose3D partPose =
+					getLastPose(i, pose_is_valid);  // Take the particle data:
+				mrpt::poses::CPose3D partPose2 =
+					mrpt::poses::CPose3D(partPose);
+				const double obs_log_likelihood =
+					PF_SLAM_computeObservationLikelihoodForParticle(
+						PF_options, i, *sf, partPose2);
+				me->m_particles[i].log_w +=
+					obs_log_likelihood * PF_options.powFactor;
+			});  // for each particle "i"
 
 		// Normalization of weights is done outside of this method
 		// automatically.
@@ -405,6 +459,20 @@ double PF_implementation<PARTICLE_TYPE, MYSELF>::
 		const mrpt::bayes::CParticleFilter::TParticleFilterOptions& PF_options,
 		const mrpt::bayes::CParticleFilterCapable* obj, size_t index,
 		const void* action, const void* observation)
+{
+	return PF_SLAM_particlesEvaluator_AuxPFOptimal<BINTYPE>(
+		PF_options, obj, index, action, observation,
+		mrpt::random::getRandomGenerator());
+}
+
+template <class PARTICLE_TYPE, class MYSELF>
+template <class BINTYPE>
+double PF_implementation<PARTICLE_TYPE, MYSELF>::
+	PF_SLAM_particlesEvaluator_AuxPFOptimal(
+		const mrpt::bayes::CParticleFilter::TParticleFilterOptions& PF_options,
+		const mrpt::bayes::CParticleFilterCapable* obj, size_t index,
+		const void* action, const void* observation,
+		mrpt::random::CRandomGenerator& rng)
 {
 	MRPT_UNUSED_PARAM(action);
 	MRPT_START
@@ -430,7 +498,7 @@ double PF_implementation<PARTICLE_TYPE, MYSELF>::
 	mrpt::poses::CPose3D drawnSample;
 	for (size_t q = 0; q < N; q++)
 	{
-		me->m_movementDrawer.drawSample(drawnSample);
+		me->m_movementDrawer.drawSample(drawnSample, rng);
 		mrpt::poses::CPose3D x_predict = oldPose + drawnSample;
 
 		// Estimate the mean...
@@ -483,6 +551,20 @@ double PF_implementation<PARTICLE_TYPE, MYSELF>::
 		const mrpt::bayes::CParticleFilter::TParticleFilterOptions& PF_options,
 		const mrpt::bayes::CParticleFilterCapable* obj, size_t index,
 		const void* action, const void* observation)
+{
+	return PF_SLAM_particlesEvaluator_AuxPFStandard<BINTYPE>(
+		PF_options, obj, index, action, observation,
+		mrpt::random::getRandomGenerator());
+}
+
+template <class PARTICLE_TYPE, class MYSELF>
+template <class BINTYPE>
+double PF_implementation<PARTICLE_TYPE, MYSELF>::
+	PF_SLAM_particlesEvaluator_AuxPFStandard(
+		const mrpt::bayes::CParticleFilter::TParticleFilterOptions& PF_options,
+		const mrpt::bayes::CParticleFilterCapable* obj, size_t index,
+		const void* action, const void* observation,
+		mrpt::random::CRandomGenerator& rng)
 {
 	MRPT_START
 
@@ -534,7 +616,7 @@ double PF_implementation<PARTICLE_TYPE, MYSELF>::
 		mrpt::poses::CPose3D drawnSample;
 		for (size_t q = 0; q < N; q++)
 		{
-			myObj->m_movementDrawer.drawSample(drawnSample);
+			myObj->m_movementDrawer.drawSample(drawnSample, rng);
 			mrpt::poses::CPose3D x_predict = oldPose + drawnSample;
 
 			// Estimate the mean...
@@ -624,14 +706,38 @@ void PF_implementation<PARTICLE_TYPE, MYSELF>::
 
 	// Prepare data for executing "fastDrawSample"
 	using TMyClass = PF_implementation<PARTICLE_TYPE, MYSELF>;
-	auto funcOpt =
+	using TEvaluator =
+		mrpt::bayes::CParticleFilterCapable::TParticleProbabilityEvaluator;
+	const TEvaluator funcOpt =
 		&TMyClass::template PF_SLAM_particlesEvaluator_AuxPFOptimal<BINTYPE>;
-	auto funcStd =
+	const TEvaluator funcStd =
 		&TMyClass::template PF_SLAM_particlesEvaluator_AuxPFStandard<BINTYPE>;
 
-	me->prepareFastDrawSample(
-		PF_options, USE_OPTIMAL_SAMPLING ? funcOpt : funcStd,
-		&meanRobotMovement, sf);
+	if (PF_options.numThreads == 1)
+	{
+		me->prepareFastDrawSample(
+			PF_options, USE_OPTIMAL_SAMPLING ? funcOpt : funcStd,
+			&meanRobotMovement, sf);
+	}
+	else
+	{
+		// Evaluate all particles in parallel first, then just feed the
+		// results to prepareFastDrawSample():
+		std::vector<double> partEvals(M);
+		PF_SLAM_parallel_for(
+			PF_options, M,
+			[&](size_t i, mrpt::random::CRandomGenerator& rng) {
+				partEvals[i] =
+					USE_OPTIMAL_SAMPLING
+						? PF_SLAM_particlesEvaluator_AuxPFOptimal<BINTYPE>(
+							  PF_options, me, i, &meanRobotMovement, sf, rng)
+						: PF_SLAM_particlesEvaluator_AuxPFStandard<BINTYPE>(
+							  PF_options, me, i, &meanRobotMovement, sf, rng);
+			});
+		me->prepareFastDrawSample(
+			PF_options, &TMyClass::PF_SLAM_particlesEvaluator_Precomputed,
+			&partEvals, sf);
+	}
 
 	// For USE_OPTIMAL_SAMPLING=1,  m_pfAuxiliaryPFOptimal_maxLikelihood is now
 	// computed.
@@ -16,8 +16,12 @@
 #include <mrpt/poses/CPose3D.h>
 #include <mrpt/poses/CPose3DPDFGaussian.h>
 #include <mrpt/poses/CPoseRandomSampler.h>
+#include <mrpt/random/RandomGenerators.h>
 #include <mrpt/slam/TKLDParams.h>
 #include <mrpt/system/COutputLogger.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <functional>
+#include <memory>
 
 namespace mrpt
 {
@@ -67,6 +71,66 @@ class PF_implementation : public mrpt::system::COutputLogger
 	mutable std::vector<mrpt::math::TPose3D>
 		m_pfAuxiliaryPFOptimal_maxLikDrawnMovement;
 	std::vector<bool> m_pfAuxiliaryPFOptimal_maxLikMovementDrawHasBeenUsed;
+	/** Worker threads used when TParticleFilterOptions::numThreads!=1.
+	 * Created on demand; shared (not duplicated) among copies of this
+	 * object. */
+	std::shared_ptr<mrpt::system::CWorkerThreadsPool> m_threadPool;
+
+	/** Number of consecutive particles which share one random generator in
+	 * PF_SLAM_parallel_for(). */
+	static constexpr size_t PARALLEL_RNG_BLOCK = 64;
+
+	/** Runs `body(i,rng)` for each particle index `i` in `[0,N)`, in
+	 * parallel if `PF_options.numThreads!=1`.
+	 *
+	 * In serial mode, `rng` is always mrpt::random::getRandomGenerator(), so
+	 * results are identical to those of a plain `for` loop. Otherwise,
+	 * particles are split into blocks of PARALLEL_RNG_BLOCK indices, each one
+	 * processed sequentially with its own generator seeded from the global
+	 * one, so results only depend on the global seed, not on the number of
+	 * threads or the scheduling. Index 0 is always run first on its own,
+	 * which warms up any lazily-built data in the observations or maps
+	 * (e.g. CSensoryFrame auxiliary point maps) before going parallel.
+	 *
+	 * `body` must only write to data associated to particle `i`.
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void PF_SLAM_parallel_for(
+		const mrpt::bayes::CParticleFilter::TParticleFilterOptions& PF_options,
+		const size_t N,
+		const std::function<void(size_t, mrpt::random::CRandomGenerator&)>&
+			body);
+
+	/** Evaluates one particle for PF_SLAM_particlesEvaluator_AuxPFOptimal(),
+	 * drawing samples from the given generator. */
+	template <class BINTYPE>
+	static double PF_SLAM_particlesEvaluator_AuxPFOptimal(
+		const mrpt::bayes::CParticleFilter::TParticleFilterOptions& PF_options,
+		const mrpt::bayes::CParticleFilterCapable* obj, size_t index,
+		const void* action, const void* observation,
+		mrpt::random::CRandomGenerator& rng);
+
+	/** Evaluates one particle for PF_SLAM_particlesEvaluator_AuxPFStandard(),
+	 * drawing samples from the given generator. */
+	template <class BINTYPE>
+	static double PF_SLAM_particlesEvaluator_AuxPFStandard(
+		const mrpt::bayes::CParticleFilter::TParticleFilterOptions& PF_options,
+		const mrpt::bayes::CParticleFilterCapable* obj, size_t index,
+		const void* action, const void* observation,
+		mrpt::random::CRandomGenerator& rng);
+
+	/** A particle evaluator which returns precomputed values: `action` must
+	 * be a `const std::vector<double>*` with one entry per particle. */
+	static double PF_SLAM_particlesEvaluator_Precomputed(
+		const mrpt::bayes::CParticleFilter::TParticleFilterOptions& PF_options,
+		const mrpt::bayes::CParticleFilterCapable* obj, size_t index,
+		const void* action, const void* observation)
+	{
+		MRPT_UNUSED_PARAM(PF_options);
+		MRPT_UNUSED_PARAM(obj);
+		MRPT_UNUSED_PARAM(observation);
+		return (*static_cast<const std::vector<double>*>(action))[index];
+	}
 
 	/**  Compute w[i]*p(z_t | mu_t^i), with mu_t^i being
 	  *    the mean of the new robot pose
@@ -22,6 +22,8 @@
 #include <mrpt/poses/CPose3DPDF.h>
 #include <mrpt/poses/CPosePDFGaussian.h>
 #include <mrpt/poses/CPose3DPDFGaussian.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <Eigen/Dense>
 
 using namespace mrpt::slam;
 using namespace mrpt::maps;
@@ -53,6 +55,9 @@ CPosePDF::Ptr CICP::AlignPDF(
 		case icpLevenbergMarquardt:
 			resultPDF = ICP_Method_LM(m1, mm2, initialEstimationPDF, outInfo);
 			break;
+		case icpPointToPlane:
+			THROW_EXCEPTION("icpPointToPlane is only implemented for ICP-3D");
+			break;
 		default:
 			THROW_EXCEPTION_FMT(
 				"Invalid value for ICP_algorithm: %i",
@@ -118,6 +123,8 @@ void CICP::TConfigParams::loadFromConfigFile(
 
 	MRPT_LOAD_CONFIG_VAR(
 		corresponding_points_decimation, int, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR(numThreads, int, iniFile, section);
+	MRPT_LOAD_CONFIG_VAR(pointToPlane_normalNeighbors, int, iniFile, section);
 }
 
 void CICP::TConfigParams::saveToConfigFile(
@@ -166,6 +173,23 @@ void CICP::TConfigParams::saveToConfigFile(
 	MRPT_SAVE_CONFIG_VAR_COMMENT(skip_cov_calculation, "");
 	MRPT_SAVE_CONFIG_VAR_COMMENT(skip_quality_calculation, "");
 	MRPT_SAVE_CONFIG_VAR_COMMENT(corresponding_points_decimation, "");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		numThreads,
+		"Threads for correspondence search (0: all cores, 1: serial)");
+	MRPT_SAVE_CONFIG_VAR_COMMENT(
+		pointToPlane_normalNeighbors,
+		"[icpPointToPlane] Neighbors used to estimate surface normals");
+}
+
+mrpt::system::CWorkerThreadsPool* CICP::getThreadPool()
+{
+	if (options.numThreads == 1) return nullptr;
+	const size_t nThreads = options.numThreads != 0
+								? options.numThreads
+								: CWorkerThreadsPool::hardwareThreads();
+	if (!m_threadPool || m_threadPool->size() != nThreads - 1)
+		m_threadPool = std::make_shared<CWorkerThreadsPool>(nThreads - 1);
+	return m_threadPool.get();
 }
 
 float CICP::kernel(const float& x2, const float& rho2)
@@ -228,6 +252,7 @@ CPosePDF::Ptr CICP::ICP_Method_Classic(
 	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
 	matchParams.decimation_other_map_points =
 		options.corresponding_points_decimation;
+	matchParams.threadPool = getThreadPool();
 
 	// Asure maps are not empty!
 	// ------------------------------------------------------
@@ -598,6 +623,7 @@ CPosePDF::Ptr CICP::ICP_Method_LM(
 	matchParams.onlyUniqueRobust = onlyUniqueRobust;
 	matchParams.decimation_other_map_points =
 		options.corresponding_points_decimation;
+	matchParams.threadPool = getThreadPool();
 
 	// The gaussian PDF to estimate:
 	// ------------------------------------------------------
@@ -934,7 +960,13 @@ CPose3DPDF::Ptr CICP::Align3DPDF(
 				ICP3D_Method_Classic(m1, mm2, initialEstimationPDF, outInfo);
 			break;
 		case icpLevenbergMarquardt:
-			THROW_EXCEPTION("Only icpClassic is implemented for ICP-3D");
+			THROW_EXCEPTION(
+				"Only icpClassic and icpPointToPlane are implemented for "
+				"ICP-3D");
+			break;
+		case icpPointToPlane:
+			resultPDF = ICP3D_Method_PointToPlane(
+				m1, mm2, initialEstimationPDF, outInfo);
 			break;
 		default:
 			THROW_EXCEPTION_FMT(
@@ -1007,6 +1039,7 @@ CPose3DPDF::Ptr CICP::ICP3D_Method_Classic(
 	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
 	matchParams.decimation_other_map_points =
 		options.corresponding_points_decimation;
+	matchParams.threadPool = getThreadPool();
 
 	// Asure maps are not empty!
 	// ------------------------------------------------------
@@ -1121,3 +1154,222 @@ CPose3DPDF::Ptr CICP::ICP3D_Method_Classic(
 
 	MRPT_END
 }
+
+CPose3DPDF::Ptr CICP::ICP3D_Method_PointToPlane(
+	const mrpt::maps::CMetricMap* mm1, const mrpt::maps::CMetricMap* mm2,
+	const CPose3DPDFGaussian& initialEstimationPDF, TReturnInfo& outInfo)
+{
+	MRPT_START
+
+	// Assure the class of the maps:
+	ASSERT_(mm1->GetRuntimeClass()->derivedFrom(CLASS_ID(CPointsMap)));
+	ASSERT_(mm2->GetRuntimeClass()->derivedFrom(CLASS_ID(CPointsMap)));
+	const CPointsMap* m1 = static_cast<const CPointsMap*>(mm1);
+	const CPointsMap* m2 = static_cast<const CPointsMap*>(mm2);
+
+	// Asserts:
+	// -----------------
+	ASSERT_(options.ALFA > 0 && options.ALFA < 1);
+	ASSERT_ABOVEEQ_(options.pointToPlane_normalNeighbors, 3u);
+
+	outInfo.nIterations = 0;
+	outInfo.goodness = 1;
+	outInfo.quality = 0;
+
+	auto gaussPdf = mrpt::make_aligned_shared<CPose3DPDFGaussian>();
+	gaussPdf->mean = initialEstimationPDF.mean;
+
+	mrpt::system::CWorkerThreadsPool* pool = getThreadPool();
+
+	TMatchingParams matchParams;
+	TMatchingExtraResults matchExtraResults;
+	matchParams.maxDistForCorrespondence = options.thresholdDist;
+	matchParams.maxAngularDistForCorrespondence = options.thresholdAng;
+	matchParams.onlyKeepTheClosest = true;
+	matchParams.onlyUniqueRobust = options.onlyUniqueRobust;
+	matchParams.decimation_other_map_points =
+		options.corresponding_points_decimation;
+	matchParams.threadPool = pool;
+
+	if (m2->isEmpty() || m1->size() < options.pointToPlane_normalNeighbors)
+		return gaussPdf;
+
+	// Surface normals of the reference map, only estimated (once) for those
+	// points which are paired at some iteration. normalState: 0=unknown,
+	// 1=valid, 2=ill-defined (e.g. isolated or collinear points).
+	const size_t nRef = m1->size();
+	std::vector<mrpt::math::TPoint3Df> normals(nRef);
+	std::vector<uint8_t> normalState(nRef, 0);
+	std::vector<size_t> pendingNormals;
+	m1->kdTreeEnsureIndexBuilt3D();
+
+	auto estimateNormals = [&](size_t i0, size_t i1) {
+		std::vector<size_t> idxs;
+		std::vector<float> dists;
+		for (size_t i = i0; i < i1; i++)
+		{
+			const size_t pt = pendingNormals[i];
+			m1->kdTreeNClosestPoint3DIdx(
+				m1->getPointsBufferRef_x()[pt], m1->getPointsBufferRef_y()[pt],
+				m1->getPointsBufferRef_z()[pt],
+				options.pointToPlane_normalNeighbors, idxs, dists);
+			// The normal is the eigenvector of the smallest eigenvalue of the
+			// covariance of the neighborhood:
+			Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+			for (size_t k : idxs)
+				mean += Eigen::Vector3d(
+					m1->getPointsBufferRef_x()[k],
+					m1->getPointsBufferRef_y()[k],
+					m1->getPointsBufferRef_z()[k]);
+			mean /= idxs.size();
+			Eigen::Matrix3d cov = Eigen::Matrix3d::Zero();
+			for (size_t k : idxs)
+			{
+				const Eigen::Vector3d d =
+					Eigen::Vector3d(
+						m1->getPointsBufferRef_x()[k],
+						m1->getPointsBufferRef_y()[k],
+						m1->getPointsBufferRef_z()[k]) -
+					mean;
+				cov += d * d.transpose();
+			}
+			Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> es(cov);
+			const Eigen::Vector3d& ev = es.eigenvalues();
+			// A plane: two large eigenvalues, and a small one:
+			if (idxs.size() < 3 || ev[1] <= 0 || ev[0] > 0.1 * ev[1])
+			{
+				normalState[pt] = 2;
+				continue;
+			}
+			const Eigen::Vector3d n = es.eigenvectors().col(0);
+			normals[pt] = mrpt::math::TPoint3Df(n[0], n[1], n[2]);
+			normalState[pt] = 1;
+		}
+	};
+
+	TMatchingPairList correspondences;
+	bool keepApproaching;
+	// Gauss-Newton system of the last iteration:
+	Eigen::Matrix<double, 6, 6> H;
+	double sumWeightedSqErr = 0;
+	size_t nPlanePairs = 0;
+	do
+	{
+		CPose3D& P = gaussPdf->mean;
+		matchParams.angularDistPivotPoint = TPoint3D(P.x(), P.y(), P.z());
+
+		// Find the matching:
+		m1->determineMatching3D(
+			m2, P, correspondences, matchParams, matchExtraResults);
+
+		// Estimate the normals of newly-paired reference points:
+		pendingNormals.clear();
+		for (const auto& c : correspondences)
+			if (normalState[c.this_idx] == 0)
+			{
+				normalState[c.this_idx] = 2;  // (Mark as "pending")
+				pendingNormals.push_back(c.this_idx);
+			}
+		if (pool)
+			pool->parallel_for(pendingNormals.size(), estimateNormals, 64);
+		else
+			estimateNormals(0, pendingNormals.size());
+
+		// One Gauss-Newton step, for the increment d=[t w] such that
+		// P <- exp(d) (+) P, minimizing sum_i (n_i * (P (+) p_i - q_i))^2:
+		H.setZero();
+		Eigen::Matrix<double, 6, 1> g = Eigen::Matrix<double, 6, 1>::Zero();
+		sumWeightedSqErr = 0;
+		nPlanePairs = 0;
+		const double rho2 = mrpt::square(options.kernel_rho);
+		for (const auto& c : correspondences)
+		{
+			if (normalState[c.this_idx] != 1) continue;
+			const auto& nf = normals[c.this_idx];
+			const Eigen::Vector3d n(nf.x, nf.y, nf.z);
+			double gx, gy, gz;
+			P.composePoint(c.other_x, c.other_y, c.other_z, gx, gy, gz);
+			const Eigen::Vector3d p(gx, gy, gz);
+			const double r =
+				n.dot(p - Eigen::Vector3d(c.this_x, c.this_y, c.this_z));
+			Eigen::Matrix<double, 6, 1> J;
+			J.head<3>() = n;
+			J.tail<3>() = p.cross(n);
+			// Cauchy robust kernel, as IRLS weights:
+			const double w =
+				options.use_kernel ? rho2 / (rho2 + r * r) : 1.0;
+			H.noalias() += w * J * J.transpose();
+			g.noalias() += w * r * J;
+			sumWeightedSqErr += w * r * r;
+			nPlanePairs++;
+		}
+
+		keepApproaching = nPlanePairs >= 6;
+		if (keepApproaching)
+		{
+			const Eigen::Matrix<double, 6, 1> d = -H.ldlt().solve(g);
+			CArrayDouble<6> incr;
+			for (int i = 0; i < 6; i++) incr[i] = d[i];
+			P = CPose3D::exp(incr, true /*pseudo-exponential*/) + P;
+
+			// If matching has not changed, decrease the thresholds:
+			if (std::abs(d[0]) < options.minAbsStep_trans &&
+				std::abs(d[1]) < options.minAbsStep_trans &&
+				std::abs(d[2]) < options.minAbsStep_trans &&
+				std::abs(d[3]) < options.minAbsStep_rot &&
+				std::abs(d[4]) < options.minAbsStep_rot &&
+				std::abs(d[5]) < options.minAbsStep_rot)
+			{
+				matchParams.maxDistForCorrespondence *= options.ALFA;
+				matchParams.maxAngularDistForCorrespondence *= options.ALFA;
+				if (matchParams.maxDistForCorrespondence <
+					options.smallestThresholdDist)
+					keepApproaching = false;
+
+				if (++matchParams.offset_other_map_points >=
+					options.corresponding_points_decimation)
+					matchParams.offset_other_map_points = 0;
+			}
+		}
+
+		// Next iteration:
+		outInfo.nIterations++;
+	} while (keepApproaching && outInfo.nIterations < options.maxIterations);
+
+	// Covariance of the increment d, from the last Gauss-Newton step:
+	// s^2 H^-1, with s^2 the residual variance. Then, mapped to the
+	// [x y z yaw pitch roll] of the pose with the Jacobian of exp(d) (+) P
+	// at d=0, estimated numerically:
+	if (!options.skip_cov_calculation && nPlanePairs > 6)
+	{
+		const double s2 = sumWeightedSqErr / (nPlanePairs - 6);
+		const Eigen::Matrix<double, 6, 6> cov_d = s2 * H.inverse();
+
+		const CPose3D P0 = gaussPdf->mean;
+		const double eps = 1e-7;
+		Eigen::Matrix<double, 6, 6> Jd;
+		for (int k = 0; k < 6; k++)
+		{
+			CArrayDouble<6> incr;
+			for (int i = 0; i < 6; i++) incr[i] = 0;
+			incr[k] = eps;
+			const CPose3D Pp = CPose3D::exp(incr, true) + P0;
+			incr[k] = -eps;
+			const CPose3D Pm = CPose3D::exp(incr, true) + P0;
+			Jd(0, k) = Pp.x() - Pm.x();
+			Jd(1, k) = Pp.y() - Pm.y();
+			Jd(2, k) = Pp.z() - Pm.z();
+			Jd(3, k) = mrpt::math::wrapToPi(Pp.yaw() - Pm.yaw());
+			Jd(4, k) = mrpt::math::wrapToPi(Pp.pitch() - Pm.pitch());
+			Jd(5, k) = mrpt::math::wrapToPi(Pp.roll() - Pm.roll());
+		}
+		Jd /= 2 * eps;
+		gaussPdf->cov = Jd * cov_d * Jd.transpose();
+	}
+
+	outInfo.goodness = matchExtraResults.correspondencesRatio;
+
+	return gaussPdf;
+
+	MRPT_END
+}
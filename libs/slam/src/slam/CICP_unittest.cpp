@@ -12,6 +12,7 @@
 #include <mrpt/opengl/CAngularObservationMesh.h>
 #include <mrpt/poses/CPosePDF.h>
 #include <mrpt/poses/CPose3DPDF.h>
+#include <mrpt/poses/CPose3DPDFGaussian.h>
 
 #include <mrpt/opengl/COpenGLScene.h>
 #include <mrpt/opengl/CGridPlaneXY.h>
@@ -19,6 +20,8 @@
 #include <mrpt/opengl/CSphere.h>
 #include <mrpt/opengl/CDisk.h>
 #include <mrpt/opengl/stock_objects.h>
+#include <mrpt/random.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <gtest/gtest.h>
 
 using namespace mrpt;
@@ -35,7 +38,8 @@ class ICPTests : public ::testing::Test
    protected:
 	virtual void SetUp() {}
 	virtual void TearDown() {}
-	void align2scans(const TICPAlgorithm icp_method)
+	void align2scans(
+		const TICPAlgorithm icp_method, const unsigned int numThreads = 1)
 	{
 		float SCAN_RANGES_1[] = {
 			0.910f,  0.900f,  0.910f,  0.900f,  0.900f,  0.890f,  0.890f,
@@ -203,6 +207,7 @@ class ICPTests : public ::testing::Test
 
 		// -----------------------------------------------------
 		ICP.options.ICP_algorithm = icp_method;
+		ICP.options.numThreads = numThreads;
 
 		ICP.options.maxIterations = 100;
 		ICP.options.thresholdAng = DEG2RAD(10.0f);
@@ -263,6 +268,98 @@ TEST_F(ICPTests, AlignScans_icpLevenbergMarquardt)
 {
 	align2scans(icpLevenbergMarquardt);
 }
+TEST_F(ICPTests, AlignScans_icpClassic_MT) { align2scans(icpClassic, 4); }
+
+TEST_F(ICPTests, ICP3D_threadedSearchAndPointToPlane)
+{
+	// A room corner: three orthogonal planes constrain all 6 DOFs. Large
+	// enough for the correspondence search to be split among threads.
+	CSimplePointsMap M1, M2;
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+	for (int i = 0; i < 1500; i++)
+	{
+		M1.insertPoint(rng.drawUniform(0, 2), rng.drawUniform(0, 2), 0);
+		M1.insertPoint(rng.drawUniform(0, 2), 0, rng.drawUniform(0, 2));
+		M1.insertPoint(0, rng.drawUniform(0, 2), rng.drawUniform(0, 2));
+	}
+	const CPose3D displacement(
+		0.05, -0.03, 0.02, DEG2RAD(2.0), DEG2RAD(-1.0), DEG2RAD(1.5));
+	M2.changeCoordinatesReference(M1, displacement);
+
+	// The threaded search must give exactly the same correspondences:
+	mrpt::system::CWorkerThreadsPool pool(3);
+	for (const auto& pose :
+		 {CPose3D(), displacement, CPose3D(0.1, 0.1, 0, 0.05, 0, 0)})
+	{
+		TMatchingParams params;
+		params.maxDistForCorrespondence = 0.2f;
+		params.decimation_other_map_points = 2;
+		TMatchingExtraResults extra_st, extra_mt;
+		mrpt::tfest::TMatchingPairList corrs_st, corrs_mt;
+		M1.determineMatching3D(&M2, pose, corrs_st, params, extra_st);
+		// Enough (decimated) points to be split among the threads:
+		ASSERT_GT(corrs_st.size(), 1000u);
+		params.threadPool = &pool;
+		M1.determineMatching3D(&M2, pose, corrs_mt, params, extra_mt);
+		ASSERT_EQ(corrs_st.size(), corrs_mt.size());
+		for (size_t i = 0; i < corrs_st.size(); i++)
+		{
+			const auto &a = corrs_st[i], &b = corrs_mt[i];
+			EXPECT_EQ(a.this_idx, b.this_idx);
+			EXPECT_EQ(a.other_idx, b.other_idx);
+			EXPECT_EQ(
+				a.errorSquareAfterTransformation,
+				b.errorSquareAfterTransformation);
+		}
+		EXPECT_EQ(extra_st.correspondencesRatio, extra_mt.correspondencesRatio);
+		EXPECT_EQ(extra_st.sumSqrDist, extra_mt.sumSqrDist);
+	}
+
+	CPose3D mean_st;
+	for (const auto& variant :
+		 {std::make_pair(icpClassic, 1u), std::make_pair(icpClassic, 4u),
+		  std::make_pair(icpPointToPlane, 4u)})
+	{
+		CICP icp;
+		icp.options.thresholdDist = 0.2f;
+		icp.options.thresholdAng = 0;
+		icp.options.corresponding_points_decimation = 2;
+		icp.options.ICP_algorithm = variant.first;
+		icp.options.numThreads = variant.second;
+		icp.options.maxIterations = 200;
+		CICP::TReturnInfo info;
+		const CPose3DPDF::Ptr pdf =
+			icp.Align3D(&M2, &M1, CPose3D(), nullptr, &info);
+		const CPose3D mean = pdf->getMeanVal();
+		EXPECT_NEAR(
+			0,
+			(mean.getAsVectorVal() - displacement.getAsVectorVal())
+				.array()
+				.abs()
+				.maxCoeff(),
+			1e-3)
+			<< "ICP method: " << int(variant.first)
+			<< " threads: " << variant.second << endl
+			<< "ICP output: mean= " << mean << endl;
+
+		if (variant.first == icpClassic && variant.second == 1)
+			mean_st = mean;
+		else if (variant.first == icpClassic)
+			EXPECT_EQ(mean_st.getAsVectorVal(), mean.getAsVectorVal());
+		else
+		{
+			// A valid, small covariance:
+			CPose3DPDFGaussian gauss;
+			gauss.copyFrom(*pdf);
+			for (int i = 0; i < 6; i++)
+			{
+				EXPECT_GT(gauss.cov(i, i), 0);
+				EXPECT_LT(gauss.cov(i, i), 1e-3);
+			}
+		}
+	}
+}
 
 TEST_F(ICPTests, RayTracingICP3D)
 {
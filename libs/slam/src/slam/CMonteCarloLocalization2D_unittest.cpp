@@ -11,6 +11,11 @@
 #include <mrpt/config/CConfigFile.h>
 #include <mrpt/slam/CMonteCarloLocalization2D.h>
 #include <mrpt/maps/CMultiMetricMap.h>
+#include <mrpt/maps/COccupancyGridMap2D.h>
+#include <mrpt/obs/CActionCollection.h>
+#include <mrpt/obs/CActionRobotMovement2D.h>
+#include <mrpt/obs/CObservation2DRangeScan.h>
+#include <mrpt/obs/CSensoryFrame.h>
 #include <mrpt/maps/CSimpleMap.h>
 #include <mrpt/obs/CRawlog.h>
 #include <mrpt/system/filesystem.h>
@@ -313,3 +318,89 @@ TEST(MonteCarlo2D, RunSampleDataset)
 
 	FAIL() << "Failed to converge after 3 opportunities!!" << endl;
 }
+
+// Runs a few PF steps in a synthetic map, returning all particle states:
+static std::vector<double> run_pf_synthetic(
+	CParticleFilter::TParticleFilterAlgorithm algorithm,
+	unsigned int numThreads, bool useLikelihoodCache)
+{
+	COccupancyGridMap2D grid(-5.0f, 5.0f, -5.0f, 5.0f, 0.1f);
+	for (unsigned int i = 0; i < grid.getSizeX(); i++)
+	{
+		grid.setCell(i, 0, 0.0f);
+		grid.setCell(i, grid.getSizeY() - 1, 0.0f);
+		grid.setCell(i, 30, 0.0f);
+	}
+	for (unsigned int j = 0; j < grid.getSizeY(); j++)
+	{
+		grid.setCell(0, j, 0.0f);
+		grid.setCell(grid.getSizeX() - 1, j, 0.0f);
+	}
+	// Either the on-demand per-cell cache (filled concurrently by all
+	// threads) or the distance transform table:
+	grid.likelihoodOptions.likelihoodMethod =
+		COccupancyGridMap2D::lmLikelihoodField_Thrun;
+	grid.likelihoodOptions.LF_useDistanceTransform = !useLikelihoodCache;
+	grid.likelihoodOptions.enableLikelihoodCache = useLikelihoodCache;
+
+	getRandomGenerator().randomize(1234);
+
+	CMonteCarloLocalization2D pdf;
+	pdf.options.metricMap = &grid;
+	pdf.resetUniform(-1.0, 1.0, -1.0, 1.0, -0.5, 0.5, 300);
+
+	CParticleFilter PF;
+	PF.m_options.PF_algorithm = algorithm;
+	PF.m_options.pfAuxFilterOptimal_MaximumSearchSamples = 10;
+	PF.m_options.numThreads = numThreads;
+
+	CPose2D robotPose(0.5, 0.2, 0.1);
+	const CPose2D odoIncr(0.1, 0, 0.02);
+	for (int step = 0; step < 3; step++)
+	{
+		robotPose = robotPose + odoIncr;
+
+		CActionRobotMovement2D act;
+		CActionRobotMovement2D::TMotionModelOptions opts;
+		opts.modelSelection = CActionRobotMovement2D::mmGaussian;
+		act.computeFromOdometry(odoIncr, opts);
+		CActionCollection acts;
+		acts.insert(act);
+
+		auto scan = mrpt::make_aligned_shared<CObservation2DRangeScan>();
+		scan->aperture = 2 * M_PIf;
+		scan->maxRange = 10.0f;
+		grid.laserScanSimulator(*scan, robotPose, 0.5f, 181);
+		CSensoryFrame sf;
+		sf.insert(scan);
+
+		PF.executeOn(pdf, &acts, &sf);
+	}
+
+	std::vector<double> ret;
+	for (const auto& p : pdf.m_particles)
+	{
+		ret.push_back(p.d->x());
+		ret.push_back(p.d->y());
+		ret.push_back(p.d->phi());
+		ret.push_back(p.log_w);
+	}
+	return ret;
+}
+
+TEST(MonteCarlo2D, ParallelIsDeterministic)
+{
+	for (bool useCache : {false, true})
+		for (auto algorithm : {CParticleFilter::pfStandardProposal,
+							   CParticleFilter::pfAuxiliaryPFStandard,
+							   CParticleFilter::pfAuxiliaryPFOptimal})
+		{
+			const auto serial = run_pf_synthetic(algorithm, 1, useCache);
+			const auto par2 = run_pf_synthetic(algorithm, 2, useCache);
+			const auto par4 = run_pf_synthetic(algorithm, 4, useCache);
+			EXPECT_EQ(serial.size(), par2.size());
+			// Results must not depend on the number of threads:
+			EXPECT_EQ(par2, par4)
+				<< "algorithm=" << int(algorithm) << " cache=" << useCache;
+		}
+}
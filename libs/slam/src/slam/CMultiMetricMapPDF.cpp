@@ -352,8 +352,10 @@ void CMultiMetricMapPDF::rebuildAverageMap()
 
 		// Reserve a float grid-map, add weight all maps
 		// -------------------------------------------------------------------------------------------
+		COccupancyGridMap2D& avrGrid = *averageMap.m_gridMaps[0];
+		const unsigned int sx = avrGrid.getSizeX(), sy = avrGrid.getSizeY();
 		std::vector<float> floatMap;
-		floatMap.resize(averageMap.m_gridMaps[0]->map.size(), 0);
+		floatMap.resize(size_t(sx) * sy, 0);
 
 		// For each particle in the RBPF:
 		double sumW = 0;
@@ -364,37 +366,33 @@ void CMultiMetricMapPDF::rebuildAverageMap()
 
 		for (part = m_particles.begin(); part != m_particles.end(); ++part)
 		{
-			// Variables:
-			std::vector<COccupancyGridMap2D::cellType>::iterator srcCell;
-			std::vector<COccupancyGridMap2D::cellType>::iterator firstSrcCell =
-				part->d->mapTillNow.m_gridMaps[0]->map.begin();
-			std::vector<COccupancyGridMap2D::cellType>::iterator lastSrcCell =
-				part->d->mapTillNow.m_gridMaps[0]->map.end();
-			std::vector<float>::iterator destCell;
+			const COccupancyGridMap2D& grid =
+				*part->d->mapTillNow.m_gridMaps[0];
 
 			// The weight of particle:
 			float w = exp(part->log_w) / sumW;
 
-			ASSERT_(
-				part->d->mapTillNow.m_gridMaps[0]->map.size() ==
-				floatMap.size());
-
 			// For each cell in individual maps:
-			for (srcCell = firstSrcCell, destCell = floatMap.begin();
-				 srcCell != lastSrcCell; srcCell++, destCell++)
-				(*destCell) += w * (*srcCell);
+			for (unsigned int cy = 0; cy < sy; cy++)
+			{
+				const COccupancyGridMap2D::cellType* srcCell =
+					grid.cellsRow(cy);
+				float* destCell = &floatMap[size_t(cy) * sx];
+				for (unsigned int cx = 0; cx < sx; cx++)
+					destCell[cx] += w * srcCell[cx];
+			}
 		}
 
 		// Copy to fixed point map:
-		std::vector<float>::iterator srcCell;
-		std::vector<COccupancyGridMap2D::cellType>::iterator destCell =
-			averageMap.m_gridMaps[0]->map.begin();
-
-		ASSERT_(averageMap.m_gridMaps[0]->map.size() == floatMap.size());
-
-		for (srcCell = floatMap.begin(); srcCell != floatMap.end();
-			 srcCell++, destCell++)
-			*destCell = static_cast<COccupancyGridMap2D::cellType>(*srcCell);
+		for (unsigned int cy = 0; cy < sy; cy++)
+		{
+			const float* srcCell = &floatMap[size_t(cy) * sx];
+			COccupancyGridMap2D::cellType* destCell =
+				avrGrid.cellsRowForWriting(cy);
+			for (unsigned int cx = 0; cx < sx; cx++)
+				destCell[cx] =
+					static_cast<COccupancyGridMap2D::cellType>(srcCell[cx]);
+		}
 
 		MRPT_END
 	}  // End of SSE not supported
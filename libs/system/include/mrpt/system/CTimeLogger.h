@@ -12,6 +12,9 @@
 #include <mrpt/system/COutputLogger.h>
 #include <mrpt/core/exceptions.h>
 #include <mrpt/containers/ts_hash_map.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <stack>
 #include <map>
@@ -35,6 +38,28 @@ namespace system
  * - `enter()`: average 445 ns
  * - `leave()`: average 316 ns
  *
+ * <b>Hierarchical mode</b> (see setHierarchicalMode()): meant for profiling
+ * inner loops and multi-threaded code. Each thread records its calls into its
+ * own buffer, with no contention between threads, as a tree of nested
+ * sections (a "call tree", see getCallTree()), which can be also saved as a
+ * timeline to be viewed in Chrome's `chrome://tracing` (see
+ * enableTraceRecording(), saveToChromeTraceFile()). Sections are identified by
+ * integer IDs, interned once per call site with MRPT_TIME_LOGGER_SCOPE(),
+ * instead of looking up their names in each call:
+ * \code
+ *    CTimeLogger logger;
+ *    logger.setHierarchicalMode();
+ *    // ...
+ *    for (...)
+ *    {
+ *       MRPT_TIME_LOGGER_SCOPE(logger, "inner-loop");
+ *       // do whatever
+ *    }
+ * \endcode
+ * The name-based API (enter(), leave(), CTimeLoggerEntry, getStats(),...)
+ * still works in this mode: flat stats per section name are computed from the
+ * call trees of all threads.
+ *
  * \sa CTimeLoggerEntry
  *
  * \note The default behavior is dumping all the information at destruction.
@@ -68,6 +93,26 @@ class CTimeLogger : public mrpt::system::COutputLogger
 	void do_enter(const char* func_name);
 	double do_leave(const char* func_name);
 
+   public:
+	/** Identifier of a section name, see internSectionName() */
+	using section_id_t = uint32_t;
+
+   protected:
+	/** Call tree and trace of one thread, for the hierarchical mode */
+	struct ThreadData;
+	bool m_hierarchical{false};
+	bool m_trace_enabled{false};
+	std::size_t m_trace_max_events{0};
+	/** Unique ID of this object, to find its per-thread data */
+	uint64_t m_uid;
+	mutable std::mutex m_threads_mtx;
+	std::vector<std::shared_ptr<ThreadData>> m_threads;
+
+	ThreadData& getThreadData();
+	void do_enter_section(const section_id_t id);
+	double do_leave_section(const section_id_t id);
+	void copyThreadDataFrom(const CTimeLogger& o);
+
    public:
 	/** Data of each call section: # of calls, minimum, maximum, average and
 	 * overall execution time (in seconds) \sa getStats */
@@ -129,6 +174,58 @@ class CTimeLogger : public mrpt::system::COutputLogger
 	/** Return the last execution time of the given "section", or 0 if it hasn't
 	 * ever been called "enter" with that section name */
 	double getLastTime(const std::string& name) const;
+
+	/** @name Hierarchical mode
+		@{ */
+
+	/** Returns the unique ID of a section name, the same for all CTimeLogger
+	 * objects. The cost involves a global lock, so it should be called once
+	 * per call site, e.g. by means of MRPT_TIME_LOGGER_SCOPE(). */
+	static section_id_t internSectionName(const char* name);
+	/** Returns the name of a section ID \sa internSectionName */
+	static std::string getSectionName(const section_id_t id);
+
+	/** Switches to the hierarchical, thread-aware mode (see the class
+	 * description). Should be called before profiling any section. */
+	void setHierarchicalMode(bool enable = true) { m_hierarchical = enable; }
+	bool isHierarchicalMode() const { return m_hierarchical; }
+	/** In hierarchical mode, records each call to a section (thread, start
+	 * time and duration), to be saved with saveToChromeTraceFile().
+	 * \param max_events_per_thread Further calls are not recorded, to bound
+	 * memory usage (each call takes 24 bytes). */
+	void enableTraceRecording(
+		bool enable = true, std::size_t max_events_per_thread = 1000000);
+
+	/** Start of a section in hierarchical mode \sa MRPT_TIME_LOGGER_SCOPE */
+	inline void enterSection(const section_id_t id)
+	{
+		if (m_enabled) do_enter_section(id);
+	}
+	/** End of a section in hierarchical mode \return The ellapsed time, in
+	 * seconds or 0 if disabled. */
+	inline double leaveSection(const section_id_t id)
+	{
+		return m_enabled ? do_leave_section(id) : 0;
+	}
+
+	/** A node in the call tree, with the stats of a section in one context
+	 * (sequence of parent sections). \sa getCallTree */
+	struct TCallTreeNode
+	{
+		std::string name;
+		TCallStats stats{0, 0, 0, 0, 0, 0};
+		std::vector<TCallTreeNode> children;
+	};
+	/** Returns the tree of nested sections, merged from all threads. The root
+	 * node has no name nor stats. */
+	TCallTreeNode getCallTree() const;
+	/** Dump the call tree to a multi-line text string \sa getCallTree */
+	std::string getCallTreeAsText(const size_t column_width = 80) const;
+	/** Saves all calls recorded since enableTraceRecording() as a JSON file in
+	 * the Chrome "Trace Event Format", which can be open with
+	 * `chrome://tracing`. \return false on error writing the file. */
+	bool saveToChromeTraceFile(const std::string& json_file) const;
+	/** @} */
 };  // End of class def.
 
 /** A safe way to call enter() and leave() of a mrpt::system::CTimeLogger upon
@@ -151,11 +248,31 @@ class CTimeLogger : public mrpt::system::COutputLogger
 struct CTimeLoggerEntry
 {
 	CTimeLoggerEntry(const CTimeLogger& logger, const char* section_name);
+	/** Use an interned section ID, for CTimeLogger hierarchical mode. */
+	CTimeLoggerEntry(
+		const CTimeLogger& logger, const CTimeLogger::section_id_t section_id);
 	~CTimeLoggerEntry();
 	CTimeLogger& m_logger;
+	/** nullptr if the section is given by `m_section_id` */
 	const char* m_section_name;
+	CTimeLogger::section_id_t m_section_id;
 };
 
+#define MRPT_TIME_LOGGER_CONCAT_(a, b) a##b
+#define MRPT_TIME_LOGGER_CONCAT(a, b) MRPT_TIME_LOGGER_CONCAT_(a, b)
+
+/** Profiles the rest of the current scope as a section of a CTimeLogger, whose
+ * name is interned only once (the first time this line runs). This is the
+ * fastest way to use CTimeLogger in hierarchical mode.
+ * \ingroup mrpt_system_grp */
+#define MRPT_TIME_LOGGER_SCOPE(_LOGGER, _SECTION_NAME)                   \
+	static const mrpt::system::CTimeLogger::section_id_t                 \
+		MRPT_TIME_LOGGER_CONCAT(mrpt_tle_section_id_, __LINE__) =         \
+			mrpt::system::CTimeLogger::internSectionName(_SECTION_NAME);  \
+	const mrpt::system::CTimeLoggerEntry MRPT_TIME_LOGGER_CONCAT(        \
+		mrpt_tle_entry_, __LINE__)(                                      \
+		_LOGGER, MRPT_TIME_LOGGER_CONCAT(mrpt_tle_section_id_, __LINE__))
+
 /** @name Auxiliary stuff for the global profiler used in MRPT_START / MRPT_END
   macros.
   @{ */
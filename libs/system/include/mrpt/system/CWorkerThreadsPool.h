@@ -0,0 +1,107 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace mrpt
+{
+namespace system
+{
+/** A simple pool of worker threads, fed from a FIFO queue of tasks.
+ *
+ * Tasks can be submitted individually with enqueue(), which returns a
+ * std::future for its result, or as a data-parallel loop with
+ * parallel_for(), which splits a range of indices into contiguous chunks and
+ * blocks until all of them have been processed. The calling thread also
+ * processes chunks in parallel_for(), so it is safe to call it from within a
+ * task running in the same pool (nested parallelism never deadlocks, it just
+ * degrades into serial execution if all workers are busy).
+ *
+ * A pool with zero threads is valid: all work is then run in the calling
+ * thread, which is handy to switch off parallelism without special cases.
+ *
+ * \note [New in MRPT 2.0.0]
+ * \ingroup mrpt_system_grp
+ */
+class CWorkerThreadsPool
+{
+   public:
+	/** Creates the pool with the given number of worker threads. Use
+	 * CWorkerThreadsPool::hardwareThreads() to use all cores. */
+	explicit CWorkerThreadsPool(std::size_t num_threads);
+	/** Dtor: waits for all pending tasks to finish and joins the threads. */
+	~CWorkerThreadsPool();
+
+	CWorkerThreadsPool(const CWorkerThreadsPool&) = delete;
+	CWorkerThreadsPool& operator=(const CWorkerThreadsPool&) = delete;
+
+	/** Submits a task to the queue. \return A future for its result. */
+	template <class F, class... Args>
+	auto enqueue(F&& f, Args&&... args)
+		-> std::future<typename std::result_of<F(Args...)>::type>
+	{
+		using return_type = typename std::result_of<F(Args...)>::type;
+		auto task = std::make_shared<std::packaged_task<return_type()>>(
+			std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+		std::future<return_type> res = task->get_future();
+		if (m_threads.empty())
+		{
+			(*task)();
+			return res;
+		}
+		{
+			std::unique_lock<std::mutex> lock(m_queue_mutex);
+			m_tasks.emplace([task]() { (*task)(); });
+		}
+		m_condition.notify_one();
+		return res;
+	}
+
+	/** Runs `body(first,last)` over contiguous chunks `[first,last)` covering
+	 * `[0,N)`, in parallel, and returns once all chunks are done.
+	 * Exceptions thrown from `body` are re-thrown in the calling thread.
+	 * \param min_chunk_size Minimum number of indices per chunk, to avoid
+	 * scheduling overhead for tiny workloads.
+	 */
+	void parallel_for(
+		std::size_t N,
+		const std::function<void(std::size_t, std::size_t)>& body,
+		std::size_t min_chunk_size = 1);
+
+	/** Number of worker threads. */
+	std::size_t size() const { return m_threads.size(); }
+	/** Number of tasks waiting in the queue. */
+	std::size_t pendingTasks() const;
+
+	/** Returns std::thread::hardware_concurrency(), or 1 if unknown. */
+	static std::size_t hardwareThreads();
+
+   private:
+	std::vector<std::thread> m_threads;
+	std::queue<std::function<void()>> m_tasks;
+	mutable std::mutex m_queue_mutex;
+	std::condition_variable m_condition;
+	std::atomic_bool m_do_stop;
+
+	void workerThreadMain();
+};
+
+}  // namespace system
+}  // namespace mrpt
@@ -12,8 +12,15 @@
 #include <mrpt/system/CTimeLogger.h>
 #include <mrpt/system/string_utils.h>
 #include <mrpt/core/bits_math.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <iostream>
 #include <fstream>
+#include <functional>
+#include <limits>
+#include <unordered_map>
 
 using namespace mrpt;
 using namespace mrpt::system;
@@ -51,9 +58,417 @@ void global_profiler_leave(const char* func_name) noexcept
 }
 }
 
+// ----------------- Hierarchical mode --------------------
+namespace
+{
+using section_id_t = CTimeLogger::section_id_t;
+
+/** Global registry of section names */
+struct SectionNames
+{
+	std::mutex mtx;
+	std::unordered_map<std::string, section_id_t> ids;
+	std::deque<std::string> names;
+
+	static SectionNames& Instance()
+	{
+		static SectionNames obj;
+		return obj;
+	}
+};
+
+/** Each object gets a different ID, never reused, to find its per-thread
+ * data from thread-local storage. */
+uint64_t newLoggerUID()
+{
+	static std::atomic<uint64_t> last_uid{0};
+	return ++last_uid;
+}
+
+/** A small, stable index for each thread, for traces */
+uint32_t currentThreadIndex()
+{
+	static std::atomic<uint32_t> num_threads{0};
+	thread_local const uint32_t idx = num_threads++;
+	return idx;
+}
+
+/** Monotonic clock, in nanoseconds */
+inline int64_t nowNanoseconds()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+			   std::chrono::steady_clock::now().time_since_epoch())
+		.count();
+}
+
+/** Per-thread cache of name => ID, for enter()/leave() in hierarchical mode,
+ * so the global registry (and its lock) is only used once per name. */
+section_id_t internSectionNameCached(const char* name)
+{
+	thread_local std::unordered_map<std::string, section_id_t> cache;
+	thread_local std::string key;
+	key = name;
+	auto it = cache.find(key);
+	if (it != cache.end()) return it->second;
+	const auto id = CTimeLogger::internSectionName(name);
+	cache[key] = id;
+	return id;
+}
+}  // namespace
+
+struct CTimeLogger::ThreadData
+{
+	/** Only locked by the owner thread, unless stats are being read */
+	std::mutex mtx;
+	uint32_t thread_index{0};
+
+	struct Node
+	{
+		section_id_t id;
+		uint32_t parent;
+		std::vector<uint32_t> children;
+		TCallStats stats{0, 0, 0, 0, 0, 0};
+	};
+	/** The tree of calls. nodes[0] is the root. */
+	std::vector<Node> nodes{Node{0, 0, {}}};
+
+	struct OpenCall
+	{
+		uint32_t node;
+		int64_t start;
+	};
+	std::vector<OpenCall> open_calls;
+
+	struct TraceEvent
+	{
+		section_id_t id;
+		int64_t start, duration;  // nanoseconds
+	};
+	std::vector<TraceEvent> trace;
+
+	void resetStats()
+	{
+		for (auto& n : nodes) n.stats = TCallStats{0, 0, 0, 0, 0, 0};
+		trace.clear();
+	}
+};
+
+CTimeLogger::section_id_t CTimeLogger::internSectionName(const char* name)
+{
+	auto& reg = SectionNames::Instance();
+	std::lock_guard<std::mutex> lck(reg.mtx);
+	const auto it = reg.ids.find(name);
+	if (it != reg.ids.end()) return it->second;
+	const auto id = static_cast<section_id_t>(reg.names.size());
+	reg.names.emplace_back(name);
+	reg.ids[name] = id;
+	return id;
+}
+
+std::string CTimeLogger::getSectionName(const section_id_t id)
+{
+	auto& reg = SectionNames::Instance();
+	std::lock_guard<std::mutex> lck(reg.mtx);
+	ASSERT_BELOW_(id, reg.names.size());
+	return reg.names[id];
+}
+
+CTimeLogger::ThreadData& CTimeLogger::getThreadData()
+{
+	// Fast path: same logger as in the last call from this thread. Kept apart
+	// from the map, since trivial thread_local's have no init/dtor guards.
+	thread_local uint64_t last_uid = 0;
+	thread_local ThreadData* last = nullptr;
+	if (last_uid == m_uid) return *last;
+
+	thread_local std::unordered_map<uint64_t, std::weak_ptr<ThreadData>> all;
+	std::shared_ptr<ThreadData> td;
+	auto it = all.find(m_uid);
+	if (it != all.end()) td = it->second.lock();
+	if (!td)
+	{
+		// Forget about destroyed loggers:
+		if (all.size() > 64)
+		{
+			for (auto i = all.begin(); i != all.end();)
+			{
+				if (i->second.expired())
+					i = all.erase(i);
+				else
+					++i;
+			}
+		}
+		td = std::make_shared<ThreadData>();
+		td->thread_index = currentThreadIndex();
+		{
+			std::lock_guard<std::mutex> lck(m_threads_mtx);
+			m_threads.push_back(td);
+		}
+		all[m_uid] = td;
+	}
+	last_uid = m_uid;
+	last = td.get();
+	return *td;
+}
+
+void CTimeLogger::do_enter_section(const section_id_t id)
+{
+	ThreadData& td = getThreadData();
+	std::lock_guard<std::mutex> lck(td.mtx);
+
+	const uint32_t parent =
+		td.open_calls.empty() ? 0 : td.open_calls.back().node;
+	uint32_t node = 0;
+	for (const auto c : td.nodes[parent].children)
+	{
+		if (td.nodes[c].id == id)
+		{
+			node = c;
+			break;
+		}
+	}
+	if (!node)
+	{
+		node = static_cast<uint32_t>(td.nodes.size());
+		td.nodes.push_back(ThreadData::Node{id, parent, {}});
+		td.nodes[parent].children.push_back(node);
+	}
+	td.nodes[node].stats.n_calls++;
+	// Read the time at the end, to avoid counting our own delays:
+	td.open_calls.push_back({node, nowNanoseconds()});
+}
+
+double CTimeLogger::do_leave_section(const section_id_t id)
+{
+	const int64_t now = nowNanoseconds();
+	ThreadData& td = getThreadData();
+	std::lock_guard<std::mutex> lck(td.mtx);
+
+	// Normally, the innermost section. Otherwise, close the inner ones (e.g.
+	// their leave() were skipped by an exception).
+	auto it = std::find_if(
+		td.open_calls.rbegin(), td.open_calls.rend(),
+		[&](const ThreadData::OpenCall& c) {
+			return td.nodes[c.node].id == id;
+		});
+	if (it == td.open_calls.rend()) return 0;  // This shouldn't happen!
+	const ThreadData::OpenCall call = *it;
+	td.open_calls.erase(std::next(it).base(), td.open_calls.end());
+
+	const double At = (now - call.start) * 1e-9;
+	TCallStats& s = td.nodes[call.node].stats;
+	s.last_t = At;
+	s.total_t += At;
+	if (s.n_calls == 1)
+	{
+		s.min_t = At;
+		s.max_t = At;
+	}
+	else
+	{
+		mrpt::keep_min(s.min_t, At);
+		mrpt::keep_max(s.max_t, At);
+	}
+	if (m_trace_enabled && td.trace.size() < m_trace_max_events)
+		td.trace.push_back({id, call.start, now - call.start});
+	return At;
+}
+
+void CTimeLogger::enableTraceRecording(
+	bool enable, std::size_t max_events_per_thread)
+{
+	m_trace_max_events = max_events_per_thread;
+	m_trace_enabled = enable;
+}
+
+void CTimeLogger::copyThreadDataFrom(const CTimeLogger& o)
+{
+	m_hierarchical = o.m_hierarchical;
+	m_trace_enabled = o.m_trace_enabled;
+	m_trace_max_events = o.m_trace_max_events;
+	// A new ID, so no thread uses our former per-thread data anymore:
+	m_uid = newLoggerUID();
+
+	std::vector<std::shared_ptr<ThreadData>> threads;
+	{
+		std::lock_guard<std::mutex> lck(o.m_threads_mtx);
+		threads = o.m_threads;
+	}
+	for (auto& td : threads)
+	{
+		// Copy the results only, not owned by any thread:
+		auto cp = std::make_shared<ThreadData>();
+		std::lock_guard<std::mutex> lck(td->mtx);
+		cp->thread_index = td->thread_index;
+		cp->nodes = td->nodes;
+		cp->trace = td->trace;
+		td = cp;
+	}
+	std::lock_guard<std::mutex> lck(m_threads_mtx);
+	m_threads = std::move(threads);
+}
+
+CTimeLogger::TCallTreeNode CTimeLogger::getCallTree() const
+{
+	std::vector<std::shared_ptr<ThreadData>> threads;
+	{
+		std::lock_guard<std::mutex> lck(m_threads_mtx);
+		threads = m_threads;
+	}
+
+	TCallTreeNode root;
+	for (const auto& td : threads)
+	{
+		std::lock_guard<std::mutex> lck(td->mtx);
+		std::function<void(uint32_t, TCallTreeNode&)> merge;
+		merge = [&](uint32_t idx, TCallTreeNode& out) {
+			for (const auto c : td->nodes[idx].children)
+			{
+				const auto& n = td->nodes[c];
+				if (!n.stats.n_calls) continue;
+				const std::string name = getSectionName(n.id);
+				auto it = std::find_if(
+					out.children.begin(), out.children.end(),
+					[&](const TCallTreeNode& e) { return e.name == name; });
+				if (it == out.children.end())
+				{
+					out.children.emplace_back();
+					it = out.children.end() - 1;
+					it->name = name;
+					it->stats = n.stats;
+				}
+				else
+				{
+					TCallStats& s = it->stats;
+					mrpt::keep_min(s.min_t, n.stats.min_t);
+					mrpt::keep_max(s.max_t, n.stats.max_t);
+					s.n_calls += n.stats.n_calls;
+					s.total_t += n.stats.total_t;
+					s.last_t = n.stats.last_t;
+				}
+				merge(c, *it);
+			}
+		};
+		merge(0, root);
+	}
+
+	// Compute means, and sort by total time:
+	std::function<void(TCallTreeNode&)> finish;
+	finish = [&](TCallTreeNode& n) {
+		n.stats.mean_t =
+			n.stats.n_calls ? n.stats.total_t / n.stats.n_calls : 0;
+		std::sort(
+			n.children.begin(), n.children.end(),
+			[](const TCallTreeNode& a, const TCallTreeNode& b) {
+				return a.stats.total_t > b.stats.total_t;
+			});
+		for (auto& c : n.children) finish(c);
+	};
+	finish(root);
+	return root;
+}
+
+std::string CTimeLogger::getCallTreeAsText(const size_t column_width) const
+{
+	std::string s = "Call tree:\n";
+	s += "           FUNCTION                         #CALLS  MIN.T  MEAN.T "
+		 "MAX.T TOTAL \n";
+	s += std::string(column_width, '-') + "\n";
+
+	std::function<void(const TCallTreeNode&, size_t)> print;
+	print = [&](const TCallTreeNode& n, size_t depth) {
+		for (const auto& c : n.children)
+		{
+			s += format(
+				"%s %7u %6ss %6ss %6ss %6ss\n",
+				rightPad(std::string(2 * depth, ' ') + c.name, 39, true)
+					.c_str(),
+				static_cast<unsigned int>(c.stats.n_calls),
+				unitsFormat(c.stats.min_t, 1, false).c_str(),
+				unitsFormat(c.stats.mean_t, 1, false).c_str(),
+				unitsFormat(c.stats.max_t, 1, false).c_str(),
+				unitsFormat(c.stats.total_t, 1, false).c_str());
+			print(c, depth + 1);
+		}
+	};
+	print(getCallTree(), 0);
+	return s;
+}
+
+/** Escapes a string for a JSON file */
+static std::string jsonEscape(const std::string& str)
+{
+	std::string r;
+	r.reserve(str.size());
+	for (const char c : str)
+	{
+		if (c == '"' || c == '\\')
+		{
+			r += '\\';
+			r += c;
+		}
+		else if (static_cast<unsigned char>(c) < 0x20)
+			r += format("\\u%04x", static_cast<unsigned int>(c));
+		else
+			r += c;
+	}
+	return r;
+}
+
+bool CTimeLogger::saveToChromeTraceFile(const std::string& json_file) const
+{
+	std::ofstream f(json_file);
+	if (!f.is_open()) return false;
+
+	std::vector<std::shared_ptr<ThreadData>> threads;
+	{
+		std::lock_guard<std::mutex> lck(m_threads_mtx);
+		threads = m_threads;
+	}
+	std::map<section_id_t, std::string> names;
+	int64_t t0 = std::numeric_limits<int64_t>::max();
+	for (const auto& td : threads)
+	{
+		std::lock_guard<std::mutex> lck(td->mtx);
+		for (const auto& e : td->trace)
+		{
+			mrpt::keep_min(t0, e.start);
+			if (!names.count(e.id))
+				names[e.id] = jsonEscape(getSectionName(e.id));
+		}
+	}
+
+	// "Complete" events (ph:X), with times in microseconds:
+	f << "{\"traceEvents\":[\n";
+	const std::string process =
+		jsonEscape(m_name.empty() ? "CTimeLogger" : m_name);
+	f << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,"
+		 "\"args\":{\"name\":\""
+	  << process << "\"}}";
+	for (const auto& td : threads)
+	{
+		std::lock_guard<std::mutex> lck(td->mtx);
+		for (const auto& e : td->trace)
+		{
+			f << format(
+				",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%u,"
+				"\"ts\":%.3f,\"dur\":%.3f}",
+				names[e.id].c_str(), td->thread_index,
+				(e.start - t0) * 1e-3, e.duration * 1e-3);
+		}
+	}
+	f << "\n],\"displayTimeUnit\":\"ms\"}\n";
+	return f.good();
+}
+
+// ----------------- CTimeLogger --------------------
 CTimeLogger::CTimeLogger(
 	bool enabled /*=true*/, const std::string& name /*=""*/)
-	: COutputLogger("CTimeLogger"), m_tictac(), m_enabled(enabled), m_name(name)
+	: COutputLogger("CTimeLogger"),
+	  m_tictac(),
+	  m_enabled(enabled),
+	  m_name(name),
+	  m_uid(newLoggerUID())
 {
 	m_tictac.Tic();
 }
@@ -61,7 +476,12 @@ CTimeLogger::CTimeLogger(
 CTimeLogger::~CTimeLogger()
 {
 	// Dump all stats:
-	if (!m_data.empty())  // If logging is disabled, do nothing...
+	bool has_sections = !m_data.empty();
+	{
+		std::lock_guard<std::mutex> lck(m_threads_mtx);
+		has_sections = has_sections || !m_threads.empty();
+	}
+	if (has_sections)  // If logging is disabled, do nothing...
 		dumpAllStats();
 }
 
@@ -71,13 +491,16 @@ CTimeLogger::CTimeLogger(const CTimeLogger& o)
 	  m_name(o.m_name),
 	  m_data(o.m_data)
 {
+	copyThreadDataFrom(o);
 }
 CTimeLogger& CTimeLogger::operator=(const CTimeLogger& o)
 {
+	if (this == &o) return *this;
 	COutputLogger::operator=(o);
 	m_enabled = o.m_enabled;
 	m_name = o.m_name;
 	m_data = o.m_data;
+	copyThreadDataFrom(o);
 	return *this;
 }
 CTimeLogger::CTimeLogger(CTimeLogger&& o)
@@ -86,13 +509,16 @@ CTimeLogger::CTimeLogger(CTimeLogger&& o)
 	  m_name(o.m_name),
 	  m_data(o.m_data)
 {
+	copyThreadDataFrom(o);
 }
 CTimeLogger& CTimeLogger::operator=(CTimeLogger&& o)
 {
+	if (this == &o) return *this;
 	COutputLogger::operator=(o);
 	m_enabled = o.m_enabled;
 	m_name = o.m_name;
 	m_data = o.m_data;
+	copyThreadDataFrom(o);
 	return *this;
 }
 
@@ -104,6 +530,14 @@ void CTimeLogger::clear(bool deep_clear)
 	{
 		for (auto& e : m_data) e.second = TCallData();
 	}
+
+	// Sections being profiled by other threads right now must be kept:
+	std::lock_guard<std::mutex> lck(m_threads_mtx);
+	for (auto& td : m_threads)
+	{
+		std::lock_guard<std::mutex> lck2(td->mtx);
+		td->resetStats();
+	}
 }
 
 std::string aux_format_string_multilines(const std::string& s, const size_t len)
@@ -131,6 +565,29 @@ void CTimeLogger::getStats(std::map<std::string, TCallStats>& out_stats) const
 		cs.n_calls = e.second.n_calls;
 		cs.last_t = e.second.last_t;
 	}
+
+	// Sections of the hierarchical mode, for all threads and parents:
+	std::function<void(const TCallTreeNode&)> add;
+	add = [&](const TCallTreeNode& n) {
+		for (const auto& c : n.children)
+		{
+			auto it = out_stats.find(c.name);
+			if (it == out_stats.end())
+				out_stats[c.name] = c.stats;
+			else
+			{
+				TCallStats& cs = it->second;
+				mrpt::keep_min(cs.min_t, c.stats.min_t);
+				mrpt::keep_max(cs.max_t, c.stats.max_t);
+				cs.n_calls += c.stats.n_calls;
+				cs.total_t += c.stats.total_t;
+				cs.mean_t = cs.total_t / cs.n_calls;
+				cs.last_t = c.stats.last_t;
+			}
+			add(c);
+		}
+	};
+	add(getCallTree());
 }
 
 std::string CTimeLogger::getStatsAsText(const size_t column_width) const
@@ -182,6 +639,10 @@ std::string CTimeLogger::getStatsAsText(const size_t column_width) const
 			i.second.has_time_units ? 's' : ' ');
 	}
 
+	// Hierarchical mode:
+	if (!getCallTree().children.empty())
+		stats_text += getCallTreeAsText(column_width);
+
 	std::string footer(top_header);
 	stats_text += footer + "\n";
 
@@ -190,16 +651,18 @@ std::string CTimeLogger::getStatsAsText(const size_t column_width) const
 
 void CTimeLogger::saveToCSVFile(const std::string& csv_file) const
 {
+	std::map<std::string, TCallStats> stats;
+	getStats(stats);
+
 	std::string s;
 	s += "FUNCTION, #CALLS, LAST.T, MIN.T, MEAN.T, MAX.T, TOTAL.T\n";
-	for (const auto& i : m_data)
+	for (const auto& i : stats)
 	{
 		s += format(
 			"\"%s\",\"%7u\",\"%e\",\"%e\",\"%e\",\"%e\",\"%e\"\n",
 			i.first.c_str(), static_cast<unsigned int>(i.second.n_calls),
-			i.second.last_t, i.second.min_t,
-			i.second.n_calls ? i.second.mean_t / i.second.n_calls : 0,
-			i.second.max_t, i.second.mean_t);
+			i.second.last_t, i.second.min_t, i.second.mean_t, i.second.max_t,
+			i.second.total_t);
 	}
 	std::ofstream(csv_file) << s;
 }
@@ -211,6 +674,11 @@ void CTimeLogger::dumpAllStats(const size_t column_width) const
 
 void CTimeLogger::do_enter(const char* func_name)
 {
+	if (m_hierarchical)
+	{
+		do_enter_section(internSectionNameCached(func_name));
+		return;
+	}
 	const string s = func_name;
 	TCallData& d = m_data[s];
 
@@ -221,6 +689,9 @@ void CTimeLogger::do_enter(const char* func_name)
 
 double CTimeLogger::do_leave(const char* func_name)
 {
+	if (m_hierarchical)
+		return do_leave_section(internSectionNameCached(func_name));
+
 	const double tim = m_tictac.Tac();
 
 	const string s = func_name;
@@ -280,7 +751,13 @@ double CTimeLogger::getMeanTime(const std::string& name) const
 {
 	TDataMap::const_iterator it = m_data.find(name);
 	if (it == m_data.end())
-		return 0;
+	{
+		if (!m_hierarchical) return 0;
+		std::map<std::string, TCallStats> stats;
+		getStats(stats);
+		const auto its = stats.find(name);
+		return its == stats.end() ? 0 : its->second.mean_t;
+	}
 	else
 		return it->second.n_calls ? it->second.mean_t / it->second.n_calls : 0;
 }
@@ -288,15 +765,37 @@ double CTimeLogger::getLastTime(const std::string& name) const
 {
 	TDataMap::const_iterator it = m_data.find(name);
 	if (it == m_data.end())
-		return 0;
+	{
+		if (!m_hierarchical) return 0;
+		std::map<std::string, TCallStats> stats;
+		getStats(stats);
+		const auto its = stats.find(name);
+		return its == stats.end() ? 0 : its->second.last_t;
+	}
 	else
 		return it->second.last_t;
 }
 
 CTimeLoggerEntry::CTimeLoggerEntry(
 	const CTimeLogger& logger, const char* section_name)
-	: m_logger(const_cast<CTimeLogger&>(logger)), m_section_name(section_name)
+	: m_logger(const_cast<CTimeLogger&>(logger)),
+	  m_section_name(section_name),
+	  m_section_id(0)
 {
 	m_logger.enter(m_section_name);
 }
-CTimeLoggerEntry::~CTimeLoggerEntry() { m_logger.leave(m_section_name); }
+CTimeLoggerEntry::CTimeLoggerEntry(
+	const CTimeLogger& logger, const CTimeLogger::section_id_t section_id)
+	: m_logger(const_cast<CTimeLogger&>(logger)),
+	  m_section_name(nullptr),
+	  m_section_id(section_id)
+{
+	m_logger.enterSection(m_section_id);
+}
+CTimeLoggerEntry::~CTimeLoggerEntry()
+{
+	if (m_section_name)
+		m_logger.leave(m_section_name);
+	else
+		m_logger.leaveSection(m_section_id);
+}
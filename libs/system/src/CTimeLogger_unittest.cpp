@@ -0,0 +1,94 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/system/CTimeLogger.h>
+#include <mrpt/system/filesystem.h>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <iterator>
+#include <thread>
+
+using mrpt::system::CTimeLogger;
+using mrpt::system::CTimeLoggerEntry;
+
+namespace
+{
+void inner(CTimeLogger& tl) { MRPT_TIME_LOGGER_SCOPE(tl, "inner"); }
+void outer(CTimeLogger& tl)
+{
+	MRPT_TIME_LOGGER_SCOPE(tl, "outer");
+	for (int i = 0; i < 10; i++) inner(tl);
+}
+}  // namespace
+
+TEST(CTimeLogger, internSectionName)
+{
+	const auto id = CTimeLogger::internSectionName("CTimeLogger.test.a");
+	EXPECT_EQ(id, CTimeLogger::internSectionName("CTimeLogger.test.a"));
+	EXPECT_NE(id, CTimeLogger::internSectionName("CTimeLogger.test.b"));
+	EXPECT_EQ(CTimeLogger::getSectionName(id), "CTimeLogger.test.a");
+}
+
+TEST(CTimeLogger, hierarchicalMultiThread)
+{
+	CTimeLogger tl(true, "test");
+	tl.setVerbosityLevel(mrpt::system::LVL_ERROR);
+	tl.setHierarchicalMode();
+	tl.enableTraceRecording();
+
+	const int nThreads = 4, nCalls = 50;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < nThreads; t++)
+		threads.emplace_back([&]() {
+			for (int i = 0; i < nCalls; i++) outer(tl);
+			// The name-based API works on top:
+			CTimeLoggerEntry tle(tl, "legacy");
+			inner(tl);
+		});
+	for (auto& t : threads) t.join();
+
+	const auto tree = tl.getCallTree();
+	ASSERT_EQ(tree.children.size(), 2U);
+	for (const auto& c : tree.children)
+	{
+		ASSERT_EQ(c.children.size(), 1U);
+		EXPECT_EQ(c.children[0].name, "inner");
+		if (c.name == "outer")
+		{
+			EXPECT_EQ(c.stats.n_calls, size_t(nThreads * nCalls));
+			EXPECT_EQ(
+				c.children[0].stats.n_calls, size_t(nThreads * nCalls * 10));
+			EXPECT_GE(c.stats.total_t, c.children[0].stats.total_t);
+		}
+		else
+		{
+			EXPECT_EQ(c.name, "legacy");
+			EXPECT_EQ(c.stats.n_calls, size_t(nThreads));
+			EXPECT_EQ(c.children[0].stats.n_calls, size_t(nThreads));
+		}
+	}
+
+	// Flat stats, per name:
+	std::map<std::string, CTimeLogger::TCallStats> stats;
+	tl.getStats(stats);
+	EXPECT_EQ(stats["inner"].n_calls, size_t(nThreads * (nCalls * 10 + 1)));
+	EXPECT_GT(tl.getMeanTime("outer"), 0);
+
+	const std::string fil = mrpt::system::getTempFileName();
+	EXPECT_TRUE(tl.saveToChromeTraceFile(fil));
+	std::ifstream f(fil);
+	const std::string json(
+		(std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+	EXPECT_NE(json.find("\"name\":\"outer\",\"ph\":\"X\""), std::string::npos);
+	mrpt::system::deleteFile(fil);
+
+	tl.clear();
+	EXPECT_EQ(tl.getCallTree().children.size(), 0U);
+}
@@ -0,0 +1,129 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "system-precomp.h"  // Precompiled headers
+
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <algorithm>
+#include <exception>
+
+using namespace mrpt::system;
+
+CWorkerThreadsPool::CWorkerThreadsPool(std::size_t num_threads)
+	: m_do_stop(false)
+{
+	m_threads.reserve(num_threads);
+	for (std::size_t i = 0; i < num_threads; i++)
+		m_threads.emplace_back(&CWorkerThreadsPool::workerThreadMain, this);
+}
+
+CWorkerThreadsPool::~CWorkerThreadsPool()
+{
+	{
+		std::unique_lock<std::mutex> lock(m_queue_mutex);
+		m_do_stop = true;
+	}
+	m_condition.notify_all();
+	for (auto& t : m_threads)
+		if (t.joinable()) t.join();
+}
+
+std::size_t CWorkerThreadsPool::pendingTasks() const
+{
+	std::unique_lock<std::mutex> lock(m_queue_mutex);
+	return m_tasks.size();
+}
+
+std::size_t CWorkerThreadsPool::hardwareThreads()
+{
+	return std::max<std::size_t>(1, std::thread::hardware_concurrency());
+}
+
+void CWorkerThreadsPool::workerThreadMain()
+{
+	for (;;)
+	{
+		std::function<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(m_queue_mutex);
+			m_condition.wait(
+				lock, [this] { return m_do_stop || !m_tasks.empty(); });
+			// Drain the queue before quitting:
+			if (m_do_stop && m_tasks.empty()) return;
+			task = std::move(m_tasks.front());
+			m_tasks.pop();
+		}
+		task();
+	}
+}
+
+void CWorkerThreadsPool::parallel_for(
+	std::size_t N, const std::function<void(std::size_t, std::size_t)>& body,
+	std::size_t min_chunk_size)
+{
+	if (!N) return;
+	if (min_chunk_size < 1) min_chunk_size = 1;
+
+	const std::size_t max_chunks = (N + min_chunk_size - 1) / min_chunk_size;
+	const std::size_t nChunks = std::min(max_chunks, m_threads.size() + 1);
+	if (nChunks <= 1)
+	{
+		body(0, N);
+		return;
+	}
+
+	// Chunks are grabbed dynamically by workers *and* the calling thread, so
+	// the caller never waits for a chunk nobody has started to process:
+	struct TSharedState
+	{
+		std::atomic<std::size_t> next_chunk{0};
+		std::size_t done_chunks = 0;
+		std::mutex mtx;
+		std::condition_variable cv;
+		std::exception_ptr error;
+	};
+	auto st = std::make_shared<TSharedState>();
+	const std::size_t chunk_len = (N + nChunks - 1) / nChunks;
+
+	auto runChunks = [st, nChunks, chunk_len, N, &body]() {
+		for (;;)
+		{
+			const std::size_t c = st->next_chunk++;
+			if (c >= nChunks) return;
+			const std::size_t first = c * chunk_len;
+			const std::size_t last = std::min(N, first + chunk_len);
+			try
+			{
+				if (first < last) body(first, last);
+			}
+			catch (...)
+			{
+				std::unique_lock<std::mutex> lck(st->mtx);
+				if (!st->error) st->error = std::current_exception();
+			}
+			{
+				std::unique_lock<std::mutex> lck(st->mtx);
+				st->done_chunks++;
+			}
+			st->cv.notify_all();
+		}
+	};
+
+	{
+		std::unique_lock<std::mutex> lock(m_queue_mutex);
+		for (std::size_t i = 1; i < nChunks; i++) m_tasks.emplace(runChunks);
+	}
+	m_condition.notify_all();
+
+	runChunks();
+
+	std::unique_lock<std::mutex> lck(st->mtx);
+	st->cv.wait(lck, [&]() { return st->done_chunks == nChunks; });
+	if (st->error) std::rethrow_exception(st->error);
+}
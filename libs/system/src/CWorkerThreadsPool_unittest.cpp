@@ -0,0 +1,64 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <stdexcept>
+
+TEST(CWorkerThreadsPool, enqueue)
+{
+	for (std::size_t nThreads : {0, 1, 3})
+	{
+		mrpt::system::CWorkerThreadsPool pool(nThreads);
+		EXPECT_EQ(pool.size(), nThreads);
+		std::vector<std::future<int>> res;
+		for (int i = 0; i < 20; i++)
+			res.emplace_back(pool.enqueue([](int x) { return x * x; }, i));
+		for (int i = 0; i < 20; i++) EXPECT_EQ(res[i].get(), i * i);
+	}
+}
+
+TEST(CWorkerThreadsPool, parallel_for)
+{
+	for (std::size_t nThreads : {0, 1, 4})
+	{
+		mrpt::system::CWorkerThreadsPool pool(nThreads);
+		for (std::size_t N : {1, 7, 1000})
+		{
+			std::vector<int> v(N, 0);
+			pool.parallel_for(N, [&](std::size_t i0, std::size_t i1) {
+				for (std::size_t i = i0; i < i1; i++) v[i] += int(i);
+			});
+			// Each index must have been visited exactly once:
+			for (std::size_t i = 0; i < N; i++) EXPECT_EQ(v[i], int(i));
+		}
+	}
+}
+
+TEST(CWorkerThreadsPool, parallel_for_nested_and_exceptions)
+{
+	mrpt::system::CWorkerThreadsPool pool(2);
+	std::vector<int> v(64, 0);
+	pool.parallel_for(8, [&](std::size_t i0, std::size_t i1) {
+		for (std::size_t i = i0; i < i1; i++)
+			pool.parallel_for(8, [&](std::size_t j0, std::size_t j1) {
+				for (std::size_t j = j0; j < j1; j++) v[i * 8 + j] = 1;
+			});
+	});
+	EXPECT_EQ(std::accumulate(v.begin(), v.end(), 0), 64);
+
+	EXPECT_THROW(
+		pool.parallel_for(
+			10,
+			[](std::size_t, std::size_t) {
+				throw std::runtime_error("expected");
+			}),
+		std::runtime_error);
+}
@@ -30,6 +30,7 @@ MRPT_WARNING(
 #include <mrpt/vision/CVideoFileWriter.h>
 #include <mrpt/vision/tracking.h>
 #include <mrpt/vision/descriptor_kdtrees.h>
+#include <mrpt/vision/CDescriptorMatrix.h>
 #include <mrpt/vision/descriptor_pairing.h>
 #include <mrpt/vision/bundle_adjustment.h>
 #include <mrpt/vision/CUndistortMap.h>
@@ -0,0 +1,121 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+#pragma once
+
+#include <mrpt/core/aligned_allocator.h>
+#include <mrpt/vision/types.h>
+#include <cstdint>
+#include <vector>
+
+namespace mrpt
+{
+namespace vision
+{
+class CFeatureList;
+
+/** \addtogroup  mrptvision_features
+	@{ */
+
+/** The descriptors of one kind of all the features in a CFeatureList, packed
+ * in one contiguous, aligned block of memory (one row per feature), for fast
+ * batch distance computations, e.g. in match_descriptors_brute_force().
+ *
+ * Descriptors are stored in one of two formats:
+ * - Binary descriptors (descORB, descLATCH, descBLD): the raw bytes, compared
+ * with the Hamming distance (number of different bits).
+ * - Real-valued descriptors (descSIFT, descSURF): as `float`, compared with
+ * the Euclidean (L2) distance.
+ *
+ * Each row is padded with zeros up to a multiple of 32 bytes, so distance
+ * kernels work on whole SIMD registers, and the whole matrix is aligned to
+ * MRPT_MAX_ALIGN_BYTES. The padding does not change the distances.
+ *
+ * \note The distance for LATCH and BLD descriptors is the Hamming distance,
+ * as for OpenCV's matchers, while CFeature::descriptorLATCHDistanceTo() and
+ * CFeature::descriptorBLDDistanceTo() compare their bytes with L2.
+ * \note [New in MRPT 2.0.0]
+ * \sa match_descriptors_brute_force
+ */
+class CDescriptorMatrix
+{
+   public:
+	/** Empty matrix */
+	CDescriptorMatrix() = default;
+	/** Constructor from a list of features. \sa setFromFeatures */
+	CDescriptorMatrix(const CFeatureList& feats, TDescriptorType desc)
+	{
+		setFromFeatures(feats, desc);
+	}
+
+	/** Copies the descriptors of type `desc` of all features in the list.
+	 * \exception std::exception If `desc` is not one of descORB, descLATCH,
+	 * descBLD, descSIFT or descSURF, or any feature does not have the
+	 * descriptor, or they have different lengths.
+	 */
+	void setFromFeatures(const CFeatureList& feats, TDescriptorType desc);
+
+	/** Removes all rows */
+	void clear();
+
+	/** Number of rows (descriptors) */
+	std::size_t size() const { return m_rows; }
+	bool empty() const { return m_rows == 0; }
+	/** The type of descriptors stored in the matrix */
+	TDescriptorType descriptorType() const { return m_type; }
+	/** Whether descriptors are compared with Hamming (true) or L2 (false) */
+	bool isBinary() const { return m_binary; }
+	/** Length of each descriptor: number of bytes (binary) or of floats. */
+	std::size_t descriptorLength() const { return m_length; }
+	/** Number of bytes between consecutive rows (a multiple of 32). */
+	std::size_t rowStride() const { return m_stride; }
+
+	/** Pointer to the i'th row of a matrix of binary descriptors */
+	const uint8_t* binaryRow(std::size_t i) const
+	{
+		return &m_data[i * m_stride];
+	}
+	/** Pointer to the i'th row of a matrix of real-valued descriptors */
+	const float* floatRow(std::size_t i) const
+	{
+		return reinterpret_cast<const float*>(&m_data[i * m_stride]);
+	}
+
+	/** Distance between the i'th row of this matrix and the j'th row of
+	 * `o`: Hamming or Euclidean distance, depending on the descriptor type.
+	 * Both matrices must have the same type and length of descriptors. */
+	float distance(
+		std::size_t i, const CDescriptorMatrix& o, std::size_t j) const;
+
+	/** Distances between the i'th row of this matrix and rows [j0,j1) of
+	 * `o`, stored in `out[0]`...`out[j1-j0-1]`. For speed in searches, these
+	 * are Hamming distances (binary descriptors) or *squared* Euclidean
+	 * distances. */
+	void rawDistances(
+		std::size_t i, const CDescriptorMatrix& o, std::size_t j0,
+		std::size_t j1, float* out) const;
+
+	/** Number of different bits in two arrays of `n` bytes. Uses AVX2 or
+	 * POPCNT instructions, if available. */
+	static uint32_t hammingDistance(
+		const uint8_t* a, const uint8_t* b, std::size_t n);
+	/** Squared Euclidean distance between two arrays of `n` floats. Uses AVX2
+	 * or SSE2 instructions, if available. */
+	static float squaredL2Distance(
+		const float* a, const float* b, std::size_t n);
+
+   private:
+	std::vector<uint8_t, mrpt::aligned_allocator_cpp11<uint8_t>> m_data;
+	std::size_t m_rows{0}, m_length{0}, m_stride{0};
+	TDescriptorType m_type{descAny};
+	bool m_binary{false};
+};
+
+/** @} */
+}  // namespace vision
+}  // namespace mrpt
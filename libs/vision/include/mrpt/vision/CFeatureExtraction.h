@@ -15,9 +15,14 @@
 #include <mrpt/vision/utils.h>
 #include <mrpt/vision/CFeature.h>
 #include <mrpt/vision/TSimpleFeature.h>
+#include <functional>
 
 namespace mrpt
 {
+namespace system
+{
+class CWorkerThreadsPool;
+}
 namespace vision
 {
 /** The central class from which images can be analyzed in search of different
@@ -72,6 +77,7 @@ namespace vision
   *   - CFeatureExtraction::detectFeatures_SSE2_FASTER9()
   *   - CFeatureExtraction::detectFeatures_SSE2_FASTER10()
   *   - CFeatureExtraction::detectFeatures_SSE2_FASTER12()
+  *   - CFeatureExtraction::detectFeaturesTiled()
   *
   * \note The descriptor "Intensity-domain spin images" is described in "A
   *sparse texture representation using affine-invariant regions", S Lazebnik, C
@@ -312,6 +318,41 @@ class CFeatureExtraction
 			bool rotationInvariance;  // = true,
 			int half_ssd_size;  // = 3
 		} LATCHOptions;
+
+		/** Tiled extraction: the image (or the ROI) is split into a grid of
+		 * cells, the detector runs on each cell (in parallel, if a thread
+		 * pool is given) with its own budget of features, and the results
+		 * are merged with a non-maximum suppression. This distributes the
+		 * features uniformly over the image, and scales with the number of
+		 * cores. Used for featFAST, featFASTER9/10/12, featORB, featHarris
+		 * and featKLT; ignored for other detectors.
+		 * \note [New in MRPT 2.0.0]
+		 */
+		struct TTilingOptions
+		{
+			/** Enables the tiled extraction (default=false) */
+			bool enable{false};
+			/** Number of cells in each direction (default=4x4) */
+			unsigned int cells_x{4}, cells_y{4};
+			/** Maximum number of features in each cell. Default=0: the
+			 * `nDesiredFeatures` in detectFeatures() divided among the
+			 * cells, or no limit if that is also 0. */
+			unsigned int max_features_per_cell{0};
+			/** Pixels around each cell also passed to the detector, so
+			 * features near the cell borders are detected as in the whole
+			 * image. Default=0: automatic, from the patch size and the
+			 * detector options (e.g. larger for ORB with many levels). */
+			unsigned int cell_margin{0};
+			/** Minimum distance between features in the merged list
+			 * [pixels]. Default=0: use the `min_distance` of the detector
+			 * options. */
+			float min_distance{0};
+			/** (Default:nullptr) If provided, cells are processed by the
+			 * threads of this pool (and the calling thread). For stereo
+			 * pairs, both images can share the same pool. Not loaded from
+			 * config files. */
+			mrpt::system::CWorkerThreadsPool* threadPool{nullptr};
+		} tilingOptions;
 	};
 
 	TOptions options;  //!< Set all the parameters of the desired method here
@@ -433,6 +474,32 @@ class CFeatureExtraction
 		uint8_t octave = 0,
 		std::vector<size_t>* out_feats_index_by_row = nullptr);
 
+	/** Callback for detectFeaturesTiled(): detects the features in the image
+	 * region [x0,x1)x[y0,y1) (a cell plus its margins) into `out`, in image
+	 * coordinates and with their `response` set. It is invoked from the
+	 * threads of TOptions::TTilingOptions::threadPool, if one is given. */
+	using TCellDetector = std::function<void(
+		int x0, int y0, int x1, int y1, CFeatureList& out)>;
+
+	/** The detector-independent part of the tiled extraction (see
+	 * TOptions::TTilingOptions), usable with any detector: splits the ROI
+	 * (or the whole WxH image, if the ROI is empty) into cells, runs
+	 * `detector` on each cell extended with a margin (`to.cell_margin`, or
+	 * `default_margin` if 0), drops the features in the margins and keeps
+	 * the ones with the highest response in each cell (up to
+	 * `to.max_features_per_cell`, or `nDesiredFeatures` divided among the
+	 * cells if 0). These are appended to `feats` by decreasing response,
+	 * skipping those closer than `to.min_distance` (or `default_min_dist` if
+	 * 0) to an already added one, up to `nDesiredFeatures` (0: no limit).
+	 * IDs are assigned starting at `init_ID`.
+	 * \ingroup mrptvision_features */
+	static void detectFeaturesTiled(
+		const TOptions::TTilingOptions& to, const TCellDetector& detector,
+		const unsigned int W, const unsigned int H, CFeatureList& feats,
+		unsigned int init_ID = 0, unsigned int nDesiredFeatures = 0,
+		const TImageROI& ROI = TImageROI(), int default_margin = 0,
+		float default_min_dist = 0);
+
 	/** @} */
 
    private:
@@ -623,6 +690,13 @@ class CFeatureExtraction
 		const TImageROI& ROI = TImageROI(),
 		const mrpt::math::CMatrixBool* mask = nullptr) const;
 
+	/** Tiled extraction of features with the detector in options.featsType,
+	 * see TOptions::TTilingOptions */
+	void extractFeaturesTiled(
+		const mrpt::img::CImage& img, CFeatureList& feats,
+		unsigned int init_ID = 0, unsigned int nDesiredFeatures = 0,
+		const TImageROI& ROI = TImageROI()) const;
+
 	/** Edward's "FASTER & Better" detector, N=9,10,12 */
 	void extractFeaturesFASTER_N(
 		const int N, const mrpt::img::CImage& img, CFeatureList& feats,
@@ -11,9 +11,16 @@
 #define __mrpt_vision_image_pyramid_H
 
 #include <mrpt/img/CImage.h>
+#include <mrpt/math/types_math.h>
+#include <cstdint>
+#include <future>
 
 namespace mrpt
 {
+namespace system
+{
+class CWorkerThreadsPool;
+}
 namespace vision
 {
 /** Holds and builds a pyramid of images: starting with an image at full
@@ -50,6 +57,21 @@ namespace vision
   *
   *  \note Both converting to grayscale and building the octave images have
  * SSE2-optimized implementations (if available).
+  *
+  *  The images (and gradients) of each octave are reused when the pyramid is
+ * rebuilt (e.g. for each frame of a video) with images of the same size and
+ * format, so no memory is allocated in that case. Pyramids can also be built
+ * in another thread with \a buildPyramidAsync(), e.g. to build the pyramid of
+ * the next frame while features are tracked in the current one:
+  * \code
+  *   CImagePyramid  pyr[2];
+  *   auto next = pyr[0].buildPyramidAsync(img0, 4);
+  *   for (int i = 0; ; i++) {
+  *      next.get();  // pyr[i%2] is ready
+  *      next = pyr[(i+1)%2].buildPyramidAsync(img[i+1], 4);
+  *      // ... use pyr[i%2]...
+  *   }
+  * \endcode
   *
   * \sa mrpt::img::CImage
   * \ingroup mrpt_vision_grp
@@ -71,11 +93,14 @@ class CImagePyramid
 	 * pixel block when downsampling.
 	  *  \param[in] convert_grayscale If true, the pyramid is built in grayscale
 	 * even for color input images.
+	  *  \param[in] compute_gradients If true, also compute the gradients of
+	 * each octave (see \a computeGradients()). [New in MRPT 2.0.0]
 	  * \sa buildPyramidFast
 	  */
 	void buildPyramid(
 		const mrpt::img::CImage& img, const size_t nOctaves,
-		const bool smooth_halves = true, const bool convert_grayscale = false);
+		const bool smooth_halves = true, const bool convert_grayscale = false,
+		const bool compute_gradients = false);
 
 	/**  Exactly like \a buildPyramid(), but if the input image has not to be
 	 * converted from RGB to grayscale, the image data buffer is *reutilized*
@@ -84,7 +109,37 @@ class CImagePyramid
 	  */
 	void buildPyramidFast(
 		mrpt::img::CImage& img, const size_t nOctaves,
-		const bool smooth_halves = true, const bool convert_grayscale = false);
+		const bool smooth_halves = true, const bool convert_grayscale = false,
+		const bool compute_gradients = false);
+
+	/** Like \a buildPyramid(), but in a thread of `pool` or, if it is
+	 * nullptr, in a new thread. Neither this object nor `img` can be
+	 * accessed until the returned future is ready; its get() method waits
+	 * for it, and rethrows any exception in the building.
+	 * \note [New in MRPT 2.0.0]
+	 */
+	std::future<void> buildPyramidAsync(
+		const mrpt::img::CImage& img, const size_t nOctaves,
+		const bool smooth_halves = true, const bool convert_grayscale = false,
+		const bool compute_gradients = false,
+		mrpt::system::CWorkerThreadsPool* pool = nullptr);
+
+	/** Computes \a gradients_x and \a gradients_y for all the octaves, which
+	 * must be grayscale. Buffers are reused if the sizes did not change.
+	 * \note [New in MRPT 2.0.0]
+	 */
+	void computeGradients();
+
+	/** Gradients of an 8-bit grayscale image of size `w`x`h` with `stride`
+	 * bytes per row: `gx(y,x) = I(y,x+1)-I(y,x-1)`,
+	 * `gy(y,x) = I(y+1,x)-I(y-1,x)`, and 0 at the border pixels. `gx` and
+	 * `gy` are row-major arrays of `w`x`h` elements. Uses AVX2 or SSE2
+	 * instructions, if available.
+	 * \note [New in MRPT 2.0.0]
+	 */
+	static void imageGradients(
+		const uint8_t* img, const size_t w, const size_t h, const size_t stride,
+		int16_t* gx, int16_t* gy);
 
 	/** The individual images:
 	  *  - images[0]: 1st octave (full-size)
@@ -92,6 +147,16 @@ class CImagePyramid
 	  *  - images[2]: 3rd octave (1/4 size)
 	  */
 	std::vector<mrpt::img::CImage> images;
+
+	/** Gradients of an image (see \a imageGradients()), as a matrix with
+	 * one row per image row. */
+	using TGradientImage = Eigen::Matrix<
+		int16_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+
+	/** Horizontal and vertical gradients of each octave in \a images, only
+	 * if computed with \a computeGradients() (or the `compute_gradients`
+	 * argument of the build methods); empty otherwise. */
+	std::vector<TGradientImage> gradients_x, gradients_y;
 };
 }
 }
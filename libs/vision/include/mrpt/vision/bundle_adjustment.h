@@ -14,6 +14,7 @@
 #include <mrpt/img/TCamera.h>
 #include <mrpt/system/TParameters.h>
 #include <mrpt/math/lightweight_geom_data.h>
+#include <mrpt/math/robust_kernels.h>
 
 #include <array>
 #include <functional>
@@ -22,6 +23,10 @@
 // vision/src/ba_*.cpp
 namespace mrpt
 {
+namespace system
+{
+class CWorkerThreadsPool;
+}
 namespace vision
 {
 /** \defgroup bundle_adj Bundle-Adjustment methods
@@ -62,7 +67,10 @@ using TBundleAdjustmentFeedbackFunctor = std::function<void(
   *		- "max_iterations": Maximum number of iterations to run (default=50)
   *		- "robust_kernel": If !=0, use a robust kernel against outliers
   *(default=1)
-  *		- "kernel_param": The pseudo-huber kernel parameter (default=3)
+  *		- "kernel_param": The robust kernel parameter, in pixels (default=3)
+  *		- "robust_kernel_type": The robust kernel, as a value of
+  *mrpt::math::TRobustKernelType: 1=Pseudo-Huber, 2=Huber, 3=Cauchy
+  *(default=1)
   *		- "mu": Initial mu for LevMarq (default=-1 -> autoguess)
   *		- "num_fix_frames": Number of first frame poses to don't optimize (keep
   *unmodified as they come in)  (default=1: the first pose is the reference and
@@ -72,6 +80,18 @@ using TBundleAdjustmentFeedbackFunctor = std::function<void(
   *all)
   *		- "profiler": If !=0, displays profiling information to the console at
   *return.
+  *		- "num_threads": Number of threads for residuals, Jacobians, the
+  *Hessian blocks and the reduced camera system (default=1)
+  *
+  * The normal equations are solved with the Schur complement: landmarks are
+  *eliminated (their 3x3 Hessian blocks are inverted independently), the
+  *reduced camera system is built as a block-sparse matrix whose structure is
+  *computed once from the observations, and solved with a sparse Cholesky
+  *factorization. The cost of each iteration grows with the number of
+  *observations and of co-visible frame pairs, not with
+  *frames x landmarks. With robust kernels, the Hessian and gradient terms
+  *of each observation are weighted with the derivative of the kernel
+  *(IRLS). Results do not depend on "num_threads".
   *
   * \note In this function, all coordinates are absolute. Camera frames are such
   *that +Z points forward from the focal point (see the figure in
@@ -135,6 +155,10 @@ void ba_initial_estimate(
   *  See mrpt::vision::bundle_adj_full for a description of most parameters.
   * \param frame_poses_are_inverse If set to true, global camera poses are \f$
  * \ominus F \f$ instead of \f$ F \f$, for each F in frame_poses.
+  * \param kernel_type The robust kernel, if use_robust_kernel is true.
+  * \param pool If provided, observations are processed in parallel by the
+ * threads of this pool. The result does not depend on the number of
+ * threads.
   *
   *  \return Overall squared reprojection error.
   * \ingroup bundle_adj
@@ -147,7 +171,10 @@ double reprojectionResiduals(
 	std::vector<std::array<double, 2>>& out_residuals,
 	const bool frame_poses_are_inverse, const bool use_robust_kernel = true,
 	const double kernel_param = 3.0,
-	std::vector<double>* out_kernel_1st_deriv = nullptr);
+	std::vector<double>* out_kernel_1st_deriv = nullptr,
+	const mrpt::math::TRobustKernelType kernel_type =
+		mrpt::math::rkPseudoHuber,
+	mrpt::system::CWorkerThreadsPool* pool = nullptr);
 
 //! \overload
 double reprojectionResiduals(
@@ -158,7 +185,10 @@ double reprojectionResiduals(
 	std::vector<std::array<double, 2>>& out_residuals,
 	const bool frame_poses_are_inverse, const bool use_robust_kernel = true,
 	const double kernel_param = 3.0,
-	std::vector<double>* out_kernel_1st_deriv = nullptr);
+	std::vector<double>* out_kernel_1st_deriv = nullptr,
+	const mrpt::math::TRobustKernelType kernel_type =
+		mrpt::math::rkPseudoHuber,
+	mrpt::system::CWorkerThreadsPool* pool = nullptr);
 
 /** For each pose in the vector \a frame_poses, adds a "delta" increment to the
  * manifold, with the "delta" given in the se(3) Lie algebra:
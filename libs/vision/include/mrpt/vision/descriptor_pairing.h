@@ -11,6 +11,18 @@
 #define mrpt_vision_descriptor_pairing_H
 
 #include <mrpt/vision/types.h>
+#include <mrpt/vision/CFeature.h>
+#include <mrpt/vision/CDescriptorMatrix.h>
+#include <limits>
+#include <vector>
+
+namespace mrpt
+{
+namespace system
+{
+class CWorkerThreadsPool;
+}
+}  // namespace mrpt
 
 namespace mrpt
 {
@@ -153,6 +165,76 @@ size_t find_descriptor_pairings(
 	MRPT_END
 }
 
+/** One pairing found by match_descriptors_brute_force() */
+struct TDescriptorMatch
+{
+	/** Indices of the descriptors in the first and second matrices */
+	std::size_t idx1{0}, idx2{0};
+	/** Hamming (binary descriptors) or Euclidean distance */
+	float distance{0};
+};
+
+/** Options for match_descriptors_brute_force() */
+struct TBruteForceMatchingOptions
+{
+	/** Pairings with a larger distance are discarded (Hamming or Euclidean
+	 * distance, see CDescriptorMatrix) */
+	float max_distance{std::numeric_limits<float>::max()};
+	/** If >0, Lowe's ratio test: a pairing is discarded unless its distance
+	 * is below `ratio` times the distance to the second best candidate, e.g.
+	 * 0.8. */
+	float ratio{0};
+	/** If true, only keep pairings (i,j) where `i` is also the best match of
+	 * `j` in the first matrix. */
+	bool cross_check{false};
+};
+
+/** Finds, for each descriptor in `desc1`, the closest one in `desc2`
+ * (exhaustive search), then filters pairings according to `opts`.
+ *
+ * Both matrices must have the same type and length of descriptors. Distances
+ * are computed with SIMD kernels (see CDescriptorMatrix), over tiles of
+ * `desc2` rows so they stay in cache, and rows of `desc1` are split among
+ * the threads of `pool`, if provided. The result does not depend on the
+ * number of threads; in case of ties, the lowest index wins.
+ *
+ * \param[out] matches The pairings, sorted by `idx1`.
+ * \return The number of pairings.
+ * \note [New in MRPT 2.0.0]
+ * \sa match_features_brute_force, CDescriptorMatrix
+ */
+std::size_t match_descriptors_brute_force(
+	const CDescriptorMatrix& desc1, const CDescriptorMatrix& desc2,
+	std::vector<TDescriptorMatch>& matches,
+	const TBruteForceMatchingOptions& opts = TBruteForceMatchingOptions(),
+	mrpt::system::CWorkerThreadsPool* pool = nullptr);
+
+/** Convenience version of match_descriptors_brute_force() for two lists of
+ * features, using their descriptors of type `descriptor` (one of descORB,
+ * descLATCH, descBLD, descSIFT or descSURF).
+ *
+ * \code
+ *  CFeatureList feats1, feats2;
+ *  // Populate feature lists with ORB features [...]
+ *  mrpt::vision::TBruteForceMatchingOptions opts;
+ *  opts.max_distance = 64;
+ *  opts.cross_check = true;
+ *  CMatchedFeatureList matches;
+ *  mrpt::vision::match_features_brute_force(
+ *     feats1, feats2, matches, mrpt::vision::descORB, opts);
+ * \endcode
+ *
+ * \param[out] matches The pairings, in the order of `list1`.
+ * \return The number of pairings.
+ * \note [New in MRPT 2.0.0]
+ * \sa matchFeatures
+ */
+std::size_t match_features_brute_force(
+	const CFeatureList& list1, const CFeatureList& list2,
+	CMatchedFeatureList& matches, const TDescriptorType descriptor,
+	const TBruteForceMatchingOptions& opts = TBruteForceMatchingOptions(),
+	mrpt::system::CWorkerThreadsPool* pool = nullptr);
+
 /** @} */
 }  // namespace vision
 }  // namespace mrpt
@@ -343,6 +343,10 @@ struct CFeatureTracker_KL : public CGenericFeatureTracker
 	void trackFeatures_impl_templ(
 		const mrpt::img::CImage& old_img, const mrpt::img::CImage& new_img,
 		FEATLIST& inout_featureList);
+
+	/** Pyramid buffers for cvCalcOpticalFlowPyrLK(), kept between calls to
+	 * avoid reallocating them for each frame. */
+	mrpt::img::CImage m_prev_pyr, m_cur_pyr;
 };
 
 /** Search for correspondences which are not in the same row and deletes them
@@ -0,0 +1,302 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "vision-precomp.h"  // Precompiled headers
+
+#include <mrpt/vision/CDescriptorMatrix.h>
+#include <mrpt/vision/CFeature.h>
+#include <mrpt/core/exceptions.h>
+#include <mrpt/core/format.h>
+#include <cmath>
+#include <cstring>  // memcpy
+
+#if MRPT_HAS_SSE2
+#include <mrpt/core/SSE_types.h>
+#endif
+#if MRPT_HAS_AVX2
+#include <immintrin.h>
+#endif
+#if defined(_MSC_VER) && defined(_M_X64) && MRPT_HAS_SSE4_2
+#include <intrin.h>  // __popcnt64()
+#endif
+
+using namespace mrpt::vision;
+
+namespace
+{
+inline uint64_t popcount64(uint64_t x)
+{
+#if defined(_MSC_VER) && defined(_M_X64) && MRPT_HAS_SSE4_2
+	return __popcnt64(x);
+#elif defined(__GNUC__)
+	// POPCNT instruction if enabled (e.g. -msse4.2), an optimized call
+	// otherwise:
+	return static_cast<uint64_t>(__builtin_popcountll(x));
+#else
+	x = x - ((x >> 1) & 0x5555555555555555ULL);
+	x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+	x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+	return (x * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+/** Length of the descriptor `desc` of a feature (0 if it has none) */
+std::size_t featureDescriptorLength(
+	const CFeature& f, const TDescriptorType desc)
+{
+	switch (desc)
+	{
+		case descORB:
+			return f.descriptors.ORB.size();
+		case descLATCH:
+			return f.descriptors.LATCH.size();
+		case descBLD:
+			return f.descriptors.BLD.size();
+		case descSIFT:
+			return f.descriptors.SIFT.size();
+		case descSURF:
+			return f.descriptors.SURF.size();
+		default:
+			return 0;
+	}
+}
+
+inline uint32_t hamming(const uint8_t* a, const uint8_t* b, std::size_t n)
+{
+	std::size_t i = 0;
+	uint64_t count = 0;
+#if MRPT_HAS_AVX2
+	if (n >= 32)
+	{
+		// Bit count of each nibble with a lookup table, then horizontal sums
+		// of bytes with SAD (W. Mula's method):
+		const __m256i lut = _mm256_setr_epi8(
+			0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2,
+			3, 1, 2, 2, 3, 2, 3, 3, 4);
+		const __m256i low_mask = _mm256_set1_epi8(0x0f);
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i acc = zero;
+		for (; i + 32 <= n; i += 32)
+		{
+			const __m256i x = _mm256_xor_si256(
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+				_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+			const __m256i lo = _mm256_and_si256(x, low_mask);
+			const __m256i hi =
+				_mm256_and_si256(_mm256_srli_epi16(x, 4), low_mask);
+			const __m256i cnt = _mm256_add_epi8(
+				_mm256_shuffle_epi8(lut, lo), _mm256_shuffle_epi8(lut, hi));
+			acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, zero));
+		}
+		count = static_cast<uint64_t>(_mm256_extract_epi64(acc, 0)) +
+				static_cast<uint64_t>(_mm256_extract_epi64(acc, 1)) +
+				static_cast<uint64_t>(_mm256_extract_epi64(acc, 2)) +
+				static_cast<uint64_t>(_mm256_extract_epi64(acc, 3));
+	}
+#endif
+	for (; i + 8 <= n; i += 8)
+	{
+		uint64_t x, y;
+		std::memcpy(&x, a + i, sizeof(x));
+		std::memcpy(&y, b + i, sizeof(y));
+		count += popcount64(x ^ y);
+	}
+	for (; i < n; i++) count += popcount64(a[i] ^ b[i]);
+	return static_cast<uint32_t>(count);
+}
+
+inline float squaredL2(const float* a, const float* b, std::size_t n)
+{
+	std::size_t i = 0;
+	float sum = 0;
+#if MRPT_HAS_AVX2
+	__m256 acc = _mm256_setzero_ps();
+	for (; i + 8 <= n; i += 8)
+	{
+		const __m256 d =
+			_mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+		acc = _mm256_add_ps(acc, _mm256_mul_ps(d, d));
+	}
+	__m128 s = _mm_add_ps(
+		_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+	s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+	s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+	sum = _mm_cvtss_f32(s);
+#elif MRPT_HAS_SSE2
+	__m128 acc = _mm_setzero_ps();
+	for (; i + 4 <= n; i += 4)
+	{
+		const __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+		acc = _mm_add_ps(acc, _mm_mul_ps(d, d));
+	}
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+	sum = _mm_cvtss_f32(acc);
+#endif
+	for (; i < n; i++)
+	{
+		const float d = a[i] - b[i];
+		sum += d * d;
+	}
+	return sum;
+}
+}  // namespace
+
+void CDescriptorMatrix::clear()
+{
+	m_data.clear();
+	m_rows = m_length = m_stride = 0;
+	m_type = descAny;
+	m_binary = false;
+}
+
+void CDescriptorMatrix::setFromFeatures(
+	const CFeatureList& feats, TDescriptorType desc)
+{
+	MRPT_START
+
+	clear();
+
+	bool binary = false;
+	switch (desc)
+	{
+		case descORB:
+		case descLATCH:
+		case descBLD:
+			binary = true;
+			break;
+		case descSIFT:
+		case descSURF:
+			binary = false;
+			break;
+		default:
+			THROW_EXCEPTION(
+				"Unsupported descriptor type: only ORB, LATCH, BLD, SIFT and "
+				"SURF are supported.");
+	}
+
+	const std::size_t N = feats.size();
+	const std::size_t len = N ? featureDescriptorLength(*feats[0], desc) : 0;
+	for (std::size_t i = 0; i < N; i++)
+	{
+		const std::size_t len_i = featureDescriptorLength(*feats[i], desc);
+		if (len_i == 0 || len_i != len)
+			THROW_EXCEPTION(
+				mrpt::format(
+					"Feature #%u has no descriptor of the requested type, or "
+					"its length (%u) differs from that of the first feature "
+					"(%u).",
+					static_cast<unsigned int>(i),
+					static_cast<unsigned int>(len_i),
+					static_cast<unsigned int>(len)));
+	}
+
+	m_type = desc;
+	m_binary = binary;
+	m_rows = N;
+	m_length = len;
+	// Pad rows up to a multiple of 32 bytes (one AVX register):
+	const std::size_t row_bytes = len * (binary ? 1 : sizeof(float));
+	m_stride = ((row_bytes + 31) / 32) * 32;
+	m_data.assign(m_rows * m_stride, 0);
+
+	for (std::size_t i = 0; i < N; i++)
+	{
+		const auto& d = feats[i]->descriptors;
+		uint8_t* row = &m_data[i * m_stride];
+		switch (desc)
+		{
+			case descORB:
+				std::memcpy(row, d.ORB.data(), len);
+				break;
+			case descLATCH:
+				std::memcpy(row, d.LATCH.data(), len);
+				break;
+			case descBLD:
+				std::memcpy(row, d.BLD.data(), len);
+				break;
+			case descSURF:
+				std::memcpy(row, d.SURF.data(), len * sizeof(float));
+				break;
+			case descSIFT:
+			{
+				float* frow = reinterpret_cast<float*>(row);
+				for (std::size_t k = 0; k < len; k++)
+					frow[k] = static_cast<float>(d.SIFT[k]);
+			}
+			break;
+			default:
+				break;
+		}
+	}
+
+	MRPT_END
+}
+
+float CDescriptorMatrix::distance(
+	std::size_t i, const CDescriptorMatrix& o, std::size_t j) const
+{
+	ASSERTDEB_(m_type == o.m_type && m_length == o.m_length);
+	ASSERTDEB_(i < m_rows && j < o.m_rows);
+	if (m_binary)
+		return static_cast<float>(
+			hamming(binaryRow(i), o.binaryRow(j), m_stride));
+	else
+		return std::sqrt(
+			squaredL2(floatRow(i), o.floatRow(j), m_stride / sizeof(float)));
+}
+
+uint32_t CDescriptorMatrix::hammingDistance(
+	const uint8_t* a, const uint8_t* b, std::size_t n)
+{
+	return hamming(a, b, n);
+}
+
+float CDescriptorMatrix::squaredL2Distance(
+	const float* a, const float* b, std::size_t n)
+{
+	return squaredL2(a, b, n);
+}
+
+void CDescriptorMatrix::rawDistances(
+	std::size_t i, const CDescriptorMatrix& o, std::size_t j0, std::size_t j1,
+	float* out) const
+{
+	ASSERTDEB_(m_type == o.m_type && m_length == o.m_length);
+	ASSERTDEB_(i < m_rows && j0 <= j1 && j1 <= o.m_rows);
+	if (m_binary)
+	{
+		const uint8_t* a = binaryRow(i);
+		const uint8_t* b = o.binaryRow(j0);
+		// Constant lengths for the most common descriptors (e.g. ORB: 32
+		// bytes), so the kernel is fully unrolled:
+		switch (m_stride)
+		{
+			case 32:
+				for (std::size_t j = j0; j < j1; j++, b += 32)
+					*out++ = static_cast<float>(hamming(a, b, 32));
+				break;
+			case 64:
+				for (std::size_t j = j0; j < j1; j++, b += 64)
+					*out++ = static_cast<float>(hamming(a, b, 64));
+				break;
+			default:
+				for (std::size_t j = j0; j < j1; j++, b += m_stride)
+					*out++ = static_cast<float>(hamming(a, b, m_stride));
+				break;
+		}
+	}
+	else
+	{
+		const float* a = floatRow(i);
+		const std::size_t n = m_stride / sizeof(float);
+		for (std::size_t j = j0; j < j1; j++)
+			*out++ = squaredL2(a, o.floatRow(j), n);
+	}
+}
@@ -15,6 +15,7 @@
 #include <mrpt/io/CFileInputStream.h>
 #include <mrpt/serialization/stl_serialization.h>
 #include <mrpt/vision/CFeature.h>
+#include <mrpt/vision/CDescriptorMatrix.h>
 #include <mrpt/vision/types.h>
 #include <mrpt/serialization/stl_serialization.h>
 #include <mrpt/math/data_utils.h>
@@ -853,19 +854,9 @@ uint8_t CFeature::descriptorORBDistanceTo(const CFeature& oFeature) const
 	const std::vector<uint8_t>& o_desc = oFeature.descriptors.ORB;
 
 	// Descriptors XOR + Hamming weight
-	uint8_t distance = 0;
-	for (uint8_t k = 0; k < t_desc.size(); ++k)
-	{
-		uint8_t x_or = t_desc[k] ^ o_desc[k];
-		uint8_t count;  // from : Wegner, Peter (1960), "A technique for
-		// counting ones in a binary computer", Communications
-		// of the ACM 3 (5): 322, doi:10.1145/367236.367286
-		for (count = 0; x_or; count++)  // ...
-			x_or &= x_or - 1;  // ...
-		distance += count;
-	}
-
-	return float(distance);
+	return static_cast<uint8_t>(
+		CDescriptorMatrix::hammingDistance(
+			t_desc.data(), o_desc.data(), t_desc.size()));
 }  // end-descriptorORBDistanceTo
 
 // # added by Raghavender Sahdev
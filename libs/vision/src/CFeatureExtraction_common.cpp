@@ -39,6 +39,25 @@ void CFeatureExtraction::detectFeatures(
 	const CImage& img, CFeatureList& feats, const unsigned int init_ID,
 	const unsigned int nDesiredFeatures, const TImageROI& ROI) const
 {
+	if (options.tilingOptions.enable)
+	{
+		switch (options.featsType)
+		{
+			case featFAST:
+			case featFASTER9:
+			case featFASTER10:
+			case featFASTER12:
+			case featORB:
+			case featHarris:
+			case featKLT:
+				extractFeaturesTiled(
+					img, feats, init_ID, nDesiredFeatures, ROI);
+				return;
+			default:
+				break;
+		}
+	}
+
 	switch (options.featsType)
 	{
 		case featHarris:
@@ -472,6 +491,13 @@ void CFeatureExtraction::TOptions::dumpToTextStream(std::ostream& out) const
 	LOADABLEOPTS_DUMP_VAR(LATCHOptions.half_ssd_size, int)
 	LOADABLEOPTS_DUMP_VAR(LATCHOptions.rotationInvariance, bool)
 
+	LOADABLEOPTS_DUMP_VAR(tilingOptions.enable, bool)
+	LOADABLEOPTS_DUMP_VAR(tilingOptions.cells_x, int)
+	LOADABLEOPTS_DUMP_VAR(tilingOptions.cells_y, int)
+	LOADABLEOPTS_DUMP_VAR(tilingOptions.max_features_per_cell, int)
+	LOADABLEOPTS_DUMP_VAR(tilingOptions.cell_margin, int)
+	LOADABLEOPTS_DUMP_VAR(tilingOptions.min_distance, float)
+
 	out << mrpt::format("\n");
 }
 
@@ -560,4 +586,12 @@ void CFeatureExtraction::TOptions::loadFromConfigFile(
 	MRPT_LOAD_CONFIG_VAR(LATCHOptions.half_ssd_size, int, iniFile, section)
 	MRPT_LOAD_CONFIG_VAR(
 		LATCHOptions.rotationInvariance, bool, iniFile, section)
+
+	MRPT_LOAD_CONFIG_VAR(tilingOptions.enable, bool, iniFile, section)
+	MRPT_LOAD_CONFIG_VAR(tilingOptions.cells_x, int, iniFile, section)
+	MRPT_LOAD_CONFIG_VAR(tilingOptions.cells_y, int, iniFile, section)
+	MRPT_LOAD_CONFIG_VAR(
+		tilingOptions.max_features_per_cell, int, iniFile, section)
+	MRPT_LOAD_CONFIG_VAR(tilingOptions.cell_margin, int, iniFile, section)
+	MRPT_LOAD_CONFIG_VAR(tilingOptions.min_distance, float, iniFile, section)
 }
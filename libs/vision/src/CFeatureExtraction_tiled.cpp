@@ -0,0 +1,264 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "vision-precomp.h"  // Precompiled headers
+
+#include <mrpt/vision/CFeatureExtraction.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <algorithm>
+#include <cmath>
+
+using namespace mrpt;
+using namespace mrpt::vision;
+using namespace mrpt::img;
+using namespace std;
+
+namespace
+{
+bool responseGreater(const CFeature::Ptr& a, const CFeature::Ptr& b)
+{
+	return a->response > b->response;
+}
+}  // namespace
+
+/************************************************************************************************
+*								extractFeaturesTiled
+************************************************************************************************/
+void CFeatureExtraction::extractFeaturesTiled(
+	const mrpt::img::CImage& inImg, CFeatureList& feats,
+	unsigned int init_ID, unsigned int nDesiredFeatures,
+	const TImageROI& ROI) const
+{
+	MRPT_START
+
+	// Convert to gray-scale (and load delayed-load images) only once. All
+	// cells are taken from this image, from any thread:
+	const CImage gray(inImg, FAST_REF_OR_CONVERT_TO_GRAY);
+	const int W = static_cast<int>(gray.getWidth());
+	const int H = static_cast<int>(gray.getHeight());
+
+	// Detector options in each cell:
+	CFeatureExtraction cellFext;
+	cellFext.options = options;
+	cellFext.options.tilingOptions.enable = false;
+	cellFext.options.harrisOptions.tile_image = false;
+	cellFext.options.KLTOptions.tile_image = false;
+	cellFext.options.addNewFeatures = false;
+
+	// Default margin and minimum distance for each detector:
+	float min_dist = 0;
+	int margin = static_cast<int>(options.patchSize / 2 + 1);
+	bool detector_has_response = true;
+	switch (options.featsType)
+	{
+		case featFAST:
+			min_dist = options.FASTOptions.min_distance;
+			margin = std::max(margin, 4);
+			break;
+		case featFASTER9:
+		case featFASTER10:
+		case featFASTER12:
+			min_dist = options.FASTOptions.min_distance;
+			margin = std::max(margin, 4);
+			// Needed to rank the features of each cell:
+			cellFext.options.FASTOptions.use_KLT_response = true;
+			break;
+		case featORB:
+		{
+			min_dist = static_cast<float>(options.ORBOptions.min_distance);
+			// OpenCV's ORB ignores keypoints closer than 31 pixels to the
+			// image border, at each pyramid level:
+			const double max_scale = std::pow(
+				options.ORBOptions.scale_factor,
+				static_cast<double>(options.ORBOptions.n_levels) - 1);
+			margin = std::max(
+				margin, static_cast<int>(std::ceil(31 * max_scale)));
+		}
+		break;
+		case featHarris:
+			min_dist = options.harrisOptions.min_distance;
+			margin = std::max(
+				margin,
+				options.harrisOptions.radius +
+					static_cast<int>(options.harrisOptions.min_distance));
+			detector_has_response = false;
+			break;
+		case featKLT:
+			min_dist = options.KLTOptions.min_distance;
+			margin = std::max(
+				margin, options.KLTOptions.radius +
+							static_cast<int>(options.KLTOptions.min_distance));
+			detector_has_response = false;
+			break;
+		default:
+			THROW_EXCEPTION(
+				"Tiled extraction is only implemented for FAST, FASTER, ORB, "
+				"Harris and KLT features");
+	}
+
+	auto cellDetector = [&](int px0, int py0, int px1, int py1,
+							CFeatureList& out) {
+		CImage cellImg;
+		gray.extract_patch(cellImg, px0, py0, px1 - px0, py1 - py0);
+		cellFext.detectFeatures(cellImg, out);
+		for (auto& f : out)
+		{
+			f->x += px0;
+			f->y += py0;
+			if (!detector_has_response)
+			{
+				const int ix = static_cast<int>(f->x + 0.5f);
+				const int iy = static_cast<int>(f->y + 0.5f);
+				const int KLT_half_win = 4;
+				f->response = (ix > KLT_half_win && iy > KLT_half_win &&
+							   ix < W - 1 - KLT_half_win &&
+							   iy < H - 1 - KLT_half_win)
+								  ? gray.KLT_response(ix, iy, KLT_half_win)
+								  : -100;
+			}
+		}
+	};
+
+	if (!options.addNewFeatures) feats.clear();
+	detectFeaturesTiled(
+		options.tilingOptions, cellDetector, W, H, feats, init_ID,
+		nDesiredFeatures, ROI, margin, min_dist);
+
+	MRPT_END
+}
+
+/************************************************************************************************
+*								detectFeaturesTiled
+************************************************************************************************/
+void CFeatureExtraction::detectFeaturesTiled(
+	const TOptions::TTilingOptions& to, const TCellDetector& detector,
+	const unsigned int imgW, const unsigned int imgH, CFeatureList& feats,
+	unsigned int init_ID, unsigned int nDesiredFeatures, const TImageROI& ROI,
+	int default_margin, float default_min_dist)
+{
+	MRPT_START
+
+	ASSERT_(to.cells_x > 0 && to.cells_y > 0);
+	ASSERT_(detector);
+	const int W = static_cast<int>(imgW);
+	const int H = static_cast<int>(imgH);
+
+	// Region to split into cells: the ROI, if any, or the whole image:
+	int x0 = 0, y0 = 0, x1 = W, y1 = H;
+	if (!(ROI.xMax == 0 && ROI.xMin == 0 && ROI.yMax == 0 && ROI.yMin == 0))
+	{
+		x0 = std::max(0, static_cast<int>(ROI.xMin));
+		y0 = std::max(0, static_cast<int>(ROI.yMin));
+		x1 = std::min(W, static_cast<int>(ROI.xMax) + 1);
+		y1 = std::min(H, static_cast<int>(ROI.yMax) + 1);
+	}
+
+	const int margin = (to.cell_margin > 0) ? static_cast<int>(to.cell_margin)
+											: std::max(0, default_margin);
+	const float min_dist =
+		(to.min_distance > 0) ? to.min_distance : default_min_dist;
+
+	const unsigned int nCells = to.cells_x * to.cells_y;
+	unsigned int cell_budget = to.max_features_per_cell;
+	if (!cell_budget && nDesiredFeatures)
+		cell_budget = (nDesiredFeatures + nCells - 1) / nCells;
+
+	// Detect in each cell independently:
+	std::vector<std::vector<CFeature::Ptr>> cellFeats(nCells);
+	auto processCells = [&](std::size_t c0, std::size_t c1) {
+		for (std::size_t c = c0; c < c1; c++)
+		{
+			const int cx = static_cast<int>(c % to.cells_x);
+			const int cy = static_cast<int>(c / to.cells_x);
+			// Cell limits [cx0,cx1)x[cy0,cy1), and with margins:
+			const int ncx = static_cast<int>(to.cells_x);
+			const int ncy = static_cast<int>(to.cells_y);
+			const int cx0 = x0 + (x1 - x0) * cx / ncx;
+			const int cx1 = x0 + (x1 - x0) * (cx + 1) / ncx;
+			const int cy0 = y0 + (y1 - y0) * cy / ncy;
+			const int cy1 = y0 + (y1 - y0) * (cy + 1) / ncy;
+			if (cx1 <= cx0 || cy1 <= cy0) continue;
+			const int px0 = std::max(0, cx0 - margin);
+			const int py0 = std::max(0, cy0 - margin);
+			const int px1 = std::min(W, cx1 + margin);
+			const int py1 = std::min(H, cy1 + margin);
+
+			CFeatureList lst;
+			detector(px0, py0, px1, py1, lst);
+
+			auto& out = cellFeats[c];
+			out.reserve(lst.size());
+			for (auto& f : lst)
+			{
+				// Features in the margins belong to the neighboring cells:
+				if (f->x < cx0 || f->x >= cx1 || f->y < cy0 || f->y >= cy1)
+					continue;
+				out.push_back(f);
+			}
+			std::stable_sort(out.begin(), out.end(), responseGreater);
+			if (cell_budget && out.size() > cell_budget)
+				out.resize(cell_budget);
+		}
+	};
+	if (to.threadPool)
+		to.threadPool->parallel_for(nCells, processCells);
+	else
+		processCells(0, nCells);
+
+	// Merge, with a non-maximum suppression across cell borders:
+	std::vector<CFeature::Ptr> all;
+	for (auto& cf : cellFeats) all.insert(all.end(), cf.begin(), cf.end());
+	std::stable_sort(all.begin(), all.end(), responseGreater);
+
+	const std::size_t nMax = (nDesiredFeatures != 0) ? nDesiredFeatures
+													 : all.size();
+	std::size_t nAdded = 0;
+
+	// Accepted features are stored in a grid of buckets of size min_dist, so
+	// only the 3x3 neighboring buckets must be checked for each candidate:
+	const bool do_nms = min_dist > 0;
+	const float bucket_size = do_nms ? min_dist : 1;
+	const int grid_lx = do_nms ? static_cast<int>(W / bucket_size) + 1 : 1;
+	const int grid_ly = do_nms ? static_cast<int>(H / bucket_size) + 1 : 1;
+	std::vector<std::vector<CFeature*>> grid(grid_lx * grid_ly);
+	const float min_dist2 = min_dist * min_dist;
+
+	for (const auto& f : all)
+	{
+		if (nAdded >= nMax) break;
+		if (do_nms)
+		{
+			const int bx = std::min(
+				grid_lx - 1,
+				std::max(0, static_cast<int>(f->x / bucket_size)));
+			const int by = std::min(
+				grid_ly - 1,
+				std::max(0, static_cast<int>(f->y / bucket_size)));
+			bool too_close = false;
+			for (int iy = std::max(0, by - 1);
+				 !too_close && iy <= std::min(grid_ly - 1, by + 1); iy++)
+				for (int ix = std::max(0, bx - 1);
+					 !too_close && ix <= std::min(grid_lx - 1, bx + 1); ix++)
+					for (const CFeature* o : grid[iy * grid_lx + ix])
+						if (square(o->x - f->x) + square(o->y - f->y) <
+							min_dist2)
+						{
+							too_close = true;
+							break;
+						}
+			if (too_close) continue;
+			grid[by * grid_lx + bx].push_back(f.get());
+		}
+		f->ID = init_ID + static_cast<TFeatureID>(nAdded);
+		feats.push_back(f);
+		nAdded++;
+	}
+
+	MRPT_END
+}
@@ -0,0 +1,263 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/CFeatureExtraction.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/config/CConfigFileMemory.h>
+#include <mrpt/core/bits_math.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <set>
+
+using namespace mrpt::vision;
+
+namespace
+{
+// A fake detector for the tiled extraction: a feature every 2 pixels, each
+// with a distinct response which only depends on its location, so the same
+// feature gets the same response when detected from overlapping cells.
+const unsigned int fakeW = 320, fakeH = 240;
+float fakeResponse(int x, int y)
+{
+	// Multiplying by an odd number is a bijection modulo 2^17 > W*H:
+	return static_cast<float>(((y * fakeW + x) * 40503u) & 131071u);
+}
+struct FakeDetector
+{
+	std::mutex cs;
+	std::set<std::array<int, 4>> regions;
+
+	void operator()(int x0, int y0, int x1, int y1, CFeatureList& out)
+	{
+		{
+			std::lock_guard<std::mutex> lock(cs);
+			regions.insert({{x0, y0, x1, y1}});
+		}
+		for (int y = y0 + (y0 % 2); y < y1; y += 2)
+			for (int x = x0 + (x0 % 2); x < x1; x += 2)
+			{
+				auto f = CFeature::Create();
+				f->x = x;
+				f->y = y;
+				f->response = fakeResponse(x, y);
+				out.push_back(f);
+			}
+	}
+};
+}  // namespace
+
+TEST(CFeatureExtraction, detectFeaturesTiled_cellBudgetAndMargins)
+{
+	FakeDetector det;
+	auto detFn = [&det](int x0, int y0, int x1, int y1, CFeatureList& out) {
+		det(x0, y0, x1, y1, out);
+	};
+
+	CFeatureExtraction::TOptions::TTilingOptions to;
+	to.cells_x = 4;
+	to.cells_y = 3;
+	// No non-maximum suppression; the margin comes from the default:
+	const int margin = 10;
+	const unsigned int nDesired = 120, init_ID = 1000;
+	CFeatureList feats;
+	CFeatureExtraction::detectFeaturesTiled(
+		to, detFn, fakeW, fakeH, feats, init_ID, nDesired, TImageROI(),
+		margin);
+
+	// Each 80x80 cell, extended with the margins (clipped to the image):
+	std::set<std::array<int, 4>> expectedRegions;
+	for (int cy = 0; cy < 3; cy++)
+		for (int cx = 0; cx < 4; cx++)
+			expectedRegions.insert(
+				{{std::max(0, cx * 80 - margin), std::max(0, cy * 80 - margin),
+				  std::min<int>(fakeW, (cx + 1) * 80 + margin),
+				  std::min<int>(fakeH, (cy + 1) * 80 + margin)}});
+	EXPECT_EQ(det.regions, expectedRegions);
+
+	// The budget of each cell (nDesired/12) are its features with the
+	// highest responses, without those detected in the margins:
+	ASSERT_EQ(feats.size(), nDesired);
+	std::vector<std::vector<float>> perCell(12);
+	for (std::size_t i = 0; i < feats.size(); i++)
+	{
+		const auto& f = *feats[i];
+		EXPECT_EQ(f.ID, init_ID + i);
+		if (i > 0)
+		{
+			EXPECT_LE(f.response, feats[i - 1]->response);
+		}
+		perCell[static_cast<int>(f.y / 80) * 4 + static_cast<int>(f.x / 80)]
+			.push_back(f.response);
+	}
+	for (int c = 0; c < 12; c++)
+	{
+		std::vector<float> expected;
+		for (int y = (c / 4) * 80; y < (c / 4 + 1) * 80; y += 2)
+			for (int x = (c % 4) * 80; x < (c % 4 + 1) * 80; x += 2)
+				expected.push_back(fakeResponse(x, y));
+		std::sort(expected.rbegin(), expected.rend());
+		expected.resize(nDesired / 12);
+		EXPECT_EQ(perCell[c], expected) << "cell #" << c;
+	}
+
+	// max_features_per_cell overrides the budget from nDesired:
+	to.max_features_per_cell = 3;
+	feats.clear();
+	CFeatureExtraction::detectFeaturesTiled(
+		to, detFn, fakeW, fakeH, feats, 0, nDesired, TImageROI(), margin);
+	EXPECT_EQ(feats.size(), 3u * 12);
+}
+
+TEST(CFeatureExtraction, detectFeaturesTiled_NMS)
+{
+	FakeDetector det;
+	auto detFn = [&det](int x0, int y0, int x1, int y1, CFeatureList& out) {
+		det(x0, y0, x1, y1, out);
+	};
+
+	CFeatureExtraction::TOptions::TTilingOptions to;
+	to.cells_x = 3;
+	to.cells_y = 2;
+	to.cell_margin = 3;  // Overrides the default margin
+	to.min_distance = 5;  // Overrides the default distance
+	const TImageROI ROI(50, 169, 40, 119);  // 120x80 pixels
+	CFeatureList feats;
+	CFeatureExtraction::detectFeaturesTiled(
+		to, detFn, fakeW, fakeH, feats, 0, 0, ROI, 20 /*margin*/,
+		50 /*min_dist*/);
+
+	std::set<std::array<int, 4>> expectedRegions;
+	for (int cy = 0; cy < 2; cy++)
+		for (int cx = 0; cx < 3; cx++)
+			expectedRegions.insert(
+				{{50 + cx * 40 - 3, 40 + cy * 40 - 3, 50 + (cx + 1) * 40 + 3,
+				  40 + (cy + 1) * 40 + 3}});
+	EXPECT_EQ(det.regions, expectedRegions);
+
+	// All features in the ROI, far enough from each other, and any other
+	// feature in the ROI is too close to a better one (greedy NMS):
+	ASSERT_GT(feats.size(), 0u);
+	for (std::size_t i = 0; i < feats.size(); i++)
+	{
+		const auto& f = *feats[i];
+		EXPECT_TRUE(f.x >= 50 && f.x < 170 && f.y >= 40 && f.y < 120);
+		for (std::size_t j = 0; j < i; j++)
+			EXPECT_GE(
+				mrpt::square(f.x - feats[j]->x) +
+					mrpt::square(f.y - feats[j]->y),
+				25.0f);
+	}
+	for (int y = 40; y < 120; y += 2)
+		for (int x = 50; x < 170; x += 2)
+		{
+			bool accepted_or_suppressed = false;
+			for (std::size_t i = 0; i < feats.size(); i++)
+				if (feats[i]->response >= fakeResponse(x, y) &&
+					mrpt::square(feats[i]->x - x) +
+							mrpt::square(feats[i]->y - y) <
+						25.0f)
+					accepted_or_suppressed = true;
+			EXPECT_TRUE(accepted_or_suppressed) << "x=" << x << " y=" << y;
+		}
+
+	// Same result with threads:
+	mrpt::system::CWorkerThreadsPool pool(3);
+	to.threadPool = &pool;
+	CFeatureList feats_mt;
+	CFeatureExtraction::detectFeaturesTiled(
+		to, detFn, fakeW, fakeH, feats_mt, 0, 0, ROI, 20, 50);
+	ASSERT_EQ(feats.size(), feats_mt.size());
+	for (std::size_t i = 0; i < feats.size(); i++)
+	{
+		EXPECT_EQ(feats[i]->x, feats_mt[i]->x);
+		EXPECT_EQ(feats[i]->y, feats_mt[i]->y);
+	}
+}
+
+TEST(CFeatureExtraction, tilingOptionsLoadFromConfig)
+{
+	mrpt::config::CConfigFileMemory cfg;
+	cfg.write("fext", "tilingOptions.enable", true);
+	cfg.write("fext", "tilingOptions.cells_x", 6);
+	cfg.write("fext", "tilingOptions.cells_y", 3);
+	cfg.write("fext", "tilingOptions.max_features_per_cell", 20);
+	cfg.write("fext", "tilingOptions.min_distance", 7.5);
+
+	CFeatureExtraction::TOptions opts;
+	EXPECT_FALSE(opts.tilingOptions.enable);
+	opts.loadFromConfigFile(cfg, "fext");
+	EXPECT_TRUE(opts.tilingOptions.enable);
+	EXPECT_EQ(opts.tilingOptions.cells_x, 6u);
+	EXPECT_EQ(opts.tilingOptions.cells_y, 3u);
+	EXPECT_EQ(opts.tilingOptions.max_features_per_cell, 20u);
+	EXPECT_EQ(opts.tilingOptions.cell_margin, 0u);
+	EXPECT_FLOAT_EQ(opts.tilingOptions.min_distance, 7.5f);
+}
+
+#if MRPT_HAS_OPENCV
+
+TEST(CFeatureExtraction, tiledFASTER)
+{
+	// A grid of squares: corners everywhere in the image.
+	mrpt::img::CImage img(320, 240, CH_GRAY);
+	img.filledRectangle(0, 0, 319, 239, mrpt::img::TColor(0, 0, 0));
+	for (int y = 5; y < 230; y += 20)
+		for (int x = 5; x < 310; x += 20)
+			img.filledRectangle(
+				x, y, x + 9, y + 9, mrpt::img::TColor(255, 255, 255));
+
+	CFeatureExtraction fext;
+	fext.options.featsType = featFASTER9;
+	fext.options.FASTOptions.threshold = 40;
+	fext.options.tilingOptions.enable = true;
+	fext.options.tilingOptions.cells_x = 4;
+	fext.options.tilingOptions.cells_y = 3;
+	fext.options.tilingOptions.min_distance = 5;
+
+	const unsigned int nDesired = 120;
+	CFeatureList feats;
+	fext.detectFeatures(img, feats, 0, nDesired);
+	ASSERT_GT(feats.size(), 0u);
+	EXPECT_LE(feats.size(), nDesired);
+
+	// Features are spread over all cells, and far enough from each other:
+	std::vector<unsigned int> perCell(12, 0);
+	for (std::size_t i = 0; i < feats.size(); i++)
+	{
+		const auto& f = *feats[i];
+		EXPECT_EQ(f.ID, i);
+		perCell[static_cast<int>(f.y / 80) * 4 + static_cast<int>(f.x / 80)]++;
+		for (std::size_t j = 0; j < i; j++)
+			EXPECT_GE(
+				mrpt::square(f.x - feats[j]->x) +
+					mrpt::square(f.y - feats[j]->y),
+				25.0f);
+	}
+	for (auto n : perCell)
+	{
+		EXPECT_GT(n, 0u);
+		EXPECT_LE(n, nDesired / 12);
+	}
+
+	// Same result with threads:
+	mrpt::system::CWorkerThreadsPool pool(3);
+	fext.options.tilingOptions.threadPool = &pool;
+	CFeatureList feats_mt;
+	fext.detectFeatures(img, feats_mt, 0, nDesired);
+	ASSERT_EQ(feats.size(), feats_mt.size());
+	for (std::size_t i = 0; i < feats.size(); i++)
+	{
+		EXPECT_EQ(feats[i]->x, feats_mt[i]->x);
+		EXPECT_EQ(feats[i]->y, feats_mt[i]->y);
+	}
+}
+
+#endif
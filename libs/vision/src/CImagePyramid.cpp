@@ -9,6 +9,15 @@
 
 #include "vision-precomp.h"  // Precompiled headers
 #include <mrpt/vision/CImagePyramid.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <cstring>  // memset
+
+#if MRPT_HAS_SSE2
+#include <mrpt/core/SSE_types.h>
+#endif
+#if MRPT_HAS_AVX2
+#include <immintrin.h>
+#endif
 
 using namespace mrpt;
 using namespace mrpt::vision;
@@ -21,10 +30,13 @@ CImagePyramid::~CImagePyramid()
 }
 
 // Template that generalizes the two user entry-points below:
+// Images of existing octaves are overwritten, reusing their buffers if the
+// image size has not changed.
 template <bool FASTLOAD>
 void buildPyramid_templ(
 	CImagePyramid& obj, mrpt::img::CImage& img, const size_t nOctaves,
-	const bool smooth_halves, const bool convert_grayscale)
+	const bool smooth_halves, const bool convert_grayscale,
+	const bool compute_gradients)
 {
 	ASSERT_ABOVE_(nOctaves, 0);
 
@@ -56,21 +68,146 @@ void buildPyramid_templ(
 		else
 			obj.images[o - 1].scaleHalf(obj.images[o]);
 	}
+
+	if (compute_gradients)
+		obj.computeGradients();
+	else
+	{
+		obj.gradients_x.clear();
+		obj.gradients_y.clear();
+	}
 }
 
 void CImagePyramid::buildPyramid(
 	const mrpt::img::CImage& img, const size_t nOctaves,
-	const bool smooth_halves, const bool convert_grayscale)
+	const bool smooth_halves, const bool convert_grayscale,
+	const bool compute_gradients)
 {
 	buildPyramid_templ<false>(
 		*this, *const_cast<mrpt::img::CImage*>(&img), nOctaves, smooth_halves,
-		convert_grayscale);
+		convert_grayscale, compute_gradients);
 }
 
 void CImagePyramid::buildPyramidFast(
 	mrpt::img::CImage& img, const size_t nOctaves, const bool smooth_halves,
-	const bool convert_grayscale)
+	const bool convert_grayscale, const bool compute_gradients)
 {
 	buildPyramid_templ<true>(
-		*this, img, nOctaves, smooth_halves, convert_grayscale);
+		*this, img, nOctaves, smooth_halves, convert_grayscale,
+		compute_gradients);
+}
+
+std::future<void> CImagePyramid::buildPyramidAsync(
+	const mrpt::img::CImage& img, const size_t nOctaves,
+	const bool smooth_halves, const bool convert_grayscale,
+	const bool compute_gradients, mrpt::system::CWorkerThreadsPool* pool)
+{
+	auto task = [this, &img, nOctaves, smooth_halves, convert_grayscale,
+				 compute_gradients]() {
+		buildPyramid(
+			img, nOctaves, smooth_halves, convert_grayscale,
+			compute_gradients);
+	};
+	if (pool) return pool->enqueue(task);
+	return std::async(std::launch::async, task);
+}
+
+void CImagePyramid::computeGradients()
+{
+	MRPT_START
+
+	const size_t nOctaves = images.size();
+	gradients_x.resize(nOctaves);
+	gradients_y.resize(nOctaves);
+	for (size_t o = 0; o < nOctaves; o++)
+	{
+		const CImage& im = images[o];
+		ASSERTMSG_(!im.isColor(), "Gradients require grayscale octaves");
+		const size_t w = im.getWidth(), h = im.getHeight();
+		// No reallocation if the size did not change:
+		gradients_x[o].resize(h, w);
+		gradients_y[o].resize(h, w);
+		if (!w || !h) continue;
+		imageGradients(
+			im.get_unsafe(0, 0), w, h, im.getRowStride(),
+			gradients_x[o].data(), gradients_y[o].data());
+	}
+
+	MRPT_END
+}
+
+void CImagePyramid::imageGradients(
+	const uint8_t* img, const size_t w, const size_t h, const size_t stride,
+	int16_t* gx, int16_t* gy)
+{
+	if (!w || !h) return;
+
+	// Border rows:
+	std::memset(gx, 0, sizeof(int16_t) * w);
+	std::memset(gy, 0, sizeof(int16_t) * w);
+	if (h > 1)
+	{
+		std::memset(gx + (h - 1) * w, 0, sizeof(int16_t) * w);
+		std::memset(gy + (h - 1) * w, 0, sizeof(int16_t) * w);
+	}
+
+	for (size_t y = 1; y + 1 < h; y++)
+	{
+		const uint8_t* row = img + y * stride;
+		const uint8_t* prev = row - stride;
+		const uint8_t* next = row + stride;
+		int16_t* ox = gx + y * w;
+		int16_t* oy = gy + y * w;
+
+		// Border columns:
+		ox[0] = oy[0] = 0;
+		ox[w - 1] = oy[w - 1] = 0;
+
+		size_t x = 1;
+#if MRPT_HAS_AVX2
+		// 16 pixels per iteration, reading up to row[x+16]:
+		for (; x + 17 <= w; x += 16)
+		{
+			const __m256i l = _mm256_cvtepu8_epi16(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x - 1)));
+			const __m256i r = _mm256_cvtepu8_epi16(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + x + 1)));
+			const __m256i u = _mm256_cvtepu8_epi16(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(prev + x)));
+			const __m256i d = _mm256_cvtepu8_epi16(
+				_mm_loadu_si128(reinterpret_cast<const __m128i*>(next + x)));
+			_mm256_storeu_si256(
+				reinterpret_cast<__m256i*>(ox + x), _mm256_sub_epi16(r, l));
+			_mm256_storeu_si256(
+				reinterpret_cast<__m256i*>(oy + x), _mm256_sub_epi16(d, u));
+		}
+#elif MRPT_HAS_SSE2
+		// 8 pixels per iteration, reading up to row[x+8]:
+		const __m128i zero = _mm_setzero_si128();
+		for (; x + 9 <= w; x += 8)
+		{
+			const __m128i l = _mm_unpacklo_epi8(
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + x - 1)),
+				zero);
+			const __m128i r = _mm_unpacklo_epi8(
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + x + 1)),
+				zero);
+			const __m128i u = _mm_unpacklo_epi8(
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(prev + x)),
+				zero);
+			const __m128i d = _mm_unpacklo_epi8(
+				_mm_loadl_epi64(reinterpret_cast<const __m128i*>(next + x)),
+				zero);
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(ox + x), _mm_sub_epi16(r, l));
+			_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(oy + x), _mm_sub_epi16(d, u));
+		}
+#endif
+		for (; x + 1 < w; x++)
+		{
+			ox[x] = static_cast<int16_t>(row[x + 1] - row[x - 1]);
+			oy[x] = static_cast<int16_t>(next[x] - prev[x]);
+		}
+	}
 }
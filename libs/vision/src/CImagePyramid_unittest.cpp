@@ -0,0 +1,78 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/CImagePyramid.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt::vision;
+
+TEST(CImagePyramid, imageGradients)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(123);
+	// Sizes around the SIMD block lengths, and rows with padding:
+	for (size_t w : {1, 2, 3, 9, 10, 16, 17, 18, 33, 40})
+		for (size_t h : {1, 2, 3, 7})
+		{
+			const size_t stride = w + 5;
+			std::vector<uint8_t> img(stride * h);
+			for (auto& p : img)
+				p = static_cast<uint8_t>(rng.drawUniform32bit());
+			std::vector<int16_t> gx(w * h, 1), gy(w * h, 1);
+			CImagePyramid::imageGradients(
+				img.data(), w, h, stride, gx.data(), gy.data());
+
+			for (size_t y = 0; y < h; y++)
+				for (size_t x = 0; x < w; x++)
+				{
+					int ex = 0, ey = 0;
+					const uint8_t* p = &img[y * stride + x];
+					if (x > 0 && y > 0 && x + 1 < w && y + 1 < h)
+					{
+						ex = p[1] - p[-1];
+						ey = p[stride] - p[-static_cast<ptrdiff_t>(stride)];
+					}
+					EXPECT_EQ(gx[y * w + x], ex) << "w=" << w << " h=" << h;
+					EXPECT_EQ(gy[y * w + x], ey) << "w=" << w << " h=" << h;
+				}
+		}
+}
+
+#if MRPT_HAS_OPENCV
+
+TEST(CImagePyramid, buildReusesBuffers)
+{
+	mrpt::img::CImage img(101, 77, CH_GRAY);
+	for (unsigned y = 0; y < 77; y++)
+		for (unsigned x = 0; x < 101; x++)
+			*img.get_unsafe(x, y) = static_cast<uint8_t>(x * 3 + y * 7);
+
+	CImagePyramid pyr;
+	pyr.buildPyramid(img, 3, true, false, true);
+	ASSERT_EQ(pyr.images.size(), 3u);
+	ASSERT_EQ(pyr.gradients_x.size(), 3u);
+	EXPECT_EQ(pyr.images[2].getWidth(), 25u);
+	EXPECT_EQ(pyr.gradients_x[1].cols(), 50);
+	EXPECT_EQ(pyr.gradients_x[0](10, 10), 6);
+	EXPECT_EQ(pyr.gradients_y[0](10, 10), 14);
+
+	const uint8_t* bufs[3];
+	for (int o = 0; o < 3; o++) bufs[o] = pyr.images[o].get_unsafe(0, 0);
+
+	// Same size: no new buffers, even when built in another thread:
+	mrpt::system::CWorkerThreadsPool pool(1);
+	pyr.buildPyramidAsync(img, 3, true, false, true, &pool).get();
+	for (int o = 0; o < 3; o++)
+		EXPECT_EQ(bufs[o], pyr.images[o].get_unsafe(0, 0));
+	EXPECT_EQ(pyr.gradients_y[0](10, 10), 14);
+}
+
+#endif
@@ -12,6 +12,7 @@
 #include <mrpt/vision/bundle_adjustment.h>
 #include <mrpt/vision/pinhole.h>
 #include <mrpt/math/robust_kernels.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include "ba_internals.h"
 
 using namespace std;
@@ -95,18 +96,60 @@ void mrpt::vision::ba_initial_estimate(
 	MRPT_END
 }
 
+namespace
+{
+/** Evaluates the robust kernel `type` for the squared error `r2`. Returns
+ * the robustified squared error, and its derivative wrt r2 (the weight of
+ * this residual in the normal equations) in `out_1st_deriv`. */
+double evalRobustKernel(
+	const TRobustKernelType type, const double param_sq, const double r2,
+	double& out_1st_deriv)
+{
+	double kernel_2nd_deriv;
+	switch (type)
+	{
+		case rkLeastSquares:
+		{
+			RobustKernel<rkLeastSquares> kernel;
+			kernel.param_sq = param_sq;
+			return kernel.eval(r2, out_1st_deriv, kernel_2nd_deriv);
+		}
+		case rkPseudoHuber:
+		{
+			RobustKernel<rkPseudoHuber> kernel;
+			kernel.param_sq = param_sq;
+			return kernel.eval(r2, out_1st_deriv, kernel_2nd_deriv);
+		}
+		case rkHuber:
+		{
+			RobustKernel<rkHuber> kernel;
+			kernel.param_sq = param_sq;
+			return kernel.eval(r2, out_1st_deriv, kernel_2nd_deriv);
+		}
+		case rkCauchy:
+		{
+			RobustKernel<rkCauchy> kernel;
+			kernel.param_sq = param_sq;
+			return kernel.eval(r2, out_1st_deriv, kernel_2nd_deriv);
+		}
+		default:
+			THROW_EXCEPTION("Unknown robust kernel type");
+	};
+}
+}  // namespace
+
 // This function is what to do for each feature in the reprojection loops below.
 // -> residual: the raw residual, even if using robust kernel
-// -> sum+= scaled squared norm of the residual (which != squared norm if using
-// robust kernel)
+// -> returns: scaled squared norm of the residual (which != squared norm if
+// using robust kernel)
 template <bool POSES_INVERSE>
-inline void reprojectionResidualsElement(
+inline double reprojectionResidualsElement(
 	const TCamera& camera_params, const TFeatureObservation& OBS,
 	std::array<double, 2>& out_residual,
 	const TFramePosesVec::value_type& frame,
-	const TLandmarkLocationsVec::value_type& point, double& sum,
-	const bool use_robust_kernel, const double kernel_param,
-	double* out_kernel_1st_deriv)
+	const TLandmarkLocationsVec::value_type& point,
+	const bool use_robust_kernel, const TRobustKernelType kernel_type,
+	const double kernel_param, double* out_kernel_1st_deriv)
 {
 	const TPixelCoordf z_pred =
 		mrpt::vision::pinhole::projectPoint_no_distortion<POSES_INVERSE>(
@@ -120,19 +163,69 @@ inline void reprojectionResidualsElement(
 
 	if (use_robust_kernel)
 	{
-		RobustKernel<rkPseudoHuber> kernel;
-		kernel.param_sq = square(kernel_param);
-		double kernel_1st_deriv, kernel_2nd_deriv;
-
-		sum += kernel.eval(sum_2, kernel_1st_deriv, kernel_2nd_deriv);
+		double kernel_1st_deriv;
+		const double r = evalRobustKernel(
+			kernel_type, square(kernel_param), sum_2, kernel_1st_deriv);
 		if (out_kernel_1st_deriv) *out_kernel_1st_deriv = kernel_1st_deriv;
+		return r;
 	}
 	else
 	{
-		sum += sum_2;
+		return sum_2;
 	}
 }
 
+// Common implementation of both reprojectionResiduals(): `getFramePoint(i)`
+// returns the frame and the point of the i-th observation.
+template <class FRAME_POINT_GETTER>
+double reprojectionResiduals_impl(
+	const TSequenceFeatureObservations& observations,
+	const TCamera& camera_params, FRAME_POINT_GETTER getFramePoint,
+	std::vector<std::array<double, 2>>& out_residuals,
+	const bool frame_poses_are_inverse, const bool use_robust_kernel,
+	const double kernel_param, std::vector<double>* out_kernel_1st_deriv,
+	const TRobustKernelType kernel_type,
+	mrpt::system::CWorkerThreadsPool* pool)
+{
+	const size_t N = observations.size();
+	out_residuals.resize(N);
+	if (out_kernel_1st_deriv) out_kernel_1st_deriv->resize(N);
+
+	// Errors are summed up afterwards in the same order, so the result does
+	// not depend on the threads:
+	std::vector<double> errs(N);
+
+	auto body = [&](size_t i0, size_t i1) {
+		for (size_t i = i0; i < i1; i++)
+		{
+			const TFeatureObservation& OBS = observations[i];
+			const auto fp = getFramePoint(i);
+
+			double* ptr_1st_deriv =
+				out_kernel_1st_deriv ? &((*out_kernel_1st_deriv)[i]) : nullptr;
+
+			if (frame_poses_are_inverse)
+				errs[i] = reprojectionResidualsElement<true>(
+					camera_params, OBS, out_residuals[i], *fp.first,
+					*fp.second, use_robust_kernel, kernel_type, kernel_param,
+					ptr_1st_deriv);
+			else
+				errs[i] = reprojectionResidualsElement<false>(
+					camera_params, OBS, out_residuals[i], *fp.first,
+					*fp.second, use_robust_kernel, kernel_type, kernel_param,
+					ptr_1st_deriv);
+		}
+	};
+	if (pool)
+		pool->parallel_for(N, body, 256 /* min obs per chunk */);
+	else
+		body(0, N);
+
+	double sum = 0;
+	for (size_t i = 0; i < N; i++) sum += errs[i];
+	return sum;
+}
+
 /** Compute reprojection error vector (used from within Bundle Adjustment
  * methods, but can be used in general)
  *  See mrpt::vision::bundle_adj_full for a description of most parameters.
@@ -145,45 +238,27 @@ double mrpt::vision::reprojectionResiduals(
 	const TLandmarkLocationsMap& landmark_points,
 	std::vector<std::array<double, 2>>& out_residuals,
 	const bool frame_poses_are_inverse, const bool use_robust_kernel,
-	const double kernel_param, std::vector<double>* out_kernel_1st_deriv)
+	const double kernel_param, std::vector<double>* out_kernel_1st_deriv,
+	const TRobustKernelType kernel_type,
+	mrpt::system::CWorkerThreadsPool* pool)
 {
 	MRPT_START
 
-	double sum = 0;
-
-	const size_t N = observations.size();
-	out_residuals.resize(N);
-	if (out_kernel_1st_deriv) out_kernel_1st_deriv->resize(N);
-
-	for (size_t i = 0; i < N; i++)
-	{
+	auto getFramePoint = [&](size_t i) {
 		const TFeatureObservation& OBS = observations[i];
 
-		const TFeatureID i_p = OBS.id_feature;
-		const TCameraPoseID i_f = OBS.id_frame;
-
-		TFramePosesMap::const_iterator itF = frame_poses.find(i_f);
-		TLandmarkLocationsMap::const_iterator itP = landmark_points.find(i_p);
+		TFramePosesMap::const_iterator itF = frame_poses.find(OBS.id_frame);
+		TLandmarkLocationsMap::const_iterator itP =
+			landmark_points.find(OBS.id_feature);
 		ASSERTMSG_(itF != frame_poses.end(), "Frame ID is not in list!");
 		ASSERTMSG_(itP != landmark_points.end(), "Landmark ID is not in list!");
+		return std::make_pair(&itF->second, &itP->second);
+	};
 
-		const TFramePosesMap::mapped_type& frame = itF->second;
-		const TLandmarkLocationsMap::mapped_type& point = itP->second;
-
-		double* ptr_1st_deriv =
-			out_kernel_1st_deriv ? &((*out_kernel_1st_deriv)[i]) : nullptr;
-
-		if (frame_poses_are_inverse)
-			reprojectionResidualsElement<true>(
-				camera_params, OBS, out_residuals[i], frame, point, sum,
-				use_robust_kernel, kernel_param, ptr_1st_deriv);
-		else
-			reprojectionResidualsElement<false>(
-				camera_params, OBS, out_residuals[i], frame, point, sum,
-				use_robust_kernel, kernel_param, ptr_1st_deriv);
-	}
-
-	return sum;
+	return reprojectionResiduals_impl(
+		observations, camera_params, getFramePoint, out_residuals,
+		frame_poses_are_inverse, use_robust_kernel, kernel_param,
+		out_kernel_1st_deriv, kernel_type, pool);
 
 	MRPT_END
 }
@@ -194,42 +269,26 @@ double mrpt::vision::reprojectionResiduals(
 	const TLandmarkLocationsVec& landmark_points,
 	std::vector<std::array<double, 2>>& out_residuals,
 	const bool frame_poses_are_inverse, const bool use_robust_kernel,
-	const double kernel_param, std::vector<double>* out_kernel_1st_deriv)
+	const double kernel_param, std::vector<double>* out_kernel_1st_deriv,
+	const TRobustKernelType kernel_type,
+	mrpt::system::CWorkerThreadsPool* pool)
 {
 	MRPT_START
 
-	double sum = 0;
-
-	const size_t N = observations.size();
-	out_residuals.resize(N);
-	if (out_kernel_1st_deriv) out_kernel_1st_deriv->resize(N);
-
-	for (size_t i = 0; i < N; i++)
-	{
+	auto getFramePoint = [&](size_t i) {
 		const TFeatureObservation& OBS = observations[i];
 
-		const TFeatureID i_p = OBS.id_feature;
-		const TCameraPoseID i_f = OBS.id_frame;
-
-		ASSERT_BELOW_(i_p, landmark_points.size());
-		ASSERT_BELOW_(i_f, frame_poses.size());
-		const TFramePosesVec::value_type& frame = frame_poses[i_f];
-		const TLandmarkLocationsVec::value_type& point = landmark_points[i_p];
-
-		double* ptr_1st_deriv =
-			out_kernel_1st_deriv ? &((*out_kernel_1st_deriv)[i]) : nullptr;
-
-		if (frame_poses_are_inverse)
-			reprojectionResidualsElement<true>(
-				camera_params, OBS, out_residuals[i], frame, point, sum,
-				use_robust_kernel, kernel_param, ptr_1st_deriv);
-		else
-			reprojectionResidualsElement<false>(
-				camera_params, OBS, out_residuals[i], frame, point, sum,
-				use_robust_kernel, kernel_param, ptr_1st_deriv);
-	}
+		ASSERT_BELOW_(OBS.id_feature, landmark_points.size());
+		ASSERT_BELOW_(OBS.id_frame, frame_poses.size());
+		return std::make_pair(
+			&frame_poses[OBS.id_frame], &landmark_points[OBS.id_feature]);
+	};
+
+	return reprojectionResiduals_impl(
+		observations, camera_params, getFramePoint, out_residuals,
+		frame_poses_are_inverse, use_robust_kernel, kernel_param,
+		out_kernel_1st_deriv, kernel_type, pool);
 
-	return sum;
 	MRPT_END
 }
 
@@ -243,69 +302,96 @@ void mrpt::vision::ba_build_gradient_Hessians(
 	mrpt::aligned_std_vector<CMatrixFixedNumeric<double, 3, 3>>& V,
 	mrpt::aligned_std_vector<CArrayDouble<3>>& eps_point,
 	const size_t num_fix_frames, const size_t num_fix_points,
-	const vector<double>* kernel_1st_deriv)
+	const vector<double>* kernel_1st_deriv, const TBAObsIndex& obs_index,
+	mrpt::system::CWorkerThreadsPool* pool)
 {
 	MRPT_START
 
-	const size_t N = observations.size();
 	const bool use_robust_kernel = (kernel_1st_deriv != nullptr);
+	ASSERT_EQUAL_(obs_index.frame_obs.size(), U.size());
+	ASSERT_EQUAL_(obs_index.point_obs.size(), V.size());
 
-	for (size_t i = 0; i < N; i++)
-	{
-		const TFeatureObservation& OBS = observations[i];
-
-		const TFeatureID i_p = OBS.id_feature;
-		const TCameraPoseID i_f = OBS.id_frame;
-
-		const Eigen::Matrix<double, 2, 1> RESID(&residual_vec[i][0]);
-		const JacData<6, 3, 2>& JACOB = jac_data_vec[i];
-		ASSERTDEB_(JACOB.frame_id == i_f && JACOB.point_id == i_p);
-
-		if (i_f >= num_fix_frames)
+	// Each frame and point block is built by one thread, from the lists of
+	// its observations, so no synchronization is needed:
+	auto frames_body = [&](size_t j0, size_t j1) {
+		for (size_t frame_id = j0; frame_id < j1; frame_id++)
 		{
-			const size_t frame_id = i_f - num_fix_frames;
-			ASSERTDEB_(JACOB.J_frame_valid);
-			ASSERT_BELOW_(frame_id, U.size());
-			CMatrixDouble66 JtJ(UNINITIALIZED_MATRIX);
-			JtJ.multiply_AtA(JACOB.J_frame);
-
-			CArrayDouble<6> eps_delta;
-			JACOB.J_frame.multiply_Atb(
-				RESID, eps_delta);  // eps_delta = J^t * RESID
-			if (!use_robust_kernel)
-			{
-				eps_frame[frame_id] += eps_delta;
-			}
-			else
+			U[frame_id].zeros();
+			eps_frame[frame_id].fill(0);
+			for (const size_t i : obs_index.frame_obs[frame_id])
 			{
-				const double rho_1st_der = (*kernel_1st_deriv)[i];
-				eps_frame[frame_id] += eps_delta * rho_1st_der;
+				const JacData<6, 3, 2>& JACOB = jac_data_vec[i];
+				ASSERTDEB_(
+					JACOB.frame_id == observations[i].id_frame &&
+					JACOB.frame_id == frame_id + num_fix_frames);
+				ASSERTDEB_(JACOB.J_frame_valid);
+				const Eigen::Matrix<double, 2, 1> RESID(&residual_vec[i][0]);
+				// Weight of this observation (IRLS):
+				const double w =
+					use_robust_kernel ? (*kernel_1st_deriv)[i] : 1.0;
+
+				CMatrixDouble66 JtJ(UNINITIALIZED_MATRIX);
+				JtJ.multiply_AtA(JACOB.J_frame);
+
+				CArrayDouble<6> eps_delta;
+				JACOB.J_frame.multiply_Atb(
+					RESID, eps_delta);  // eps_delta = J^t * RESID
+				if (!use_robust_kernel)
+				{
+					eps_frame[frame_id] += eps_delta;
+					U[frame_id] += JtJ;
+				}
+				else
+				{
+					eps_frame[frame_id] += eps_delta * w;
+					U[frame_id] += JtJ * w;
+				}
 			}
-			U[frame_id] += JtJ;
 		}
-		if (i_p >= num_fix_points)
+	};
+	auto points_body = [&](size_t p0, size_t p1) {
+		for (size_t point_id = p0; point_id < p1; point_id++)
 		{
-			const size_t point_id = i_p - num_fix_points;
-			ASSERTDEB_(JACOB.J_point_valid);
-			ASSERT_BELOW_(point_id, V.size());
-			CMatrixDouble33 JtJ(UNINITIALIZED_MATRIX);
-			JtJ.multiply_AtA(JACOB.J_point);
-
-			CArrayDouble<3> eps_delta;
-			JACOB.J_point.multiply_Atb(
-				RESID, eps_delta);  // eps_delta = J^t * RESID
-			if (!use_robust_kernel)
+			V[point_id].zeros();
+			eps_point[point_id].fill(0);
+			for (const size_t i : obs_index.point_obs[point_id])
 			{
-				eps_point[point_id] += eps_delta;
+				const JacData<6, 3, 2>& JACOB = jac_data_vec[i];
+				ASSERTDEB_(JACOB.point_id == point_id + num_fix_points);
+				ASSERTDEB_(JACOB.J_point_valid);
+				const Eigen::Matrix<double, 2, 1> RESID(&residual_vec[i][0]);
+				const double w =
+					use_robust_kernel ? (*kernel_1st_deriv)[i] : 1.0;
+
+				CMatrixDouble33 JtJ(UNINITIALIZED_MATRIX);
+				JtJ.multiply_AtA(JACOB.J_point);
+
+				CArrayDouble<3> eps_delta;
+				JACOB.J_point.multiply_Atb(
+					RESID, eps_delta);  // eps_delta = J^t * RESID
+				if (!use_robust_kernel)
+				{
+					eps_point[point_id] += eps_delta;
+					V[point_id] += JtJ;
+				}
+				else
+				{
+					eps_point[point_id] += eps_delta * w;
+					V[point_id] += JtJ * w;
+				}
 			}
-			else
-			{
-				const double rho_1st_der = (*kernel_1st_deriv)[i];
-				eps_point[point_id] += eps_delta * rho_1st_der;
-			}
-
-			V[point_id] += JtJ;
 		}
+	};
+
+	if (pool)
+	{
+		pool->parallel_for(U.size(), frames_body, 16);
+		pool->parallel_for(V.size(), points_body, 64);
+	}
+	else
+	{
+		frames_body(0, U.size());
+		points_body(0, V.size());
 	}
 
 	MRPT_END
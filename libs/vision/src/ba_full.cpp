@@ -13,8 +13,9 @@
 #include <mrpt/system/CTimeLogger.h>
 #include <mrpt/math/CSparseMatrix.h>
 #include <mrpt/math/ops_containers.h>
-#include <mrpt/core/aligned_std_map.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 
+#include <algorithm>  // sort(), unique()
 #include <memory>  // unique_ptr
 
 #include "ba_internals.h"
@@ -86,6 +87,11 @@ double mrpt::vision::bundle_adj_full(
 		extra_params.getWithDefaultVal("num_fix_points", 0);
 	const double kernel_param =
 		extra_params.getWithDefaultVal("kernel_param", 3.0);
+	const auto kernel_type = static_cast<TRobustKernelType>(
+		static_cast<int>(extra_params.getWithDefaultVal(
+			"robust_kernel_type", static_cast<double>(rkPseudoHuber))));
+	const size_t num_threads = static_cast<size_t>(
+		std::max(1.0, extra_params.getWithDefaultVal("num_threads", 1.0)));
 
 	const bool enable_profiler =
 		0 != extra_params.getWithDefaultVal("profiler", 0);
@@ -113,6 +119,21 @@ double mrpt::vision::bundle_adj_full(
 	profiler.leave("invert_poses");
 #endif
 
+	// Threads for the per-observation, per-frame and per-point loops. The
+	// calling thread also works, hence the "-1":
+	mrpt::system::CWorkerThreadsPool threadPool(num_threads - 1);
+	mrpt::system::CWorkerThreadsPool* pool =
+		num_threads > 1 ? &threadPool : nullptr;
+	auto parallelFor = [pool](
+						   size_t N,
+						   const std::function<void(size_t, size_t)>& body,
+						   size_t min_chunk) {
+		if (pool)
+			pool->parallel_for(N, body, min_chunk);
+		else
+			body(0, N);
+	};
+
 	MyJacDataVec jac_data_vec(num_obs);
 	vector<Array_O> residual_vec(num_obs);
 	vector<double> kernel_1st_deriv(num_obs);
@@ -128,7 +149,7 @@ double mrpt::vision::bundle_adj_full(
 	profiler.enter("compute_Jacobians");
 	ba_compute_Jacobians<INV_POSES_BOOL>(
 		frame_poses, landmark_points, camera_params, jac_data_vec,
-		num_fix_frames, num_fix_points);
+		num_fix_frames, num_fix_points, pool);
 	profiler.leave("compute_Jacobians");
 
 	profiler.enter("reprojectionResiduals");
@@ -136,7 +157,7 @@ double mrpt::vision::bundle_adj_full(
 		observations, camera_params, frame_poses, landmark_points, residual_vec,
 		INV_POSES_BOOL,  // are poses inverse?
 		use_robust_kernel, kernel_param,
-		use_robust_kernel ? &kernel_1st_deriv : nullptr);
+		use_robust_kernel ? &kernel_1st_deriv : nullptr, kernel_type, pool);
 	profiler.leave("reprojectionResiduals");
 
 	MRPT_CHECK_NORMAL_NUMBER(res);
@@ -154,17 +175,75 @@ double mrpt::vision::bundle_adj_full(
 	const size_t len_free_frames = FrameDof * num_free_frames;
 	const size_t len_free_points = PointDof * num_free_points;
 
+	// Structure of the problem, which does not change between iterations:
+	profiler.enter("build_structure");
+	TBAObsIndex obs_index;
+	obs_index.build(
+		observations, num_free_frames, num_free_points, num_fix_frames,
+		num_fix_points);
+
+	// Observations with both a free frame and a free point, for each free
+	// point. These are the only ones with a "W" block:
+	vector<vector<size_t>> point_fobs(num_free_points);
+	for (size_t i = 0; i < num_free_points; i++)
+		for (const size_t k : obs_index.point_obs[i])
+			if (observations[k].id_frame >= num_fix_frames)
+				point_fobs[i].push_back(k);
+
+	// Block structure of the reduced camera system: for each row (free frame)
+	// the sorted list of frames which share some free point with it, plus the
+	// diagonal. Blocks are stored row after row in a flat vector.
+	vector<vector<size_t>> row_cols(num_free_frames);
+	for (size_t j = 0; j < num_free_frames; j++) row_cols[j].push_back(j);
+	for (size_t i = 0; i < num_free_points; i++)
+		for (const size_t a : point_fobs[i])
+			for (const size_t b : point_fobs[i])
+				row_cols[observations[a].id_frame - num_fix_frames].push_back(
+					observations[b].id_frame - num_fix_frames);
+	vector<size_t> row_first_block(num_free_frames + 1, 0);
+	for (size_t j = 0; j < num_free_frames; j++)
+	{
+		auto& c = row_cols[j];
+		std::sort(c.begin(), c.end());
+		c.erase(std::unique(c.begin(), c.end()), c.end());
+		row_first_block[j + 1] = row_first_block[j] + c.size();
+	}
+	const size_t num_blocks = row_first_block[num_free_frames];
+	mrpt::aligned_std_vector<Matrix_FxF> S_blocks(num_blocks);
+	profiler.leave("build_structure");
+
+	VERBOSE_COUT << "Blocks in the reduced camera system: " << num_blocks
+				 << endl;
+
 	mrpt::aligned_std_vector<Matrix_FxF> H_f(num_free_frames);
 	mrpt::aligned_std_vector<Array_F> eps_frame(num_free_frames, arrF_zeros);
 	mrpt::aligned_std_vector<Matrix_PxP> H_p(num_free_points);
 	mrpt::aligned_std_vector<Array_P> eps_point(num_free_points, arrP_zeros);
-
-	profiler.enter("build_gradient_Hessians");
-	ba_build_gradient_Hessians(
-		observations, residual_vec, jac_data_vec, H_f, eps_frame, H_p,
-		eps_point, num_fix_frames, num_fix_points,
-		use_robust_kernel ? &kernel_1st_deriv : nullptr);
-	profiler.leave("build_gradient_Hessians");
+	// W blocks (J_f^T * J_p), indexed by observation:
+	mrpt::aligned_std_vector<Matrix_FxP> W(num_obs);
+
+	auto build_gradient_Hessians = [&]() {
+		profiler.enter("build_gradient_Hessians");
+		ba_build_gradient_Hessians(
+			observations, residual_vec, jac_data_vec, H_f, eps_frame, H_p,
+			eps_point, num_fix_frames, num_fix_points,
+			use_robust_kernel ? &kernel_1st_deriv : nullptr, obs_index, pool);
+
+		parallelFor(
+			num_free_points,
+			[&](size_t i0, size_t i1) {
+				for (size_t i = i0; i < i1; i++)
+					for (const size_t k : point_fobs[i])
+					{
+						const MyJacData& J = jac_data_vec[k];
+						W[k].multiply_AtB(J.J_frame, J.J_point);
+						if (use_robust_kernel) W[k] *= kernel_1st_deriv[k];
+					}
+			},
+			64);
+		profiler.leave("build_gradient_Hessians");
+	};
+	build_gradient_Hessians();
 
 	double nu = 2;
 	double eps = 1e-16;  // 0.000000000000001;
@@ -194,6 +273,8 @@ double mrpt::vision::bundle_adj_full(
 
 	SparseCholDecompPtr ptrCh;
 
+	mrpt::aligned_std_vector<Matrix_PxP> V_inv(num_free_points);
+
 	for (size_t iter = 0; iter < max_iters; iter++)
 	{
 		VERBOSE_COUT << "iteration: " << iter << endl;
@@ -214,126 +295,90 @@ double mrpt::vision::bundle_adj_full(
 			I_muFrame.unit(FrameDof, mu);
 			I_muPoint.unit(PointDof, mu);
 
-			mrpt::aligned_std_vector<Matrix_FxF> U_star(
-				num_free_frames, I_muFrame);
-			mrpt::aligned_std_vector<Matrix_PxP> V_inv(num_free_points);
-
-			for (size_t i = 0; i < U_star.size(); ++i) U_star[i] += H_f[i];
-
-			for (size_t i = 0; i < H_p.size(); ++i)
-				(H_p[i] + I_muPoint).inv_fast(V_inv[i]);
-
-			using WMap = mrpt::aligned_std_map<pair<TCameraPoseID, TLandmarkID>,
-											   Matrix_FxP>;
-			WMap W, Y;
-
-			// For quick look-up of entries in W affecting a given point ID:
-			vector<vector<WMap::iterator>> W_entries(
-				num_points);  // Index is "TLandmarkID"
-
-			MyJacDataVec::const_iterator jac_iter = jac_data_vec.begin();
-			for (TSequenceFeatureObservations::const_iterator it_obs =
-					 observations.begin();
-				 it_obs != observations.end(); ++it_obs)
-			{
-				const TFeatureID feat_id = it_obs->id_feature;
-				const TCameraPoseID frame_id = it_obs->id_frame;
-
-				if (jac_iter->J_frame_valid && jac_iter->J_point_valid)
-				{
-					const CMatrixFixedNumeric<double, ObsDim, FrameDof>&
-						J_frame = jac_iter->J_frame;
-					const CMatrixFixedNumeric<double, ObsDim, PointDof>&
-						J_point = jac_iter->J_point;
-					const pair<TCameraPoseID, TLandmarkID> id_pair =
-						make_pair(frame_id, feat_id);
-
-					Matrix_FxP tmp(UNINITIALIZED_MATRIX);
-					tmp.multiply_AtB(J_frame, J_point);
-
-					// W[ids] = J_f^T * J_p
-					// Was: W[id_pair] = tmp;
-					const pair<WMap::iterator, bool>& retInsert =
-						W.insert(make_pair(id_pair, tmp));
-					ASSERT_(retInsert.second == true);
-					W_entries[feat_id].push_back(
-						retInsert.first);  // Keep the iterator
-
-					// Y[ids] = W[ids] * H_p^{-1}
-					Y[id_pair].multiply_AB(
-						tmp, V_inv[feat_id - num_fix_points]);
-				}
-				++jac_iter;
-			}
-
-			mrpt::aligned_std_map<pair<TCameraPoseID, TLandmarkID>, Matrix_FxF>
-				YW_map;
-			for (size_t i = 0; i < H_f.size(); ++i)
-				YW_map[std::pair<TCameraPoseID, TLandmarkID>(i, i)] = U_star[i];
+			profiler.enter("Schur.invert.points");
+			parallelFor(
+				num_free_points,
+				[&](size_t i0, size_t i1) {
+					for (size_t i = i0; i < i1; i++)
+						(H_p[i] + I_muPoint).inv_fast(V_inv[i]);
+				},
+				256);
+			profiler.leave("Schur.invert.points");
 
 			CVectorDouble delta(
 				len_free_frames + len_free_points);  // The optimal step
 			CVectorDouble e(len_free_frames);
 
+			// Reduced camera system, one row of blocks per free frame:
+			//  S_jk = U_j* [j==k] - sum_i Y_ij * W_ik^T
+			//  e_j  = eps_frame_j - sum_i Y_ij * eps_point_i
+			// with Y_ij = W_ij * V_i*^{-1}. Each row is written by one thread
+			// only, and summed up in the same order whatever the threads.
 			profiler.enter("Schur.build.reduced.frames");
-			for (size_t j = 0; j < num_free_frames; ++j)
-				::memcpy(
-					&e[j * FrameDof], &eps_frame[j][0],
-					sizeof(e[0]) * FrameDof);  // e.slice(j*FrameDof,FrameDof) =
-			// AT(eps_frame,j);
-
-			for (WMap::iterator Y_ij = Y.begin(); Y_ij != Y.end(); ++Y_ij)
-			{
-				const TLandmarkID point_id = Y_ij->first.second;
-				const size_t i =
-					Y_ij->first.second - num_fix_points;  // point index
-				const size_t j =
-					Y_ij->first.first - num_fix_frames;  // frame index
-
-				const vector<WMap::iterator>& iters =
-					W_entries[point_id];  //->second;
-
-				for (size_t itIdx = 0; itIdx < iters.size(); itIdx++)
-				// for (size_t k=0; k<num_free_frames; ++k)
-				{
-					const WMap::iterator& W_ik = iters[itIdx];
-					const TLandmarkID k = W_ik->first.first - num_fix_frames;
-
-					Matrix_FxF YWt(UNINITIALIZED_MATRIX);  //-(Y_ij->second) *
-					//(W_ik->second).T();
-					YWt.multiply_ABt(Y_ij->second, W_ik->second);
-					// YWt*=-1.0; // The "-" sign is taken into account below:
-
-					const pair<TCameraPoseID, TLandmarkID> ids_jk =
-						pair<TCameraPoseID, TLandmarkID>(j, k);
-
-					auto it = YW_map.find(ids_jk);
-					if (it != YW_map.end())
-						it->second -= YWt;  // += (-YWt);
-					else
-						YW_map[ids_jk] = YWt * (-1.0);
-				}
-
-				CArrayDouble<FrameDof> r;
-				Y_ij->second.multiply_Ab(eps_point[i], r);
-				for (size_t k = 0; k < FrameDof; k++)
-					e[j * FrameDof + k] -= r[k];
-			}
+			parallelFor(
+				num_free_frames,
+				[&](size_t j0, size_t j1) {
+					// Position of each column in the current row:
+					vector<size_t> col_pos(num_free_frames);
+					for (size_t j = j0; j < j1; j++)
+					{
+						const vector<size_t>& cols = row_cols[j];
+						Matrix_FxF* row_blocks = &S_blocks[row_first_block[j]];
+						for (size_t c = 0; c < cols.size(); c++)
+						{
+							col_pos[cols[c]] = c;
+							if (cols[c] == j)
+							{
+								row_blocks[c] = H_f[j];
+								row_blocks[c] += I_muFrame;
+							}
+							else
+								row_blocks[c].zeros();
+						}
+
+						Array_F e_j = eps_frame[j];
+						for (const size_t a : obs_index.frame_obs[j])
+						{
+							const TLandmarkID point_id =
+								observations[a].id_feature;
+							if (point_id < num_fix_points) continue;
+							const size_t i = point_id - num_fix_points;
+
+							Matrix_FxP Y(UNINITIALIZED_MATRIX);
+							Y.multiply_AB(W[a], V_inv[i]);
+
+							Array_F r;
+							Y.multiply_Ab(eps_point[i], r);
+							e_j -= r;
+
+							for (const size_t b : point_fobs[i])
+							{
+								const size_t k =
+									observations[b].id_frame - num_fix_frames;
+								Matrix_FxF YWt(UNINITIALIZED_MATRIX);
+								YWt.multiply_ABt(Y, W[b]);
+								row_blocks[col_pos[k]] -= YWt;
+							}
+						}
+						::memcpy(
+							&e[j * FrameDof], &e_j[0], sizeof(e[0]) * FrameDof);
+					}
+				},
+				4);
 			profiler.leave("Schur.build.reduced.frames");
 
 			profiler.enter("sS:ALL");
 			profiler.enter("sS:fill");
 
-			VERBOSE_COUT << "Entries in YW_map:" << YW_map.size() << endl;
-
 			CSparseMatrix sS(len_free_frames, len_free_frames);
 
-			for (auto it = YW_map.begin(); it != YW_map.end(); ++it)
+			for (size_t j = 0; j < num_free_frames; j++)
 			{
-				const pair<TCameraPoseID, TLandmarkID>& ids = it->first;
-				const Matrix_FxF& YW = it->second;
-				sS.insert_submatrix(
-					ids.first * FrameDof, ids.second * FrameDof, YW);
+				const vector<size_t>& cols = row_cols[j];
+				for (size_t c = 0; c < cols.size(); c++)
+					sS.insert_submatrix(
+						j * FrameDof, cols[c] * FrameDof,
+						S_blocks[row_first_block[j] + c]);
 			}
 			profiler.leave("sS:fill");
 
@@ -364,6 +409,7 @@ double mrpt::vision::bundle_adj_full(
 			catch (CExceptionNotDefPos&)
 			{
 				profiler.leave("sS:ALL");
+				profiler.leave("COMPLETE_ITER");
 				// not positive definite so increase mu and try again
 				mu *= nu;
 				nu *= 2.;
@@ -381,39 +427,37 @@ double mrpt::vision::bundle_adj_full(
 						g[0]));  // g.slice(0,FrameDof*(num_frames-num_fix_frames))
 			// = e;
 
-			for (size_t i = 0; i < num_free_points; ++i)
-			{
-				Array_P tmp =
-					eps_point[i];  // eps_point.slice(PointDof*i,PointDof);
-
-				for (size_t j = 0; j < num_free_frames; ++j)
-				{
-					WMap::iterator W_ij;
-					W_ij = W.find(
-						make_pair(
-							TCameraPoseID(j + num_fix_frames),
-							TLandmarkID(i + num_fix_points)));
-
-					if (W_ij != W.end())
+			// delta_point_i = V_i*^{-1} * (eps_point_i - sum_j W_ij^T *
+			// delta_frame_j)
+			parallelFor(
+				num_free_points,
+				[&](size_t i0, size_t i1) {
+					for (size_t i = i0; i < i1; ++i)
 					{
-						// tmp -= W_ij->second.T() *
-						// delta.slice(j*FrameDof,FrameDof);
-						const Array_F v(&delta[j * FrameDof]);
-						Array_P r;
-						W_ij->second.multiply_Atb(v, r);  // r= A^t * v
-						tmp -= r;
+						Array_P tmp = eps_point[i];
+						for (const size_t b : point_fobs[i])
+						{
+							const size_t j =
+								observations[b].id_frame - num_fix_frames;
+							const Array_F v(&delta[j * FrameDof]);
+							Array_P r;
+							W[b].multiply_Atb(v, r);  // r= A^t * v
+							tmp -= r;
+						}
+						Array_P Vi_tmp;
+						V_inv[i].multiply_Ab(
+							tmp, Vi_tmp);  // Vi_tmp = V_inv[i] * tmp
+
+						::memcpy(
+							&delta[len_free_frames + i * PointDof], &Vi_tmp[0],
+							sizeof(Vi_tmp[0]) * PointDof);
+						::memcpy(
+							&g[len_free_frames + i * PointDof],
+							&eps_point[i][0],
+							sizeof(eps_point[0][0]) * PointDof);
 					}
-				}
-				Array_P Vi_tmp;
-				V_inv[i].multiply_Ab(tmp, Vi_tmp);  // Vi_tmp = V_inv[i] * tmp
-
-				::memcpy(
-					&delta[len_free_frames + i * PointDof], &Vi_tmp[0],
-					sizeof(Vi_tmp[0]) * PointDof);
-				::memcpy(
-					&g[len_free_frames + i * PointDof], &eps_point[i][0],
-					sizeof(eps_point[0][0]) * PointDof);
-			}
+				},
+				256);
 			profiler.leave("PostSchur.landmarks");
 
 			// Vars for temptative new estimates:
@@ -441,7 +485,8 @@ double mrpt::vision::bundle_adj_full(
 				new_landmark_points, new_residual_vec,
 				INV_POSES_BOOL,  // are poses inverse?
 				use_robust_kernel, kernel_param,
-				use_robust_kernel ? &new_kernel_1st_deriv : nullptr);
+				use_robust_kernel ? &new_kernel_1st_deriv : nullptr,
+				kernel_type, pool);
 			profiler.leave("reprojectionResiduals");
 
 			MRPT_CHECK_NORMAL_NUMBER(res_new);
@@ -467,21 +512,10 @@ double mrpt::vision::bundle_adj_full(
 				profiler.enter("compute_Jacobians");
 				ba_compute_Jacobians<INV_POSES_BOOL>(
 					frame_poses, landmark_points, camera_params, jac_data_vec,
-					num_fix_frames, num_fix_points);
+					num_fix_frames, num_fix_points, pool);
 				profiler.leave("compute_Jacobians");
 
-				// Reset to zeros:
-				H_f.assign(num_free_frames, Matrix_FxF());
-				H_p.assign(num_free_points, Matrix_PxP());
-				eps_frame.assign(num_free_frames, arrF_zeros);
-				eps_point.assign(num_free_points, arrP_zeros);
-
-				profiler.enter("build_gradient_Hessians");
-				ba_build_gradient_Hessians(
-					observations, residual_vec, jac_data_vec, H_f, eps_frame,
-					H_p, eps_point, num_fix_frames, num_fix_points,
-					use_robust_kernel ? &kernel_1st_deriv : nullptr);
-				profiler.leave("build_gradient_Hessians");
+				build_gradient_Hessians();
 
 				stop = norm_inf(g) <= eps;
 				// mu *= max(1.0/3.0, 1-std::pow(2*rho-1,3.0) );
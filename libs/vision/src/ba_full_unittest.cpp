@@ -0,0 +1,119 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/bundle_adjustment.h>
+#include <mrpt/vision/pinhole.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+
+using namespace mrpt::vision;
+using namespace mrpt::math;
+using namespace mrpt::poses;
+
+namespace
+{
+// A camera moving along +X, looking at points in front of it (+Z).
+void simulateScene(
+	const mrpt::img::TCamera& cam, TFramePosesVec& gt_frames,
+	TLandmarkLocationsVec& gt_points, TSequenceFeatureObservations& obs)
+{
+	auto& rng = mrpt::random::getRandomGenerator();
+	rng.randomize(1234);
+
+	const size_t nFrames = 12, nPoints = 150;
+	gt_frames.resize(nFrames);
+	gt_points.resize(nPoints);
+	for (size_t i = 0; i < nFrames; i++)
+		gt_frames[i] = CPose3D(0.5 * i, 0.1 * std::sin(0.3 * i), 0, 0, 0, 0);
+	for (auto& p : gt_points)
+		p = TPoint3D(
+			rng.drawUniform(-2.0, 0.5 * nFrames + 2),
+			rng.drawUniform(-3.0, 3.0), rng.drawUniform(5.0, 10.0));
+
+	obs.clear();
+	for (size_t j = 0; j < nPoints; j++)
+		for (size_t i = 0; i < nFrames; i++)
+		{
+			if (std::abs(gt_points[j].x - gt_frames[i].x()) > 3) continue;
+			const auto px = pinhole::projectPoint_no_distortion<false>(
+				cam, gt_frames[i], gt_points[j]);
+			obs.push_back(TFeatureObservation(j, i, px));
+		}
+}
+}  // namespace
+
+TEST(bundle_adj_full, convergesAndIsThreadIndependent)
+{
+	mrpt::img::TCamera cam;
+	cam.ncols = 800;
+	cam.nrows = 600;
+	cam.fx(400);
+	cam.fy(400);
+	cam.cx(400);
+	cam.cy(300);
+
+	TFramePosesVec gt_frames;
+	TLandmarkLocationsVec gt_points;
+	TSequenceFeatureObservations obs;
+	simulateScene(cam, gt_frames, gt_points, obs);
+
+	// Perturbed initial guess (the first frame is fixed):
+	auto& rng = mrpt::random::getRandomGenerator();
+	TFramePosesVec frames0 = gt_frames;
+	TLandmarkLocationsVec points0 = gt_points;
+	for (size_t i = 1; i < frames0.size(); i++)
+		frames0[i] = CPose3D(
+			gt_frames[i].x() + rng.drawGaussian1D(0, 0.02),
+			gt_frames[i].y() + rng.drawGaussian1D(0, 0.02),
+			gt_frames[i].z() + rng.drawGaussian1D(0, 0.02),
+			rng.drawGaussian1D(0, 0.005), rng.drawGaussian1D(0, 0.005),
+			rng.drawGaussian1D(0, 0.005));
+	for (auto& p : points0)
+	{
+		p.x += rng.drawGaussian1D(0, 0.05);
+		p.y += rng.drawGaussian1D(0, 0.05);
+		p.z += rng.drawGaussian1D(0, 0.05);
+	}
+	// The scale is fixed by two frames, so the solution is unique:
+	const size_t num_fix_frames = 2;
+	frames0[1] = gt_frames[1];
+
+	for (double kernel : {rkPseudoHuber, rkHuber, rkCauchy})
+	{
+		double res[2];
+		TFramePosesVec frames[2];
+		TLandmarkLocationsVec points[2];
+		for (int t = 0; t < 2; t++)
+		{
+			mrpt::system::TParametersDouble params;
+			params["num_fix_frames"] = num_fix_frames;
+			params["max_iterations"] = 30;
+			params["robust_kernel_type"] = kernel;
+			params["num_threads"] = t == 0 ? 1 : 3;
+			frames[t] = frames0;
+			points[t] = points0;
+			res[t] = bundle_adj_full(obs, cam, frames[t], points[t], params);
+		}
+		EXPECT_LT(res[0], 1e-6) << "kernel=" << kernel;
+		// Same result whatever the number of threads:
+		EXPECT_EQ(res[0], res[1]);
+		for (size_t i = 0; i < gt_frames.size(); i++)
+		{
+			EXPECT_NEAR(frames[0][i].x(), gt_frames[i].x(), 1e-3);
+			EXPECT_NEAR(frames[0][i].y(), gt_frames[i].y(), 1e-3);
+			EXPECT_NEAR(frames[0][i].yaw(), gt_frames[i].yaw(), 1e-3);
+			EXPECT_EQ(frames[0][i].x(), frames[1][i].x());
+		}
+		for (size_t j = 0; j < gt_points.size(); j++)
+		{
+			EXPECT_NEAR(points[0][j].distanceTo(gt_points[j]), 0, 1e-2);
+			EXPECT_EQ(points[0][j].z, points[1][j].z);
+		}
+	}
+}
@@ -14,6 +14,7 @@
 #include <mrpt/math/CArrayNumeric.h>
 #include <mrpt/poses/CPose3D.h>
 #include <mrpt/core/aligned_std_vector.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
 #include <mrpt/vision/types.h>
 
 #include <array>
@@ -192,13 +193,15 @@ void pointJac(
 // For the case of *inverse* or *normal* frame poses being estimated.
 // Made inline so immediate values in "poses_are_inverses" are propragated by
 // the compiler
+// If `pool`!=nullptr, observations are split between its threads.
 template <bool POSES_ARE_INVERSE>
 void ba_compute_Jacobians(
 	const TFramePosesVec& frame_poses,
 	const TLandmarkLocationsVec& landmark_points,
 	const mrpt::img::TCamera& camera_params,
 	mrpt::aligned_std_vector<JacData<6, 3, 2>>& jac_data_vec,
-	const size_t num_fix_frames, const size_t num_fix_points)
+	const size_t num_fix_frames, const size_t num_fix_points,
+	mrpt::system::CWorkerThreadsPool* pool = nullptr)
 {
 	MRPT_START
 
@@ -207,37 +210,75 @@ void ba_compute_Jacobians(
 	ASSERT_(!frame_poses.empty() && !landmark_points.empty());
 	const size_t N = jac_data_vec.size();
 
-	for (size_t i = 0; i < N; i++)
-	{
-		JacData<6, 3, 2>& D = jac_data_vec[i];
-
-		const TCameraPoseID i_f = D.frame_id;
-		const TLandmarkID i_p = D.point_id;
-
-		ASSERTDEB_(i_f < frame_poses.size());
-		ASSERTDEB_(i_p < landmark_points.size());
-
-		if (i_f >= num_fix_frames)
+	auto body = [&](size_t i0, size_t i1) {
+		for (size_t i = i0; i < i1; i++)
 		{
-			frameJac<POSES_ARE_INVERSE>(
-				camera_params, frame_poses[i_f], landmark_points[i_p],
-				D.J_frame);
-			D.J_frame_valid = true;
+			JacData<6, 3, 2>& D = jac_data_vec[i];
+
+			const TCameraPoseID i_f = D.frame_id;
+			const TLandmarkID i_p = D.point_id;
+
+			ASSERTDEB_(i_f < frame_poses.size());
+			ASSERTDEB_(i_p < landmark_points.size());
+
+			if (i_f >= num_fix_frames)
+			{
+				frameJac<POSES_ARE_INVERSE>(
+					camera_params, frame_poses[i_f], landmark_points[i_p],
+					D.J_frame);
+				D.J_frame_valid = true;
+			}
+
+			if (i_p >= num_fix_points)
+			{
+				pointJac<POSES_ARE_INVERSE>(
+					camera_params, frame_poses[i_f], landmark_points[i_p],
+					D.J_point);
+				D.J_point_valid = true;
+			}
 		}
+	};
+	if (pool)
+		pool->parallel_for(N, body, 256 /* min obs per chunk */);
+	else
+		body(0, N);
+
+	MRPT_END
+}
 
-		if (i_p >= num_fix_points)
+/** Indices of the observations of each free frame and of each free point,
+ * in the order of the observations vector. Used to build the Hessian blocks
+ * of each frame and point independently from the others. */
+struct TBAObsIndex
+{
+	/** frame_obs[j]: observations of the frame with ID `j+num_fix_frames` */
+	std::vector<std::vector<size_t>> frame_obs;
+	/** point_obs[i]: observations of the point with ID `i+num_fix_points` */
+	std::vector<std::vector<size_t>> point_obs;
+
+	void build(
+		const TSequenceFeatureObservations& observations,
+		const size_t num_free_frames, const size_t num_free_points,
+		const size_t num_fix_frames, const size_t num_fix_points)
+	{
+		frame_obs.assign(num_free_frames, std::vector<size_t>());
+		point_obs.assign(num_free_points, std::vector<size_t>());
+		for (size_t k = 0; k < observations.size(); k++)
 		{
-			pointJac<POSES_ARE_INVERSE>(
-				camera_params, frame_poses[i_f], landmark_points[i_p],
-				D.J_point);
-			D.J_point_valid = true;
+			const TFeatureObservation& o = observations[k];
+			if (o.id_frame >= num_fix_frames)
+				frame_obs[o.id_frame - num_fix_frames].push_back(k);
+			if (o.id_feature >= num_fix_points)
+				point_obs[o.id_feature - num_fix_points].push_back(k);
 		}
 	}
-	MRPT_END
-}
+};
 
 /** Construct the BA linear system.
- *  Set kernel_1st_deriv!=nullptr if using robust kernel.
+ *  Set kernel_1st_deriv!=nullptr if using robust kernel: the terms of each
+ *  observation are then weighted with the kernel derivative (IRLS).
+ *  U, eps_frame, V and eps_point must be already sized, and are overwritten.
+ *  If `pool`!=nullptr, the blocks are built in parallel.
  */
 void ba_build_gradient_Hessians(
 	const TSequenceFeatureObservations& observations,
@@ -248,7 +289,8 @@ void ba_build_gradient_Hessians(
 	mrpt::aligned_std_vector<mrpt::math::CMatrixFixedNumeric<double, 3, 3>>& V,
 	mrpt::aligned_std_vector<CArrayDouble<3>>& eps_point,
 	const size_t num_fix_frames, const size_t num_fix_points,
-	const vector<double>* kernel_1st_deriv);
+	const vector<double>* kernel_1st_deriv, const TBAObsIndex& obs_index,
+	mrpt::system::CWorkerThreadsPool* pool = nullptr);
 }  // namespace vision
 }  // namespace mrpt
 
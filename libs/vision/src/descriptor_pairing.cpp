@@ -0,0 +1,198 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include "vision-precomp.h"  // Precompiled headers
+
+#include <mrpt/vision/descriptor_pairing.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <algorithm>  // min()
+#include <cmath>
+#include <mutex>
+
+using namespace mrpt::vision;
+
+namespace
+{
+/** Rows of the second matrix compared against a block of rows of the first
+ * one, so they stay in the cache */
+constexpr std::size_t DESC2_TILE_ROWS = 256;
+
+/** Best and second best candidates of one row */
+struct TBestPair
+{
+	float best{std::numeric_limits<float>::max()};
+	float second{std::numeric_limits<float>::max()};
+	std::size_t best_idx{0};
+};
+
+/** Brute-force search for rows [i0,i1) of `desc1`, with "raw" distances
+ * (see CDescriptorMatrix::rawDistances). `rev_best` and `rev_idx` are updated
+ * with the best row in [i0,i1) for each row of `desc2`, if not null (for
+ * cross-checking). */
+void bruteForceRows(
+	const CDescriptorMatrix& desc1, const CDescriptorMatrix& desc2,
+	const std::size_t i0, const std::size_t i1, std::vector<TBestPair>& best,
+	std::vector<float>* rev_best, std::vector<std::size_t>* rev_idx)
+{
+	const std::size_t N2 = desc2.size();
+	float dists[DESC2_TILE_ROWS];
+	for (std::size_t j0 = 0; j0 < N2; j0 += DESC2_TILE_ROWS)
+	{
+		const std::size_t j1 = std::min(N2, j0 + DESC2_TILE_ROWS),
+						  nj = j1 - j0;
+		for (std::size_t i = i0; i < i1; i++)
+		{
+			desc1.rawDistances(i, desc2, j0, j1, dists);
+			TBestPair b = best[i];
+			for (std::size_t k = 0; k < nj; k++)
+			{
+				const float d = dists[k];
+				if (d < b.second)
+				{
+					if (d < b.best)
+					{
+						b.second = b.best;
+						b.best = d;
+						b.best_idx = j0 + k;
+					}
+					else
+						b.second = d;
+				}
+			}
+			best[i] = b;
+
+			if (!rev_best) continue;
+			float* rb = rev_best->data() + j0;
+			std::size_t* ri = rev_idx->data() + j0;
+			for (std::size_t k = 0; k < nj; k++)
+			{
+				if (dists[k] < rb[k])
+				{
+					rb[k] = dists[k];
+					ri[k] = i;
+				}
+			}
+		}
+	}
+}
+}  // namespace
+
+std::size_t mrpt::vision::match_descriptors_brute_force(
+	const CDescriptorMatrix& desc1, const CDescriptorMatrix& desc2,
+	std::vector<TDescriptorMatch>& matches,
+	const TBruteForceMatchingOptions& opts,
+	mrpt::system::CWorkerThreadsPool* pool)
+{
+	MRPT_START
+
+	matches.clear();
+	const std::size_t N1 = desc1.size(), N2 = desc2.size();
+	if (!N1 || !N2) return 0;
+
+	ASSERTMSG_(
+		desc1.descriptorType() == desc2.descriptorType() &&
+			desc1.descriptorLength() == desc2.descriptorLength(),
+		"Both matrices must have the same type and length of descriptors");
+	ASSERT_(opts.ratio >= 0);
+
+	// Comparisons are done with Hamming or *squared* L2 distances:
+	const bool binary = desc1.isBinary();
+	float max_dist = opts.max_distance, ratio = opts.ratio;
+	if (!binary)
+	{
+		max_dist = max_dist < std::sqrt(std::numeric_limits<float>::max())
+					   ? max_dist * max_dist
+					   : std::numeric_limits<float>::max();
+		ratio = ratio * ratio;
+	}
+
+	std::vector<TBestPair> best(N1);
+	std::vector<float> rev_best;
+	std::vector<std::size_t> rev_idx;
+	if (opts.cross_check)
+	{
+		rev_best.assign(N2, std::numeric_limits<float>::max());
+		rev_idx.assign(N2, 0);
+	}
+	std::mutex rev_mtx;
+
+	auto body = [&](std::size_t i0, std::size_t i1) {
+		// Reverse (2->1) matches are found per block of rows, then merged:
+		std::vector<float> blk_rev_best;
+		std::vector<std::size_t> blk_rev_idx;
+		if (opts.cross_check)
+		{
+			blk_rev_best.assign(N2, std::numeric_limits<float>::max());
+			blk_rev_idx.assign(N2, 0);
+		}
+		auto* rb = opts.cross_check ? &blk_rev_best : nullptr;
+		auto* ri = opts.cross_check ? &blk_rev_idx : nullptr;
+
+		bruteForceRows(desc1, desc2, i0, i1, best, rb, ri);
+
+		if (!opts.cross_check) return;
+		std::lock_guard<std::mutex> lck(rev_mtx);
+		for (std::size_t j = 0; j < N2; j++)
+		{
+			// On ties, keep the lowest index, whatever the order of blocks:
+			const float d = blk_rev_best[j];
+			if (d < rev_best[j] ||
+				(d == rev_best[j] && blk_rev_idx[j] < rev_idx[j]))
+			{
+				rev_best[j] = blk_rev_best[j];
+				rev_idx[j] = blk_rev_idx[j];
+			}
+		}
+	};
+
+	if (pool)
+		pool->parallel_for(N1, body, 16 /*min rows per block*/);
+	else
+		body(0, N1);
+
+	for (std::size_t i = 0; i < N1; i++)
+	{
+		const TBestPair& b = best[i];
+		if (b.best > max_dist) continue;
+		if (opts.ratio > 0 && N2 > 1 && !(b.best < ratio * b.second))
+			continue;
+		if (opts.cross_check && rev_idx[b.best_idx] != i) continue;
+
+		TDescriptorMatch m;
+		m.idx1 = i;
+		m.idx2 = b.best_idx;
+		m.distance = binary ? b.best : std::sqrt(b.best);
+		matches.push_back(m);
+	}
+	return matches.size();
+
+	MRPT_END
+}
+
+std::size_t mrpt::vision::match_features_brute_force(
+	const CFeatureList& list1, const CFeatureList& list2,
+	CMatchedFeatureList& matches, const TDescriptorType descriptor,
+	const TBruteForceMatchingOptions& opts,
+	mrpt::system::CWorkerThreadsPool* pool)
+{
+	MRPT_START
+
+	matches.clear();
+	const CDescriptorMatrix desc1(list1, descriptor), desc2(list2, descriptor);
+
+	std::vector<TDescriptorMatch> pairs;
+	match_descriptors_brute_force(desc1, desc2, pairs, opts, pool);
+
+	for (const auto& p : pairs)
+		matches.push_back(std::make_pair(list1[p.idx1], list2[p.idx2]));
+	if (!matches.empty()) matches.updateMaxID(bothLists);
+	return matches.size();
+
+	MRPT_END
+}
@@ -0,0 +1,169 @@
+/* +------------------------------------------------------------------------+
+   |                     Mobile Robot Programming Toolkit (MRPT)            |
+   |                          http://www.mrpt.org/                          |
+   |                                                                        |
+   | Copyright (c) 2005-2018, Individual contributors, see AUTHORS file     |
+   | See: http://www.mrpt.org/Authors - All rights reserved.                |
+   | Released under BSD License. See details in http://www.mrpt.org/License |
+   +------------------------------------------------------------------------+ */
+
+#include <mrpt/vision/descriptor_pairing.h>
+#include <mrpt/system/CWorkerThreadsPool.h>
+#include <mrpt/random.h>
+#include <gtest/gtest.h>
+#include <cmath>
+
+using namespace mrpt::vision;
+
+namespace
+{
+auto& rng = mrpt::random::getRandomGenerator();
+
+// A list of N features with random ORB descriptors:
+CFeatureList randomORBFeatures(std::size_t N, std::size_t len = 32)
+{
+	CFeatureList feats;
+	for (std::size_t i = 0; i < N; i++)
+	{
+		auto f = std::make_shared<CFeature>();
+		f->ID = i;
+		f->descriptors.ORB.resize(len);
+		for (auto& b : f->descriptors.ORB)
+			b = static_cast<uint8_t>(rng.drawUniform32bit());
+		feats.push_back(f);
+	}
+	return feats;
+}
+
+// A copy of `feats`, in reverse order, with a few bits changed:
+CFeatureList perturbedCopy(const CFeatureList& feats)
+{
+	CFeatureList out;
+	for (std::size_t i = feats.size(); i-- > 0;)
+	{
+		auto f = std::make_shared<CFeature>(*feats[i]);
+		for (int k = 0; k < 5; k++)
+		{
+			auto& b = f->descriptors.ORB
+						  [rng.drawUniform32bit() % f->descriptors.ORB.size()];
+			b ^= static_cast<uint8_t>(1 << (rng.drawUniform32bit() % 8));
+		}
+		out.push_back(f);
+	}
+	return out;
+}
+}  // namespace
+
+TEST(DescriptorPairing, DistanceKernels)
+{
+	rng.randomize(123);
+	for (std::size_t n = 1; n < 100; n++)
+	{
+		std::vector<uint8_t> a(n), b(n);
+		std::vector<float> fa(n), fb(n);
+		unsigned int hamming = 0;
+		double l2 = 0;
+		for (std::size_t i = 0; i < n; i++)
+		{
+			a[i] = static_cast<uint8_t>(rng.drawUniform32bit());
+			b[i] = static_cast<uint8_t>(rng.drawUniform32bit());
+			for (uint8_t x = a[i] ^ b[i]; x; x >>= 1) hamming += x & 1;
+			fa[i] = static_cast<float>(rng.drawGaussian1D_normalized());
+			fb[i] = static_cast<float>(rng.drawGaussian1D_normalized());
+			l2 += (fa[i] - fb[i]) * (fa[i] - fb[i]);
+		}
+		EXPECT_EQ(
+			hamming, CDescriptorMatrix::hammingDistance(a.data(), b.data(), n));
+		EXPECT_NEAR(
+			l2, CDescriptorMatrix::squaredL2Distance(fa.data(), fb.data(), n),
+			1e-4 * l2);
+	}
+}
+
+TEST(DescriptorPairing, DescriptorMatrix)
+{
+	rng.randomize(123);
+	const auto feats = randomORBFeatures(10, 33);
+	const CDescriptorMatrix m(feats, descORB);
+	EXPECT_EQ(m.size(), 10u);
+	EXPECT_TRUE(m.isBinary());
+	EXPECT_EQ(m.descriptorLength(), 33u);
+	EXPECT_EQ(m.rowStride(), 64u);
+	for (std::size_t i = 0; i < m.size(); i++)
+		for (std::size_t j = 0; j < m.size(); j++)
+			EXPECT_EQ(
+				m.distance(i, m, j),
+				feats[i]->descriptorORBDistanceTo(*feats[j]));
+
+	// SIFT descriptors are converted to float, compared with L2:
+	CFeatureList sift;
+	for (int i = 0; i < 3; i++)
+	{
+		auto f = std::make_shared<CFeature>();
+		f->descriptors.SIFT.resize(128);
+		for (auto& b : f->descriptors.SIFT)
+			b = static_cast<uint8_t>(rng.drawUniform32bit());
+		sift.push_back(f);
+	}
+	const CDescriptorMatrix ms(sift, descSIFT);
+	EXPECT_FALSE(ms.isBinary());
+	EXPECT_NEAR(
+		ms.distance(0, ms, 2),
+		sift[0]->descriptorSIFTDistanceTo(*sift[2], false), 1e-2);
+
+	// Missing descriptors:
+	EXPECT_ANY_THROW(CDescriptorMatrix(sift, descORB));
+	EXPECT_ANY_THROW(CDescriptorMatrix(sift, descPolarImages));
+}
+
+TEST(DescriptorPairing, BruteForceORB)
+{
+	rng.randomize(123);
+	const std::size_t N = 500;
+	const auto feats1 = randomORBFeatures(N);
+	const auto feats2 = perturbedCopy(feats1);
+	const CDescriptorMatrix d1(feats1, descORB), d2(feats2, descORB);
+
+	TBruteForceMatchingOptions opts;
+	std::vector<TDescriptorMatch> matches;
+	EXPECT_EQ(match_descriptors_brute_force(d1, d2, matches, opts), N);
+	for (const auto& m : matches)
+	{
+		EXPECT_EQ(m.idx2, N - 1 - m.idx1);
+		EXPECT_LE(m.distance, 5.0f);
+		// Compare against an exhaustive search with CFeature methods:
+		float best = 1e9;
+		for (std::size_t j = 0; j < N; j++)
+			best = std::min<float>(
+				best, feats1[m.idx1]->descriptorORBDistanceTo(*feats2[j]));
+		EXPECT_EQ(m.distance, best);
+	}
+
+	// Same result with threads, and all filters (which keep true pairs):
+	opts.max_distance = 10;
+	opts.ratio = 0.8f;
+	opts.cross_check = true;
+	mrpt::system::CWorkerThreadsPool pool(3);
+	std::vector<TDescriptorMatch> matches_mt;
+	EXPECT_EQ(
+		match_descriptors_brute_force(d1, d2, matches_mt, opts, &pool), N);
+	for (std::size_t i = 0; i < N; i++)
+	{
+		EXPECT_EQ(matches[i].idx1, matches_mt[i].idx1);
+		EXPECT_EQ(matches[i].idx2, matches_mt[i].idx2);
+	}
+
+	// Features without a counterpart are filtered out:
+	const auto others = randomORBFeatures(N);
+	const CDescriptorMatrix d3(others, descORB);
+	opts.ratio = 0;
+	opts.cross_check = false;
+	EXPECT_EQ(match_descriptors_brute_force(d1, d3, matches, opts), 0u);
+
+	CMatchedFeatureList mfl;
+	opts.max_distance = 10;
+	EXPECT_EQ(
+		match_features_brute_force(feats1, feats2, mfl, descORB, opts, &pool),
+		N);
+	for (const auto& p : mfl) EXPECT_EQ(p.first->ID, p.second->ID);
+}
@@ -87,11 +87,17 @@ void CFeatureTracker_KL::trackFeatures_impl_templ(
 		const IplImage* prev_gray_ipl = prev_gray.getAs<IplImage>();
 		const IplImage* cur_gray_ipl = cur_gray.getAs<IplImage>();
 
-		// Pyramids
+		// Pyramids: their buffers are kept between calls (only reallocated
+		// if the image size changes). Their contents are always rebuilt.
 		// JL: It seems that cache'ing the pyramids of previous images doesn't
 		// really improve the efficiency (!?!?)
-		IplImage* pPyr = nullptr;
-		IplImage* cPyr = nullptr;
+		// Buffer size required by OpenCV: (width+8)*height/3 bytes
+		const unsigned int pyr_w = img_width + 8,
+						   pyr_h = img_height / 3 + 1;
+		m_prev_pyr.resize(pyr_w, pyr_h, CH_GRAY, true);
+		m_cur_pyr.resize(pyr_w, pyr_h, CH_GRAY, true);
+		IplImage* pPyr = m_prev_pyr.getAs<IplImage>();
+		IplImage* cPyr = m_cur_pyr.getAs<IplImage>();
 
 		int flags = 0;
 
@@ -106,9 +112,6 @@ void CFeatureTracker_KL::trackFeatures_impl_templ(
 				CV_TERMCRIT_ITER | CV_TERMCRIT_EPS, LK_max_iters, LK_epsilon),
 			flags);
 
-		cvReleaseImage(&pPyr);
-		cvReleaseImage(&cPyr);
-
 		for (size_t i = 0; i < nFeatures; ++i)
 		{
 			const bool trck_err_too_large =